@@ -0,0 +1,152 @@
+#ifndef ASSETID_H
+#define ASSETID_H
+
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <string>
+#include <string_view>
+#include <type_traits>
+
+namespace jela
+{
+    namespace utils
+    {
+        // Calls output with every byte of the UTF-8 encoding of name, backslashes coming out as forward slashes.
+        // char strings are expected to be UTF-8 already, wchar_t strings UTF-16 or UTF-32 depending on the platform.
+        template <typename CharType, typename Output>
+        constexpr void ForEachAssetNameByte(std::basic_string_view<CharType> name, Output&& output)
+        {
+            using UnsignedChar = std::make_unsigned_t<CharType>;
+
+            for (std::size_t index = 0; index < name.size(); ++index)
+            {
+                uint32_t codePoint{ static_cast<UnsignedChar>(name[index]) };
+                if (codePoint == '\\') codePoint = '/';
+
+                if constexpr (sizeof(CharType) == 1)
+                {
+                    output(static_cast<uint8_t>(codePoint));
+                }
+                else
+                {
+                    if constexpr (sizeof(CharType) == 2)
+                    {
+                        const bool isPair{ codePoint >= 0xD800 && codePoint < 0xDC00 && index + 1 < name.size() &&
+                                           static_cast<UnsignedChar>(name[index + 1]) >= 0xDC00 &&
+                                           static_cast<UnsignedChar>(name[index + 1]) < 0xE000 };
+                        if (isPair)
+                        {
+                            codePoint = 0x10000 + ((codePoint - 0xD800) << 10) + (static_cast<UnsignedChar>(name[index + 1]) - 0xDC00);
+                            ++index;
+                        }
+                    }
+
+                    if (codePoint < 0x80)
+                    {
+                        output(static_cast<uint8_t>(codePoint));
+                    }
+                    else if (codePoint < 0x800)
+                    {
+                        output(static_cast<uint8_t>(0xC0 | (codePoint >> 6)));
+                        output(static_cast<uint8_t>(0x80 | (codePoint & 0x3F)));
+                    }
+                    else if (codePoint < 0x10000)
+                    {
+                        output(static_cast<uint8_t>(0xE0 | (codePoint >> 12)));
+                        output(static_cast<uint8_t>(0x80 | ((codePoint >> 6) & 0x3F)));
+                        output(static_cast<uint8_t>(0x80 | (codePoint & 0x3F)));
+                    }
+                    else
+                    {
+                        output(static_cast<uint8_t>(0xF0 | (codePoint >> 18)));
+                        output(static_cast<uint8_t>(0x80 | ((codePoint >> 12) & 0x3F)));
+                        output(static_cast<uint8_t>(0x80 | ((codePoint >> 6) & 0x3F)));
+                        output(static_cast<uint8_t>(0x80 | (codePoint & 0x3F)));
+                    }
+                }
+            }
+        }
+
+        // 64-bit FNV-1a of the bytes ForEachAssetNameByte gives, so a name hashes the same whatever its character type
+        template <typename CharType>
+        constexpr uint64_t HashAssetName(std::basic_string_view<CharType> name)
+        {
+            uint64_t hash{ 14695981039346656037ull };
+            ForEachAssetNameByte(name, [&hash](uint8_t byte)
+                {
+                    hash ^= byte;
+                    hash *= 1099511628211ull;
+                });
+            return hash;
+        }
+        constexpr uint64_t HashAssetName(std::string_view name) { return HashAssetName<char>(name); }
+        constexpr uint64_t HashAssetName(std::wstring_view name) { return HashAssetName<wchar_t>(name); }
+    }
+
+    //---------------------------------------------------------------
+    // 64-bit hash of an asset's name, the key resources and pack entries are looked up by.
+    // Names are hashed as written: "Textures/Ship.png" and "Textures\Ship.png" give the same id, "./Textures/Ship.png" doesn't.
+    // Literals are hashed by the compiler: "Textures/Ship.png"_asset
+    class AssetId final
+    {
+    public:
+        constexpr AssetId() = default;
+        constexpr explicit AssetId(std::string_view name) :
+            m_Value{ utils::HashAssetName(name) }
+        {
+            if (!std::is_constant_evaluated()) RememberName(name);
+        }
+        constexpr explicit AssetId(std::wstring_view name) :
+            m_Value{ utils::HashAssetName(name) }
+        {
+            if (!std::is_constant_evaluated()) RememberName(name);
+        }
+
+        static constexpr AssetId FromValue(uint64_t value)
+        {
+            AssetId id{};
+            id.m_Value = value;
+            return id;
+        }
+
+        constexpr uint64_t GetValue() const { return m_Value; }
+        // Only a default constructed id is invalid
+        constexpr bool IsValid() const { return m_Value != 0; }
+
+        constexpr bool operator==(const AssetId&) const = default;
+        constexpr auto operator<=>(const AssetId&) const = default;
+
+        // The name in debug builds, when an id was made from it at runtime or it was remembered; the value in hexadecimal otherwise.
+        std::string GetName() const;
+
+        // Debug builds keep a table from id to name, for GetName and to assert that no two names share an id.
+        // Ids made from a runtime string are added to it automatically, literals aren't.
+#ifdef _DEBUG
+        static void RememberName(std::string_view name);
+        static void RememberName(std::wstring_view name);
+#else
+        static void RememberName(std::string_view) {}
+        static void RememberName(std::wstring_view) {}
+#endif // _DEBUG
+
+    private:
+        uint64_t m_Value{};
+    };
+    //---------------------------------------------------------------
+
+    namespace literals
+    {
+        consteval AssetId operator""_asset(const char* pName, std::size_t size) { return AssetId{ std::string_view{ pName, size } }; }
+        consteval AssetId operator""_asset(const wchar_t* pName, std::size_t size) { return AssetId{ std::wstring_view{ pName, size } }; }
+    }
+}
+
+// The value is already a hash
+template <>
+struct std::hash<jela::AssetId>
+{
+    std::size_t operator()(const jela::AssetId& id) const noexcept { return static_cast<std::size_t>(id.GetValue()); }
+};
+
+#endif // !ASSETID_H
@@ -0,0 +1,171 @@
+#ifndef ASSETPACK_H
+#define ASSETPACK_H
+
+#include "AssetId.h"
+#include "MappedFile.h"
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <filesystem>
+#include <span>
+#include <streambuf>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // Pack file layout, all values little-endian:
+    //   Header
+    //   Entry[entryCount]      sorted by hash, no two entries share one
+    //   char names[namesSize]  not null-terminated, referenced by the entries
+    //   blobs                  each one starting at a multiple of blobAlignment
+    namespace pack
+    {
+        inline constexpr uint32_t magic{ 'J' | ('P' << 8) | ('A' << 16) | ('K' << 24) };
+        inline constexpr uint32_t version{ 1 };
+        inline constexpr uint64_t blobAlignment{ 16 };
+
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t entryCount;
+            uint64_t namesOffset;
+            uint64_t namesSize;
+        };
+
+        struct Entry
+        {
+            // AssetId of the name
+            uint64_t hash;
+            uint64_t offset;
+            uint64_t size;
+            uint32_t nameOffset;
+            uint32_t nameSize;
+        };
+    }
+
+    namespace utils
+    {
+        // Relative path with forward slashes in UTF-8, the way names are stored in a pack.
+        std::string NormalizeAssetName(const std::filesystem::path& name);
+    }
+
+    //---------------------------------------------------------------
+    // Read-only archive of assets, memory-mapped as a whole.
+    // Lookups are a binary search on the AssetId and return views straight into the mapping,
+    // valid for as long as the pack lives. Safe to read from several threads at once.
+    class AssetPack final
+    {
+    public:
+        // Throws a FileException when the file is missing or isn't a valid pack.
+        explicit AssetPack(const std::filesystem::path& packPath);
+        ~AssetPack() = default;
+
+        AssetPack(const AssetPack&) = delete;
+        AssetPack(AssetPack&&) noexcept = delete;
+        AssetPack& operator= (const AssetPack&) = delete;
+        AssetPack& operator= (AssetPack&&) noexcept = delete;
+
+        // Empty when the pack doesn't contain the asset. name is expected in the form NormalizeAssetName gives.
+        std::span<const std::byte> Find(std::string_view name) const;
+        bool Contains(std::string_view name) const { return FindEntry(name) != nullptr; }
+        // Skips hashing and comparing the name. Ids are unique within a pack, the writer rejects names that collide.
+        std::span<const std::byte> Find(AssetId id) const;
+        bool Contains(AssetId id) const { return FindEntry(id) != nullptr; }
+        // Empty when the pack doesn't contain the asset
+        std::string_view FindName(AssetId id) const;
+
+        std::size_t GetAssetCount() const { return m_Entries.size(); }
+        std::string_view GetAssetName(std::size_t index) const;
+        AssetId GetAssetId(std::size_t index) const { return AssetId::FromValue(m_Entries[index].hash); }
+        std::span<const std::byte> GetAssetData(std::size_t index) const;
+        const std::filesystem::path& GetPath() const { return m_File.GetPath(); }
+
+    private:
+        const pack::Entry* FindEntry(std::string_view name) const;
+        const pack::Entry* FindEntry(AssetId id) const;
+
+        MappedFile m_File;
+        std::span<const pack::Entry> m_Entries{};
+        std::string_view m_Names{};
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Lets stream based loaders read a packed asset in place: std::istream stream{ &buffer };
+    // Seeking past the end stops at the end, the next read then sets eofbit just like a file would.
+    class AssetStreamBuffer final : public std::streambuf
+    {
+    public:
+        explicit AssetStreamBuffer(std::span<const std::byte> data)
+        {
+            // The get area is never written to, std::streambuf just has no const version
+            char* const pBegin{ const_cast<char*>(reinterpret_cast<const char*>(data.data())) };
+            setg(pBegin, pBegin, pBegin + data.size());
+        }
+
+    protected:
+        pos_type seekoff(off_type offset, std::ios_base::seekdir direction, std::ios_base::openmode which) override
+        {
+            if (!(which & std::ios_base::in)) return pos_type(off_type(-1));
+
+            const off_type size{ egptr() - eback() };
+            off_type position{ offset };
+            if (direction == std::ios_base::cur) position += gptr() - eback();
+            else if (direction == std::ios_base::end) position += size;
+
+            if (position < 0) return pos_type(off_type(-1));
+            position = std::min(position, size);
+
+            setg(eback(), eback() + position, egptr());
+            return pos_type(position);
+        }
+        pos_type seekpos(pos_type position, std::ios_base::openmode which) override
+        {
+            return seekoff(off_type(position), std::ios_base::beg, which);
+        }
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Builds a pack file. Files are only read while writing, so adding a whole directory is cheap.
+    class AssetPackWriter final
+    {
+    public:
+        AssetPackWriter() = default;
+        ~AssetPackWriter() = default;
+
+        AssetPackWriter(const AssetPackWriter&) = delete;
+        AssetPackWriter(AssetPackWriter&&) noexcept = delete;
+        AssetPackWriter& operator= (const AssetPackWriter&) = delete;
+        AssetPackWriter& operator= (AssetPackWriter&&) noexcept = delete;
+
+        void AddFile(const std::filesystem::path& name, const std::filesystem::path& filePath);
+        void AddData(const std::filesystem::path& name, std::vector<std::byte> data);
+        // Adds every regular file below directory, named by its path relative to directory.
+        void AddDirectory(const std::filesystem::path& directory);
+
+        std::size_t GetAssetCount() const { return m_Assets.size(); }
+
+        // Throws a FileException when an input can't be read, the output can't be written,
+        // or two assets share a name or an AssetId.
+        // The pack is written next to packPath first and only replaces it once complete.
+        void Write(const std::filesystem::path& packPath) const;
+
+    private:
+        struct PendingAsset
+        {
+            std::string name;
+            std::filesystem::path filePath;
+            std::vector<std::byte> data;
+        };
+
+        std::vector<PendingAsset> m_Assets{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !ASSETPACK_H
@@ -1,7 +1,11 @@
 #ifndef AUDIO_H
 #define AUDIO_H
 
+#include "AudioDsp.h"
 #include "AudioService.h"
+#include "Defines.h"
+#include "VoiceSelector.h"
+#include <optional>
 
 namespace jela
 {
@@ -18,10 +22,11 @@ namespace jela
         Audio& operator= (const Audio&) = delete;
         Audio& operator= (Audio&&) noexcept = delete;
 
-        virtual void AddSound(const tstring& filename, SoundID id) override;
+        virtual void AddSound(const tstring& filename, SoundID id, bool stream = false) override;
         virtual void RemoveSound(SoundID id) override;
-        virtual void PlaySoundClip(SoundID id, bool repeat, uint8_t volume = 100, float frequency = 1.f) const override;
-        virtual void PlaySoundInstance(SoundID, bool, SoundInstanceID&, uint8_t = 100, float = 1.f) const override { OutputDebugString(_T("The 'Audio' Service does not support instance sounds.")); }
+        virtual void ReloadSound(const tstring& filename) override;
+        virtual void PlaySoundClip(SoundID id, bool repeat, uint8_t volume = 100, float frequency = 1.f, uint8_t priority = 128) const override;
+        virtual void PlaySoundInstance(SoundID, bool, SoundInstanceID&, uint8_t = 100, float = 1.f, uint8_t = 128) const override { OutputDebugString(_T("The 'Audio' Service does not support instance sounds.")); }
         virtual uint8_t GetMasterVolume() const override;
         virtual void SetMasterVolume(uint8_t newVolume) override;
         virtual void IncrementMasterVolume() override;
@@ -36,6 +41,8 @@ namespace jela
         virtual void StopSound(SoundID id) const override;
         virtual void StopSound(SoundID, const SoundInstanceID&) const override { OutputDebugString(_T("The 'Audio' Service does not support instance sounds.")); }
         virtual void StopAllSounds() const override;
+        virtual void SeekSound(SoundID, const SoundInstanceID&, float) const override { OutputDebugString(_T("The 'Audio' Service does not support instance sounds.")); }
+        virtual void Update() override {}
 
     private:
 
@@ -45,6 +52,15 @@ namespace jela
         AudioImpl* m_pImpl;
     };
 
+    // The submix buses of XAudio. Every sound plays through one, which has its own volume and effects before the master volume.
+    enum class AudioBus : uint8_t
+    {
+        Music,
+        Sfx,
+        Ui,
+        Voice
+    };
+
     class XAudio final : public AudioService
     {
     public:
@@ -57,10 +73,11 @@ namespace jela
         XAudio& operator= (const XAudio&) = delete;
         XAudio& operator= (XAudio&&) noexcept = delete;
 
-        virtual void AddSound(const tstring& filename, SoundID id) override;
+        virtual void AddSound(const tstring& filename, SoundID id, bool stream = false) override;
         virtual void RemoveSound(SoundID id) override;
-        virtual void PlaySoundClip(SoundID id, bool repeat, uint8_t volume = 100, float frequency = 1.f) const override;
-        virtual void PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume = 100, float frequency = 1.f) const override;
+        virtual void ReloadSound(const tstring& filename) override;
+        virtual void PlaySoundClip(SoundID id, bool repeat, uint8_t volume = 100, float frequency = 1.f, uint8_t priority = 128) const override;
+        virtual void PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume = 100, float frequency = 1.f, uint8_t priority = 128) const override;
         virtual uint8_t GetMasterVolume() const override;
         virtual void SetMasterVolume(uint8_t newVolume) override;
         virtual void IncrementMasterVolume() override;
@@ -75,8 +92,29 @@ namespace jela
         virtual void StopSound(SoundID id) const override;
         virtual void StopSound(SoundID id, const SoundInstanceID& instanceId) const override;
         virtual void StopAllSounds() const override;
+        virtual void SeekSound(SoundID id, const SoundInstanceID& instanceId, float seconds) const override;
+        // Gives the channels of each format to the sounds that rank highest, the others play on virtually until one frees up
+        virtual void Update() override;
+
+        void SetVoiceStealPolicy(VoiceStealPolicy policy);
+        VoiceStealPolicy GetVoiceStealPolicy() const;
+
+        // Streamed sounds play through the music bus until they are set to another, the others through the SFX bus. Voices that play move along.
+        void SetSoundBus(SoundID id, AudioBus bus);
+        uint8_t GetBusVolume(AudioBus bus) const;
+        void SetBusVolume(AudioBus bus, uint8_t newVolume);
+        // Keeps the volume, for when it is unmuted
+        void SetBusMute(AudioBus bus, bool isMuted);
+        bool IsBusMuted(AudioBus bus) const;
+        // Runs the bus through the effects that are on in settings, all of them are off by default.
+        // With a keyBus the compressor ducks this bus by the level of that one, music under dialogue for instance, rather than compressing it by its own.
+        void SetBusEffects(AudioBus bus, const audio::EffectSettings& settings, std::optional<AudioBus> keyBus = std::nullopt);
 
         static void SetNrOfChannelsPerFormat(uint16_t amount);
+        // Converts every sound added after this that isn't streamed or compressed to one format when it loads, so they all share one pool of channels
+        // instead of a pool per format they come in. Takes mono or stereo of 16 bit PCM or 32 bit float.
+        // A sampleRate of 0, which is the default, plays sounds in the format of their file.
+        static void SetEngineFormat(uint32_t sampleRate, uint16_t channelCount = 2, uint16_t bitsPerSample = 16);
 
     private:
         class AudioImpl;
@@ -84,6 +122,9 @@ namespace jela
 
         inline static uint16_t m_NrOfChannelsPerFormat{ 64 };
         inline static bool m_ChannelPoolCreated{ false };
+        inline static uint32_t m_EngineSampleRate{};
+        inline static uint16_t m_EngineChannelCount{ 2 };
+        inline static uint16_t m_EngineBitsPerSample{ 16 };
 
     };
 
@@ -0,0 +1,48 @@
+#ifndef AUDIOCONVERT_H
+#define AUDIOCONVERT_H
+
+#include "WaveFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jela::audio
+{
+    //---------------------------------------------------------------
+    // Converts sounds between sample formats, channel counts and sample rates when they load, so a service can play all of them in one format.
+    // In between, samples are float from -1 to 1 and interleaved. Like the mixer's kernels these compile to SSE2, NEON or scalar code.
+    // Sizes are in samples; destination has to be large enough for source, and they may not overlap.
+
+    // The plain format of 16 bit PCM or, with 32 bits, IEEE float
+    WaveFormat MakePcmFormat(uint32_t sampleRate, uint16_t channelCount, uint16_t bitsPerSample);
+    // PCM of 8, 16, 24 or 32 bits and 32 bit float, with frames of no more than blockAlign bytes
+    bool CanDecode(const WaveFormat& format);
+    // 16 bit PCM and 32 bit float, with frames of exactly blockAlign bytes
+    bool CanEncode(const WaveFormat& format);
+
+    // Decodes the whole frames of source to a sample for each channel of each. 16 bit samples are divided by 32768, other sizes scaled alike.
+    void DecodePcm(std::span<const std::byte> source, const WaveFormat& format, std::span<float> destination);
+    // Float is copied as it is. 16 bit is clamped to -1 to 1 and rounded to the nearest sample, ties to even, scaled by 32768 like DecodePcm,
+    // so 16 bit samples come back unchanged and full scale saturates to the largest sample.
+    void EncodePcm(std::span<const float> source, const WaveFormat& format, std::span<std::byte> destination);
+
+    void Deinterleave(std::span<const float> stereo, std::span<float> left, std::span<float> right);
+    void Interleave(std::span<const float> left, std::span<const float> right, std::span<float> stereo);
+
+    // Mixes frames of any number of channels down or up to mono or stereo. Mono plays on both sides of stereo, stereo averages to mono.
+    // More channels fold into stereo by the speaker each is for: channelMask as in WAVE_FORMAT_EXTENSIBLE, or 0 for the default order.
+    void RemixChannels(std::span<const float> source, uint16_t sourceChannelCount, uint32_t channelMask, std::span<float> destination, uint16_t destinationChannelCount);
+
+    // Where frame lies after converting from sourceRate to destinationRate, rounded to the nearest frame
+    uint64_t ConvertFrame(uint64_t frame, uint32_t sourceRate, uint32_t destinationRate);
+    // The frames a sound of frameCount frames takes after converting, enough to reach its end
+    uint64_t ConvertFrameCount(uint64_t frameCount, uint32_t sourceRate, uint32_t destinationRate);
+
+    // Converts the data chunk of a sound in format to target, which has to be mono or stereo and one CanEncode takes.
+    // Rates are converted with a SincResampler. Throws a FileTypeNotSupportedException when it can't decode format.
+    std::vector<std::byte> ConvertSound(std::span<const std::byte> data, const WaveFormat& format, const WaveFormat& target);
+    //---------------------------------------------------------------
+}
+
+#endif // !AUDIOCONVERT_H
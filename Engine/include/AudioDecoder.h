@@ -0,0 +1,73 @@
+#ifndef AUDIODECODER_H
+#define AUDIODECODER_H
+
+#include "WaveFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+
+namespace jela::audio
+{
+    //---------------------------------------------------------------
+    // Decodes a compressed sound a block at a time to interleaved 16 bit PCM, so the sound stays compressed in memory
+    // and only the blocks that play are decoded, into small buffers of the stream playing them.
+    // Blocks decode on their own, so playback can start or seek to any of them. An instance is for one sound,
+    // which is what caches of decoded blocks tell sounds apart by. Doesn't depend on the platform.
+    class BlockDecoder
+    {
+    public:
+        BlockDecoder() = default;
+        virtual ~BlockDecoder() = default;
+
+        BlockDecoder(const BlockDecoder&) = delete;
+        BlockDecoder(BlockDecoder&&) noexcept = delete;
+        BlockDecoder& operator= (const BlockDecoder&) = delete;
+        BlockDecoder& operator= (BlockDecoder&&) noexcept = delete;
+
+        // The 16 bit PCM the blocks decode to, the channels and rate of the sound
+        virtual const WaveFormat& GetDecodedFormat() const = 0;
+        // Compressed bytes of a block
+        virtual uint32_t GetBlockSize() const = 0;
+        virtual uint32_t GetFramesPerBlock() const = 0;
+        // block is GetBlockSize() bytes, destination holds GetFramesPerBlock() frames
+        virtual void DecodeBlock(std::span<const std::byte> block, std::span<int16_t> destination) const = 0;
+
+        uint64_t GetFrameCount(std::size_t dataSize) const { return dataSize / GetBlockSize() * uint64_t{ GetFramesPerBlock() }; }
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // IMA ADPCM as WAVE files store it, 4 bits a sample. Each block starts with the first sample and step index of every channel,
+    // followed by words of 8 samples of a channel, one channel after another.
+    class ImaAdpcmDecoder final : public BlockDecoder
+    {
+    public:
+        // Throws a FileTypeNotSupportedException when format isn't IMA ADPCM of 4 bits, or its blocks don't hold the samples it says
+        explicit ImaAdpcmDecoder(const WaveFormat& format);
+        virtual ~ImaAdpcmDecoder() = default;
+
+        ImaAdpcmDecoder(const ImaAdpcmDecoder&) = delete;
+        ImaAdpcmDecoder(ImaAdpcmDecoder&&) noexcept = delete;
+        ImaAdpcmDecoder& operator= (const ImaAdpcmDecoder&) = delete;
+        ImaAdpcmDecoder& operator= (ImaAdpcmDecoder&&) noexcept = delete;
+
+        virtual const WaveFormat& GetDecodedFormat() const override { return m_DecodedFormat; }
+        virtual uint32_t GetBlockSize() const override { return m_BlockSize; }
+        virtual uint32_t GetFramesPerBlock() const override { return m_FramesPerBlock; }
+        virtual void DecodeBlock(std::span<const std::byte> block, std::span<int16_t> destination) const override;
+
+    private:
+        WaveFormat m_DecodedFormat{};
+        uint32_t m_BlockSize{};
+        uint32_t m_FramesPerBlock{};
+    };
+    //---------------------------------------------------------------
+
+    // Whether format is compressed in a way CreateBlockDecoder takes
+    bool IsBlockCompressed(const WaveFormat& format);
+    // A decoder for a sound in format, which IsBlockCompressed has to be true for. Throws like the decoder does.
+    std::shared_ptr<const BlockDecoder> CreateBlockDecoder(const WaveFormat& format);
+}
+
+#endif // !AUDIODECODER_H
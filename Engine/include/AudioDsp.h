@@ -0,0 +1,226 @@
+#ifndef AUDIODSP_H
+#define AUDIODSP_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+namespace jela::audio
+{
+    //---------------------------------------------------------------
+    // Effects that run on blocks of interleaved float frames, in place, keeping their state from one block to the next.
+    // Like the mixer's kernels they compile to SSE2, NEON or scalar code, and they don't allocate while processing:
+    // whatever depends on the sample rate or channel count is made up front. The filters and reverb process up to maxEffectChannelCount channels,
+    // channels past those pass through them unchanged.
+    inline constexpr uint16_t maxEffectChannelCount{ 8 };
+
+    // y = b0 x + b1 x[-1] + b2 x[-2] - a1 y[-1] - a2 y[-2]
+    struct BiquadCoefficients
+    {
+        float b0{ 1.f };
+        float b1{};
+        float b2{};
+        float a1{};
+        float a2{};
+    };
+
+    // The second order filters of the Audio EQ Cookbook. A q of 0.7071 is flat up to the cutoff, higher ones peak there.
+    BiquadCoefficients MakeLowPass(uint32_t sampleRate, float cutoff, float q = 0.7071f);
+    BiquadCoefficients MakeHighPass(uint32_t sampleRate, float cutoff, float q = 0.7071f);
+
+    // A biquad on every channel. A sample depends on the output before it, so rather than a sample per lane it works out 4 frames of a channel
+    // at once, as a sum of the 4 inputs and the 2 values of state before them, each times what it adds to every one of the 4 outputs.
+    class Biquad final
+    {
+    public:
+        Biquad() = default;
+        ~Biquad() = default;
+
+        Biquad(const Biquad&) = default;
+        Biquad(Biquad&&) noexcept = default;
+        Biquad& operator= (const Biquad&) = default;
+        Biquad& operator= (Biquad&&) noexcept = default;
+
+        // Keeps the state, so a filter can move without a click
+        void SetCoefficients(const BiquadCoefficients& coefficients);
+        const BiquadCoefficients& GetCoefficients() const { return m_Coefficients; }
+        void Reset();
+
+        void Process(std::span<float> samples, uint16_t channelCount);
+
+    private:
+        static constexpr std::size_t m_BlockFrameCount{ 4 };
+
+        BiquadCoefficients m_Coefficients{};
+        // What the state before a block of 4 frames and each of its inputs add to its outputs, 4 values each:
+        // the first state value, the second, then the inputs of the 4 frames
+        std::array<float, (2 + m_BlockFrameCount) * m_BlockFrameCount> m_BlockTaps{};
+        // Transposed direct form II, two values per channel
+        std::array<float, 2 * maxEffectChannelCount> m_State{};
+    };
+
+    struct CompressorSettings
+    {
+        float thresholdDb{ -18.f };
+        // Of the level above the threshold to what is left of it, 1 leaves it as it is
+        float ratio{ 4.f };
+        float attackMs{ 10.f };
+        float releaseMs{ 150.f };
+        float makeupGainDb{};
+    };
+
+    // Lowers the level above a threshold, on the peak of all channels at once so the image doesn't move.
+    // The level is followed and the gain worked out once per control block of frames, the gain ramps linearly in between.
+    // Keyed by the level of another signal instead of its own, it ducks: music under dialogue, for instance.
+    class Compressor final
+    {
+    public:
+        static constexpr std::size_t m_ControlFrameCount{ 16 };
+
+        Compressor() = default;
+        ~Compressor() = default;
+
+        Compressor(const Compressor&) = default;
+        Compressor(Compressor&&) noexcept = default;
+        Compressor& operator= (const Compressor&) = default;
+        Compressor& operator= (Compressor&&) noexcept = default;
+
+        void SetSettings(const CompressorSettings& settings, uint32_t sampleRate);
+        void Reset();
+
+        // keyLevel is the peak of the key over the same time as samples, which then only get their gain from it
+        void Process(std::span<float> samples, uint16_t channelCount, std::optional<float> keyLevel = std::nullopt);
+
+        // Of the last control block, 1 when it doesn't compress
+        float GetGain() const { return m_Gain; }
+
+    private:
+        // Moves the level towards peak over frameCount frames and returns the gain for it
+        float UpdateGain(float peak, std::size_t frameCount);
+
+        uint32_t m_SampleRate{};
+        float m_Threshold{ 1.f };
+        float m_Slope{};
+        float m_MakeupGain{ 1.f };
+        // Time constants in frames
+        float m_AttackFrames{ 1.f };
+        float m_ReleaseFrames{ 1.f };
+        // Per control block of m_ControlFrameCount frames, worked out from the time constants once
+        float m_AttackCoefficient{};
+        float m_ReleaseCoefficient{};
+
+        float m_Level{};
+        float m_Gain{ 1.f };
+    };
+
+    struct ReverbSettings
+    {
+        // 0 to 1, how long the tail lasts
+        float roomSize{ 0.5f };
+        // 0 to 1, how fast the highs of the tail die out
+        float damping{ 0.5f };
+        float wetGain{ 0.25f };
+        float dryGain{ 1.f };
+    };
+
+    // A small Schroeder reverb after Freeverb: 4 damped comb filters in parallel, then 2 allpass filters in series.
+    // The channels share the tail of their sum, odd channels get one with slightly longer delays so stereo sounds wide.
+    // Every delay is longer than 4 frames, so 4 frames of a line are read and written at once, one per lane.
+    class Reverb final
+    {
+    public:
+        Reverb() = default;
+        ~Reverb() = default;
+
+        Reverb(const Reverb&) = delete;
+        Reverb(Reverb&&) noexcept = default;
+        Reverb& operator= (const Reverb&) = delete;
+        Reverb& operator= (Reverb&&) noexcept = default;
+
+        // Allocates the delay lines for the rate, and clears them
+        void Prepare(uint32_t sampleRate);
+        void SetSettings(const ReverbSettings& settings);
+        void Reset();
+
+        void Process(std::span<float> samples, uint16_t channelCount);
+
+    private:
+        static constexpr std::size_t m_CombCount{ 4 };
+        static constexpr std::size_t m_AllpassCount{ 2 };
+        static constexpr std::size_t m_BlockFrameCount{ 4 };
+        // Frames summed into the input of the tails at a time
+        static constexpr std::size_t m_ChunkFrameCount{ 64 };
+
+        struct Tail
+        {
+            // One line per comb, then one per allpass, all in lines at the offsets
+            std::array<std::size_t, m_CombCount + m_AllpassCount> offsets{};
+            std::array<std::size_t, m_CombCount + m_AllpassCount> lengths{};
+            std::array<std::size_t, m_CombCount + m_AllpassCount> positions{};
+            std::array<float, m_CombCount> filterStates{};
+        };
+
+        // Puts out the tail of each of the inputs
+        void ProcessTail(Tail& tail, std::span<const float> inputs, std::span<float> outputs);
+        float ProcessTailFrame(Tail& tail, float input);
+
+        std::vector<float> m_Lines{};
+        std::array<Tail, 2> m_Tails{};
+        float m_Feedback{};
+        float m_Damping{};
+        // What the damping filter's state before a block and each of the comb outputs in it add to the 4 values it filters to, like Biquad's taps
+        std::array<float, (1 + m_BlockFrameCount) * m_BlockFrameCount> m_DampingTaps{};
+        ReverbSettings m_Settings{};
+    };
+
+    struct EffectSettings
+    {
+        bool isHighPassOn{};
+        float highPassCutoff{ 80.f };
+        bool isLowPassOn{};
+        float lowPassCutoff{ 8000.f };
+        bool isCompressorOn{};
+        CompressorSettings compressor{};
+        bool isReverbOn{};
+        ReverbSettings reverb{};
+    };
+
+    // The effects of a bus, in the order high-pass, low-pass, compressor, reverb. Those that are off cost nothing.
+    class EffectChain final
+    {
+    public:
+        EffectChain() = default;
+        ~EffectChain() = default;
+
+        EffectChain(const EffectChain&) = delete;
+        EffectChain(EffectChain&&) noexcept = default;
+        EffectChain& operator= (const EffectChain&) = delete;
+        EffectChain& operator= (EffectChain&&) noexcept = default;
+
+        // Allocates what the effects need for the format and clears their state
+        void Prepare(uint32_t sampleRate, uint16_t channelCount);
+        void SetSettings(const EffectSettings& settings);
+        const EffectSettings& GetSettings() const { return m_Settings; }
+
+        // A keyLevel ducks the samples by it rather than compressing them by their own level, see Compressor
+        void Process(std::span<float> samples, std::optional<float> keyLevel = std::nullopt);
+        // The peak of what Process put out last, to key another chain with
+        float GetPeak() const { return m_Peak; }
+
+    private:
+        EffectSettings m_Settings{};
+        uint32_t m_SampleRate{ 48000 };
+        uint16_t m_ChannelCount{ 2 };
+        Biquad m_HighPass{};
+        Biquad m_LowPass{};
+        Compressor m_Compressor{};
+        Reverb m_Reverb{};
+        float m_Peak{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !AUDIODSP_H
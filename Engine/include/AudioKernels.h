@@ -0,0 +1,79 @@
+#ifndef AUDIOKERNELS_H
+#define AUDIOKERNELS_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jela::audio
+{
+    //---------------------------------------------------------------
+    // The sample loops of the software mixer, on float samples from -1 to 1.
+    // They compile to SSE2 on x86/x64, NEON on ARM and plain scalar code everywhere else, which every target has,
+    // so unlike the pixel conversions they don't check the CPU. Stereo is interleaved, left first.
+    // Sizes are in samples; destination has to be large enough for source, and they may not overlap.
+
+    // Adds source to both channels of the stereo destination, times the gain of each channel
+    void MixMono(std::span<const float> source, std::span<float> destination, float leftGain, float rightGain);
+    // Adds left and right, one channel each, to the stereo destination, times the gain of each channel
+    void MixStereo(std::span<const float> left, std::span<const float> right, std::span<float> destination, float leftGain, float rightGain);
+
+    // Multiplies the stereo frames by a gain that goes linearly from startGain on the first frame to endGain after the last
+    void ApplyGainRamp(std::span<float> samples, float startGain, float endGain);
+    // The largest absolute value, 0 when empty
+    float GetPeak(std::span<const float> samples);
+    // Clamps every sample to -limit to limit. NaN becomes -limit.
+    void Clamp(std::span<float> samples, float limit);
+    // Clamps to -1 to 1 and rounds to the nearest 16 bit sample, ties to even
+    void ToInt16(std::span<const float> source, std::span<int16_t> destination);
+
+    // Resampling reads one channel at positions in frames of source, fixed point with 32 bits of fraction.
+    // Output frame i is taken at position + i * step: the filter reads the tap count of frames from the whole part of it on,
+    // and the value lies at the fraction past the frame that is half the tap count minus one further.
+    // So source has to start that many frames of history before the first position. Both return the position after the last frame.
+    inline constexpr int positionFractionBits{ 32 };
+    inline constexpr uint64_t positionFractionMask{ (uint64_t{ 1 } << positionFractionBits) - 1 };
+
+    inline constexpr std::size_t linearTapCount{ 2 };
+    inline constexpr std::size_t polyphaseTapCount{ 16 };
+
+    // Straight lines between the frames. Cheap, but dulls the highs and aliases.
+    uint64_t ResampleLinear(std::span<const float> source, uint64_t position, uint64_t step, std::span<float> destination);
+    // A Kaiser windowed sinc in 256 phases, interpolated between them. The passband ends at 0.45 of the source rate,
+    // so pitching a sound up above the output rate still aliases somewhat.
+    uint64_t ResamplePolyphase(std::span<const float> source, uint64_t position, uint64_t step, std::span<float> destination);
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // ResamplePolyphase's filter made for one pair of rates, to convert whole sounds when they load rather than while mixing.
+    // Twice as long, which it can afford running once a sound: flat to 0.45 of the rate and some 75 dB down past its half.
+    // Downsampling cuts at 0.45 of the destination rate instead of the source's, so it doesn't alias, with proportionally more taps.
+    inline constexpr std::size_t sincTapCount{ 32 };
+    inline constexpr std::size_t maxSincTapCount{ 256 };
+
+    class SincResampler final
+    {
+    public:
+        SincResampler(uint32_t sourceRate, uint32_t destinationRate);
+        ~SincResampler() = default;
+
+        SincResampler(const SincResampler&) = delete;
+        SincResampler(SincResampler&&) noexcept = delete;
+        SincResampler& operator= (const SincResampler&) = delete;
+        SincResampler& operator= (SincResampler&&) noexcept = delete;
+
+        // A multiple of 4, from sincTapCount up to maxSincTapCount
+        std::size_t GetTapCount() const { return m_TapCount; }
+        // Like ResamplePolyphase, with GetTapCount() taps
+        uint64_t Resample(std::span<const float> source, uint64_t position, uint64_t step, std::span<float> destination) const;
+
+    private:
+        std::size_t m_TapCount{};
+        // The taps of every phase and the one after the last, one after the other
+        std::vector<float> m_Phases{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !AUDIOKERNELS_H
@@ -0,0 +1,28 @@
+#ifndef AUDIOLOG_H
+#define AUDIOLOG_H
+
+#include <cstdint>
+#include <functional>
+#include <string_view>
+
+namespace jela::audio
+{
+    //---------------------------------------------------------------
+    // Where the audio services report what went wrong, so they don't depend on the engine or the debugger to be heard.
+    // Messages may come from the mixing thread, the sink is called under a lock, one message at a time.
+    enum class LogLevel : uint8_t
+    {
+        Info,
+        Warning,
+        Error
+    };
+
+    using LogSink = std::function<void(LogLevel level, std::string_view message)>;
+
+    // An empty sink restores the default one: the debugger output on Windows, stderr elsewhere
+    void SetLogSink(LogSink log);
+    void Log(LogLevel level, std::string_view message);
+    //---------------------------------------------------------------
+}
+
+#endif // !AUDIOLOG_H
@@ -0,0 +1,138 @@
+#ifndef AUDIOMIXER_H
+#define AUDIOMIXER_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jela
+{
+    class WaveFile;
+
+    //---------------------------------------------------------------
+    // A sound decoded the way the software mixer reads it: float samples, all frames of one channel after the other.
+    class MixerSound final
+    {
+    public:
+        static constexpr uint16_t m_MaxChannelCount{ 2 };
+
+        // Decodes PCM of 8, 16, 24 or 32 bits and 32 bit float, in mono or stereo.
+        // Throws a FileTypeNotSupportedException for anything else.
+        explicit MixerSound(const WaveFile& waveFile);
+        ~MixerSound() = default;
+
+        MixerSound(const MixerSound&) = delete;
+        MixerSound(MixerSound&&) noexcept = delete;
+        MixerSound& operator= (const MixerSound&) = delete;
+        MixerSound& operator= (MixerSound&&) noexcept = delete;
+
+        uint16_t GetChannelCount() const { return m_ChannelCount; }
+        uint32_t GetSampleRate() const { return m_SampleRate; }
+        uint32_t GetFrameCount() const { return m_FrameCount; }
+        std::span<const float> GetChannel(uint16_t channel) const { return { m_Samples.data() + std::size_t{ channel } * m_FrameCount, m_FrameCount }; }
+
+        // What repeating plays: the first loop of the smpl chunk, or the whole sound when there is none. The end is exclusive.
+        uint32_t GetLoopBegin() const { return m_LoopBegin; }
+        uint32_t GetLoopEnd() const { return m_LoopEnd; }
+
+    private:
+        uint16_t m_ChannelCount{};
+        uint32_t m_SampleRate{};
+        uint32_t m_FrameCount{};
+        uint32_t m_LoopBegin{};
+        uint32_t m_LoopEnd{};
+        std::vector<float> m_Samples{};
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Mixes a fixed number of voices into stereo float blocks of a fixed size, without threads, locks or allocating.
+    // Each voice plays a MixerSound resampled to the output rate and times the voice's frequency,
+    // and the mix goes through the master gain and a limiter that keeps it under full scale.
+    // Sounds have to outlive the voices that play them; a voice drops its sound when it stops or plays to the end.
+    class AudioMixer final
+    {
+    public:
+        enum class Resampler : uint8_t
+        {
+            Linear,
+            Polyphase
+        };
+
+        static constexpr uint16_t m_ChannelCount{ 2 };
+
+        AudioMixer(uint32_t sampleRate, uint32_t blockFrameCount, uint16_t voiceCount, Resampler resampler = Resampler::Polyphase);
+        ~AudioMixer() = default;
+
+        AudioMixer(const AudioMixer&) = delete;
+        AudioMixer(AudioMixer&&) noexcept = delete;
+        AudioMixer& operator= (const AudioMixer&) = delete;
+        AudioMixer& operator= (AudioMixer&&) noexcept = delete;
+
+        // Plays the sound from the start, in place of whatever the voice played. volume is a gain, 1 leaves the sound as is.
+        // frequency multiplies the pitch and speed, clamped to 1/1024 to 1024 like XAudio2's ratios.
+        void Play(uint16_t voice, const MixerSound* pSound, bool isLooping, float volume, float frequency);
+        void Stop(uint16_t voice);
+        void Pause(uint16_t voice);
+        void Resume(uint16_t voice);
+        // Continues from frame of the sound, wrapped into the loop when looping or clamped to the last frame otherwise
+        void Seek(uint16_t voice, uint64_t frame);
+        void SetMasterGain(float gain) { m_MasterGain = gain; }
+
+        // Mixes the next block, valid until the next call. Voices that play to their end stop and are listed by GetEndedVoices.
+        std::span<const float> Mix();
+        std::span<const uint16_t> GetEndedVoices() const { return m_EndedVoices; }
+
+        bool IsPlaying(uint16_t voice) const { return m_Voices[voice].pSound != nullptr; }
+        bool IsPaused(uint16_t voice) const { return m_Voices[voice].isPaused; }
+        // The frame of its sound the voice is at
+        uint64_t GetPosition(uint16_t voice) const;
+
+        uint32_t GetSampleRate() const { return m_SampleRate; }
+        uint32_t GetBlockFrameCount() const { return m_BlockFrameCount; }
+        uint16_t GetVoiceCount() const { return static_cast<uint16_t>(m_Voices.size()); }
+
+    private:
+        struct Voice
+        {
+            const MixerSound* pSound{};
+            // In frames of the sound, fixed point. Looping doesn't wrap it back at once, see MixVoice.
+            uint64_t position{};
+            uint64_t step{};
+            float gain{};
+            bool isLooping{};
+            bool isPaused{};
+        };
+
+        // Returns whether the voice played to its end
+        bool MixVoice(Voice& voice);
+        void Gather(const Voice& voice, uint16_t channel, int64_t firstFrame, std::size_t frameCount, float* pDestination) const;
+        void Limit();
+
+        const uint32_t m_SampleRate;
+        const uint32_t m_BlockFrameCount;
+        const Resampler m_Resampler;
+        const std::size_t m_TapCount;
+        // Frames of the source the resampler reads per chunk of a block, more for voices played faster
+        const std::size_t m_SourceFrameCapacity;
+        // How much of the way back to a gain of 1 the limiter goes per block
+        const float m_LimiterRelease;
+
+        std::vector<Voice> m_Voices{};
+        std::vector<uint16_t> m_EndedVoices{};
+
+        std::vector<float> m_Block{};
+        // Per channel of the voice being mixed, one after the other: the frames of its sound the resampler reads, and what it makes of them
+        std::vector<float> m_SourceFrames{};
+        std::vector<float> m_VoiceFrames{};
+
+        float m_MasterGain{ 1.f };
+        // What the last block ended at, the next one ramps from there
+        float m_AppliedGain{ 1.f };
+        float m_LimiterGain{ 1.f };
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !AUDIOMIXER_H
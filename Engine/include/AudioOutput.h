@@ -0,0 +1,132 @@
+#ifndef AUDIOOUTPUT_H
+#define AUDIOOUTPUT_H
+
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <stop_token>
+#include <vector>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // Where the software mixer sends its blocks: float samples from -1 to 1, frames of interleaved channels.
+    // Open is called once before the first block, then Write for every block, on the mixing thread and never at the same time.
+    class AudioOutput
+    {
+    public:
+        AudioOutput() = default;
+        virtual ~AudioOutput() = default;
+
+        AudioOutput(const AudioOutput&) = delete;
+        AudioOutput(AudioOutput&&) noexcept = delete;
+        AudioOutput& operator= (const AudioOutput&) = delete;
+        AudioOutput& operator= (AudioOutput&&) noexcept = delete;
+
+        virtual void Open(uint32_t sampleRate, uint16_t channelCount) = 0;
+        // May block until the output has room, which paces the mixer; has to return soon once stopToken is stopped
+        virtual void Write(std::span<const float> samples, std::stop_token stopToken) = 0;
+        // Whether Write waits for the output to play the samples. If not, the mixer keeps to the clock itself.
+        virtual bool IsPaced() const = 0;
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Drops the samples, only counting them. Profiles the mixer without any output.
+    class NullAudioOutput final : public AudioOutput
+    {
+    public:
+        NullAudioOutput() = default;
+        virtual ~NullAudioOutput() = default;
+
+        NullAudioOutput(const NullAudioOutput&) = delete;
+        NullAudioOutput(NullAudioOutput&&) noexcept = delete;
+        NullAudioOutput& operator= (const NullAudioOutput&) = delete;
+        NullAudioOutput& operator= (NullAudioOutput&&) noexcept = delete;
+
+        virtual void Open(uint32_t, uint16_t channelCount) override { m_ChannelCount = channelCount; }
+        virtual void Write(std::span<const float> samples, std::stop_token) override;
+        virtual bool IsPaced() const override { return false; }
+
+        // Any thread
+        uint64_t GetFrameCount() const { return m_FrameCount.load(std::memory_order_relaxed); }
+
+    private:
+        uint16_t m_ChannelCount{ 1 };
+        std::atomic<uint64_t> m_FrameCount{};
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Records to a 16 bit PCM .wav file. The sizes in its header are filled in when the output is destroyed.
+    class WaveFileAudioOutput final : public AudioOutput
+    {
+    public:
+        // Throws a FileLoadException when the file can't be created
+        explicit WaveFileAudioOutput(const std::filesystem::path& filePath);
+        virtual ~WaveFileAudioOutput();
+
+        WaveFileAudioOutput(const WaveFileAudioOutput&) = delete;
+        WaveFileAudioOutput(WaveFileAudioOutput&&) noexcept = delete;
+        WaveFileAudioOutput& operator= (const WaveFileAudioOutput&) = delete;
+        WaveFileAudioOutput& operator= (WaveFileAudioOutput&&) noexcept = delete;
+
+        virtual void Open(uint32_t sampleRate, uint16_t channelCount) override;
+        virtual void Write(std::span<const float> samples, std::stop_token) override;
+        virtual bool IsPaced() const override { return false; }
+
+    private:
+        void WriteHeader();
+
+        std::ofstream m_File;
+        uint32_t m_SampleRate{};
+        uint16_t m_ChannelCount{};
+        uint64_t m_DataSize{};
+        std::vector<int16_t> m_Samples{};
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Ring of samples that another thread reads, like a device callback or a test.
+    // Write waits while the ring is full, so the mixer runs at the pace of the reader. Neither side locks.
+    class RingBufferAudioOutput final : public AudioOutput
+    {
+    public:
+        explicit RingBufferAudioOutput(std::size_t frameCapacity);
+        virtual ~RingBufferAudioOutput() = default;
+
+        RingBufferAudioOutput(const RingBufferAudioOutput&) = delete;
+        RingBufferAudioOutput(RingBufferAudioOutput&&) noexcept = delete;
+        RingBufferAudioOutput& operator= (const RingBufferAudioOutput&) = delete;
+        RingBufferAudioOutput& operator= (RingBufferAudioOutput&&) noexcept = delete;
+
+        virtual void Open(uint32_t sampleRate, uint16_t channelCount) override;
+        virtual void Write(std::span<const float> samples, std::stop_token stopToken) override;
+        virtual bool IsPaced() const override { return true; }
+
+        // Reader's thread, once opened. Copies as many whole frames as are there and fit, and returns how many that were.
+        std::size_t Read(std::span<float> destination);
+        // Any thread, once opened
+        std::size_t GetReadableFrameCount() const;
+        uint32_t GetSampleRate() const { return m_SampleRate; }
+        uint16_t GetChannelCount() const { return m_ChannelCount; }
+
+    private:
+        void Wake();
+
+        const std::size_t m_FrameCapacity;
+        uint32_t m_SampleRate{};
+        uint16_t m_ChannelCount{};
+        std::vector<float> m_Samples{};
+
+        // Samples written and read since it was opened, the difference is what the ring holds
+        std::atomic<uint64_t> m_WritePosition{};
+        std::atomic<uint64_t> m_ReadPosition{};
+        std::atomic<uint32_t> m_Signal{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !AUDIOOUTPUT_H
@@ -3,41 +3,12 @@
 
 #include <string>
 #include <memory>
-#include "Observer.h"
-#include "Defines.h"
+#include "SoundInstanceID.h"
+#include "TString.h"
 
 namespace jela
 {
 
-	using SoundID = unsigned int;
-	struct SoundInstanceID final : public Observer<uint8_t, std::vector<SoundInstanceID*>&>
-	{
-        std::optional<uint8_t> GetID() const { return m_Id; }
-
-        SoundInstanceID() = default;
-
-        //--------------------------------------------------------------
-        // IMPLEMENTED
-
-        virtual ~SoundInstanceID();
-		SoundInstanceID(const SoundInstanceID& other);
-		SoundInstanceID(SoundInstanceID&& other) noexcept;
-		SoundInstanceID& operator= (const SoundInstanceID& other);
-		SoundInstanceID& operator= (SoundInstanceID&& other) noexcept;
-		//--------------------------------------------------------------
-
-		void Init(uint8_t index);
-		void SaveSubject(Subject<uint8_t, std::vector<SoundInstanceID*>&>* pSubject);
-	private:
-
-		virtual void Notify(uint8_t index, std::vector<SoundInstanceID*>& vecThisObservers) override;
-		virtual void OnSubjectDestroy(Subject<uint8_t, std::vector<SoundInstanceID*>&>* pSubject) override;
-
-        std::optional<uint8_t> m_Id{};
-
-		Subject<uint8_t, std::vector<SoundInstanceID*>&>* m_pSubject{};
-	};
-
 	class AudioService
 	{
 	public:
@@ -49,10 +20,14 @@ namespace jela
 		AudioService& operator= (const AudioService&) = delete;
 		AudioService& operator= (AudioService&&) noexcept = delete;
 
-		virtual void AddSound(const tstring& filename, SoundID id) = 0;
+		// A streamed sound is read from its file while it plays instead of being loaded whole, meant for long music tracks
+		virtual void AddSound(const tstring& filename, SoundID id, bool stream = false) = 0;
 		virtual void RemoveSound(SoundID id) = 0;
-		virtual void PlaySoundClip(SoundID id, bool repeat, uint8_t volume = 100, float frequency = 1.f) const = 0;
-		virtual void PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume = 100, float frequency = 1.f) const = 0;
+		// Reloads every sound that was added with this file, relative to the data path. A failed reload keeps the old sound.
+		virtual void ReloadSound(const tstring& filename) = 0;
+		// When more sounds play than a service has voices for, the ones of the highest priority are heard
+		virtual void PlaySoundClip(SoundID id, bool repeat, uint8_t volume = 100, float frequency = 1.f, uint8_t priority = 128) const = 0;
+		virtual void PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume = 100, float frequency = 1.f, uint8_t priority = 128) const = 0;
 		virtual uint8_t GetMasterVolume() const = 0;
 		virtual void SetMasterVolume(uint8_t newVolume) = 0;
 		virtual void IncrementMasterVolume() = 0;
@@ -67,6 +42,10 @@ namespace jela
 		virtual void StopSound(SoundID id) const = 0;
 		virtual void StopSound(SoundID id, const SoundInstanceID& instanceId) const = 0;
 		virtual void StopAllSounds() const = 0;
+		// Continues the instance from seconds into the sound
+		virtual void SeekSound(SoundID id, const SoundInstanceID& instanceId, float seconds) const = 0;
+		// Called by the engine once a frame
+		virtual void Update() = 0;
 
 	};
 
@@ -81,10 +60,11 @@ namespace jela
 		NullAudio& operator= (const NullAudio&) = delete;
 		NullAudio& operator= (NullAudio&&) noexcept = delete;
 
-		virtual void AddSound(const tstring&, SoundID) override {}
+		virtual void AddSound(const tstring&, SoundID, bool = false) override {}
 		virtual void RemoveSound(SoundID) override {}
-		virtual void PlaySoundClip(SoundID, bool, uint8_t = 100, float = 1.f) const override {}
-		virtual void PlaySoundInstance(SoundID, bool, SoundInstanceID&, uint8_t = 100, float = 1.f) const override {};
+		virtual void ReloadSound(const tstring&) override {}
+		virtual void PlaySoundClip(SoundID, bool, uint8_t = 100, float = 1.f, uint8_t = 128) const override {}
+		virtual void PlaySoundInstance(SoundID, bool, SoundInstanceID&, uint8_t = 100, float = 1.f, uint8_t = 128) const override {};
 		virtual uint8_t GetMasterVolume() const override { return 0; }
 		virtual void SetMasterVolume(uint8_t) override {}
 		virtual void IncrementMasterVolume() override {}
@@ -99,6 +79,8 @@ namespace jela
 		virtual void StopSound(SoundID) const override{};
 		virtual void StopSound(SoundID, const SoundInstanceID&) const override{};
 		virtual void StopAllSounds() const override{};
+		virtual void SeekSound(SoundID, const SoundInstanceID&, float) const override{};
+		virtual void Update() override {};
 	};
 
 	class LogAudio final : public AudioService
@@ -115,10 +97,11 @@ namespace jela
 		LogAudio& operator= (const LogAudio&) = delete;
 		LogAudio& operator= (LogAudio&&) noexcept = delete;
 
-		virtual void AddSound(const tstring& filename, SoundID id) override;
+		virtual void AddSound(const tstring& filename, SoundID id, bool stream = false) override;
 		virtual void RemoveSound(SoundID id) override;
-		virtual void PlaySoundClip(SoundID id, bool repeat, uint8_t volume = 100, float frequency = 1.f) const override;
-		virtual void PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume = 100, float frequency = 1.f) const override;
+		virtual void ReloadSound(const tstring& filename) override;
+		virtual void PlaySoundClip(SoundID id, bool repeat, uint8_t volume = 100, float frequency = 1.f, uint8_t priority = 128) const override;
+		virtual void PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume = 100, float frequency = 1.f, uint8_t priority = 128) const override;
 		virtual uint8_t GetMasterVolume() const override;
 		virtual void SetMasterVolume(uint8_t newVolume) override;
 		virtual void IncrementMasterVolume() override;
@@ -133,6 +116,8 @@ namespace jela
 		virtual void StopSound(SoundID id) const override;
 		virtual void StopSound(SoundID id, const SoundInstanceID& instanceId) const override;
 		virtual void StopAllSounds() const override;
+		virtual void SeekSound(SoundID id, const SoundInstanceID& instanceId, float seconds) const override;
+		virtual void Update() override;
 	private:
 
 		std::unique_ptr<AudioService> m_pRealService;
@@ -0,0 +1,235 @@
+#ifndef AUDIOSTREAM_H
+#define AUDIOSTREAM_H
+
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <limits>
+#include <list>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+namespace jela
+{
+    namespace audio
+    {
+        class BlockDecoder;
+    }
+
+    class AudioStreamer;
+
+    //---------------------------------------------------------------
+    // Where a stream sends its buffers to be played, on XAudio a source voice.
+    // Only called by the streaming thread, never while a call to it is still running.
+    class AudioStreamSink
+    {
+    public:
+        AudioStreamSink() = default;
+        virtual ~AudioStreamSink() = default;
+
+        AudioStreamSink(const AudioStreamSink&) = delete;
+        AudioStreamSink(AudioStreamSink&&) noexcept = delete;
+        AudioStreamSink& operator= (const AudioStreamSink&) = delete;
+        AudioStreamSink& operator= (AudioStreamSink&&) noexcept = delete;
+
+        // Queues buffer behind the ones submitted before. Its memory stays untouched until the stream's OnBufferEnd was called for it.
+        // isEndOfStream is set on the last buffer of a stream that doesn't loop.
+        virtual void SubmitBuffer(std::span<const std::byte> buffer, bool isEndOfStream) = 0;
+        // Drops every queued buffer. OnBufferEnd still has to be called for each of them, in order.
+        virtual void FlushBuffers() = 0;
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Plays sample data through a small ring of buffers, so only the ring is resident instead of the whole sound.
+    // The streaming thread copies the data into free buffers and submits them; the sink hands them back with OnBufferEnd.
+    // Copying rather than submitting the data itself means a mapped file is paged in on the streaming thread, not the audio one.
+    // Looping wraps within a buffer, so the loop point has no gap. Created by an AudioStreamer, which runs the streaming thread.
+    // Frames are the size of a sample of all channels in bytes, or of a compressed block the sink decodes.
+    // Compressed data can also be decoded by the stream itself, a block at a time into a buffer of its own, so the sink gets PCM.
+    class AudioStream final
+    {
+    public:
+        AudioStream(AudioStreamer* pStreamer, AudioStreamSink* pSink, std::size_t bufferSize, uint32_t bufferCount);
+        ~AudioStream() = default;
+
+        AudioStream(const AudioStream&) = delete;
+        AudioStream(AudioStream&&) noexcept = delete;
+        AudioStream& operator= (const AudioStream&) = delete;
+        AudioStream& operator= (AudioStream&&) noexcept = delete;
+
+        // Owner's thread. Streams data from the start; pDataOwner keeps it alive until the stream stops or the streaming thread is done with it.
+        // data is cut to whole frames and may not end up empty. Looping repeats the frames from loopBegin up to loopEnd, which 0 puts at the end.
+        void Start(std::span<const std::byte> data, std::shared_ptr<const void> pDataOwner, uint32_t frameSize, bool isLooping, uint64_t loopBegin = 0, uint64_t loopEnd = 0);
+        // Owner's thread. Like Start, but data is blocks that pDecoder decodes as they are streamed, and frames and loop points are decoded ones.
+        // isCached keeps the decoded blocks in the streamer's DecodedBlockCache, for short sounds that play often, so those are decoded once while they stay hot.
+        void Start(std::span<const std::byte> data, std::shared_ptr<const void> pDataOwner, std::shared_ptr<const audio::BlockDecoder> pDecoder, bool isCached,
+            bool isLooping, uint64_t loopBegin = 0, uint64_t loopEnd = 0);
+        // Owner's thread. Nothing is submitted anymore once it returns, the sink still has to flush what it has queued.
+        void Stop();
+        // Any thread. Continues from frame, which is wrapped into the loop when looping or clamped to the last frame otherwise.
+        // The streaming thread flushes the sink first, so what was queued is dropped.
+        void Seek(uint64_t frame);
+
+        // Sink's thread, without blocking. Returns whether it was the end of the stream.
+        bool OnBufferEnd();
+
+        // Streaming thread. Handles a pending seek and fills and submits every free buffer, returns whether it did any of that.
+        bool Update();
+
+        bool IsActive() const { return m_IsActive.load(std::memory_order_relaxed); }
+        std::size_t GetBufferSize() const { return m_BufferSize; }
+        uint32_t GetBufferCount() const { return m_BufferCount; }
+
+    private:
+        void StartData(std::span<const std::byte> data, std::shared_ptr<const void> pDataOwner, std::shared_ptr<const audio::BlockDecoder> pDecoder, bool isCached,
+            uint32_t frameSize, uint64_t frameCount, bool isLooping, uint64_t loopBegin, uint64_t loopEnd);
+        // Streaming thread, without the lock. The decoded block blockIndex of data, which stays valid until the next call.
+        std::span<const std::byte> GetDecodedBlock(std::span<const std::byte> data, const std::shared_ptr<const audio::BlockDecoder>& pDecoder, bool isCached,
+            uint32_t generation, uint64_t blockIndex);
+
+        static constexpr uint64_t m_NoSeek{ std::numeric_limits<uint64_t>::max() };
+        static constexpr uint64_t m_NoEnd{ std::numeric_limits<uint64_t>::max() };
+
+        AudioStreamer* const m_pStreamer;
+        AudioStreamSink* const m_pSink;
+        const std::size_t m_BufferSize;
+        const uint32_t m_BufferCount;
+        // All buffers back to back, buffer n of the ring starts at n * m_BufferSize
+        std::vector<std::byte> m_Buffers{};
+
+        // Guards what Start, Stop and the streaming thread share, and every call to the sink.
+        // Only held for bookkeeping and submitting; buffers are filled without it.
+        std::mutex m_Mutex{};
+        std::span<const std::byte> m_Data{};
+        std::shared_ptr<const void> m_pDataOwner{};
+        std::shared_ptr<const audio::BlockDecoder> m_pDecoder{};
+        bool m_IsCached{};
+        uint32_t m_FrameSize{};
+        bool m_IsLooping{};
+        // In bytes, of the decoded data when there is a decoder
+        std::size_t m_Size{};
+        std::size_t m_LoopBegin{};
+        std::size_t m_LoopEnd{};
+        bool m_IsFinished{};
+        std::size_t m_Position{};
+        // Changes on every Start and Stop, so a buffer filled for an earlier one isn't submitted
+        uint32_t m_Generation{};
+        std::atomic<bool> m_IsActive{};
+        std::atomic<uint64_t> m_SeekFrame{ m_NoSeek };
+
+        // Buffers submitted and ended since the stream was created. Every submitted buffer ends once, in order,
+        // so their difference is the number in use and the next free one is m_SubmittedCount % m_BufferCount.
+        std::atomic<uint64_t> m_SubmittedCount{};
+        std::atomic<uint64_t> m_EndedCount{};
+        // Value of m_SubmittedCount for the last buffer of a stream that doesn't loop
+        std::atomic<uint64_t> m_EndCount{ m_NoEnd };
+
+        // Only touched by the streaming thread. The block decoded last, of the Start of generation m_BlockGeneration,
+        // so filling a buffer that ends within a block doesn't decode it again for the next one.
+        std::vector<int16_t> m_Block{};
+        uint64_t m_BlockIndex{};
+        uint32_t m_BlockGeneration{};
+        bool m_HasBlock{};
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Keeps the blocks that streams decoded last, up to a budget of bytes, dropping the one used longest ago to make room.
+    // Only used by the streaming thread, so it takes no locks. Blocks are told apart by their decoder, which is for one sound;
+    // the decoder is only referred to weakly, and the blocks of one that is destroyed are decoded again if a new one gets its address.
+    class DecodedBlockCache final
+    {
+    public:
+        explicit DecodedBlockCache(std::size_t capacity);
+        ~DecodedBlockCache() = default;
+
+        DecodedBlockCache(const DecodedBlockCache&) = delete;
+        DecodedBlockCache(DecodedBlockCache&&) noexcept = delete;
+        DecodedBlockCache& operator= (const DecodedBlockCache&) = delete;
+        DecodedBlockCache& operator= (DecodedBlockCache&&) noexcept = delete;
+
+        // The decoded block blockIndex of data, decoded first when it isn't cached. Stays valid until the next call.
+        // A block larger than the whole budget is still kept, as the only one.
+        std::span<const int16_t> GetBlock(std::span<const std::byte> data, const std::shared_ptr<const audio::BlockDecoder>& pDecoder, uint64_t blockIndex);
+
+        // Bytes the cached blocks take
+        std::size_t GetSize() const { return m_Size; }
+        std::size_t GetCapacity() const { return m_Capacity; }
+
+    private:
+        struct Key
+        {
+            const audio::BlockDecoder* pDecoder;
+            uint64_t blockIndex;
+
+            bool operator==(const Key&) const = default;
+        };
+        struct KeyHash
+        {
+            std::size_t operator()(const Key& key) const;
+        };
+        struct Entry
+        {
+            Key key;
+            std::weak_ptr<const audio::BlockDecoder> pDecoder;
+            std::vector<int16_t> samples;
+        };
+
+        const std::size_t m_Capacity;
+        std::size_t m_Size{};
+        // Used last first
+        std::list<Entry> m_Entries{};
+        std::unordered_map<Key, std::list<Entry>::iterator, KeyHash> m_EntryIts{};
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Owns the streams and the thread that keeps their buffers filled. The thread sleeps until a stream wakes it,
+    // when it starts, seeks or gets a buffer back. A sink may be destroyed once its stream is stopped.
+    class AudioStreamer final
+    {
+    public:
+        explicit AudioStreamer(std::size_t blockCacheSize = m_DefaultBlockCacheSize);
+        ~AudioStreamer() = default;
+
+        AudioStreamer(const AudioStreamer&) = delete;
+        AudioStreamer(AudioStreamer&&) noexcept = delete;
+        AudioStreamer& operator= (const AudioStreamer&) = delete;
+        AudioStreamer& operator= (AudioStreamer&&) noexcept = delete;
+
+        // The stream lives as long as the streamer. bufferSize is rounded down to whole frames when it starts.
+        AudioStream& CreateStream(AudioStreamSink* pSink, std::size_t bufferSize = m_DefaultBufferSize, uint32_t bufferCount = m_DefaultBufferCount);
+
+        // Any thread, without blocking
+        void Wake();
+
+        // Streaming thread
+        DecodedBlockCache& GetBlockCache() { return m_BlockCache; }
+
+        // 16 KiB is 85 ms of 48 kHz 16 bit stereo, so 4 of them leave over 250 ms to refill one
+        static constexpr std::size_t m_DefaultBufferSize{ 16 * 1024 };
+        static constexpr uint32_t m_DefaultBufferCount{ 4 };
+        // 2 MiB holds 22 seconds of 48 kHz 16 bit mono, plenty for the sound effects that play over and over
+        static constexpr std::size_t m_DefaultBlockCacheSize{ 2 * 1024 * 1024 };
+
+    private:
+        void Run(std::stop_token stopToken);
+
+        // Only locked to add a stream and to copy the list, streams are never removed
+        std::mutex m_StreamsMutex{};
+        std::vector<std::unique_ptr<AudioStream>> m_Streams{};
+        std::atomic<uint32_t> m_Signal{};
+        DecodedBlockCache m_BlockCache;
+
+        // Last, so it stops before the rest is destroyed
+        std::jthread m_Thread;
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !AUDIOSTREAM_H
@@ -2,58 +2,12 @@
 #define DEFINES_H
 
 
-#include <tchar.h>
-#include <string>
+#include "TString.h"
 #include <sstream>
 #include <fstream>
 #include <iostream>
 #include <regex>
 
-
-#ifdef _UNICODE
-    #define tchar			wchar_t
-	#define tstring			std::wstring
-	#define tcin			std::wcin
-	#define tcout			std::wcout
-	#define tstringstream	std::wstringstream
-	#define tofstream		std::wofstream
-	#define tifstream		std::wifstream
-	#define tfstream		std::wfstream
-	#define tostream		std::wostream
-	#define to_tstring		std::to_wstring
-
-	#define tregex			std::wregex
-	#define tcmatch			std::wcmatch
-	#define tsmatch			std::wsmatch
-	#define tcsub_match		std::wcsub_match
-	#define tssub_match		std::wssub_match
-#else
-	#define tchar			char
-	#define tstring			std::string
-	#define tcin			std::cin
-	#define tcout			std::cout
-	#define tstringstream	std::stringstream
-	#define tofstream		std::ofstream
-	#define tifstream		std::ifstream
-	#define tfstream		std::fstream
-	#define tostream		std::ostream
-	#define to_tstring		std::to_string
-
-	#define tregex			std::regex
-	#define tcmatch			std::cmatch
-	#define tsmatch			std::smatch
-	#define tcsub_match		std::csub_match
-	#define tssub_match		std::ssub_match
-#endif
-
-
-#include <filesystem>
-static inline std::wstring to_wstring(const tstring& str)
-{
-	std::filesystem::path p{ str };
-	return p.wstring();
-}
-
 //next ifdef is code from Kevin Hoefman, teacher at Howest, DAE in Kortrijk
 //64 bit defines
 #ifdef _WIN64
@@ -69,6 +23,7 @@ static inline std::wstring to_wstring(const tstring& str)
 #endif
 
 
+#ifdef _WIN32
 // DirectX
 #include <d2d1.h>
 #include <d2d1helper.h>
@@ -81,20 +36,21 @@ static inline std::wstring to_wstring(const tstring& str)
 #include <mferror.h>
 #include <MMSystem.h>
 #include <wincodec.h>
+#endif // _WIN32
 
 
 template<typename Interface>
 inline void SafeRelease(
 	Interface** ppInterfaceToRelease)
 {
-	if (*ppInterfaceToRelease != NULL)
+	if (*ppInterfaceToRelease != nullptr)
 	{
 		(*ppInterfaceToRelease)->Release();
-		(*ppInterfaceToRelease) = NULL;
+		(*ppInterfaceToRelease) = nullptr;
 	}
 }
 
-#ifndef HINST_THISCOMPONENT
+#if defined(_WIN32) && !defined(HINST_THISCOMPONENT)
 EXTERN_C IMAGE_DOS_HEADER __ImageBase;
 #define HINST_THISCOMPONENT ((HINSTANCE)&__ImageBase)
 #endif
@@ -3,12 +3,14 @@
 
 #include "BaseGame.h"
 #include "Structs.h"
+#include "Matrix3x2.h"
 #include "Geometry.h"
 #include "CPlayer.h"
 #include "Audio.h"
 #include "framework.h"
 #include "Controller.h"
 #include "ResourceManager.h"
+#include "EventBus.h"
 #include <vector>
 #include <chrono>
 
@@ -182,6 +184,7 @@ namespace jela
         // Getters
 
         ResourceManager* const ResourceMngr() const;
+        EventBus* const GetEventBus() const;
         const Font* const GetCurrentFont() const;
         Rectf GetWindowRect() const;
         float GetWindowScale() const;
@@ -250,7 +253,7 @@ namespace jela
         FLOAT                           m_ViewPortTranslationX{};
         FLOAT                           m_ViewPortTranslationY{};
 
-        std::vector<D2D1::Matrix3x2F>   m_VecTransformMatrices{};
+        std::vector<Matrix3x2>          m_VecTransformMatrices{};
 
         mutable bool                    m_TransformChanged{};
 
@@ -279,6 +282,7 @@ namespace jela
         std::vector<std::unique_ptr<Controller>> m_pVecControllers{};
 
         std::unique_ptr<ResourceManager>m_pResourceManager{};
+        std::unique_ptr<EventBus>m_pEventBus{};
     };
     //---------------------------------------------------------------
 
@@ -0,0 +1,146 @@
+#ifndef EVENTBUS_H
+#define EVENTBUS_H
+
+#include "Observer.h"
+#include "LinearAllocator.h"
+#include <atomic>
+#include <functional>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <type_traits>
+#include <vector>
+
+namespace jela
+{
+    class ThreadPool;
+
+    //---------------------------------------------------------------
+    // Deferred events: Publish only appends to a contiguous queue per event type,
+    // Dispatch hands every queue to its handlers in one go. The engine dispatches once per frame, right after Tick.
+    // Events published while dispatching wait for the next Dispatch.
+    // Only publish and subscribe on the game thread.
+    class EventBus final
+    {
+    public:
+        EventBus() = default;
+        ~EventBus() = default;
+
+        EventBus(const EventBus&) = delete;
+        EventBus(EventBus&&) noexcept = delete;
+        EventBus& operator= (const EventBus&) = delete;
+        EventBus& operator= (EventBus&&) noexcept = delete;
+
+        template <typename Event>
+        void Publish(Event&& event)
+        {
+            GetQueue<std::remove_cvref_t<Event>>().events.emplace_back(std::forward<Event>(event));
+        }
+        template <typename Event, typename ...Args>
+        void Emplace(Args&&... args)
+        {
+            GetQueue<Event>().events.emplace_back(std::forward<Args>(args)...);
+        }
+
+        // Gets all events of the type that were published since the previous Dispatch, in order.
+        // Handlers stay subscribed for as long as the returned Connection lives.
+        template <typename Event>
+        [[nodiscard]] Connection SubscribeBatch(std::function<void(std::span<const Event> events)> handler)
+        {
+            return GetQueue<Event>().handlers.Connect(std::move(handler));
+        }
+        template <typename Event>
+        [[nodiscard]] Connection Subscribe(std::function<void(const Event& event)> handler)
+        {
+            return SubscribeBatch<Event>([handler = std::move(handler)](std::span<const Event> events)
+                {
+                    for (const Event& event : events) handler(event);
+                });
+        }
+
+        // Dispatches the queue of this type on the thread pool, next to the other parallel types.
+        // Its handlers then must not touch anything the other handlers use, nor publish or subscribe.
+        // Without a thread pool every type is dispatched on the calling thread.
+        template <typename Event>
+        void SetParallelDispatch(bool isParallel) { GetQueue<Event>().isParallel = isParallel; }
+        void SetThreadPool(ThreadPool* pThreadPool) { m_pThreadPool = pThreadPool; }
+
+        void Dispatch();
+
+        // Memory for event payloads, valid until the Dispatch that delivers the events published in the same frame is over.
+        // Nothing allocated here is destroyed, so only trivially destructible types are allowed.
+        template <typename Type>
+        std::span<Type> AllocatePayload(std::size_t count)
+        {
+            static_assert(std::is_trivially_destructible_v<Type>, "Payloads are never destroyed.");
+            Type* const pData{ static_cast<Type*>(m_FrameAllocators[m_CurrentAllocator].Allocate(sizeof(Type) * count, alignof(Type))) };
+            std::uninitialized_value_construct_n(pData, count);
+            return { pData, count };
+        }
+        std::string_view CopyPayload(std::string_view text);
+
+        template <typename Event>
+        std::size_t GetQueuedCount() { return GetQueue<Event>().events.size(); }
+
+    private:
+        struct QueueBase
+        {
+            virtual ~QueueBase() = default;
+            // Moves the queued events aside, so handlers can publish for the next Dispatch. False when there were none.
+            virtual bool TakeEvents() = 0;
+            virtual void DeliverEvents() = 0;
+
+            bool isParallel{};
+        };
+
+        template <typename Event>
+        struct Queue final : QueueBase
+        {
+            virtual bool TakeEvents() override
+            {
+                std::swap(events, dispatchingEvents);
+                return !dispatchingEvents.empty();
+            }
+            virtual void DeliverEvents() override
+            {
+                handlers.NotifyObservers(std::span<const Event>{ dispatchingEvents });
+                // Keeps the capacity for the next frame
+                dispatchingEvents.clear();
+            }
+
+            std::vector<Event> events{};
+            std::vector<Event> dispatchingEvents{};
+            Subject<std::span<const Event>> handlers{};
+        };
+
+        // Every event type gets the next free index the first time it is used, by any bus
+        static std::size_t GetNextTypeIndex();
+        template <typename Event>
+        static std::size_t GetTypeIndex()
+        {
+            static const std::size_t index{ GetNextTypeIndex() };
+            return index;
+        }
+
+        template <typename Event>
+        Queue<Event>& GetQueue()
+        {
+            const std::size_t index{ GetTypeIndex<Event>() };
+            if (index >= m_Queues.size()) m_Queues.resize(index + 1);
+            if (!m_Queues[index]) m_Queues[index] = std::make_unique<Queue<Event>>();
+            return static_cast<Queue<Event>&>(*m_Queues[index]);
+        }
+
+        std::vector<std::unique_ptr<QueueBase>> m_Queues{};
+        std::vector<QueueBase*> m_SerialQueues{};
+        std::vector<QueueBase*> m_ParallelQueues{};
+        ThreadPool* m_pThreadPool{};
+
+        // One fills up while the other one's payloads are being dispatched
+        LinearAllocator m_FrameAllocators[2]{};
+        std::size_t m_CurrentAllocator{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !EVENTBUS_H
@@ -0,0 +1,50 @@
+#ifndef FILEWATCHER_H
+#define FILEWATCHER_H
+
+#include <chrono>
+#include <filesystem>
+#include <functional>
+#include <memory>
+#include <thread>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // Reports files that were written, created or renamed below a directory.
+    // Uses ReadDirectoryChangesW on Windows and inotify on Linux, so the cost follows the number of changes,
+    // not the number of files. Other platforms aren't supported and never report anything.
+    class FileWatcher final
+    {
+    public:
+        // Gets the path of the changed file, relative to the watched directory.
+        using Callback = std::function<void(const std::filesystem::path& file)>;
+
+        // onChanged runs on the watcher's own thread, once a file has been left alone for debounceTime.
+        // Editors tend to save in several steps, which then only count as one change.
+        FileWatcher(const std::filesystem::path& directory, Callback onChanged,
+                    std::chrono::milliseconds debounceTime = std::chrono::milliseconds{ 150 });
+        ~FileWatcher();
+
+        FileWatcher(const FileWatcher&) = delete;
+        FileWatcher(FileWatcher&&) noexcept = delete;
+        FileWatcher& operator= (const FileWatcher&) = delete;
+        FileWatcher& operator= (FileWatcher&&) noexcept = delete;
+
+        // False when the directory couldn't be watched
+        bool IsWatching() const { return m_IsWatching; }
+
+    private:
+        class Impl;
+
+        void Run(std::stop_token stopToken);
+
+        std::unique_ptr<Impl> m_pImpl;
+        Callback m_OnChanged;
+        std::chrono::milliseconds m_DebounceTime;
+        bool m_IsWatching{};
+        std::jthread m_Thread{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !FILEWATCHER_H
@@ -2,7 +2,7 @@
 #define GEOMETRY_H
 
 #include "Structs.h"
-#include <functional>
+#include "Point2fArray.h"
 
 namespace jela
 {
@@ -36,6 +36,7 @@ namespace jela
 	{
 	public:
 		Polygon(const std::vector<Point2f>& points, bool closeSegment = true);
+		Polygon(const Point2fArray& points, bool closeSegment = true);
 
 		Polygon(const Polygon& other) = delete;
 		Polygon(Polygon&& other) noexcept = delete;
@@ -44,18 +45,25 @@ namespace jela
 		virtual ~Polygon() = default;
 
 		bool Recreate(const std::vector<Point2f>& points, bool closeSegment = true);
+		bool Recreate(const Point2fArray& points, bool closeSegment = true);
 
 		virtual void ResetPosition() override;
 		virtual void Move(float x, float y) override { Move({ x,y }); }
 		virtual void Move(const Vector2f& translation) override;
 
-		std::vector<Point2f> GetOriginalPoints() const;
-		const std::vector<Point2f>& GetPoints() const{ return m_Points; };
+		Point2fArray GetOriginalPoints() const;
+		const Point2fArray& GetPoints() const{ return m_Points; };
+		// Convex decomposition of the outline, computed on first use and kept until the polygon is recreated.
+		const std::vector<Point2fArray>& GetConvexPieces() const;
 		bool IsPointInside(const Point2f& point) const;
-	private:
-		void AdjustPoints(const std::function<void(Point2f&)>& func);
+		bool IsOverlapping(const Polygon& other) const;
 
-		std::vector<Point2f> m_Points{};
+		// Drops the points that lie closer than tolerance to the simplified outline (Ramer-Douglas-Peucker).
+		bool Simplify(float tolerance, bool closeSegment = true);
+	private:
+		Point2fArray m_Points{};
+		mutable std::vector<Point2fArray> m_ConvexPieces{};
+		mutable bool m_AreConvexPiecesValid{};
 	};
 
 	class Arc final : public Geometry
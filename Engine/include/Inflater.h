@@ -0,0 +1,88 @@
+#ifndef INFLATER_H
+#define INFLATER_H
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // Decompresses a raw deflate stream (RFC 1951), without the zlib or gzip wrapper around it.
+    // The whole input has to be in memory, the output can be taken in pieces of any size:
+    // besides the input only the 32 KiB history and one chunk of output are kept.
+    class Inflater final
+    {
+    public:
+        // input has to outlive the inflater
+        explicit Inflater(std::span<const uint8_t> input);
+        ~Inflater() = default;
+
+        Inflater(const Inflater&) = delete;
+        Inflater(Inflater&&) noexcept = default;
+        Inflater& operator= (const Inflater&) = delete;
+        Inflater& operator= (Inflater&&) noexcept = default;
+
+        // Fills output, returns less only when the stream ends. Throws a FileLoadException when the data is corrupt.
+        std::size_t Read(std::span<uint8_t> output);
+        // True once the end of the stream was reached and all of it was read
+        bool IsFinished() const { return m_State == State::Done && m_ReadPosition == m_WritePosition; }
+
+    private:
+        enum class State : uint8_t
+        {
+            BlockHeader,
+            Stored,
+            Huffman,
+            Done
+        };
+
+        static constexpr uint32_t fastBits{ 10 };
+
+        // Codes of up to fastBits bits are decoded with one lookup, longer ones by walking the canonical code
+        struct HuffmanTable
+        {
+            // symbol << 4 | code length, 0 for codes that are longer than fastBits
+            std::array<uint16_t, std::size_t{ 1 } << fastBits> fast{};
+            std::array<uint16_t, 16> counts{};
+            std::array<uint16_t, 288> symbols{};
+        };
+
+        static void BuildTable(HuffmanTable& table, std::span<const uint8_t> lengths);
+
+        void Fill();
+        void ReadBlockHeader();
+        void ReadDynamicTables();
+        void InflateStored(std::size_t end);
+        void InflateHuffman(std::size_t end);
+
+        void Refill();
+        uint32_t PeekBits(uint32_t count) const { return static_cast<uint32_t>(m_Bits & ((uint64_t{ 1 } << count) - 1)); }
+        void DropBits(uint32_t count) { m_Bits >>= count; m_BitCount -= count; }
+        uint32_t GetBits(uint32_t count);
+        uint32_t DecodeSymbol(const HuffmanTable& table);
+        // Bits beyond the end of the input read as 0, this tells whether any of those were used
+        bool IsPastEnd() const { return m_InputPosition * 8 - m_BitCount > m_Input.size() * 8; }
+
+        std::span<const uint8_t> m_Input;
+        std::size_t m_InputPosition{};
+        uint64_t m_Bits{};
+        uint32_t m_BitCount{};
+
+        State m_State{ State::BlockHeader };
+        bool m_IsLastBlock{};
+        std::size_t m_StoredRemaining{};
+        HuffmanTable m_LiteralTable{};
+        HuffmanTable m_DistanceTable{};
+
+        // History first, then the output that wasn't read yet
+        std::vector<uint8_t> m_Buffer;
+        std::size_t m_ReadPosition{};
+        std::size_t m_WritePosition{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !INFLATER_H
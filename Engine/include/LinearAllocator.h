@@ -0,0 +1,50 @@
+#ifndef LINEARALLOCATOR_H
+#define LINEARALLOCATOR_H
+
+#include <cstddef>
+#include <memory>
+#include <vector>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // Hands out memory by bumping an offset, and frees all of it at once with Reset.
+    // Never runs destructors: meant for short-lived, trivially destructible data such as per-frame payloads.
+    class LinearAllocator final
+    {
+    public:
+        LinearAllocator() : LinearAllocator{ 64 * 1024 } {}
+        explicit LinearAllocator(std::size_t blockSize);
+        ~LinearAllocator() = default;
+
+        LinearAllocator(const LinearAllocator&) = delete;
+        LinearAllocator(LinearAllocator&&) noexcept = default;
+        LinearAllocator& operator= (const LinearAllocator&) = delete;
+        LinearAllocator& operator= (LinearAllocator&&) noexcept = default;
+
+        // Requests larger than the block size get a block of their own
+        void* Allocate(std::size_t size, std::size_t alignment = alignof(std::max_align_t));
+
+        // Keeps the blocks for reuse; everything allocated before is invalid afterwards
+        void Reset();
+
+        std::size_t GetUsedBytes() const { return m_UsedBytes; }
+        std::size_t GetCapacity() const;
+
+    private:
+        struct Block
+        {
+            std::unique_ptr<std::byte[]> pData;
+            std::size_t size;
+        };
+
+        std::vector<Block> m_Blocks{};
+        std::size_t m_BlockSize;
+        std::size_t m_CurrentBlock{};
+        std::size_t m_Offset{};
+        std::size_t m_UsedBytes{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !LINEARALLOCATOR_H
@@ -0,0 +1,41 @@
+#ifndef MAPPEDFILE_H
+#define MAPPEDFILE_H
+
+#include <cstddef>
+#include <filesystem>
+#include <span>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // Read-only view of a whole file, mapped into memory for as long as the object lives.
+    // Pages are loaded by the OS on first access, so opening is cheap no matter the file size.
+    class MappedFile final
+    {
+    public:
+        // Throws FileNotFoundException or FileLoadException
+        explicit MappedFile(const std::filesystem::path& filePath);
+        ~MappedFile();
+
+        MappedFile(const MappedFile&) = delete;
+        MappedFile(MappedFile&&) noexcept = delete;
+        MappedFile& operator= (const MappedFile&) = delete;
+        MappedFile& operator= (MappedFile&&) noexcept = delete;
+
+        std::span<const std::byte> GetData() const { return { m_pData, m_Size }; }
+        std::size_t GetSize() const { return m_Size; }
+        const std::filesystem::path& GetPath() const { return m_FilePath; }
+
+    private:
+        std::filesystem::path m_FilePath;
+        const std::byte* m_pData{};
+        std::size_t m_Size{};
+#ifdef _WIN32
+        void* m_hFile{};
+        void* m_hMapping{};
+#endif // _WIN32
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !MAPPEDFILE_H
@@ -0,0 +1,211 @@
+#ifndef MATRIX3X2_H
+#define MATRIX3X2_H
+
+#include "Structs.h"
+#include <algorithm>
+
+namespace jela
+{
+    // Portable 2D affine transform.
+    // Uses the same memory layout and row-vector convention as D2D1_MATRIX_3X2_F, so it can be handed to
+    // Direct2D as is: a point is transformed as [x y 1] * M, and A * B means "first apply A, then B".
+    struct Matrix3x2
+    {
+        struct Decomposition
+        {
+            Vector2f translation;
+            // Counterclockwise rotation in degrees.
+            float rotation;
+            Vector2f scale;
+            // Shear of x along y, applied before the scale.
+            float skew;
+        };
+
+        Matrix3x2() = default;
+        explicit constexpr Matrix3x2(float m11, float m12, float m21, float m22, float dx, float dy) :
+            m11{ m11 }, m12{ m12 },
+            m21{ m21 }, m22{ m22 },
+            dx{ dx }, dy{ dy }
+        {}
+
+        float m11;
+        float m12;
+        float m21;
+        float m22;
+        float dx;
+        float dy;
+
+        //---------------------------------------------------------------
+        // Factories
+        static constexpr Matrix3x2 Identity()
+        {
+            return Matrix3x2{ 1.f, 0.f, 0.f, 1.f, 0.f, 0.f };
+        }
+        static constexpr Matrix3x2 Translation(float xTranslation, float yTranslation)
+        {
+            return Matrix3x2{ 1.f, 0.f, 0.f, 1.f, xTranslation, yTranslation };
+        }
+        static constexpr Matrix3x2 Translation(const Vector2f& translation)
+        {
+            return Translation(translation.x, translation.y);
+        }
+        static constexpr Matrix3x2 Scale(float xScale, float yScale, const Point2f& pointToScaleFrom = Point2f{ 0.f, 0.f })
+        {
+            return Matrix3x2{
+                xScale, 0.f,
+                0.f, yScale,
+                pointToScaleFrom.x - xScale * pointToScaleFrom.x,
+                pointToScaleFrom.y - yScale * pointToScaleFrom.y };
+        }
+        // Same angle convention as D2D1::Matrix3x2F::Rotation.
+        static Matrix3x2 Rotation(float angle, const Point2f& pivotPoint = Point2f{ 0.f, 0.f })
+        {
+            const float radians{ angle * std::numbers::pi_v<float> / 180.f };
+            return FromCosSin(std::cos(radians), std::sin(radians), pivotPoint);
+        }
+        static constexpr Matrix3x2 FromCosSin(float cosAngle, float sinAngle, const Point2f& pivotPoint = Point2f{ 0.f, 0.f })
+        {
+            return Matrix3x2{
+                cosAngle, sinAngle,
+                -sinAngle, cosAngle,
+                pivotPoint.x - pivotPoint.x * cosAngle + pivotPoint.y * sinAngle,
+                pivotPoint.y - pivotPoint.x * sinAngle - pivotPoint.y * cosAngle };
+        }
+        static Matrix3x2 Compose(const Decomposition& decomposition)
+        {
+            const Matrix3x2 skew{ 1.f, 0.f, decomposition.skew, 1.f, 0.f, 0.f };
+            return skew
+                * Scale(decomposition.scale.x, decomposition.scale.y)
+                * Rotation(decomposition.rotation)
+                * Translation(decomposition.translation);
+        }
+        //---------------------------------------------------------------
+
+        constexpr Matrix3x2 operator*(const Matrix3x2& rhs) const
+        {
+            return Matrix3x2{
+                m11 * rhs.m11 + m12 * rhs.m21,
+                m11 * rhs.m12 + m12 * rhs.m22,
+                m21 * rhs.m11 + m22 * rhs.m21,
+                m21 * rhs.m12 + m22 * rhs.m22,
+                dx * rhs.m11 + dy * rhs.m21 + rhs.dx,
+                dx * rhs.m12 + dy * rhs.m22 + rhs.dy };
+        }
+        constexpr Matrix3x2& operator*=(const Matrix3x2& rhs)
+        {
+            *this = *this * rhs;
+            return *this;
+        }
+        constexpr bool operator==(const Matrix3x2& rhs) const
+        {
+            return math::Abs(m11 - rhs.m11) < FLT_EPSILON && math::Abs(m12 - rhs.m12) < FLT_EPSILON &&
+                math::Abs(m21 - rhs.m21) < FLT_EPSILON && math::Abs(m22 - rhs.m22) < FLT_EPSILON &&
+                math::Abs(dx - rhs.dx) < FLT_EPSILON && math::Abs(dy - rhs.dy) < FLT_EPSILON;
+        }
+        constexpr bool operator!=(const Matrix3x2& rhs) const
+        {
+            return !(*this == rhs);
+        }
+
+        constexpr float Determinant() const { return m11 * m22 - m12 * m21; }
+        constexpr bool IsInvertible() const { return math::Abs(Determinant()) > FLT_EPSILON; }
+        constexpr bool IsIdentity() const { return *this == Identity(); }
+
+        // Returns false and leaves the matrix untouched when it is singular.
+        constexpr bool Invert()
+        {
+            const float determinant{ Determinant() };
+            if (math::Abs(determinant) <= FLT_EPSILON) return false;
+
+            const float invDeterminant{ 1.f / determinant };
+            *this = Matrix3x2{
+                m22 * invDeterminant,
+                -m12 * invDeterminant,
+                -m21 * invDeterminant,
+                m11 * invDeterminant,
+                (m21 * dy - m22 * dx) * invDeterminant,
+                (m12 * dx - m11 * dy) * invDeterminant };
+            return true;
+        }
+        constexpr Matrix3x2 Inverse() const
+        {
+            Matrix3x2 inverse{ *this };
+            const bool inverted{ inverse.Invert() };
+            assert(inverted && "Tried to take the inverse of a singular Matrix3x2.");
+            (void)inverted;
+            return inverse;
+        }
+
+        // Splits the matrix into skew * scale * rotation * translation. A reflection ends up in a negative y-scale.
+        Decomposition Decompose() const
+        {
+            Decomposition result{};
+            result.translation = Vector2f{ dx, dy };
+
+            const float xScale{ Vector2f{ m11, m12 }.Length() };
+            result.scale.x = xScale;
+            if (xScale <= FLT_EPSILON)
+            {
+                result.rotation = 0.f;
+                result.scale.y = Vector2f{ m21, m22 }.Length();
+                result.skew = 0.f;
+                return result;
+            }
+
+            const float cosAngle{ m11 / xScale };
+            const float sinAngle{ m12 / xScale };
+            result.rotation = std::atan2(sinAngle, cosAngle) * 180.f / std::numbers::pi_v<float>;
+
+            // Second row, expressed in the rotated frame
+            const float shear{ m21 * cosAngle + m22 * sinAngle };
+            result.scale.y = -m21 * sinAngle + m22 * cosAngle;
+            result.skew = shear / xScale;
+
+            return result;
+        }
+
+        constexpr Point2f TransformPoint(const Point2f& point) const
+        {
+            return Point2f{
+                point.x * m11 + point.y * m21 + dx,
+                point.x * m12 + point.y * m22 + dy };
+        }
+        constexpr Vector2f TransformVector(const Vector2f& vector) const
+        {
+            return Vector2f{
+                vector.x * m11 + vector.y * m21,
+                vector.x * m12 + vector.y * m22 };
+        }
+        // Returns the axis aligned bounding box of the transformed rectangle.
+        constexpr Rectf TransformRect(const Rectf& rect) const
+        {
+#ifdef MATHEMATICAL_COORDINATESYSTEM
+            const float yMin{ rect.bottom };
+#else
+            const float yMin{ rect.top };
+#endif // MATHEMATICAL_COORDINATESYSTEM
+            const Point2f corners[4]{
+                TransformPoint(Point2f{ rect.left, yMin }),
+                TransformPoint(Point2f{ rect.left + rect.width, yMin }),
+                TransformPoint(Point2f{ rect.left, yMin + rect.height }),
+                TransformPoint(Point2f{ rect.left + rect.width, yMin + rect.height }) };
+
+            Point2f min{ corners[0] };
+            Point2f max{ corners[0] };
+            for (const Point2f& corner : corners)
+            {
+                min.x = std::min(min.x, corner.x);
+                min.y = std::min(min.y, corner.y);
+                max.x = std::max(max.x, corner.x);
+                max.y = std::max(max.y, corner.y);
+            }
+            return Rectf{ min, max.x - min.x, max.y - min.y };
+        }
+    };
+
+    static_assert(cPlainMathType<Matrix3x2, 6>);
+    static_assert(Matrix3x2::Translation(2.f, 3.f).TransformPoint(Point2f{ 1.f, 1.f }) == Point2f{ 3.f, 4.f });
+    static_assert((Matrix3x2::Scale(2.f, 4.f) * Matrix3x2::Scale(2.f, 4.f).Inverse()).IsIdentity());
+}
+
+#endif // !MATRIX3X2_H
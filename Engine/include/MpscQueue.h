@@ -0,0 +1,139 @@
+#ifndef MPSCQUEUE_H
+#define MPSCQUEUE_H
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <cstddef>
+#include <cstdint>
+#include <stop_token>
+#include <type_traits>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // Bounded queue any number of threads push to and one thread pops from, without locks.
+    // Every slot has a sequence number telling whether it is free for the push of a lap around the ring, or filled for its pop.
+    // Pushing never blocks: it fails when the queue is full. Commands are copied in and out whole, so they have to be plain data.
+    template <typename Command, std::size_t Capacity>
+    class MpscQueue final
+    {
+        static_assert(std::is_trivially_copyable_v<Command>, "Commands are copied in and out of the ring as plain data.");
+        static_assert(std::has_single_bit(Capacity), "The capacity has to be a power of two.");
+
+    public:
+        MpscQueue()
+        {
+            for (std::size_t index = 0; index < Capacity; ++index) m_Slots[index].sequence.store(index, std::memory_order_relaxed);
+        }
+        ~MpscQueue() = default;
+
+        MpscQueue(const MpscQueue&) = delete;
+        MpscQueue(MpscQueue&&) noexcept = delete;
+        MpscQueue& operator= (const MpscQueue&) = delete;
+        MpscQueue& operator= (MpscQueue&&) noexcept = delete;
+
+        // Any thread. Returns false when the queue is full, the command is then dropped.
+        bool TryPush(const Command& command)
+        {
+            std::size_t position{ m_PushPosition.load(std::memory_order_relaxed) };
+            while (true)
+            {
+                Slot& slot{ m_Slots[position & m_Mask] };
+                const std::size_t sequence{ slot.sequence.load(std::memory_order_acquire) };
+                const auto lap{ static_cast<std::ptrdiff_t>(sequence - position) };
+
+                if (lap == 0)
+                {
+                    // The slot is free for this position, claim it before another producer does
+                    if (m_PushPosition.compare_exchange_weak(position, position + 1, std::memory_order_relaxed))
+                    {
+                        slot.command = command;
+                        // Sequentially consistent with the check below, see Wait
+                        slot.sequence.store(position + 1, std::memory_order_seq_cst);
+                        break;
+                    }
+                }
+                // Still holds the command of the previous lap, the consumer hasn't caught up
+                else if (lap < 0) return false;
+                // Another producer claimed it first
+                else position = m_PushPosition.load(std::memory_order_relaxed);
+            }
+
+            // Only the first producer to see the consumer waiting wakes it
+            if (m_IsConsumerWaiting.load(std::memory_order_seq_cst) && m_IsConsumerWaiting.exchange(false, std::memory_order_relaxed)) Wake();
+            return true;
+        }
+
+        // Consumer only. False when there is nothing to pop, or the next command is still being written.
+        bool TryPop(Command& command)
+        {
+            Slot& slot{ m_Slots[m_PopPosition & m_Mask] };
+            if (slot.sequence.load(std::memory_order_acquire) != m_PopPosition + 1) return false;
+
+            command = slot.command;
+            // Free for the push one lap later
+            slot.sequence.store(m_PopPosition + Capacity, std::memory_order_release);
+            ++m_PopPosition;
+            return true;
+        }
+
+        // Consumer only. Sleeps until a command can be popped, Wake is called or stopToken is stopped.
+        // Returns at once when a command already can be popped.
+        void Wait(std::stop_token stopToken = {})
+        {
+            Wait(stopToken, [] { return false; });
+        }
+
+        // Consumer only. Also returns at once when hasWork does, for work the consumer gets some other way than the queue.
+        // Whoever hands it that work calls Wake after making it visible; hasWork is checked after the wait is set up, so that Wake isn't missed.
+        template <typename Predicate>
+        void Wait(std::stop_token stopToken, Predicate hasWork)
+        {
+            const std::stop_callback wakeOnStop{ stopToken, [this] { Wake(); } };
+
+            // Producers store the command and then check this flag, the consumer sets the flag and then checks for a command.
+            // Sequentially consistent, so at least one of them sees the other and no push is missed.
+            m_IsConsumerWaiting.store(true, std::memory_order_seq_cst);
+
+            // Read before checking, so a Wake in between makes wait return
+            const uint32_t signal{ m_Signal.load(std::memory_order_acquire) };
+            const bool canPop{ m_Slots[m_PopPosition & m_Mask].sequence.load(std::memory_order_seq_cst) == m_PopPosition + 1 };
+            if (!canPop && !stopToken.stop_requested() && !hasWork()) m_Signal.wait(signal, std::memory_order_acquire);
+
+            m_IsConsumerWaiting.store(false, std::memory_order_relaxed);
+        }
+
+        // Any thread. Ends the consumer's Wait, for example to stop it.
+        void Wake()
+        {
+            m_Signal.fetch_add(1, std::memory_order_release);
+            m_Signal.notify_one();
+        }
+
+        static constexpr std::size_t GetCapacity() { return Capacity; }
+
+    private:
+        struct Slot
+        {
+            std::atomic<std::size_t> sequence{};
+            Command command{};
+        };
+
+        static constexpr std::size_t m_Mask{ Capacity - 1 };
+        // Keeps what the producers and the consumer write off each other's cache lines.
+        // Padding rather than alignas, which MSVC warns about.
+        static constexpr std::size_t m_CacheLineSize{ 64 };
+
+        std::array<Slot, Capacity> m_Slots{};
+        std::byte m_SlotsPadding[m_CacheLineSize]{};
+        std::atomic<std::size_t> m_PushPosition{};
+        std::byte m_PushPadding[m_CacheLineSize]{};
+        std::size_t m_PopPosition{};
+        std::atomic<bool> m_IsConsumerWaiting{};
+        std::atomic<uint32_t> m_Signal{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !MPSCQUEUE_H
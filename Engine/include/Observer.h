@@ -1,14 +1,21 @@
 #ifndef OBSERVER_H
 #define OBSERVER_H
 
-#include <vector>
-#include "Defines.h"
+#include <cassert>
+#include <functional>
+#include <memory>
 
 namespace jela
 {
 
     template <typename... Args>
     class Observer;
+    class Connection;
+
+    //---------------------------------------------------------------
+    // Keeps its observers in an intrusive linked list: subscribing and Observer::Unsubscribe are O(1) and never allocate.
+    // Observers may subscribe and unsubscribe, themselves or others, from inside Notify.
+    // Observers are notified newest first; the ones that subscribe during a notification only get the next one.
     template <typename... Args>
     class Subject final
     {
@@ -16,73 +23,203 @@ namespace jela
         Subject() = default;
         ~Subject()
         {
-            for (Observer< Args... >* pObserver : m_pVecObservers)
+            assert(!m_pIterations && "A Subject can't be destroyed while it notifies");
+
+            while (m_pFirst)
             {
+                Observer<Args...>* const pObserver{ m_pFirst };
+                Unlink(pObserver);
                 pObserver->OnSubjectDestroy(this);
             }
         }
 
-        Subject(const Subject&) = default;
-        Subject(Subject&&) noexcept = default;
-        Subject& operator= (const Subject&) = default;
-        Subject& operator= (Subject&&) noexcept = default;
+        // The observers point back to their subject
+        Subject(const Subject&) = delete;
+        Subject(Subject&&) noexcept = delete;
+        Subject& operator= (const Subject&) = delete;
+        Subject& operator= (Subject&&) noexcept = delete;
 
-        void AddObserver(Observer<Args... >* pObserver)
+        // An observer follows one subject at a time, unsubscribe it from the previous one first.
+        // Adding an observer twice does nothing.
+        void AddObserver(Observer<Args...>* pObserver)
         {
-            if (pObserver)
-            {
-                if (!HasObserver(pObserver)) m_pVecObservers.emplace_back(pObserver);
-                else OutputDebugString(_T("Observer already subscribed to Subject."));
-            }
-            else OutputDebugString(_T("Tried to add a nullptr to the Subject."));
+            assert(pObserver && "Tried to add a nullptr to the Subject");
+            if (pObserver->m_pSubject == this) return;
+            assert(!pObserver->m_pSubject && "Tried to add an Observer that already follows another Subject");
+
+            pObserver->m_pSubject = this;
+            pObserver->m_pPrevious = nullptr;
+            pObserver->m_pNext = m_pFirst;
+            if (m_pFirst) m_pFirst->m_pPrevious = pObserver;
+            m_pFirst = pObserver;
         }
-        void RemoveObserver(Observer<Args... >* pObserver)
+        // These only compare addresses, so they are safe to call with an observer that was already destroyed.
+        // They walk the list, Observer::Unsubscribe is the O(1) way for an observer that is known to be alive.
+        void RemoveObserver(const Observer<Args...>* pObserver)
         {
-            if (!m_pVecObservers.empty() && pObserver)
-            {
-                auto amountErased = std::erase(m_pVecObservers, pObserver);
-                if (amountErased == 0) OutputDebugString(_T("Couldn't find Observer to remove in the vector. Continuing.\n"));
-            }
+            if (Observer<Args...>* const pFound{ Find(pObserver) }) Unlink(pFound);
         }
-        bool HasObserver(Observer<Args... >* pObserver)
+        bool HasObserver(const Observer<Args...>* pObserver) const
         {
-            return std::ranges::find(m_pVecObservers, pObserver) != m_pVecObservers.cend();
+            return Find(pObserver) != nullptr;
         }
-        void NotifyObservers(Args...  args)
+        bool HasObservers() const { return m_pFirst != nullptr; }
+
+        void NotifyObservers(Args... args)
         {
-            for (Observer<Args... >* pObserver : m_pVecObservers)
+            // Registered on the subject, so unlinking the next observer moves it along
+            Iteration iteration{ m_pFirst, m_pIterations };
+            m_pIterations = &iteration;
+
+            struct IterationGuard
+            {
+                Subject* pSubject;
+                Iteration* pIteration;
+                ~IterationGuard() { pSubject->m_pIterations = pIteration->pOuter; }
+            } guard{ this, &iteration };
+
+            while (iteration.pNext)
             {
+                Observer<Args...>* const pObserver{ iteration.pNext };
+                iteration.pNext = pObserver->m_pNext;
                 pObserver->Notify(args...);
             }
         }
+
+        // Calls callback on every notification, for as long as the returned Connection lives
+        [[nodiscard]] Connection Connect(std::function<void(Args...)> callback);
+
     private:
-        std::vector<Observer<Args... >*> m_pVecObservers;
+        friend class Observer<Args...>;
+
+        // One per NotifyObservers on the stack, nested when an observer notifies the same subject again
+        struct Iteration
+        {
+            Observer<Args...>* pNext;
+            Iteration* pOuter;
+        };
+
+        Observer<Args...>* Find(const Observer<Args...>* pObserver) const
+        {
+            if (!pObserver) return nullptr;
+            for (Observer<Args...>* pCurrent = m_pFirst; pCurrent; pCurrent = pCurrent->m_pNext)
+            {
+                if (pCurrent == pObserver) return pCurrent;
+            }
+            return nullptr;
+        }
+
+        void Unlink(Observer<Args...>* pObserver)
+        {
+            for (Iteration* pIteration = m_pIterations; pIteration; pIteration = pIteration->pOuter)
+            {
+                if (pIteration->pNext == pObserver) pIteration->pNext = pObserver->m_pNext;
+            }
+
+            if (pObserver->m_pPrevious) pObserver->m_pPrevious->m_pNext = pObserver->m_pNext;
+            else m_pFirst = pObserver->m_pNext;
+            if (pObserver->m_pNext) pObserver->m_pNext->m_pPrevious = pObserver->m_pPrevious;
+
+            pObserver->m_pSubject = nullptr;
+            pObserver->m_pPrevious = nullptr;
+            pObserver->m_pNext = nullptr;
+        }
 
+        Observer<Args...>* m_pFirst{};
+        Iteration* m_pIterations{};
     };
+    //---------------------------------------------------------------
 
 
 
+    //---------------------------------------------------------------
+    // Unsubscribes itself when destroyed. Copies start out unsubscribed.
     template <typename... Args>
     class Observer
     {
     public:
 
-        virtual ~Observer() = default;
+        virtual ~Observer() { Unsubscribe(); }
 
-        Observer(const Observer&) = default;
-        Observer(Observer&&) noexcept = default;
-        Observer& operator= (const Observer&) = default;
-        Observer& operator= (Observer&&) noexcept = default;
+        Observer(const Observer&) : Observer{} {}
+        Observer(Observer&&) noexcept : Observer{} {}
+        Observer& operator= (const Observer&) { return *this; }
+        Observer& operator= (Observer&&) noexcept { return *this; }
 
         virtual void Notify(Args...  args) = 0;
-        virtual void OnSubjectDestroy(Subject<Args...>* pSubject) = 0;
+        // The observer is already unsubscribed when this is called
+        virtual void OnSubjectDestroy(Subject<Args...>*) {}
+
+        Subject<Args...>* GetSubject() const { return m_pSubject; }
+        void Unsubscribe() { if (m_pSubject) m_pSubject->Unlink(this); }
 
     protected:
         Observer() = default;
+
+    private:
+        friend class Subject<Args...>;
+
+        Subject<Args...>* m_pSubject{};
+        Observer* m_pPrevious{};
+        Observer* m_pNext{};
     };
+    //---------------------------------------------------------------
+
+
+
+    //---------------------------------------------------------------
+    // Owns a subscription made with Subject::Connect and ends it when destroyed.
+    // Doesn't depend on the subject's arguments, so connections to different subjects can be kept together.
+    class Connection final
+    {
+    public:
+        Connection() = default;
+        ~Connection() = default;
+
+        Connection(const Connection&) = delete;
+        Connection(Connection&&) noexcept = default;
+        Connection& operator= (const Connection&) = delete;
+        Connection& operator= (Connection&&) noexcept = default;
+
+        // False once disconnected, or when the subject was destroyed
+        bool IsConnected() const { return m_pObserver && m_pObserver->IsConnected(); }
+        void Disconnect() { m_pObserver = nullptr; }
+
+    private:
+        template <typename... Args>
+        friend class Subject;
+
+        struct CallbackObserverBase
+        {
+            virtual ~CallbackObserverBase() = default;
+            virtual bool IsConnected() const = 0;
+        };
+
+        explicit Connection(std::unique_ptr<CallbackObserverBase> pObserver) : m_pObserver{ std::move(pObserver) } {}
+
+        std::unique_ptr<CallbackObserverBase> m_pObserver{};
+    };
+
+    template <typename... Args>
+    Connection Subject<Args...>::Connect(std::function<void(Args...)> callback)
+    {
+        struct CallbackObserver final : Observer<Args...>, Connection::CallbackObserverBase
+        {
+            explicit CallbackObserver(std::function<void(Args...)> function) : callback{ std::move(function) } {}
+
+            virtual void Notify(Args... args) override { callback(args...); }
+            virtual bool IsConnected() const override { return this->GetSubject() != nullptr; }
+
+            std::function<void(Args...)> callback;
+        };
 
+        auto pObserver = std::make_unique<CallbackObserver>(std::move(callback));
+        AddObserver(pObserver.get());
+        return Connection{ std::move(pObserver) };
+    }
+    //---------------------------------------------------------------
 
 }
 
 
-#endif // !OBSERVER_H
\ No newline at end of file
+#endif // !OBSERVER_H
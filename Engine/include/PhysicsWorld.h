@@ -0,0 +1,258 @@
+#ifndef PHYSICSWORLD_H
+#define PHYSICSWORLD_H
+
+#include "Structs.h"
+#include "Matrix3x2.h"
+#include "Point2fArray.h"
+#include <array>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+namespace jela
+{
+    class ThreadPool;
+
+    using BodyID = uint32_t;
+    inline constexpr BodyID invalidBody{ std::numeric_limits<BodyID>::max() };
+
+    enum class BodyType : uint8_t
+    {
+        Static,
+        Dynamic
+    };
+
+    enum class ShapeType : uint8_t
+    {
+        Circle,
+        Polygon
+    };
+
+    struct BodyDefinition
+    {
+        BodyType type{ BodyType::Dynamic };
+        float density{ 1.f };
+        float friction{ 0.4f };
+        float restitution{ 0.f };
+        // Degrees, counterclockwise
+        float angle{};
+        Vector2f velocity{};
+        // Degrees per second, counterclockwise
+        float angularVelocity{};
+        float linearDamping{};
+        float angularDamping{};
+    };
+
+    //---------------------------------------------------------------
+    // Headless 2D rigid-body simulation.
+    // Bodies are stored as structure-of-arrays and identified by a BodyID that stays valid until RemoveBody.
+    // Units are whatever the game uses; the default tuning assumes pixels, roughly 100 pixels per meter.
+    // Running Step with the same time step on the same input gives the same result, with or without a thread pool.
+    class PhysicsWorld final
+    {
+    public:
+        static constexpr uint32_t maxPolygonVertices{ 16 };
+
+        // Gravity points down in the engine's coordinate system.
+        PhysicsWorld();
+        explicit PhysicsWorld(const Vector2f& gravity);
+        ~PhysicsWorld() = default;
+
+        PhysicsWorld(const PhysicsWorld&) = delete;
+        PhysicsWorld(PhysicsWorld&&) noexcept = delete;
+        PhysicsWorld& operator= (const PhysicsWorld&) = delete;
+        PhysicsWorld& operator= (PhysicsWorld&&) noexcept = delete;
+
+        //---------------------------------------------------------------
+        // Bodies
+        BodyID AddBody(const Circlef& circle, const BodyDefinition& definition = {});
+        BodyID AddBody(const Rectf& rect, const BodyDefinition& definition = {});
+        // Ellipses are approximated by a polygon with maxPolygonVertices vertices.
+        BodyID AddBody(const Ellipsef& ellipse, const BodyDefinition& definition = {});
+        // Uses the convex hull of the points, so concave outlines are filled in; hulls with more than
+        // maxPolygonVertices vertices are thinned out. Returns invalidBody when the points don't span an area.
+        BodyID AddBody(const Point2fArray& points, const BodyDefinition& definition = {});
+        void RemoveBody(BodyID body);
+        bool IsValid(BodyID body) const;
+
+        std::size_t GetBodyCount() const { return m_BodyCount; }
+        std::size_t GetContactCount() const { return m_Contacts.size(); }
+        std::size_t GetAwakeIslandCount() const { return m_AwakeIslandCount; }
+
+        // The position of a body is its center of mass.
+        Point2f GetPosition(BodyID body) const;
+        // Degrees, counterclockwise
+        float GetAngle(BodyID body) const;
+        Vector2f GetVelocity(BodyID body) const;
+        // Degrees per second, counterclockwise
+        float GetAngularVelocity(BodyID body) const;
+        float GetMass(BodyID body) const;
+        BodyType GetBodyType(BodyID body) const;
+        // Local to world transform of the body, the shape is defined around its center of mass.
+        Matrix3x2 GetTransform(BodyID body) const;
+
+        ShapeType GetShapeType(BodyID body) const;
+        float GetRadius(BodyID body) const;
+        // Fills the world space outline of a polygon body, or clears the array for circles.
+        void GetWorldVertices(BodyID body, Point2fArray& vertices) const;
+
+        void SetPosition(BodyID body, const Point2f& position);
+        void SetAngle(BodyID body, float angle);
+        void SetVelocity(BodyID body, const Vector2f& velocity);
+        void SetAngularVelocity(BodyID body, float angularVelocity);
+
+        // Forces are accumulated until the next step.
+        void ApplyForce(BodyID body, const Vector2f& force);
+        void ApplyForce(BodyID body, const Vector2f& force, const Point2f& worldPoint);
+        void ApplyTorque(BodyID body, float torque);
+        void ApplyImpulse(BodyID body, const Vector2f& impulse);
+        void ApplyImpulse(BodyID body, const Vector2f& impulse, const Point2f& worldPoint);
+
+        bool IsAwake(BodyID body) const;
+        void SetAwake(BodyID body, bool awake);
+        //---------------------------------------------------------------
+
+        //---------------------------------------------------------------
+        // Simulation
+        void Step(float timeStep);
+        // Runs as many fixed steps as fit in the elapsed time, carrying the remainder to the next call.
+        void Update(float elapsedSec);
+
+        void SetGravity(const Vector2f& gravity) { m_Gravity = gravity; }
+        const Vector2f& GetGravity() const { return m_Gravity; }
+        void SetFixedTimeStep(float timeStep) { m_FixedTimeStep = timeStep; }
+        float GetFixedTimeStep() const { return m_FixedTimeStep; }
+        void SetVelocityIterations(uint32_t iterations) { m_VelocityIterations = iterations; }
+        void SetSleepingEnabled(bool enabled);
+        bool IsSleepingEnabled() const { return m_SleepingEnabled; }
+
+        // The pool is not owned; pass nullptr to run everything on the calling thread.
+        void SetThreadPool(ThreadPool* pThreadPool) { m_pThreadPool = pThreadPool; }
+        //---------------------------------------------------------------
+
+    private:
+        struct Shape
+        {
+            ShapeType type;
+            uint32_t vertexCount;
+            float radius;
+            // Counterclockwise, around the center of mass
+            std::array<Vector2f, maxPolygonVertices> vertices;
+            std::array<Vector2f, maxPolygonVertices> normals;
+        };
+
+        struct ContactPoint
+        {
+            Vector2f position;
+            Vector2f rA;
+            Vector2f rB;
+            float separation;
+            float normalImpulse;
+            float tangentImpulse;
+            float normalMass;
+            float tangentMass;
+            float velocityBias;
+            float relaxBias;
+            uint32_t featureID;
+        };
+
+        struct Contact
+        {
+            uint64_t key;
+            BodyID bodyA;
+            BodyID bodyB;
+            // Points from A to B
+            Vector2f normal;
+            float friction;
+            float restitution;
+            uint32_t solverA;
+            uint32_t solverB;
+            uint32_t pointCount;
+            std::array<ContactPoint, 2> points;
+            // Symmetric 2x2 normal mass of a two-point contact and its inverse, stored as { 11, 12, 22 }
+            std::array<float, 3> blockK;
+            std::array<float, 3> blockMass;
+        };
+
+        BodyID AddBody(const Shape& shape, float area, const Point2f& centroid, float unitInertia, const BodyDefinition& definition);
+        BodyID AddPolygonBody(std::vector<Point2f> points, const BodyDefinition& definition);
+
+        void UpdateBounds();
+        void FindContacts();
+        void Collide(Contact& contact) const;
+        void BuildIslands();
+        void SolveIsland(std::size_t island, float timeStep);
+        void Wake(BodyID body);
+
+        void ForEach(std::size_t count, std::size_t grainSize, const std::function<void(std::size_t begin, std::size_t end)>& task);
+
+        static constexpr uint8_t aliveFlag{ 1 << 0 };
+        static constexpr uint8_t dynamicFlag{ 1 << 1 };
+        static constexpr uint8_t awakeFlag{ 1 << 2 };
+
+        // Body storage, indexed by BodyID
+        std::vector<float> m_PositionX{};
+        std::vector<float> m_PositionY{};
+        std::vector<float> m_Angle{};
+        std::vector<float> m_Cos{};
+        std::vector<float> m_Sin{};
+        std::vector<float> m_VelocityX{};
+        std::vector<float> m_VelocityY{};
+        std::vector<float> m_AngularVelocity{};
+        std::vector<float> m_ForceX{};
+        std::vector<float> m_ForceY{};
+        std::vector<float> m_Torque{};
+        std::vector<float> m_InvMass{};
+        std::vector<float> m_InvInertia{};
+        std::vector<float> m_Friction{};
+        std::vector<float> m_Restitution{};
+        std::vector<float> m_LinearDamping{};
+        std::vector<float> m_AngularDamping{};
+        std::vector<float> m_SleepTime{};
+        std::vector<float> m_MinX{};
+        std::vector<float> m_MinY{};
+        std::vector<float> m_MaxX{};
+        std::vector<float> m_MaxY{};
+        std::vector<uint8_t> m_Flags{};
+        std::vector<Shape> m_Shapes{};
+        std::vector<BodyID> m_FreeBodies{};
+        std::size_t m_BodyCount{};
+
+        // Broadphase
+        std::vector<BodyID> m_SortedBodies{};
+        std::vector<uint64_t> m_Pairs{};
+        std::vector<uint32_t> m_PreviousContact{};
+
+        // Contacts, sorted by key so last step's impulses can be matched in a single pass
+        std::vector<Contact> m_Contacts{};
+        std::vector<Contact> m_NewContacts{};
+
+        // Islands
+        std::vector<uint32_t> m_IslandParent{};
+        std::vector<uint32_t> m_IslandOfBody{};
+        std::vector<uint32_t> m_IslandBodyStart{};
+        std::vector<BodyID> m_IslandBodies{};
+        std::vector<uint32_t> m_IslandContactStart{};
+        std::vector<uint32_t> m_IslandContacts{};
+        std::vector<uint8_t> m_IslandAwake{};
+        std::size_t m_AwakeIslandCount{};
+
+        // Solver bodies, laid out island by island
+        std::vector<float> m_SolverVelocityX{};
+        std::vector<float> m_SolverVelocityY{};
+        std::vector<float> m_SolverAngularVelocity{};
+        std::vector<float> m_SolverInvMass{};
+        std::vector<float> m_SolverInvInertia{};
+
+        Vector2f m_Gravity{};
+        float m_FixedTimeStep{ 1.f / 60.f };
+        float m_TimeAccumulator{};
+        uint32_t m_VelocityIterations{ 8 };
+        bool m_SleepingEnabled{ true };
+        ThreadPool* m_pThreadPool{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !PHYSICSWORLD_H
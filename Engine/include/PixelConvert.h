@@ -0,0 +1,60 @@
+#ifndef PIXELCONVERT_H
+#define PIXELCONVERT_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace jela::pixels
+{
+    //---------------------------------------------------------------
+    // Pixel format conversions for image loading, on whole rows or images at once.
+    // Every function picks the widest instruction set the CPU supports the first time any of them is called:
+    // AVX2 or SSE4.1 on x86/x64, NEON on ARM64, plain scalar code otherwise. All of them give the same bytes.
+    // 4 channel formats keep alpha in the last byte; premultiplying rounds color * alpha / 255 to nearest.
+    // Sizes are in bytes or values, and destination has to be large enough for source.
+    // Unless noted otherwise source and destination may be the same memory, but may not partially overlap.
+
+    enum class SimdLevel : uint8_t
+    {
+        Scalar,
+        Sse41,
+        Avx2,
+        Neon
+    };
+
+    // The level the conversions currently run at
+    SimdLevel GetSimdLevel();
+    // The best level the CPU supports
+    SimdLevel GetSupportedSimdLevel();
+    // Forces a lower level, to compare them. Levels the CPU doesn't support are ignored; returns whether it was set.
+    bool SetSimdLevel(SimdLevel level);
+    const char* GetSimdLevelName(SimdLevel level);
+
+    // RGBA to BGRA and back
+    void SwapRedBlue(std::span<const uint8_t> source, std::span<uint8_t> destination);
+    void Premultiply(std::span<const uint8_t> source, std::span<uint8_t> destination);
+    // Pixels with an alpha of 0 become 0
+    void Unpremultiply(std::span<const uint8_t> source, std::span<uint8_t> destination);
+    // SwapRedBlue and Premultiply in one pass
+    void RgbaToPremultipliedBgra(std::span<const uint8_t> source, std::span<uint8_t> destination);
+
+    // 3 bytes per pixel to 4, opaque. Source and destination may not overlap.
+    void RgbToBgra(std::span<const uint8_t> source, std::span<uint8_t> destination);
+    // 1 byte per pixel to 4, opaque. Source and destination may not overlap.
+    void GrayToBgra(std::span<const uint8_t> source, std::span<uint8_t> destination);
+    // 2 bytes per pixel, gray then alpha, to 4. Source and destination may not overlap.
+    void GrayAlphaToPremultipliedBgra(std::span<const uint8_t> source, std::span<uint8_t> destination);
+
+    // Makes the 4 byte pixels whose first three bytes equal those of keyColor fully transparent, 0.
+    // keyColor is read the way the pixels lie in memory, for BGRA that is 0x00RRGGBB.
+    void ColorKeyToAlpha(std::span<uint8_t> pixels, uint32_t keyColor);
+
+    // Every byte to a float from 0 to 1
+    void ToFloat(std::span<const uint8_t> source, std::span<float> destination);
+    // Every float, clamped to 0 to 1, to the nearest byte. NaN becomes 0.
+    void FromFloat(std::span<const float> source, std::span<uint8_t> destination);
+    //---------------------------------------------------------------
+}
+
+#endif // !PIXELCONVERT_H
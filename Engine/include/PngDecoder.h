@@ -0,0 +1,96 @@
+#ifndef PNGDECODER_H
+#define PNGDECODER_H
+
+#include "Inflater.h"
+#include "TextureLoader.h"
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // Decodes PNG images straight to premultiplied BGRA, the format textures are uploaded in.
+    // Doesn't depend on the platform, so tools and headless builds can load images too.
+    // Non-interlaced images are decoded a few rows at a time: besides the file only two rows and the
+    // inflate window are kept. Interlaced images are decoded whole on the first call.
+    // Chunk CRCs and the zlib checksum aren't verified, the data is only checked for being decodable.
+    class PngDecoder final
+    {
+    public:
+        // data has to outlive the decoder. Throws a FileLoadException when it isn't a PNG that can be decoded.
+        explicit PngDecoder(std::span<const std::byte> data);
+        ~PngDecoder() = default;
+
+        PngDecoder(const PngDecoder&) = delete;
+        PngDecoder(PngDecoder&&) noexcept = default;
+        PngDecoder& operator= (const PngDecoder&) = delete;
+        PngDecoder& operator= (PngDecoder&&) noexcept = default;
+
+        // Decodes the whole image at once. Throws a FileLoadException when data is corrupt.
+        static DecodedImage Decode(std::span<const std::byte> data);
+
+        uint32_t GetWidth() const { return m_Width; }
+        uint32_t GetHeight() const { return m_Height; }
+        bool IsInterlaced() const { return m_IsInterlaced; }
+        // Rows returned by DecodeRows so far
+        uint32_t GetDecodedRowCount() const { return m_NextRow; }
+
+        // Writes the next rows to destination, rowStride bytes apart, each width * 4 bytes long.
+        // Returns the number of rows written, less than rowCount only once the image ends.
+        // Throws a FileLoadException when the data is corrupt.
+        uint32_t DecodeRows(std::span<uint8_t> destination, std::size_t rowStride, uint32_t rowCount);
+
+    private:
+        enum class ColorType : uint8_t
+        {
+            Gray = 0,
+            Rgb = 2,
+            Palette = 3,
+            GrayAlpha = 4,
+            Rgba = 6
+        };
+
+        void ReadHeader(std::span<const uint8_t> chunk);
+        void ReadPalette(std::span<const uint8_t> chunk);
+        void ReadTransparency(std::span<const uint8_t> chunk);
+        void BuildLookupTable();
+
+        std::size_t GetRowSize(uint32_t width) const;
+        // Inflates and unfilters the next row of width pixels into m_CurrentRow, the row that was there before is the one above it
+        void ReadRow(uint32_t width);
+        void ConvertRow(uint8_t* pDestination, uint32_t width) const;
+        void DecodeInterlaced();
+
+        uint32_t m_Width{};
+        uint32_t m_Height{};
+        uint8_t m_BitDepth{};
+        ColorType m_ColorType{};
+        bool m_IsInterlaced{};
+        // Bytes per pixel, rounded up to 1, the distance the filters look back over
+        uint32_t m_FilterStride{};
+
+        std::vector<uint8_t> m_Palette{};
+        std::vector<uint8_t> m_PaletteAlpha{};
+        bool m_HasColorKey{};
+        std::array<uint16_t, 3> m_ColorKey{};
+        // BGRA for every value of palette images and gray ones under 8 bits
+        std::vector<uint32_t> m_LookupTable{};
+
+        // Only joined when the image data is split over several IDAT chunks
+        std::vector<uint8_t> m_JoinedData{};
+        Inflater m_Inflater;
+
+        // Each starts with the filter type byte
+        std::vector<uint8_t> m_CurrentRow{};
+        std::vector<uint8_t> m_PreviousRow{};
+        uint32_t m_NextRow{};
+
+        std::vector<uint8_t> m_InterlacedPixels{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !PNGDECODER_H
@@ -0,0 +1,121 @@
+#ifndef POINT2FARRAY_H
+#define POINT2FARRAY_H
+
+#include "Structs.h"
+#include "Matrix3x2.h"
+#include <cstdint>
+#include <initializer_list>
+#include <new>
+#include <utility>
+#include <vector>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    template <typename T, std::size_t Alignment>
+    struct AlignedAllocator
+    {
+        static_assert(Alignment >= alignof(T), "Alignment must be at least the natural alignment of T.");
+
+        using value_type = T;
+
+        template <typename U>
+        struct rebind { using other = AlignedAllocator<U, Alignment>; };
+
+        AlignedAllocator() noexcept = default;
+        template <typename U>
+        AlignedAllocator(const AlignedAllocator<U, Alignment>&) noexcept {}
+
+        T* allocate(std::size_t count)
+        {
+            return static_cast<T*>(::operator new(count * sizeof(T), std::align_val_t{ Alignment }));
+        }
+        void deallocate(T* pMemory, std::size_t) noexcept
+        {
+            ::operator delete(pMemory, std::align_val_t{ Alignment });
+        }
+
+        template <typename U>
+        bool operator==(const AlignedAllocator<U, Alignment>&) const noexcept { return true; }
+    };
+    //---------------------------------------------------------------
+
+
+    //---------------------------------------------------------------
+    // Structure-of-arrays storage for 2D points.
+    // The x and y coordinates live in two separate aligned arrays, so the transform
+    // and reduction kernels can process several points per instruction.
+    class Point2fArray final
+    {
+    public:
+        static constexpr std::size_t alignment{ 32 };
+        using FloatVector = std::vector<float, AlignedAllocator<float, alignment>>;
+
+        Point2fArray() = default;
+        explicit Point2fArray(std::size_t size);
+        explicit Point2fArray(const std::vector<Point2f>& points);
+        Point2fArray(std::initializer_list<Point2f> points);
+
+        Point2fArray(const Point2fArray& other) = default;
+        Point2fArray(Point2fArray&& other) noexcept = default;
+        Point2fArray& operator=(const Point2fArray& other) = default;
+        Point2fArray& operator=(Point2fArray&& other) noexcept = default;
+        ~Point2fArray() = default;
+
+        void Assign(const std::vector<Point2f>& points);
+        std::vector<Point2f> ToVector() const;
+
+        std::size_t Size() const { return m_X.size(); }
+        bool Empty() const { return m_X.empty(); }
+        void Reserve(std::size_t capacity);
+        void Resize(std::size_t size);
+        void Clear();
+        void PushBack(const Point2f& point);
+
+        Point2f operator[](std::size_t index) const { return Point2f{ m_X[index], m_Y[index] }; }
+        void Set(std::size_t index, const Point2f& point) { m_X[index] = point.x; m_Y[index] = point.y; }
+
+        float* X() { return m_X.data(); }
+        float* Y() { return m_Y.data(); }
+        const float* X() const { return m_X.data(); }
+        const float* Y() const { return m_Y.data(); }
+
+        // Kernels
+        void Translate(const Vector2f& translation);
+        void Scale(float xScale, float yScale, const Point2f& pointToScaleFrom = Point2f{});
+        void Scale(float scale, const Point2f& pointToScaleFrom = Point2f{}) { Scale(scale, scale, pointToScaleFrom); }
+        // Counterclockwise rotation in degrees around the pivot point.
+        void Rotate(float angle, const Point2f& pivotPoint = Point2f{});
+        // Row-vector affine transform, the same convention Matrix3x2 uses:
+        // x' = x * m11 + y * m21 + dx
+        // y' = x * m12 + y * m22 + dy
+        void Transform(float m11, float m12, float m21, float m22, float dx, float dy);
+        void Transform(const Matrix3x2& matrix) { Transform(matrix.m11, matrix.m12, matrix.m21, matrix.m22, matrix.dx, matrix.dy); }
+
+        std::pair<Point2f, Point2f> GetMinMax() const;
+        Rectf GetBoundingRect() const;
+        // The average of all points, not the area centroid of the shape they describe.
+        Point2f GetCentroid() const;
+
+    private:
+        FloatVector m_X{};
+        FloatVector m_Y{};
+    };
+    //---------------------------------------------------------------
+
+
+    //---------------------------------------------------------------
+    // Batch versions of the utils queries.
+    // The results vector is resized to the amount of points; an entry is 1 when the point passes the test.
+    namespace utils
+    {
+        void IsPointInRect(const Point2fArray& points, const Rectf& r, std::vector<uint8_t>& results);
+        void IsPointInCircle(const Point2fArray& points, const Circlef& c, std::vector<uint8_t>& results);
+        void IsPointInEllipse(const Point2fArray& points, const Ellipsef& e, std::vector<uint8_t>& results);
+        void Distance(const Point2fArray& points, const Point2f& p, std::vector<float>& results);
+        std::size_t CountPointsInRect(const Point2fArray& points, const Rectf& r);
+    }
+    //---------------------------------------------------------------
+}
+
+#endif // !POINT2FARRAY_H
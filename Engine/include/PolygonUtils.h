@@ -0,0 +1,41 @@
+#ifndef POLYGONUTILS_H
+#define POLYGONUTILS_H
+
+#include "Structs.h"
+#include "Point2fArray.h"
+#include <array>
+#include <cstdint>
+#include <vector>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // Simplification and convex decomposition of simple polygons.
+    // Outlines may wind either way; everything these functions return is counterclockwise,
+    // meaning a positive signed area (clockwise on screen when the y-axis points down).
+    namespace utils
+    {
+        // Signed area, positive for counterclockwise outlines
+        float GetSignedArea(const Point2fArray& points);
+        bool IsConvex(const Point2fArray& points);
+
+        // Ramer-Douglas-Peucker: drops every point that lies closer than tolerance to the simplified outline.
+        Point2fArray SimplifyRamerDouglasPeucker(const Point2fArray& points, float tolerance, bool closed = true);
+        // Visvalingam-Whyatt: repeatedly drops the point that spans the smallest triangle with its neighbours,
+        // as long as that area stays below minArea. Closed outlines keep at least 3 points.
+        Point2fArray SimplifyVisvalingam(const Point2fArray& points, float minArea, bool closed = true);
+
+        // Ear clipping. Returns triangles as indices into points, each one counterclockwise.
+        std::vector<std::array<uint32_t, 3>> Triangulate(const Point2fArray& points);
+        // Hertel-Mehlhorn: merges the triangulation back together along every diagonal that keeps both sides convex.
+        // Gives at most 4 times the minimal number of convex pieces.
+        std::vector<Point2fArray> DecomposeConvex(const Point2fArray& points);
+
+        // Both expect a convex, counterclockwise outline such as the pieces from DecomposeConvex.
+        bool IsPointInConvexPolygon(const Point2fArray& convexPoints, const Point2f& point);
+        bool IsOverlappingConvex(const Point2fArray& convexPoints1, const Point2fArray& convexPoints2);
+    }
+    //---------------------------------------------------------------
+}
+
+#endif // !POLYGONUTILS_H
@@ -0,0 +1,62 @@
+#ifndef RESOURCEBUDGET_H
+#define RESOURCEBUDGET_H
+
+#include "AssetId.h"
+#include <cstdint>
+#include <functional>
+#include <list>
+#include <unordered_map>
+#include <vector>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // Byte accounting for cached resources, kept in least recently used order.
+    // Only tracks ids and sizes: the owner decides which resources are in use and frees the ones picked for eviction.
+    class ResourceBudget final
+    {
+    public:
+        // A budget of 0 never evicts anything
+        explicit ResourceBudget(std::size_t budget = 0) : m_Budget{ budget } {}
+
+        // Adding an id that is already tracked updates its size. Both count as a use.
+        void Add(AssetId id, std::size_t sizeInBytes);
+        void Remove(AssetId id);
+        void Clear();
+        // Marks the resource as the most recently used one
+        void Touch(AssetId id);
+
+        // While over budget, moves the least recently used ids for which isInUse returns false into evicted
+        // and stops tracking them. Returns how many were added.
+        std::size_t Evict(const std::function<bool(AssetId id)>& isInUse, std::vector<AssetId>& evicted);
+
+        void SetBudget(std::size_t budget) { m_Budget = budget; }
+        std::size_t GetBudget() const { return m_Budget; }
+        std::size_t GetUsage() const { return m_Usage; }
+        bool IsOverBudget() const { return m_Budget > 0 && m_Usage > m_Budget; }
+
+        std::size_t GetCount() const { return m_Lookup.size(); }
+        // Total since construction, Clear doesn't reset it
+        uint64_t GetEvictionCount() const { return m_EvictionCount; }
+        uint64_t GetEvictedBytes() const { return m_EvictedBytes; }
+
+    private:
+        struct Entry
+        {
+            AssetId id;
+            std::size_t sizeInBytes;
+        };
+
+        // Least recently used first
+        std::list<Entry> m_Entries{};
+        std::unordered_map<AssetId, std::list<Entry>::iterator> m_Lookup{};
+
+        std::size_t m_Budget;
+        std::size_t m_Usage{};
+        uint64_t m_EvictionCount{};
+        uint64_t m_EvictedBytes{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !RESOURCEBUDGET_H
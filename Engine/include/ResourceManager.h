@@ -3,8 +3,18 @@
 
 #include "framework.h"
 #include "Observer.h"
+#include "AssetPack.h"
+#include "TextureLoader.h"
+#include "TextureCache.h"
+#include "FileWatcher.h"
+#include "ResourceBudget.h"
+#include "SlotMap.h"
+#include <functional>
 #include <map>
+#include <memory>
+#include <mutex>
 #include <unordered_map>
+#include <unordered_set>
 
 namespace jela
 {
@@ -14,6 +24,8 @@ namespace jela
     {
     public:
         explicit Texture(const tstring& filename);
+        // Only uploads, the image was decoded beforehand by Decode.
+        explicit Texture(const tstring& filename, const DecodedImage& image);
 
         Texture(const Texture& other) = delete;
         Texture(Texture&& other) noexcept = delete;
@@ -26,11 +38,21 @@ namespace jela
         float GetWidth() const { return m_TextureWidth; }
         float GetHeight() const { return m_TextureHeight; }
         const tstring& GetFileName() const { return m_FileName; }
+        // Video memory taken by the bitmap
+        std::size_t GetSizeInBytes() const;
 
         static void InitFactory();
         static void DestroyFactory();
 
+        // Decodes the file into memory without touching the render target, safe to call from any thread.
+        // Reads it from the ResourceManager's texture cache instead when that has it, and adds it otherwise.
+        static DecodedImage Decode(const tstring& filename);
+
     private:
+        // PNGs go through PngDecoder, every other format through WIC
+        static DecodedImage DecodeFile(const tstring& filename);
+        static DecodedImage DecodeWithWic(const tstring& filename);
+        void Upload(const DecodedImage& image);
 
         static IWICImagingFactory* m_pWICFactory;
         ID2D1Bitmap* m_pDBitmap{ nullptr };
@@ -64,9 +86,10 @@ namespace jela
     private:
         // using friend class for tight coupling
         friend class TextFormat;
-        HRESULT Initialize(const std::wstring& filename);
+        HRESULT Initialize(const std::wstring& filename, std::span<const std::byte> packedData);
 
         static IDWriteFactory5* m_pDWriteFactory;
+        static IDWriteInMemoryFontFileLoader* m_pInMemoryLoader;
 
         IDWriteFontCollection1* m_pFontCollection{ nullptr };
 
@@ -131,14 +154,21 @@ namespace jela
             m_DataPath = dataPath;
             Texture::InitFactory();
             Font::InitFactory();
+            m_pTextureLoader = std::make_unique<TextureLoader>(&Texture::Decode);
         }
         ~ResourceManager()
         {
             m_OnFontChange.RemoveObserver(m_pCurrentTextFormat);
+            m_pFileWatcher = nullptr;
+
+            // Workers might still be decoding with the WIC factory
+            m_pTextureLoader = nullptr;
+            m_PendingTextures.clear();
 
             m_pDefaultTextFormat = nullptr;
             RemoveAllFonts();
             RemoveAllTextures();
+            UnmountAllAssetPacks();
 
             Texture::DestroyFactory();
             Font::DestroyFactory();
@@ -152,19 +182,76 @@ namespace jela
         ResourceManager& operator= (ResourceManager&&) noexcept = delete;
 
         template <typename ResourceType>
-        struct ResourcePtr;
-
-        void GetTexture(const tstring& file, ResourcePtr<Texture>& resourcePtr);
+        class ResourceHandle;
+        struct AsyncTexture;
+
+        // The handle is invalid when the file couldn't be loaded
+        ResourceHandle<Texture> GetTexture(const tstring& file);
+        // Skips hashing the name: GetTexture("Textures/Ship.png"_asset).
+        // Works for textures that are already loaded and for the ones a mounted pack contains, the only places the file name can come from.
+        ResourceHandle<Texture> GetTexture(AssetId id);
+        // Decodes the file on a worker thread and uploads it during a later Update.
+        // Textures that are already loaded are ready right away, and onLoaded is then called before returning.
+        // onLoaded gets nullptr when loading failed.
+        AsyncTexture GetTextureAsync(const tstring& file, LoadPriority priority = LoadPriority::Normal,
+                                     std::function<void(const Texture*)> onLoaded = {});
+        // Handles to a removed resource resolve to nullptr from then on
         void RemoveTexture(const tstring& file);
         void RemoveAllTextures();
 
-        void GetFont(const tstring& fontName, ResourcePtr<Font>& resourcePtr, bool fromFile = false);
+        ResourceHandle<Font> GetFont(const tstring& fontName, bool fromFile = false);
         void RemoveFont(const tstring& fontName);
         void RemoveAllFonts();
 
+        // nullptr when the handle is invalid or its resource got removed. An evicted texture is loaded again first.
+        const Texture* Resolve(const ResourceHandle<Texture>& handle);
+        const Font* Resolve(const ResourceHandle<Font>& handle);
+
+        // Uploads the textures that finished decoding and runs their callbacks. Called by the engine every frame.
+        void Update();
+        // Limits the uploads done in one Update, spreading a burst of finished textures over several frames.
+        void SetMaxTextureUploadsPerFrame(std::size_t maxUploads) { m_MaxTextureUploadsPerFrame = maxUploads; }
+        std::size_t GetPendingTextureCount() const { return m_PendingTextures.size(); }
+
+        // Above this many bytes, textures that weren't resolved during this or the previous frame are evicted,
+        // least recently used first. Their handles stay valid: resolving one, or getting the texture again, loads it again.
+        // 0, the default, keeps every texture.
+        void SetTextureBudget(std::size_t budgetInBytes);
+        std::size_t GetTextureBudget() const { return m_TextureBudget.GetBudget(); }
+        std::size_t GetTextureMemoryUsage() const { return m_TextureBudget.GetUsage(); }
+        uint64_t GetEvictedTextureCount() const { return m_TextureBudget.GetEvictionCount(); }
+        uint64_t GetEvictedTextureBytes() const { return m_TextureBudget.GetEvictedBytes(); }
+
+        // Resources are looked up in the mounted packs first, the last mounted one first,
+        // and read from the data path when no pack has them. The pack file is relative to the data path.
+        // Mount packs before loading resources, the loading threads read the packs without locking.
+        bool MountAssetPack(const tstring& packFile);
+        void UnmountAllAssetPacks() { m_AssetPacks.clear(); }
+        // Empty when no mounted pack contains the file
+        std::span<const std::byte> FindPackedAsset(const tstring& file) const;
+        std::span<const std::byte> FindPackedAsset(AssetId id) const;
+        // The pack FindPackedAsset would read the file from, nullptr when it comes from the data path
+        const AssetPack* FindAssetPack(const tstring& file) const;
+
+        // Keeps the decoded textures in directory, so later runs can skip decoding them. An empty directory turns it off.
+        // Compressing saves disk space, most on sprites with large transparent areas, but the pixels can't be uploaded in place.
+        // Set it before loading textures, the loading threads use it without locking.
+        bool SetTextureCache(const tstring& directory, bool isCompressed = false);
+        TextureCache* GetTextureCache() const { return m_pTextureCache.get(); }
+
+        // Watches the data path and reloads the textures, fonts and sounds whose files change, during the next Update.
+        // Handles resolve to the reloaded resource; when a reload fails the old one stays.
+        // Meant for development: files that a mounted pack contains keep coming from the pack.
+        void SetHotReloadEnabled(bool isEnabled);
+        bool IsHotReloadEnabled() const { return m_pFileWatcher != nullptr; }
+
         const tstring& GetDataPath() const { return m_DataPath; }
         const Font* const GetCurrentFont() const { return m_pCurrentFont; }
-        const TextFormat* const GetCurrentTextFormat() const { return m_pCurrentTextFormat; }
+        // Falls back to the default TextFormat when the game destroyed the one it set, which unsubscribed it
+        const TextFormat* const GetCurrentTextFormat() const
+        {
+            return m_OnFontChange.HasObserver(m_pCurrentTextFormat) ? m_pCurrentTextFormat : m_pDefaultTextFormat.get();
+        }
 
         void SetDataPath(const tstring& newPath) { m_DataPath = newPath; }
         void SetCurrentFont(const Font* const pFont);
@@ -172,125 +259,160 @@ namespace jela
     private:
 
         //-----------------------------------------------------------------------------------------------------------------
-        // Private ManagedResource struct
+        // Private ManagedResource and ResourcePool structs
 
         template <typename ResourceType>
         struct ManagedResource
         {
-            template <typename ...Args>
-            ManagedResource(Args&&... args) :
-                resource{ args... },
-                pOnResourceDestroy{std::make_unique<Subject<>>()}
-            {}
-
-            ~ManagedResource() { pOnResourceDestroy->NotifyObservers(); }
+            // nullptr while the resource is evicted
+            std::unique_ptr<ResourceType> pResource{};
+            AssetId id{};
+            // What it is loaded from
+            tstring name{};
+            // Last frame in which a handle resolved to this resource
+            uint64_t lastUsedFrame{};
+        };
 
-            ManagedResource(const ManagedResource&) = delete;
-            ManagedResource(ManagedResource&&) noexcept = delete;
-            ManagedResource& operator= (const ManagedResource&) = delete;
-            ManagedResource& operator= (ManagedResource&&) noexcept = delete;
+        // Resources live in a slot map, so handles stay plain indices; the id map is only used when loading.
+        template <typename ResourceType>
+        struct ResourcePool
+        {
+            using Key = typename SlotMap<ManagedResource<ResourceType>>::Key;
 
-            ResourceType resource;
+            ManagedResource<ResourceType>* Find(AssetId id)
+            {
+                const auto it = ids.find(id);
+                return it != ids.end() ? slots.Find(it->second) : nullptr;
+            }
+            Key Add(AssetId id, const tstring& name, std::unique_ptr<ResourceType> pResource, uint64_t frame = 0)
+            {
+                const Key key{ slots.Emplace(ManagedResource<ResourceType>{ std::move(pResource), id, name, frame }) };
+                ids.emplace(id, key);
+                return key;
+            }
+            bool Remove(AssetId id)
+            {
+                const auto it = ids.find(id);
+                if (it == ids.end()) return false;
 
-            void HandleObserver(ResourcePtr<ResourceType>& resourcePtr)
+                slots.Erase(it->second);
+                ids.erase(it);
+                return true;
+            }
+            void Clear()
             {
-                if (resourcePtr.pObject) resourcePtr.m_pSubject->RemoveObserver(&resourcePtr);
-                pOnResourceDestroy->AddObserver(&resourcePtr);
-                resourcePtr.SaveSubject(pOnResourceDestroy.get());
-                resourcePtr.pObject = &resource;
+                slots.Clear();
+                ids.clear();
             }
 
-        private:
-            std::unique_ptr<Subject<>> pOnResourceDestroy{};
+            SlotMap<ManagedResource<ResourceType>> slots{};
+            std::unordered_map<AssetId, Key> ids{};
         };
         //-----------------------------------------------------------------------------------------------------------------
 
     public:
 
         //-----------------------------------------------------------------------------------------------------------------
-        // Public ResourcePtr struct
+        // Public ResourceHandle class
+        // A slot index and generation: free to copy and store, and never dangling.
+        // Resolves through the engine's ResourceManager, to nullptr once the resource is removed.
         template <typename ResourceType>
-        struct ResourcePtr final : public Observer<>
+        class ResourceHandle final
         {
-            const ResourceType* pObject = nullptr;
+        public:
+            ResourceHandle() = default;
 
-            ResourcePtr() = default;
+            const ResourceType* Get() const { return m_Key == Key{} ? nullptr : GetResourceManager()->Resolve(*this); }
+            const ResourceType* operator->() const { return Get(); }
+            explicit operator bool() const { return Get() != nullptr; }
 
-            virtual ~ResourcePtr() { if (m_pSubject) m_pSubject->RemoveObserver(this); }
+            bool operator==(const ResourceHandle&) const = default;
 
-            ResourcePtr(const ResourcePtr& other)
-                : pObject{other.pObject}
-                  , m_pSubject{other.m_pSubject}
-            {
-                if (m_pSubject) m_pSubject->AddObserver(this);
-            }
+        private:
+            friend class ResourceManager;
+            using Key = typename ResourcePool<ResourceType>::Key;
 
-            ResourcePtr(ResourcePtr&& other) noexcept
-                : pObject{std::move(other.pObject)}
-                  , m_pSubject{std::move(other.m_pSubject)}
-            {
-                if (m_pSubject)
-                {
-                    m_pSubject->RemoveObserver(&other);
-                    m_pSubject->AddObserver(this);
-                }
-
-                other.m_pSubject = nullptr;
-                other.pObject = nullptr;
-            }
+            explicit ResourceHandle(Key key) : m_Key{ key } {}
 
-            ResourcePtr& operator= (const ResourcePtr& other)
-            {
-                if (m_pSubject) m_pSubject->RemoveObserver(this);
+            Key m_Key{};
+        };
+        //-----------------------------------------------------------------------------------------------------------------
 
-                pObject = other.pObject;
-                m_pSubject = other.m_pSubject;
-                if (m_pSubject) m_pSubject->AddObserver(this);
+        //-----------------------------------------------------------------------------------------------------------------
+        // Public AsyncTexture struct
+        // Result of GetTextureAsync. Copies share the same request; only use it on the game thread.
+        struct AsyncTexture final
+        {
+            AsyncTexture() = default;
 
-                return *this;
-            }
+            LoadStatus GetStatus() const { return m_pState ? m_pState->status : LoadStatus::Failed; }
+            bool IsReady() const { return GetStatus() == LoadStatus::Ready; }
+            bool IsPending() const { return GetStatus() == LoadStatus::Pending; }
 
-            ResourcePtr& operator= (ResourcePtr&& other) noexcept
+            // nullptr until the texture is ready, or after it got removed from the ResourceManager
+            const Texture* GetTexture() const { return m_pState ? m_pState->texture.Get() : nullptr; }
+            const ResourceHandle<Texture>& GetHandle() const
             {
-                if (m_pSubject) m_pSubject->RemoveObserver(this);
-
-                m_pSubject = std::move(other.m_pSubject);
-                pObject = std::move(other.pObject);
-
-                if (m_pSubject)
-                {
-                    m_pSubject->RemoveObserver(&other);
-                    m_pSubject->AddObserver(this);
-                }
-
-                other.m_pSubject = nullptr;
-                other.pObject = nullptr;
-
-                return *this;
+                static const ResourceHandle<Texture> noTexture{};
+                return m_pState ? m_pState->texture : noTexture;
+            }
+            const std::string& GetError() const
+            {
+                static const std::string noError{};
+                return m_pState ? m_pState->error : noError;
             }
 
         private:
-            friend struct ManagedResource<ResourceType>;
+            friend class ResourceManager;
 
-            virtual void Notify() override { pObject = nullptr; }
-            virtual void OnSubjectDestroy(Subject<>* pSubject) override { if (pSubject == m_pSubject) m_pSubject = nullptr; }
-            void SaveSubject(Subject<>* pSubject)
+            struct State
             {
-                if (!pSubject) OutputDebugString(_T("Subject was nullptr when trying to save it to the ResourcePtr SingleSubjectsObserver."));
-                else m_pSubject = pSubject;
-            }
-            Subject<>* m_pSubject{};
+                ResourceHandle<Texture> texture{};
+                LoadStatus status{ LoadStatus::Pending };
+                std::string error{};
+                std::function<void(const Texture*)> onLoaded{};
+            };
+
+            explicit AsyncTexture(std::shared_ptr<State> pState) : m_pState{ std::move(pState) } {}
+
+            std::shared_ptr<State> m_pState{};
         };
         //-----------------------------------------------------------------------------------------------------------------
 
     private:
 
-        template<typename ResourceType>
-        using ResourceMap = std::unordered_map<tstring, ManagedResource<ResourceType>>;
+        static void FinishAsyncTexture(AsyncTexture::State& state, const std::string& error);
+        ResourceHandle<Texture> GetTexture(AssetId id, const tstring& file);
+        ResourceHandle<Texture> AddTexture(AssetId id, const tstring& file, std::unique_ptr<Texture> pTexture);
+        void ReloadChangedFiles();
+        void EvictTextures();
+
         //------------------------------------------------------
         // RESOURCES
-        ResourceMap<Texture>            m_MapTextures{};
-        ResourceMap<Font>               m_MapFonts{};
+        ResourcePool<Texture>           m_Textures{};
+        ResourcePool<Font>              m_Fonts{};
+        // Counts Updates, tells which textures are in use
+        uint64_t                        m_FrameNumber{ 1 };
+
+        // TEXTURE MEMORY
+        ResourceBudget                  m_TextureBudget{};
+
+        // ASSET PACKS
+        std::vector<std::unique_ptr<AssetPack>> m_AssetPacks{};
+
+        // ASYNC TEXTURES
+        std::unique_ptr<TextureCache>   m_pTextureCache{};
+        std::unique_ptr<TextureLoader>  m_pTextureLoader{};
+        std::unordered_map<AssetId, std::vector<std::shared_ptr<AsyncTexture::State>>> m_PendingTextures{};
+        std::vector<TextureLoader::Result> m_LoadedTextures{};
+        std::size_t                     m_MaxTextureUploadsPerFrame{ 4 };
+
+        // HOT RELOAD
+        std::unique_ptr<FileWatcher>    m_pFileWatcher{};
+        // Filled by the watcher thread
+        std::mutex                      m_ChangedFilesMutex{};
+        std::vector<std::filesystem::path> m_ChangedFiles{};
+        std::unordered_set<AssetId>     m_ReloadingTextures{};
 
         // CURRENTLY USED FONT
         Subject<const Font* const>      m_OnFontChange{};
@@ -298,7 +420,7 @@ namespace jela
         const Font*                     m_pCurrentFont{ nullptr };
         TextFormat*                     m_pCurrentTextFormat{ nullptr };
 
-        ResourcePtr<Font>               m_pDefaultFont{};
+        ResourceHandle<Font>            m_DefaultFont{};
         std::unique_ptr<TextFormat>     m_pDefaultTextFormat{ nullptr };
 
         // DATA PATH
@@ -310,7 +432,10 @@ namespace jela
     };
 
     template <typename ResourceType>
-    using ResourcePtr = ResourceManager::ResourcePtr<ResourceType>;
+    using ResourceHandle = ResourceManager::ResourceHandle<ResourceType>;
+    using TextureHandle = ResourceManager::ResourceHandle<Texture>;
+    using FontHandle = ResourceManager::ResourceHandle<Font>;
+    using AsyncTexture = ResourceManager::AsyncTexture;
     //---------------------------------------------------------------
 
 }
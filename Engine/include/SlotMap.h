@@ -0,0 +1,106 @@
+#ifndef SLOTMAP_H
+#define SLOTMAP_H
+
+#include "Defines.h"
+#include <cassert>
+#include <cstdint>
+#include <limits>
+#include <optional>
+#include <utility>
+#include <vector>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // Stores values in reusable slots and hands out keys made of a slot index and a generation.
+    // Insert, erase and lookup are O(1). A slot's generation changes every time its value is erased,
+    // so a key to an erased value never finds the value that reuses the slot.
+    template <typename ValueType>
+    class SlotMap final
+    {
+    public:
+        struct Key
+        {
+            uint32_t index{};
+            // Generations start at 1, a default constructed key never finds anything
+            uint32_t generation{};
+
+            bool operator==(const Key&) const = default;
+        };
+
+        SlotMap() = default;
+
+        template <typename ...Args>
+        Key Emplace(Args&&... args)
+        {
+            uint32_t index{};
+            if (m_FirstFreeSlot != noFreeSlot)
+            {
+                index = m_FirstFreeSlot;
+                m_FirstFreeSlot = m_Slots[index].nextFreeSlot;
+            }
+            else
+            {
+                assert(m_Slots.size() < noFreeSlot && _T("SlotMap ran out of slots"));
+                index = static_cast<uint32_t>(m_Slots.size());
+                m_Slots.emplace_back();
+            }
+
+            Slot& slot{ m_Slots[index] };
+            slot.value.emplace(std::forward<Args>(args)...);
+            ++m_Size;
+            return Key{ index, slot.generation };
+        }
+
+        bool Erase(Key key)
+        {
+            if (!Contains(key)) return false;
+
+            Slot& slot{ m_Slots[key.index] };
+            slot.value.reset();
+            // Skips 0 when it wraps around, that generation belongs to default keys
+            if (++slot.generation == 0) slot.generation = 1;
+            slot.nextFreeSlot = m_FirstFreeSlot;
+            m_FirstFreeSlot = key.index;
+            --m_Size;
+            return true;
+        }
+
+        // Keys handed out before stay invalid
+        void Clear()
+        {
+            for (uint32_t index = 0; index < m_Slots.size(); ++index)
+            {
+                if (m_Slots[index].value) Erase(Key{ index, m_Slots[index].generation });
+            }
+        }
+
+        ValueType* Find(Key key) { return Contains(key) ? &*m_Slots[key.index].value : nullptr; }
+        const ValueType* Find(Key key) const { return Contains(key) ? &*m_Slots[key.index].value : nullptr; }
+
+        bool Contains(Key key) const
+        {
+            return key.index < m_Slots.size() && m_Slots[key.index].generation == key.generation && m_Slots[key.index].value;
+        }
+
+        std::size_t GetSize() const { return m_Size; }
+        bool IsEmpty() const { return m_Size == 0; }
+
+    private:
+        static constexpr uint32_t noFreeSlot{ std::numeric_limits<uint32_t>::max() };
+
+        struct Slot
+        {
+            std::optional<ValueType> value{};
+            uint32_t generation{ 1 };
+            uint32_t nextFreeSlot{ noFreeSlot };
+        };
+
+        std::vector<Slot> m_Slots{};
+        uint32_t m_FirstFreeSlot{ noFreeSlot };
+        std::size_t m_Size{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !SLOTMAP_H
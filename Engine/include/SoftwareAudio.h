@@ -0,0 +1,74 @@
+#ifndef SOFTWAREAUDIO_H
+#define SOFTWAREAUDIO_H
+
+#include "AudioService.h"
+#include "AudioMixer.h"
+#include "AudioOutput.h"
+#include <cstddef>
+#include <functional>
+#include <span>
+
+namespace jela
+{
+    struct SoftwareAudioSettings final
+    {
+        // Returns the data of a file from a mounted asset pack, or nothing when no pack contains it
+        using PackedAssetFinder = std::function<std::span<const std::byte>(const tstring& filename)>;
+
+        uint32_t sampleRate{ 48000 };
+        // 256 frames is 5.3 ms at 48 kHz, how late a call to the service is heard at most on top of what the output buffers
+        uint32_t blockFrameCount{ 256 };
+        uint16_t voiceCount{ 64 };
+        AudioMixer::Resampler resampler{ AudioMixer::Resampler::Polyphase };
+        // Sounds are read from a pack when the finder has them and from this path otherwise.
+        // In the engine these are the resource manager's GetDataPath and FindPackedAsset; without a finder every sound is read from its file.
+        tstring dataPath{};
+        PackedAssetFinder findPackedAsset{};
+    };
+
+    // Mixes every sound itself, on its own thread, and hands the blocks to an AudioOutput.
+    // Doesn't depend on a platform audio API or on the engine, so sounds can be played, recorded and profiled anywhere.
+    // What goes wrong is reported through audio::Log.
+    // Sounds are decoded whole when added, the stream flag is ignored. So is the priority: a sound plays when a voice is free.
+    class SoftwareAudio final : public AudioService
+    {
+    public:
+
+        explicit SoftwareAudio(std::unique_ptr<AudioOutput> pOutput, const SoftwareAudioSettings& settings = {});
+        virtual ~SoftwareAudio();
+
+        SoftwareAudio(const SoftwareAudio&) = delete;
+        SoftwareAudio(SoftwareAudio&&) noexcept = delete;
+        SoftwareAudio& operator= (const SoftwareAudio&) = delete;
+        SoftwareAudio& operator= (SoftwareAudio&&) noexcept = delete;
+
+        virtual void AddSound(const tstring& filename, SoundID id, bool stream = false) override;
+        virtual void RemoveSound(SoundID id) override;
+        virtual void ReloadSound(const tstring& filename) override;
+        virtual void PlaySoundClip(SoundID id, bool repeat, uint8_t volume = 100, float frequency = 1.f, uint8_t priority = 128) const override;
+        virtual void PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume = 100, float frequency = 1.f, uint8_t priority = 128) const override;
+        virtual uint8_t GetMasterVolume() const override;
+        virtual void SetMasterVolume(uint8_t newVolume) override;
+        virtual void IncrementMasterVolume() override;
+        virtual void DecrementMasterVolume() override;
+        virtual void ToggleMute() override;
+        virtual void PauseSound(SoundID id) const override;
+        virtual void PauseSound(SoundID id, const SoundInstanceID& instanceId) const override;
+        virtual void PauseAllSounds() const override;
+        virtual void ResumeSound(SoundID id) const override;
+        virtual void ResumeSound(SoundID id, const SoundInstanceID& instanceId) const override;
+        virtual void ResumeAllSounds() const override;
+        virtual void StopSound(SoundID id) const override;
+        virtual void StopSound(SoundID id, const SoundInstanceID& instanceId) const override;
+        virtual void StopAllSounds() const override;
+        virtual void SeekSound(SoundID id, const SoundInstanceID& instanceId, float seconds) const override;
+        virtual void Update() override;
+
+    private:
+        class AudioImpl;
+        AudioImpl* m_pImpl;
+    };
+
+}
+
+#endif // !SOFTWAREAUDIO_H
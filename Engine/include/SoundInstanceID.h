@@ -0,0 +1,40 @@
+#ifndef SOUNDINSTANCEID_H
+#define SOUNDINSTANCEID_H
+
+#include <cstdint>
+#include <optional>
+#include "Observer.h"
+
+namespace jela
+{
+
+	using SoundID = unsigned int;
+	// Follows the channel an instance plays on, and resets when that channel is released.
+	struct SoundInstanceID final : public Observer<uint8_t>
+	{
+        std::optional<uint8_t> GetID() const { return m_Id; }
+
+        SoundInstanceID() = default;
+
+        //--------------------------------------------------------------
+        // IMPLEMENTED
+
+        virtual ~SoundInstanceID() = default;
+		SoundInstanceID(const SoundInstanceID& other);
+		SoundInstanceID(SoundInstanceID&& other) noexcept;
+		SoundInstanceID& operator= (const SoundInstanceID& other);
+		SoundInstanceID& operator= (SoundInstanceID&& other) noexcept;
+		//--------------------------------------------------------------
+
+		// Subscribes to the released channels of the sound it plays
+		void Init(uint8_t index, Subject<uint8_t>* pOnChannelRelease);
+	private:
+
+		virtual void Notify(uint8_t index) override;
+		virtual void OnSubjectDestroy(Subject<uint8_t>* pSubject) override;
+
+        std::optional<uint8_t> m_Id{};
+	};
+}
+
+#endif // !SOUNDINSTANCEID_H
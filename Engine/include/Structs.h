@@ -3,6 +3,11 @@
 
 #include "Defines.h"
 #include <cassert>
+#include <cfloat>
+#include <cmath>
+#include <cstdint>
+#include <format>
+#include <numbers>
 #include <type_traits>
 
 
@@ -12,15 +17,50 @@ namespace jela
 	template <typename T>
 	concept cArithmetic = std::is_arithmetic_v<T>;
 
+	namespace math
+	{
+		constexpr float Abs(float value)
+		{
+			return value < 0.f ? -value : value;
+		}
+
+		// std::sqrt is not constexpr before C++26, so compile-time evaluation falls back to Newton-Raphson.
+		constexpr float Sqrt(float value)
+		{
+			if (std::is_constant_evaluated())
+			{
+				if (value <= 0.f) return 0.f;
+				double current{ value };
+				double previous{ 0.0 };
+				for (int iteration = 0; iteration < 64 && current != previous; ++iteration)
+				{
+					previous = current;
+					current = 0.5 * (current + value / current);
+				}
+				return static_cast<float>(current);
+			}
+			return std::sqrt(value);
+		}
+	}
+
 	struct Point2f
 	{
 		Point2f() = default;
-		explicit Point2f(float x, float y);
+		explicit constexpr Point2f(float x, float y) :
+			x{ x },
+			y{ y }
+		{}
 		float x;
 		float y;
 
-		bool operator==(const Point2f& rhs) const;
-		bool operator!=(const Point2f& rhs) const;
+		constexpr bool operator==(const Point2f& rhs) const
+		{
+			return (math::Abs(x - rhs.x) < FLT_EPSILON) && (math::Abs(y - rhs.y) < FLT_EPSILON);
+		}
+		constexpr bool operator!=(const Point2f& rhs) const
+		{
+			return !(*this == rhs);
+		}
 	};
 
 
@@ -28,8 +68,18 @@ namespace jela
 	struct Rectf
 	{
 		Rectf() = default;
-		explicit Rectf(float left, float bottom, float width, float height);
-		explicit Rectf(const Point2f& leftBottom, float width, float height);
+		explicit constexpr Rectf(float left, float bottom, float width, float height) :
+			left{ left },
+			bottom{ bottom },
+			width{ width },
+			height{ height }
+		{}
+		explicit constexpr Rectf(const Point2f& leftBottom, float width, float height) :
+			left{ leftBottom.x },
+			bottom{ leftBottom.y },
+			width{ width },
+			height{ height }
+		{}
 
 		float left;
 		float bottom;
@@ -41,8 +91,18 @@ namespace jela
 	{
 	public:
 		Rectf() = default;
-		explicit Rectf(float left, float top, float width, float height);
-		explicit Rectf(const Point2f& leftTop, float width, float height);
+		explicit constexpr Rectf(float left, float top, float width, float height) :
+			left{ left },
+			top{ top },
+			width{ width },
+			height{ height }
+		{}
+		explicit constexpr Rectf(const Point2f& leftTop, float width, float height) :
+			left{ leftTop.x },
+			top{ leftTop.y },
+			width{ width },
+			height{ height }
+		{}
 
 		float left;
 		float top;
@@ -54,8 +114,16 @@ namespace jela
 	struct Ellipsef
 	{
 		Ellipsef() = default;
-		explicit Ellipsef(float xCenter, float yCenter, float xRadius, float yRadius);
-		explicit Ellipsef(const Point2f& center, float xRadius, float yRadius);
+		explicit constexpr Ellipsef(float xCenter, float yCenter, float xRadius, float yRadius) :
+			center{ xCenter, yCenter },
+			radiusX{ xRadius },
+			radiusY{ yRadius }
+		{}
+		explicit constexpr Ellipsef(const Point2f& center, float xRadius, float yRadius) :
+			center{ center },
+			radiusX{ xRadius },
+			radiusY{ yRadius }
+		{}
 
 		Point2f center;
 		float radiusX;
@@ -65,8 +133,14 @@ namespace jela
 	struct Circlef
 	{
 		Circlef() = default;
-		explicit Circlef(float xCenter, float yCenter, float radius);
-		explicit Circlef(const Point2f& center, float radius);
+		explicit constexpr Circlef(float xCenter, float yCenter, float radius) :
+			center{ xCenter, yCenter },
+			rad{ radius }
+		{}
+		explicit constexpr Circlef(const Point2f& center, float radius) :
+			center{ center },
+			rad{ radius }
+		{}
 
 		Point2f center;
 		float rad;
@@ -76,77 +150,168 @@ namespace jela
     struct Vector2f
     {
         Vector2f() = default;
-        Vector2f(float x, float y);
-        Vector2f(const Point2f& endPoint);
-        Vector2f(const Point2f& startPoint, const Point2f& endPoint);
-
-        Vector2f operator-() const;
-		Vector2f operator+() const;
-		Vector2f operator-(const Vector2f& rhs) const;
-		Vector2f operator+(const Vector2f& rhs) const;
-
-        Vector2f& operator+=(const Vector2f& rhs);
-		Vector2f& operator-=(const Vector2f& rhs);
+        constexpr Vector2f(float x, float y) :
+			x{ x },
+			y{ y }
+		{}
+        constexpr Vector2f(const Point2f& endPoint) :
+			x{ endPoint.x },
+			y{ endPoint.y }
+		{}
+        constexpr Vector2f(const Point2f& startPoint, const Point2f& endPoint) :
+			x{ endPoint.x - startPoint.x },
+			y{ endPoint.y - startPoint.y }
+		{}
+
+        constexpr Vector2f operator-() const { return { -x, -y }; }
+		constexpr Vector2f operator+() const { return { x, y }; }
+		constexpr Vector2f operator-(const Vector2f& rhs) const { return { x - rhs.x, y - rhs.y }; }
+		constexpr Vector2f operator+(const Vector2f& rhs) const { return { x + rhs.x, y + rhs.y }; }
+
+        constexpr Vector2f& operator+=(const Vector2f& rhs)
+		{
+			x += rhs.x;
+			y += rhs.y;
+			return *this;
+		}
+		constexpr Vector2f& operator-=(const Vector2f& rhs)
+		{
+			x -= rhs.x;
+			y -= rhs.y;
+			return *this;
+		}
 
-		Vector2f operator*(cArithmetic auto rhs) const
+		constexpr Vector2f operator*(cArithmetic auto rhs) const
 		{
 			return { static_cast<float>(x * rhs), static_cast<float>(y * rhs) };
 		}
-		Vector2f operator/(cArithmetic auto rhs) const
+		constexpr Vector2f operator/(cArithmetic auto rhs) const
 		{
-			assert((std::abs(rhs) > FLT_EPSILON));
+			assert((math::Abs(static_cast<float>(rhs)) > FLT_EPSILON));
 			return { static_cast<float>(x / rhs), static_cast<float>(y / rhs) };
 		}
-		Vector2f& operator*=(cArithmetic auto rhs)
+		constexpr Vector2f& operator*=(cArithmetic auto rhs)
 		{
 			x = static_cast<float>(x * rhs);
 			y = static_cast<float>(y * rhs);
 			return *this;
 		}
-		Vector2f& operator/=(cArithmetic auto rhs)
+		constexpr Vector2f& operator/=(cArithmetic auto rhs)
 		{
-			assert((std::abs(rhs) > FLT_EPSILON));
+			assert((math::Abs(static_cast<float>(rhs)) > FLT_EPSILON));
 			x = static_cast<float>(x / rhs);
 			y = static_cast<float>(y / rhs);
 			return *this;
 		}
 
-		bool operator==(const Vector2f& rhs) const;
-		bool operator!=(const Vector2f& rhs) const;
+		constexpr bool operator==(const Vector2f& rhs) const
+		{
+			return (math::Abs(x - rhs.x) < FLT_EPSILON) && (math::Abs(y - rhs.y) < FLT_EPSILON);
+		}
+		constexpr bool operator!=(const Vector2f& rhs) const
+		{
+			return !(*this == rhs);
+		}
 
-		static float Dot(const Vector2f& first, const Vector2f& second);
-		static float Cross(const Vector2f& first, const Vector2f& second);
-		static float AngleBetween(const Vector2f& first, const Vector2f& second);
-		static Vector2f Reflect(const Vector2f& vector, const Vector2f& surfaceNormal);
+		static constexpr float Dot(const Vector2f& first, const Vector2f& second)
+		{
+			return first.x * second.x + first.y * second.y;
+		}
+		static constexpr float Cross(const Vector2f& first, const Vector2f& second)
+		{
+			return first.x * second.y - first.y * second.x;
+		}
+		static float AngleBetween(const Vector2f& first, const Vector2f& second)
+		{
+			return std::atan2(Cross(first, second), Dot(first, second)) * 180 / std::numbers::pi_v<float>;
+		}
+		static constexpr Vector2f Reflect(const Vector2f& vector, const Vector2f& surfaceNormal)
+		{
+			const Vector2f normal{ surfaceNormal.Normalized() };
+			return vector - normal * (2.f * Dot(vector, normal));
+		}
 
-		tstring	ToString(uint8_t decimalPrecision = 1) const;
+		tstring	ToString(uint8_t decimalPrecision = 1) const
+		{
+			return _T("( ") + std::format(_T("{:.{}f}"), x, decimalPrecision) +
+				_T(", ") + std::format(_T("{:.{}f}"), y, decimalPrecision) + _T(" )");
+		}
 
-		float Length() const;
-		float SquaredLength() const;
+		constexpr float Length() const { return math::Sqrt(x * x + y * y); }
+		constexpr float SquaredLength() const { return x * x + y * y; }
 
-		Vector2f Normalized() const;
-		Vector2f& Normalize();
-		Vector2f Orthogonal() const;
+		constexpr Vector2f Normalized() const
+		{
+			const float l{ Length() };
+			if (l < FLT_EPSILON) return { 0.f, 0.f };
+			return { x / l, y / l };
+		}
+		constexpr Vector2f& Normalize()
+		{
+			const float l{ Length() };
+			if (l < FLT_EPSILON) return *this;
+			*this /= l;
+			return *this;
+		}
+		constexpr Vector2f Orthogonal() const { return { -y, x }; }
 
 
 		float x;
 		float y;
 	};
 
-	Vector2f operator*(cArithmetic auto lhs, Vector2f rhs)
+	constexpr Vector2f operator*(cArithmetic auto lhs, Vector2f rhs)
 	{
 		return rhs * lhs;
 	}
 
-	tostream& operator<< (tostream& lhs, const Vector2f& rhs);
+	inline tostream& operator<< (tostream& lhs, const Vector2f& rhs)
+	{
+		lhs << rhs.ToString();
+		return lhs;
+	}
+
+	constexpr Point2f& operator+=(Point2f& lhs, const Vector2f& rhs)
+	{
+		lhs.x += rhs.x;
+		lhs.y += rhs.y;
+		return lhs;
+	}
+	constexpr Point2f operator+(const Point2f& lhs, const Vector2f& rhs)
+	{
+		return Point2f{ lhs.x + rhs.x, lhs.y + rhs.y };
+	}
+	constexpr Point2f& operator-=(Point2f& lhs, const Vector2f& rhs)
+	{
+		lhs.x -= rhs.x;
+		lhs.y -= rhs.y;
+		return lhs;
+	}
+	constexpr Point2f operator-(const Point2f& lhs, const Vector2f& rhs)
+	{
+		return Point2f{ lhs.x - rhs.x, lhs.y - rhs.y };
+	}
+	constexpr Vector2f operator-(const Point2f& lhs, const Point2f& rhs)
+	{
+		return { lhs.x - rhs.x, lhs.y - rhs.y };
+	}
 
-	Point2f& operator+=(Point2f& lhs, const Vector2f& rhs);
-	Point2f operator+(const Point2f& lhs, const Vector2f& rhs);
-	Point2f& operator-=(Point2f& lhs, const Vector2f& rhs);
-	Point2f operator-(const Point2f& lhs, const Vector2f& rhs);
 
-	Vector2f operator-(const Point2f& lhs, const Point2f& rhs);
+	// The math types are passed around by value, memcpy'd into SoA storage and handed to Direct2D,
+	// so they must stay plain 'float' aggregates without hidden state.
+	template <typename T, std::size_t NrOfFloats>
+	concept cPlainMathType =
+		std::is_trivially_copyable_v<T> &&
+		std::is_trivially_default_constructible_v<T> &&
+		std::is_standard_layout_v<T> &&
+		sizeof(T) == NrOfFloats * sizeof(float) &&
+		alignof(T) == alignof(float);
+
+	static_assert(cPlainMathType<Point2f, 2>);
+	static_assert(cPlainMathType<Vector2f, 2>);
+	static_assert(cPlainMathType<Rectf, 4>);
+	static_assert(cPlainMathType<Ellipsef, 4>);
+	static_assert(cPlainMathType<Circlef, 3>);
 }
 
 #endif // !STRUCTS_H
-
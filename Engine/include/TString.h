@@ -0,0 +1,61 @@
+#ifndef TSTRING_H
+#define TSTRING_H
+
+// The text macros of Defines.h without the Windows headers, for the code that also builds on other platforms
+#ifdef _WIN32
+    #include <tchar.h>
+#else
+    #ifdef _UNICODE
+        #define _T(x)       L##x
+    #else
+        #define _T(x)       x
+    #endif
+#endif
+#include <filesystem>
+#include <string>
+
+
+#ifdef _UNICODE
+    #define tchar			wchar_t
+	#define tstring			std::wstring
+	#define tcin			std::wcin
+	#define tcout			std::wcout
+	#define tstringstream	std::wstringstream
+	#define tofstream		std::wofstream
+	#define tifstream		std::wifstream
+	#define tfstream		std::wfstream
+	#define tostream		std::wostream
+	#define to_tstring		std::to_wstring
+
+	#define tregex			std::wregex
+	#define tcmatch			std::wcmatch
+	#define tsmatch			std::wsmatch
+	#define tcsub_match		std::wcsub_match
+	#define tssub_match		std::wssub_match
+#else
+	#define tchar			char
+	#define tstring			std::string
+	#define tcin			std::cin
+	#define tcout			std::cout
+	#define tstringstream	std::stringstream
+	#define tofstream		std::ofstream
+	#define tifstream		std::ifstream
+	#define tfstream		std::fstream
+	#define tostream		std::ostream
+	#define to_tstring		std::to_string
+
+	#define tregex			std::regex
+	#define tcmatch			std::cmatch
+	#define tsmatch			std::smatch
+	#define tcsub_match		std::csub_match
+	#define tssub_match		std::ssub_match
+#endif
+
+
+static inline std::wstring to_wstring(const tstring& str)
+{
+	std::filesystem::path p{ str };
+	return p.wstring();
+}
+
+#endif // !TSTRING_H
@@ -0,0 +1,97 @@
+#ifndef TEXTURECACHE_H
+#define TEXTURECACHE_H
+
+#include "TextureLoader.h"
+#include <atomic>
+#include <cstdint>
+#include <filesystem>
+#include <optional>
+#include <string_view>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // One file per image, named after its key, all values little-endian:
+    //   Header
+    //   pixels   storedSize bytes, raw or LZ4 block compressed
+    namespace texturecache
+    {
+        inline constexpr uint32_t magic{ 'J' | ('T' << 8) | ('E' << 16) | ('X' << 24) };
+        inline constexpr uint32_t version{ 1 };
+
+        enum class Compression : uint32_t
+        {
+            None,
+            Lz4
+        };
+
+        // A multiple of 16 bytes, so raw pixels are well aligned inside the mapping
+        struct Header
+        {
+            uint32_t magic;
+            uint32_t version;
+            uint64_t key;
+            uint32_t width;
+            uint32_t height;
+            Compression compression;
+            uint32_t reserved;
+            uint64_t pixelsSize;
+            uint64_t storedSize;
+        };
+    }
+
+    namespace utils
+    {
+        // LZ4 block format. Fast rather than small: meant for data that's read far more often than it's written.
+        std::vector<uint8_t> CompressLz4(std::span<const uint8_t> data);
+        // False when source is corrupt or doesn't decompress to exactly destination.size() bytes
+        bool DecompressLz4(std::span<const uint8_t> source, std::span<uint8_t> destination);
+    }
+
+    //---------------------------------------------------------------
+    // Keeps decoded images on disk, so the next run doesn't have to decode them again.
+    // Uncompressed entries are mapped and uploaded in place, compressed ones trade some of that speed for disk space.
+    // Safe to use from several threads at once.
+    class TextureCache final
+    {
+    public:
+        // Creates the directory when it doesn't exist yet
+        explicit TextureCache(const std::filesystem::path& directory, bool isCompressed = false);
+        ~TextureCache() = default;
+
+        TextureCache(const TextureCache&) = delete;
+        TextureCache(TextureCache&&) noexcept = delete;
+        TextureCache& operator= (const TextureCache&) = delete;
+        TextureCache& operator= (TextureCache&&) noexcept = delete;
+
+        // Changes whenever the source does: its path, last write time or size.
+        // name tells apart the images stored inside one source file, like the assets of a pack.
+        // 0 when sourceFile can't be read, those images aren't cached.
+        static uint64_t MakeKey(std::string_view name, const std::filesystem::path& sourceFile);
+
+        // Empty when there is no valid entry for the key
+        std::optional<DecodedImage> Find(uint64_t key) const;
+        // Writes to a temporary file first, so a crash never leaves a half written entry.
+        // A failed write only costs a decode on the next run, so it returns false instead of throwing.
+        bool Store(uint64_t key, const DecodedImage& image) const;
+        // Deletes every entry. Don't call it while images found in the cache are still alive.
+        void Clear();
+
+        const std::filesystem::path& GetDirectory() const { return m_Directory; }
+        bool IsCompressed() const { return m_IsCompressed; }
+        uint64_t GetHitCount() const { return m_HitCount; }
+        uint64_t GetMissCount() const { return m_MissCount; }
+
+    private:
+        std::filesystem::path GetEntryPath(uint64_t key) const;
+
+        std::filesystem::path m_Directory;
+        bool m_IsCompressed;
+
+        mutable std::atomic<uint64_t> m_HitCount{};
+        mutable std::atomic<uint64_t> m_MissCount{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !TEXTURECACHE_H
@@ -0,0 +1,112 @@
+#ifndef TEXTURELOADER_H
+#define TEXTURELOADER_H
+
+#include "Defines.h"
+#include "MappedFile.h"
+#include <cstdint>
+#include <deque>
+#include <functional>
+#include <limits>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <vector>
+
+namespace jela
+{
+    class ThreadPool;
+
+    enum class LoadPriority : uint8_t
+    {
+        Low,
+        Normal,
+        High
+    };
+
+    enum class LoadStatus : uint8_t
+    {
+        Pending,
+        Ready,
+        Failed
+    };
+
+    // 32 bits per pixel, premultiplied BGRA, rows tightly packed (width * 4 bytes per row).
+    struct DecodedImage
+    {
+        uint32_t width{};
+        uint32_t height{};
+        std::vector<uint8_t> pixels{};
+
+        // Set instead of pixels when the image is read in place from a mapped file, which stays mapped as long as this lives
+        std::shared_ptr<const MappedFile> pMappedFile{};
+        std::span<const uint8_t> mappedPixels{};
+
+        std::span<const uint8_t> GetPixels() const { return pMappedFile ? mappedPixels : std::span<const uint8_t>{ pixels }; }
+    };
+
+    //---------------------------------------------------------------
+    // Decodes image files on worker threads, highest priority first.
+    // Has no knowledge of the graphics device: the owner collects the finished images on its own thread
+    // and uploads them from there.
+    class TextureLoader final
+    {
+    public:
+        // Runs on a worker thread with the file that was requested.
+        // Signals an unreadable file by throwing, preferably a FileException.
+        using Decoder = std::function<DecodedImage(const tstring& file)>;
+
+        struct Result
+        {
+            tstring file{};
+            DecodedImage image{};
+            // Empty when the decode succeeded
+            std::string error{};
+        };
+
+        // By default uses half of the hardware threads, so decoding doesn't starve the game.
+        explicit TextureLoader(Decoder decoder);
+        TextureLoader(Decoder decoder, uint32_t nrOfThreads);
+        // Drops the queued requests and waits for the ones being decoded.
+        ~TextureLoader();
+
+        TextureLoader(const TextureLoader&) = delete;
+        TextureLoader(TextureLoader&&) noexcept = delete;
+        TextureLoader& operator= (const TextureLoader&) = delete;
+        TextureLoader& operator= (TextureLoader&&) noexcept = delete;
+
+        // A file that is queued, being decoded or waiting to be collected isn't decoded twice;
+        // requesting a queued file again only raises its priority when the new one is higher.
+        void Request(const tstring& file, LoadPriority priority = LoadPriority::Normal);
+
+        // Moves at most maxResults finished decodes to the back of results, in order of completion.
+        std::size_t Collect(std::vector<Result>& results, std::size_t maxResults = std::numeric_limits<std::size_t>::max());
+
+        // Requests that are queued or being decoded
+        std::size_t GetPendingCount() const;
+
+    private:
+        struct Job
+        {
+            tstring file;
+            LoadPriority priority;
+            uint64_t sequence;
+        };
+        static bool IsLowerPriority(const Job& lhs, const Job& rhs);
+
+        void RunNextJob();
+
+        Decoder m_Decoder;
+
+        mutable std::mutex m_Mutex{};
+        // Max-heap ordered by IsLowerPriority
+        std::vector<Job> m_Jobs{};
+        std::deque<Result> m_Results{};
+        std::vector<tstring> m_DecodingFiles{};
+        uint64_t m_NextSequence{};
+
+        std::unique_ptr<ThreadPool> m_pThreadPool;
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !TEXTURELOADER_H
@@ -0,0 +1,60 @@
+#ifndef THREADPOOL_H
+#define THREADPOOL_H
+
+#include <condition_variable>
+#include <cstdint>
+#include <functional>
+#include <future>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <type_traits>
+#include <vector>
+
+namespace jela
+{
+    class ThreadPool final
+    {
+    public:
+        // By default one thread per hardware thread, minus the one the game runs on.
+        ThreadPool();
+        explicit ThreadPool(uint32_t nrOfThreads);
+        ~ThreadPool();
+
+        ThreadPool(const ThreadPool&) = delete;
+        ThreadPool(ThreadPool&&) noexcept = delete;
+        ThreadPool& operator= (const ThreadPool&) = delete;
+        ThreadPool& operator= (ThreadPool&&) noexcept = delete;
+
+        template <typename Func>
+        std::future<std::invoke_result_t<Func>> Enqueue(Func&& task)
+        {
+            using ReturnType = std::invoke_result_t<Func>;
+
+            // std::function needs a copyable target, so the packaged_task is shared.
+            auto pTask = std::make_shared<std::packaged_task<ReturnType()>>(std::forward<Func>(task));
+            std::future<ReturnType> future = pTask->get_future();
+            Push([pTask]() { (*pTask)(); });
+            return future;
+        }
+
+        // Splits [0, count) in chunks of at most grainSize elements and runs them on the pool.
+        // The calling thread helps out and the function only returns once every chunk is done.
+        // When a chunk throws, the chunks that haven't started are skipped and the first exception is rethrown here, on the calling thread.
+        void ParallelFor(std::size_t count, std::size_t grainSize, const std::function<void(std::size_t begin, std::size_t end)>& task);
+
+        uint32_t GetNrOfThreads() const { return static_cast<uint32_t>(m_Threads.size()); }
+
+    private:
+        void Push(std::function<void()>&& task);
+        void WorkerLoop(std::stop_token stopToken);
+
+        std::vector<std::jthread> m_Threads{};
+        std::queue<std::function<void()>> m_Tasks{};
+        std::mutex m_TasksMutex{};
+        std::condition_variable_any m_TasksCondition{};
+    };
+}
+
+#endif // !THREADPOOL_H
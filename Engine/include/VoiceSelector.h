@@ -0,0 +1,88 @@
+#ifndef VOICESELECTOR_H
+#define VOICESELECTOR_H
+
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+namespace jela
+{
+    // Which of the sounds of the lowest priority loses its voice when more sounds play than there are voices.
+    // A sound of a higher priority always takes the voice of a lower one.
+    enum class VoiceStealPolicy : uint8_t
+    {
+        // None of them: a sound only takes the voice of one of a lower priority
+        LowestPriority,
+        // The one played at the lowest volume
+        Quietest,
+        // The one that started longest ago, so the newest sounds are always heard
+        Oldest
+    };
+
+    // Where frame of a sound plays: wrapped into the loop when looping and at or past the loop's end, clamped to the last frame otherwise.
+    // loopEnd is exclusive. Like XAudio2's buffers, frames before the loop's end play as they are.
+    uint64_t ResolveFrame(uint64_t frame, uint64_t frameCount, bool isLooping, uint64_t loopBegin, uint64_t loopEnd);
+
+    //---------------------------------------------------------------
+    // Follows the frame a sound is at from the time that passes, for a sound that plays without a voice to ask.
+    class VoiceTimeline final
+    {
+    public:
+        using Clock = std::chrono::steady_clock;
+
+        // framesPerSecond is the sample rate times the frequency ratio
+        void Start(uint64_t frame, double framesPerSecond, Clock::time_point now);
+        void Seek(uint64_t frame, Clock::time_point now);
+        void Pause(Clock::time_point now);
+        void Resume(Clock::time_point now);
+
+        // Keeps counting past the end of the sound, ResolveFrame wraps it into the loop
+        uint64_t GetFrame(Clock::time_point now) const;
+        bool IsPaused() const { return m_IsPaused; }
+
+    private:
+        Clock::time_point m_StartTime{};
+        uint64_t m_StartFrame{};
+        double m_FramesPerSecond{};
+        bool m_IsPaused{};
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Decides which of the sounds that play get one of the few voices to be heard on, the others play on virtually.
+    // Paused sounds come last whatever the policy, they have nothing to be heard.
+    class VoiceSelector final
+    {
+    public:
+        struct Candidate
+        {
+            // Whatever the caller finds the sound back by
+            uint32_t voice;
+            uint8_t priority;
+            float volume;
+            // Higher for sounds played later
+            uint64_t playOrder;
+            bool isPaused;
+            // Whether it has a voice now. Wins ties, so sounds of the same rank don't swap voices every update.
+            bool isAudible;
+        };
+
+        explicit VoiceSelector(VoiceStealPolicy policy = VoiceStealPolicy::LowestPriority) : m_Policy{ policy } {}
+
+        void SetPolicy(VoiceStealPolicy policy) { m_Policy = policy; }
+        VoiceStealPolicy GetPolicy() const { return m_Policy; }
+
+        // Whether lhs gets a voice before rhs
+        bool Outranks(const Candidate& lhs, const Candidate& rhs) const;
+        // Moves the voiceCount candidates that get a voice to the front, in no particular order, and returns them.
+        // Linear in the number of candidates on average.
+        std::span<Candidate> Select(std::span<Candidate> candidates, std::size_t voiceCount) const;
+
+    private:
+        VoiceStealPolicy m_Policy;
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !VOICESELECTOR_H
@@ -0,0 +1,95 @@
+#ifndef WAVEFILE_H
+#define WAVEFILE_H
+
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jela
+{
+    //---------------------------------------------------------------
+    // The fields of a fmt chunk
+    struct WaveFormat
+    {
+        static constexpr uint16_t pcm{ 0x0001 };
+        static constexpr uint16_t adpcm{ 0x0002 };
+        static constexpr uint16_t ieeeFloat{ 0x0003 };
+        static constexpr uint16_t imaAdpcm{ 0x0011 };
+        static constexpr uint16_t extensible{ 0xFFFE };
+
+        // For WAVE_FORMAT_EXTENSIBLE the tag of its sub format, so extensible PCM simply reads as PCM
+        uint16_t formatTag{};
+        uint16_t channelCount{};
+        uint32_t sampleRate{};
+        uint32_t bytesPerSecond{};
+        // Bytes per frame of all channels, or per compressed block
+        uint16_t blockAlign{};
+        uint16_t bitsPerSample{};
+
+        bool isExtensible{};
+        // Only set by WAVE_FORMAT_EXTENSIBLE
+        uint16_t validBitsPerSample{};
+        uint32_t channelMask{};
+
+        // What follows cbSize for compressed formats, like ADPCM's coefficients. A view into the file.
+        std::span<const std::byte> extraData{};
+
+        // The frames an IMA ADPCM block of blockAlign bytes holds, 0 when it is too small for its headers.
+        // Taken from the block size rather than the extra data, which writers may leave out.
+        uint32_t GetImaFramesPerBlock() const;
+    };
+
+    // A loop of a smpl chunk, in frames
+    struct WaveLoop
+    {
+        uint32_t begin{};
+        // The last frame of the loop, not the one after it
+        uint32_t end{};
+        // 0 loops forever
+        uint32_t playCount{};
+    };
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Reads a RIFF/WAVE file that is in memory or mapped, walking its chunks once.
+    // The chunks are views into the data, which has to outlive the WaveFile; only the format fields and loops are copied out.
+    // Doesn't depend on the platform. Unknown chunks are skipped, of chunks that appear twice the first one counts.
+    class WaveFile final
+    {
+    public:
+        // Throws a FileTypeNotSupportedException when data isn't RIFF/WAVE, or a FileLoadException when it is corrupt
+        explicit WaveFile(std::span<const std::byte> data);
+        ~WaveFile() = default;
+
+        WaveFile(const WaveFile&) = default;
+        WaveFile(WaveFile&&) noexcept = default;
+        WaveFile& operator= (const WaveFile&) = default;
+        WaveFile& operator= (WaveFile&&) noexcept = default;
+
+        const WaveFormat& GetFormat() const { return m_Format; }
+        // Cut to whole blocks. A data chunk that runs past the end of the file, as left by writers that were cut off, ends with the file.
+        std::span<const std::byte> GetData() const { return m_Data; }
+        // Frames of samples of all channels, which for IMA ADPCM are the samples its blocks hold rather than the blocks
+        uint64_t GetFrameCount() const;
+
+        std::span<const std::byte> GetFormatChunk() const { return m_FormatChunk; }
+        // Empty when the file has none
+        std::span<const std::byte> GetSamplerChunk() const { return m_SamplerChunk; }
+        // The loops of the smpl chunk that lie within the data
+        const std::vector<WaveLoop>& GetLoops() const { return m_Loops; }
+
+    private:
+        void ReadFormat(std::span<const std::byte> chunk);
+        void ReadLoops(std::span<const std::byte> chunk);
+
+        WaveFormat m_Format{};
+        std::span<const std::byte> m_FormatChunk{};
+        std::span<const std::byte> m_Data{};
+        std::span<const std::byte> m_SamplerChunk{};
+        std::vector<WaveLoop> m_Loops{};
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !WAVEFILE_H
@@ -0,0 +1,62 @@
+#include "AssetId.h"
+#include <cassert>
+#include <format>
+#include <mutex>
+#include <unordered_map>
+
+namespace jela
+{
+#ifdef _DEBUG
+    namespace
+    {
+        struct NameTable
+        {
+            std::mutex mutex{};
+            std::unordered_map<uint64_t, std::string> names{};
+        };
+
+        NameTable& GetNameTable()
+        {
+            static NameTable table{};
+            return table;
+        }
+
+        template <typename CharType>
+        void RememberNameImpl(std::basic_string_view<CharType> name)
+        {
+            // Stored the way it was hashed, so the same name written with the other separator doesn't count as a collision
+            std::string utf8Name{};
+            utils::ForEachAssetNameByte(name, [&utf8Name](uint8_t byte) { utf8Name += static_cast<char>(byte); });
+            const uint64_t value{ utils::HashAssetName(name) };
+
+            NameTable& table{ GetNameTable() };
+            const std::lock_guard<std::mutex> lock{ table.mutex };
+
+            const auto [it, isAdded] = table.names.try_emplace(value, utf8Name);
+            assert((isAdded || it->second == utf8Name) && "Two asset names share the same AssetId, rename one of them");
+        }
+    }
+
+    void AssetId::RememberName(std::string_view name)
+    {
+        RememberNameImpl(name);
+    }
+
+    void AssetId::RememberName(std::wstring_view name)
+    {
+        RememberNameImpl(name);
+    }
+#endif // _DEBUG
+
+    std::string AssetId::GetName() const
+    {
+#ifdef _DEBUG
+        {
+            NameTable& table{ GetNameTable() };
+            const std::lock_guard<std::mutex> lock{ table.mutex };
+            if (const auto it = table.names.find(m_Value); it != table.names.end()) return it->second;
+        }
+#endif // _DEBUG
+        return std::format("#{:016x}", m_Value);
+    }
+}
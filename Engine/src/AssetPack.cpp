@@ -0,0 +1,254 @@
+#include "AssetPack.h"
+#include "FileExceptions.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <fstream>
+
+namespace jela
+{
+    static_assert(std::endian::native == std::endian::little, "Pack files are read in place and stored little-endian.");
+
+    namespace
+    {
+        constexpr uint64_t AlignBlob(uint64_t offset)
+        {
+            return (offset + pack::blobAlignment - 1) / pack::blobAlignment * pack::blobAlignment;
+        }
+    }
+
+    namespace utils
+    {
+        std::string NormalizeAssetName(const std::filesystem::path& name)
+        {
+            const std::u8string normalized{ name.lexically_normal().generic_u8string() };
+            return std::string{ reinterpret_cast<const char*>(normalized.data()), normalized.size() };
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------------------
+    //---------------------
+    //AssetPack
+    //---------------------
+
+    AssetPack::AssetPack(const std::filesystem::path& packPath) :
+        m_File{ packPath }
+    {
+        const std::span<const std::byte> data{ m_File.GetData() };
+
+        pack::Header header{};
+        if (data.size() < sizeof(header))
+            throw FileLoadException{ std::format("\"{}\" is too small to be an asset pack.\n", packPath.string()) };
+        std::memcpy(&header, data.data(), sizeof(header));
+
+        if (header.magic != pack::magic || header.version != pack::version)
+            throw FileLoadException{ std::format("\"{}\" is not an asset pack of version {}.\n", packPath.string(), pack::version) };
+
+        const uint64_t indexSize{ header.entryCount * sizeof(pack::Entry) };
+        if (header.entryCount > data.size() / sizeof(pack::Entry) ||
+            header.namesOffset < sizeof(header) + indexSize ||
+            header.namesOffset > data.size() || header.namesSize > data.size() - header.namesOffset)
+            throw FileLoadException{ std::format("Index of asset pack \"{}\" is corrupt.\n", packPath.string()) };
+
+        // The header is a multiple of 8 bytes, so the entries are correctly aligned inside the mapping
+        m_Entries = { reinterpret_cast<const pack::Entry*>(data.data() + sizeof(header)), static_cast<std::size_t>(header.entryCount) };
+        m_Names = { reinterpret_cast<const char*>(data.data() + header.namesOffset), static_cast<std::size_t>(header.namesSize) };
+
+        for (std::size_t index = 0; index < m_Entries.size(); ++index)
+        {
+            const pack::Entry& entry{ m_Entries[index] };
+            const bool isInside{ static_cast<uint64_t>(entry.nameOffset) + entry.nameSize <= m_Names.size() &&
+                                 entry.offset <= data.size() && entry.size <= data.size() - entry.offset };
+
+            // Lookups rely on the order, and on the ids being unique
+            if (!isInside || (index > 0 && m_Entries[index - 1].hash >= entry.hash))
+                throw FileLoadException{ std::format("Entry {} of asset pack \"{}\" is corrupt.\n", index, packPath.string()) };
+        }
+    }
+
+    std::span<const std::byte> AssetPack::Find(std::string_view name) const
+    {
+        const pack::Entry* pEntry{ FindEntry(name) };
+        if (!pEntry) return {};
+        return m_File.GetData().subspan(static_cast<std::size_t>(pEntry->offset), static_cast<std::size_t>(pEntry->size));
+    }
+
+    std::span<const std::byte> AssetPack::Find(AssetId id) const
+    {
+        const pack::Entry* pEntry{ FindEntry(id) };
+        if (!pEntry) return {};
+        return m_File.GetData().subspan(static_cast<std::size_t>(pEntry->offset), static_cast<std::size_t>(pEntry->size));
+    }
+
+    std::string_view AssetPack::FindName(AssetId id) const
+    {
+        const pack::Entry* pEntry{ FindEntry(id) };
+        if (!pEntry) return {};
+        return m_Names.substr(pEntry->nameOffset, pEntry->nameSize);
+    }
+
+    std::string_view AssetPack::GetAssetName(std::size_t index) const
+    {
+        const pack::Entry& entry{ m_Entries[index] };
+        return m_Names.substr(entry.nameOffset, entry.nameSize);
+    }
+
+    std::span<const std::byte> AssetPack::GetAssetData(std::size_t index) const
+    {
+        const pack::Entry& entry{ m_Entries[index] };
+        return m_File.GetData().subspan(static_cast<std::size_t>(entry.offset), static_cast<std::size_t>(entry.size));
+    }
+
+    const pack::Entry* AssetPack::FindEntry(std::string_view name) const
+    {
+        // A name that isn't packed could still share its id with one that is
+        const pack::Entry* pEntry{ FindEntry(AssetId::FromValue(utils::HashAssetName(name))) };
+        if (pEntry && m_Names.substr(pEntry->nameOffset, pEntry->nameSize) != name) return nullptr;
+        return pEntry;
+    }
+
+    const pack::Entry* AssetPack::FindEntry(AssetId id) const
+    {
+        const auto it = std::ranges::lower_bound(m_Entries, id.GetValue(), {}, &pack::Entry::hash);
+        return it != m_Entries.end() && it->hash == id.GetValue() ? &*it : nullptr;
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------------------
+
+
+    //---------------------------------------------------------------------------------------------------------------------------------
+    //---------------------
+    //AssetPackWriter
+    //---------------------
+
+    void AssetPackWriter::AddFile(const std::filesystem::path& name, const std::filesystem::path& filePath)
+    {
+        m_Assets.emplace_back(PendingAsset{ utils::NormalizeAssetName(name), filePath, {} });
+    }
+
+    void AssetPackWriter::AddData(const std::filesystem::path& name, std::vector<std::byte> data)
+    {
+        m_Assets.emplace_back(PendingAsset{ utils::NormalizeAssetName(name), {}, std::move(data) });
+    }
+
+    void AssetPackWriter::AddDirectory(const std::filesystem::path& directory)
+    {
+        if (!std::filesystem::is_directory(directory))
+            throw FileNotFoundException{ std::format("Directory \"{}\" does not exist. Error occurred when adding it to an asset pack.\n", directory.string()) };
+
+        for (const std::filesystem::directory_entry& entry : std::filesystem::recursive_directory_iterator{ directory })
+        {
+            if (entry.is_regular_file()) AddFile(entry.path().lexically_relative(directory), entry.path());
+        }
+    }
+
+    void AssetPackWriter::Write(const std::filesystem::path& packPath) const
+    {
+        struct Layout
+        {
+            const PendingAsset* pAsset;
+            pack::Entry entry;
+        };
+
+        std::vector<Layout> layout{};
+        layout.reserve(m_Assets.size());
+
+        uint64_t namesSize{};
+        for (const PendingAsset& asset : m_Assets)
+        {
+            uint64_t size{ asset.data.size() };
+            if (!asset.filePath.empty())
+            {
+                std::error_code error{};
+                size = std::filesystem::file_size(asset.filePath, error);
+                if (error)
+                    throw FileNotFoundException{ std::format("File \"{}\" could not be read. Error occurred when writing an asset pack.\n", asset.filePath.string()) };
+            }
+
+            layout.emplace_back(Layout{ &asset, pack::Entry{ utils::HashAssetName(asset.name), 0, size, static_cast<uint32_t>(namesSize), static_cast<uint32_t>(asset.name.size()) } });
+            namesSize += asset.name.size();
+        }
+
+        std::ranges::sort(layout, {}, [](const Layout& asset) { return asset.entry.hash; });
+
+        // Assets are looked up by id alone, so ids have to be unique as well
+        for (std::size_t index = 1; index < layout.size(); ++index)
+        {
+            const std::string& previousName{ layout[index - 1].pAsset->name };
+            const std::string& name{ layout[index].pAsset->name };
+            if (layout[index - 1].entry.hash != layout[index].entry.hash) continue;
+
+            if (previousName == name)
+                throw FileException{ std::format("Asset \"{}\" was added to the pack twice.\n", name) };
+            throw FileException{ std::format("Assets \"{}\" and \"{}\" have the same AssetId {:016x}, rename one of them.\n",
+                                             previousName, name, layout[index].entry.hash) };
+        }
+
+        // Names are stored in sorted order too, so neighbouring lookups touch neighbouring memory
+        std::string names{};
+        names.reserve(static_cast<std::size_t>(namesSize));
+        for (Layout& asset : layout)
+        {
+            asset.entry.nameOffset = static_cast<uint32_t>(names.size());
+            names += asset.pAsset->name;
+        }
+
+        const pack::Header header{ pack::magic, pack::version, layout.size(), sizeof(pack::Header) + layout.size() * sizeof(pack::Entry), names.size() };
+
+        uint64_t offset{ header.namesOffset + header.namesSize };
+        for (Layout& asset : layout)
+        {
+            asset.entry.offset = AlignBlob(offset);
+            offset = asset.entry.offset + asset.entry.size;
+        }
+
+        std::filesystem::path temporaryPath{ packPath };
+        temporaryPath += ".tmp";
+        {
+            std::ofstream output{ temporaryPath, std::ios_base::binary | std::ios_base::trunc };
+            if (!output.is_open())
+                throw FileLoadException{ std::format("\"{}\" could not be opened for writing.\n", temporaryPath.string()) };
+
+            output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            for (const Layout& asset : layout)
+                output.write(reinterpret_cast<const char*>(&asset.entry), sizeof(asset.entry));
+            output.write(names.data(), static_cast<std::streamsize>(names.size()));
+
+            std::vector<char> buffer(1 << 16);
+            uint64_t written{ header.namesOffset + header.namesSize };
+            for (const Layout& asset : layout)
+            {
+                const std::vector<char> padding(static_cast<std::size_t>(asset.entry.offset - written), 0);
+                output.write(padding.data(), static_cast<std::streamsize>(padding.size()));
+
+                if (asset.pAsset->filePath.empty())
+                {
+                    output.write(reinterpret_cast<const char*>(asset.pAsset->data.data()), static_cast<std::streamsize>(asset.pAsset->data.size()));
+                }
+                else
+                {
+                    std::ifstream input{ asset.pAsset->filePath, std::ios_base::binary };
+                    uint64_t remaining{ asset.entry.size };
+                    while (input && remaining > 0)
+                    {
+                        const std::size_t chunk{ static_cast<std::size_t>(std::min<uint64_t>(remaining, buffer.size())) };
+                        input.read(buffer.data(), static_cast<std::streamsize>(chunk));
+                        output.write(buffer.data(), input.gcount());
+                        remaining -= static_cast<uint64_t>(input.gcount());
+                    }
+                    if (remaining > 0)
+                        throw FileLoadException{ std::format("File \"{}\" could not be read completely. Error occurred when writing an asset pack.\n", asset.pAsset->filePath.string()) };
+                }
+
+                written = asset.entry.offset + asset.entry.size;
+            }
+
+            if (!output.flush())
+                throw FileLoadException{ std::format("Writing asset pack \"{}\" failed.\n", temporaryPath.string()) };
+        }
+
+        std::filesystem::rename(temporaryPath, packPath);
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------------------
+}
@@ -1,13 +1,21 @@
 #include "Engine.h"
 #include "CPlayer.h"
 #include "framework.h"
+#include "MpscQueue.h"
 #include <map>
-#include <queue>
 #include <memory>
+#include <optional>
 #include <functional>
 #include <thread>
 #include <mutex>
+#include <chrono>
+#include <atomic>
+#include <algorithm>
+#include <condition_variable>
+#include <deque>
+#include <vector>
 #include <ranges>
+#include <filesystem>
 
 namespace jela
 {
@@ -85,6 +93,10 @@ namespace jela
 		{
 			return m_Exists;
 		}
+		const tstring& GetFilePath() const
+		{
+			return m_FilePath;
+		}
 	private:
 
 		void OpenFile(const tstring& fileName)
@@ -106,8 +118,13 @@ namespace jela
 	class Audio::AudioImpl final
 	{
 	public:
-		AudioImpl() { m_Thread = std::jthread{ &Audio::AudioImpl::HandleRequests, this }; }
-		~AudioImpl() { m_ServiceIsActive = false; }
+		AudioImpl() { m_Thread = std::jthread{ [this](std::stop_token stopToken) { HandleRequests(stopToken); } }; }
+		~AudioImpl()
+		{
+			// Wakes the thread if it's waiting, events still in the queue are dropped
+			m_Thread.request_stop();
+			m_Thread.join();
+		}
 
 		AudioImpl(const AudioImpl&) = delete;
 		AudioImpl(AudioImpl&&) noexcept = delete;
@@ -116,19 +133,19 @@ namespace jela
 
 		void AddSoundImpl(const tstring& filename, SoundID id)
 		{
-
-			std::lock_guard<std::mutex> lck{ m_EventsMutex };
-			m_Events.push(QueueInfo{ .id{id}, .playBackEvent{Event::Add}, .filename{ENGINE.ResourceMngr()->GetDataPath() + filename} });
+			PushEvent(QueueInfo{ .id{id}, .playBackEvent{Event::Add} }, ENGINE.ResourceMngr()->GetDataPath() + filename);
 		}
 		void RemoveSoundImpl(SoundID id)
 		{
-			std::lock_guard<std::mutex> lck{ m_EventsMutex };
-			m_Events.push(QueueInfo{ .id{id}, .playBackEvent{Event::Remove} });
+			PushEvent(QueueInfo{ .id{id}, .playBackEvent{Event::Remove} });
+		}
+		void ReloadSoundImpl(const tstring& filename)
+		{
+			PushEvent(QueueInfo{ .playBackEvent{Event::Reload} }, ENGINE.ResourceMngr()->GetDataPath() + filename);
 		}
 		void PlaySoundClipImpl(SoundID id, bool repeat)
 		{
-			std::lock_guard<std::mutex> lck{ m_EventsMutex };
-			m_Events.push(QueueInfo{ .repeat{repeat}, .id{id}, .playBackEvent{Event::Play} });
+			PushEvent(QueueInfo{ .repeat{repeat}, .id{id}, .playBackEvent{Event::Play} });
 		}
 		uint8_t GetMasterVolumeImpl() const
 		{
@@ -175,33 +192,27 @@ namespace jela
 		}
 		void PauseSoundImpl(SoundID id)
 		{
-			std::lock_guard<std::mutex> lck{ m_EventsMutex };
-			m_Events.push(QueueInfo{ .id{id}, .playBackEvent{Event::Pause} });
+			PushEvent(QueueInfo{ .id{id}, .playBackEvent{Event::Pause} });
 		}
 		void PauseAllSoundsImpl()
 		{
-			std::lock_guard<std::mutex> lck{ m_EventsMutex };
-			m_Events.push(QueueInfo{ .allSounds{true}, .playBackEvent{ Event::Pause } });
+			PushEvent(QueueInfo{ .allSounds{true}, .playBackEvent{ Event::Pause } });
 		}
 		void ResumeSoundImpl(SoundID id)
 		{
-			std::lock_guard<std::mutex> lck{ m_EventsMutex };
-			m_Events.push(QueueInfo{ .id{id}, .playBackEvent{Event::Resume} });
+			PushEvent(QueueInfo{ .id{id}, .playBackEvent{Event::Resume} });
 		}
 		void ResumeAllSoundsImpl()
 		{
-			std::lock_guard<std::mutex> lck{ m_EventsMutex };
-			m_Events.push(QueueInfo{ .allSounds{true}, .playBackEvent{ Event::Resume } });
+			PushEvent(QueueInfo{ .allSounds{true}, .playBackEvent{ Event::Resume } });
 		}
 		void StopSoundImpl(SoundID id)
 		{
-			std::lock_guard<std::mutex> lck{ m_EventsMutex };
-			m_Events.push(QueueInfo{ .id{id}, .playBackEvent{Event::Stop} });
+			PushEvent(QueueInfo{ .id{id}, .playBackEvent{Event::Stop} });
 		}
 		void StopAllSoundsImpl()
 		{
-			std::lock_guard<std::mutex> lck{ m_EventsMutex };
-			m_Events.push(QueueInfo{ .allSounds{true}, .playBackEvent{ Event::Stop } });
+			PushEvent(QueueInfo{ .allSounds{true}, .playBackEvent{ Event::Stop } });
 		}
 
 	private:
@@ -214,7 +225,8 @@ namespace jela
 			Play,
 			Pause,
 			Resume,
-			Stop
+			Stop,
+			Reload
 		};
 
 		struct AudioInfo
@@ -223,26 +235,115 @@ namespace jela
 			bool repeat{};
 		};
 
+		// Plain data, so it can go through the lock-free queue
 		struct QueueInfo
 		{
 			bool repeat{ false };
 			bool allSounds{ false };
 			SoundID id{};
 			Event playBackEvent{};
-			tstring filename{};
+			// Key of the filename of Add and Reload in m_Filenames
+			uint32_t filenameKey{};
+		};
+
+		// A Play whose file is still being opened, with the events for the same sound that came after it
+		struct PendingPlay
+		{
+			QueueInfo play{};
+			std::chrono::steady_clock::time_point since{};
+			std::vector<QueueInfo> heldEvents{};
 		};
 
+		// How often a Play checks whether its file has been opened, and how long until it gives up
+		static constexpr std::chrono::milliseconds m_ReadyPollInterval{ 5 };
+		static constexpr std::chrono::seconds m_ReadyTimeout{ 5 };
+
 		//std::map<SoundID,AudioInfo> m_pMapMusicClips{};
-		std::queue<QueueInfo> m_Events{};
-		std::jthread m_Thread;
-		mutable std::mutex m_EventsMutex;
+		// Pushed to by any thread, only the request thread pops
+		MpscQueue<QueueInfo, 1024> m_Events{};
+
+		// Where Add, Remove, Reload and Stop go when the queue is full, they can't be dropped without the sounds going out of sync.
+		// While it holds events every push goes here, so they stay in order. Only locked once the queue has overflowed.
+		std::mutex m_OverflowMutex{};
+		std::vector<QueueInfo> m_OverflowEvents{};
+		std::atomic<bool> m_IsOverflowing{ false };
+
+		// Filenames don't fit in the queue. Only adding and reloading, which read files anyway, lock this.
+		std::mutex m_FilenamesMutex{};
+		std::map<uint32_t, tstring> m_Filenames{};
+		uint32_t m_NextFilenameKey{};
+
+		// Only waited on with the stop token while a Play is pending, nothing else notifies it
+		std::mutex m_ReadyMutex{};
+		std::condition_variable_any m_ReadyCondition{};
 
-		bool m_ServiceIsActive{ true };
-		bool m_IsMute{ false };
+		// Request thread only
+		std::vector<PendingPlay> m_PendingPlays{};
+		// An event for all sounds, or a reload, that waits until every pending Play is resolved
+		std::optional<QueueInfo> m_BlockedEvent{};
+
+		std::atomic<bool> m_IsMute{ false };
+
+		// Last, so it has stopped before the members it uses are destroyed
+		std::jthread m_Thread;
 
 
 		// PRIVATE FUNCTIONS
-		void HandleRequests();
+		static bool IsTransient(Event event)
+		{
+			return event == Event::Play || event == Event::Pause || event == Event::Resume;
+		}
+		void PushEvent(const QueueInfo& info)
+		{
+			// Never blocks the caller while the queue has room
+			if (not m_IsOverflowing.load(std::memory_order_acquire))
+			{
+				if (m_Events.TryPush(info)) return;
+
+				// Only matters now, when the request thread is this far behind it is dropped
+				if (IsTransient(info.playBackEvent))
+				{
+					OutputDebugString((_T("\nThe audio event queue is full, dropped an event. ID: ") + to_tstring(info.id) + _T('\n')).c_str());
+					return;
+				}
+			}
+
+			{
+				std::lock_guard<std::mutex> lck{ m_OverflowMutex };
+				m_OverflowEvents.push_back(info);
+				m_IsOverflowing.store(true, std::memory_order_seq_cst);
+			}
+			m_Events.Wake();
+		}
+		void PushEvent(QueueInfo info, tstring&& filename)
+		{
+			{
+				std::lock_guard<std::mutex> lck{ m_FilenamesMutex };
+				info.filenameKey = m_NextFilenameKey++;
+				m_Filenames.emplace(info.filenameKey, std::move(filename));
+			}
+			PushEvent(info);
+		}
+		// Request thread. Moves the overflowed events to events, false when there were none.
+		bool TakeOverflowEvents(std::deque<QueueInfo>& events)
+		{
+			if (not m_IsOverflowing.load(std::memory_order_acquire)) return false;
+
+			std::lock_guard<std::mutex> lck{ m_OverflowMutex };
+			events.insert(events.end(), m_OverflowEvents.begin(), m_OverflowEvents.end());
+			m_OverflowEvents.clear();
+			m_IsOverflowing.store(false, std::memory_order_release);
+			return true;
+		}
+		tstring TakeFilename(uint32_t key)
+		{
+			std::lock_guard<std::mutex> lck{ m_FilenamesMutex };
+			return std::move(m_Filenames.extract(key).mapped());
+		}
+		void HandleRequests(std::stop_token stopToken);
+		void HandleEvent(const QueueInfo& info, std::map<SoundID, AudioInfo>& audioMap);
+		void ResolvePendingPlays(std::map<SoundID, AudioInfo>& audioMap);
+		void WaitForPendingPlays(std::stop_token stopToken);
 		void Add(const tstring& filename, SoundID id, std::map<SoundID, AudioInfo>& audioMap)
 		{
 			if (not audioMap.contains(id))
@@ -252,6 +353,18 @@ namespace jela
 			}
 			else OutputDebugString((_T("\nTrying to Add SoundID that is already present. Filename: ") + filename + _T("ID: ") + to_tstring(id) + _T('\n')).c_str());
 		}
+		void Reload(const tstring& filename, std::map<SoundID, AudioInfo>& audioMap)
+		{
+			const std::filesystem::path filePath{ std::filesystem::path{ filename }.lexically_normal() };
+			for (auto& audioInfo : audioMap | std::views::values)
+			{
+				if (std::filesystem::path{ audioInfo.pAudioFile->GetFilePath() }.lexically_normal() != filePath) continue;
+
+				// The old file keeps playing when the new one can't be opened
+				auto pNewAudioFile = std::make_unique<Audio::AudioFile>(filename);
+				if (pNewAudioFile->Exists()) audioInfo.pAudioFile = std::move(pNewAudioFile);
+			}
+		}
 		void Remove(SoundID id, std::map<SoundID, AudioInfo>& audioMap)
 		{
 			if (audioMap.contains(id)) audioMap.erase(id);
@@ -321,62 +434,132 @@ namespace jela
 		}
 	};
 
-	void Audio::AudioImpl::HandleRequests()
+	void Audio::AudioImpl::HandleRequests(std::stop_token stopToken)
 	{
 		std::map<SoundID, AudioInfo> pMapMusicClips{};
-		while (m_ServiceIsActive)
+		// Taken from the overflow all at once, and handled before anything newer is popped
+		std::deque<QueueInfo> overflowEvents{};
+		while (not stopToken.stop_requested())
 		{
-			QueueInfo info{};
-			////////////
-			// Events lock
-			std::unique_lock<std::mutex> eventsLock{ m_EventsMutex };
+			ResolvePendingPlays(pMapMusicClips);
 
-			if (m_Events.empty())
+			if (m_BlockedEvent.has_value())
 			{
-				eventsLock.unlock();
-				////////////
+				if (m_PendingPlays.empty())
+				{
+					HandleEvent(*m_BlockedEvent, pMapMusicClips);
+					m_BlockedEvent.reset();
+				}
+				else WaitForPendingPlays(stopToken);
 				continue;
 			}
-			info = m_Events.front();
 
-			if (info.playBackEvent == Event::Play)
+			QueueInfo info{};
+			if (not overflowEvents.empty())
 			{
-				if (pMapMusicClips.at(info.id).pAudioFile->IsReadyToPlay()) m_Events.pop();
+				info = overflowEvents.front();
+				overflowEvents.pop_front();
 			}
-			else m_Events.pop();
-			eventsLock.unlock();
-			////////////
+			else if (not m_Events.TryPop(info))
+			{
+				if (TakeOverflowEvents(overflowEvents)) continue;
 
+				// Sleeps until there is an event or the service stops
+				if (m_PendingPlays.empty()) m_Events.Wait(stopToken, [this] { return m_IsOverflowing.load(std::memory_order_seq_cst); });
+				else WaitForPendingPlays(stopToken);
+				continue;
+			}
 
-			switch (info.playBackEvent)
+			HandleEvent(info, pMapMusicClips);
+		}
+	}
+
+	void Audio::AudioImpl::HandleEvent(const QueueInfo& info, std::map<SoundID, AudioInfo>& audioMap)
+	{
+		// These touch every sound, so they wait for the pending Plays. Nothing is popped after them until then, which keeps the order.
+		if (info.allSounds || info.playBackEvent == Event::Reload)
+		{
+			if (not m_PendingPlays.empty())
 			{
-			case Event::Add:
-				Add(info.filename, info.id, pMapMusicClips);
-				break;
-			case Event::Remove:
-				Remove(info.id, pMapMusicClips);
-				break;
-			case Event::Play:
-				if (pMapMusicClips.at(info.id).pAudioFile->IsReadyToPlay())
-					Play(info.id, info.repeat, pMapMusicClips);
-				break;
-			case Event::Pause:
-				if (info.allSounds) PauseAll(pMapMusicClips);
-				else Pause(info.id, pMapMusicClips);
-				break;
-			case Event::Resume:
-				if (info.allSounds) ResumeAll(pMapMusicClips);
-				else Resume(info.id, pMapMusicClips);
-				break;
-			case Event::Stop:
-				if (info.allSounds) StopAll(pMapMusicClips);
-				else Stop(info.id, pMapMusicClips);
-				break;
+				m_BlockedEvent = info;
+				return;
+			}
+		}
+		// The events for a sound with a pending Play wait behind it, those for other sounds go on
+		else if (const auto itPending = std::ranges::find(m_PendingPlays, info.id, [](const PendingPlay& pending) { return pending.play.id; });
+			itPending != m_PendingPlays.end())
+		{
+			itPending->heldEvents.push_back(info);
+			return;
+		}
+		else if (info.playBackEvent == Event::Play && audioMap.contains(info.id) && not audioMap.at(info.id).pAudioFile->IsReadyToPlay())
+		{
+			m_PendingPlays.push_back(PendingPlay{ .play{info}, .since{std::chrono::steady_clock::now()} });
+			return;
+		}
+
+		switch (info.playBackEvent)
+		{
+		case Event::Add:
+			Add(TakeFilename(info.filenameKey), info.id, audioMap);
+			break;
+		case Event::Remove:
+			Remove(info.id, audioMap);
+			break;
+		case Event::Reload:
+			Reload(TakeFilename(info.filenameKey), audioMap);
+			break;
+		case Event::Play:
+			Play(info.id, info.repeat, audioMap);
+			break;
+		case Event::Pause:
+			if (info.allSounds) PauseAll(audioMap);
+			else Pause(info.id, audioMap);
+			break;
+		case Event::Resume:
+			if (info.allSounds) ResumeAll(audioMap);
+			else Resume(info.id, audioMap);
+			break;
+		case Event::Stop:
+			if (info.allSounds) StopAll(audioMap);
+			else Stop(info.id, audioMap);
+			break;
 
+		}
+	}
+
+	void Audio::AudioImpl::ResolvePendingPlays(std::map<SoundID, AudioInfo>& audioMap)
+	{
+		// Handling the held events can add pending Plays at the end, which are checked in this same pass
+		for (std::size_t index = 0; index < m_PendingPlays.size();)
+		{
+			const QueueInfo play{ m_PendingPlays[index].play };
+			// Its sound can't have been removed, the Remove would be held behind it
+			const bool isReady{ audioMap.at(play.id).pAudioFile->IsReadyToPlay() };
+			if (not isReady && std::chrono::steady_clock::now() - m_PendingPlays[index].since < m_ReadyTimeout)
+			{
+				++index;
+				continue;
 			}
+
+			std::vector<QueueInfo> heldEvents{ std::move(m_PendingPlays[index].heldEvents) };
+			m_PendingPlays.erase(m_PendingPlays.begin() + index);
+
+			if (isReady) Play(play.id, play.repeat, audioMap);
+			else OutputDebugString((_T("\nGave up playing a sound that didn't get ready. ID: ") + to_tstring(play.id) + _T('\n')).c_str());
+
+			for (const QueueInfo& heldInfo : heldEvents) HandleEvent(heldInfo, audioMap);
 		}
 	}
 
+	void Audio::AudioImpl::WaitForPendingPlays(std::stop_token stopToken)
+	{
+		// Nothing signals when a file is ready, so it is checked again every poll interval. New events wait at most that long.
+		// Stopping the service still ends the wait at once.
+		std::unique_lock<std::mutex> lck{ m_ReadyMutex };
+		m_ReadyCondition.wait_for(lck, stopToken, m_ReadyPollInterval, [] { return false; });
+	}
+
 	//Audio
 	Audio::Audio() :
 		m_pImpl{ new AudioImpl{} }
@@ -392,15 +575,20 @@ namespace jela
 		delete m_pImpl;
 		MFShutdown();
 	}
-	void Audio::AddSound(const tstring& filename, SoundID id)
+	// Media Foundation always reads from the file while it plays, so every sound streams
+	void Audio::AddSound(const tstring& filename, SoundID id, bool)
 	{
 		m_pImpl->AddSoundImpl(filename, id);
 	}
+	void Audio::ReloadSound(const tstring& filename)
+	{
+		m_pImpl->ReloadSoundImpl(filename);
+	}
 	void Audio::RemoveSound(SoundID id)
 	{
 		m_pImpl->RemoveSoundImpl(id);
 	}
-	void Audio::PlaySoundClip(SoundID id, bool repeat, uint8_t volume, float frequency) const
+	void Audio::PlaySoundClip(SoundID id, bool repeat, uint8_t volume, float frequency, uint8_t) const
 	{
 		if (volume != 100) OutputDebugString(_T("Different volume not supported in the 'Audio' Service."));
 		if (std::abs(frequency) - 1.f > 0.f) OutputDebugString(_T("Different frequency not supported in the 'Audio' Service."));
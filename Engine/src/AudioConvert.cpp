@@ -0,0 +1,363 @@
+#include "AudioConvert.h"
+#include "AudioKernels.h"
+#include "FileExceptions.h"
+#include "Simd.h"
+#include <algorithm>
+#include <array>
+#include <bit>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+namespace jela::audio
+{
+    namespace
+    {
+        constexpr float minus3dB{ 0.70710678f };
+
+        // The left and right gains of the speakers in the order of the bits of a channel mask: front left, front right, front center,
+        // low frequency, back left, back right, front left and right of center, back center, side left and side right.
+        // Speakers past those, and channels the mask has no speaker for, play on both sides.
+        constexpr std::array<std::array<float, 2>, 11> speakerGains{ {
+            { 1.f, 0.f }, { 0.f, 1.f }, { minus3dB, minus3dB }, { 0.f, 0.f }, { minus3dB, 0.f }, { 0.f, minus3dB },
+            { 1.f, 0.f }, { 0.f, 1.f }, { 0.5f, 0.5f }, { minus3dB, 0.f }, { 0.f, minus3dB } } };
+        constexpr std::array<float, 2> otherSpeakerGains{ 0.5f, 0.5f };
+
+        float ReadSample(const std::byte* pSample, uint16_t formatTag, std::size_t bytesPerSample)
+        {
+            const auto byteAt{ [pSample](int index) { return std::to_integer<uint32_t>(pSample[index]); } };
+            if (formatTag == WaveFormat::ieeeFloat)
+            {
+                float value{};
+                std::memcpy(&value, pSample, sizeof(value));
+                return value;
+            }
+
+            switch (bytesPerSample)
+            {
+            case 1: return (static_cast<float>(byteAt(0)) - 128.f) / 128.f;
+            case 2: return static_cast<float>(static_cast<int16_t>(byteAt(0) | byteAt(1) << 8)) / 32768.f;
+            // Shifted to the top of 32 bits and back, which extends the sign
+            case 3: return static_cast<float>(static_cast<int32_t>(byteAt(0) << 8 | byteAt(1) << 16 | byteAt(2) << 24) >> 8) / 8388608.f;
+            default: return static_cast<float>(static_cast<int32_t>(byteAt(0) | byteAt(1) << 8 | byteAt(2) << 16 | byteAt(3) << 24)) / 2147483648.f;
+            }
+        }
+
+        // Decodes samples that follow each other without gaps
+        void DecodePacked(const std::byte* pSource, uint16_t formatTag, std::size_t bytesPerSample, std::size_t count, float* pDestination)
+        {
+            if (formatTag == WaveFormat::ieeeFloat)
+            {
+                std::memcpy(pDestination, pSource, count * sizeof(float));
+                return;
+            }
+
+            std::size_t index{};
+            if (bytesPerSample == 2)
+            {
+#if defined(JELA_SIMD_SSE2)
+                const __m128 scale{ _mm_set1_ps(1.f / 32768.f) };
+                for (; index + 8 <= count; index += 8)
+                {
+                    const __m128i samples{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + index * 2)) };
+                    // Into the top half of 32 bits and shifted back down, which extends the sign
+                    const __m128i low{ _mm_srai_epi32(_mm_unpacklo_epi16(_mm_setzero_si128(), samples), 16) };
+                    const __m128i high{ _mm_srai_epi32(_mm_unpackhi_epi16(_mm_setzero_si128(), samples), 16) };
+                    _mm_storeu_ps(pDestination + index, _mm_mul_ps(_mm_cvtepi32_ps(low), scale));
+                    _mm_storeu_ps(pDestination + index + 4, _mm_mul_ps(_mm_cvtepi32_ps(high), scale));
+                }
+#elif defined(JELA_SIMD_NEON)
+                for (; index + 8 <= count; index += 8)
+                {
+                    const int16x8_t samples{ vreinterpretq_s16_u8(vld1q_u8(reinterpret_cast<const uint8_t*>(pSource + index * 2))) };
+                    vst1q_f32(pDestination + index, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_low_s16(samples))), 1.f / 32768.f));
+                    vst1q_f32(pDestination + index + 4, vmulq_n_f32(vcvtq_f32_s32(vmovl_s16(vget_high_s16(samples))), 1.f / 32768.f));
+                }
+#endif
+            }
+            for (; index < count; ++index) pDestination[index] = ReadSample(pSource + index * bytesPerSample, formatTag, bytesPerSample);
+        }
+
+        // Resamples each channel of the frames on its own, to as many frames as reach the end of the sound
+        std::vector<float> ResampleChannels(std::span<const float> samples, uint16_t channelCount, uint32_t sourceRate, uint32_t destinationRate)
+        {
+            assert(channelCount == 1 || channelCount == 2);
+            const SincResampler resampler{ sourceRate, destinationRate };
+            const std::size_t frameCount{ samples.size() / channelCount };
+            const auto resampledFrameCount{ static_cast<std::size_t>(ConvertFrameCount(frameCount, sourceRate, destinationRate)) };
+            const uint64_t step{ ((uint64_t{ sourceRate } << positionFractionBits) + destinationRate / 2) / destinationRate };
+
+            // Zeros before and after the sound, where the filter reads past its ends
+            const std::size_t history{ resampler.GetTapCount() / 2 - 1 };
+            std::vector<float> source(frameCount + resampler.GetTapCount() + 1);
+            std::vector<float> resampled(resampledFrameCount * channelCount);
+
+            if (channelCount == 1)
+            {
+                std::ranges::copy(samples, source.begin() + history);
+                resampler.Resample(source, 0, step, resampled);
+                return resampled;
+            }
+
+            std::vector<float> rightSource(source.size());
+            Deinterleave(samples, std::span{ source }.subspan(history, frameCount), std::span{ rightSource }.subspan(history, frameCount));
+            std::vector<float> left(resampledFrameCount);
+            std::vector<float> right(resampledFrameCount);
+            resampler.Resample(source, 0, step, left);
+            resampler.Resample(rightSource, 0, step, right);
+            Interleave(left, right, resampled);
+            return resampled;
+        }
+    }
+
+    WaveFormat MakePcmFormat(uint32_t sampleRate, uint16_t channelCount, uint16_t bitsPerSample)
+    {
+        WaveFormat format{};
+        format.formatTag = bitsPerSample == 32 ? WaveFormat::ieeeFloat : WaveFormat::pcm;
+        format.channelCount = channelCount;
+        format.sampleRate = sampleRate;
+        format.bitsPerSample = bitsPerSample;
+        format.blockAlign = static_cast<uint16_t>(channelCount * bitsPerSample / 8);
+        format.bytesPerSecond = sampleRate * format.blockAlign;
+        return format;
+    }
+
+    bool CanDecode(const WaveFormat& format)
+    {
+        const uint16_t bits{ format.bitsPerSample };
+        const bool isPcm{ format.formatTag == WaveFormat::pcm && (bits == 8 || bits == 16 || bits == 24 || bits == 32) };
+        const bool isFloat{ format.formatTag == WaveFormat::ieeeFloat && bits == 32 };
+        return (isPcm || isFloat) && format.channelCount > 0 && format.blockAlign >= format.channelCount * bits / 8;
+    }
+
+    bool CanEncode(const WaveFormat& format)
+    {
+        const bool isPcm{ format.formatTag == WaveFormat::pcm && format.bitsPerSample == 16 };
+        const bool isFloat{ format.formatTag == WaveFormat::ieeeFloat && format.bitsPerSample == 32 };
+        return (isPcm || isFloat) && format.channelCount > 0 && format.blockAlign == format.channelCount * format.bitsPerSample / 8;
+    }
+
+    void DecodePcm(std::span<const std::byte> source, const WaveFormat& format, std::span<float> destination)
+    {
+        assert(CanDecode(format));
+        const std::size_t bytesPerSample{ format.bitsPerSample / 8u };
+        const std::size_t frameCount{ source.size() / format.blockAlign };
+        assert(destination.size() >= frameCount * format.channelCount);
+
+        // Frames padded past their samples are read one at a time
+        if (format.blockAlign == format.channelCount * bytesPerSample)
+        {
+            DecodePacked(source.data(), format.formatTag, bytesPerSample, frameCount * format.channelCount, destination.data());
+            return;
+        }
+        for (std::size_t frame = 0; frame < frameCount; ++frame)
+            DecodePacked(source.data() + frame * format.blockAlign, format.formatTag, bytesPerSample, format.channelCount, destination.data() + frame * format.channelCount);
+    }
+
+    void EncodePcm(std::span<const float> source, const WaveFormat& format, std::span<std::byte> destination)
+    {
+        assert(CanEncode(format) && destination.size() >= source.size() * (format.bitsPerSample / 8));
+        const std::size_t count{ source.size() };
+        const float* const pSource{ source.data() };
+        std::byte* const pDestination{ destination.data() };
+
+        if (format.formatTag == WaveFormat::ieeeFloat)
+        {
+            std::memcpy(pDestination, pSource, count * sizeof(float));
+            return;
+        }
+
+        constexpr float scale{ 32768.f };
+        std::size_t index{};
+#if defined(JELA_SIMD_SSE2)
+        const __m128 upper{ _mm_set1_ps(1.f) };
+        const __m128 lower{ _mm_set1_ps(-1.f) };
+        const __m128 scales{ _mm_set1_ps(scale) };
+        for (; index + 8 <= count; index += 8)
+        {
+            // Converting rounds to nearest even, packing saturates
+            const __m128 low{ _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSource + index), lower), upper), scales) };
+            const __m128 high{ _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSource + index + 4), lower), upper), scales) };
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination + index * 2), _mm_packs_epi32(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high)));
+        }
+#elif defined(JELA_SIMD_NEON)
+        const float32x4_t upper{ vdupq_n_f32(1.f) };
+        const float32x4_t lower{ vdupq_n_f32(-1.f) };
+        for (; index + 8 <= count; index += 8)
+        {
+            const float32x4_t low{ vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(pSource + index), lower), upper), scale) };
+            const float32x4_t high{ vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(pSource + index + 4), lower), upper), scale) };
+            vst1q_u8(reinterpret_cast<uint8_t*>(pDestination + index * 2), vreinterpretq_u8_s16(vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(low)), vqmovn_s32(vcvtnq_s32_f32(high)))));
+        }
+#endif
+        for (; index < count; ++index)
+        {
+            const float value{ pSource[index] > -1.f ? pSource[index] : -1.f };
+            const auto sample{ static_cast<int32_t>(std::min(std::lrint((value < 1.f ? value : 1.f) * scale), long{ INT16_MAX })) };
+            pDestination[index * 2] = static_cast<std::byte>(sample & 0xFF);
+            pDestination[index * 2 + 1] = static_cast<std::byte>((sample >> 8) & 0xFF);
+        }
+    }
+
+    void Deinterleave(std::span<const float> stereo, std::span<float> left, std::span<float> right)
+    {
+        assert(left.size() >= stereo.size() / 2 && right.size() >= stereo.size() / 2);
+        const std::size_t frameCount{ stereo.size() / 2 };
+        const float* const pStereo{ stereo.data() };
+        float* const pLeft{ left.data() };
+        float* const pRight{ right.data() };
+
+        std::size_t frame{};
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+        // Interleaving the frames twice sorts them: l0 l2 r0 r2 and l1 l3 r1 r3, then l0 l1 l2 l3 and r0 r1 r2 r3
+        for (; frame + simd::floatWidth <= frameCount; frame += simd::floatWidth)
+        {
+            const simd::Float4 first{ simd::Load(pStereo + frame * 2) };
+            const simd::Float4 second{ simd::Load(pStereo + frame * 2 + simd::floatWidth) };
+            const simd::Float4 even{ simd::InterleaveLow(first, second) };
+            const simd::Float4 odd{ simd::InterleaveHigh(first, second) };
+            simd::Store(pLeft + frame, simd::InterleaveLow(even, odd));
+            simd::Store(pRight + frame, simd::InterleaveHigh(even, odd));
+        }
+#endif
+        for (; frame < frameCount; ++frame)
+        {
+            pLeft[frame] = pStereo[frame * 2];
+            pRight[frame] = pStereo[frame * 2 + 1];
+        }
+    }
+
+    void Interleave(std::span<const float> left, std::span<const float> right, std::span<float> stereo)
+    {
+        assert(left.size() == right.size() && stereo.size() >= left.size() * 2);
+        const std::size_t frameCount{ left.size() };
+        const float* const pLeft{ left.data() };
+        const float* const pRight{ right.data() };
+        float* const pStereo{ stereo.data() };
+
+        std::size_t frame{};
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+        for (; frame + simd::floatWidth <= frameCount; frame += simd::floatWidth)
+        {
+            const simd::Float4 leftSamples{ simd::Load(pLeft + frame) };
+            const simd::Float4 rightSamples{ simd::Load(pRight + frame) };
+            simd::Store(pStereo + frame * 2, simd::InterleaveLow(leftSamples, rightSamples));
+            simd::Store(pStereo + frame * 2 + simd::floatWidth, simd::InterleaveHigh(leftSamples, rightSamples));
+        }
+#endif
+        for (; frame < frameCount; ++frame)
+        {
+            pStereo[frame * 2] = pLeft[frame];
+            pStereo[frame * 2 + 1] = pRight[frame];
+        }
+    }
+
+    void RemixChannels(std::span<const float> source, uint16_t sourceChannelCount, uint32_t channelMask, std::span<float> destination, uint16_t destinationChannelCount)
+    {
+        assert(sourceChannelCount > 0 && (destinationChannelCount == 1 || destinationChannelCount == 2));
+        const std::size_t frameCount{ source.size() / sourceChannelCount };
+        assert(destination.size() >= frameCount * destinationChannelCount);
+        const float* const pSource{ source.data() };
+        float* const pDestination{ destination.data() };
+
+        if (sourceChannelCount == destinationChannelCount)
+        {
+            std::copy_n(pSource, frameCount * sourceChannelCount, pDestination);
+            return;
+        }
+
+        std::size_t frame{};
+        if (sourceChannelCount == 1)
+        {
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+            for (; frame + simd::floatWidth <= frameCount; frame += simd::floatWidth)
+            {
+                const simd::Float4 samples{ simd::Load(pSource + frame) };
+                simd::Store(pDestination + frame * 2, simd::InterleaveLow(samples, samples));
+                simd::Store(pDestination + frame * 2 + simd::floatWidth, simd::InterleaveHigh(samples, samples));
+            }
+#endif
+            for (; frame < frameCount; ++frame) pDestination[frame * 2] = pDestination[frame * 2 + 1] = pSource[frame];
+            return;
+        }
+
+        if (sourceChannelCount == 2)
+        {
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+            // Sorted into left and right like Deinterleave does
+            const simd::Float4 half{ simd::Set1(0.5f) };
+            for (; frame + simd::floatWidth <= frameCount; frame += simd::floatWidth)
+            {
+                const simd::Float4 first{ simd::Load(pSource + frame * 2) };
+                const simd::Float4 second{ simd::Load(pSource + frame * 2 + simd::floatWidth) };
+                const simd::Float4 even{ simd::InterleaveLow(first, second) };
+                const simd::Float4 odd{ simd::InterleaveHigh(first, second) };
+                simd::Store(pDestination + frame, simd::Mul(simd::Add(simd::InterleaveLow(even, odd), simd::InterleaveHigh(even, odd)), half));
+            }
+#endif
+            for (; frame < frameCount; ++frame) pDestination[frame] = (pSource[frame * 2] + pSource[frame * 2 + 1]) * 0.5f;
+            return;
+        }
+
+        // Each channel is for the speaker of the next bit set in the mask
+        std::vector<std::array<float, 2>> gains(sourceChannelCount, otherSpeakerGains);
+        uint32_t remainingMask{ channelMask == 0 ? (uint32_t{ 1 } << speakerGains.size()) - 1 : channelMask };
+        for (std::array<float, 2>& channelGains : gains)
+        {
+            if (remainingMask == 0) break;
+            const auto speaker{ static_cast<std::size_t>(std::countr_zero(remainingMask)) };
+            remainingMask &= remainingMask - 1;
+            if (speaker < speakerGains.size()) channelGains = speakerGains[speaker];
+        }
+
+        for (; frame < frameCount; ++frame)
+        {
+            float left{};
+            float right{};
+            for (uint16_t channel = 0; channel < sourceChannelCount; ++channel)
+            {
+                left += pSource[frame * sourceChannelCount + channel] * gains[channel][0];
+                right += pSource[frame * sourceChannelCount + channel] * gains[channel][1];
+            }
+            if (destinationChannelCount == 1) pDestination[frame] = (left + right) * 0.5f;
+            else
+            {
+                pDestination[frame * 2] = left;
+                pDestination[frame * 2 + 1] = right;
+            }
+        }
+    }
+
+    uint64_t ConvertFrame(uint64_t frame, uint32_t sourceRate, uint32_t destinationRate)
+    {
+        return (frame * destinationRate + sourceRate / 2) / sourceRate;
+    }
+
+    uint64_t ConvertFrameCount(uint64_t frameCount, uint32_t sourceRate, uint32_t destinationRate)
+    {
+        return (frameCount * destinationRate + sourceRate - 1) / sourceRate;
+    }
+
+    std::vector<std::byte> ConvertSound(std::span<const std::byte> data, const WaveFormat& format, const WaveFormat& target)
+    {
+        if (!CanDecode(format))
+            throw FileTypeNotSupportedException{ std::format("Format tag {} with {} bits per sample can't be converted.", format.formatTag, format.bitsPerSample), { "8, 16, 24 or 32 bit PCM .wav", "32 bit IEEE float .wav" } };
+        assert(CanEncode(target) && (target.channelCount == 1 || target.channelCount == 2));
+
+        const std::size_t frameCount{ data.size() / format.blockAlign };
+        std::vector<float> samples(frameCount * format.channelCount);
+        DecodePcm(data, format, samples);
+
+        if (format.channelCount != target.channelCount)
+        {
+            std::vector<float> remixed(frameCount * target.channelCount);
+            RemixChannels(samples, format.channelCount, format.channelMask, remixed, target.channelCount);
+            samples = std::move(remixed);
+        }
+        if (format.sampleRate != target.sampleRate) samples = ResampleChannels(samples, target.channelCount, format.sampleRate, target.sampleRate);
+
+        std::vector<std::byte> converted(samples.size() * (target.bitsPerSample / 8));
+        EncodePcm(samples, target, converted);
+        return converted;
+    }
+}
@@ -0,0 +1,457 @@
+#include "AudioDsp.h"
+#include "AudioKernels.h"
+#include "Simd.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+namespace jela::audio
+{
+    namespace
+    {
+        float DecibelsToGain(float decibels)
+        {
+            return std::pow(10.f, decibels / 20.f);
+        }
+
+        // The cookbook's filters share all but their numerator
+        BiquadCoefficients MakeBiquad(uint32_t sampleRate, float cutoff, float q, bool isHighPass)
+        {
+            const double nyquist{ sampleRate / 2.0 };
+            const double frequency{ std::clamp(static_cast<double>(cutoff), 10.0, nyquist * 0.98) };
+            const double omega{ 2.0 * std::numbers::pi * frequency / sampleRate };
+            const double cosine{ std::cos(omega) };
+            const double alpha{ std::sin(omega) / (2.0 * std::max(static_cast<double>(q), 0.1)) };
+            const double a0{ 1.0 + alpha };
+
+            const double b1{ isHighPass ? -(1.0 + cosine) : 1.0 - cosine };
+            const double b0{ std::abs(b1) / 2.0 };
+            return { static_cast<float>(b0 / a0), static_cast<float>(b1 / a0), static_cast<float>(b0 / a0),
+                     static_cast<float>(-2.0 * cosine / a0), static_cast<float>((1.0 - alpha) / a0) };
+        }
+
+        // Freeverb's delays at 44.1 kHz, the shorter half of its combs and allpasses. The second tail's are longer by the spread.
+        constexpr std::array<std::size_t, 4> reverbCombLengths{ 1116, 1277, 1422, 1557 };
+        constexpr std::array<std::size_t, 2> reverbAllpassLengths{ 556, 341 };
+        constexpr std::size_t reverbStereoSpread{ 23 };
+        constexpr float reverbReferenceRate{ 44100.f };
+        constexpr float reverbInputGain{ 0.015f };
+        constexpr float reverbWetScale{ 3.f };
+        constexpr float reverbAllpassFeedback{ 0.5f };
+        // Added to what goes into the combs, so their tails settle on it instead of decaying into denormals, which are slow to compute with
+        constexpr float antiDenormal{ 1e-18f };
+    }
+
+    BiquadCoefficients MakeLowPass(uint32_t sampleRate, float cutoff, float q)
+    {
+        return MakeBiquad(sampleRate, cutoff, q, false);
+    }
+
+    BiquadCoefficients MakeHighPass(uint32_t sampleRate, float cutoff, float q)
+    {
+        return MakeBiquad(sampleRate, cutoff, q, true);
+    }
+
+    //---------------------------------------------------------------
+    // Biquad
+    void Biquad::SetCoefficients(const BiquadCoefficients& coefficients)
+    {
+        m_Coefficients = coefficients;
+        const auto [b0, b1, b2, a1, a2] { coefficients };
+
+        // Runs 4 frames with each of the state values and inputs set to 1 alone, what comes out is what that one adds to each frame
+        for (std::size_t input = 0; input < 2 + m_BlockFrameCount; ++input)
+        {
+            float state1{ input == 0 ? 1.f : 0.f };
+            float state2{ input == 1 ? 1.f : 0.f };
+            for (std::size_t frame = 0; frame < m_BlockFrameCount; ++frame)
+            {
+                const float x{ input == 2 + frame ? 1.f : 0.f };
+                const float y{ b0 * x + state1 };
+                state1 = b1 * x - a1 * y + state2;
+                state2 = b2 * x - a2 * y;
+                m_BlockTaps[input * m_BlockFrameCount + frame] = y;
+            }
+        }
+    }
+
+    void Biquad::Reset()
+    {
+        m_State.fill(0.f);
+    }
+
+    void Biquad::Process(std::span<float> samples, uint16_t channelCount)
+    {
+        assert(channelCount > 0);
+        const std::size_t frameCount{ samples.size() / channelCount };
+        const std::size_t filteredCount{ std::min(channelCount, maxEffectChannelCount) };
+        const auto [b0, b1, b2, a1, a2] { m_Coefficients };
+        float* const pSamples{ samples.data() };
+
+        std::size_t frame{};
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+        // Mono and stereo fill whole registers with 4 frames. The inputs are summed first, only the last two terms wait for the block before.
+        if (channelCount <= 2)
+        {
+            const float* const pTaps{ m_BlockTaps.data() };
+            const simd::Float4 state1Taps{ simd::Load(pTaps) };
+            const simd::Float4 state2Taps{ simd::Load(pTaps + 4) };
+            const simd::Float4 input0Taps{ simd::Load(pTaps + 8) };
+            const simd::Float4 input1Taps{ simd::Load(pTaps + 12) };
+            const simd::Float4 input2Taps{ simd::Load(pTaps + 16) };
+            const simd::Float4 input3Taps{ simd::Load(pTaps + 20) };
+
+            for (; frame + m_BlockFrameCount <= frameCount; frame += m_BlockFrameCount)
+            {
+                float* const pBlock{ pSamples + frame * channelCount };
+                simd::Float4 outputs[2]{ simd::Zero(), simd::Zero() };
+                for (std::size_t channel = 0; channel < channelCount; ++channel)
+                {
+                    const float x2{ pBlock[2 * channelCount + channel] };
+                    const float x3{ pBlock[3 * channelCount + channel] };
+                    simd::Float4 y{ simd::Mul(simd::Set1(pBlock[channel]), input0Taps) };
+                    y = simd::MulAdd(simd::Set1(pBlock[channelCount + channel]), input1Taps, y);
+                    y = simd::MulAdd(simd::Set1(x2), input2Taps, y);
+                    y = simd::MulAdd(simd::Set1(x3), input3Taps, y);
+
+                    float& state1{ m_State[channel * 2] };
+                    float& state2{ m_State[channel * 2 + 1] };
+                    y = simd::MulAdd(simd::Set1(state1), state1Taps, simd::MulAdd(simd::Set1(state2), state2Taps, y));
+                    outputs[channel] = y;
+
+                    // The state after the last frame, from the last two like the scalar filter gets it
+                    float ys[simd::floatWidth];
+                    simd::Store(ys, y);
+                    state1 = b1 * x3 - a1 * ys[3] + (b2 * x2 - a2 * ys[2]);
+                    state2 = b2 * x3 - a2 * ys[3];
+                }
+
+                if (channelCount == 1) simd::Store(pBlock, outputs[0]);
+                else
+                {
+                    simd::Store(pBlock, simd::InterleaveLow(outputs[0], outputs[1]));
+                    simd::Store(pBlock + simd::floatWidth, simd::InterleaveHigh(outputs[0], outputs[1]));
+                }
+            }
+        }
+#endif
+        for (; frame < frameCount; ++frame)
+        {
+            float* const pFrame{ pSamples + frame * channelCount };
+            for (std::size_t channel = 0; channel < filteredCount; ++channel)
+            {
+                float& state1{ m_State[channel * 2] };
+                float& state2{ m_State[channel * 2 + 1] };
+                const float x{ pFrame[channel] };
+                const float y{ b0 * x + state1 };
+                state1 = b1 * x - a1 * y + state2;
+                state2 = b2 * x - a2 * y;
+                pFrame[channel] = y;
+            }
+        }
+    }
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Compressor
+    void Compressor::SetSettings(const CompressorSettings& settings, uint32_t sampleRate)
+    {
+        m_SampleRate = sampleRate;
+        m_Threshold = DecibelsToGain(settings.thresholdDb);
+        m_Slope = 1.f - 1.f / std::max(settings.ratio, 1.f);
+        m_MakeupGain = DecibelsToGain(settings.makeupGainDb);
+
+        // The time constants in frames, the level gets 63% of the way there in one
+        m_AttackFrames = std::max(settings.attackMs * 0.001f * static_cast<float>(sampleRate), 1.f);
+        m_ReleaseFrames = std::max(settings.releaseMs * 0.001f * static_cast<float>(sampleRate), 1.f);
+        m_AttackCoefficient = std::exp(-static_cast<float>(m_ControlFrameCount) / m_AttackFrames);
+        m_ReleaseCoefficient = std::exp(-static_cast<float>(m_ControlFrameCount) / m_ReleaseFrames);
+    }
+
+    void Compressor::Reset()
+    {
+        m_Level = 0.f;
+        m_Gain = 1.f;
+    }
+
+    float Compressor::UpdateGain(float peak, std::size_t frameCount)
+    {
+        const bool isAttack{ peak > m_Level };
+        // Only the last block of a call can be short
+        const float coefficient{ frameCount == m_ControlFrameCount ? (isAttack ? m_AttackCoefficient : m_ReleaseCoefficient) :
+                                 std::exp(-static_cast<float>(frameCount) / (isAttack ? m_AttackFrames : m_ReleaseFrames)) };
+        m_Level = peak + coefficient * (m_Level - peak);
+
+        // Above the threshold every dB of level leaves 1 / ratio dB, so the gain is (level / threshold) ^ (1 / ratio - 1)
+        if (m_Level <= m_Threshold) return m_MakeupGain;
+        return m_MakeupGain * std::pow(m_Level / m_Threshold, -m_Slope);
+    }
+
+    void Compressor::Process(std::span<float> samples, uint16_t channelCount, std::optional<float> keyLevel)
+    {
+        assert(channelCount > 0);
+        const std::size_t frameCount{ samples.size() / channelCount };
+        for (std::size_t frame = 0; frame < frameCount; frame += m_ControlFrameCount)
+        {
+            const std::size_t blockFrameCount{ std::min(m_ControlFrameCount, frameCount - frame) };
+            const std::span<float> block{ samples.subspan(frame * channelCount, blockFrameCount * channelCount) };
+            const float startGain{ m_Gain };
+            m_Gain = UpdateGain(keyLevel ? *keyLevel : GetPeak(block), blockFrameCount);
+            if (startGain == 1.f && m_Gain == 1.f) continue;
+
+            if (channelCount == 2)
+            {
+                ApplyGainRamp(block, startGain, m_Gain);
+                continue;
+            }
+            const float delta{ (m_Gain - startGain) / static_cast<float>(blockFrameCount) };
+            std::size_t blockFrame{};
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+            if (channelCount == 1)
+            {
+                const float offsets[simd::floatWidth]{ 0.f, delta, 2.f * delta, 3.f * delta };
+                const simd::Float4 offset{ simd::Load(offsets) };
+                for (; blockFrame + simd::floatWidth <= blockFrameCount; blockFrame += simd::floatWidth)
+                {
+                    const simd::Float4 gain{ simd::Add(simd::Set1(startGain + delta * static_cast<float>(blockFrame)), offset) };
+                    simd::Store(block.data() + blockFrame, simd::Mul(simd::Load(block.data() + blockFrame), gain));
+                }
+            }
+#endif
+            for (; blockFrame < blockFrameCount; ++blockFrame)
+            {
+                const float gain{ startGain + delta * static_cast<float>(blockFrame) };
+                for (std::size_t channel = 0; channel < channelCount; ++channel) block[blockFrame * channelCount + channel] *= gain;
+            }
+        }
+    }
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // Reverb
+    void Reverb::Prepare(uint32_t sampleRate)
+    {
+        const float scale{ static_cast<float>(sampleRate) / reverbReferenceRate };
+        std::size_t size{};
+        for (std::size_t tailIndex = 0; tailIndex < m_Tails.size(); ++tailIndex)
+        {
+            Tail& tail{ m_Tails[tailIndex] };
+            const std::size_t spread{ tailIndex * reverbStereoSpread };
+            for (std::size_t line = 0; line < m_CombCount + m_AllpassCount; ++line)
+            {
+                const std::size_t length{ line < m_CombCount ? reverbCombLengths[line] + spread : reverbAllpassLengths[line - m_CombCount] + spread };
+                tail.lengths[line] = std::max(static_cast<std::size_t>(static_cast<float>(length) * scale), m_BlockFrameCount);
+                tail.offsets[line] = size;
+                size += tail.lengths[line];
+            }
+        }
+        m_Lines.assign(size, 0.f);
+        Reset();
+    }
+
+    void Reverb::SetSettings(const ReverbSettings& settings)
+    {
+        m_Settings = settings;
+        m_Feedback = std::clamp(settings.roomSize, 0.f, 1.f) * 0.28f + 0.7f;
+        m_Damping = std::clamp(settings.damping, 0.f, 1.f) * 0.4f;
+
+        // filtered = output (1 - damping) + filtered before * damping, run over 4 frames from each of its inputs alone
+        for (std::size_t input = 0; input < 1 + m_BlockFrameCount; ++input)
+        {
+            float filtered{ input == 0 ? 1.f : 0.f };
+            for (std::size_t frame = 0; frame < m_BlockFrameCount; ++frame)
+            {
+                const float output{ input == 1 + frame ? 1.f : 0.f };
+                filtered = output * (1.f - m_Damping) + filtered * m_Damping;
+                m_DampingTaps[input * m_BlockFrameCount + frame] = filtered;
+            }
+        }
+    }
+
+    void Reverb::Reset()
+    {
+        std::ranges::fill(m_Lines, 0.f);
+        for (Tail& tail : m_Tails)
+        {
+            tail.positions.fill(0);
+            tail.filterStates.fill(0.f);
+        }
+    }
+
+    void Reverb::ProcessTail(Tail& tail, std::span<const float> inputs, std::span<float> outputs)
+    {
+        const std::size_t frameCount{ inputs.size() };
+        std::size_t frame{};
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+        float* const pLines{ m_Lines.data() };
+        const float* const pTaps{ m_DampingTaps.data() };
+        const simd::Float4 stateTaps{ simd::Load(pTaps) };
+        const simd::Float4 output0Taps{ simd::Load(pTaps + 4) };
+        const simd::Float4 output1Taps{ simd::Load(pTaps + 8) };
+        const simd::Float4 output2Taps{ simd::Load(pTaps + 12) };
+        const simd::Float4 output3Taps{ simd::Load(pTaps + 16) };
+        const simd::Float4 feedback{ simd::Set1(m_Feedback) };
+        const simd::Float4 allpassFeedback{ simd::Set1(reverbAllpassFeedback) };
+
+        while (frame < frameCount)
+        {
+            // Blocks run up to where the first line wraps, the frame that wraps goes on its own
+            std::size_t untilWrap{ frameCount - frame };
+            for (std::size_t line = 0; line < m_CombCount + m_AllpassCount; ++line) untilWrap = std::min(untilWrap, tail.lengths[line] - tail.positions[line]);
+            if (untilWrap < m_BlockFrameCount)
+            {
+                outputs[frame] = ProcessTailFrame(tail, inputs[frame]);
+                ++frame;
+                continue;
+            }
+
+            const std::size_t blockCount{ untilWrap / m_BlockFrameCount };
+            for (std::size_t block = 0; block < blockCount; ++block, frame += m_BlockFrameCount)
+            {
+                const std::size_t advance{ block * m_BlockFrameCount };
+                const simd::Float4 input{ simd::Add(simd::Load(inputs.data() + frame), simd::Set1(antiDenormal)) };
+                simd::Float4 output{ simd::Zero() };
+
+                for (std::size_t comb = 0; comb < m_CombCount; ++comb)
+                {
+                    float* const pLine{ pLines + tail.offsets[comb] + tail.positions[comb] + advance };
+                    output = simd::Add(output, simd::Load(pLine));
+
+                    // Each comb's feedback goes through a one pole low-pass, which is what damps the highs
+                    simd::Float4 filtered{ simd::Mul(simd::Set1(tail.filterStates[comb]), stateTaps) };
+                    filtered = simd::MulAdd(simd::Set1(pLine[0]), output0Taps, filtered);
+                    filtered = simd::MulAdd(simd::Set1(pLine[1]), output1Taps, filtered);
+                    filtered = simd::MulAdd(simd::Set1(pLine[2]), output2Taps, filtered);
+                    filtered = simd::MulAdd(simd::Set1(pLine[3]), output3Taps, filtered);
+                    float filteredValues[simd::floatWidth];
+                    simd::Store(filteredValues, filtered);
+                    tail.filterStates[comb] = filteredValues[3];
+                    simd::Store(pLine, simd::MulAdd(filtered, feedback, input));
+                }
+
+                for (std::size_t allpass = m_CombCount; allpass < m_CombCount + m_AllpassCount; ++allpass)
+                {
+                    float* const pLine{ pLines + tail.offsets[allpass] + tail.positions[allpass] + advance };
+                    const simd::Float4 delayed{ simd::Load(pLine) };
+                    simd::Store(pLine, simd::MulAdd(delayed, allpassFeedback, output));
+                    output = simd::Sub(delayed, output);
+                }
+                simd::Store(outputs.data() + frame, output);
+            }
+
+            for (std::size_t line = 0; line < m_CombCount + m_AllpassCount; ++line)
+            {
+                tail.positions[line] += blockCount * m_BlockFrameCount;
+                if (tail.positions[line] == tail.lengths[line]) tail.positions[line] = 0;
+            }
+        }
+#endif
+        for (; frame < frameCount; ++frame) outputs[frame] = ProcessTailFrame(tail, inputs[frame]);
+    }
+
+    float Reverb::ProcessTailFrame(Tail& tail, float input)
+    {
+        float* const pLines{ m_Lines.data() };
+        float output{};
+        for (std::size_t comb = 0; comb < m_CombCount; ++comb)
+        {
+            std::size_t& position{ tail.positions[comb] };
+            float& delayed{ pLines[tail.offsets[comb] + position] };
+            output += delayed;
+            tail.filterStates[comb] = delayed * (1.f - m_Damping) + tail.filterStates[comb] * m_Damping;
+            delayed = tail.filterStates[comb] * m_Feedback + (input + antiDenormal);
+            if (++position == tail.lengths[comb]) position = 0;
+        }
+
+        for (std::size_t allpass = m_CombCount; allpass < m_CombCount + m_AllpassCount; ++allpass)
+        {
+            std::size_t& position{ tail.positions[allpass] };
+            float& delayed{ pLines[tail.offsets[allpass] + position] };
+            const float allpassOutput{ delayed - output };
+            delayed = output + delayed * reverbAllpassFeedback;
+            output = allpassOutput;
+            if (++position == tail.lengths[allpass]) position = 0;
+        }
+        return output;
+    }
+
+    void Reverb::Process(std::span<float> samples, uint16_t channelCount)
+    {
+        assert(channelCount > 0);
+        // Not prepared yet
+        if (m_Lines.empty()) return;
+
+        const std::size_t frameCount{ samples.size() / channelCount };
+        const std::size_t processedCount{ std::min(channelCount, maxEffectChannelCount) };
+        const float wetGain{ m_Settings.wetGain * reverbWetScale };
+        const float dryGain{ m_Settings.dryGain };
+
+        float inputs[m_ChunkFrameCount];
+        float wetEven[m_ChunkFrameCount];
+        float wetOdd[m_ChunkFrameCount];
+        for (std::size_t chunkFrame = 0; chunkFrame < frameCount; chunkFrame += m_ChunkFrameCount)
+        {
+            const std::size_t chunkFrameCount{ std::min(m_ChunkFrameCount, frameCount - chunkFrame) };
+            float* const pChunk{ samples.data() + chunkFrame * channelCount };
+            for (std::size_t frame = 0; frame < chunkFrameCount; ++frame)
+            {
+                float input{};
+                for (std::size_t channel = 0; channel < processedCount; ++channel) input += pChunk[frame * channelCount + channel];
+                inputs[frame] = input * reverbInputGain;
+            }
+
+            ProcessTail(m_Tails[0], { inputs, chunkFrameCount }, { wetEven, chunkFrameCount });
+            if (processedCount > 1) ProcessTail(m_Tails[1], { inputs, chunkFrameCount }, { wetOdd, chunkFrameCount });
+
+            for (std::size_t frame = 0; frame < chunkFrameCount; ++frame)
+            {
+                float* const pFrame{ pChunk + frame * channelCount };
+                for (std::size_t channel = 0; channel < processedCount; ++channel)
+                    pFrame[channel] = pFrame[channel] * dryGain + (channel % 2 == 0 ? wetEven[frame] : wetOdd[frame]) * wetGain;
+            }
+        }
+    }
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // EffectChain
+    void EffectChain::Prepare(uint32_t sampleRate, uint16_t channelCount)
+    {
+        m_SampleRate = sampleRate;
+        m_ChannelCount = channelCount;
+        m_Reverb.Prepare(sampleRate);
+        m_HighPass.Reset();
+        m_LowPass.Reset();
+        m_Compressor.Reset();
+        // The coefficients depend on the rate
+        const EffectSettings settings{ m_Settings };
+        m_Settings = {};
+        SetSettings(settings);
+    }
+
+    void EffectChain::SetSettings(const EffectSettings& settings)
+    {
+        // An effect that comes on again starts from silence, not from where it was left
+        if (settings.isHighPassOn && !m_Settings.isHighPassOn) m_HighPass.Reset();
+        if (settings.isLowPassOn && !m_Settings.isLowPassOn) m_LowPass.Reset();
+        if (settings.isCompressorOn && !m_Settings.isCompressorOn) m_Compressor.Reset();
+        if (settings.isReverbOn && !m_Settings.isReverbOn) m_Reverb.Reset();
+
+        m_Settings = settings;
+        m_HighPass.SetCoefficients(MakeHighPass(m_SampleRate, settings.highPassCutoff));
+        m_LowPass.SetCoefficients(MakeLowPass(m_SampleRate, settings.lowPassCutoff));
+        m_Compressor.SetSettings(settings.compressor, m_SampleRate);
+        m_Reverb.SetSettings(settings.reverb);
+    }
+
+    void EffectChain::Process(std::span<float> samples, std::optional<float> keyLevel)
+    {
+        if (m_Settings.isHighPassOn) m_HighPass.Process(samples, m_ChannelCount);
+        if (m_Settings.isLowPassOn) m_LowPass.Process(samples, m_ChannelCount);
+        if (m_Settings.isCompressorOn) m_Compressor.Process(samples, m_ChannelCount, keyLevel);
+        if (m_Settings.isReverbOn) m_Reverb.Process(samples, m_ChannelCount);
+        m_Peak = audio::GetPeak(samples);
+    }
+    //---------------------------------------------------------------
+}
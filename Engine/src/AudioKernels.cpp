@@ -0,0 +1,337 @@
+#include "AudioKernels.h"
+#include "Simd.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+
+namespace jela::audio
+{
+    namespace
+    {
+        constexpr std::size_t phaseBits{ 8 };
+        constexpr std::size_t phaseCount{ std::size_t{ 1 } << phaseBits };
+        constexpr double passband{ 0.45 };
+        constexpr double kaiserBeta{ 6.0 };
+
+        // The filter for every phase, plus the one a whole frame on, so each phase can be interpolated towards the next
+        struct PolyphaseTable
+        {
+            std::array<std::array<float, polyphaseTapCount>, phaseCount + 1> phases{};
+        };
+
+        // Modified Bessel function of the first kind, order 0, for the Kaiser window
+        double BesselI0(double x)
+        {
+            double sum{ 1.0 };
+            double term{ 1.0 };
+            for (int k = 1; k < 32; ++k)
+            {
+                term *= (x / (2.0 * k)) * (x / (2.0 * k));
+                sum += term;
+            }
+            return sum;
+        }
+
+        // Fills taps with a Kaiser windowed sinc that cuts at cutoff, a fraction of the source rate, for a value fraction past the center tap.
+        // Every phase passes a constant unchanged, so the resampled signal doesn't ripple with the fraction.
+        void CreateWindowedSinc(std::span<float> taps, double fraction, double cutoff)
+        {
+            const double halfWidth{ static_cast<double>(taps.size() / 2) };
+            const double center{ halfWidth - 1.0 };
+
+            double sum{};
+            for (std::size_t tap = 0; tap < taps.size(); ++tap)
+            {
+                const double offset{ static_cast<double>(tap) - center - fraction };
+                const double ratio{ offset / halfWidth };
+                const double window{ ratio * ratio < 1.0 ? BesselI0(kaiserBeta * std::sqrt(1.0 - ratio * ratio)) / BesselI0(kaiserBeta) : 0.0 };
+                const double x{ 2.0 * cutoff * offset };
+                const double sinc{ x == 0.0 ? 1.0 : std::sin(std::numbers::pi * x) / (std::numbers::pi * x) };
+                const double value{ 2.0 * cutoff * sinc * window };
+                taps[tap] = static_cast<float>(value);
+                sum += value;
+            }
+            for (float& value : taps) value = static_cast<float>(value / sum);
+        }
+
+        PolyphaseTable CreatePolyphaseTable()
+        {
+            PolyphaseTable table{};
+            for (std::size_t phase = 0; phase <= phaseCount; ++phase)
+                CreateWindowedSinc(table.phases[phase], static_cast<double>(phase) / phaseCount, passband);
+            return table;
+        }
+
+        const PolyphaseTable& GetPolyphaseTable()
+        {
+            static const PolyphaseTable table{ CreatePolyphaseTable() };
+            return table;
+        }
+    }
+
+    void MixMono(std::span<const float> source, std::span<float> destination, float leftGain, float rightGain)
+    {
+        assert(destination.size() >= source.size() * 2);
+        const std::size_t count{ source.size() };
+        const float* const pSource{ source.data() };
+        float* const pDestination{ destination.data() };
+
+        std::size_t index{};
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+        const float gains[simd::floatWidth]{ leftGain, rightGain, leftGain, rightGain };
+        const simd::Float4 gain{ simd::Load(gains) };
+        for (; index + simd::floatWidth <= count; index += simd::floatWidth)
+        {
+            const simd::Float4 samples{ simd::Load(pSource + index) };
+            float* const pOut{ pDestination + index * 2 };
+            simd::Store(pOut, simd::MulAdd(simd::InterleaveLow(samples, samples), gain, simd::Load(pOut)));
+            simd::Store(pOut + simd::floatWidth, simd::MulAdd(simd::InterleaveHigh(samples, samples), gain, simd::Load(pOut + simd::floatWidth)));
+        }
+#endif
+        for (; index < count; ++index)
+        {
+            pDestination[index * 2] += pSource[index] * leftGain;
+            pDestination[index * 2 + 1] += pSource[index] * rightGain;
+        }
+    }
+
+    void MixStereo(std::span<const float> left, std::span<const float> right, std::span<float> destination, float leftGain, float rightGain)
+    {
+        assert(left.size() == right.size() && destination.size() >= left.size() * 2);
+        const std::size_t count{ left.size() };
+        const float* const pLeft{ left.data() };
+        const float* const pRight{ right.data() };
+        float* const pDestination{ destination.data() };
+
+        std::size_t index{};
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+        const simd::Float4 leftGains{ simd::Set1(leftGain) };
+        const simd::Float4 rightGains{ simd::Set1(rightGain) };
+        for (; index + simd::floatWidth <= count; index += simd::floatWidth)
+        {
+            const simd::Float4 leftSamples{ simd::Mul(simd::Load(pLeft + index), leftGains) };
+            const simd::Float4 rightSamples{ simd::Mul(simd::Load(pRight + index), rightGains) };
+            float* const pOut{ pDestination + index * 2 };
+            simd::Store(pOut, simd::Add(simd::InterleaveLow(leftSamples, rightSamples), simd::Load(pOut)));
+            simd::Store(pOut + simd::floatWidth, simd::Add(simd::InterleaveHigh(leftSamples, rightSamples), simd::Load(pOut + simd::floatWidth)));
+        }
+#endif
+        for (; index < count; ++index)
+        {
+            pDestination[index * 2] += pLeft[index] * leftGain;
+            pDestination[index * 2 + 1] += pRight[index] * rightGain;
+        }
+    }
+
+    void ApplyGainRamp(std::span<float> samples, float startGain, float endGain)
+    {
+        const std::size_t frameCount{ samples.size() / 2 };
+        if (frameCount == 0) return;
+        const float delta{ (endGain - startGain) / static_cast<float>(frameCount) };
+        float* const pSamples{ samples.data() };
+
+        std::size_t frame{};
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+        // Two frames per register, the gain is worked out from the frame rather than summed up, so it doesn't drift
+        const float offsets[simd::floatWidth]{ 0.f, 0.f, delta, delta };
+        const simd::Float4 offset{ simd::Load(offsets) };
+        for (; frame + 2 <= frameCount; frame += 2)
+        {
+            const simd::Float4 gain{ simd::Add(simd::Set1(startGain + delta * static_cast<float>(frame)), offset) };
+            simd::Store(pSamples + frame * 2, simd::Mul(simd::Load(pSamples + frame * 2), gain));
+        }
+#endif
+        for (; frame < frameCount; ++frame)
+        {
+            const float gain{ startGain + delta * static_cast<float>(frame) };
+            pSamples[frame * 2] *= gain;
+            pSamples[frame * 2 + 1] *= gain;
+        }
+    }
+
+    float GetPeak(std::span<const float> samples)
+    {
+        const std::size_t count{ samples.size() };
+        const float* const pSamples{ samples.data() };
+
+        float peak{};
+        std::size_t index{};
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+        simd::Float4 peaks{ simd::Zero() };
+        for (; index + simd::floatWidth <= count; index += simd::floatWidth)
+        {
+            const simd::Float4 values{ simd::Load(pSamples + index) };
+            peaks = simd::Max(peaks, simd::Max(values, simd::Sub(simd::Zero(), values)));
+        }
+        peak = simd::HorizontalMax(peaks);
+#endif
+        for (; index < count; ++index) peak = std::max(peak, std::abs(pSamples[index]));
+        return peak;
+    }
+
+    void Clamp(std::span<float> samples, float limit)
+    {
+        const std::size_t count{ samples.size() };
+        float* const pSamples{ samples.data() };
+
+        std::size_t index{};
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+        const simd::Float4 upper{ simd::Set1(limit) };
+        const simd::Float4 lower{ simd::Set1(-limit) };
+        for (; index + simd::floatWidth <= count; index += simd::floatWidth)
+            simd::Store(pSamples + index, simd::Min(simd::Max(simd::Load(pSamples + index), lower), upper));
+#endif
+        // Written like SSE's max and min, which return the second value for NaN
+        for (; index < count; ++index)
+        {
+            const float value{ pSamples[index] > -limit ? pSamples[index] : -limit };
+            pSamples[index] = value < limit ? value : limit;
+        }
+    }
+
+    void ToInt16(std::span<const float> source, std::span<int16_t> destination)
+    {
+        assert(destination.size() >= source.size());
+        constexpr float scale{ 32767.f };
+        const std::size_t count{ source.size() };
+        const float* const pSource{ source.data() };
+        int16_t* const pDestination{ destination.data() };
+
+        std::size_t index{};
+#if defined(JELA_SIMD_SSE2)
+        const __m128 upper{ _mm_set1_ps(1.f) };
+        const __m128 lower{ _mm_set1_ps(-1.f) };
+        const __m128 scales{ _mm_set1_ps(scale) };
+        for (; index + 8 <= count; index += 8)
+        {
+            // Converting rounds to nearest even, packing saturates
+            const __m128 low{ _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSource + index), lower), upper), scales) };
+            const __m128 high{ _mm_mul_ps(_mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSource + index + 4), lower), upper), scales) };
+            _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination + index), _mm_packs_epi32(_mm_cvtps_epi32(low), _mm_cvtps_epi32(high)));
+        }
+#elif defined(JELA_SIMD_NEON)
+        const float32x4_t upper{ vdupq_n_f32(1.f) };
+        const float32x4_t lower{ vdupq_n_f32(-1.f) };
+        for (; index + 8 <= count; index += 8)
+        {
+            const float32x4_t low{ vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(pSource + index), lower), upper), scale) };
+            const float32x4_t high{ vmulq_n_f32(vminq_f32(vmaxq_f32(vld1q_f32(pSource + index + 4), lower), upper), scale) };
+            vst1q_s16(pDestination + index, vcombine_s16(vqmovn_s32(vcvtnq_s32_f32(low)), vqmovn_s32(vcvtnq_s32_f32(high))));
+        }
+#endif
+        for (; index < count; ++index)
+        {
+            const float value{ pSource[index] > -1.f ? pSource[index] : -1.f };
+            pDestination[index] = static_cast<int16_t>(std::lrint((value < 1.f ? value : 1.f) * scale));
+        }
+    }
+
+    uint64_t ResampleLinear(std::span<const float> source, uint64_t position, uint64_t step, std::span<float> destination)
+    {
+        if (destination.empty()) return position;
+        assert(((position + (destination.size() - 1) * step) >> positionFractionBits) + linearTapCount <= source.size());
+        constexpr float fractionScale{ 1.f / static_cast<float>(uint64_t{ 1 } << positionFractionBits) };
+        const float* const pSource{ source.data() };
+
+        for (float& sample : destination)
+        {
+            const float* const pFrame{ pSource + (position >> positionFractionBits) };
+            const float fraction{ static_cast<float>(position & positionFractionMask) * fractionScale };
+            sample = pFrame[0] + (pFrame[1] - pFrame[0]) * fraction;
+            position += step;
+        }
+        return position;
+    }
+
+    uint64_t ResamplePolyphase(std::span<const float> source, uint64_t position, uint64_t step, std::span<float> destination)
+    {
+        if (destination.empty()) return position;
+        assert(((position + (destination.size() - 1) * step) >> positionFractionBits) + polyphaseTapCount <= source.size());
+        constexpr int phaseFractionBits{ positionFractionBits - static_cast<int>(phaseBits) };
+        constexpr float phaseFractionScale{ 1.f / static_cast<float>(uint64_t{ 1 } << phaseFractionBits) };
+        const PolyphaseTable& table{ GetPolyphaseTable() };
+        const float* const pSource{ source.data() };
+
+        for (float& sample : destination)
+        {
+            const float* const pFrame{ pSource + (position >> positionFractionBits) };
+            const auto fraction{ static_cast<uint32_t>(position & positionFractionMask) };
+            const float* const pTaps{ table.phases[fraction >> phaseFractionBits].data() };
+            const float* const pNextTaps{ table.phases[(fraction >> phaseFractionBits) + 1].data() };
+            const float weight{ static_cast<float>(fraction & ((uint32_t{ 1 } << phaseFractionBits) - 1)) * phaseFractionScale };
+
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+            const simd::Float4 weights{ simd::Set1(weight) };
+            simd::Float4 sum{ simd::Zero() };
+            for (std::size_t tap = 0; tap < polyphaseTapCount; tap += simd::floatWidth)
+            {
+                const simd::Float4 taps{ simd::Load(pTaps + tap) };
+                const simd::Float4 coefficients{ simd::MulAdd(simd::Sub(simd::Load(pNextTaps + tap), taps), weights, taps) };
+                sum = simd::MulAdd(simd::Load(pFrame + tap), coefficients, sum);
+            }
+            sample = simd::HorizontalAdd(sum);
+#else
+            float sum{};
+            for (std::size_t tap = 0; tap < polyphaseTapCount; ++tap)
+                sum += pFrame[tap] * (pTaps[tap] + (pNextTaps[tap] - pTaps[tap]) * weight);
+            sample = sum;
+#endif
+            position += step;
+        }
+        return position;
+    }
+
+    //---------------------------------------------------------------
+    // SincResampler
+    SincResampler::SincResampler(uint32_t sourceRate, uint32_t destinationRate)
+    {
+        // Downsampling cuts below the destination's half rate instead, and takes as many more taps to keep the transition as steep
+        const double downsampling{ std::max(1.0, static_cast<double>(sourceRate) / destinationRate) };
+        const auto tapCount{ static_cast<std::size_t>(std::ceil(static_cast<double>(sincTapCount) * downsampling / simd::floatWidth)) * simd::floatWidth };
+        m_TapCount = std::min(tapCount, maxSincTapCount);
+        m_Phases.resize((phaseCount + 1) * m_TapCount);
+        for (std::size_t phase = 0; phase <= phaseCount; ++phase)
+            CreateWindowedSinc(std::span{ m_Phases }.subspan(phase * m_TapCount, m_TapCount), static_cast<double>(phase) / phaseCount, passband / downsampling);
+    }
+
+    uint64_t SincResampler::Resample(std::span<const float> source, uint64_t position, uint64_t step, std::span<float> destination) const
+    {
+        if (destination.empty()) return position;
+        assert(((position + (destination.size() - 1) * step) >> positionFractionBits) + m_TapCount <= source.size());
+        constexpr int phaseFractionBits{ positionFractionBits - static_cast<int>(phaseBits) };
+        constexpr float phaseFractionScale{ 1.f / static_cast<float>(uint64_t{ 1 } << phaseFractionBits) };
+        const float* const pSource{ source.data() };
+        const float* const pPhases{ m_Phases.data() };
+
+        for (float& sample : destination)
+        {
+            const float* const pFrame{ pSource + (position >> positionFractionBits) };
+            const auto fraction{ static_cast<uint32_t>(position & positionFractionMask) };
+            const float* const pTaps{ pPhases + (fraction >> phaseFractionBits) * m_TapCount };
+            const float* const pNextTaps{ pTaps + m_TapCount };
+            const float weight{ static_cast<float>(fraction & ((uint32_t{ 1 } << phaseFractionBits) - 1)) * phaseFractionScale };
+
+#if defined(JELA_SIMD_SSE2) || defined(JELA_SIMD_NEON)
+            const simd::Float4 weights{ simd::Set1(weight) };
+            simd::Float4 sum{ simd::Zero() };
+            for (std::size_t tap = 0; tap < m_TapCount; tap += simd::floatWidth)
+            {
+                const simd::Float4 taps{ simd::Load(pTaps + tap) };
+                const simd::Float4 coefficients{ simd::MulAdd(simd::Sub(simd::Load(pNextTaps + tap), taps), weights, taps) };
+                sum = simd::MulAdd(simd::Load(pFrame + tap), coefficients, sum);
+            }
+            sample = simd::HorizontalAdd(sum);
+#else
+            float sum{};
+            for (std::size_t tap = 0; tap < m_TapCount; ++tap)
+                sum += pFrame[tap] * (pTaps[tap] + (pNextTaps[tap] - pTaps[tap]) * weight);
+            sample = sum;
+#endif
+            position += step;
+        }
+        return position;
+    }
+    //---------------------------------------------------------------
+}
@@ -0,0 +1,50 @@
+#include "AudioLog.h"
+#include <mutex>
+#include <string>
+
+#ifdef _WIN32
+#include <windows.h>
+#else
+#include <cstdio>
+#endif // _WIN32
+
+namespace jela::audio
+{
+    namespace
+    {
+        void LogToDefault(LogLevel, std::string_view message)
+        {
+#ifdef _WIN32
+            OutputDebugStringA(std::string{ message }.c_str());
+#else
+            std::fwrite(message.data(), 1, message.size(), stderr);
+#endif // _WIN32
+        }
+
+        struct Sink
+        {
+            std::mutex mutex{};
+            LogSink log{ LogToDefault };
+        };
+
+        Sink& GetSink()
+        {
+            static Sink sink{};
+            return sink;
+        }
+    }
+
+    void SetLogSink(LogSink log)
+    {
+        Sink& sink{ GetSink() };
+        const std::lock_guard<std::mutex> lock{ sink.mutex };
+        sink.log = log ? std::move(log) : LogSink{ LogToDefault };
+    }
+
+    void Log(LogLevel level, std::string_view message)
+    {
+        Sink& sink{ GetSink() };
+        const std::lock_guard<std::mutex> lock{ sink.mutex };
+        sink.log(level, message);
+    }
+}
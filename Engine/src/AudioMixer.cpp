@@ -0,0 +1,254 @@
+#include "AudioMixer.h"
+#include "AudioConvert.h"
+#include "AudioKernels.h"
+#include "FileExceptions.h"
+#include "WaveFile.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+
+namespace jela
+{
+    namespace
+    {
+        // Just under full scale, so converting to integers later doesn't clip on rounding
+        constexpr float limiterThreshold{ 0.98f };
+        constexpr double limiterReleaseSeconds{ 0.1 };
+        constexpr float minFrequency{ 1.f / 1024.f };
+        constexpr float maxFrequency{ 1024.f };
+        // Positions keep 32 bits for whole frames, and run up to two loops past the end of one
+        constexpr uint64_t maxFrameCount{ uint64_t{ 1 } << 30 };
+        constexpr uint64_t unitStep{ uint64_t{ 1 } << audio::positionFractionBits };
+    }
+
+    //---------------------------------------------------------------
+    // MixerSound
+    MixerSound::MixerSound(const WaveFile& waveFile)
+    {
+        const WaveFormat& format{ waveFile.GetFormat() };
+        if (!audio::CanDecode(format))
+            throw FileTypeNotSupportedException{ std::format("Format tag {} with {} bits per sample can't be mixed in software.", format.formatTag, format.bitsPerSample), { "8, 16, 24 or 32 bit PCM .wav", "32 bit IEEE float .wav" } };
+        if (format.channelCount > m_MaxChannelCount)
+            throw FileTypeNotSupportedException{ std::format("Sounds with {} channels can't be mixed in software.", format.channelCount), { "mono .wav", "stereo .wav" } };
+        if (waveFile.GetFrameCount() >= maxFrameCount)
+            throw FileLoadException{ "Expected a sound shorter than 2^30 frames when decoding it for the software mixer.\n" };
+
+        m_ChannelCount = format.channelCount;
+        m_SampleRate = format.sampleRate;
+        m_FrameCount = static_cast<uint32_t>(waveFile.GetFrameCount());
+        m_Samples.resize(std::size_t{ m_FrameCount } * m_ChannelCount);
+
+        if (m_ChannelCount == 1) audio::DecodePcm(waveFile.GetData(), format, m_Samples);
+        else
+        {
+            std::vector<float> interleaved(m_Samples.size());
+            audio::DecodePcm(waveFile.GetData(), format, interleaved);
+            audio::Deinterleave(interleaved, std::span{ m_Samples }.first(m_FrameCount), std::span{ m_Samples }.subspan(m_FrameCount));
+        }
+
+        // The loops are checked to lie within the data already
+        const std::vector<WaveLoop>& loops{ waveFile.GetLoops() };
+        m_LoopBegin = loops.empty() ? 0 : loops.front().begin;
+        m_LoopEnd = loops.empty() ? m_FrameCount : loops.front().end + 1;
+    }
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // AudioMixer
+    AudioMixer::AudioMixer(uint32_t sampleRate, uint32_t blockFrameCount, uint16_t voiceCount, Resampler resampler) :
+        m_SampleRate{ sampleRate },
+        m_BlockFrameCount{ std::max(blockFrameCount, 1u) },
+        m_Resampler{ resampler },
+        m_TapCount{ resampler == Resampler::Linear ? audio::linearTapCount : audio::polyphaseTapCount },
+        // A whole block at twice the output rate in one go
+        m_SourceFrameCapacity{ 2 * std::size_t{ m_BlockFrameCount } + m_TapCount },
+        m_LimiterRelease{ static_cast<float>(1.0 - std::exp(-static_cast<double>(m_BlockFrameCount) / sampleRate / limiterReleaseSeconds)) },
+        m_Voices(voiceCount),
+        m_Block(std::size_t{ m_BlockFrameCount } * m_ChannelCount),
+        m_SourceFrames(m_SourceFrameCapacity * MixerSound::m_MaxChannelCount),
+        m_VoiceFrames(std::size_t{ m_BlockFrameCount } * MixerSound::m_MaxChannelCount)
+    {
+        m_EndedVoices.reserve(voiceCount);
+    }
+
+    void AudioMixer::Play(uint16_t voice, const MixerSound* pSound, bool isLooping, float volume, float frequency)
+    {
+        assert(voice < m_Voices.size() && pSound);
+        const double ratio{ static_cast<double>(std::clamp(frequency, minFrequency, maxFrequency)) * pSound->GetSampleRate() / m_SampleRate };
+        const auto step{ static_cast<uint64_t>(std::llround(std::ldexp(ratio, audio::positionFractionBits))) };
+        m_Voices[voice] = Voice{ pSound, 0, std::max<uint64_t>(step, 1), volume, isLooping, false };
+    }
+
+    void AudioMixer::Stop(uint16_t voice)
+    {
+        m_Voices[voice] = Voice{};
+    }
+
+    void AudioMixer::Pause(uint16_t voice)
+    {
+        if (m_Voices[voice].pSound) m_Voices[voice].isPaused = true;
+    }
+
+    void AudioMixer::Resume(uint16_t voice)
+    {
+        m_Voices[voice].isPaused = false;
+    }
+
+    void AudioMixer::Seek(uint16_t voice, uint64_t frame)
+    {
+        Voice& seekedVoice{ m_Voices[voice] };
+        if (!seekedVoice.pSound) return;
+
+        const MixerSound& sound{ *seekedVoice.pSound };
+        const uint64_t loopBegin{ sound.GetLoopBegin() };
+        const uint64_t loopEnd{ sound.GetLoopEnd() };
+        frame = seekedVoice.isLooping && frame >= loopEnd ? loopBegin + (frame - loopBegin) % (loopEnd - loopBegin) : std::min<uint64_t>(frame, sound.GetFrameCount() - 1);
+        seekedVoice.position = frame << audio::positionFractionBits;
+    }
+
+    uint64_t AudioMixer::GetPosition(uint16_t voice) const
+    {
+        const Voice& positionedVoice{ m_Voices[voice] };
+        if (!positionedVoice.pSound) return 0;
+
+        const MixerSound& sound{ *positionedVoice.pSound };
+        const uint64_t frame{ positionedVoice.position >> audio::positionFractionBits };
+        if (!positionedVoice.isLooping || frame < sound.GetLoopEnd()) return std::min<uint64_t>(frame, sound.GetFrameCount());
+        return sound.GetLoopBegin() + (frame - sound.GetLoopEnd()) % (sound.GetLoopEnd() - sound.GetLoopBegin());
+    }
+
+    std::span<const float> AudioMixer::Mix()
+    {
+        std::ranges::fill(m_Block, 0.f);
+        m_EndedVoices.clear();
+
+        for (std::size_t index = 0; index < m_Voices.size(); ++index)
+        {
+            Voice& voice{ m_Voices[index] };
+            if (!voice.pSound || voice.isPaused) continue;
+            if (MixVoice(voice))
+            {
+                voice = Voice{};
+                m_EndedVoices.push_back(static_cast<uint16_t>(index));
+            }
+        }
+
+        Limit();
+        return m_Block;
+    }
+
+    // The position runs on past the end of the loop instead of going back to its start, and the frames past the end are read from the loop.
+    // That way the resampler's history right after going back is the end of the loop, which is what plays before it, rather than what lies before its start.
+    bool AudioMixer::MixVoice(Voice& voice)
+    {
+        const MixerSound& sound{ *voice.pSound };
+        const uint16_t channelCount{ sound.GetChannelCount() };
+        const uint64_t end{ uint64_t{ sound.GetFrameCount() } << audio::positionFractionBits };
+        const uint64_t loopEnd{ sound.GetLoopEnd() };
+        const uint64_t loopLength{ loopEnd - sound.GetLoopBegin() };
+        const auto historyFrameCount{ static_cast<int64_t>(m_TapCount / 2 - 1) };
+        // The furthest a chunk's last frame may lie past the whole part of its first position, so its taps fit the source frames
+        const uint64_t maxReach{ (uint64_t{ m_SourceFrameCapacity - m_TapCount + 1 } << audio::positionFractionBits) - 1 };
+
+        std::size_t mixedCount{};
+        while (mixedCount < m_BlockFrameCount)
+        {
+            if (!voice.isLooping && voice.position >= end) break;
+
+            // Chunks end with the block, the sound, or the source frames that fit
+            const uint64_t fraction{ voice.position & audio::positionFractionMask };
+            std::size_t count{ m_BlockFrameCount - mixedCount };
+            if (!voice.isLooping) count = static_cast<std::size_t>(std::min<uint64_t>(count, (end - voice.position + voice.step - 1) / voice.step));
+            count = static_cast<std::size_t>(std::min<uint64_t>(count, (maxReach - fraction) / voice.step + 1));
+
+            const int64_t firstFrame{ static_cast<int64_t>(voice.position >> audio::positionFractionBits) - historyFrameCount };
+            const std::size_t sourceCount{ static_cast<std::size_t>((fraction + (count - 1) * voice.step) >> audio::positionFractionBits) + m_TapCount };
+            for (uint16_t channel = 0; channel < channelCount; ++channel)
+            {
+                float* const pSource{ m_SourceFrames.data() + channel * m_SourceFrameCapacity };
+                Gather(voice, channel, firstFrame, sourceCount, pSource);
+
+                const std::span<const float> source{ pSource, sourceCount };
+                const std::span<float> destination{ m_VoiceFrames.data() + channel * std::size_t{ m_BlockFrameCount } + mixedCount, count };
+                // A sound at the output rate and unpitched is copied, filtering it would only dull it
+                if (voice.step == unitStep && fraction == 0) std::copy_n(pSource + historyFrameCount, count, destination.data());
+                else if (m_Resampler == Resampler::Linear) audio::ResampleLinear(source, fraction, voice.step, destination);
+                else audio::ResamplePolyphase(source, fraction, voice.step, destination);
+            }
+
+            voice.position += count * voice.step;
+            mixedCount += count;
+
+            // Back by whole loops once a full loop past its end, which leaves the history in the loop
+            if (const uint64_t frame{ voice.position >> audio::positionFractionBits }; voice.isLooping && frame >= loopEnd + loopLength)
+                voice.position = ((loopEnd + (frame - loopEnd) % loopLength) << audio::positionFractionBits) | (voice.position & audio::positionFractionMask);
+        }
+
+        const std::span<float> block{ std::span<float>{ m_Block }.first(mixedCount * m_ChannelCount) };
+        const std::span<const float> left{ m_VoiceFrames.data(), mixedCount };
+        if (channelCount == 1) audio::MixMono(left, block, voice.gain, voice.gain);
+        else audio::MixStereo(left, { m_VoiceFrames.data() + m_BlockFrameCount, mixedCount }, block, voice.gain, voice.gain);
+
+        return !voice.isLooping && voice.position >= end;
+    }
+
+    // Copies frames of one channel of the voice's sound, from firstFrame on, the way MixVoice reads them:
+    // frames before the start and past the end are silent, except when looping, where those past the end of the loop come from the loop.
+    void AudioMixer::Gather(const Voice& voice, uint16_t channel, int64_t firstFrame, std::size_t frameCount, float* pDestination) const
+    {
+        const MixerSound& sound{ *voice.pSound };
+        const float* const pSamples{ sound.GetChannel(channel).data() };
+        const int64_t soundFrameCount{ sound.GetFrameCount() };
+        const int64_t loopBegin{ sound.GetLoopBegin() };
+        const int64_t loopEnd{ sound.GetLoopEnd() };
+
+        int64_t frame{ firstFrame };
+        while (frameCount > 0)
+        {
+            std::size_t runCount{};
+            if (frame < 0)
+            {
+                runCount = static_cast<std::size_t>(std::min<int64_t>(static_cast<int64_t>(frameCount), -frame));
+                std::fill_n(pDestination, runCount, 0.f);
+            }
+            else if (voice.isLooping && frame >= loopEnd)
+            {
+                const int64_t loopFrame{ loopBegin + (frame - loopEnd) % (loopEnd - loopBegin) };
+                runCount = static_cast<std::size_t>(std::min<int64_t>(static_cast<int64_t>(frameCount), loopEnd - loopFrame));
+                std::copy_n(pSamples + loopFrame, runCount, pDestination);
+            }
+            else if (frame >= soundFrameCount)
+            {
+                runCount = frameCount;
+                std::fill_n(pDestination, runCount, 0.f);
+            }
+            else
+            {
+                const int64_t runEnd{ voice.isLooping ? loopEnd : soundFrameCount };
+                runCount = static_cast<std::size_t>(std::min<int64_t>(static_cast<int64_t>(frameCount), runEnd - frame));
+                std::copy_n(pSamples + frame, runCount, pDestination);
+            }
+
+            frame += static_cast<int64_t>(runCount);
+            pDestination += runCount;
+            frameCount -= runCount;
+        }
+    }
+
+    // Follows peaks at once and recovers slowly, ramping over each block so the gain never jumps.
+    // The ramp starts at the previous block's gain, so a peak right at the start of a louder block can still go over and is clamped.
+    void AudioMixer::Limit()
+    {
+        const float peak{ audio::GetPeak(m_Block) * m_MasterGain };
+        float limiterGain{ m_LimiterGain + (1.f - m_LimiterGain) * m_LimiterRelease };
+        if (peak * limiterGain > limiterThreshold) limiterGain = limiterThreshold / peak;
+
+        const float gain{ m_MasterGain * limiterGain };
+        audio::ApplyGainRamp(m_Block, m_AppliedGain, gain);
+        audio::Clamp(m_Block, 1.f);
+
+        m_AppliedGain = gain;
+        m_LimiterGain = limiterGain;
+    }
+    //---------------------------------------------------------------
+}
@@ -0,0 +1,162 @@
+#include "AudioOutput.h"
+#include "AudioKernels.h"
+#include "FileExceptions.h"
+#include <algorithm>
+#include <array>
+#include <cassert>
+#include <cstring>
+
+namespace jela
+{
+    namespace
+    {
+        constexpr std::size_t waveHeaderSize{ 44 };
+
+        void WriteLittleEndian(std::array<char, waveHeaderSize>& header, std::size_t offset, uint32_t value, std::size_t size)
+        {
+            for (std::size_t index = 0; index < size; ++index) header[offset + index] = static_cast<char>((value >> (8 * index)) & 0xFF);
+        }
+    }
+
+    //---------------------------------------------------------------
+    // NullAudioOutput
+    void NullAudioOutput::Write(std::span<const float> samples, std::stop_token)
+    {
+        m_FrameCount.fetch_add(samples.size() / m_ChannelCount, std::memory_order_relaxed);
+    }
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // WaveFileAudioOutput
+    WaveFileAudioOutput::WaveFileAudioOutput(const std::filesystem::path& filePath) :
+        m_File{ filePath, std::ios::binary | std::ios::trunc }
+    {
+        if (!m_File) throw FileLoadException{ std::format("Could not create {} to record audio to.\n", filePath.string()) };
+    }
+
+    WaveFileAudioOutput::~WaveFileAudioOutput()
+    {
+        if (m_ChannelCount == 0) return;
+        m_File.seekp(0);
+        WriteHeader();
+    }
+
+    void WaveFileAudioOutput::Open(uint32_t sampleRate, uint16_t channelCount)
+    {
+        m_SampleRate = sampleRate;
+        m_ChannelCount = channelCount;
+        // Written with sizes of 0 for now
+        WriteHeader();
+    }
+
+    void WaveFileAudioOutput::Write(std::span<const float> samples, std::stop_token)
+    {
+        m_Samples.resize(samples.size());
+        audio::ToInt16(samples, m_Samples);
+        // Every platform the engine builds for is little-endian, like the file
+        m_File.write(reinterpret_cast<const char*>(m_Samples.data()), static_cast<std::streamsize>(m_Samples.size() * sizeof(int16_t)));
+        m_DataSize += m_Samples.size() * sizeof(int16_t);
+    }
+
+    void WaveFileAudioOutput::WriteHeader()
+    {
+        constexpr uint16_t bitsPerSample{ 16 };
+        const uint16_t blockAlign{ static_cast<uint16_t>(m_ChannelCount * bitsPerSample / 8) };
+        // A recording past 4 GiB keeps playing up to there
+        const auto dataSize{ static_cast<uint32_t>(std::min<uint64_t>(m_DataSize, UINT32_MAX - waveHeaderSize) / blockAlign * blockAlign) };
+
+        std::array<char, waveHeaderSize> header{};
+        std::memcpy(header.data(), "RIFF", 4);
+        WriteLittleEndian(header, 4, static_cast<uint32_t>(waveHeaderSize - 8 + dataSize), 4);
+        std::memcpy(header.data() + 8, "WAVEfmt ", 8);
+        WriteLittleEndian(header, 16, 16, 4);
+        WriteLittleEndian(header, 20, 1, 2);
+        WriteLittleEndian(header, 22, m_ChannelCount, 2);
+        WriteLittleEndian(header, 24, m_SampleRate, 4);
+        WriteLittleEndian(header, 28, m_SampleRate * blockAlign, 4);
+        WriteLittleEndian(header, 32, blockAlign, 2);
+        WriteLittleEndian(header, 34, bitsPerSample, 2);
+        std::memcpy(header.data() + 36, "data", 4);
+        WriteLittleEndian(header, 40, dataSize, 4);
+        m_File.write(header.data(), static_cast<std::streamsize>(header.size()));
+    }
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // RingBufferAudioOutput
+    RingBufferAudioOutput::RingBufferAudioOutput(std::size_t frameCapacity) :
+        m_FrameCapacity{ std::max<std::size_t>(frameCapacity, 1) }
+    {
+    }
+
+    void RingBufferAudioOutput::Open(uint32_t sampleRate, uint16_t channelCount)
+    {
+        m_SampleRate = sampleRate;
+        m_ChannelCount = channelCount;
+        m_Samples.assign(m_FrameCapacity * channelCount, 0.f);
+    }
+
+    void RingBufferAudioOutput::Write(std::span<const float> samples, std::stop_token stopToken)
+    {
+        const std::stop_callback wakeOnStop{ stopToken, [this] { Wake(); } };
+        const std::size_t capacity{ m_Samples.size() };
+        uint64_t writePosition{ m_WritePosition.load(std::memory_order_relaxed) };
+
+        // A block larger than the ring goes in as it empties
+        while (!samples.empty())
+        {
+            // Read before checking for room, so a read in between makes the wait return
+            const uint32_t signal{ m_Signal.load(std::memory_order_acquire) };
+            const auto freeSize{ static_cast<std::size_t>(capacity - (writePosition - m_ReadPosition.load(std::memory_order_acquire))) };
+            if (freeSize == 0)
+            {
+                if (stopToken.stop_requested()) return;
+                m_Signal.wait(signal, std::memory_order_acquire);
+                continue;
+            }
+
+            const std::size_t writeSize{ std::min(freeSize, samples.size()) };
+            const auto offset{ static_cast<std::size_t>(writePosition % capacity) };
+            const std::size_t firstSize{ std::min(writeSize, capacity - offset) };
+            std::memcpy(m_Samples.data() + offset, samples.data(), firstSize * sizeof(float));
+            std::memcpy(m_Samples.data(), samples.data() + firstSize, (writeSize - firstSize) * sizeof(float));
+
+            writePosition += writeSize;
+            m_WritePosition.store(writePosition, std::memory_order_release);
+            samples = samples.subspan(writeSize);
+        }
+    }
+
+    std::size_t RingBufferAudioOutput::Read(std::span<float> destination)
+    {
+        assert(m_ChannelCount > 0);
+        const std::size_t capacity{ m_Samples.size() };
+        const uint64_t readPosition{ m_ReadPosition.load(std::memory_order_relaxed) };
+        const auto readableSize{ static_cast<std::size_t>(m_WritePosition.load(std::memory_order_acquire) - readPosition) };
+        // The writer adds whole blocks but may stop halfway one, so the size is cut to whole frames
+        const std::size_t readSize{ std::min(readableSize, destination.size()) / m_ChannelCount * m_ChannelCount };
+        if (readSize == 0) return 0;
+
+        const auto offset{ static_cast<std::size_t>(readPosition % capacity) };
+        const std::size_t firstSize{ std::min(readSize, capacity - offset) };
+        std::memcpy(destination.data(), m_Samples.data() + offset, firstSize * sizeof(float));
+        std::memcpy(destination.data() + firstSize, m_Samples.data(), (readSize - firstSize) * sizeof(float));
+
+        m_ReadPosition.store(readPosition + readSize, std::memory_order_release);
+        Wake();
+        return readSize / m_ChannelCount;
+    }
+
+    std::size_t RingBufferAudioOutput::GetReadableFrameCount() const
+    {
+        const uint64_t readableSize{ m_WritePosition.load(std::memory_order_acquire) - m_ReadPosition.load(std::memory_order_acquire) };
+        return static_cast<std::size_t>(readableSize / m_ChannelCount);
+    }
+
+    void RingBufferAudioOutput::Wake()
+    {
+        m_Signal.fetch_add(1, std::memory_order_release);
+        m_Signal.notify_one();
+    }
+    //---------------------------------------------------------------
+}
@@ -10,114 +10,42 @@ namespace jela
 	std::unique_ptr<AudioService> AudioLocator::m_Instance{ std::make_unique<NullAudio>() };
 	//------------------------------------------------------------------------------------------------------------------------------
 
-	//------------------------------------------------------------------------------------------------------------------------------
-	// SoundInstanceID
-	SoundInstanceID::~SoundInstanceID() { if (m_pSubject) m_pSubject->RemoveObserver(this); }
-
-	SoundInstanceID::SoundInstanceID(const SoundInstanceID& other)
-        : m_Id{other.m_Id}
-          , m_pSubject{other.m_pSubject}
-    {
-        if (m_pSubject) m_pSubject->AddObserver(this);
-    }
-
-	SoundInstanceID::SoundInstanceID(SoundInstanceID&& other) noexcept
-        : m_Id{std::move(other.m_Id)}
-          , m_pSubject{std::move(other.m_pSubject) }
-	{
-		if (m_pSubject)
-		{
-			m_pSubject->RemoveObserver(&other);
-			m_pSubject->AddObserver(this);
-		}
-
-		other.m_pSubject = nullptr;
-        other.m_Id = std::nullopt;
-	}
-
-	SoundInstanceID& SoundInstanceID::operator= (const SoundInstanceID& other)
-	{
-		m_pSubject = other.m_pSubject;
-		m_Id = other.m_Id;
-		if (m_pSubject) m_pSubject->AddObserver(this);
-
-		return *this;
-	}
-
-	SoundInstanceID& SoundInstanceID::operator= (SoundInstanceID&& other) noexcept
-	{
-		m_pSubject = std::move(other.m_pSubject);
-        m_Id = std::move(other.m_Id);
-
-		if (m_pSubject)
-		{
-			m_pSubject->RemoveObserver(&other);
-			m_pSubject->AddObserver(this);
-        }
-
-        other.m_pSubject = nullptr;
-		other.m_Id = std::nullopt;
-
-		return *this;
-    }
-
-    void SoundInstanceID::Init(uint8_t index)
-	{
-		if (!m_Id.has_value()) m_Id = index;
-		else OutputDebugString(_T("SoundInstanceID was already initialized when trying to initialize."));
-	}
-	void SoundInstanceID::SaveSubject(Subject<uint8_t, std::vector<SoundInstanceID*>&>* pSubject)
-	{
-		if (pSubject) m_pSubject = pSubject;
-		else OutputDebugString(_T("Subject was nullptr when trying to save it to a SoundInstanceID SingleSubjectsObserver."));
-	}
-
-	void SoundInstanceID::Notify(uint8_t index, std::vector<SoundInstanceID*>& vecThisObservers)
-    {
-        if (m_Id.has_value() && m_Id.value() == index)
-		{
-			m_Id = std::nullopt;
-			m_pSubject = nullptr;
-			vecThisObservers.emplace_back(this);
-		}
-	}
-	void SoundInstanceID::OnSubjectDestroy(Subject<uint8_t, std::vector<SoundInstanceID*>&>* pSubject)
-	{
-		if (pSubject == m_pSubject) m_Id = std::nullopt;
-		m_pSubject = nullptr;
-	}
-	//------------------------------------------------------------------------------------------------------------------------------
-
 	//------------------------------------------------------------------------------------------------------------------------------
 	// LogAudio
-	void LogAudio::AddSound(const tstring& path, SoundID id)
+	void LogAudio::AddSound(const tstring& path, SoundID id, bool stream)
 	{
-		OutputDebugString(std::format(_T("LogAudio: AddSound: path: {}, id: {}\n"), path, id).c_str());
-		m_pRealService->AddSound(path, id);
+		OutputDebugString(std::format(_T("LogAudio: AddSound: path: {}, id: {}, stream: {}\n"), path, id, stream).c_str());
+		m_pRealService->AddSound(path, id, stream);
 	}
 	void LogAudio::RemoveSound(SoundID id)
 	{
 		OutputDebugString(std::format(_T("LogAudio: RemoveSound: id: {}\n"), id).c_str());
 		m_pRealService->RemoveSound(id);
 	}
-	void LogAudio::PlaySoundClip(SoundID id, bool repeat, uint8_t volume, float frequency) const
+	void LogAudio::ReloadSound(const tstring& filename)
+	{
+		OutputDebugString(std::format(_T("LogAudio: ReloadSound: path: {}\n"), filename).c_str());
+		m_pRealService->ReloadSound(filename);
+	}
+	void LogAudio::PlaySoundClip(SoundID id, bool repeat, uint8_t volume, float frequency, uint8_t priority) const
     {
         OutputDebugString(
             std::format(
-                _T("LogAudio: PlaySoundClip: id: {}, repeat: {}, Volume {}, Frequency {}\n"), id, repeat,
-                static_cast<int>(volume), frequency).c_str());
-		m_pRealService->PlaySoundClip(id, repeat, volume, frequency);
+                _T("LogAudio: PlaySoundClip: id: {}, repeat: {}, Volume {}, Frequency {}, Priority {}\n"), id, repeat,
+                static_cast<int>(volume), frequency, static_cast<int>(priority)).c_str());
+		m_pRealService->PlaySoundClip(id, repeat, volume, frequency, priority);
 	}
-	void LogAudio::PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume, float frequency) const
+	void LogAudio::PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume, float frequency, uint8_t priority) const
 	{
-		OutputDebugString(std::format(_T("LogAudio: PlaySoundInstance: id: {}, repeat: {}, Instance id: {}, Volume {}, Frequency {}\n"),
+		OutputDebugString(std::format(_T("LogAudio: PlaySoundInstance: id: {}, repeat: {}, Instance id: {}, Volume {}, Frequency {}, Priority {}\n"),
 			id,
 			repeat,
 			instanceId.GetID().has_value() ? to_tstring(instanceId.GetID().value()) : _T("std::nullopt"),
 			volume,
-			frequency
+			frequency,
+			static_cast<int>(priority)
 		).c_str());
-		m_pRealService->PlaySoundInstance(id, repeat, instanceId, volume);
+		m_pRealService->PlaySoundInstance(id, repeat, instanceId, volume, frequency, priority);
 	}
 	uint8_t LogAudio::GetMasterVolume() const
 	{
@@ -190,5 +118,15 @@ namespace jela
 		OutputDebugString(_T("LogAudio: StopAllSounds\n"));
 		m_pRealService->StopAllSounds();
 	}
+	void LogAudio::SeekSound(SoundID id, const SoundInstanceID& instanceId, float seconds) const
+	{
+		OutputDebugString(std::format(_T("LogAudio: SeekSound: id: {}, Instance id: {}, Seconds: {}\n"), id, instanceId.GetID().has_value() ? to_tstring(instanceId.GetID().value()) : _T("std::nullopt"), seconds).c_str());
+		m_pRealService->SeekSound(id, instanceId, seconds);
+	}
+	void LogAudio::Update()
+	{
+		// Not logged, it is called every frame
+		m_pRealService->Update();
+	}
 	//------------------------------------------------------------------------------------------------------------------------------
 }
@@ -0,0 +1,315 @@
+#include "AudioStream.h"
+#include "AudioDecoder.h"
+#include <algorithm>
+#include <cassert>
+#include <cstring>
+#include <functional>
+
+namespace jela
+{
+    namespace
+    {
+        // Copies the data from position on into buffer, going back to loopBegin at loopEnd when looping. readAt gives the bytes of the data
+        // from a position on, as many as follow it in memory. Returns the number of bytes written and moves position past them.
+        template <typename ReadAt>
+        std::size_t FillBuffer(std::span<std::byte> buffer, std::size_t dataSize, std::size_t& position, bool isLooping, std::size_t loopBegin, std::size_t loopEnd, ReadAt readAt)
+        {
+            const std::size_t stop{ isLooping ? loopEnd : dataSize };
+            std::size_t filledSize{};
+            while (filledSize < buffer.size())
+            {
+                if (position == stop)
+                {
+                    if (!isLooping) break;
+                    position = loopBegin;
+                }
+
+                const std::span<const std::byte> source{ readAt(position) };
+                const std::size_t copySize{ std::min({ buffer.size() - filledSize, stop - position, source.size() }) };
+                std::memcpy(buffer.data() + filledSize, source.data(), copySize);
+                filledSize += copySize;
+                position += copySize;
+            }
+            return filledSize;
+        }
+    }
+
+    //---------------------------------------------------------------
+    // AudioStream
+    AudioStream::AudioStream(AudioStreamer* pStreamer, AudioStreamSink* pSink, std::size_t bufferSize, uint32_t bufferCount) :
+        m_pStreamer{ pStreamer },
+        m_pSink{ pSink },
+        m_BufferSize{ bufferSize },
+        m_BufferCount{ std::max(bufferCount, 2u) },
+        m_Buffers(m_BufferSize * m_BufferCount)
+    {
+    }
+
+    void AudioStream::Start(std::span<const std::byte> data, std::shared_ptr<const void> pDataOwner, uint32_t frameSize, bool isLooping, uint64_t loopBegin, uint64_t loopEnd)
+    {
+        assert(frameSize > 0);
+        StartData(data.first(data.size() / frameSize * frameSize), std::move(pDataOwner), nullptr, false, frameSize, data.size() / frameSize, isLooping, loopBegin, loopEnd);
+    }
+
+    void AudioStream::Start(std::span<const std::byte> data, std::shared_ptr<const void> pDataOwner, std::shared_ptr<const audio::BlockDecoder> pDecoder, bool isCached,
+        bool isLooping, uint64_t loopBegin, uint64_t loopEnd)
+    {
+        assert(pDecoder);
+        const uint32_t blockSize{ pDecoder->GetBlockSize() };
+        const uint32_t frameSize{ pDecoder->GetDecodedFormat().blockAlign };
+        const uint64_t frameCount{ pDecoder->GetFrameCount(data.size()) };
+        StartData(data.first(data.size() / blockSize * blockSize), std::move(pDataOwner), std::move(pDecoder), isCached, frameSize, frameCount, isLooping, loopBegin, loopEnd);
+    }
+
+    void AudioStream::StartData(std::span<const std::byte> data, std::shared_ptr<const void> pDataOwner, std::shared_ptr<const audio::BlockDecoder> pDecoder, bool isCached,
+        uint32_t frameSize, uint64_t frameCount, bool isLooping, uint64_t loopBegin, uint64_t loopEnd)
+    {
+        assert(!IsActive() && frameSize > 0 && frameSize <= m_BufferSize && frameCount > 0);
+        {
+            const std::lock_guard<std::mutex> lock{ m_Mutex };
+            m_Data = data;
+            m_pDataOwner = std::move(pDataOwner);
+            m_pDecoder = std::move(pDecoder);
+            m_IsCached = isCached;
+            m_FrameSize = frameSize;
+            m_IsLooping = isLooping;
+            m_Size = static_cast<std::size_t>(frameCount * frameSize);
+
+            // A loop that doesn't fit the data loops all of it
+            if (loopEnd == 0 || loopEnd > frameCount || loopBegin >= loopEnd)
+            {
+                loopBegin = 0;
+                loopEnd = frameCount;
+            }
+            m_LoopBegin = static_cast<std::size_t>(loopBegin * frameSize);
+            m_LoopEnd = static_cast<std::size_t>(loopEnd * frameSize);
+            m_IsFinished = false;
+            m_Position = 0;
+            ++m_Generation;
+            m_SeekFrame.store(m_NoSeek, std::memory_order_relaxed);
+            m_EndCount.store(m_NoEnd, std::memory_order_relaxed);
+            m_IsActive.store(true, std::memory_order_relaxed);
+        }
+        m_pStreamer->Wake();
+    }
+
+    void AudioStream::Stop()
+    {
+        std::shared_ptr<const void> pDataOwner{};
+        std::shared_ptr<const audio::BlockDecoder> pDecoder{};
+        {
+            const std::lock_guard<std::mutex> lock{ m_Mutex };
+            if (!IsActive()) return;
+
+            ++m_Generation;
+            m_IsActive.store(false, std::memory_order_relaxed);
+            m_EndCount.store(m_NoEnd, std::memory_order_relaxed);
+            m_Data = {};
+            pDataOwner = std::move(m_pDataOwner);
+            pDecoder = std::move(m_pDecoder);
+        }
+        // The data may be released here, rather than while holding the lock
+    }
+
+    void AudioStream::Seek(uint64_t frame)
+    {
+        m_SeekFrame.store(frame, std::memory_order_relaxed);
+        m_pStreamer->Wake();
+    }
+
+    bool AudioStream::OnBufferEnd()
+    {
+        const uint64_t endedCount{ m_EndedCount.fetch_add(1, std::memory_order_acq_rel) + 1 };
+        m_pStreamer->Wake();
+        return endedCount == m_EndCount.load(std::memory_order_acquire);
+    }
+
+    bool AudioStream::Update()
+    {
+        bool hasWorked{};
+        std::unique_lock<std::mutex> lock{ m_Mutex };
+
+        while (IsActive())
+        {
+            if (const uint64_t seekFrame{ m_SeekFrame.exchange(m_NoSeek, std::memory_order_relaxed) }; seekFrame != m_NoSeek)
+            {
+                const uint64_t frameCount{ m_Size / m_FrameSize };
+                const uint64_t loopBegin{ m_LoopBegin / m_FrameSize };
+                const uint64_t loopEnd{ m_LoopEnd / m_FrameSize };
+                const uint64_t frame{ m_IsLooping && seekFrame >= loopEnd ? loopBegin + (seekFrame - loopBegin) % (loopEnd - loopBegin) : std::min(seekFrame, frameCount - 1) };
+                m_Position = static_cast<std::size_t>(frame * m_FrameSize);
+                m_IsFinished = false;
+                // Before flushing, or the last buffer ending because of the flush would count as the end of the stream
+                m_EndCount.store(m_NoEnd, std::memory_order_release);
+                m_pSink->FlushBuffers();
+                hasWorked = true;
+            }
+
+            if (m_IsFinished) break;
+            const uint64_t submittedCount{ m_SubmittedCount.load(std::memory_order_relaxed) };
+            if (submittedCount - m_EndedCount.load(std::memory_order_acquire) >= m_BufferCount) break;
+
+            // The free buffer is only touched by this thread, so it is filled without holding the lock.
+            // The copies of the owner and decoder keep them alive even if the stream is stopped meanwhile.
+            const uint32_t generation{ m_Generation };
+            const std::span<const std::byte> data{ m_Data };
+            const std::shared_ptr<const void> pDataOwner{ m_pDataOwner };
+            const std::shared_ptr<const audio::BlockDecoder> pDecoder{ m_pDecoder };
+            const bool isCached{ m_IsCached };
+            const std::size_t size{ m_Size };
+            const uint32_t frameSize{ m_FrameSize };
+            const bool isLooping{ m_IsLooping };
+            const std::size_t loopBegin{ m_LoopBegin };
+            const std::size_t loopEnd{ m_LoopEnd };
+            std::size_t position{ m_Position };
+            const std::span<std::byte> buffer{ m_Buffers.data() + (submittedCount % m_BufferCount) * m_BufferSize, m_BufferSize / m_FrameSize * m_FrameSize };
+
+            lock.unlock();
+            std::size_t filledSize{};
+            if (!pDecoder) filledSize = FillBuffer(buffer, size, position, isLooping, loopBegin, loopEnd, [data](std::size_t at) { return data.subspan(at); });
+            else
+            {
+                const std::size_t blockSize{ std::size_t{ pDecoder->GetFramesPerBlock() } * frameSize };
+                filledSize = FillBuffer(buffer, size, position, isLooping, loopBegin, loopEnd, [&](std::size_t at)
+                    {
+                        return GetDecodedBlock(data, pDecoder, isCached, generation, at / blockSize).subspan(at % blockSize);
+                    });
+            }
+            lock.lock();
+
+            // Stopped, started again or seeked while filling, the buffer is filled again if still needed
+            if (generation != m_Generation || m_SeekFrame.load(std::memory_order_relaxed) != m_NoSeek) continue;
+
+            m_Position = position;
+            m_IsFinished = !isLooping && position == size;
+            if (m_IsFinished) m_EndCount.store(submittedCount + 1, std::memory_order_release);
+            m_SubmittedCount.store(submittedCount + 1, std::memory_order_relaxed);
+            m_pSink->SubmitBuffer(buffer.first(filledSize), m_IsFinished);
+            hasWorked = true;
+        }
+
+        return hasWorked;
+    }
+
+    std::span<const std::byte> AudioStream::GetDecodedBlock(std::span<const std::byte> data, const std::shared_ptr<const audio::BlockDecoder>& pDecoder, bool isCached,
+        uint32_t generation, uint64_t blockIndex)
+    {
+        if (isCached) return std::as_bytes(m_pStreamer->GetBlockCache().GetBlock(data, pDecoder, blockIndex));
+
+        const std::size_t sampleCount{ std::size_t{ pDecoder->GetFramesPerBlock() } * pDecoder->GetDecodedFormat().channelCount };
+        if (!m_HasBlock || m_BlockGeneration != generation || m_BlockIndex != blockIndex)
+        {
+            // Only grows, so after the first block of the largest sound this stream played nothing is allocated anymore
+            if (m_Block.size() < sampleCount) m_Block.resize(sampleCount);
+            const std::size_t blockSize{ pDecoder->GetBlockSize() };
+            pDecoder->DecodeBlock(data.subspan(static_cast<std::size_t>(blockIndex * blockSize), blockSize), m_Block);
+            m_HasBlock = true;
+            m_BlockGeneration = generation;
+            m_BlockIndex = blockIndex;
+        }
+        return std::as_bytes(std::span{ m_Block }.first(sampleCount));
+    }
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // DecodedBlockCache
+    std::size_t DecodedBlockCache::KeyHash::operator()(const Key& key) const
+    {
+        return std::hash<const void*>{}(key.pDecoder) ^ static_cast<std::size_t>(key.blockIndex * 0x9E3779B97F4A7C15ull);
+    }
+
+    DecodedBlockCache::DecodedBlockCache(std::size_t capacity) :
+        m_Capacity{ capacity }
+    {
+    }
+
+    std::span<const int16_t> DecodedBlockCache::GetBlock(std::span<const std::byte> data, const std::shared_ptr<const audio::BlockDecoder>& pDecoder, uint64_t blockIndex)
+    {
+        const Key key{ pDecoder.get(), blockIndex };
+        const std::size_t sampleCount{ std::size_t{ pDecoder->GetFramesPerBlock() } * pDecoder->GetDecodedFormat().channelCount };
+        const auto decode{ [&](Entry& entry)
+            {
+                const std::size_t blockSize{ pDecoder->GetBlockSize() };
+                pDecoder->DecodeBlock(data.subspan(static_cast<std::size_t>(blockIndex * blockSize), blockSize), entry.samples);
+            } };
+
+        if (const auto it{ m_EntryIts.find(key) }; it != m_EntryIts.end())
+        {
+            m_Entries.splice(m_Entries.begin(), m_Entries, it->second);
+            Entry& entry{ m_Entries.front() };
+            // Left behind by a decoder that was destroyed, this one just got its address
+            if (entry.pDecoder.expired())
+            {
+                m_Size -= entry.samples.capacity() * sizeof(int16_t);
+                entry.samples.resize(sampleCount);
+                m_Size += entry.samples.capacity() * sizeof(int16_t);
+                entry.pDecoder = pDecoder;
+                decode(entry);
+            }
+            return entry.samples;
+        }
+
+        // A dropped block of the same size gives its memory to the new one, so a full cache of like sounds allocates little more than the map's nodes
+        std::vector<int16_t> samples{};
+        const std::size_t blockBytes{ sampleCount * sizeof(int16_t) };
+        while (!m_Entries.empty() && m_Size + blockBytes > m_Capacity)
+        {
+            Entry& oldest{ m_Entries.back() };
+            m_Size -= oldest.samples.capacity() * sizeof(int16_t);
+            if (oldest.samples.capacity() == sampleCount) samples = std::move(oldest.samples);
+            m_EntryIts.erase(oldest.key);
+            m_Entries.pop_back();
+        }
+        samples.resize(sampleCount);
+        m_Size += samples.capacity() * sizeof(int16_t);
+
+        Entry& entry{ m_Entries.emplace_front(Entry{ key, pDecoder, std::move(samples) }) };
+        m_EntryIts.emplace(key, m_Entries.begin());
+        decode(entry);
+        return entry.samples;
+    }
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // AudioStreamer
+    AudioStreamer::AudioStreamer(std::size_t blockCacheSize) :
+        m_BlockCache{ blockCacheSize },
+        m_Thread{ [this](std::stop_token stopToken) { Run(stopToken); } }
+    {
+    }
+
+    AudioStream& AudioStreamer::CreateStream(AudioStreamSink* pSink, std::size_t bufferSize, uint32_t bufferCount)
+    {
+        const std::lock_guard<std::mutex> lock{ m_StreamsMutex };
+        return *m_Streams.emplace_back(std::make_unique<AudioStream>(this, pSink, bufferSize, bufferCount));
+    }
+
+    void AudioStreamer::Wake()
+    {
+        m_Signal.fetch_add(1, std::memory_order_release);
+        m_Signal.notify_one();
+    }
+
+    void AudioStreamer::Run(std::stop_token stopToken)
+    {
+        const std::stop_callback wakeOnStop{ stopToken, [this] { Wake(); } };
+
+        std::vector<AudioStream*> streams{};
+        while (!stopToken.stop_requested())
+        {
+            // Read before the pass, so a wake during it makes the wait return at once
+            const uint32_t signal{ m_Signal.load(std::memory_order_acquire) };
+            {
+                const std::lock_guard<std::mutex> lock{ m_StreamsMutex };
+                streams.clear();
+                for (const std::unique_ptr<AudioStream>& pStream : m_Streams) streams.push_back(pStream.get());
+            }
+
+            bool hasWorked{};
+            for (AudioStream* pStream : streams) hasWorked = pStream->Update() || hasWorked;
+
+            if (!hasWorked && !stopToken.stop_requested()) m_Signal.wait(signal, std::memory_order_acquire);
+        }
+    }
+    //---------------------------------------------------------------
+}
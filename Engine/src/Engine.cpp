@@ -1,5 +1,6 @@
 
 #include "Engine.h"
+#include "AudioLog.h"
 #include <algorithm>
 #include <numbers>
 
@@ -39,7 +40,9 @@ namespace jela
         m_pGame = nullptr;
 
         AudioLocator::RegisterAudioService(nullptr);
+        audio::SetLogSink({});
 
+        m_pEventBus = nullptr;
         m_pResourceManager = nullptr;
 
         SafeRelease(&m_pDBitmap);
@@ -309,7 +312,13 @@ namespace jela
                     m_pGame->HandleControllerInput();
                 }
 
+                m_pResourceManager->Update();
+
                 m_pGame->Tick();
+                // Events published during Tick reach their handlers before the frame is drawn
+                m_pEventBus->Dispatch();
+                // After the game played this frame's sounds, so they get their voices before it ends
+                AudioLocator::GetAudioService().Update();
                 Paint();
 
                 m_TriggerCount.QuadPart = currentCount.QuadPart + int(m_SecondsPerFrame * countsPersSecond.QuadPart);
@@ -341,6 +350,15 @@ namespace jela
             m_pResourceManager = std::make_unique<ResourceManager>(resourcePath);
             m_pResourceManager->Start();
 
+            m_pEventBus = std::make_unique<EventBus>();
+
+            // Audio errors get the same message box as the other exceptions of the engine
+            audio::SetLogSink([this](audio::LogLevel level, std::string_view message)
+                {
+                    OutputDebugStringA(std::string{ message }.c_str());
+                    if (level == audio::LogLevel::Error) NotifyException(std::string{ message });
+                });
+
             HRESULT hr{ S_OK };
             hr = MakeWindow();
 
@@ -1217,13 +1235,16 @@ namespace jela
     {
         if (m_TransformChanged)
         {
-            D2D1::Matrix3x2F combinedMatrix{D2D1::Matrix3x2F::Identity()};
+            Matrix3x2 combinedMatrix{Matrix3x2::Identity()};
             for (const auto& matrix : m_VecTransformMatrices)
             {
                 combinedMatrix = matrix * combinedMatrix;
             }
 
-            m_pDBitmapRenderTarget->SetTransform(combinedMatrix);
+            m_pDBitmapRenderTarget->SetTransform(D2D1::Matrix3x2F{
+                combinedMatrix.m11, combinedMatrix.m12,
+                combinedMatrix.m21, combinedMatrix.m22,
+                combinedMatrix.dx, combinedMatrix.dy });
 
             m_TransformChanged = false;
         }
@@ -1235,7 +1256,7 @@ namespace jela
         if (!m_VecTransformMatrices.empty())
         {
             auto& lastMatrix = m_VecTransformMatrices.back();
-            lastMatrix = D2D1::Matrix3x2F::Translation(xTranslation, -yTranslation) * lastMatrix;
+            lastMatrix = Matrix3x2::Translation(xTranslation, -yTranslation) * lastMatrix;
         }
         else OutputDebugString(_T("Vector of matrices was empty while trying to add a Translation matrix."));
 
@@ -1247,7 +1268,7 @@ namespace jela
         if (!m_VecTransformMatrices.empty())
         {
             auto& lastMatrix = m_VecTransformMatrices.back();
-            lastMatrix = D2D1::Matrix3x2F::Rotation(-angle, D2D1::Point2F(xPivotPoint, m_GameHeight - yPivotPoint)) * lastMatrix;
+            lastMatrix = Matrix3x2::Rotation(-angle, Point2f{ xPivotPoint, m_GameHeight - yPivotPoint }) * lastMatrix;
         }
         else OutputDebugString(_T("Vector of matrices was empty while trying to add a Rotation matrix."));
 
@@ -1258,8 +1279,8 @@ namespace jela
         if (!m_VecTransformMatrices.empty())
         {
             auto& lastMatrix = m_VecTransformMatrices.back();
-            lastMatrix = D2D1::Matrix3x2F::Scale(xScale, yScale,
-                D2D1::Point2F(xPointToScaleFrom, m_GameHeight - yPointToScaleFrom))
+            lastMatrix = Matrix3x2::Scale(xScale, yScale,
+                Point2f{ xPointToScaleFrom, m_GameHeight - yPointToScaleFrom })
                 * lastMatrix;
         }
         else OutputDebugString(_T("Vector of matrices was empty while trying to add a Scaling matrix."));
@@ -1272,7 +1293,7 @@ namespace jela
         if (!m_VecTransformMatrices.empty())
         {
             auto& lastMatrix = m_VecTransformMatrices.back();
-            lastMatrix = D2D1::Matrix3x2F::Translation(xTranslation, yTranslation) * lastMatrix;
+            lastMatrix = Matrix3x2::Translation(xTranslation, yTranslation) * lastMatrix;
         }
         else OutputDebugString(_T("Vector of matrices was empty while trying to add a Translation matrix."));
 
@@ -1283,7 +1304,7 @@ namespace jela
         if (!m_VecTransformMatrices.empty())
         {
             auto& lastMatrix = m_VecTransformMatrices.back();
-            lastMatrix = D2D1::Matrix3x2F::Rotation(-angle, D2D1::Point2F(xPivotPoint, yPivotPoint)) * lastMatrix;
+            lastMatrix = Matrix3x2::Rotation(-angle, Point2f{ xPivotPoint, yPivotPoint }) * lastMatrix;
         }
         else OutputDebugString(_T("Vector of matrices was empty while trying to add a Rotation matrix."));
 
@@ -1294,7 +1315,7 @@ namespace jela
         if (!m_VecTransformMatrices.empty())
         {
             auto& lastMatrix = m_VecTransformMatrices.back();
-            lastMatrix = D2D1::Matrix3x2F::Scale(xScale, yScale, D2D1::Point2F(xPointToScaleFrom, yPointToScaleFrom)) * lastMatrix;
+            lastMatrix = Matrix3x2::Scale(xScale, yScale, Point2f{ xPointToScaleFrom, yPointToScaleFrom }) * lastMatrix;
         }
         else OutputDebugString(_T("Vector of matrices was empty while trying to add a Scaling matrix."));
 
@@ -1304,7 +1325,7 @@ namespace jela
 
     void Engine::PushTransform()
     {
-        m_VecTransformMatrices.push_back(D2D1::Matrix3x2F::Identity());
+        m_VecTransformMatrices.push_back(Matrix3x2::Identity());
     }
 
     void Engine::PopTransform()
@@ -1475,6 +1496,11 @@ namespace jela
         return m_pResourceManager.get();
     }
 
+    EventBus* const Engine::GetEventBus() const
+    {
+        return m_pEventBus.get();
+    }
+
     const Font* const Engine::GetCurrentFont() const
     {
         return m_pResourceManager->GetCurrentFont();
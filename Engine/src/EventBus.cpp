@@ -0,0 +1,50 @@
+#include "EventBus.h"
+#include "ThreadPool.h"
+#include <cstring>
+
+namespace jela
+{
+    void EventBus::Dispatch()
+    {
+        // Payloads published from here on belong to the next Dispatch
+        const std::size_t dispatchedAllocator{ m_CurrentAllocator };
+        m_CurrentAllocator = 1 - m_CurrentAllocator;
+
+        // Every queue is taken before any handler runs, whatever they publish waits for the next Dispatch
+        for (const std::unique_ptr<QueueBase>& pQueue : m_Queues)
+        {
+            if (!pQueue || !pQueue->TakeEvents()) continue;
+
+            if (pQueue->isParallel && m_pThreadPool) m_ParallelQueues.emplace_back(pQueue.get());
+            else m_SerialQueues.emplace_back(pQueue.get());
+        }
+
+        if (!m_ParallelQueues.empty())
+        {
+            // The calling thread helps out, so the serial queues wait until the parallel ones are done
+            m_pThreadPool->ParallelFor(m_ParallelQueues.size(), 1, [this](std::size_t begin, std::size_t end)
+                {
+                    for (std::size_t index = begin; index < end; ++index) m_ParallelQueues[index]->DeliverEvents();
+                });
+            m_ParallelQueues.clear();
+        }
+
+        for (QueueBase* const pQueue : m_SerialQueues) pQueue->DeliverEvents();
+        m_SerialQueues.clear();
+
+        m_FrameAllocators[dispatchedAllocator].Reset();
+    }
+
+    std::string_view EventBus::CopyPayload(std::string_view text)
+    {
+        const std::span<char> copy{ AllocatePayload<char>(text.size()) };
+        std::memcpy(copy.data(), text.data(), text.size());
+        return { copy.data(), copy.size() };
+    }
+
+    std::size_t EventBus::GetNextTypeIndex()
+    {
+        static std::atomic<std::size_t> nextIndex{};
+        return nextIndex++;
+    }
+}
@@ -0,0 +1,273 @@
+#include "FileWatcher.h"
+#include <algorithm>
+#include <array>
+#include <unordered_map>
+#include <vector>
+
+#ifdef _WIN32
+#include "framework.h"
+#elif defined(__linux__)
+#include <poll.h>
+#include <sys/eventfd.h>
+#include <sys/inotify.h>
+#include <unistd.h>
+#endif
+
+namespace jela
+{
+    //---------------------------------------------------------------------------------------------------------------------------------
+    // Platform part: waits for changes and wakes up early when the watcher stops.
+    // A negative timeout waits until something happens.
+
+#ifdef _WIN32
+
+    class FileWatcher::Impl final
+    {
+    public:
+        explicit Impl(const std::filesystem::path& directory)
+        {
+            m_hDirectory = CreateFileW(directory.c_str(), FILE_LIST_DIRECTORY,
+                                       FILE_SHARE_READ | FILE_SHARE_WRITE | FILE_SHARE_DELETE, NULL, OPEN_EXISTING,
+                                       FILE_FLAG_BACKUP_SEMANTICS | FILE_FLAG_OVERLAPPED, NULL);
+            m_hChangeEvent = CreateEventW(NULL, TRUE, FALSE, NULL);
+            m_hWakeEvent = CreateEventW(NULL, FALSE, FALSE, NULL);
+
+            m_IsValid = m_hDirectory != INVALID_HANDLE_VALUE && m_hChangeEvent && m_hWakeEvent && IssueRead();
+        }
+        ~Impl()
+        {
+            if (m_hDirectory != INVALID_HANDLE_VALUE)
+            {
+                CancelIoEx(m_hDirectory, &m_Overlapped);
+                DWORD bytes{};
+                GetOverlappedResult(m_hDirectory, &m_Overlapped, &bytes, TRUE);
+                CloseHandle(m_hDirectory);
+            }
+            if (m_hChangeEvent) CloseHandle(m_hChangeEvent);
+            if (m_hWakeEvent) CloseHandle(m_hWakeEvent);
+        }
+
+        Impl(const Impl&) = delete;
+        Impl(Impl&&) noexcept = delete;
+        Impl& operator= (const Impl&) = delete;
+        Impl& operator= (Impl&&) noexcept = delete;
+
+        bool IsValid() const { return m_IsValid; }
+        void Wake() { SetEvent(m_hWakeEvent); }
+
+        void WaitForChanges(std::chrono::milliseconds timeout, std::vector<std::filesystem::path>& changedFiles)
+        {
+            const HANDLE handles[]{ m_hChangeEvent, m_hWakeEvent };
+            const DWORD waitTime{ timeout.count() < 0 ? INFINITE : static_cast<DWORD>(timeout.count()) };
+            if (WaitForMultipleObjects(2, handles, FALSE, waitTime) != WAIT_OBJECT_0) return;
+
+            DWORD bytes{};
+            if (GetOverlappedResult(m_hDirectory, &m_Overlapped, &bytes, FALSE) && bytes > 0)
+            {
+                const std::byte* pInfo{ m_Buffer.data() };
+                while (true)
+                {
+                    const auto& info = *reinterpret_cast<const FILE_NOTIFY_INFORMATION*>(pInfo);
+                    if (info.Action == FILE_ACTION_ADDED || info.Action == FILE_ACTION_MODIFIED || info.Action == FILE_ACTION_RENAMED_NEW_NAME)
+                        changedFiles.emplace_back(std::wstring{ info.FileName, info.FileNameLength / sizeof(WCHAR) });
+
+                    if (info.NextEntryOffset == 0) break;
+                    pInfo += info.NextEntryOffset;
+                }
+            }
+            // bytes is 0 when the buffer overflowed, those changes are lost
+
+            ResetEvent(m_hChangeEvent);
+            m_IsValid = IssueRead();
+        }
+
+    private:
+        bool IssueRead()
+        {
+            m_Overlapped = OVERLAPPED{};
+            m_Overlapped.hEvent = m_hChangeEvent;
+            return ReadDirectoryChangesW(m_hDirectory, m_Buffer.data(), static_cast<DWORD>(m_Buffer.size()), TRUE,
+                                         FILE_NOTIFY_CHANGE_FILE_NAME | FILE_NOTIFY_CHANGE_LAST_WRITE,
+                                         NULL, &m_Overlapped, NULL);
+        }
+
+        HANDLE m_hDirectory{ INVALID_HANDLE_VALUE };
+        HANDLE m_hChangeEvent{};
+        HANDLE m_hWakeEvent{};
+        OVERLAPPED m_Overlapped{};
+        // ReadDirectoryChangesW needs DWORD alignment
+        alignas(DWORD) std::array<std::byte, 1 << 16> m_Buffer{};
+        bool m_IsValid{};
+    };
+
+#elif defined(__linux__)
+
+    class FileWatcher::Impl final
+    {
+    public:
+        explicit Impl(const std::filesystem::path& directory) :
+            m_Directory{ directory },
+            m_InotifyDescriptor{ inotify_init1(IN_NONBLOCK | IN_CLOEXEC) },
+            m_WakeDescriptor{ eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC) }
+        {
+            m_IsValid = m_InotifyDescriptor >= 0 && m_WakeDescriptor >= 0 && WatchDirectory({});
+        }
+        ~Impl()
+        {
+            if (m_InotifyDescriptor >= 0) close(m_InotifyDescriptor);
+            if (m_WakeDescriptor >= 0) close(m_WakeDescriptor);
+        }
+
+        Impl(const Impl&) = delete;
+        Impl(Impl&&) noexcept = delete;
+        Impl& operator= (const Impl&) = delete;
+        Impl& operator= (Impl&&) noexcept = delete;
+
+        bool IsValid() const { return m_IsValid; }
+        void Wake()
+        {
+            const uint64_t value{ 1 };
+            [[maybe_unused]] const ssize_t written{ write(m_WakeDescriptor, &value, sizeof(value)) };
+        }
+
+        void WaitForChanges(std::chrono::milliseconds timeout, std::vector<std::filesystem::path>& changedFiles)
+        {
+            pollfd descriptors[]{ { m_InotifyDescriptor, POLLIN, 0 }, { m_WakeDescriptor, POLLIN, 0 } };
+            if (poll(descriptors, 2, static_cast<int>(std::max<std::chrono::milliseconds::rep>(timeout.count(), -1))) <= 0) return;
+
+            if (descriptors[1].revents & POLLIN)
+            {
+                uint64_t value{};
+                [[maybe_unused]] const ssize_t bytesRead{ read(m_WakeDescriptor, &value, sizeof(value)) };
+            }
+            if (!(descriptors[0].revents & POLLIN)) return;
+
+            alignas(inotify_event) char buffer[1 << 16];
+            for (ssize_t length = read(m_InotifyDescriptor, buffer, sizeof(buffer)); length > 0;
+                 length = read(m_InotifyDescriptor, buffer, sizeof(buffer)))
+            {
+                for (ssize_t offset = 0; offset < length;)
+                {
+                    const auto& event = *reinterpret_cast<const inotify_event*>(buffer + offset);
+                    offset += static_cast<ssize_t>(sizeof(inotify_event) + event.len);
+
+                    const auto directoryIt = m_WatchedDirectories.find(event.wd);
+                    if (directoryIt == m_WatchedDirectories.end()) continue;
+
+                    if (event.mask & IN_IGNORED)
+                    {
+                        m_WatchedDirectories.erase(directoryIt);
+                        continue;
+                    }
+                    if (event.len == 0) continue;
+
+                    const std::filesystem::path file{ directoryIt->second / event.name };
+                    // New directories get watched too; files copied in along with them count as changed
+                    if (event.mask & IN_ISDIR) WatchDirectory(file, &changedFiles);
+                    else changedFiles.emplace_back(file);
+                }
+            }
+        }
+
+    private:
+        bool WatchDirectory(const std::filesystem::path& relativeDirectory, std::vector<std::filesystem::path>* pExistingFiles = nullptr)
+        {
+            const std::filesystem::path directory{ m_Directory / relativeDirectory };
+            const int watchDescriptor{ inotify_add_watch(m_InotifyDescriptor, directory.c_str(),
+                                                         IN_CLOSE_WRITE | IN_MOVED_TO | IN_CREATE | IN_ONLYDIR) };
+            if (watchDescriptor < 0) return false;
+            m_WatchedDirectories[watchDescriptor] = relativeDirectory;
+
+            std::error_code error{};
+            for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator{ directory, error })
+            {
+                const std::filesystem::path relativePath{ relativeDirectory / entry.path().filename() };
+                if (entry.is_directory(error)) WatchDirectory(relativePath, pExistingFiles);
+                else if (pExistingFiles) pExistingFiles->emplace_back(relativePath);
+            }
+            return true;
+        }
+
+        std::filesystem::path m_Directory;
+        int m_InotifyDescriptor;
+        int m_WakeDescriptor;
+        std::unordered_map<int, std::filesystem::path> m_WatchedDirectories{};
+        bool m_IsValid{};
+    };
+
+#else
+
+    class FileWatcher::Impl final
+    {
+    public:
+        explicit Impl(const std::filesystem::path&) {}
+
+        bool IsValid() const { return false; }
+        void Wake() {}
+        void WaitForChanges(std::chrono::milliseconds, std::vector<std::filesystem::path>&) {}
+    };
+
+#endif
+    //---------------------------------------------------------------------------------------------------------------------------------
+
+
+    FileWatcher::FileWatcher(const std::filesystem::path& directory, Callback onChanged, std::chrono::milliseconds debounceTime) :
+        m_pImpl{ std::make_unique<Impl>(directory) },
+        m_OnChanged{ std::move(onChanged) },
+        m_DebounceTime{ debounceTime }
+    {
+        m_IsWatching = m_pImpl->IsValid();
+        if (m_IsWatching) m_Thread = std::jthread{ [this](std::stop_token stopToken) { Run(stopToken); } };
+    }
+
+    FileWatcher::~FileWatcher()
+    {
+        if (m_Thread.joinable())
+        {
+            m_Thread.request_stop();
+            m_pImpl->Wake();
+            m_Thread.join();
+        }
+    }
+
+    void FileWatcher::Run(std::stop_token stopToken)
+    {
+        using Clock = std::chrono::steady_clock;
+
+        std::unordered_map<std::filesystem::path, Clock::time_point> lastChanges{};
+        std::vector<std::filesystem::path> changedFiles{};
+        std::vector<std::filesystem::path> settledFiles{};
+
+        while (!stopToken.stop_requested())
+        {
+            // Sleeps until the oldest pending change settles, or indefinitely when nothing is pending
+            std::chrono::milliseconds timeout{ -1 };
+            if (!lastChanges.empty())
+            {
+                const auto oldestIt = std::ranges::min_element(lastChanges, {}, [](const auto& change) { return change.second; });
+                const auto remaining = oldestIt->second + m_DebounceTime - Clock::now();
+                timeout = std::max(std::chrono::ceil<std::chrono::milliseconds>(remaining), std::chrono::milliseconds{ 0 });
+            }
+
+            m_pImpl->WaitForChanges(timeout, changedFiles);
+            if (stopToken.stop_requested()) return;
+
+            const Clock::time_point now{ Clock::now() };
+            for (std::filesystem::path& file : changedFiles) lastChanges[std::move(file)] = now;
+            changedFiles.clear();
+
+            for (auto it = lastChanges.begin(); it != lastChanges.end();)
+            {
+                if (now - it->second >= m_DebounceTime)
+                {
+                    settledFiles.emplace_back(it->first);
+                    it = lastChanges.erase(it);
+                }
+                else ++it;
+            }
+
+            for (const std::filesystem::path& file : settledFiles) m_OnChanged(file);
+            settledFiles.clear();
+        }
+    }
+}
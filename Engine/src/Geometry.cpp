@@ -1,7 +1,7 @@
 #include "Geometry.h"
 #include "Engine.h"
+#include "PolygonUtils.h"
 #include <algorithm>
-#include <execution>
 #include <numbers>
 
 namespace jela
@@ -20,19 +20,26 @@ namespace jela
 	//--------------------------------------------------------------------------------------------------------------------
 	// Polygon
 	Polygon::Polygon(const std::vector<Point2f>& points, bool closeSegment) :
-		Geometry{},
-		m_Points{points}
+		Polygon{ Point2fArray{ points }, closeSegment }
+	{}
+	Polygon::Polygon(const Point2fArray& points, bool closeSegment) :
+		Geometry{}
 	{
-		AdjustPoints([&](Point2f& point) { point += GetTranslation(); });
 		Recreate(points, closeSegment);
 	}
 	bool Polygon::Recreate(const std::vector<Point2f>& points, bool closeSegment)
+	{
+		return Recreate(Point2fArray{ points }, closeSegment);
+	}
+	bool Polygon::Recreate(const Point2fArray& points, bool closeSegment)
 	{
 		HRESULT hr = Geometry::Recreate();
 
 		m_Points = points;
+		m_ConvexPieces.clear();
+		m_AreConvexPiecesValid = false;
 
-		if (!m_Points.empty())
+		if (!m_Points.Empty())
 		{
 			ID2D1GeometrySink* pSink{};
 
@@ -43,15 +50,17 @@ namespace jela
 			if (SUCCEEDED(hr))
 			{
 
-				std::vector<D2D1_POINT_2F> D2points(m_Points.size());
+				std::vector<D2D1_POINT_2F> D2points(m_Points.Size());
 
-				for (size_t i = 0; i < m_Points.size(); i++)
+				const float* const pX{ m_Points.X() };
+				const float* const pY{ m_Points.Y() };
+				for (size_t i = 0; i < m_Points.Size(); i++)
 				{
 #ifdef MATHEMATICAL_COORDINATESYSTEM
 
-					D2points[i] = D2D1::Point2F(m_Points[i].x, ENGINE.GetWindowRect().height - m_Points[i].y);
+					D2points[i] = D2D1::Point2F(pX[i], ENGINE.GetWindowRect().height - pY[i]);
 #else
-					D2points[i] = D2D1::Point2F(m_Points[i].x, m_Points[i].y);
+					D2points[i] = D2D1::Point2F(pX[i], pY[i]);
 
 #endif // MATHEMATICAL_COORDINATESYSTEM
 				}
@@ -72,68 +81,77 @@ namespace jela
 
 	void Polygon::ResetPosition()
 	{
-		AdjustPoints([&](Point2f& point) { point -= GetTranslation(); });
+		m_Points.Translate(-GetTranslation());
+		for (Point2fArray& piece : m_ConvexPieces) piece.Translate(-GetTranslation());
 		Geometry::ResetPosition();
 	}
 	void Polygon::Move(const Vector2f& translation)
 	{
 		Geometry::Move(translation);
-		AdjustPoints([&](Point2f& point) { point += translation; });
+		m_Points.Translate(translation);
+		for (Point2fArray& piece : m_ConvexPieces) piece.Translate(translation);
 	}
 
-	std::vector<Point2f> Polygon::GetOriginalPoints() const
+	Point2fArray Polygon::GetOriginalPoints() const
 	{
-		std::vector<Point2f>transformedPoints = m_Points;
-		std::for_each(std::execution::par, transformedPoints.begin(), transformedPoints.end(),
-			[&](Point2f& point) { point -= GetTranslation(); });
-		return transformedPoints;
+		Point2fArray originalPoints{ m_Points };
+		originalPoints.Translate(-GetTranslation());
+		return originalPoints;
+	}
+
+	const std::vector<Point2fArray>& Polygon::GetConvexPieces() const
+	{
+		if (!m_AreConvexPiecesValid)
+		{
+			m_ConvexPieces = utils::DecomposeConvex(m_Points);
+			m_AreConvexPiecesValid = true;
+		}
+		return m_ConvexPieces;
 	}
 
 	bool Polygon::IsPointInside(const Point2f& point) const
 	{
-		if (m_Points.size() < 2) return false;
+		if (m_Points.Size() < 3) return false;
 
 		// 1. First do a simple test with axis aligned bounding box around the polygon
-		float xMin{ m_Points[0].x };
-		float xMax{ m_Points[0].x };
-		float yMin{ m_Points[0].y };
-		float yMax{ m_Points[0].y };
-		for (size_t idx{ 1 }; idx < m_Points.size(); ++idx)
-		{
-			if (xMin > m_Points[idx].x) xMin = m_Points[idx].x;
-
-			if (xMax < m_Points[idx].x) xMax = m_Points[idx].x;
+		const auto [min, max] = m_Points.GetMinMax();
 
-			if (yMin > m_Points[idx].y) yMin = m_Points[idx].y;
+		if (point.x < min.x || point.x > max.x || point.y < min.y || point.y > max.y) return false;
 
-			if (yMax < m_Points[idx].y) yMax = m_Points[idx].y;
-		}
+		// 2. The point is inside when it is inside any of the convex pieces
+		const std::vector<Point2fArray>& pieces{ GetConvexPieces() };
+		return std::any_of(pieces.begin(), pieces.end(), [&point](const Point2fArray& piece)
+			{
+				return utils::IsPointInConvexPolygon(piece, point);
+			});
+	}
 
-		if (point.x < xMin || point.x > xMax || point.y < yMin || point.y > yMax) return false;
+	bool Polygon::IsOverlapping(const Polygon& other) const
+	{
+		if (m_Points.Size() < 3 || other.m_Points.Size() < 3) return false;
 
-        // 2. Draw a virtual ray from anywhere outside the polygon to the point
-        //    and count how often it hits any side of the polygon.
-		//    If the number of hits is even, it's outside of the polygon, if it's odd, it's inside.
-		int numberOfIntersectionPoints{ 0 };
-		Point2f p2{ xMax + 10, yMax + 20 }; // random point outside the box
+		const auto [min1, max1] = m_Points.GetMinMax();
+		const auto [min2, max2] = other.m_Points.GetMinMax();
+		if (min1.x > max2.x || min2.x > max1.x || min1.y > max2.y || min2.y > max1.y) return false;
 
-		// Count the number of intersection points
-		float lambda1{}, lambda2{};
-		for (size_t i{ 0 }; i < m_Points.size(); ++i)
+		for (const Point2fArray& piece1 : GetConvexPieces())
 		{
-			if (utils::IntersectLineSegments(m_Points[i], m_Points[(i + 1) % m_Points.size()], point, p2, lambda1, lambda2))
+			for (const Point2fArray& piece2 : other.GetConvexPieces())
 			{
-				++numberOfIntersectionPoints;
+				if (utils::IsOverlappingConvex(piece1, piece2)) return true;
 			}
 		}
-		return numberOfIntersectionPoints % 2 != 0;
-
+		return false;
 	}
 
-	void Polygon::AdjustPoints(const std::function<void(Point2f&)>& func)
+	bool Polygon::Simplify(float tolerance, bool closeSegment)
 	{
-		std::for_each(std::execution::par, m_Points.begin(), m_Points.end(), func);
+		const Vector2f translation{ GetTranslation() };
+		const bool result{ Recreate(utils::SimplifyRamerDouglasPeucker(GetOriginalPoints(), tolerance, closeSegment), closeSegment) };
+		m_Points.Translate(translation);
+		return result;
 	}
+
 	//--------------------------------------------------------------------------------------------------------------------
 
 
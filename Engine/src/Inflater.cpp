@@ -0,0 +1,357 @@
+#include "Inflater.h"
+#include "FileExceptions.h"
+#include <algorithm>
+#include <bit>
+#include <cstring>
+
+namespace jela
+{
+    static_assert(std::endian::native == std::endian::little, "The bit reader loads 8 input bytes at once.");
+
+    namespace
+    {
+        constexpr std::size_t windowSize{ 32768 };
+        constexpr std::size_t chunkSize{ 65536 };
+        constexpr std::size_t maxMatchLength{ 258 };
+
+        constexpr std::array<uint16_t, 29> lengthBases{ 3, 4, 5, 6, 7, 8, 9, 10, 11, 13, 15, 17, 19, 23, 27, 31,
+                                                        35, 43, 51, 59, 67, 83, 99, 115, 131, 163, 195, 227, 258 };
+        constexpr std::array<uint8_t, 29> lengthExtraBits{ 0, 0, 0, 0, 0, 0, 0, 0, 1, 1, 1, 1, 2, 2, 2, 2,
+                                                           3, 3, 3, 3, 4, 4, 4, 4, 5, 5, 5, 5, 0 };
+        constexpr std::array<uint16_t, 30> distanceBases{ 1, 2, 3, 4, 5, 7, 9, 13, 17, 25, 33, 49, 65, 97, 129, 193,
+                                                          257, 385, 513, 769, 1025, 1537, 2049, 3073, 4097, 6145, 8193, 12289, 16385, 24577 };
+        constexpr std::array<uint8_t, 30> distanceExtraBits{ 0, 0, 0, 0, 1, 1, 2, 2, 3, 3, 4, 4, 5, 5, 6, 6,
+                                                             7, 7, 8, 8, 9, 9, 10, 10, 11, 11, 12, 12, 13, 13 };
+        // Order in which the code length code lengths are stored
+        constexpr std::array<uint8_t, 19> codeLengthOrder{ 16, 17, 18, 0, 8, 7, 9, 6, 10, 5, 11, 4, 12, 3, 13, 2, 14, 1, 15 };
+
+        uint32_t ReverseBits(uint32_t code, uint32_t length)
+        {
+            uint32_t reversed{};
+            for (uint32_t bit = 0; bit < length; ++bit)
+            {
+                reversed = (reversed << 1) | (code & 1);
+                code >>= 1;
+            }
+            return reversed;
+        }
+
+        [[noreturn]] void ThrowCorrupt(const char* pReason)
+        {
+            throw FileLoadException{ std::format("Deflate data is corrupt: {}.\n", pReason) };
+        }
+    }
+
+    Inflater::Inflater(std::span<const uint8_t> input) :
+        m_Input{ input }
+    {}
+
+    std::size_t Inflater::Read(std::span<uint8_t> output)
+    {
+        std::size_t written{};
+        while (written < output.size())
+        {
+            if (m_ReadPosition == m_WritePosition)
+            {
+                if (m_State == State::Done) break;
+                Fill();
+                continue;
+            }
+
+            const std::size_t count{ std::min(output.size() - written, m_WritePosition - m_ReadPosition) };
+            std::memcpy(output.data() + written, m_Buffer.data() + m_ReadPosition, count);
+            m_ReadPosition += count;
+            written += count;
+        }
+        return written;
+    }
+
+    void Inflater::Fill()
+    {
+        if (m_Buffer.empty()) m_Buffer.resize(windowSize + chunkSize + maxMatchLength);
+
+        // Everything was read, only the history matches can reach back to has to stay
+        if (m_WritePosition > windowSize)
+        {
+            std::memmove(m_Buffer.data(), m_Buffer.data() + m_WritePosition - windowSize, windowSize);
+            m_WritePosition = windowSize;
+            m_ReadPosition = windowSize;
+        }
+
+        // Leaves room for one more match
+        const std::size_t end{ m_Buffer.size() - maxMatchLength };
+        while (m_WritePosition < end && m_State != State::Done)
+        {
+            switch (m_State)
+            {
+            case State::BlockHeader:
+                ReadBlockHeader();
+                break;
+            case State::Stored:
+                InflateStored(end);
+                break;
+            case State::Huffman:
+                InflateHuffman(end);
+                break;
+            case State::Done:
+                break;
+            }
+        }
+
+        if (IsPastEnd()) ThrowCorrupt("the stream is truncated");
+    }
+
+    void Inflater::ReadBlockHeader()
+    {
+        m_IsLastBlock = GetBits(1) != 0;
+        switch (GetBits(2))
+        {
+        case 0:
+        {
+            // Continues at the next byte boundary, the bytes still in the bit buffer go back to the input
+            DropBits(m_BitCount % 8);
+            const uint32_t length{ GetBits(16) };
+            const uint32_t lengthComplement{ GetBits(16) };
+            if ((length ^ 0xFFFF) != lengthComplement) ThrowCorrupt("a stored block has an invalid length");
+
+            m_InputPosition -= m_BitCount / 8;
+            m_Bits = 0;
+            m_BitCount = 0;
+
+            m_StoredRemaining = length;
+            m_State = State::Stored;
+            break;
+        }
+        case 1:
+        {
+            std::array<uint8_t, 288 + 32> lengths{};
+            std::fill(lengths.begin(), lengths.begin() + 144, uint8_t{ 8 });
+            std::fill(lengths.begin() + 144, lengths.begin() + 256, uint8_t{ 9 });
+            std::fill(lengths.begin() + 256, lengths.begin() + 280, uint8_t{ 7 });
+            std::fill(lengths.begin() + 280, lengths.begin() + 288, uint8_t{ 8 });
+            std::fill(lengths.begin() + 288, lengths.end(), uint8_t{ 5 });
+
+            BuildTable(m_LiteralTable, std::span{ lengths }.first(288));
+            BuildTable(m_DistanceTable, std::span{ lengths }.subspan(288, 30));
+            m_State = State::Huffman;
+            break;
+        }
+        case 2:
+            ReadDynamicTables();
+            m_State = State::Huffman;
+            break;
+        default:
+            ThrowCorrupt("a block has an invalid type");
+        }
+    }
+
+    void Inflater::ReadDynamicTables()
+    {
+        const uint32_t literalCount{ GetBits(5) + 257 };
+        const uint32_t distanceCount{ GetBits(5) + 1 };
+        const uint32_t codeLengthCount{ GetBits(4) + 4 };
+        if (literalCount > 286 || distanceCount > 30) ThrowCorrupt("a block has too many codes");
+
+        std::array<uint8_t, 19> codeLengthLengths{};
+        for (uint32_t index = 0; index < codeLengthCount; ++index) codeLengthLengths[codeLengthOrder[index]] = static_cast<uint8_t>(GetBits(3));
+
+        HuffmanTable codeLengthTable{};
+        BuildTable(codeLengthTable, codeLengthLengths);
+
+        // Literal and distance lengths form one sequence, repeats can run from one into the other
+        std::array<uint8_t, 286 + 30> lengths{};
+        for (uint32_t index = 0; index < literalCount + distanceCount;)
+        {
+            Refill();
+            const uint32_t symbol{ DecodeSymbol(codeLengthTable) };
+            if (symbol < 16)
+            {
+                lengths[index++] = static_cast<uint8_t>(symbol);
+                continue;
+            }
+
+            uint8_t length{};
+            uint32_t repeat{};
+            if (symbol == 16)
+            {
+                if (index == 0) ThrowCorrupt("a length repeat has nothing to repeat");
+                length = lengths[index - 1];
+                repeat = 3 + GetBits(2);
+            }
+            else if (symbol == 17) repeat = 3 + GetBits(3);
+            else repeat = 11 + GetBits(7);
+
+            if (index + repeat > literalCount + distanceCount) ThrowCorrupt("a length repeat runs past the end");
+            std::fill_n(lengths.begin() + index, repeat, length);
+            index += repeat;
+        }
+
+        if (lengths[256] == 0) ThrowCorrupt("a block has no end code");
+        BuildTable(m_LiteralTable, std::span{ lengths }.first(literalCount));
+        BuildTable(m_DistanceTable, std::span{ lengths }.subspan(literalCount, distanceCount));
+    }
+
+    void Inflater::InflateStored(std::size_t end)
+    {
+        const std::size_t count{ std::min(m_StoredRemaining, end - m_WritePosition) };
+        if (count > m_Input.size() - std::min(m_InputPosition, m_Input.size())) ThrowCorrupt("a stored block is truncated");
+
+        std::memcpy(m_Buffer.data() + m_WritePosition, m_Input.data() + m_InputPosition, count);
+        m_InputPosition += count;
+        m_WritePosition += count;
+        m_StoredRemaining -= count;
+
+        if (m_StoredRemaining == 0) m_State = m_IsLastBlock ? State::Done : State::BlockHeader;
+    }
+
+    void Inflater::InflateHuffman(std::size_t end)
+    {
+        uint8_t* const pBuffer{ m_Buffer.data() };
+
+        while (m_WritePosition < end)
+        {
+            Refill();
+
+            uint32_t symbol{ DecodeSymbol(m_LiteralTable) };
+            // Runs of literals are decoded from the same refill for as long as another whole code fits
+            while (symbol < 256)
+            {
+                pBuffer[m_WritePosition++] = static_cast<uint8_t>(symbol);
+                if (m_BitCount < 15 || m_WritePosition >= end) break;
+                symbol = DecodeSymbol(m_LiteralTable);
+            }
+            if (symbol < 256) continue;
+            if (symbol == 256)
+            {
+                m_State = m_IsLastBlock ? State::Done : State::BlockHeader;
+                return;
+            }
+
+            const uint32_t lengthIndex{ symbol - 257 };
+            if (lengthIndex >= lengthBases.size()) ThrowCorrupt("a length code is invalid");
+            const uint32_t length{ lengthBases[lengthIndex] + GetBits(lengthExtraBits[lengthIndex]) };
+
+            // A distance code and its extra bits take at most 28 bits
+            if (m_BitCount < 28) Refill();
+            const uint32_t distanceIndex{ DecodeSymbol(m_DistanceTable) };
+            if (distanceIndex >= distanceBases.size()) ThrowCorrupt("a distance code is invalid");
+            const uint32_t distance{ distanceBases[distanceIndex] + GetBits(distanceExtraBits[distanceIndex]) };
+            if (distance > m_WritePosition) ThrowCorrupt("a distance reaches back before the start");
+
+            // Overlapping matches repeat their pattern, copying at most distance bytes at a time keeps that intact
+            uint8_t* const pOutput{ pBuffer + m_WritePosition };
+            const uint8_t* const pMatch{ pOutput - distance };
+            if (distance >= length)
+            {
+                std::memcpy(pOutput, pMatch, length);
+            }
+            else
+            {
+                for (uint32_t copied = 0; copied < length;)
+                {
+                    const uint32_t chunk{ std::min(distance, length - copied) };
+                    std::memcpy(pOutput + copied, pMatch + copied, chunk);
+                    copied += chunk;
+                }
+            }
+            m_WritePosition += length;
+        }
+    }
+
+    void Inflater::BuildTable(HuffmanTable& table, std::span<const uint8_t> lengths)
+    {
+        table.counts.fill(0);
+        for (const uint8_t length : lengths) ++table.counts[length];
+        table.counts[0] = 0;
+
+        int left{ 1 };
+        for (uint32_t length = 1; length < 16; ++length)
+        {
+            left = (left << 1) - table.counts[length];
+            if (left < 0) ThrowCorrupt("a Huffman code is over-subscribed");
+        }
+
+        // Symbols sorted by code length, then by value: the order canonical codes are assigned in
+        std::array<uint16_t, 16> offsets{};
+        for (uint32_t length = 1; length < 15; ++length) offsets[length + 1] = offsets[length] + table.counts[length];
+        for (uint32_t symbol = 0; symbol < lengths.size(); ++symbol)
+        {
+            if (lengths[symbol] != 0) table.symbols[offsets[lengths[symbol]]++] = static_cast<uint16_t>(symbol);
+        }
+
+        std::array<uint32_t, 16> nextCodes{};
+        uint32_t code{};
+        for (uint32_t length = 1; length < 16; ++length)
+        {
+            code = (code + table.counts[length - 1]) << 1;
+            nextCodes[length] = code;
+        }
+
+        // Codes are stored starting at their first bit, which the bit reader returns as the lowest one
+        table.fast.fill(0);
+        for (uint32_t symbol = 0; symbol < lengths.size(); ++symbol)
+        {
+            const uint32_t length{ lengths[symbol] };
+            if (length == 0) continue;
+
+            const uint32_t reversedCode{ ReverseBits(nextCodes[length]++, length) };
+            if (length > fastBits) continue;
+
+            for (uint32_t index = reversedCode; index < table.fast.size(); index += 1u << length)
+                table.fast[index] = static_cast<uint16_t>((symbol << 4) | length);
+        }
+    }
+
+    void Inflater::Refill()
+    {
+        if (m_InputPosition + 8 <= m_Input.size())
+        {
+            uint64_t bytes{};
+            std::memcpy(&bytes, m_Input.data() + m_InputPosition, sizeof(bytes));
+            m_Bits |= bytes << m_BitCount;
+            m_InputPosition += (63 - m_BitCount) / 8;
+            m_BitCount |= 56;
+            return;
+        }
+
+        while (m_BitCount <= 56)
+        {
+            if (m_InputPosition < m_Input.size()) m_Bits |= uint64_t{ m_Input[m_InputPosition] } << m_BitCount;
+            ++m_InputPosition;
+            m_BitCount += 8;
+        }
+    }
+
+    uint32_t Inflater::GetBits(uint32_t count)
+    {
+        if (m_BitCount < count) Refill();
+        const uint32_t bits{ PeekBits(count) };
+        DropBits(count);
+        return bits;
+    }
+
+    uint32_t Inflater::DecodeSymbol(const HuffmanTable& table)
+    {
+        if (const uint16_t entry{ table.fast[PeekBits(fastBits)] }; entry != 0)
+        {
+            DropBits(entry & 0x0F);
+            return entry >> 4;
+        }
+
+        // Canonical codes of one length are consecutive, and longer codes start after the shorter ones end
+        int code{};
+        int first{};
+        int index{};
+        for (uint32_t length = 1; length < 16; ++length)
+        {
+            code |= static_cast<int>(GetBits(1));
+            const int count{ table.counts[length] };
+            if (code - first < count) return table.symbols[index + code - first];
+
+            index += count;
+            first = (first + count) << 1;
+            code <<= 1;
+        }
+        ThrowCorrupt("a Huffman code is invalid");
+    }
+}
@@ -0,0 +1,56 @@
+#include "LinearAllocator.h"
+#include <algorithm>
+#include <cassert>
+#include <cstdint>
+#include <numeric>
+
+namespace jela
+{
+    LinearAllocator::LinearAllocator(std::size_t blockSize) :
+        m_BlockSize{ blockSize }
+    {
+        assert(m_BlockSize > 0 && "LinearAllocator needs a block size");
+    }
+
+    void* LinearAllocator::Allocate(std::size_t size, std::size_t alignment)
+    {
+        assert(alignment > 0 && (alignment & (alignment - 1)) == 0 && "Alignment must be a power of 2");
+
+        while (m_CurrentBlock < m_Blocks.size())
+        {
+            const Block& block{ m_Blocks[m_CurrentBlock] };
+            const auto address = reinterpret_cast<std::uintptr_t>(block.pData.get()) + m_Offset;
+            const std::size_t padding{ (alignment - address % alignment) % alignment };
+
+            if (m_Offset + padding + size <= block.size)
+            {
+                m_Offset += padding + size;
+                m_UsedBytes += size;
+                return block.pData.get() + m_Offset - size;
+            }
+
+            ++m_CurrentBlock;
+            m_Offset = 0;
+        }
+
+        // new[] only guarantees fundamental alignment, the extra room covers anything stricter
+        const std::size_t blockSize{ std::max(m_BlockSize, size + alignment) };
+        m_Blocks.emplace_back(Block{ std::make_unique<std::byte[]>(blockSize), blockSize });
+        m_CurrentBlock = m_Blocks.size() - 1;
+        m_Offset = 0;
+        return Allocate(size, alignment);
+    }
+
+    void LinearAllocator::Reset()
+    {
+        m_CurrentBlock = 0;
+        m_Offset = 0;
+        m_UsedBytes = 0;
+    }
+
+    std::size_t LinearAllocator::GetCapacity() const
+    {
+        return std::accumulate(m_Blocks.begin(), m_Blocks.end(), std::size_t{},
+                               [](std::size_t total, const Block& block) { return total + block.size; });
+    }
+}
@@ -0,0 +1,91 @@
+#include "MappedFile.h"
+#include "FileExceptions.h"
+
+#ifdef _WIN32
+#include "framework.h"
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif // _WIN32
+
+namespace jela
+{
+#ifdef _WIN32
+
+    MappedFile::MappedFile(const std::filesystem::path& filePath) :
+        m_FilePath{ filePath }
+    {
+        HANDLE hFile = CreateFileW(filePath.c_str(), GENERIC_READ, FILE_SHARE_READ, NULL, OPEN_EXISTING,
+                                   FILE_ATTRIBUTE_NORMAL | FILE_FLAG_RANDOM_ACCESS, NULL);
+        if (hFile == INVALID_HANDLE_VALUE)
+            throw FileNotFoundException{ std::format("File \"{}\" could not be opened for mapping.\n", filePath.string()) };
+        m_hFile = hFile;
+
+        LARGE_INTEGER fileSize{};
+        if (!GetFileSizeEx(hFile, &fileSize))
+        {
+            CloseHandle(hFile);
+            throw FileLoadException{ std::format("Size of file \"{}\" could not be read.\n", filePath.string()) };
+        }
+        m_Size = static_cast<std::size_t>(fileSize.QuadPart);
+
+        // Empty files can't be mapped, they simply have no data
+        if (m_Size == 0) return;
+
+        m_hMapping = CreateFileMappingW(hFile, NULL, PAGE_READONLY, 0, 0, NULL);
+        if (m_hMapping) m_pData = static_cast<const std::byte*>(MapViewOfFile(m_hMapping, FILE_MAP_READ, 0, 0, 0));
+
+        if (!m_pData)
+        {
+            if (m_hMapping) CloseHandle(m_hMapping);
+            CloseHandle(hFile);
+            throw FileLoadException{ std::format("File \"{}\" could not be mapped. Error code: {}\n", filePath.string(), GetLastError()) };
+        }
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_pData) UnmapViewOfFile(m_pData);
+        if (m_hMapping) CloseHandle(m_hMapping);
+        if (m_hFile) CloseHandle(m_hFile);
+    }
+
+#else
+
+    MappedFile::MappedFile(const std::filesystem::path& filePath) :
+        m_FilePath{ filePath }
+    {
+        const int fileDescriptor{ open(filePath.c_str(), O_RDONLY | O_CLOEXEC) };
+        if (fileDescriptor < 0)
+            throw FileNotFoundException{ std::format("File \"{}\" could not be opened for mapping.\n", filePath.string()) };
+
+        struct stat fileStatus{};
+        if (fstat(fileDescriptor, &fileStatus) != 0)
+        {
+            close(fileDescriptor);
+            throw FileLoadException{ std::format("Size of file \"{}\" could not be read.\n", filePath.string()) };
+        }
+        m_Size = static_cast<std::size_t>(fileStatus.st_size);
+
+        if (m_Size > 0)
+        {
+            void* pMapping{ mmap(nullptr, m_Size, PROT_READ, MAP_PRIVATE, fileDescriptor, 0) };
+            if (pMapping != MAP_FAILED) m_pData = static_cast<const std::byte*>(pMapping);
+        }
+
+        // The mapping keeps its own reference to the file
+        close(fileDescriptor);
+
+        if (m_Size > 0 && !m_pData)
+            throw FileLoadException{ std::format("File \"{}\" could not be mapped.\n", filePath.string()) };
+    }
+
+    MappedFile::~MappedFile()
+    {
+        if (m_pData) munmap(const_cast<std::byte*>(m_pData), m_Size);
+    }
+
+#endif // _WIN32
+}
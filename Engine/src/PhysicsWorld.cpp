@@ -0,0 +1,1221 @@
+#include "PhysicsWorld.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <cmath>
+#include <numbers>
+#include <numeric>
+
+namespace jela
+{
+    namespace
+    {
+        // Tuned for pixels, roughly 100 pixels per meter
+        constexpr float linearSlop{ 0.5f };
+        constexpr float baumgarte{ 0.2f };
+        constexpr float restitutionThreshold{ 100.f };
+        constexpr float linearSleepTolerance{ 1.f };
+        constexpr float angularSleepTolerance{ 2.f * std::numbers::pi_v<float> / 180.f };
+        constexpr float timeToSleep{ 0.5f };
+        constexpr uint32_t relaxIterations{ 2 };
+        constexpr uint32_t maxSubSteps{ 8 };
+        constexpr uint32_t noSolverBody{ std::numeric_limits<uint32_t>::max() };
+        constexpr float infinity{ std::numeric_limits<float>::infinity() };
+
+        constexpr float ToRadians(float degrees) { return degrees * std::numbers::pi_v<float> / 180.f; }
+        constexpr float ToDegrees(float radians) { return radians * 180.f / std::numbers::pi_v<float>; }
+
+        constexpr uint64_t MakePairKey(BodyID first, BodyID second)
+        {
+            return (uint64_t{ std::min(first, second) } << 32) | std::max(first, second);
+        }
+
+        // Cross product of an angular velocity with a vector
+        constexpr Vector2f Cross(float scalar, const Vector2f& vector)
+        {
+            return Vector2f{ -scalar * vector.y, scalar * vector.x };
+        }
+
+        // Andrew's monotone chain, returns the hull counterclockwise without collinear points.
+        std::vector<Point2f> ConvexHull(std::vector<Point2f> points)
+        {
+            std::sort(points.begin(), points.end(), [](const Point2f& first, const Point2f& second)
+                {
+                    return first.x < second.x || (first.x == second.x && first.y < second.y);
+                });
+            if (points.size() < 3) return points;
+
+            auto turn = [](const Point2f& origin, const Point2f& first, const Point2f& second)
+                {
+                    return Vector2f::Cross(first - origin, second - origin);
+                };
+
+            std::vector<Point2f> hull(2 * points.size());
+            std::size_t size{};
+            for (const Point2f& point : points)
+            {
+                while (size >= 2 && turn(hull[size - 2], hull[size - 1], point) <= 0.f) --size;
+                hull[size++] = point;
+            }
+            const std::size_t lowerSize{ size + 1 };
+            for (std::size_t i = points.size() - 1; i-- > 0;)
+            {
+                while (size >= lowerSize && turn(hull[size - 2], hull[size - 1], points[i]) <= 0.f) --size;
+                hull[size++] = points[i];
+            }
+            hull.resize(size - 1);
+            return hull;
+        }
+
+        //---------------------------------------------------------------
+        // Narrowphase
+        struct ManifoldPoint
+        {
+            Vector2f position;
+            float separation;
+            uint32_t featureID;
+        };
+
+        struct Manifold
+        {
+            // Points from the first shape to the second one
+            Vector2f normal;
+            uint32_t pointCount;
+            std::array<ManifoldPoint, 2> points;
+        };
+
+        struct WorldPolygon
+        {
+            uint32_t count;
+            std::array<Vector2f, PhysicsWorld::maxPolygonVertices> vertices;
+            std::array<Vector2f, PhysicsWorld::maxPolygonVertices> normals;
+        };
+
+        struct ClipVertex
+        {
+            Vector2f position;
+            uint32_t featureID;
+        };
+
+        void CollideCircles(const Vector2f& centerA, float radiusA, const Vector2f& centerB, float radiusB, Manifold& manifold)
+        {
+            const Vector2f offset{ centerB - centerA };
+            const float radius{ radiusA + radiusB };
+            const float distanceSquared{ offset.SquaredLength() };
+            if (distanceSquared > (radius + linearSlop) * (radius + linearSlop)) return;
+
+            const float distance{ std::sqrt(distanceSquared) };
+            const Vector2f normal{ distance > FLT_EPSILON ? offset / distance : Vector2f{ 0.f, 1.f } };
+            const Vector2f surfaceA{ centerA + normal * radiusA };
+            const Vector2f surfaceB{ centerB - normal * radiusB };
+
+            manifold.normal = normal;
+            manifold.pointCount = 1;
+            manifold.points[0] = ManifoldPoint{ (surfaceA + surfaceB) * 0.5f, distance - radius, 0 };
+        }
+
+        // The normal points from the polygon to the circle.
+        void CollidePolygonAndCircle(const WorldPolygon& polygon, const Vector2f& center, float radius, Manifold& manifold)
+        {
+            uint32_t edge{};
+            float maxSeparation{ -infinity };
+            for (uint32_t i = 0; i < polygon.count; ++i)
+            {
+                const float separation{ Vector2f::Dot(polygon.normals[i], center - polygon.vertices[i]) };
+                if (separation > radius + linearSlop) return;
+                if (separation > maxSeparation)
+                {
+                    maxSeparation = separation;
+                    edge = i;
+                }
+            }
+
+            const Vector2f& vertex1{ polygon.vertices[edge] };
+            const Vector2f& vertex2{ polygon.vertices[(edge + 1) % polygon.count] };
+
+            Vector2f normal{};
+            float separation{};
+            if (maxSeparation < FLT_EPSILON)
+            {
+                // Center inside the polygon
+                normal = polygon.normals[edge];
+                separation = maxSeparation - radius;
+            }
+            else if (Vector2f::Dot(center - vertex1, vertex2 - vertex1) <= 0.f)
+            {
+                const Vector2f offset{ center - vertex1 };
+                if (offset.SquaredLength() > (radius + linearSlop) * (radius + linearSlop)) return;
+                const float distance{ offset.Length() };
+                normal = offset / distance;
+                separation = distance - radius;
+            }
+            else if (Vector2f::Dot(center - vertex2, vertex1 - vertex2) <= 0.f)
+            {
+                const Vector2f offset{ center - vertex2 };
+                if (offset.SquaredLength() > (radius + linearSlop) * (radius + linearSlop)) return;
+                const float distance{ offset.Length() };
+                normal = offset / distance;
+                separation = distance - radius;
+            }
+            else
+            {
+                normal = polygon.normals[edge];
+                separation = maxSeparation - radius;
+            }
+
+            const Vector2f surfaceB{ center - normal * radius };
+            manifold.normal = normal;
+            manifold.pointCount = 1;
+            manifold.points[0] = ManifoldPoint{ surfaceB - normal * (separation * 0.5f), separation, edge };
+        }
+
+        // Largest separation along the edge normals of the first polygon
+        float FindMaxSeparation(uint32_t& edge, const WorldPolygon& polygon1, const WorldPolygon& polygon2)
+        {
+            float maxSeparation{ -infinity };
+            for (uint32_t i = 0; i < polygon1.count; ++i)
+            {
+                float separation{ infinity };
+                for (uint32_t j = 0; j < polygon2.count; ++j)
+                {
+                    separation = std::min(separation, Vector2f::Dot(polygon1.normals[i], polygon2.vertices[j] - polygon1.vertices[i]));
+                }
+                if (separation > maxSeparation)
+                {
+                    maxSeparation = separation;
+                    edge = i;
+                }
+            }
+            return maxSeparation;
+        }
+
+        uint32_t ClipSegmentToLine(std::array<ClipVertex, 2>& out, const std::array<ClipVertex, 2>& in, const Vector2f& normal, float offset, uint32_t clipFeature)
+        {
+            uint32_t count{};
+            const float distance0{ Vector2f::Dot(normal, in[0].position) - offset };
+            const float distance1{ Vector2f::Dot(normal, in[1].position) - offset };
+
+            if (distance0 <= 0.f) out[count++] = in[0];
+            if (distance1 <= 0.f) out[count++] = in[1];
+
+            if (distance0 * distance1 < 0.f)
+            {
+                const float interpolation{ distance0 / (distance0 - distance1) };
+                out[count++] = ClipVertex{ in[0].position + (in[1].position - in[0].position) * interpolation, clipFeature };
+            }
+            return count;
+        }
+
+        // SAT to find the reference face, then the incident edge gets clipped against its side planes.
+        void CollidePolygons(const WorldPolygon& polygonA, const WorldPolygon& polygonB, Manifold& manifold)
+        {
+            uint32_t edgeA{};
+            const float separationA{ FindMaxSeparation(edgeA, polygonA, polygonB) };
+            if (separationA > linearSlop) return;
+
+            uint32_t edgeB{};
+            const float separationB{ FindMaxSeparation(edgeB, polygonB, polygonA) };
+            if (separationB > linearSlop) return;
+
+            // Prefer A as reference so the choice doesn't flip-flop between nearly equal faces
+            const bool flip{ separationB > separationA + 0.1f * linearSlop };
+            const WorldPolygon& reference{ flip ? polygonB : polygonA };
+            const WorldPolygon& incident{ flip ? polygonA : polygonB };
+            const uint32_t referenceEdge{ flip ? edgeB : edgeA };
+
+            const Vector2f& referenceNormal{ reference.normals[referenceEdge] };
+            uint32_t incidentEdge{};
+            float minDot{ infinity };
+            for (uint32_t i = 0; i < incident.count; ++i)
+            {
+                const float dot{ Vector2f::Dot(referenceNormal, incident.normals[i]) };
+                if (dot < minDot)
+                {
+                    minDot = dot;
+                    incidentEdge = i;
+                }
+            }
+            const uint32_t incidentNext{ (incidentEdge + 1) % incident.count };
+            const std::array<ClipVertex, 2> incidentVertices{
+                ClipVertex{ incident.vertices[incidentEdge], 0x100 | incidentEdge },
+                ClipVertex{ incident.vertices[incidentNext], 0x100 | incidentNext } };
+
+            const uint32_t referenceNext{ (referenceEdge + 1) % reference.count };
+            const Vector2f& vertex1{ reference.vertices[referenceEdge] };
+            const Vector2f& vertex2{ reference.vertices[referenceNext] };
+            const Vector2f tangent{ (vertex2 - vertex1).Normalized() };
+
+            std::array<ClipVertex, 2> clipped1{};
+            if (ClipSegmentToLine(clipped1, incidentVertices, -tangent, -Vector2f::Dot(tangent, vertex1) + linearSlop, 0x200 | referenceEdge) < 2) return;
+
+            std::array<ClipVertex, 2> clipped2{};
+            if (ClipSegmentToLine(clipped2, clipped1, tangent, Vector2f::Dot(tangent, vertex2) + linearSlop, 0x200 | referenceNext) < 2) return;
+
+            const float frontOffset{ Vector2f::Dot(referenceNormal, vertex1) };
+            const uint32_t featureBase{ (flip ? 0x80000000u : 0u) | (referenceEdge << 16) };
+
+            manifold.normal = flip ? -referenceNormal : referenceNormal;
+            manifold.pointCount = 0;
+            for (const ClipVertex& vertex : clipped2)
+            {
+                const float separation{ Vector2f::Dot(referenceNormal, vertex.position) - frontOffset };
+                if (separation > linearSlop) continue;
+
+                manifold.points[manifold.pointCount++] = ManifoldPoint{
+                    vertex.position - referenceNormal * (separation * 0.5f),
+                    separation,
+                    featureBase | vertex.featureID };
+            }
+        }
+        //---------------------------------------------------------------
+    }
+
+    //---------------------------------------------------------------
+    // Bodies
+    PhysicsWorld::PhysicsWorld() :
+#ifdef MATHEMATICAL_COORDINATESYSTEM
+        PhysicsWorld{ Vector2f{ 0.f, -981.f } }
+#else
+        PhysicsWorld{ Vector2f{ 0.f, 981.f } }
+#endif // MATHEMATICAL_COORDINATESYSTEM
+    {}
+
+    PhysicsWorld::PhysicsWorld(const Vector2f& gravity) :
+        m_Gravity{ gravity }
+    {}
+
+    BodyID PhysicsWorld::AddBody(const Circlef& circle, const BodyDefinition& definition)
+    {
+        Shape shape{};
+        shape.type = ShapeType::Circle;
+        shape.radius = circle.rad;
+
+        const float area{ std::numbers::pi_v<float> * circle.rad * circle.rad };
+        return AddBody(shape, area, circle.center, area * circle.rad * circle.rad * 0.5f, definition);
+    }
+
+    BodyID PhysicsWorld::AddBody(const Rectf& rect, const BodyDefinition& definition)
+    {
+#ifdef MATHEMATICAL_COORDINATESYSTEM
+        const float yMin{ rect.bottom };
+#else
+        const float yMin{ rect.top };
+#endif // MATHEMATICAL_COORDINATESYSTEM
+        return AddPolygonBody({
+            Point2f{ rect.left, yMin },
+            Point2f{ rect.left + rect.width, yMin },
+            Point2f{ rect.left + rect.width, yMin + rect.height },
+            Point2f{ rect.left, yMin + rect.height } }, definition);
+    }
+
+    BodyID PhysicsWorld::AddBody(const Ellipsef& ellipse, const BodyDefinition& definition)
+    {
+        std::vector<Point2f> points(maxPolygonVertices);
+        for (uint32_t i = 0; i < maxPolygonVertices; ++i)
+        {
+            const float angle{ 2.f * std::numbers::pi_v<float> * static_cast<float>(i) / maxPolygonVertices };
+            points[i] = Point2f{ ellipse.center.x + ellipse.radiusX * std::cos(angle), ellipse.center.y + ellipse.radiusY * std::sin(angle) };
+        }
+        return AddPolygonBody(std::move(points), definition);
+    }
+
+    BodyID PhysicsWorld::AddBody(const Point2fArray& points, const BodyDefinition& definition)
+    {
+        return AddPolygonBody(points.ToVector(), definition);
+    }
+
+    BodyID PhysicsWorld::AddPolygonBody(std::vector<Point2f> points, const BodyDefinition& definition)
+    {
+        std::vector<Point2f> hull{ ConvexHull(std::move(points)) };
+        if (hull.size() < 3) return invalidBody;
+
+        if (hull.size() > maxPolygonVertices)
+        {
+            std::vector<Point2f> reduced(maxPolygonVertices);
+            for (std::size_t i = 0; i < maxPolygonVertices; ++i) reduced[i] = hull[i * hull.size() / maxPolygonVertices];
+            hull = std::move(reduced);
+        }
+
+        // Area, centroid and inertia of the triangle fan around the first vertex, for a density of 1
+        const Point2f& origin{ hull[0] };
+        float area{};
+        float inertia{};
+        Vector2f center{};
+        for (std::size_t i = 1; i + 1 < hull.size(); ++i)
+        {
+            const Vector2f edge1{ hull[i] - origin };
+            const Vector2f edge2{ hull[i + 1] - origin };
+            const float doubleArea{ Vector2f::Cross(edge1, edge2) };
+            const float triangleArea{ 0.5f * doubleArea };
+
+            area += triangleArea;
+            center += (edge1 + edge2) * (triangleArea / 3.f);
+
+            const float xIntegral{ edge1.x * edge1.x + edge2.x * edge1.x + edge2.x * edge2.x };
+            const float yIntegral{ edge1.y * edge1.y + edge2.y * edge1.y + edge2.y * edge2.y };
+            inertia += (0.25f / 3.f * doubleArea) * (xIntegral + yIntegral);
+        }
+        if (area <= FLT_EPSILON) return invalidBody;
+
+        center /= area;
+        const Point2f centroid{ origin + center };
+        // Move the inertia from the first vertex to the centroid
+        inertia -= area * center.SquaredLength();
+
+        Shape shape{};
+        shape.type = ShapeType::Polygon;
+        shape.vertexCount = static_cast<uint32_t>(hull.size());
+        for (uint32_t i = 0; i < shape.vertexCount; ++i)
+        {
+            shape.vertices[i] = hull[i] - centroid;
+        }
+        for (uint32_t i = 0; i < shape.vertexCount; ++i)
+        {
+            const Vector2f edge{ shape.vertices[(i + 1) % shape.vertexCount] - shape.vertices[i] };
+            shape.normals[i] = Vector2f{ edge.y, -edge.x }.Normalized();
+        }
+
+        return AddBody(shape, area, centroid, inertia, definition);
+    }
+
+    BodyID PhysicsWorld::AddBody(const Shape& shape, float area, const Point2f& centroid, float unitInertia, const BodyDefinition& definition)
+    {
+        BodyID body{};
+        if (!m_FreeBodies.empty())
+        {
+            body = m_FreeBodies.back();
+            m_FreeBodies.pop_back();
+        }
+        else
+        {
+            body = static_cast<BodyID>(m_Flags.size());
+            const std::size_t size{ m_Flags.size() + 1 };
+            for (std::vector<float>* pVector : {
+                &m_PositionX, &m_PositionY, &m_Angle, &m_Cos, &m_Sin,
+                &m_VelocityX, &m_VelocityY, &m_AngularVelocity, &m_ForceX, &m_ForceY, &m_Torque,
+                &m_InvMass, &m_InvInertia, &m_Friction, &m_Restitution, &m_LinearDamping, &m_AngularDamping,
+                &m_SleepTime, &m_MinX, &m_MinY, &m_MaxX, &m_MaxY })
+            {
+                pVector->resize(size);
+            }
+            m_Flags.resize(size);
+            m_Shapes.resize(size);
+            m_SortedBodies.push_back(body);
+        }
+
+        const bool isDynamic{ definition.type == BodyType::Dynamic };
+        float invMass{};
+        float invInertia{};
+        if (isDynamic)
+        {
+            // Massless dynamic bodies would be unstable, so they weigh 1 unit.
+            const float mass{ definition.density > 0.f ? definition.density * area : 1.f };
+            const float inertia{ mass * unitInertia / area };
+            invMass = 1.f / mass;
+            invInertia = inertia > 0.f ? 1.f / inertia : 0.f;
+        }
+
+        const float angle{ ToRadians(definition.angle) };
+        m_PositionX[body] = centroid.x;
+        m_PositionY[body] = centroid.y;
+        m_Angle[body] = angle;
+        m_Cos[body] = std::cos(angle);
+        m_Sin[body] = std::sin(angle);
+        m_VelocityX[body] = isDynamic ? definition.velocity.x : 0.f;
+        m_VelocityY[body] = isDynamic ? definition.velocity.y : 0.f;
+        m_AngularVelocity[body] = isDynamic ? ToRadians(definition.angularVelocity) : 0.f;
+        m_ForceX[body] = 0.f;
+        m_ForceY[body] = 0.f;
+        m_Torque[body] = 0.f;
+        m_InvMass[body] = invMass;
+        m_InvInertia[body] = invInertia;
+        m_Friction[body] = definition.friction;
+        m_Restitution[body] = definition.restitution;
+        m_LinearDamping[body] = definition.linearDamping;
+        m_AngularDamping[body] = definition.angularDamping;
+        m_SleepTime[body] = 0.f;
+        m_Flags[body] = isDynamic ? aliveFlag | dynamicFlag | awakeFlag : aliveFlag;
+        m_Shapes[body] = shape;
+
+        ++m_BodyCount;
+        return body;
+    }
+
+    void PhysicsWorld::RemoveBody(BodyID body)
+    {
+        assert(IsValid(body) && "Tried to remove a body that isn't part of the world.");
+        if (!IsValid(body)) return;
+
+        // Whatever rested on the body has to start moving again
+        std::erase_if(m_Contacts, [this, body](const Contact& contact)
+            {
+                if (contact.bodyA != body && contact.bodyB != body) return false;
+                Wake(contact.bodyA == body ? contact.bodyB : contact.bodyA);
+                return true;
+            });
+
+        m_Flags[body] = 0;
+        // Sorts the body to the end of the broadphase
+        m_MinX[body] = infinity;
+        m_MaxX[body] = infinity;
+        m_FreeBodies.push_back(body);
+        --m_BodyCount;
+    }
+
+    bool PhysicsWorld::IsValid(BodyID body) const
+    {
+        return body < m_Flags.size() && (m_Flags[body] & aliveFlag);
+    }
+
+    Point2f PhysicsWorld::GetPosition(BodyID body) const
+    {
+        assert(IsValid(body));
+        return Point2f{ m_PositionX[body], m_PositionY[body] };
+    }
+    float PhysicsWorld::GetAngle(BodyID body) const
+    {
+        assert(IsValid(body));
+        return ToDegrees(m_Angle[body]);
+    }
+    Vector2f PhysicsWorld::GetVelocity(BodyID body) const
+    {
+        assert(IsValid(body));
+        return Vector2f{ m_VelocityX[body], m_VelocityY[body] };
+    }
+    float PhysicsWorld::GetAngularVelocity(BodyID body) const
+    {
+        assert(IsValid(body));
+        return ToDegrees(m_AngularVelocity[body]);
+    }
+    float PhysicsWorld::GetMass(BodyID body) const
+    {
+        assert(IsValid(body));
+        return m_InvMass[body] > 0.f ? 1.f / m_InvMass[body] : 0.f;
+    }
+    BodyType PhysicsWorld::GetBodyType(BodyID body) const
+    {
+        assert(IsValid(body));
+        return (m_Flags[body] & dynamicFlag) ? BodyType::Dynamic : BodyType::Static;
+    }
+    Matrix3x2 PhysicsWorld::GetTransform(BodyID body) const
+    {
+        assert(IsValid(body));
+        return Matrix3x2::FromCosSin(std::cos(m_Angle[body]), std::sin(m_Angle[body]))
+            * Matrix3x2::Translation(m_PositionX[body], m_PositionY[body]);
+    }
+
+    ShapeType PhysicsWorld::GetShapeType(BodyID body) const
+    {
+        assert(IsValid(body));
+        return m_Shapes[body].type;
+    }
+    float PhysicsWorld::GetRadius(BodyID body) const
+    {
+        assert(IsValid(body));
+        return m_Shapes[body].radius;
+    }
+    void PhysicsWorld::GetWorldVertices(BodyID body, Point2fArray& vertices) const
+    {
+        assert(IsValid(body));
+        const Shape& shape{ m_Shapes[body] };
+
+        vertices.Resize(shape.vertexCount);
+        for (uint32_t i = 0; i < shape.vertexCount; ++i)
+        {
+            vertices.Set(i, Point2f{ shape.vertices[i].x, shape.vertices[i].y });
+        }
+        vertices.Transform(GetTransform(body));
+    }
+
+    void PhysicsWorld::SetPosition(BodyID body, const Point2f& position)
+    {
+        assert(IsValid(body));
+        m_PositionX[body] = position.x;
+        m_PositionY[body] = position.y;
+        Wake(body);
+    }
+    void PhysicsWorld::SetAngle(BodyID body, float angle)
+    {
+        assert(IsValid(body));
+        m_Angle[body] = ToRadians(angle);
+        Wake(body);
+    }
+    void PhysicsWorld::SetVelocity(BodyID body, const Vector2f& velocity)
+    {
+        assert(IsValid(body));
+        if (!(m_Flags[body] & dynamicFlag)) return;
+        m_VelocityX[body] = velocity.x;
+        m_VelocityY[body] = velocity.y;
+        Wake(body);
+    }
+    void PhysicsWorld::SetAngularVelocity(BodyID body, float angularVelocity)
+    {
+        assert(IsValid(body));
+        if (!(m_Flags[body] & dynamicFlag)) return;
+        m_AngularVelocity[body] = ToRadians(angularVelocity);
+        Wake(body);
+    }
+
+    void PhysicsWorld::ApplyForce(BodyID body, const Vector2f& force)
+    {
+        assert(IsValid(body));
+        if (!(m_Flags[body] & dynamicFlag)) return;
+        m_ForceX[body] += force.x;
+        m_ForceY[body] += force.y;
+        Wake(body);
+    }
+    void PhysicsWorld::ApplyForce(BodyID body, const Vector2f& force, const Point2f& worldPoint)
+    {
+        ApplyForce(body, force);
+        ApplyTorque(body, Vector2f::Cross(worldPoint - GetPosition(body), force));
+    }
+    void PhysicsWorld::ApplyTorque(BodyID body, float torque)
+    {
+        assert(IsValid(body));
+        if (!(m_Flags[body] & dynamicFlag)) return;
+        m_Torque[body] += torque;
+        Wake(body);
+    }
+    void PhysicsWorld::ApplyImpulse(BodyID body, const Vector2f& impulse)
+    {
+        assert(IsValid(body));
+        if (!(m_Flags[body] & dynamicFlag)) return;
+        m_VelocityX[body] += m_InvMass[body] * impulse.x;
+        m_VelocityY[body] += m_InvMass[body] * impulse.y;
+        Wake(body);
+    }
+    void PhysicsWorld::ApplyImpulse(BodyID body, const Vector2f& impulse, const Point2f& worldPoint)
+    {
+        ApplyImpulse(body, impulse);
+        if (!(m_Flags[body] & dynamicFlag)) return;
+        m_AngularVelocity[body] += m_InvInertia[body] * Vector2f::Cross(worldPoint - GetPosition(body), impulse);
+    }
+
+    bool PhysicsWorld::IsAwake(BodyID body) const
+    {
+        assert(IsValid(body));
+        return m_Flags[body] & awakeFlag;
+    }
+    void PhysicsWorld::SetAwake(BodyID body, bool awake)
+    {
+        assert(IsValid(body));
+        if (awake)
+        {
+            Wake(body);
+        }
+        else if (m_Flags[body] & dynamicFlag)
+        {
+            m_Flags[body] &= ~awakeFlag;
+            m_VelocityX[body] = 0.f;
+            m_VelocityY[body] = 0.f;
+            m_AngularVelocity[body] = 0.f;
+        }
+    }
+
+    void PhysicsWorld::Wake(BodyID body)
+    {
+        if (!(m_Flags[body] & dynamicFlag)) return;
+        m_Flags[body] |= awakeFlag;
+        m_SleepTime[body] = 0.f;
+    }
+    //---------------------------------------------------------------
+
+
+    //---------------------------------------------------------------
+    // Simulation
+    void PhysicsWorld::Step(float timeStep)
+    {
+        if (timeStep <= 0.f) return;
+
+        UpdateBounds();
+        FindContacts();
+        BuildIslands();
+
+        ForEach(m_IslandAwake.size(), 4, [this, timeStep](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t island = begin; island < end; ++island) SolveIsland(island, timeStep);
+            });
+    }
+
+    void PhysicsWorld::Update(float elapsedSec)
+    {
+        m_TimeAccumulator += elapsedSec;
+
+        uint32_t steps{};
+        while (m_TimeAccumulator >= m_FixedTimeStep && steps < maxSubSteps)
+        {
+            Step(m_FixedTimeStep);
+            m_TimeAccumulator -= m_FixedTimeStep;
+            ++steps;
+        }
+        // Drop what couldn't be caught up with instead of spiraling further behind
+        m_TimeAccumulator = std::min(m_TimeAccumulator, m_FixedTimeStep);
+    }
+
+    void PhysicsWorld::SetSleepingEnabled(bool enabled)
+    {
+        m_SleepingEnabled = enabled;
+        if (enabled) return;
+
+        for (BodyID body = 0; body < m_Flags.size(); ++body)
+        {
+            if (m_Flags[body] & aliveFlag) Wake(body);
+        }
+    }
+
+    void PhysicsWorld::UpdateBounds()
+    {
+        ForEach(m_Flags.size(), 256, [this](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t body = begin; body < end; ++body)
+                {
+                    if (!(m_Flags[body] & aliveFlag)) continue;
+
+                    const float cosAngle{ std::cos(m_Angle[body]) };
+                    const float sinAngle{ std::sin(m_Angle[body]) };
+                    m_Cos[body] = cosAngle;
+                    m_Sin[body] = sinAngle;
+
+                    const Shape& shape{ m_Shapes[body] };
+                    float minX{ shape.radius };
+                    float minY{ shape.radius };
+                    float maxX{ shape.radius };
+                    float maxY{ shape.radius };
+                    if (shape.type == ShapeType::Polygon)
+                    {
+                        minX = minY = infinity;
+                        maxX = maxY = -infinity;
+                        for (uint32_t i = 0; i < shape.vertexCount; ++i)
+                        {
+                            const Vector2f& vertex{ shape.vertices[i] };
+                            const float x{ cosAngle * vertex.x - sinAngle * vertex.y };
+                            const float y{ sinAngle * vertex.x + cosAngle * vertex.y };
+                            minX = std::min(minX, x);
+                            minY = std::min(minY, y);
+                            maxX = std::max(maxX, x);
+                            maxY = std::max(maxY, y);
+                        }
+                        minX = -minX;
+                        minY = -minY;
+                    }
+
+                    // Fattened by the slop so resting contacts within the margin are found
+                    m_MinX[body] = m_PositionX[body] - minX - linearSlop;
+                    m_MinY[body] = m_PositionY[body] - minY - linearSlop;
+                    m_MaxX[body] = m_PositionX[body] + maxX + linearSlop;
+                    m_MaxY[body] = m_PositionY[body] + maxY + linearSlop;
+                }
+            });
+    }
+
+    void PhysicsWorld::FindContacts()
+    {
+        // Broadphase: sort and sweep along x. Ties are broken by id to keep the pair order deterministic.
+        std::sort(m_SortedBodies.begin(), m_SortedBodies.end(), [this](BodyID first, BodyID second)
+            {
+                return m_MinX[first] < m_MinX[second] || (m_MinX[first] == m_MinX[second] && first < second);
+            });
+
+        m_Pairs.clear();
+        for (std::size_t i = 0; i < m_SortedBodies.size(); ++i)
+        {
+            const BodyID bodyA{ m_SortedBodies[i] };
+            // Removed bodies are sorted to the end
+            if (!(m_Flags[bodyA] & aliveFlag)) break;
+
+            for (std::size_t j = i + 1; j < m_SortedBodies.size(); ++j)
+            {
+                const BodyID bodyB{ m_SortedBodies[j] };
+                if (m_MinX[bodyB] > m_MaxX[bodyA]) break;
+                if (!((m_Flags[bodyA] | m_Flags[bodyB]) & dynamicFlag)) continue;
+                if (m_MinY[bodyB] > m_MaxY[bodyA] || m_MinY[bodyA] > m_MaxY[bodyB]) continue;
+
+                m_Pairs.push_back(MakePairKey(bodyA, bodyB));
+            }
+        }
+        std::sort(m_Pairs.begin(), m_Pairs.end());
+
+        // Both lists are sorted on key, so last step's contacts are matched in one pass.
+        m_NewContacts.resize(m_Pairs.size());
+        m_PreviousContact.resize(m_Pairs.size());
+        std::size_t previousContact{};
+        for (std::size_t i = 0; i < m_Pairs.size(); ++i)
+        {
+            while (previousContact < m_Contacts.size() && m_Contacts[previousContact].key < m_Pairs[i]) ++previousContact;
+            const bool found{ previousContact < m_Contacts.size() && m_Contacts[previousContact].key == m_Pairs[i] };
+            m_PreviousContact[i] = found ? static_cast<uint32_t>(previousContact) : noSolverBody;
+        }
+
+        // Narrowphase
+        ForEach(m_Pairs.size(), 64, [this](std::size_t begin, std::size_t end)
+            {
+                for (std::size_t i = begin; i < end; ++i)
+                {
+                    Contact& contact{ m_NewContacts[i] };
+                    const uint32_t previous{ m_PreviousContact[i] };
+                    const BodyID bodyA{ static_cast<BodyID>(m_Pairs[i] >> 32) };
+                    const BodyID bodyB{ static_cast<BodyID>(m_Pairs[i] & 0xFFFFFFFF) };
+
+                    // Nothing moved between sleeping bodies, so their old contact is still accurate.
+                    if (!((m_Flags[bodyA] | m_Flags[bodyB]) & awakeFlag))
+                    {
+                        if (previous != noSolverBody) contact = m_Contacts[previous];
+                        else contact.pointCount = 0;
+                        continue;
+                    }
+
+                    contact.key = m_Pairs[i];
+                    contact.bodyA = bodyA;
+                    contact.bodyB = bodyB;
+                    contact.friction = std::sqrt(m_Friction[bodyA] * m_Friction[bodyB]);
+                    contact.restitution = std::max(m_Restitution[bodyA], m_Restitution[bodyB]);
+                    contact.pointCount = 0;
+                    Collide(contact);
+
+                    if (previous == noSolverBody) continue;
+
+                    // Warm starting
+                    const Contact& oldContact{ m_Contacts[previous] };
+                    for (uint32_t point = 0; point < contact.pointCount; ++point)
+                    {
+                        for (uint32_t oldPoint = 0; oldPoint < oldContact.pointCount; ++oldPoint)
+                        {
+                            if (oldContact.points[oldPoint].featureID != contact.points[point].featureID) continue;
+                            contact.points[point].normalImpulse = oldContact.points[oldPoint].normalImpulse;
+                            contact.points[point].tangentImpulse = oldContact.points[oldPoint].tangentImpulse;
+                            break;
+                        }
+                    }
+                }
+            });
+
+        std::erase_if(m_NewContacts, [](const Contact& contact) { return contact.pointCount == 0; });
+        m_Contacts.swap(m_NewContacts);
+    }
+
+    void PhysicsWorld::Collide(Contact& contact) const
+    {
+        const Shape& shapeA{ m_Shapes[contact.bodyA] };
+        const Shape& shapeB{ m_Shapes[contact.bodyB] };
+        const Vector2f positionA{ m_PositionX[contact.bodyA], m_PositionY[contact.bodyA] };
+        const Vector2f positionB{ m_PositionX[contact.bodyB], m_PositionY[contact.bodyB] };
+
+        auto toWorld = [this](BodyID body, const Shape& shape, const Vector2f& position)
+            {
+                const float cosAngle{ m_Cos[body] };
+                const float sinAngle{ m_Sin[body] };
+
+                WorldPolygon polygon{};
+                polygon.count = shape.vertexCount;
+                for (uint32_t i = 0; i < shape.vertexCount; ++i)
+                {
+                    const Vector2f& vertex{ shape.vertices[i] };
+                    const Vector2f& normal{ shape.normals[i] };
+                    polygon.vertices[i] = position + Vector2f{ cosAngle * vertex.x - sinAngle * vertex.y, sinAngle * vertex.x + cosAngle * vertex.y };
+                    polygon.normals[i] = Vector2f{ cosAngle * normal.x - sinAngle * normal.y, sinAngle * normal.x + cosAngle * normal.y };
+                }
+                return polygon;
+            };
+
+        Manifold manifold{};
+        if (shapeA.type == ShapeType::Circle && shapeB.type == ShapeType::Circle)
+        {
+            CollideCircles(positionA, shapeA.radius, positionB, shapeB.radius, manifold);
+        }
+        else if (shapeA.type == ShapeType::Polygon && shapeB.type == ShapeType::Circle)
+        {
+            CollidePolygonAndCircle(toWorld(contact.bodyA, shapeA, positionA), positionB, shapeB.radius, manifold);
+        }
+        else if (shapeA.type == ShapeType::Circle && shapeB.type == ShapeType::Polygon)
+        {
+            CollidePolygonAndCircle(toWorld(contact.bodyB, shapeB, positionB), positionA, shapeA.radius, manifold);
+            manifold.normal = -manifold.normal;
+        }
+        else
+        {
+            CollidePolygons(toWorld(contact.bodyA, shapeA, positionA), toWorld(contact.bodyB, shapeB, positionB), manifold);
+        }
+
+        contact.normal = manifold.normal;
+        contact.pointCount = manifold.pointCount;
+        for (uint32_t i = 0; i < manifold.pointCount; ++i)
+        {
+            ContactPoint& point{ contact.points[i] };
+            point = ContactPoint{};
+            point.position = manifold.points[i].position;
+            point.separation = manifold.points[i].separation;
+            point.featureID = manifold.points[i].featureID;
+        }
+    }
+
+    void PhysicsWorld::BuildIslands()
+    {
+        const std::size_t capacity{ m_Flags.size() };
+
+        // Union-find over the dynamic bodies. The smallest id becomes the root, which keeps the island order stable.
+        m_IslandParent.resize(capacity);
+        std::iota(m_IslandParent.begin(), m_IslandParent.end(), 0u);
+        auto findRoot = [this](uint32_t body)
+            {
+                while (m_IslandParent[body] != body)
+                {
+                    m_IslandParent[body] = m_IslandParent[m_IslandParent[body]];
+                    body = m_IslandParent[body];
+                }
+                return body;
+            };
+
+        for (const Contact& contact : m_Contacts)
+        {
+            if (!(m_Flags[contact.bodyA] & m_Flags[contact.bodyB] & dynamicFlag)) continue;
+
+            const uint32_t rootA{ findRoot(contact.bodyA) };
+            const uint32_t rootB{ findRoot(contact.bodyB) };
+            if (rootA < rootB) m_IslandParent[rootB] = rootA;
+            else if (rootB < rootA) m_IslandParent[rootA] = rootB;
+        }
+
+        // Number the islands, a root always comes before the rest of its island
+        m_IslandOfBody.assign(capacity, noSolverBody);
+        m_IslandAwake.clear();
+        for (uint32_t body = 0; body < capacity; ++body)
+        {
+            if ((m_Flags[body] & (aliveFlag | dynamicFlag)) != (aliveFlag | dynamicFlag)) continue;
+
+            const uint32_t root{ findRoot(body) };
+            if (root == body)
+            {
+                m_IslandOfBody[body] = static_cast<uint32_t>(m_IslandAwake.size());
+                m_IslandAwake.push_back(0);
+            }
+            else
+            {
+                m_IslandOfBody[body] = m_IslandOfBody[root];
+            }
+            m_IslandAwake[m_IslandOfBody[body]] |= static_cast<uint8_t>(m_Flags[body] & awakeFlag);
+        }
+        const std::size_t islandCount{ m_IslandAwake.size() };
+
+        // A single awake body wakes up its whole island
+        if (!m_SleepingEnabled) std::fill(m_IslandAwake.begin(), m_IslandAwake.end(), awakeFlag);
+        m_AwakeIslandCount = static_cast<std::size_t>(std::count(m_IslandAwake.begin(), m_IslandAwake.end(), awakeFlag));
+
+        // Counting sort the bodies and contacts per island. The parent array is reused as body to solver index map.
+        m_IslandBodyStart.assign(islandCount + 1, 0);
+        for (uint32_t body = 0; body < capacity; ++body)
+        {
+            if (m_IslandOfBody[body] != noSolverBody) ++m_IslandBodyStart[m_IslandOfBody[body] + 1];
+        }
+        std::partial_sum(m_IslandBodyStart.begin(), m_IslandBodyStart.end(), m_IslandBodyStart.begin());
+
+        m_IslandBodies.resize(m_IslandBodyStart.back());
+        std::vector<uint32_t>& solverIndex{ m_IslandParent };
+        {
+            std::vector<uint32_t> next(m_IslandBodyStart.begin(), m_IslandBodyStart.end() - 1);
+            for (uint32_t body = 0; body < capacity; ++body)
+            {
+                const uint32_t island{ m_IslandOfBody[body] };
+                if (island == noSolverBody)
+                {
+                    solverIndex[body] = noSolverBody;
+                    continue;
+                }
+
+                if (m_IslandAwake[island] && !(m_Flags[body] & awakeFlag)) Wake(body);
+
+                solverIndex[body] = next[island];
+                m_IslandBodies[next[island]++] = body;
+            }
+        }
+
+        auto islandOfContact = [this](const Contact& contact)
+            {
+                return m_IslandOfBody[(m_Flags[contact.bodyA] & dynamicFlag) ? contact.bodyA : contact.bodyB];
+            };
+
+        m_IslandContactStart.assign(islandCount + 1, 0);
+        for (const Contact& contact : m_Contacts) ++m_IslandContactStart[islandOfContact(contact) + 1];
+        std::partial_sum(m_IslandContactStart.begin(), m_IslandContactStart.end(), m_IslandContactStart.begin());
+
+        m_IslandContacts.resize(m_Contacts.size());
+        std::vector<uint32_t> next(m_IslandContactStart.begin(), m_IslandContactStart.end() - 1);
+        for (uint32_t i = 0; i < m_Contacts.size(); ++i)
+        {
+            Contact& contact{ m_Contacts[i] };
+            contact.solverA = solverIndex[contact.bodyA];
+            contact.solverB = solverIndex[contact.bodyB];
+            m_IslandContacts[next[islandOfContact(contact)]++] = i;
+        }
+
+        m_SolverVelocityX.resize(m_IslandBodies.size());
+        m_SolverVelocityY.resize(m_IslandBodies.size());
+        m_SolverAngularVelocity.resize(m_IslandBodies.size());
+        m_SolverInvMass.resize(m_IslandBodies.size());
+        m_SolverInvInertia.resize(m_IslandBodies.size());
+    }
+
+    void PhysicsWorld::SolveIsland(std::size_t island, float timeStep)
+    {
+        if (!m_IslandAwake[island]) return;
+
+        const uint32_t bodyBegin{ m_IslandBodyStart[island] };
+        const uint32_t bodyEnd{ m_IslandBodyStart[island + 1] };
+        const uint32_t contactBegin{ m_IslandContactStart[island] };
+        const uint32_t contactEnd{ m_IslandContactStart[island + 1] };
+        const float invTimeStep{ 1.f / timeStep };
+
+        // Integrate velocities into the solver bodies
+        for (uint32_t i = bodyBegin; i < bodyEnd; ++i)
+        {
+            const BodyID body{ m_IslandBodies[i] };
+            const float invMass{ m_InvMass[body] };
+            const float invInertia{ m_InvInertia[body] };
+            const float linearDamping{ 1.f / (1.f + timeStep * m_LinearDamping[body]) };
+            const float angularDamping{ 1.f / (1.f + timeStep * m_AngularDamping[body]) };
+
+            m_SolverVelocityX[i] = (m_VelocityX[body] + timeStep * (m_Gravity.x + invMass * m_ForceX[body])) * linearDamping;
+            m_SolverVelocityY[i] = (m_VelocityY[body] + timeStep * (m_Gravity.y + invMass * m_ForceY[body])) * linearDamping;
+            m_SolverAngularVelocity[i] = (m_AngularVelocity[body] + timeStep * invInertia * m_Torque[body]) * angularDamping;
+            m_SolverInvMass[i] = invMass;
+            m_SolverInvInertia[i] = invInertia;
+        }
+
+        // Static bodies don't get a solver body, they read as zero velocity and infinite mass.
+        auto solverVelocity = [this](uint32_t solver)
+            {
+                return solver == noSolverBody ? Vector2f{} : Vector2f{ m_SolverVelocityX[solver], m_SolverVelocityY[solver] };
+            };
+        auto solverAngularVelocity = [this](uint32_t solver)
+            {
+                return solver == noSolverBody ? 0.f : m_SolverAngularVelocity[solver];
+            };
+        auto applyImpulse = [this](uint32_t solver, const Vector2f& impulse, const Vector2f& arm)
+            {
+                if (solver == noSolverBody) return;
+                m_SolverVelocityX[solver] += m_SolverInvMass[solver] * impulse.x;
+                m_SolverVelocityY[solver] += m_SolverInvMass[solver] * impulse.y;
+                m_SolverAngularVelocity[solver] += m_SolverInvInertia[solver] * Vector2f::Cross(arm, impulse);
+            };
+
+        // Prepare the contacts and apply last step's impulses
+        for (uint32_t c = contactBegin; c < contactEnd; ++c)
+        {
+            Contact& contact{ m_Contacts[m_IslandContacts[c]] };
+            const Vector2f positionA{ m_PositionX[contact.bodyA], m_PositionY[contact.bodyA] };
+            const Vector2f positionB{ m_PositionX[contact.bodyB], m_PositionY[contact.bodyB] };
+            const float invMassA{ contact.solverA == noSolverBody ? 0.f : m_SolverInvMass[contact.solverA] };
+            const float invMassB{ contact.solverB == noSolverBody ? 0.f : m_SolverInvMass[contact.solverB] };
+            const float invInertiaA{ contact.solverA == noSolverBody ? 0.f : m_SolverInvInertia[contact.solverA] };
+            const float invInertiaB{ contact.solverB == noSolverBody ? 0.f : m_SolverInvInertia[contact.solverB] };
+            const Vector2f normal{ contact.normal };
+            const Vector2f tangent{ normal.y, -normal.x };
+
+            for (uint32_t p = 0; p < contact.pointCount; ++p)
+            {
+                ContactPoint& point{ contact.points[p] };
+                point.rA = point.position - positionA;
+                point.rB = point.position - positionB;
+
+                const float rnA{ Vector2f::Cross(point.rA, normal) };
+                const float rnB{ Vector2f::Cross(point.rB, normal) };
+                const float normalMass{ invMassA + invMassB + invInertiaA * rnA * rnA + invInertiaB * rnB * rnB };
+                point.normalMass = normalMass > 0.f ? 1.f / normalMass : 0.f;
+
+                const float rtA{ Vector2f::Cross(point.rA, tangent) };
+                const float rtB{ Vector2f::Cross(point.rB, tangent) };
+                const float tangentMass{ invMassA + invMassB + invInertiaA * rtA * rtA + invInertiaB * rtB * rtB };
+                point.tangentMass = tangentMass > 0.f ? 1.f / tangentMass : 0.f;
+
+                const Vector2f relativeVelocity{
+                    solverVelocity(contact.solverB) + Cross(solverAngularVelocity(contact.solverB), point.rB)
+                    - solverVelocity(contact.solverA) - Cross(solverAngularVelocity(contact.solverA), point.rA) };
+                const float normalVelocity{ Vector2f::Dot(relativeVelocity, normal) };
+
+                // Points within the slop count as touching, overlap beyond it is pushed out gradually.
+                point.velocityBias = -baumgarte * invTimeStep * std::min(0.f, point.separation + linearSlop);
+                point.relaxBias = 0.f;
+                if (contact.restitution > 0.f && normalVelocity < -restitutionThreshold)
+                {
+                    const float bounce{ -contact.restitution * normalVelocity };
+                    point.velocityBias = std::max(point.velocityBias, bounce);
+                    point.relaxBias = std::max(point.relaxBias, bounce);
+                }
+
+                const Vector2f impulse{ normal * point.normalImpulse + tangent * point.tangentImpulse };
+                applyImpulse(contact.solverA, -impulse, point.rA);
+                applyImpulse(contact.solverB, impulse, point.rB);
+            }
+
+            if (contact.pointCount == 2)
+            {
+                const float rn1A{ Vector2f::Cross(contact.points[0].rA, normal) };
+                const float rn1B{ Vector2f::Cross(contact.points[0].rB, normal) };
+                const float rn2A{ Vector2f::Cross(contact.points[1].rA, normal) };
+                const float rn2B{ Vector2f::Cross(contact.points[1].rB, normal) };
+                const float k11{ invMassA + invMassB + invInertiaA * rn1A * rn1A + invInertiaB * rn1B * rn1B };
+                const float k22{ invMassA + invMassB + invInertiaA * rn2A * rn2A + invInertiaB * rn2B * rn2B };
+                const float k12{ invMassA + invMassB + invInertiaA * rn1A * rn2A + invInertiaB * rn1B * rn2B };
+                const float determinant{ k11 * k22 - k12 * k12 };
+
+                // Nearly parallel points make the block ill-conditioned, those are solved one by one instead.
+                contact.blockK = { k11, k12, k22 };
+                if (k11 * k11 < 1000.f * determinant)
+                {
+                    const float invDeterminant{ 1.f / determinant };
+                    contact.blockMass = { k22 * invDeterminant, -k12 * invDeterminant, k11 * invDeterminant };
+                }
+                else
+                {
+                    contact.blockMass = { 0.f, 0.f, 0.f };
+                }
+            }
+        }
+
+        // Sequential impulses. With useBias the overlap is pushed out, the relax pass afterwards
+        // takes that extra velocity away again so stacks don't gain energy from their own correction.
+        auto solveContacts = [&](bool useBias)
+        {
+            for (uint32_t c = contactBegin; c < contactEnd; ++c)
+            {
+                Contact& contact{ m_Contacts[m_IslandContacts[c]] };
+                const Vector2f normal{ contact.normal };
+                const Vector2f tangent{ normal.y, -normal.x };
+
+                auto relativeVelocity = [&](const ContactPoint& point)
+                    {
+                        return solverVelocity(contact.solverB) + Cross(solverAngularVelocity(contact.solverB), point.rB)
+                            - solverVelocity(contact.solverA) - Cross(solverAngularVelocity(contact.solverA), point.rA);
+                    };
+                auto targetVelocity = [useBias](const ContactPoint& point)
+                    {
+                        return useBias ? point.velocityBias : point.relaxBias;
+                    };
+                auto applyNormalImpulse = [&](ContactPoint& point, float normalImpulse)
+                    {
+                        const Vector2f impulse{ normal * (normalImpulse - point.normalImpulse) };
+                        point.normalImpulse = normalImpulse;
+                        applyImpulse(contact.solverA, -impulse, point.rA);
+                        applyImpulse(contact.solverB, impulse, point.rB);
+                    };
+
+                // Friction, bounded by the normal impulse
+                for (uint32_t p = 0; p < contact.pointCount; ++p)
+                {
+                    ContactPoint& point{ contact.points[p] };
+                    const float tangentLambda{ -point.tangentMass * Vector2f::Dot(relativeVelocity(point), tangent) };
+                    const float maxFriction{ contact.friction * point.normalImpulse };
+                    const float tangentImpulse{ std::clamp(point.tangentImpulse + tangentLambda, -maxFriction, maxFriction) };
+                    const Vector2f impulse{ tangent * (tangentImpulse - point.tangentImpulse) };
+                    point.tangentImpulse = tangentImpulse;
+                    applyImpulse(contact.solverA, -impulse, point.rA);
+                    applyImpulse(contact.solverB, impulse, point.rB);
+                }
+
+                // Non-penetration, the accumulated impulse can only push
+                const bool solveBlock{ contact.pointCount == 2 && contact.blockMass[0] != 0.f };
+                if (!solveBlock)
+                {
+                    for (uint32_t p = 0; p < contact.pointCount; ++p)
+                    {
+                        ContactPoint& point{ contact.points[p] };
+                        const float normalLambda{ -point.normalMass * (Vector2f::Dot(relativeVelocity(point), normal) - targetVelocity(point)) };
+                        applyNormalImpulse(point, std::max(point.normalImpulse + normalLambda, 0.f));
+                    }
+                    continue;
+                }
+
+                // Both points at once, so a resting box doesn't rock from solving one corner before the other.
+                // This is a tiny linear complementarity problem: try all active sets until one is valid.
+                ContactPoint& point1{ contact.points[0] };
+                ContactPoint& point2{ contact.points[1] };
+                const auto& [k11, k12, k22] = contact.blockK;
+                const auto& [mass11, mass12, mass22] = contact.blockMass;
+                const float old1{ point1.normalImpulse };
+                const float old2{ point2.normalImpulse };
+
+                // Relative normal velocities with the accumulated impulses taken out
+                const float b1{ Vector2f::Dot(relativeVelocity(point1), normal) - targetVelocity(point1) - (k11 * old1 + k12 * old2) };
+                const float b2{ Vector2f::Dot(relativeVelocity(point2), normal) - targetVelocity(point2) - (k12 * old1 + k22 * old2) };
+
+                float impulse1{ -(mass11 * b1 + mass12 * b2) };
+                float impulse2{ -(mass12 * b1 + mass22 * b2) };
+                if (impulse1 < 0.f || impulse2 < 0.f)
+                {
+                    impulse1 = -point1.normalMass * b1;
+                    impulse2 = 0.f;
+                    if (impulse1 < 0.f || k12 * impulse1 + b2 < 0.f)
+                    {
+                        impulse1 = 0.f;
+                        impulse2 = -point2.normalMass * b2;
+                        if (impulse2 < 0.f || k12 * impulse2 + b1 < 0.f)
+                        {
+                            impulse2 = 0.f;
+                            // Both separating, otherwise no valid set exists and the impulses are left as they are
+                            if (b1 < 0.f || b2 < 0.f) continue;
+                        }
+                    }
+                }
+                applyNormalImpulse(point1, impulse1);
+                applyNormalImpulse(point2, impulse2);
+            }
+        };
+
+        for (uint32_t iteration = 0; iteration < m_VelocityIterations; ++iteration) solveContacts(true);
+
+        for (uint32_t i = bodyBegin; i < bodyEnd; ++i)
+        {
+            const BodyID body{ m_IslandBodies[i] };
+            m_PositionX[body] += timeStep * m_SolverVelocityX[i];
+            m_PositionY[body] += timeStep * m_SolverVelocityY[i];
+            m_Angle[body] += timeStep * m_SolverAngularVelocity[i];
+        }
+
+        for (uint32_t iteration = 0; iteration < relaxIterations; ++iteration) solveContacts(false);
+
+        // Write the bodies back
+        float minSleepTime{ infinity };
+        for (uint32_t i = bodyBegin; i < bodyEnd; ++i)
+        {
+            const BodyID body{ m_IslandBodies[i] };
+            const float velocityX{ m_SolverVelocityX[i] };
+            const float velocityY{ m_SolverVelocityY[i] };
+            const float angularVelocity{ m_SolverAngularVelocity[i] };
+
+            m_VelocityX[body] = velocityX;
+            m_VelocityY[body] = velocityY;
+            m_AngularVelocity[body] = angularVelocity;
+            m_ForceX[body] = 0.f;
+            m_ForceY[body] = 0.f;
+            m_Torque[body] = 0.f;
+
+            if (angularVelocity * angularVelocity > angularSleepTolerance * angularSleepTolerance ||
+                velocityX * velocityX + velocityY * velocityY > linearSleepTolerance * linearSleepTolerance)
+            {
+                m_SleepTime[body] = 0.f;
+            }
+            else
+            {
+                m_SleepTime[body] += timeStep;
+            }
+            minSleepTime = std::min(minSleepTime, m_SleepTime[body]);
+        }
+
+        if (!m_SleepingEnabled || minSleepTime < timeToSleep) return;
+
+        for (uint32_t i = bodyBegin; i < bodyEnd; ++i)
+        {
+            const BodyID body{ m_IslandBodies[i] };
+            m_Flags[body] &= ~awakeFlag;
+            m_VelocityX[body] = 0.f;
+            m_VelocityY[body] = 0.f;
+            m_AngularVelocity[body] = 0.f;
+        }
+    }
+
+    void PhysicsWorld::ForEach(std::size_t count, std::size_t grainSize, const std::function<void(std::size_t begin, std::size_t end)>& task)
+    {
+        if (m_pThreadPool) m_pThreadPool->ParallelFor(count, grainSize, task);
+        else if (count > 0) task(0, count);
+    }
+    //---------------------------------------------------------------
+}
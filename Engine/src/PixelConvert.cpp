@@ -0,0 +1,955 @@
+#include "PixelConvert.h"
+#include "Simd.h"
+#include <algorithm>
+#include <atomic>
+#include <cassert>
+#include <cmath>
+#include <cstring>
+
+#if defined(JELA_SIMD_SSE2)
+    #include <immintrin.h>
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #include <intrin.h>
+    #endif
+#endif
+
+namespace jela::pixels
+{
+    namespace
+    {
+        constexpr float byteToFloat{ 1.f / 255.f };
+
+        // Every level has the same kernels, counts are in pixels or, for the float conversions, in values
+        struct Kernels
+        {
+            SimdLevel level;
+            void (*pSwapRedBlue)(const uint8_t* pSource, uint8_t* pDestination, std::size_t count);
+            void (*pPremultiply)(const uint8_t* pSource, uint8_t* pDestination, std::size_t count);
+            void (*pUnpremultiply)(const uint8_t* pSource, uint8_t* pDestination, std::size_t count);
+            void (*pRgbaToPremultipliedBgra)(const uint8_t* pSource, uint8_t* pDestination, std::size_t count);
+            void (*pRgbToBgra)(const uint8_t* pSource, uint8_t* pDestination, std::size_t count);
+            void (*pGrayToBgra)(const uint8_t* pSource, uint8_t* pDestination, std::size_t count);
+            void (*pGrayAlphaToPremultipliedBgra)(const uint8_t* pSource, uint8_t* pDestination, std::size_t count);
+            void (*pColorKeyToAlpha)(uint8_t* pPixels, std::size_t count, uint32_t keyColor);
+            void (*pToFloat)(const uint8_t* pSource, float* pDestination, std::size_t count);
+            void (*pFromFloat)(const float* pSource, uint8_t* pDestination, std::size_t count);
+        };
+
+        //---------------------
+        // Scalar kernels. They define the results, the SIMD ones finish their last few pixels with these.
+        //---------------------
+
+        namespace scalar
+        {
+            // color * alpha / 255, rounded to nearest
+            uint8_t Premultiply(uint32_t color, uint32_t alpha)
+            {
+                const uint32_t product{ color * alpha + 128 };
+                return static_cast<uint8_t>((product + (product >> 8)) >> 8);
+            }
+
+            // Adds a half and truncates rather than calling nearbyint, which isn't inlined without SSE4.1.
+            // Dividing first keeps compilers from fusing the add into a multiply, the SIMD kernels do exactly the same.
+            uint8_t Unpremultiply(uint32_t color, uint32_t alpha)
+            {
+                const float value{ static_cast<float>(color) * 255.f / static_cast<float>(alpha) };
+                return static_cast<uint8_t>(std::min(value, 255.f) + 0.5f);
+            }
+
+            void SwapRedBlue(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                for (std::size_t pixel = 0; pixel < count; ++pixel)
+                {
+                    const uint8_t* const pIn{ pSource + pixel * 4 };
+                    uint8_t* const pOut{ pDestination + pixel * 4 };
+                    const uint8_t first{ pIn[0] };
+                    const uint8_t third{ pIn[2] };
+                    pOut[0] = third;
+                    pOut[1] = pIn[1];
+                    pOut[2] = first;
+                    pOut[3] = pIn[3];
+                }
+            }
+
+            void Premultiply(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                for (std::size_t pixel = 0; pixel < count; ++pixel)
+                {
+                    const uint8_t* const pIn{ pSource + pixel * 4 };
+                    uint8_t* const pOut{ pDestination + pixel * 4 };
+                    const uint8_t alpha{ pIn[3] };
+                    pOut[0] = Premultiply(pIn[0], alpha);
+                    pOut[1] = Premultiply(pIn[1], alpha);
+                    pOut[2] = Premultiply(pIn[2], alpha);
+                    pOut[3] = alpha;
+                }
+            }
+
+            void Unpremultiply(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                for (std::size_t pixel = 0; pixel < count; ++pixel)
+                {
+                    const uint8_t* const pIn{ pSource + pixel * 4 };
+                    uint8_t* const pOut{ pDestination + pixel * 4 };
+                    const uint8_t alpha{ pIn[3] };
+                    if (alpha == 0)
+                    {
+                        std::memset(pOut, 0, 4);
+                        continue;
+                    }
+                    pOut[0] = Unpremultiply(pIn[0], alpha);
+                    pOut[1] = Unpremultiply(pIn[1], alpha);
+                    pOut[2] = Unpremultiply(pIn[2], alpha);
+                    pOut[3] = alpha;
+                }
+            }
+
+            void RgbaToPremultipliedBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                for (std::size_t pixel = 0; pixel < count; ++pixel)
+                {
+                    const uint8_t* const pIn{ pSource + pixel * 4 };
+                    uint8_t* const pOut{ pDestination + pixel * 4 };
+                    const uint8_t red{ pIn[0] };
+                    const uint8_t green{ pIn[1] };
+                    const uint8_t blue{ pIn[2] };
+                    const uint8_t alpha{ pIn[3] };
+                    pOut[0] = Premultiply(blue, alpha);
+                    pOut[1] = Premultiply(green, alpha);
+                    pOut[2] = Premultiply(red, alpha);
+                    pOut[3] = alpha;
+                }
+            }
+
+            void RgbToBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                for (std::size_t pixel = 0; pixel < count; ++pixel)
+                {
+                    const uint8_t* const pIn{ pSource + pixel * 3 };
+                    uint8_t* const pOut{ pDestination + pixel * 4 };
+                    pOut[0] = pIn[2];
+                    pOut[1] = pIn[1];
+                    pOut[2] = pIn[0];
+                    pOut[3] = 255;
+                }
+            }
+
+            void GrayToBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                for (std::size_t pixel = 0; pixel < count; ++pixel)
+                {
+                    uint8_t* const pOut{ pDestination + pixel * 4 };
+                    pOut[0] = pOut[1] = pOut[2] = pSource[pixel];
+                    pOut[3] = 255;
+                }
+            }
+
+            void GrayAlphaToPremultipliedBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                for (std::size_t pixel = 0; pixel < count; ++pixel)
+                {
+                    const uint8_t alpha{ pSource[pixel * 2 + 1] };
+                    uint8_t* const pOut{ pDestination + pixel * 4 };
+                    pOut[0] = pOut[1] = pOut[2] = Premultiply(pSource[pixel * 2], alpha);
+                    pOut[3] = alpha;
+                }
+            }
+
+            void ColorKeyToAlpha(uint8_t* pPixels, std::size_t count, uint32_t keyColor)
+            {
+                keyColor &= 0x00FFFFFF;
+                for (std::size_t pixel = 0; pixel < count; ++pixel)
+                {
+                    uint32_t value{};
+                    std::memcpy(&value, pPixels + pixel * 4, sizeof(value));
+                    if ((value & 0x00FFFFFF) == keyColor) std::memset(pPixels + pixel * 4, 0, 4);
+                }
+            }
+
+            void ToFloat(const uint8_t* pSource, float* pDestination, std::size_t count)
+            {
+                for (std::size_t index = 0; index < count; ++index) pDestination[index] = static_cast<float>(pSource[index]) * byteToFloat;
+            }
+
+            void FromFloat(const float* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                for (std::size_t index = 0; index < count; ++index)
+                {
+                    // Written so NaN fails the first comparison
+                    float value{ pSource[index] > 0.f ? pSource[index] : 0.f };
+                    value = value < 1.f ? value : 1.f;
+                    pDestination[index] = static_cast<uint8_t>(std::nearbyint(value * 255.f));
+                }
+            }
+
+            constexpr Kernels kernels{
+                SimdLevel::Scalar, &SwapRedBlue, &Premultiply, &Unpremultiply, &RgbaToPremultipliedBgra,
+                &RgbToBgra, &GrayToBgra, &GrayAlphaToPremultipliedBgra, &ColorKeyToAlpha, &ToFloat, &FromFloat
+            };
+        }
+
+#if defined(JELA_SIMD_SSE2)
+        // Shuffle indices with the top bit set make pshufb write 0
+        constexpr char zeroByte{ -128 };
+
+        //---------------------
+        // SSE4.1 kernels, 4 pixels or 16 values at a time. Also need SSSE3 for pshufb.
+        //---------------------
+
+        namespace sse41
+        {
+            // 16 bit lanes, (value + 128 + ((value + 128) >> 8)) >> 8 is value / 255 rounded to nearest
+            JELA_TARGET_SSE41 __m128i MultiplyDivide255(__m128i color, __m128i alpha)
+            {
+                const __m128i product{ _mm_add_epi16(_mm_mullo_epi16(color, alpha), _mm_set1_epi16(128)) };
+                return _mm_srli_epi16(_mm_add_epi16(product, _mm_srli_epi16(product, 8)), 8);
+            }
+
+            // Any 4 pixels with alpha in the last byte
+            JELA_TARGET_SSE41 __m128i PremultiplyPixels(__m128i pixels)
+            {
+                // Each pixel's alpha in its three color lanes, 255 in its alpha lane so that stays the same
+                const __m128i lowAlpha{ _mm_setr_epi8(3, zeroByte, 3, zeroByte, 3, zeroByte, zeroByte, zeroByte,
+                                                      7, zeroByte, 7, zeroByte, 7, zeroByte, zeroByte, zeroByte) };
+                const __m128i highAlpha{ _mm_setr_epi8(11, zeroByte, 11, zeroByte, 11, zeroByte, zeroByte, zeroByte,
+                                                       15, zeroByte, 15, zeroByte, 15, zeroByte, zeroByte, zeroByte) };
+                const __m128i opaque{ _mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255) };
+
+                const __m128i low{ MultiplyDivide255(_mm_cvtepu8_epi16(pixels), _mm_or_si128(_mm_shuffle_epi8(pixels, lowAlpha), opaque)) };
+                const __m128i high{ MultiplyDivide255(_mm_unpackhi_epi8(pixels, _mm_setzero_si128()),
+                                                      _mm_or_si128(_mm_shuffle_epi8(pixels, highAlpha), opaque)) };
+                return _mm_packus_epi16(low, high);
+            }
+
+            JELA_TARGET_SSE41 __m128i SwapRedBluePixels(__m128i pixels)
+            {
+                return _mm_shuffle_epi8(pixels, _mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15));
+            }
+
+            JELA_TARGET_SSE41 __m128i Load(const uint8_t* pSource)
+            {
+                return _mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource));
+            }
+
+            JELA_TARGET_SSE41 void Store(uint8_t* pDestination, __m128i value)
+            {
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pDestination), value);
+            }
+
+            JELA_TARGET_SSE41 void SwapRedBlue(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 4 <= count; pixel += 4) Store(pDestination + pixel * 4, SwapRedBluePixels(Load(pSource + pixel * 4)));
+                scalar::SwapRedBlue(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_SSE41 void Premultiply(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 4 <= count; pixel += 4) Store(pDestination + pixel * 4, PremultiplyPixels(Load(pSource + pixel * 4)));
+                scalar::Premultiply(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            // One pixel in 4 float lanes
+            JELA_TARGET_SSE41 __m128i UnpremultiplyPixel(__m128i pixel)
+            {
+                const __m128 channels{ _mm_cvtepi32_ps(pixel) };
+                const __m128 alpha{ _mm_shuffle_ps(channels, channels, _MM_SHUFFLE(3, 3, 3, 3)) };
+                const __m128 colors{ _mm_min_ps(_mm_div_ps(_mm_mul_ps(channels, _mm_set1_ps(255.f)), alpha), _mm_set1_ps(255.f)) };
+
+                // Alpha keeps its value, and pixels with an alpha of 0 become 0
+                const __m128i result{ _mm_blend_epi16(_mm_cvttps_epi32(_mm_add_ps(colors, _mm_set1_ps(0.5f))), pixel, 0xC0) };
+                const __m128i isTransparent{ _mm_cmpeq_epi32(_mm_shuffle_epi32(pixel, _MM_SHUFFLE(3, 3, 3, 3)), _mm_setzero_si128()) };
+                return _mm_andnot_si128(isTransparent, result);
+            }
+
+            JELA_TARGET_SSE41 void Unpremultiply(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 4 <= count; pixel += 4)
+                {
+                    const __m128i pixels{ Load(pSource + pixel * 4) };
+                    const __m128i first{ UnpremultiplyPixel(_mm_cvtepu8_epi32(pixels)) };
+                    const __m128i second{ UnpremultiplyPixel(_mm_cvtepu8_epi32(_mm_srli_si128(pixels, 4))) };
+                    const __m128i third{ UnpremultiplyPixel(_mm_cvtepu8_epi32(_mm_srli_si128(pixels, 8))) };
+                    const __m128i fourth{ UnpremultiplyPixel(_mm_cvtepu8_epi32(_mm_srli_si128(pixels, 12))) };
+                    Store(pDestination + pixel * 4, _mm_packus_epi16(_mm_packus_epi32(first, second), _mm_packus_epi32(third, fourth)));
+                }
+                scalar::Unpremultiply(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_SSE41 void RgbaToPremultipliedBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 4 <= count; pixel += 4)
+                    Store(pDestination + pixel * 4, PremultiplyPixels(SwapRedBluePixels(Load(pSource + pixel * 4))));
+                scalar::RgbaToPremultipliedBgra(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_SSE41 void RgbToBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                const __m128i spread{ _mm_setr_epi8(2, 1, 0, zeroByte, 5, 4, 3, zeroByte, 8, 7, 6, zeroByte, 11, 10, 9, zeroByte) };
+                const __m128i opaque{ _mm_set1_epi32(static_cast<int>(0xFF000000)) };
+
+                // Takes 12 of the 16 bytes it loads, so it stops while 16 bytes are left to read
+                std::size_t pixel{};
+                for (; pixel + 6 <= count; pixel += 4)
+                    Store(pDestination + pixel * 4, _mm_or_si128(_mm_shuffle_epi8(Load(pSource + pixel * 3), spread), opaque));
+                scalar::RgbToBgra(pSource + pixel * 3, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_SSE41 void GrayToBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                const __m128i opaque{ _mm_set1_epi32(static_cast<int>(0xFF000000)) };
+                const __m128i spread0{ _mm_setr_epi8(0, 0, 0, zeroByte, 1, 1, 1, zeroByte, 2, 2, 2, zeroByte, 3, 3, 3, zeroByte) };
+                const __m128i spread1{ _mm_add_epi8(spread0, _mm_set1_epi8(4)) };
+                const __m128i spread2{ _mm_add_epi8(spread1, _mm_set1_epi8(4)) };
+                const __m128i spread3{ _mm_add_epi8(spread2, _mm_set1_epi8(4)) };
+
+                std::size_t pixel{};
+                for (; pixel + 16 <= count; pixel += 16)
+                {
+                    const __m128i gray{ Load(pSource + pixel) };
+                    uint8_t* const pOut{ pDestination + pixel * 4 };
+                    // Adding 4 keeps the top bit of the zeroing indices set
+                    Store(pOut, _mm_or_si128(_mm_shuffle_epi8(gray, spread0), opaque));
+                    Store(pOut + 16, _mm_or_si128(_mm_shuffle_epi8(gray, spread1), opaque));
+                    Store(pOut + 32, _mm_or_si128(_mm_shuffle_epi8(gray, spread2), opaque));
+                    Store(pOut + 48, _mm_or_si128(_mm_shuffle_epi8(gray, spread3), opaque));
+                }
+                scalar::GrayToBgra(pSource + pixel, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_SSE41 void GrayAlphaToPremultipliedBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                const __m128i spreadLow{ _mm_setr_epi8(0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7) };
+                const __m128i spreadHigh{ _mm_setr_epi8(8, 8, 8, 9, 10, 10, 10, 11, 12, 12, 12, 13, 14, 14, 14, 15) };
+
+                std::size_t pixel{};
+                for (; pixel + 8 <= count; pixel += 8)
+                {
+                    const __m128i grayAlpha{ Load(pSource + pixel * 2) };
+                    Store(pDestination + pixel * 4, PremultiplyPixels(_mm_shuffle_epi8(grayAlpha, spreadLow)));
+                    Store(pDestination + pixel * 4 + 16, PremultiplyPixels(_mm_shuffle_epi8(grayAlpha, spreadHigh)));
+                }
+                scalar::GrayAlphaToPremultipliedBgra(pSource + pixel * 2, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_SSE41 void ColorKeyToAlpha(uint8_t* pPixels, std::size_t count, uint32_t keyColor)
+            {
+                const __m128i colorMask{ _mm_set1_epi32(0x00FFFFFF) };
+                const __m128i key{ _mm_set1_epi32(static_cast<int>(keyColor & 0x00FFFFFF)) };
+
+                std::size_t pixel{};
+                for (; pixel + 4 <= count; pixel += 4)
+                {
+                    const __m128i pixels{ Load(pPixels + pixel * 4) };
+                    const __m128i isKey{ _mm_cmpeq_epi32(_mm_and_si128(pixels, colorMask), key) };
+                    Store(pPixels + pixel * 4, _mm_andnot_si128(isKey, pixels));
+                }
+                scalar::ColorKeyToAlpha(pPixels + pixel * 4, count - pixel, keyColor);
+            }
+
+            JELA_TARGET_SSE41 void ToFloat(const uint8_t* pSource, float* pDestination, std::size_t count)
+            {
+                const __m128 scale{ _mm_set1_ps(byteToFloat) };
+
+                std::size_t index{};
+                for (; index + 16 <= count; index += 16)
+                {
+                    const __m128i bytes{ Load(pSource + index) };
+                    for (int part = 0; part < 4; ++part)
+                    {
+                        // The shift needs an immediate, so each part shifts the bytes down once more
+                        const __m128i shifted{ part == 0 ? bytes : part == 1 ? _mm_srli_si128(bytes, 4) : part == 2 ? _mm_srli_si128(bytes, 8) : _mm_srli_si128(bytes, 12) };
+                        _mm_storeu_ps(pDestination + index + part * 4, _mm_mul_ps(_mm_cvtepi32_ps(_mm_cvtepu8_epi32(shifted)), scale));
+                    }
+                }
+                scalar::ToFloat(pSource + index, pDestination + index, count - index);
+            }
+
+            JELA_TARGET_SSE41 __m128i FromFloatValues(const float* pSource)
+            {
+                // max_ps returns its second operand when the first is NaN
+                const __m128 clamped{ _mm_min_ps(_mm_max_ps(_mm_loadu_ps(pSource), _mm_setzero_ps()), _mm_set1_ps(1.f)) };
+                return _mm_cvtps_epi32(_mm_mul_ps(clamped, _mm_set1_ps(255.f)));
+            }
+
+            JELA_TARGET_SSE41 void FromFloat(const float* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t index{};
+                for (; index + 16 <= count; index += 16)
+                {
+                    const __m128i low{ _mm_packus_epi32(FromFloatValues(pSource + index), FromFloatValues(pSource + index + 4)) };
+                    const __m128i high{ _mm_packus_epi32(FromFloatValues(pSource + index + 8), FromFloatValues(pSource + index + 12)) };
+                    Store(pDestination + index, _mm_packus_epi16(low, high));
+                }
+                scalar::FromFloat(pSource + index, pDestination + index, count - index);
+            }
+
+            constexpr Kernels kernels{
+                SimdLevel::Sse41, &SwapRedBlue, &Premultiply, &Unpremultiply, &RgbaToPremultipliedBgra,
+                &RgbToBgra, &GrayToBgra, &GrayAlphaToPremultipliedBgra, &ColorKeyToAlpha, &ToFloat, &FromFloat
+            };
+        }
+
+        //---------------------
+        // AVX2 kernels, 8 pixels or 32 values at a time.
+        // Most shuffles and packs stay within each 128 bit half, which decides how the data is laid out.
+        //---------------------
+
+        namespace avx2
+        {
+            JELA_TARGET_AVX2 __m256i Load(const uint8_t* pSource)
+            {
+                return _mm256_loadu_si256(reinterpret_cast<const __m256i*>(pSource));
+            }
+
+            JELA_TARGET_AVX2 void Store(uint8_t* pDestination, __m256i value)
+            {
+                _mm256_storeu_si256(reinterpret_cast<__m256i*>(pDestination), value);
+            }
+
+            // The same 16 byte shuffle in both halves
+            JELA_TARGET_AVX2 __m256i Broadcast(__m128i value)
+            {
+                return _mm256_broadcastsi128_si256(value);
+            }
+
+            JELA_TARGET_AVX2 __m256i MultiplyDivide255(__m256i color, __m256i alpha)
+            {
+                const __m256i product{ _mm256_add_epi16(_mm256_mullo_epi16(color, alpha), _mm256_set1_epi16(128)) };
+                return _mm256_srli_epi16(_mm256_add_epi16(product, _mm256_srli_epi16(product, 8)), 8);
+            }
+
+            JELA_TARGET_AVX2 __m256i PremultiplyPixels(__m256i pixels)
+            {
+                const __m256i lowAlpha{ Broadcast(_mm_setr_epi8(3, zeroByte, 3, zeroByte, 3, zeroByte, zeroByte, zeroByte,
+                                                                7, zeroByte, 7, zeroByte, 7, zeroByte, zeroByte, zeroByte)) };
+                const __m256i highAlpha{ Broadcast(_mm_setr_epi8(11, zeroByte, 11, zeroByte, 11, zeroByte, zeroByte, zeroByte,
+                                                                 15, zeroByte, 15, zeroByte, 15, zeroByte, zeroByte, zeroByte)) };
+                const __m256i opaque{ Broadcast(_mm_setr_epi16(0, 0, 0, 255, 0, 0, 0, 255)) };
+                const __m256i zero{ _mm256_setzero_si256() };
+
+                const __m256i low{ MultiplyDivide255(_mm256_unpacklo_epi8(pixels, zero), _mm256_or_si256(_mm256_shuffle_epi8(pixels, lowAlpha), opaque)) };
+                const __m256i high{ MultiplyDivide255(_mm256_unpackhi_epi8(pixels, zero), _mm256_or_si256(_mm256_shuffle_epi8(pixels, highAlpha), opaque)) };
+                return _mm256_packus_epi16(low, high);
+            }
+
+            JELA_TARGET_AVX2 __m256i SwapRedBluePixels(__m256i pixels)
+            {
+                return _mm256_shuffle_epi8(pixels, Broadcast(_mm_setr_epi8(2, 1, 0, 3, 6, 5, 4, 7, 10, 9, 8, 11, 14, 13, 12, 15)));
+            }
+
+            // Packing works per half, this puts 32 bit elements 0 4 1 5 2 6 3 7 back in order
+            JELA_TARGET_AVX2 __m256i InterleaveHalves(__m256i value)
+            {
+                return _mm256_permutevar8x32_epi32(value, _mm256_setr_epi32(0, 4, 1, 5, 2, 6, 3, 7));
+            }
+
+            JELA_TARGET_AVX2 void SwapRedBlue(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 8 <= count; pixel += 8) Store(pDestination + pixel * 4, SwapRedBluePixels(Load(pSource + pixel * 4)));
+                sse41::SwapRedBlue(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_AVX2 void Premultiply(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 8 <= count; pixel += 8) Store(pDestination + pixel * 4, PremultiplyPixels(Load(pSource + pixel * 4)));
+                sse41::Premultiply(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            // Two pixels, one in each half
+            JELA_TARGET_AVX2 __m256i UnpremultiplyPixels(__m256i pixels)
+            {
+                const __m256 channels{ _mm256_cvtepi32_ps(pixels) };
+                const __m256 alpha{ _mm256_shuffle_ps(channels, channels, _MM_SHUFFLE(3, 3, 3, 3)) };
+                const __m256 colors{ _mm256_min_ps(_mm256_div_ps(_mm256_mul_ps(channels, _mm256_set1_ps(255.f)), alpha), _mm256_set1_ps(255.f)) };
+
+                const __m256i result{ _mm256_blend_epi32(_mm256_cvttps_epi32(_mm256_add_ps(colors, _mm256_set1_ps(0.5f))), pixels, 0x88) };
+                const __m256i isTransparent{ _mm256_cmpeq_epi32(_mm256_shuffle_epi32(pixels, _MM_SHUFFLE(3, 3, 3, 3)), _mm256_setzero_si256()) };
+                return _mm256_andnot_si256(isTransparent, result);
+            }
+
+            JELA_TARGET_AVX2 __m256i LoadWidened(const uint8_t* pSource)
+            {
+                return _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(pSource)));
+            }
+
+            JELA_TARGET_AVX2 void Unpremultiply(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 8 <= count; pixel += 8)
+                {
+                    const uint8_t* const pIn{ pSource + pixel * 4 };
+                    const __m256i first{ UnpremultiplyPixels(LoadWidened(pIn)) };
+                    const __m256i second{ UnpremultiplyPixels(LoadWidened(pIn + 8)) };
+                    const __m256i third{ UnpremultiplyPixels(LoadWidened(pIn + 16)) };
+                    const __m256i fourth{ UnpremultiplyPixels(LoadWidened(pIn + 24)) };
+                    const __m256i packed{ _mm256_packus_epi16(_mm256_packus_epi32(first, second), _mm256_packus_epi32(third, fourth)) };
+                    Store(pDestination + pixel * 4, InterleaveHalves(packed));
+                }
+                sse41::Unpremultiply(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_AVX2 void RgbaToPremultipliedBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 8 <= count; pixel += 8)
+                    Store(pDestination + pixel * 4, PremultiplyPixels(SwapRedBluePixels(Load(pSource + pixel * 4))));
+                sse41::RgbaToPremultipliedBgra(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_AVX2 void RgbToBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                // Bytes 0 to 15 to the low half and 12 to 27 to the high one, each then holds 4 whole pixels
+                const __m256i split{ _mm256_setr_epi32(0, 1, 2, 3, 3, 4, 5, 6) };
+                const __m256i spread{ Broadcast(_mm_setr_epi8(2, 1, 0, zeroByte, 5, 4, 3, zeroByte, 8, 7, 6, zeroByte, 11, 10, 9, zeroByte)) };
+                const __m256i opaque{ _mm256_set1_epi32(static_cast<int>(0xFF000000)) };
+
+                // Takes 24 of the 32 bytes it loads
+                std::size_t pixel{};
+                for (; pixel + 11 <= count; pixel += 8)
+                {
+                    const __m256i rgb{ _mm256_permutevar8x32_epi32(Load(pSource + pixel * 3), split) };
+                    Store(pDestination + pixel * 4, _mm256_or_si256(_mm256_shuffle_epi8(rgb, spread), opaque));
+                }
+                sse41::RgbToBgra(pSource + pixel * 3, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_AVX2 void GrayToBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                const __m256i opaque{ _mm256_set1_epi32(static_cast<int>(0xFF000000)) };
+                // 16 gray values in both halves, each shuffle spreads 4 of them over one half
+                const __m256i spread0{ _mm256_setr_epi8(0, 0, 0, zeroByte, 1, 1, 1, zeroByte, 2, 2, 2, zeroByte, 3, 3, 3, zeroByte,
+                                                        4, 4, 4, zeroByte, 5, 5, 5, zeroByte, 6, 6, 6, zeroByte, 7, 7, 7, zeroByte) };
+                const __m256i spread1{ _mm256_add_epi8(spread0, _mm256_set1_epi8(8)) };
+
+                std::size_t pixel{};
+                for (; pixel + 16 <= count; pixel += 16)
+                {
+                    const __m256i gray{ Broadcast(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + pixel))) };
+                    uint8_t* const pOut{ pDestination + pixel * 4 };
+                    Store(pOut, _mm256_or_si256(_mm256_shuffle_epi8(gray, spread0), opaque));
+                    Store(pOut + 32, _mm256_or_si256(_mm256_shuffle_epi8(gray, spread1), opaque));
+                }
+                sse41::GrayToBgra(pSource + pixel, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_AVX2 void GrayAlphaToPremultipliedBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                const __m256i spread{ _mm256_setr_epi8(0, 0, 0, 1, 2, 2, 2, 3, 4, 4, 4, 5, 6, 6, 6, 7,
+                                                       8, 8, 8, 9, 10, 10, 10, 11, 12, 12, 12, 13, 14, 14, 14, 15) };
+
+                std::size_t pixel{};
+                for (; pixel + 8 <= count; pixel += 8)
+                {
+                    const __m256i grayAlpha{ Broadcast(_mm_loadu_si128(reinterpret_cast<const __m128i*>(pSource + pixel * 2))) };
+                    Store(pDestination + pixel * 4, PremultiplyPixels(_mm256_shuffle_epi8(grayAlpha, spread)));
+                }
+                sse41::GrayAlphaToPremultipliedBgra(pSource + pixel * 2, pDestination + pixel * 4, count - pixel);
+            }
+
+            JELA_TARGET_AVX2 void ColorKeyToAlpha(uint8_t* pPixels, std::size_t count, uint32_t keyColor)
+            {
+                const __m256i colorMask{ _mm256_set1_epi32(0x00FFFFFF) };
+                const __m256i key{ _mm256_set1_epi32(static_cast<int>(keyColor & 0x00FFFFFF)) };
+
+                std::size_t pixel{};
+                for (; pixel + 8 <= count; pixel += 8)
+                {
+                    const __m256i pixels{ Load(pPixels + pixel * 4) };
+                    const __m256i isKey{ _mm256_cmpeq_epi32(_mm256_and_si256(pixels, colorMask), key) };
+                    Store(pPixels + pixel * 4, _mm256_andnot_si256(isKey, pixels));
+                }
+                sse41::ColorKeyToAlpha(pPixels + pixel * 4, count - pixel, keyColor);
+            }
+
+            JELA_TARGET_AVX2 void ToFloat(const uint8_t* pSource, float* pDestination, std::size_t count)
+            {
+                const __m256 scale{ _mm256_set1_ps(byteToFloat) };
+
+                std::size_t index{};
+                for (; index + 8 <= count; index += 8)
+                    _mm256_storeu_ps(pDestination + index, _mm256_mul_ps(_mm256_cvtepi32_ps(LoadWidened(pSource + index)), scale));
+                sse41::ToFloat(pSource + index, pDestination + index, count - index);
+            }
+
+            JELA_TARGET_AVX2 __m256i FromFloatValues(const float* pSource)
+            {
+                const __m256 clamped{ _mm256_min_ps(_mm256_max_ps(_mm256_loadu_ps(pSource), _mm256_setzero_ps()), _mm256_set1_ps(1.f)) };
+                return _mm256_cvtps_epi32(_mm256_mul_ps(clamped, _mm256_set1_ps(255.f)));
+            }
+
+            JELA_TARGET_AVX2 void FromFloat(const float* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t index{};
+                for (; index + 32 <= count; index += 32)
+                {
+                    const __m256i low{ _mm256_packus_epi32(FromFloatValues(pSource + index), FromFloatValues(pSource + index + 8)) };
+                    const __m256i high{ _mm256_packus_epi32(FromFloatValues(pSource + index + 16), FromFloatValues(pSource + index + 24)) };
+                    Store(pDestination + index, InterleaveHalves(_mm256_packus_epi16(low, high)));
+                }
+                sse41::FromFloat(pSource + index, pDestination + index, count - index);
+            }
+
+            constexpr Kernels kernels{
+                SimdLevel::Avx2, &SwapRedBlue, &Premultiply, &Unpremultiply, &RgbaToPremultipliedBgra,
+                &RgbToBgra, &GrayToBgra, &GrayAlphaToPremultipliedBgra, &ColorKeyToAlpha, &ToFloat, &FromFloat
+            };
+        }
+#endif // JELA_SIMD_SSE2
+
+#if defined(JELA_SIMD_NEON)
+        //---------------------
+        // NEON kernels, 16 pixels or values at a time. The interleaving loads and stores split the channels into registers of their own.
+        //---------------------
+
+        namespace neon
+        {
+            // (product + 128 + ((product + 128) >> 8)) >> 8, the rounding shifts add the 128s
+            uint8x16_t Premultiply(uint8x16_t color, uint8x16_t alpha)
+            {
+                const uint16x8_t low{ vmull_u8(vget_low_u8(color), vget_low_u8(alpha)) };
+                const uint16x8_t high{ vmull_high_u8(color, alpha) };
+                return vcombine_u8(vraddhn_u16(low, vrshrq_n_u16(low, 8)), vraddhn_u16(high, vrshrq_n_u16(high, 8)));
+            }
+
+            void SwapRedBlue(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 16 <= count; pixel += 16)
+                {
+                    uint8x16x4_t pixels{ vld4q_u8(pSource + pixel * 4) };
+                    std::swap(pixels.val[0], pixels.val[2]);
+                    vst4q_u8(pDestination + pixel * 4, pixels);
+                }
+                scalar::SwapRedBlue(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            void Premultiply(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 16 <= count; pixel += 16)
+                {
+                    uint8x16x4_t pixels{ vld4q_u8(pSource + pixel * 4) };
+                    for (int channel = 0; channel < 3; ++channel) pixels.val[channel] = Premultiply(pixels.val[channel], pixels.val[3]);
+                    vst4q_u8(pDestination + pixel * 4, pixels);
+                }
+                scalar::Premultiply(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            // 4 values of one channel
+            uint32x4_t UnpremultiplyValues(uint16x4_t color, uint16x4_t alpha)
+            {
+                const float32x4_t colors{ vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(color)), 255.f) };
+                const float32x4_t divided{ vminq_f32(vdivq_f32(colors, vcvtq_f32_u32(vmovl_u16(alpha))), vdupq_n_f32(255.f)) };
+                return vcvtq_u32_f32(vaddq_f32(divided, vdupq_n_f32(0.5f)));
+            }
+
+            uint8x16_t UnpremultiplyChannel(uint8x16_t color, uint8x16_t alpha)
+            {
+                const uint16x8_t colorLow{ vmovl_u8(vget_low_u8(color)) };
+                const uint16x8_t colorHigh{ vmovl_high_u8(color) };
+                const uint16x8_t alphaLow{ vmovl_u8(vget_low_u8(alpha)) };
+                const uint16x8_t alphaHigh{ vmovl_high_u8(alpha) };
+
+                const uint16x8_t low{ vcombine_u16(vmovn_u32(UnpremultiplyValues(vget_low_u16(colorLow), vget_low_u16(alphaLow))),
+                                                   vmovn_u32(UnpremultiplyValues(vget_high_u16(colorLow), vget_high_u16(alphaLow)))) };
+                const uint16x8_t high{ vcombine_u16(vmovn_u32(UnpremultiplyValues(vget_low_u16(colorHigh), vget_low_u16(alphaHigh))),
+                                                    vmovn_u32(UnpremultiplyValues(vget_high_u16(colorHigh), vget_high_u16(alphaHigh)))) };
+                return vcombine_u8(vmovn_u16(low), vmovn_u16(high));
+            }
+
+            void Unpremultiply(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 16 <= count; pixel += 16)
+                {
+                    uint8x16x4_t pixels{ vld4q_u8(pSource + pixel * 4) };
+                    // Dividing by an alpha of 0 gives garbage, those pixels become 0
+                    const uint8x16_t isTransparent{ vceqq_u8(pixels.val[3], vdupq_n_u8(0)) };
+                    for (int channel = 0; channel < 3; ++channel)
+                        pixels.val[channel] = vbicq_u8(UnpremultiplyChannel(pixels.val[channel], pixels.val[3]), isTransparent);
+                    vst4q_u8(pDestination + pixel * 4, pixels);
+                }
+                scalar::Unpremultiply(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            void RgbaToPremultipliedBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 16 <= count; pixel += 16)
+                {
+                    const uint8x16x4_t rgba{ vld4q_u8(pSource + pixel * 4) };
+                    const uint8x16x4_t bgra{ { Premultiply(rgba.val[2], rgba.val[3]), Premultiply(rgba.val[1], rgba.val[3]),
+                                               Premultiply(rgba.val[0], rgba.val[3]), rgba.val[3] } };
+                    vst4q_u8(pDestination + pixel * 4, bgra);
+                }
+                scalar::RgbaToPremultipliedBgra(pSource + pixel * 4, pDestination + pixel * 4, count - pixel);
+            }
+
+            void RgbToBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 16 <= count; pixel += 16)
+                {
+                    const uint8x16x3_t rgb{ vld3q_u8(pSource + pixel * 3) };
+                    const uint8x16x4_t bgra{ { rgb.val[2], rgb.val[1], rgb.val[0], vdupq_n_u8(255) } };
+                    vst4q_u8(pDestination + pixel * 4, bgra);
+                }
+                scalar::RgbToBgra(pSource + pixel * 3, pDestination + pixel * 4, count - pixel);
+            }
+
+            void GrayToBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 16 <= count; pixel += 16)
+                {
+                    const uint8x16_t gray{ vld1q_u8(pSource + pixel) };
+                    const uint8x16x4_t bgra{ { gray, gray, gray, vdupq_n_u8(255) } };
+                    vst4q_u8(pDestination + pixel * 4, bgra);
+                }
+                scalar::GrayToBgra(pSource + pixel, pDestination + pixel * 4, count - pixel);
+            }
+
+            void GrayAlphaToPremultipliedBgra(const uint8_t* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t pixel{};
+                for (; pixel + 16 <= count; pixel += 16)
+                {
+                    const uint8x16x2_t grayAlpha{ vld2q_u8(pSource + pixel * 2) };
+                    const uint8x16_t gray{ Premultiply(grayAlpha.val[0], grayAlpha.val[1]) };
+                    const uint8x16x4_t bgra{ { gray, gray, gray, grayAlpha.val[1] } };
+                    vst4q_u8(pDestination + pixel * 4, bgra);
+                }
+                scalar::GrayAlphaToPremultipliedBgra(pSource + pixel * 2, pDestination + pixel * 4, count - pixel);
+            }
+
+            void ColorKeyToAlpha(uint8_t* pPixels, std::size_t count, uint32_t keyColor)
+            {
+                std::size_t pixel{};
+                for (; pixel + 16 <= count; pixel += 16)
+                {
+                    uint8x16x4_t pixels{ vld4q_u8(pPixels + pixel * 4) };
+                    uint8x16_t isKey{ vceqq_u8(pixels.val[0], vdupq_n_u8(static_cast<uint8_t>(keyColor))) };
+                    isKey = vandq_u8(isKey, vceqq_u8(pixels.val[1], vdupq_n_u8(static_cast<uint8_t>(keyColor >> 8))));
+                    isKey = vandq_u8(isKey, vceqq_u8(pixels.val[2], vdupq_n_u8(static_cast<uint8_t>(keyColor >> 16))));
+                    for (int channel = 0; channel < 4; ++channel) pixels.val[channel] = vbicq_u8(pixels.val[channel], isKey);
+                    vst4q_u8(pPixels + pixel * 4, pixels);
+                }
+                scalar::ColorKeyToAlpha(pPixels + pixel * 4, count - pixel, keyColor);
+            }
+
+            void ToFloat(const uint8_t* pSource, float* pDestination, std::size_t count)
+            {
+                std::size_t index{};
+                for (; index + 16 <= count; index += 16)
+                {
+                    const uint8x16_t bytes{ vld1q_u8(pSource + index) };
+                    const uint16x8_t low{ vmovl_u8(vget_low_u8(bytes)) };
+                    const uint16x8_t high{ vmovl_high_u8(bytes) };
+                    float* const pOut{ pDestination + index };
+                    vst1q_f32(pOut, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(low))), byteToFloat));
+                    vst1q_f32(pOut + 4, vmulq_n_f32(vcvtq_f32_u32(vmovl_high_u16(low)), byteToFloat));
+                    vst1q_f32(pOut + 8, vmulq_n_f32(vcvtq_f32_u32(vmovl_u16(vget_low_u16(high))), byteToFloat));
+                    vst1q_f32(pOut + 12, vmulq_n_f32(vcvtq_f32_u32(vmovl_high_u16(high)), byteToFloat));
+                }
+                scalar::ToFloat(pSource + index, pDestination + index, count - index);
+            }
+
+            uint16x4_t FromFloatValues(const float* pSource)
+            {
+                // maxnm returns the number when the other operand is NaN
+                const float32x4_t clamped{ vminq_f32(vmaxnmq_f32(vld1q_f32(pSource), vdupq_n_f32(0.f)), vdupq_n_f32(1.f)) };
+                return vmovn_u32(vcvtnq_u32_f32(vmulq_n_f32(clamped, 255.f)));
+            }
+
+            void FromFloat(const float* pSource, uint8_t* pDestination, std::size_t count)
+            {
+                std::size_t index{};
+                for (; index + 16 <= count; index += 16)
+                {
+                    const uint16x8_t low{ vcombine_u16(FromFloatValues(pSource + index), FromFloatValues(pSource + index + 4)) };
+                    const uint16x8_t high{ vcombine_u16(FromFloatValues(pSource + index + 8), FromFloatValues(pSource + index + 12)) };
+                    vst1q_u8(pDestination + index, vcombine_u8(vmovn_u16(low), vmovn_u16(high)));
+                }
+                scalar::FromFloat(pSource + index, pDestination + index, count - index);
+            }
+
+            constexpr Kernels kernels{
+                SimdLevel::Neon, &SwapRedBlue, &Premultiply, &Unpremultiply, &RgbaToPremultipliedBgra,
+                &RgbToBgra, &GrayToBgra, &GrayAlphaToPremultipliedBgra, &ColorKeyToAlpha, &ToFloat, &FromFloat
+            };
+        }
+#endif // JELA_SIMD_NEON
+
+        //---------------------
+        // Dispatch
+        //---------------------
+
+        SimdLevel DetectSimdLevel()
+        {
+#if defined(JELA_SIMD_NEON)
+            // Part of every ARM64 CPU
+            return SimdLevel::Neon;
+#elif defined(JELA_SIMD_SSE2)
+    #if defined(_MSC_VER) && !defined(__clang__)
+            int info[4]{};
+            __cpuid(info, 0);
+            const int maxLeaf{ info[0] };
+
+            __cpuid(info, 1);
+            const bool hasSse41{ (info[2] & (1 << 9)) != 0 && (info[2] & (1 << 19)) != 0 };
+            // AVX also needs the OS to save the 256 bit registers, which XGETBV tells once OSXSAVE is set
+            const bool hasAvx{ (info[2] & (1 << 27)) != 0 && (info[2] & (1 << 28)) != 0 && (_xgetbv(0) & 6) == 6 };
+
+            bool hasAvx2{};
+            if (maxLeaf >= 7)
+            {
+                __cpuidex(info, 7, 0);
+                hasAvx2 = hasAvx && (info[1] & (1 << 5)) != 0;
+            }
+    #else
+            __builtin_cpu_init();
+            const bool hasSse41{ __builtin_cpu_supports("ssse3") && __builtin_cpu_supports("sse4.1") };
+            const bool hasAvx2{ __builtin_cpu_supports("avx2") != 0 };
+    #endif
+            if (hasAvx2 && hasSse41) return SimdLevel::Avx2;
+            if (hasSse41) return SimdLevel::Sse41;
+            return SimdLevel::Scalar;
+#else
+            return SimdLevel::Scalar;
+#endif
+        }
+
+        const Kernels& GetKernelsFor(SimdLevel level)
+        {
+            switch (level)
+            {
+#if defined(JELA_SIMD_SSE2)
+            case SimdLevel::Sse41:
+                return sse41::kernels;
+            case SimdLevel::Avx2:
+                return avx2::kernels;
+#endif
+#if defined(JELA_SIMD_NEON)
+            case SimdLevel::Neon:
+                return neon::kernels;
+#endif
+            default:
+                return scalar::kernels;
+            }
+        }
+
+        std::atomic<const Kernels*>& GetActiveKernelsPointer()
+        {
+            static std::atomic<const Kernels*> pKernels{ &GetKernelsFor(GetSupportedSimdLevel()) };
+            return pKernels;
+        }
+
+        const Kernels& GetActiveKernels()
+        {
+            return *GetActiveKernelsPointer().load(std::memory_order_relaxed);
+        }
+    }
+
+    SimdLevel GetSimdLevel()
+    {
+        return GetActiveKernels().level;
+    }
+
+    SimdLevel GetSupportedSimdLevel()
+    {
+        static const SimdLevel level{ DetectSimdLevel() };
+        return level;
+    }
+
+    bool SetSimdLevel(SimdLevel level)
+    {
+        const SimdLevel supportedLevel{ GetSupportedSimdLevel() };
+        const bool isSupported{ level == SimdLevel::Scalar || level == supportedLevel ||
+                                (level == SimdLevel::Sse41 && supportedLevel == SimdLevel::Avx2) };
+        if (!isSupported) return false;
+
+        GetActiveKernelsPointer().store(&GetKernelsFor(level), std::memory_order_relaxed);
+        return true;
+    }
+
+    const char* GetSimdLevelName(SimdLevel level)
+    {
+        switch (level)
+        {
+        case SimdLevel::Scalar:
+            return "Scalar";
+        case SimdLevel::Sse41:
+            return "SSE4.1";
+        case SimdLevel::Avx2:
+            return "AVX2";
+        case SimdLevel::Neon:
+            return "NEON";
+        }
+        return "Unknown";
+    }
+
+    void SwapRedBlue(std::span<const uint8_t> source, std::span<uint8_t> destination)
+    {
+        assert(destination.size() >= source.size());
+        GetActiveKernels().pSwapRedBlue(source.data(), destination.data(), source.size() / 4);
+    }
+
+    void Premultiply(std::span<const uint8_t> source, std::span<uint8_t> destination)
+    {
+        assert(destination.size() >= source.size());
+        GetActiveKernels().pPremultiply(source.data(), destination.data(), source.size() / 4);
+    }
+
+    void Unpremultiply(std::span<const uint8_t> source, std::span<uint8_t> destination)
+    {
+        assert(destination.size() >= source.size());
+        GetActiveKernels().pUnpremultiply(source.data(), destination.data(), source.size() / 4);
+    }
+
+    void RgbaToPremultipliedBgra(std::span<const uint8_t> source, std::span<uint8_t> destination)
+    {
+        assert(destination.size() >= source.size());
+        GetActiveKernels().pRgbaToPremultipliedBgra(source.data(), destination.data(), source.size() / 4);
+    }
+
+    void RgbToBgra(std::span<const uint8_t> source, std::span<uint8_t> destination)
+    {
+        assert(destination.size() / 4 >= source.size() / 3);
+        GetActiveKernels().pRgbToBgra(source.data(), destination.data(), source.size() / 3);
+    }
+
+    void GrayToBgra(std::span<const uint8_t> source, std::span<uint8_t> destination)
+    {
+        assert(destination.size() / 4 >= source.size());
+        GetActiveKernels().pGrayToBgra(source.data(), destination.data(), source.size());
+    }
+
+    void GrayAlphaToPremultipliedBgra(std::span<const uint8_t> source, std::span<uint8_t> destination)
+    {
+        assert(destination.size() / 4 >= source.size() / 2);
+        GetActiveKernels().pGrayAlphaToPremultipliedBgra(source.data(), destination.data(), source.size() / 2);
+    }
+
+    void ColorKeyToAlpha(std::span<uint8_t> pixels, uint32_t keyColor)
+    {
+        GetActiveKernels().pColorKeyToAlpha(pixels.data(), pixels.size() / 4, keyColor);
+    }
+
+    void ToFloat(std::span<const uint8_t> source, std::span<float> destination)
+    {
+        assert(destination.size() >= source.size());
+        GetActiveKernels().pToFloat(source.data(), destination.data(), source.size());
+    }
+
+    void FromFloat(std::span<const float> source, std::span<uint8_t> destination)
+    {
+        assert(destination.size() >= source.size());
+        GetActiveKernels().pFromFloat(source.data(), destination.data(), source.size());
+    }
+}
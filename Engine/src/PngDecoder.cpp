@@ -0,0 +1,648 @@
+#include "PngDecoder.h"
+#include "FileExceptions.h"
+#include "PixelConvert.h"
+#include "Simd.h"
+#include <algorithm>
+#include <bit>
+#include <cassert>
+#include <cstdlib>
+#include <cstring>
+
+namespace jela
+{
+    static_assert(std::endian::native == std::endian::little, "Pixels are written as little-endian BGRA words.");
+
+    namespace
+    {
+        constexpr std::array<uint8_t, 8> signature{ 0x89, 'P', 'N', 'G', '\r', '\n', 0x1A, '\n' };
+        // Far beyond any texture size, keeps corrupt headers from allocating huge rows and images
+        constexpr uint32_t maxDimension{ 1u << 24 };
+        constexpr uint64_t maxPixelCount{ uint64_t{ 1 } << 28 };
+        // Deflate expands data at most 1032 times: 258 bytes from a length and distance of 2 bits at best
+        constexpr uint64_t maxDeflateRatio{ 1032 };
+
+        constexpr uint32_t MakeChunkType(const char(&name)[5])
+        {
+            return (uint32_t{ static_cast<uint8_t>(name[0]) } << 24) | (uint32_t{ static_cast<uint8_t>(name[1]) } << 16) |
+                   (uint32_t{ static_cast<uint8_t>(name[2]) } << 8) | uint32_t{ static_cast<uint8_t>(name[3]) };
+        }
+
+        constexpr uint32_t headerChunk{ MakeChunkType("IHDR") };
+        constexpr uint32_t paletteChunk{ MakeChunkType("PLTE") };
+        constexpr uint32_t transparencyChunk{ MakeChunkType("tRNS") };
+        constexpr uint32_t dataChunk{ MakeChunkType("IDAT") };
+        constexpr uint32_t endChunk{ MakeChunkType("IEND") };
+
+        struct InterlacePass
+        {
+            uint32_t x;
+            uint32_t y;
+            uint32_t xStep;
+            uint32_t yStep;
+        };
+        constexpr std::array<InterlacePass, 7> adam7Passes{ {
+            { 0, 0, 8, 8 }, { 4, 0, 8, 8 }, { 0, 4, 4, 8 }, { 2, 0, 4, 4 }, { 0, 2, 2, 4 }, { 1, 0, 2, 2 }, { 0, 1, 1, 2 }
+        } };
+
+        enum class FilterType : uint8_t
+        {
+            None,
+            Sub,
+            Up,
+            Average,
+            Paeth
+        };
+
+        [[noreturn]] void ThrowCorrupt(const char* pReason)
+        {
+            throw FileLoadException{ std::format("PNG data is corrupt: {}.\n", pReason) };
+        }
+
+        uint32_t ReadBigEndian32(const uint8_t* pData)
+        {
+            return (uint32_t{ pData[0] } << 24) | (uint32_t{ pData[1] } << 16) | (uint32_t{ pData[2] } << 8) | pData[3];
+        }
+
+        uint16_t ReadBigEndian16(const uint8_t* pData)
+        {
+            return static_cast<uint16_t>((pData[0] << 8) | pData[1]);
+        }
+
+        // Same rounding as libpng's png_set_scale_16
+        uint32_t ScaleTo8Bits(uint32_t value)
+        {
+            return (value * 255 + 32895) >> 16;
+        }
+
+        // color * alpha / 255, rounded to nearest
+        uint32_t Premultiply(uint32_t color, uint32_t alpha)
+        {
+            const uint32_t product{ color * alpha + 128 };
+            return (product + (product >> 8)) >> 8;
+        }
+
+        uint32_t MakePixel(uint32_t red, uint32_t green, uint32_t blue, uint32_t alpha)
+        {
+            return Premultiply(blue, alpha) | (Premultiply(green, alpha) << 8) | (Premultiply(red, alpha) << 16) | (alpha << 24);
+        }
+
+        void StorePixel(uint8_t* pDestination, uint32_t pixel)
+        {
+            std::memcpy(pDestination, &pixel, sizeof(pixel));
+        }
+
+        uint8_t PaethPredictor(int left, int above, int upperLeft)
+        {
+            const int leftDistance{ std::abs(above - upperLeft) };
+            const int aboveDistance{ std::abs(left - upperLeft) };
+            const int upperLeftDistance{ std::abs(left + above - 2 * upperLeft) };
+            if (leftDistance <= aboveDistance && leftDistance <= upperLeftDistance) return static_cast<uint8_t>(left);
+            if (aboveDistance <= upperLeftDistance) return static_cast<uint8_t>(above);
+            return static_cast<uint8_t>(upperLeft);
+        }
+
+#if defined(JELA_SIMD_SSE2)
+        //---------------------
+        // SSE2 filters for 3 and 4 byte pixels, 8 bit RGB and RGBA.
+        // Each pixel depends on the one left of it, so these work on one whole pixel at a time instead of 16 bytes.
+        //---------------------
+
+        // Always loads 4 bytes, 3 byte pixels take the first byte of the next one along; its lane is never stored.
+        // Loading exactly 3 bytes goes through memory and stalls on every pixel.
+        __m128i LoadPixel(const uint8_t* pSource)
+        {
+            uint32_t pixel{};
+            std::memcpy(&pixel, pSource, sizeof(pixel));
+            return _mm_cvtsi32_si128(static_cast<int>(pixel));
+        }
+
+        template <uint32_t stride>
+        void StorePixel(uint8_t* pDestination, __m128i pixel)
+        {
+            const uint32_t value{ static_cast<uint32_t>(_mm_cvtsi128_si32(pixel)) };
+            std::memcpy(pDestination, &value, stride);
+        }
+
+        template <uint32_t stride>
+        void UnfilterSubPixels(uint8_t* pRow, std::size_t size)
+        {
+            __m128i left{ _mm_setzero_si128() };
+            for (std::size_t index = 0; index < size; index += stride)
+            {
+                left = _mm_add_epi8(LoadPixel(pRow + index), left);
+                StorePixel<stride>(pRow + index, left);
+            }
+        }
+
+        template <uint32_t stride>
+        void UnfilterAveragePixels(uint8_t* pRow, const uint8_t* pAbove, std::size_t size)
+        {
+            // avg_epu8 rounds up, the filter rounds down
+            const __m128i one{ _mm_set1_epi8(1) };
+            __m128i left{ _mm_setzero_si128() };
+            for (std::size_t index = 0; index < size; index += stride)
+            {
+                const __m128i above{ LoadPixel(pAbove + index) };
+                const __m128i average{ _mm_sub_epi8(_mm_avg_epu8(left, above), _mm_and_si128(_mm_xor_si128(left, above), one)) };
+                left = _mm_add_epi8(LoadPixel(pRow + index), average);
+                StorePixel<stride>(pRow + index, left);
+            }
+        }
+
+        __m128i Absolute16(__m128i value)
+        {
+            return _mm_max_epi16(value, _mm_sub_epi16(_mm_setzero_si128(), value));
+        }
+
+        __m128i Select(__m128i mask, __m128i ifTrue, __m128i ifFalse)
+        {
+            return _mm_or_si128(_mm_and_si128(mask, ifTrue), _mm_andnot_si128(mask, ifFalse));
+        }
+
+        template <uint32_t stride>
+        void UnfilterPaethPixels(uint8_t* pRow, const uint8_t* pAbove, std::size_t size)
+        {
+            // The distances need 9 bits and a sign, so the channels are widened to 16 bits
+            const __m128i zero{ _mm_setzero_si128() };
+            __m128i left{ zero };
+            __m128i upperLeft{ zero };
+            for (std::size_t index = 0; index < size; index += stride)
+            {
+                const __m128i above{ _mm_unpacklo_epi8(LoadPixel(pAbove + index), zero) };
+
+                const __m128i aboveDelta{ _mm_sub_epi16(above, upperLeft) };
+                const __m128i leftDelta{ _mm_sub_epi16(left, upperLeft) };
+                const __m128i leftDistance{ Absolute16(aboveDelta) };
+                const __m128i aboveDistance{ Absolute16(leftDelta) };
+                const __m128i upperLeftDistance{ Absolute16(_mm_add_epi16(aboveDelta, leftDelta)) };
+
+                // Ties go to left, then above
+                const __m128i smallest{ _mm_min_epi16(upperLeftDistance, _mm_min_epi16(leftDistance, aboveDistance)) };
+                __m128i predictor{ Select(_mm_cmpeq_epi16(aboveDistance, smallest), above, upperLeft) };
+                predictor = Select(_mm_cmpeq_epi16(leftDistance, smallest), left, predictor);
+
+                const __m128i pixel{ _mm_add_epi8(LoadPixel(pRow + index), _mm_packus_epi16(predictor, predictor)) };
+                StorePixel<stride>(pRow + index, pixel);
+
+                left = _mm_unpacklo_epi8(pixel, zero);
+                upperLeft = above;
+            }
+        }
+#endif // JELA_SIMD_SSE2
+
+        //---------------------
+        // Filters for every pixel size, the SSE2 ones take over where they can.
+        // The first stride bytes have no left neighbour, which the filters treat as 0.
+        //---------------------
+
+        void UnfilterSub(uint8_t* pRow, std::size_t size, uint32_t stride)
+        {
+#if defined(JELA_SIMD_SSE2)
+            if (stride == 3) return UnfilterSubPixels<3>(pRow, size);
+            if (stride == 4) return UnfilterSubPixels<4>(pRow, size);
+#endif
+            for (std::size_t index = stride; index < size; ++index) pRow[index] += pRow[index - stride];
+        }
+
+        void UnfilterUp(uint8_t* pRow, const uint8_t* pAbove, std::size_t size)
+        {
+            std::size_t index{};
+#if defined(JELA_SIMD_SSE2)
+            for (; index + 16 <= size; index += 16)
+            {
+                const __m128i row{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pRow + index)) };
+                const __m128i above{ _mm_loadu_si128(reinterpret_cast<const __m128i*>(pAbove + index)) };
+                _mm_storeu_si128(reinterpret_cast<__m128i*>(pRow + index), _mm_add_epi8(row, above));
+            }
+#endif
+            for (; index < size; ++index) pRow[index] += pAbove[index];
+        }
+
+        void UnfilterAverage(uint8_t* pRow, const uint8_t* pAbove, std::size_t size, uint32_t stride)
+        {
+#if defined(JELA_SIMD_SSE2)
+            if (stride == 3) return UnfilterAveragePixels<3>(pRow, pAbove, size);
+            if (stride == 4) return UnfilterAveragePixels<4>(pRow, pAbove, size);
+#endif
+            for (std::size_t index = 0; index < stride; ++index) pRow[index] += pAbove[index] >> 1;
+            for (std::size_t index = stride; index < size; ++index) pRow[index] += static_cast<uint8_t>((pRow[index - stride] + pAbove[index]) >> 1);
+        }
+
+        void UnfilterPaeth(uint8_t* pRow, const uint8_t* pAbove, std::size_t size, uint32_t stride)
+        {
+#if defined(JELA_SIMD_SSE2)
+            if (stride == 3) return UnfilterPaethPixels<3>(pRow, pAbove, size);
+            if (stride == 4) return UnfilterPaethPixels<4>(pRow, pAbove, size);
+#endif
+            for (std::size_t index = 0; index < stride; ++index) pRow[index] += pAbove[index];
+            for (std::size_t index = stride; index < size; ++index)
+                pRow[index] += PaethPredictor(pRow[index - stride], pAbove[index], pAbove[index - stride]);
+        }
+
+        void Unfilter(FilterType filter, uint8_t* pRow, const uint8_t* pAbove, std::size_t size, uint32_t stride)
+        {
+            switch (filter)
+            {
+            case FilterType::None:
+                break;
+            case FilterType::Sub:
+                UnfilterSub(pRow, size, stride);
+                break;
+            case FilterType::Up:
+                UnfilterUp(pRow, pAbove, size);
+                break;
+            case FilterType::Average:
+                UnfilterAverage(pRow, pAbove, size, stride);
+                break;
+            case FilterType::Paeth:
+                UnfilterPaeth(pRow, pAbove, size, stride);
+                break;
+            default:
+                ThrowCorrupt("a row has an invalid filter type");
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------------------
+    //---------------------
+    //PngDecoder
+    //---------------------
+
+    PngDecoder::PngDecoder(std::span<const std::byte> data) :
+        m_Inflater{ std::span<const uint8_t>{} }
+    {
+        const std::span<const uint8_t> bytes{ reinterpret_cast<const uint8_t*>(data.data()), data.size() };
+        if (bytes.size() < signature.size() || !std::equal(signature.begin(), signature.end(), bytes.begin()))
+            throw FileLoadException{ "Data is not a PNG image.\n" };
+
+        std::vector<std::span<const uint8_t>> dataChunks{};
+        bool isEnded{};
+        for (std::size_t position = signature.size(); !isEnded && position < bytes.size();)
+        {
+            // Length, type, data and CRC
+            if (bytes.size() - position < 12) ThrowCorrupt("a chunk is truncated");
+            const uint32_t length{ ReadBigEndian32(bytes.data() + position) };
+            const uint32_t type{ ReadBigEndian32(bytes.data() + position + 4) };
+            if (length > bytes.size() - position - 12) ThrowCorrupt("a chunk is truncated");
+
+            const std::span<const uint8_t> chunk{ bytes.subspan(position + 8, length) };
+            position += 12 + std::size_t{ length };
+
+            if (m_Width == 0 && type != headerChunk) ThrowCorrupt("the header isn't the first chunk");
+
+            switch (type)
+            {
+            case headerChunk:
+                if (m_Width != 0) ThrowCorrupt("there is more than one header");
+                ReadHeader(chunk);
+                break;
+            case paletteChunk:
+                ReadPalette(chunk);
+                break;
+            case transparencyChunk:
+                ReadTransparency(chunk);
+                break;
+            case dataChunk:
+                dataChunks.emplace_back(chunk);
+                break;
+            case endChunk:
+                isEnded = true;
+                break;
+            default:
+                // Ancillary chunks, like gamma and text, have a lowercase first letter and can be skipped
+                if ((type & 0x20000000) == 0)
+                    throw FileLoadException{ std::format("PNG chunk {:08x} is not supported.\n", type) };
+                break;
+            }
+        }
+
+        if (m_Width == 0) ThrowCorrupt("the header is missing");
+        if (dataChunks.empty()) ThrowCorrupt("the image data is missing");
+        if (m_ColorType == ColorType::Palette && m_Palette.empty()) ThrowCorrupt("the palette is missing");
+
+        std::span<const uint8_t> compressedData{ dataChunks.front() };
+        if (dataChunks.size() > 1)
+        {
+            for (const std::span<const uint8_t> chunk : dataChunks) m_JoinedData.insert(m_JoinedData.end(), chunk.begin(), chunk.end());
+            compressedData = m_JoinedData;
+        }
+
+        // zlib header: deflate with a window of at most 32 KiB, no preset dictionary
+        if (compressedData.size() < 2) ThrowCorrupt("the image data is truncated");
+        const uint32_t compressionInfo{ compressedData[0] };
+        const uint32_t flags{ compressedData[1] };
+        if ((compressionInfo & 0x0F) != 8 || (compressionInfo >> 4) > 7 || ((compressionInfo << 8) | flags) % 31 != 0 || (flags & 0x20) != 0)
+            ThrowCorrupt("the image data has an invalid zlib header");
+        m_Inflater = Inflater{ compressedData.subspan(2) };
+
+        // Before anything the size of the image is allocated: a header that claims more pixels than the data can inflate to is corrupt
+        const uint64_t pixelDataSize{ uint64_t{ m_Width } * m_Height * GetRowSize(8) / 8 };
+        if (pixelDataSize > compressedData.size() * maxDeflateRatio) ThrowCorrupt("the image data is too short for the size in the header");
+
+        BuildLookupTable();
+
+        // The filter type byte in front, and room for the SSE2 filters to load one byte past the last pixel
+        const std::size_t rowSize{ 1 + GetRowSize(m_Width) + 1 };
+        m_CurrentRow.assign(rowSize, 0);
+        m_PreviousRow.assign(rowSize, 0);
+    }
+
+    DecodedImage PngDecoder::Decode(std::span<const std::byte> data)
+    {
+        PngDecoder decoder{ data };
+
+        DecodedImage image{ decoder.GetWidth(), decoder.GetHeight() };
+        const std::size_t rowStride{ std::size_t{ image.width } * 4 };
+        image.pixels.resize(rowStride * image.height);
+        decoder.DecodeRows(image.pixels, rowStride, image.height);
+        return image;
+    }
+
+    uint32_t PngDecoder::DecodeRows(std::span<uint8_t> destination, std::size_t rowStride, uint32_t rowCount)
+    {
+        rowCount = std::min(rowCount, m_Height - m_NextRow);
+        if (rowCount == 0) return 0;
+
+        const std::size_t rowSize{ std::size_t{ m_Width } * 4 };
+        assert(rowStride >= rowSize && destination.size() >= (rowCount - 1) * rowStride + rowSize && "Destination is too small for the rows");
+
+        if (m_IsInterlaced)
+        {
+            if (m_InterlacedPixels.empty()) DecodeInterlaced();
+            for (uint32_t row = 0; row < rowCount; ++row)
+                std::memcpy(destination.data() + row * rowStride, m_InterlacedPixels.data() + (m_NextRow + row) * rowSize, rowSize);
+        }
+        else
+        {
+            for (uint32_t row = 0; row < rowCount; ++row)
+            {
+                ReadRow(m_Width);
+                ConvertRow(destination.data() + row * rowStride, m_Width);
+            }
+        }
+
+        m_NextRow += rowCount;
+        if (m_NextRow == m_Height) m_InterlacedPixels = {};
+        return rowCount;
+    }
+
+    void PngDecoder::ReadHeader(std::span<const uint8_t> chunk)
+    {
+        if (chunk.size() != 13) ThrowCorrupt("the header has an invalid size");
+
+        m_Width = ReadBigEndian32(chunk.data());
+        m_Height = ReadBigEndian32(chunk.data() + 4);
+        m_BitDepth = chunk[8];
+        m_ColorType = static_cast<ColorType>(chunk[9]);
+        const uint8_t compressionMethod{ chunk[10] };
+        const uint8_t filterMethod{ chunk[11] };
+        const uint8_t interlaceMethod{ chunk[12] };
+
+        if (m_Width == 0 || m_Height == 0) ThrowCorrupt("the image is empty");
+        if (m_Width > maxDimension || m_Height > maxDimension || uint64_t{ m_Width } * m_Height > maxPixelCount)
+            throw FileLoadException{ std::format("PNG images of {} by {} pixels are too large.\n", m_Width, m_Height) };
+
+        bool isValidBitDepth{};
+        switch (m_ColorType)
+        {
+        case ColorType::Gray:
+            isValidBitDepth = m_BitDepth == 1 || m_BitDepth == 2 || m_BitDepth == 4 || m_BitDepth == 8 || m_BitDepth == 16;
+            break;
+        case ColorType::Palette:
+            isValidBitDepth = m_BitDepth == 1 || m_BitDepth == 2 || m_BitDepth == 4 || m_BitDepth == 8;
+            break;
+        case ColorType::Rgb:
+        case ColorType::GrayAlpha:
+        case ColorType::Rgba:
+            isValidBitDepth = m_BitDepth == 8 || m_BitDepth == 16;
+            break;
+        default:
+            ThrowCorrupt("the header has an invalid color type");
+        }
+        if (!isValidBitDepth) ThrowCorrupt("the header has an invalid bit depth");
+        if (compressionMethod != 0 || filterMethod != 0 || interlaceMethod > 1) ThrowCorrupt("the header has an invalid method");
+
+        m_IsInterlaced = interlaceMethod == 1;
+        m_FilterStride = static_cast<uint32_t>(GetRowSize(1));
+    }
+
+    void PngDecoder::ReadPalette(std::span<const uint8_t> chunk)
+    {
+        if (chunk.empty() || chunk.size() % 3 != 0 || chunk.size() > 256 * 3) ThrowCorrupt("the palette has an invalid size");
+        m_Palette.assign(chunk.begin(), chunk.end());
+    }
+
+    void PngDecoder::ReadTransparency(std::span<const uint8_t> chunk)
+    {
+        switch (m_ColorType)
+        {
+        case ColorType::Palette:
+            if (chunk.size() > 256) ThrowCorrupt("the transparency has an invalid size");
+            m_PaletteAlpha.assign(chunk.begin(), chunk.end());
+            break;
+        case ColorType::Gray:
+            if (chunk.size() != 2) ThrowCorrupt("the transparency has an invalid size");
+            m_HasColorKey = true;
+            m_ColorKey = { ReadBigEndian16(chunk.data()), 0, 0 };
+            break;
+        case ColorType::Rgb:
+            if (chunk.size() != 6) ThrowCorrupt("the transparency has an invalid size");
+            m_HasColorKey = true;
+            m_ColorKey = { ReadBigEndian16(chunk.data()), ReadBigEndian16(chunk.data() + 2), ReadBigEndian16(chunk.data() + 4) };
+            break;
+        default:
+            // Images with an alpha channel don't have one, decoders are told to ignore it
+            break;
+        }
+    }
+
+    void PngDecoder::BuildLookupTable()
+    {
+        if (m_ColorType == ColorType::Palette)
+        {
+            // Indices past the end of the palette are invalid, they decode as opaque black
+            m_LookupTable.assign(256, MakePixel(0, 0, 0, 255));
+            for (std::size_t index = 0; index < m_Palette.size() / 3; ++index)
+            {
+                const uint32_t alpha{ index < m_PaletteAlpha.size() ? m_PaletteAlpha[index] : 255u };
+                m_LookupTable[index] = MakePixel(m_Palette[index * 3], m_Palette[index * 3 + 1], m_Palette[index * 3 + 2], alpha);
+            }
+        }
+        else if (m_ColorType == ColorType::Gray && m_BitDepth < 8)
+        {
+            const uint32_t maxValue{ (1u << m_BitDepth) - 1 };
+            m_LookupTable.resize(std::size_t{ maxValue } + 1);
+            for (uint32_t value = 0; value <= maxValue; ++value)
+            {
+                const uint32_t gray{ value * 255 / maxValue };
+                const uint32_t alpha{ m_HasColorKey && m_ColorKey[0] == value ? 0u : 255u };
+                m_LookupTable[value] = MakePixel(gray, gray, gray, alpha);
+            }
+        }
+    }
+
+    std::size_t PngDecoder::GetRowSize(uint32_t width) const
+    {
+        uint32_t channelCount{};
+        switch (m_ColorType)
+        {
+        case ColorType::Gray:
+        case ColorType::Palette:
+            channelCount = 1;
+            break;
+        case ColorType::GrayAlpha:
+            channelCount = 2;
+            break;
+        case ColorType::Rgb:
+            channelCount = 3;
+            break;
+        case ColorType::Rgba:
+            channelCount = 4;
+            break;
+        }
+        return static_cast<std::size_t>((uint64_t{ width } * channelCount * m_BitDepth + 7) / 8);
+    }
+
+    void PngDecoder::ReadRow(uint32_t width)
+    {
+        // The row decoded last becomes the one above
+        m_CurrentRow.swap(m_PreviousRow);
+
+        const std::size_t size{ GetRowSize(width) };
+        if (m_Inflater.Read(std::span{ m_CurrentRow }.first(size + 1)) != size + 1) ThrowCorrupt("the image data is truncated");
+
+        Unfilter(static_cast<FilterType>(m_CurrentRow[0]), m_CurrentRow.data() + 1, m_PreviousRow.data() + 1, size, m_FilterStride);
+    }
+
+    void PngDecoder::ConvertRow(uint8_t* pDestination, uint32_t width) const
+    {
+        const uint8_t* const pSource{ m_CurrentRow.data() + 1 };
+
+        if (!m_LookupTable.empty())
+        {
+            if (m_BitDepth == 8)
+            {
+                for (uint32_t x = 0; x < width; ++x) StorePixel(pDestination + x * 4, m_LookupTable[pSource[x]]);
+                return;
+            }
+
+            // Packed from the highest bits down
+            const uint32_t mask{ (1u << m_BitDepth) - 1 };
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const uint32_t bit{ x * m_BitDepth };
+                const uint32_t value{ (pSource[bit / 8] >> (8 - m_BitDepth - bit % 8)) & mask };
+                StorePixel(pDestination + x * 4, m_LookupTable[value]);
+            }
+            return;
+        }
+
+        switch (m_ColorType)
+        {
+        case ColorType::Gray:
+            if (m_BitDepth == 8)
+            {
+                pixels::GrayToBgra({ pSource, width }, { pDestination, std::size_t{ width } * 4 });
+                if (m_HasColorKey && m_ColorKey[0] <= 255) pixels::ColorKeyToAlpha({ pDestination, std::size_t{ width } * 4 }, m_ColorKey[0] * 0x010101u);
+                break;
+            }
+
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const uint16_t value{ ReadBigEndian16(pSource + x * 2) };
+                const uint32_t gray{ ScaleTo8Bits(value) };
+                StorePixel(pDestination + x * 4, MakePixel(gray, gray, gray, m_HasColorKey && m_ColorKey[0] == value ? 0 : 255));
+            }
+            break;
+
+        case ColorType::GrayAlpha:
+            if (m_BitDepth == 8)
+            {
+                pixels::GrayAlphaToPremultipliedBgra({ pSource, std::size_t{ width } * 2 }, { pDestination, std::size_t{ width } * 4 });
+                break;
+            }
+
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                const uint32_t gray{ ScaleTo8Bits(ReadBigEndian16(pSource + x * 4)) };
+                const uint32_t alpha{ ScaleTo8Bits(ReadBigEndian16(pSource + x * 4 + 2)) };
+                StorePixel(pDestination + x * 4, MakePixel(gray, gray, gray, alpha));
+            }
+            break;
+
+        case ColorType::Rgb:
+            // Opaque pixels don't change when premultiplied, and transparent ones become 0
+            if (m_BitDepth == 8)
+            {
+                pixels::RgbToBgra({ pSource, std::size_t{ width } * 3 }, { pDestination, std::size_t{ width } * 4 });
+                // A key with a value past 8 bits matches nothing
+                if (m_HasColorKey && std::ranges::all_of(m_ColorKey, [](uint16_t value) { return value <= 255; }))
+                {
+                    const uint32_t keyColor{ m_ColorKey[2] | (uint32_t{ m_ColorKey[1] } << 8) | (uint32_t{ m_ColorKey[0] } << 16) };
+                    pixels::ColorKeyToAlpha({ pDestination, std::size_t{ width } * 4 }, keyColor);
+                }
+                break;
+            }
+
+            for (uint32_t x = 0; x < width; ++x)
+            {
+                std::array<uint32_t, 3> color{};
+                for (uint32_t channel = 0; channel < 3; ++channel) color[channel] = ReadBigEndian16(pSource + x * 6 + channel * 2);
+
+                const bool isTransparent{ m_HasColorKey && color[0] == m_ColorKey[0] && color[1] == m_ColorKey[1] && color[2] == m_ColorKey[2] };
+                for (uint32_t& channel : color) channel = ScaleTo8Bits(channel);
+                StorePixel(pDestination + x * 4, MakePixel(color[0], color[1], color[2], isTransparent ? 0 : 255));
+            }
+            break;
+
+        case ColorType::Rgba:
+        {
+            if (m_BitDepth == 8)
+            {
+                pixels::RgbaToPremultipliedBgra({ pSource, std::size_t{ width } * 4 }, { pDestination, std::size_t{ width } * 4 });
+            }
+            else
+            {
+                for (uint32_t x = 0; x < width; ++x)
+                {
+                    const uint8_t* const pPixel{ pSource + x * 8 };
+                    StorePixel(pDestination + x * 4, MakePixel(ScaleTo8Bits(ReadBigEndian16(pPixel)), ScaleTo8Bits(ReadBigEndian16(pPixel + 2)),
+                                                               ScaleTo8Bits(ReadBigEndian16(pPixel + 4)), ScaleTo8Bits(ReadBigEndian16(pPixel + 6))));
+                }
+            }
+            break;
+        }
+
+        default:
+            break;
+        }
+    }
+
+    void PngDecoder::DecodeInterlaced()
+    {
+        const std::size_t rowSize{ std::size_t{ m_Width } * 4 };
+        m_InterlacedPixels.resize(rowSize * m_Height);
+        std::vector<uint8_t> passRow(rowSize);
+
+        // Seven reduced images, each filtered on its own
+        for (const InterlacePass& pass : adam7Passes)
+        {
+            if (pass.x >= m_Width || pass.y >= m_Height) continue;
+            const uint32_t passWidth{ (m_Width - pass.x + pass.xStep - 1) / pass.xStep };
+            const uint32_t passHeight{ (m_Height - pass.y + pass.yStep - 1) / pass.yStep };
+
+            std::fill(m_CurrentRow.begin(), m_CurrentRow.end(), uint8_t{});
+            for (uint32_t passY = 0; passY < passHeight; ++passY)
+            {
+                ReadRow(passWidth);
+                ConvertRow(passRow.data(), passWidth);
+
+                uint8_t* const pImageRow{ m_InterlacedPixels.data() + (pass.y + passY * pass.yStep) * rowSize };
+                for (uint32_t passX = 0; passX < passWidth; ++passX)
+                    std::memcpy(pImageRow + (pass.x + passX * pass.xStep) * 4, passRow.data() + passX * 4, 4);
+            }
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------------------
+}
@@ -0,0 +1,305 @@
+#include "Point2fArray.h"
+#include "Simd.h"
+#include <cmath>
+
+namespace jela
+{
+    //--------------------------------------------------------------------------------------------------------------------
+    // Point2fArray
+    Point2fArray::Point2fArray(std::size_t size) :
+        m_X(size),
+        m_Y(size)
+    {}
+    Point2fArray::Point2fArray(const std::vector<Point2f>& points)
+    {
+        Assign(points);
+    }
+    Point2fArray::Point2fArray(std::initializer_list<Point2f> points)
+    {
+        Reserve(points.size());
+        for (const Point2f& point : points) PushBack(point);
+    }
+
+    void Point2fArray::Assign(const std::vector<Point2f>& points)
+    {
+        m_X.resize(points.size());
+        m_Y.resize(points.size());
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            m_X[i] = points[i].x;
+            m_Y[i] = points[i].y;
+        }
+    }
+    std::vector<Point2f> Point2fArray::ToVector() const
+    {
+        std::vector<Point2f> points(m_X.size());
+        for (std::size_t i = 0; i < points.size(); ++i)
+        {
+            points[i].x = m_X[i];
+            points[i].y = m_Y[i];
+        }
+        return points;
+    }
+
+    void Point2fArray::Reserve(std::size_t capacity)
+    {
+        m_X.reserve(capacity);
+        m_Y.reserve(capacity);
+    }
+    void Point2fArray::Resize(std::size_t size)
+    {
+        m_X.resize(size);
+        m_Y.resize(size);
+    }
+    void Point2fArray::Clear()
+    {
+        m_X.clear();
+        m_Y.clear();
+    }
+    void Point2fArray::PushBack(const Point2f& point)
+    {
+        m_X.push_back(point.x);
+        m_Y.push_back(point.y);
+    }
+
+    void Point2fArray::Translate(const Vector2f& translation)
+    {
+        float* const pX{ m_X.data() };
+        float* const pY{ m_Y.data() };
+        const std::size_t size{ m_X.size() };
+        const std::size_t vectorEnd{ size - size % simd::floatWidth };
+
+        const simd::Float4 dx{ simd::Set1(translation.x) };
+        const simd::Float4 dy{ simd::Set1(translation.y) };
+        for (std::size_t i = 0; i < vectorEnd; i += simd::floatWidth)
+        {
+            simd::StoreAligned(pX + i, simd::Add(simd::LoadAligned(pX + i), dx));
+            simd::StoreAligned(pY + i, simd::Add(simd::LoadAligned(pY + i), dy));
+        }
+        for (std::size_t i = vectorEnd; i < size; ++i)
+        {
+            pX[i] += translation.x;
+            pY[i] += translation.y;
+        }
+    }
+
+    void Point2fArray::Scale(float xScale, float yScale, const Point2f& pointToScaleFrom)
+    {
+        Transform(Matrix3x2::Scale(xScale, yScale, pointToScaleFrom));
+    }
+
+    void Point2fArray::Rotate(float angle, const Point2f& pivotPoint)
+    {
+        Transform(Matrix3x2::Rotation(angle, pivotPoint));
+    }
+
+    void Point2fArray::Transform(float m11, float m12, float m21, float m22, float dx, float dy)
+    {
+        float* const pX{ m_X.data() };
+        float* const pY{ m_Y.data() };
+        const std::size_t size{ m_X.size() };
+        const std::size_t vectorEnd{ size - size % simd::floatWidth };
+
+        const simd::Float4 v11{ simd::Set1(m11) };
+        const simd::Float4 v12{ simd::Set1(m12) };
+        const simd::Float4 v21{ simd::Set1(m21) };
+        const simd::Float4 v22{ simd::Set1(m22) };
+        const simd::Float4 vdx{ simd::Set1(dx) };
+        const simd::Float4 vdy{ simd::Set1(dy) };
+        for (std::size_t i = 0; i < vectorEnd; i += simd::floatWidth)
+        {
+            const simd::Float4 x{ simd::LoadAligned(pX + i) };
+            const simd::Float4 y{ simd::LoadAligned(pY + i) };
+            simd::StoreAligned(pX + i, simd::MulAdd(x, v11, simd::MulAdd(y, v21, vdx)));
+            simd::StoreAligned(pY + i, simd::MulAdd(x, v12, simd::MulAdd(y, v22, vdy)));
+        }
+        for (std::size_t i = vectorEnd; i < size; ++i)
+        {
+            const float x{ pX[i] };
+            const float y{ pY[i] };
+            pX[i] = x * m11 + y * m21 + dx;
+            pY[i] = x * m12 + y * m22 + dy;
+        }
+    }
+
+    std::pair<Point2f, Point2f> Point2fArray::GetMinMax() const
+    {
+        if (m_X.empty()) return { Point2f{}, Point2f{} };
+
+        const float* const pX{ m_X.data() };
+        const float* const pY{ m_Y.data() };
+        const std::size_t size{ m_X.size() };
+        const std::size_t vectorEnd{ size - size % simd::floatWidth };
+
+        float xMin{ pX[0] };
+        float xMax{ pX[0] };
+        float yMin{ pY[0] };
+        float yMax{ pY[0] };
+
+        if (vectorEnd > 0)
+        {
+            simd::Float4 vxMin{ simd::LoadAligned(pX) };
+            simd::Float4 vyMin{ simd::LoadAligned(pY) };
+            simd::Float4 vxMax{ vxMin };
+            simd::Float4 vyMax{ vyMin };
+            for (std::size_t i = simd::floatWidth; i < vectorEnd; i += simd::floatWidth)
+            {
+                const simd::Float4 x{ simd::LoadAligned(pX + i) };
+                const simd::Float4 y{ simd::LoadAligned(pY + i) };
+                vxMin = simd::Min(vxMin, x);
+                vxMax = simd::Max(vxMax, x);
+                vyMin = simd::Min(vyMin, y);
+                vyMax = simd::Max(vyMax, y);
+            }
+            xMin = simd::HorizontalMin(vxMin);
+            xMax = simd::HorizontalMax(vxMax);
+            yMin = simd::HorizontalMin(vyMin);
+            yMax = simd::HorizontalMax(vyMax);
+        }
+        for (std::size_t i = vectorEnd; i < size; ++i)
+        {
+            xMin = std::min(xMin, pX[i]);
+            xMax = std::max(xMax, pX[i]);
+            yMin = std::min(yMin, pY[i]);
+            yMax = std::max(yMax, pY[i]);
+        }
+
+        return { Point2f{ xMin, yMin }, Point2f{ xMax, yMax } };
+    }
+
+    Rectf Point2fArray::GetBoundingRect() const
+    {
+        const auto [min, max] = GetMinMax();
+        // In both coordinate systems the second Rectf component is the smallest y value.
+        return Rectf{ min, max.x - min.x, max.y - min.y };
+    }
+
+    Point2f Point2fArray::GetCentroid() const
+    {
+        if (m_X.empty()) return Point2f{};
+
+        const float* const pX{ m_X.data() };
+        const float* const pY{ m_Y.data() };
+        const std::size_t size{ m_X.size() };
+        const std::size_t vectorEnd{ size - size % simd::floatWidth };
+
+        // Summing the offsets to the first point keeps the partial sums small,
+        // which limits the precision loss for large arrays far away from the origin.
+        const float xOrigin{ pX[0] };
+        const float yOrigin{ pY[0] };
+        const simd::Float4 vxOrigin{ simd::Set1(xOrigin) };
+        const simd::Float4 vyOrigin{ simd::Set1(yOrigin) };
+
+        simd::Float4 xSum{ simd::Zero() };
+        simd::Float4 ySum{ simd::Zero() };
+        for (std::size_t i = 0; i < vectorEnd; i += simd::floatWidth)
+        {
+            xSum = simd::Add(xSum, simd::Sub(simd::LoadAligned(pX + i), vxOrigin));
+            ySum = simd::Add(ySum, simd::Sub(simd::LoadAligned(pY + i), vyOrigin));
+        }
+
+        float xTotal{ simd::HorizontalAdd(xSum) };
+        float yTotal{ simd::HorizontalAdd(ySum) };
+        for (std::size_t i = vectorEnd; i < size; ++i)
+        {
+            xTotal += pX[i] - xOrigin;
+            yTotal += pY[i] - yOrigin;
+        }
+
+        const float invSize{ 1.f / static_cast<float>(size) };
+        return Point2f{ xOrigin + xTotal * invSize, yOrigin + yTotal * invSize };
+    }
+    //--------------------------------------------------------------------------------------------------------------------
+
+
+    //--------------------------------------------------------------------------------------------------------------------
+    // Batch utils
+    namespace utils
+    {
+        void IsPointInRect(const Point2fArray& points, const Rectf& r, std::vector<uint8_t>& results)
+        {
+            const float* const pX{ points.X() };
+            const float* const pY{ points.Y() };
+            const float right{ r.left + r.width };
+#ifdef MATHEMATICAL_COORDINATESYSTEM
+            const float yMin{ r.bottom };
+#else
+            const float yMin{ r.top };
+#endif // MATHEMATICAL_COORDINATESYSTEM
+            const float yMax{ yMin + r.height };
+
+            results.resize(points.Size());
+            for (std::size_t i = 0; i < points.Size(); ++i)
+            {
+                results[i] = static_cast<uint8_t>((pX[i] >= r.left) & (pX[i] <= right) & (pY[i] >= yMin) & (pY[i] <= yMax));
+            }
+        }
+
+        void IsPointInCircle(const Point2fArray& points, const Circlef& c, std::vector<uint8_t>& results)
+        {
+            const float* const pX{ points.X() };
+            const float* const pY{ points.Y() };
+            const float radSquared{ c.rad * c.rad };
+
+            results.resize(points.Size());
+            for (std::size_t i = 0; i < points.Size(); ++i)
+            {
+                const float x{ c.center.x - pX[i] };
+                const float y{ c.center.y - pY[i] };
+                results[i] = static_cast<uint8_t>(x * x + y * y <= radSquared);
+            }
+        }
+
+        void IsPointInEllipse(const Point2fArray& points, const Ellipsef& e, std::vector<uint8_t>& results)
+        {
+            const float* const pX{ points.X() };
+            const float* const pY{ points.Y() };
+            const float xRadSqrd{ e.radiusX * e.radiusX };
+            const float yRadSqrd{ e.radiusY * e.radiusY };
+            const float rhs{ xRadSqrd * yRadSqrd };
+
+            results.resize(points.Size());
+            for (std::size_t i = 0; i < points.Size(); ++i)
+            {
+                const float xDist{ pX[i] - e.center.x };
+                const float yDist{ pY[i] - e.center.y };
+                results[i] = static_cast<uint8_t>(xDist * xDist * yRadSqrd + yDist * yDist * xRadSqrd <= rhs);
+            }
+        }
+
+        void Distance(const Point2fArray& points, const Point2f& p, std::vector<float>& results)
+        {
+            const float* const pX{ points.X() };
+            const float* const pY{ points.Y() };
+
+            results.resize(points.Size());
+            for (std::size_t i = 0; i < points.Size(); ++i)
+            {
+                const float x{ pX[i] - p.x };
+                const float y{ pY[i] - p.y };
+                results[i] = std::sqrt(x * x + y * y);
+            }
+        }
+
+        std::size_t CountPointsInRect(const Point2fArray& points, const Rectf& r)
+        {
+            const float* const pX{ points.X() };
+            const float* const pY{ points.Y() };
+            const float right{ r.left + r.width };
+#ifdef MATHEMATICAL_COORDINATESYSTEM
+            const float yMin{ r.bottom };
+#else
+            const float yMin{ r.top };
+#endif // MATHEMATICAL_COORDINATESYSTEM
+            const float yMax{ yMin + r.height };
+
+            std::size_t count{};
+            for (std::size_t i = 0; i < points.Size(); ++i)
+            {
+                count += static_cast<std::size_t>((pX[i] >= r.left) & (pX[i] <= right) & (pY[i] >= yMin) & (pY[i] <= yMax));
+            }
+            return count;
+        }
+    }
+    //--------------------------------------------------------------------------------------------------------------------
+}
@@ -0,0 +1,381 @@
+#include "PolygonUtils.h"
+#include <algorithm>
+#include <functional>
+#include <limits>
+#include <queue>
+#include <unordered_map>
+#include <utility>
+
+namespace jela
+{
+    namespace
+    {
+        float Cross(const Point2f& origin, const Point2f& first, const Point2f& second)
+        {
+            return Vector2f::Cross(first - origin, second - origin);
+        }
+
+        float SquaredDistanceToSegment(const Point2f& point, const Point2f& begin, const Point2f& end)
+        {
+            const Vector2f segment{ end - begin };
+            const float squaredLength{ segment.SquaredLength() };
+            if (squaredLength <= FLT_EPSILON) return (point - begin).SquaredLength();
+
+            const float t{ std::clamp(Vector2f::Dot(point - begin, segment) / squaredLength, 0.f, 1.f) };
+            return (point - (begin + segment * t)).SquaredLength();
+        }
+
+        // Marks the points of the chain [first, last] that Ramer-Douglas-Peucker keeps.
+        // Uses an explicit stack so long outlines can't overflow the call stack.
+        void MarkRamerDouglasPeucker(const Point2fArray& points, std::size_t first, std::size_t last, float squaredTolerance, std::vector<uint8_t>& keep)
+        {
+            const std::size_t size{ points.Size() };
+            std::vector<std::pair<std::size_t, std::size_t>> ranges{ { first, last } };
+            while (!ranges.empty())
+            {
+                const auto [begin, end] = ranges.back();
+                ranges.pop_back();
+
+                const Point2f beginPoint{ points[begin % size] };
+                const Point2f endPoint{ points[end % size] };
+                float maxDistance{ -1.f };
+                std::size_t farthest{ begin };
+                for (std::size_t i = begin + 1; i < end; ++i)
+                {
+                    const float distance{ SquaredDistanceToSegment(points[i % size], beginPoint, endPoint) };
+                    if (distance > maxDistance)
+                    {
+                        maxDistance = distance;
+                        farthest = i;
+                    }
+                }
+
+                if (maxDistance <= squaredTolerance) continue;
+
+                keep[farthest % size] = 1;
+                ranges.emplace_back(begin, farthest);
+                ranges.emplace_back(farthest, end);
+            }
+        }
+
+        Point2fArray KeptPoints(const Point2fArray& points, const std::vector<uint8_t>& keep)
+        {
+            Point2fArray result{};
+            result.Reserve(static_cast<std::size_t>(std::count(keep.begin(), keep.end(), uint8_t{ 1 })));
+            for (std::size_t i = 0; i < points.Size(); ++i)
+            {
+                if (keep[i]) result.PushBack(points[i]);
+            }
+            return result;
+        }
+    }
+
+    namespace utils
+    {
+        float GetSignedArea(const Point2fArray& points)
+        {
+            const std::size_t size{ points.Size() };
+            const float* const pX{ points.X() };
+            const float* const pY{ points.Y() };
+
+            float doubleArea{};
+            for (std::size_t i = 0, j = size - 1; i < size; j = i++)
+            {
+                doubleArea += pX[j] * pY[i] - pX[i] * pY[j];
+            }
+            return doubleArea * 0.5f;
+        }
+
+        bool IsConvex(const Point2fArray& points)
+        {
+            const std::size_t size{ points.Size() };
+            if (size < 3) return false;
+
+            bool hasPositive{};
+            bool hasNegative{};
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                const float cross{ Cross(points[i], points[(i + 1) % size], points[(i + 2) % size]) };
+                hasPositive |= cross > 0.f;
+                hasNegative |= cross < 0.f;
+            }
+            return !(hasPositive && hasNegative);
+        }
+
+        Point2fArray SimplifyRamerDouglasPeucker(const Point2fArray& points, float tolerance, bool closed)
+        {
+            const std::size_t size{ points.Size() };
+            if (size <= (closed ? 3u : 2u)) return points;
+
+            std::vector<uint8_t> keep(size, 0);
+            const float squaredTolerance{ tolerance * tolerance };
+
+            if (!closed)
+            {
+                keep.front() = 1;
+                keep.back() = 1;
+                MarkRamerDouglasPeucker(points, 0, size - 1, squaredTolerance, keep);
+                return KeptPoints(points, keep);
+            }
+
+            // A closed outline is split at the first point and the point farthest away from it.
+            // The second chain wraps around, index size is the first point again.
+            const Point2f start{ points[0] };
+            std::size_t farthest{};
+            float maxDistance{ -1.f };
+            for (std::size_t i = 1; i < size; ++i)
+            {
+                const float distance{ (points[i] - start).SquaredLength() };
+                if (distance > maxDistance)
+                {
+                    maxDistance = distance;
+                    farthest = i;
+                }
+            }
+
+            keep[0] = 1;
+            keep[farthest] = 1;
+            MarkRamerDouglasPeucker(points, 0, farthest, squaredTolerance, keep);
+            MarkRamerDouglasPeucker(points, farthest, size, squaredTolerance, keep);
+            return KeptPoints(points, keep);
+        }
+
+        Point2fArray SimplifyVisvalingam(const Point2fArray& points, float minArea, bool closed)
+        {
+            const std::size_t size{ points.Size() };
+            const std::size_t minSize{ closed ? 3u : 2u };
+            if (size <= minSize) return points;
+
+            constexpr float fixed{ std::numeric_limits<float>::infinity() };
+
+            std::vector<std::size_t> previous(size);
+            std::vector<std::size_t> next(size);
+            std::vector<float> areas(size);
+            std::vector<uint8_t> keep(size, 1);
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                previous[i] = (i + size - 1) % size;
+                next[i] = (i + 1) % size;
+            }
+
+            auto triangleArea = [&](std::size_t i)
+                {
+                    if (!closed && (i == 0 || i == size - 1)) return fixed;
+                    return std::abs(Cross(points[previous[i]], points[i], points[next[i]])) * 0.5f;
+                };
+
+            // Stale heap entries are skipped when their area no longer matches
+            using Entry = std::pair<float, std::size_t>;
+            std::priority_queue<Entry, std::vector<Entry>, std::greater<Entry>> queue{};
+            for (std::size_t i = 0; i < size; ++i)
+            {
+                areas[i] = triangleArea(i);
+                queue.emplace(areas[i], i);
+            }
+
+            std::size_t remaining{ size };
+            while (!queue.empty() && remaining > minSize)
+            {
+                const auto [area, i] = queue.top();
+                queue.pop();
+                if (!keep[i] || area != areas[i]) continue;
+                if (area >= minArea) break;
+
+                keep[i] = 0;
+                --remaining;
+                next[previous[i]] = next[i];
+                previous[next[i]] = previous[i];
+
+                // A neighbour never gets a smaller area than the point removed next to it,
+                // otherwise points would be dropped out of order.
+                for (const std::size_t neighbour : { previous[i], next[i] })
+                {
+                    areas[neighbour] = std::max(triangleArea(neighbour), area);
+                    queue.emplace(areas[neighbour], neighbour);
+                }
+            }
+            return KeptPoints(points, keep);
+        }
+
+        std::vector<std::array<uint32_t, 3>> Triangulate(const Point2fArray& points)
+        {
+            std::vector<std::array<uint32_t, 3>> triangles{};
+            const std::size_t size{ points.Size() };
+            if (size < 3) return triangles;
+            triangles.reserve(size - 2);
+
+            std::vector<uint32_t> remaining(size);
+            for (uint32_t i = 0; i < size; ++i) remaining[i] = i;
+            if (GetSignedArea(points) < 0.f) std::reverse(remaining.begin(), remaining.end());
+
+            auto vertex = [&](std::size_t position) { return points[remaining[position % remaining.size()]]; };
+            auto isEar = [&](std::size_t position)
+                {
+                    const std::size_t count{ remaining.size() };
+                    const Point2f a{ vertex(position + count - 1) };
+                    const Point2f b{ vertex(position) };
+                    const Point2f c{ vertex(position + 1) };
+                    if (Cross(a, b, c) <= 0.f) return false;
+
+                    // Only reflex vertices can lie inside the ear
+                    for (std::size_t other = position + 2; other < position + count - 1; ++other)
+                    {
+                        const Point2f point{ vertex(other) };
+                        if (Cross(vertex(other + count - 1), point, vertex(other + 1)) > 0.f) continue;
+                        if (point == a || point == b || point == c) continue;
+                        if (Cross(a, b, point) >= 0.f && Cross(b, c, point) >= 0.f && Cross(c, a, point) >= 0.f) return false;
+                    }
+                    return true;
+                };
+
+            std::size_t position{};
+            std::size_t failures{};
+            while (remaining.size() > 3)
+            {
+                const std::size_t count{ remaining.size() };
+                // A full round without ears only happens for degenerate or self-intersecting outlines,
+                // clipping anyway guarantees progress.
+                if (failures < count && !isEar(position))
+                {
+                    position = (position + 1) % count;
+                    ++failures;
+                    continue;
+                }
+
+                const uint32_t a{ remaining[(position + count - 1) % count] };
+                const uint32_t b{ remaining[position] };
+                const uint32_t c{ remaining[(position + 1) % count] };
+                if (Cross(points[a], points[b], points[c]) > 0.f) triangles.push_back({ a, b, c });
+
+                remaining.erase(remaining.begin() + static_cast<std::ptrdiff_t>(position));
+                if (position == remaining.size()) position = 0;
+                failures = 0;
+            }
+            if (Cross(points[remaining[0]], points[remaining[1]], points[remaining[2]]) > 0.f)
+            {
+                triangles.push_back({ remaining[0], remaining[1], remaining[2] });
+            }
+            return triangles;
+        }
+
+        std::vector<Point2fArray> DecomposeConvex(const Point2fArray& points)
+        {
+            const std::vector<std::array<uint32_t, 3>> triangles{ Triangulate(points) };
+
+            std::vector<std::vector<uint32_t>> pieces(triangles.size());
+            std::unordered_map<uint64_t, uint32_t> pieceOfEdge{};
+            auto edgeKey = [](uint32_t from, uint32_t to) { return (uint64_t{ from } << 32) | to; };
+
+            for (uint32_t t = 0; t < triangles.size(); ++t)
+            {
+                pieces[t].assign(triangles[t].begin(), triangles[t].end());
+                for (uint32_t i = 0; i < 3; ++i) pieceOfEdge[edgeKey(triangles[t][i], triangles[t][(i + 1) % 3])] = t;
+            }
+
+            // Every edge shared by two triangles is a diagonal, visited in triangulation order
+            std::vector<std::pair<uint32_t, uint32_t>> diagonals{};
+            for (const std::array<uint32_t, 3>& triangle : triangles)
+            {
+                for (uint32_t i = 0; i < 3; ++i)
+                {
+                    const uint32_t from{ triangle[i] };
+                    const uint32_t to{ triangle[(i + 1) % 3] };
+                    if (from < to && pieceOfEdge.contains(edgeKey(to, from))) diagonals.emplace_back(from, to);
+                }
+            }
+
+            std::vector<uint8_t> alive(pieces.size(), 1);
+            for (const auto& [u, v] : diagonals)
+            {
+                const uint32_t first{ pieceOfEdge.at(edgeKey(u, v)) };
+                const uint32_t second{ pieceOfEdge.at(edgeKey(v, u)) };
+                const std::vector<uint32_t>& piece1{ pieces[first] };
+                const std::vector<uint32_t>& piece2{ pieces[second] };
+                const std::size_t size1{ piece1.size() };
+                const std::size_t size2{ piece2.size() };
+
+                // piece1 runs u -> v, piece2 runs v -> u
+                const std::size_t uIn1{ static_cast<std::size_t>(std::find(piece1.begin(), piece1.end(), u) - piece1.begin()) };
+                const std::size_t vIn2{ static_cast<std::size_t>(std::find(piece2.begin(), piece2.end(), v) - piece2.begin()) };
+
+                // Removing the diagonal must leave convex corners at both of its ends
+                const Point2f beforeU{ points[piece1[(uIn1 + size1 - 1) % size1]] };
+                const Point2f afterU{ points[piece2[(vIn2 + 2) % size2]] };
+                const Point2f beforeV{ points[piece2[(vIn2 + size2 - 1) % size2]] };
+                const Point2f afterV{ points[piece1[(uIn1 + 2) % size1]] };
+                if (Cross(beforeU, points[u], afterU) < 0.f || Cross(beforeV, points[v], afterV) < 0.f) continue;
+
+                std::vector<uint32_t> merged{};
+                merged.reserve(size1 + size2 - 2);
+                for (std::size_t i = 1; i <= size1; ++i) merged.push_back(piece1[(uIn1 + i) % size1]);
+                for (std::size_t i = 2; i < size2; ++i) merged.push_back(piece2[(vIn2 + i) % size2]);
+
+                pieceOfEdge.erase(edgeKey(u, v));
+                pieceOfEdge.erase(edgeKey(v, u));
+                for (std::size_t i = 0; i < merged.size(); ++i)
+                {
+                    pieceOfEdge[edgeKey(merged[i], merged[(i + 1) % merged.size()])] = first;
+                }
+                pieces[first] = std::move(merged);
+                pieces[second].clear();
+                alive[second] = 0;
+            }
+
+            std::vector<Point2fArray> result{};
+            for (std::size_t i = 0; i < pieces.size(); ++i)
+            {
+                if (!alive[i]) continue;
+
+                Point2fArray& piece{ result.emplace_back() };
+                piece.Reserve(pieces[i].size());
+                for (const uint32_t index : pieces[i]) piece.PushBack(points[index]);
+            }
+            return result;
+        }
+
+        bool IsPointInConvexPolygon(const Point2fArray& convexPoints, const Point2f& point)
+        {
+            const std::size_t size{ convexPoints.Size() };
+            if (size < 3) return false;
+
+            const float* const pX{ convexPoints.X() };
+            const float* const pY{ convexPoints.Y() };
+            for (std::size_t i = 0, j = size - 1; i < size; j = i++)
+            {
+                // Right of any edge means outside
+                if ((pX[i] - pX[j]) * (point.y - pY[j]) - (pY[i] - pY[j]) * (point.x - pX[j]) < 0.f) return false;
+            }
+            return true;
+        }
+
+        bool IsOverlappingConvex(const Point2fArray& convexPoints1, const Point2fArray& convexPoints2)
+        {
+            if (convexPoints1.Size() < 3 || convexPoints2.Size() < 3) return false;
+
+            // Separating axis test on the edge normals of one polygon against the points of the other
+            auto hasSeparatingEdge = [](const Point2fArray& polygon, const Point2fArray& other)
+                {
+                    const std::size_t size{ polygon.Size() };
+                    const float* const pX{ polygon.X() };
+                    const float* const pY{ polygon.Y() };
+                    const float* const pOtherX{ other.X() };
+                    const float* const pOtherY{ other.Y() };
+                    for (std::size_t i = 0, j = size - 1; i < size; j = i++)
+                    {
+                        const float normalX{ pY[i] - pY[j] };
+                        const float normalY{ pX[j] - pX[i] };
+
+                        bool separated{ true };
+                        for (std::size_t k = 0; k < other.Size() && separated; ++k)
+                        {
+                            separated = normalX * (pOtherX[k] - pX[j]) + normalY * (pOtherY[k] - pY[j]) > 0.f;
+                        }
+                        if (separated) return true;
+                    }
+                    return false;
+                };
+
+            return !hasSeparatingEdge(convexPoints1, convexPoints2) && !hasSeparatingEdge(convexPoints2, convexPoints1);
+        }
+    }
+}
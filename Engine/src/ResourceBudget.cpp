@@ -0,0 +1,65 @@
+#include "ResourceBudget.h"
+
+namespace jela
+{
+    void ResourceBudget::Add(AssetId id, std::size_t sizeInBytes)
+    {
+        if (const auto it = m_Lookup.find(id); it != m_Lookup.end())
+        {
+            m_Usage = m_Usage - it->second->sizeInBytes + sizeInBytes;
+            it->second->sizeInBytes = sizeInBytes;
+            m_Entries.splice(m_Entries.end(), m_Entries, it->second);
+            return;
+        }
+
+        m_Entries.emplace_back(Entry{ id, sizeInBytes });
+        m_Lookup.emplace(id, std::prev(m_Entries.end()));
+        m_Usage += sizeInBytes;
+    }
+
+    void ResourceBudget::Remove(AssetId id)
+    {
+        if (const auto it = m_Lookup.find(id); it != m_Lookup.end())
+        {
+            m_Usage -= it->second->sizeInBytes;
+            m_Entries.erase(it->second);
+            m_Lookup.erase(it);
+        }
+    }
+
+    void ResourceBudget::Clear()
+    {
+        m_Entries.clear();
+        m_Lookup.clear();
+        m_Usage = 0;
+    }
+
+    void ResourceBudget::Touch(AssetId id)
+    {
+        if (const auto it = m_Lookup.find(id); it != m_Lookup.end())
+            m_Entries.splice(m_Entries.end(), m_Entries, it->second);
+    }
+
+    std::size_t ResourceBudget::Evict(const std::function<bool(AssetId id)>& isInUse, std::vector<AssetId>& evicted)
+    {
+        std::size_t count{};
+        for (auto it = m_Entries.begin(); it != m_Entries.end() && IsOverBudget();)
+        {
+            if (isInUse(it->id))
+            {
+                ++it;
+                continue;
+            }
+
+            m_Usage -= it->sizeInBytes;
+            m_EvictedBytes += it->sizeInBytes;
+            ++m_EvictionCount;
+            ++count;
+
+            m_Lookup.erase(it->id);
+            evicted.emplace_back(it->id);
+            it = m_Entries.erase(it);
+        }
+        return count;
+    }
+}
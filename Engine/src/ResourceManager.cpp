@@ -1,9 +1,88 @@
 #include "ResourceManager.h"
 #include "Engine.h"
 #include "FileExceptions.h"
+#include "AudioService.h"
+#include "PngDecoder.h"
 
 namespace jela
 {
+    namespace
+    {
+        // Reads the texture from a mounted asset pack when one contains it, from the data path otherwise.
+        // When it comes from a pack, ppStream receives the stream the decoder reads from. Release it after the decoder.
+        HRESULT CreateTextureDecoder(IWICImagingFactory* pFactory, const tstring& filename,
+                                     IWICStream** ppStream, IWICBitmapDecoder** ppDecoder)
+        {
+            const std::span<const std::byte> packedData{ ENGINE.ResourceMngr()->FindPackedAsset(filename) };
+            const std::filesystem::path filePath{ ENGINE.ResourceMngr()->GetDataPath() + filename };
+
+            if (packedData.empty() && !std::filesystem::exists(filePath))
+                throw FileNotFoundException{
+                    std::format("Path \"{}\" does not exist. Error occurred when trying to create a Texture.\n",
+                                filePath.string())
+                };
+
+            if (filename.find(_T(".png")) == std::string::npos &&
+                filename.find(_T(".jpg")) == std::string::npos &&
+                filename.find(_T(".jpeg")) == std::string::npos)
+                throw FileTypeNotSupportedException{
+                    std::format("File type of {} is not supported.", std::filesystem::path{ filename }.string()),
+                    { ".png", ".jpg", ".jpeg" }
+                };
+
+            if (packedData.empty())
+                return pFactory->CreateDecoderFromFilename(filePath.c_str(), NULL, GENERIC_READ, WICDecodeMetadataCacheOnLoad, ppDecoder);
+
+            HRESULT hr = pFactory->CreateStream(ppStream);
+            if (SUCCEEDED(hr))
+            {
+                hr = (*ppStream)->InitializeFromMemory(
+                    const_cast<BYTE*>(reinterpret_cast<const BYTE*>(packedData.data())),
+                    static_cast<DWORD>(packedData.size()));
+            }
+            if (SUCCEEDED(hr)) hr = pFactory->CreateDecoderFromStream(*ppStream, NULL, WICDecodeMetadataCacheOnLoad, ppDecoder);
+            return hr;
+        }
+
+        // Packed textures are keyed by the pack they come from, rebuilding the pack invalidates them
+        uint64_t GetTextureCacheKey(const tstring& filename)
+        {
+            const ResourceManager* const pResourceManager{ ENGINE.ResourceMngr() };
+            if (const AssetPack* const pPack{ pResourceManager->FindAssetPack(filename) })
+                return TextureCache::MakeKey(utils::NormalizeAssetName(filename), pPack->GetPath());
+            return TextureCache::MakeKey({}, std::filesystem::path{ pResourceManager->GetDataPath() + filename });
+        }
+
+        bool IsPngFile(const tstring& filename)
+        {
+            return std::filesystem::path{ filename }.extension() == _T(".png");
+        }
+
+        DecodedImage DecodePng(const tstring& filename)
+        {
+            const ResourceManager* const pResourceManager{ ENGINE.ResourceMngr() };
+            if (const std::span<const std::byte> packedData{ pResourceManager->FindPackedAsset(filename) }; !packedData.empty())
+                return PngDecoder::Decode(packedData);
+
+            const MappedFile file{ std::filesystem::path{ pResourceManager->GetDataPath() + filename } };
+            return PngDecoder::Decode(file.GetData());
+        }
+
+        // Worker threads join the multithreaded apartment for as long as they live.
+        struct ComThreadScope
+        {
+            ComThreadScope() : result{ CoInitializeEx(NULL, COINIT_MULTITHREADED) } {}
+            ~ComThreadScope() { if (SUCCEEDED(result)) CoUninitialize(); }
+
+            ComThreadScope(const ComThreadScope&) = delete;
+            ComThreadScope(ComThreadScope&&) noexcept = delete;
+            ComThreadScope& operator= (const ComThreadScope&) = delete;
+            ComThreadScope& operator= (ComThreadScope&&) noexcept = delete;
+
+            HRESULT result;
+        };
+    }
+
     //---------------------------------------------------------------------------------------------------------------------------------
     //---------------------
     //TEXTURE
@@ -15,92 +94,86 @@ namespace jela
                                                 m_TextureWidth{ 0 },
                                                 m_TextureHeight{ 0 }
     {
+        // Goes through memory so the image ends up in the cache, or skips decoding altogether when it's already there.
+        // PNGs don't need WIC, so they always take this path.
+        if (ENGINE.ResourceMngr()->GetTextureCache() || IsPngFile(filename))
+        {
+            m_FileName = filename;
+            Upload(Decode(filename));
+            return;
+        }
+
         HRESULT creationResult = S_OK;
 
+        IWICStream* pStream = NULL;
         IWICBitmapDecoder* pDecoder = NULL;
         IWICBitmapFrameDecode* pSource = NULL;
         IWICFormatConverter* pConverter = NULL;
 
-        if (const std::filesystem::path filePath{ ENGINE.ResourceMngr()->GetDataPath() + filename };
-            std::filesystem::exists(filePath))
-        {
-            if (filename.find(_T(".png")) == std::string::npos &&
-                filename.find(_T(".jpg")) == std::string::npos &&
-                filename.find(_T(".jpeg")) == std::string::npos)
-                throw FileTypeNotSupportedException{
-                    std::format("File type of {} is not supported.", std::filesystem::path{ filename }.string()),
-                    { ".png", ".jpg", ".jpeg" }
-                };
+        creationResult = CreateTextureDecoder(m_pWICFactory, filename, &pStream, &pDecoder);
 
-            if (SUCCEEDED(creationResult))
-            {
-                creationResult = m_pWICFactory->CreateDecoderFromFilename(
-                    filePath.c_str(),
-                    NULL,
-                    GENERIC_READ,
-                    WICDecodeMetadataCacheOnLoad,
-                    &pDecoder);
-            }
 
+        if (SUCCEEDED(creationResult))
+        {
+            // Create the initial frame.
+            creationResult = pDecoder->GetFrame(0, &pSource);
+        }
 
-            if (SUCCEEDED(creationResult))
-            {
-                // Create the initial frame.
-                creationResult = pDecoder->GetFrame(0, &pSource);
-            }
 
+        // Convert the image format to 32bppPBGRA
+        // (DXGI_FORMAT_B8G8R8A8_UNORM + D2D1_ALPHA_MODE_PREMULTIPLIED).
+        if (SUCCEEDED(creationResult)) creationResult = m_pWICFactory->CreateFormatConverter(&pConverter);
+        if (SUCCEEDED(creationResult))
+        {
+            creationResult = pConverter->Initialize(
+                pSource,
+                GUID_WICPixelFormat32bppPBGRA,
+                WICBitmapDitherTypeNone,
+                NULL,
+                0.f,
+                WICBitmapPaletteTypeMedianCut
+            );
+        }
 
-            // Convert the image format to 32bppPBGRA
-            // (DXGI_FORMAT_B8G8R8A8_UNORM + D2D1_ALPHA_MODE_PREMULTIPLIED).
-            if (SUCCEEDED(creationResult)) creationResult = m_pWICFactory->CreateFormatConverter(&pConverter);
-            if (SUCCEEDED(creationResult))
-            {
-                creationResult = pConverter->Initialize(
-                    pSource,
-                    GUID_WICPixelFormat32bppPBGRA,
-                    WICBitmapDitherTypeNone,
-                    NULL,
-                    0.f,
-                    WICBitmapPaletteTypeMedianCut
-                );
-            }
+
+        if (SUCCEEDED(creationResult))
+        {
+            creationResult = ENGINE.GetRenderTarget()->CreateBitmapFromWicBitmap(
+                pConverter,
+                NULL,
+                &m_pDBitmap
+            );
 
 
             if (SUCCEEDED(creationResult))
             {
-                creationResult = ENGINE.GetRenderTarget()->CreateBitmapFromWicBitmap(
-                    pConverter,
-                    NULL,
-                    &m_pDBitmap
-                );
-
-
-                if (SUCCEEDED(creationResult))
-                {
-                    m_TextureWidth = m_pDBitmap->GetSize().width;
-                    m_TextureHeight = m_pDBitmap->GetSize().height;
-                }
+                m_TextureWidth = m_pDBitmap->GetSize().width;
+                m_TextureHeight = m_pDBitmap->GetSize().height;
             }
+        }
 
-            m_FileName = filename;
-            SafeRelease(&pDecoder);
-            SafeRelease(&pSource);
-            SafeRelease(&pConverter);
+        m_FileName = filename;
+        SafeRelease(&pDecoder);
+        SafeRelease(&pStream);
+        SafeRelease(&pSource);
+        SafeRelease(&pConverter);
 
-            if (!SUCCEEDED(creationResult))
-            {
-                SafeRelease(&m_pDBitmap);
-                throw FileLoadException{
-                    std::format("ERROR! File \"{}\" couldn't load correctly. HRESULT Error code: {}\n",
-                                filePath.string(), creationResult)
-                };
-            }
-        }
-        else
-            throw FileNotFoundException{
-                std::format("Path \"{}\" does not exist. Error occurred when trying to create a Texture.\n",
-                            filePath.string())
+        if (!SUCCEEDED(creationResult))
+        {
+            SafeRelease(&m_pDBitmap);
+            throw FileLoadException{
+                std::format("ERROR! File \"{}\" couldn't load correctly. HRESULT Error code: {}\n",
+                            std::filesystem::path{ filename }.string(), creationResult)
             };
+        }
+    }
+
+    Texture::Texture(const tstring& filename, const DecodedImage& image) : m_pDBitmap{ NULL },
+                                                                          m_TextureWidth{ 0 },
+                                                                          m_TextureHeight{ 0 },
+                                                                          m_FileName{ filename }
+    {
+        Upload(image);
     }
 
     Texture::~Texture()
@@ -108,6 +181,38 @@ namespace jela
         SafeRelease(&m_pDBitmap);
     }
 
+    void Texture::Upload(const DecodedImage& image)
+    {
+        const HRESULT creationResult = ENGINE.GetRenderTarget()->CreateBitmap(
+            D2D1::SizeU(image.width, image.height),
+            image.GetPixels().data(),
+            image.width * 4,
+            D2D1::BitmapProperties(D2D1::PixelFormat(DXGI_FORMAT_B8G8R8A8_UNORM, D2D1_ALPHA_MODE_PREMULTIPLIED)),
+            &m_pDBitmap
+        );
+
+        if (!SUCCEEDED(creationResult))
+        {
+            SafeRelease(&m_pDBitmap);
+            throw FileLoadException{
+                std::format("ERROR! Texture \"{}\" couldn't be uploaded. HRESULT Error code: {}\n",
+                            std::filesystem::path{ m_FileName }.string(), creationResult)
+            };
+        }
+
+        m_TextureWidth = m_pDBitmap->GetSize().width;
+        m_TextureHeight = m_pDBitmap->GetSize().height;
+    }
+
+    std::size_t Texture::GetSizeInBytes() const
+    {
+        if (!m_pDBitmap) return 0;
+
+        // Every bitmap the engine creates is 32 bits per pixel
+        const D2D1_SIZE_U pixelSize{ m_pDBitmap->GetPixelSize() };
+        return std::size_t{ pixelSize.width } * pixelSize.height * 4;
+    }
+
     void Texture::InitFactory()
     {
         if (!m_pWICFactory)
@@ -127,6 +232,82 @@ namespace jela
         SafeRelease(&m_pWICFactory);
     }
 
+    DecodedImage Texture::Decode(const tstring& filename)
+    {
+        TextureCache* const pCache{ ENGINE.ResourceMngr()->GetTextureCache() };
+        if (!pCache) return DecodeFile(filename);
+
+        const uint64_t cacheKey{ GetTextureCacheKey(filename) };
+        if (std::optional<DecodedImage> cachedImage{ pCache->Find(cacheKey) }) return std::move(*cachedImage);
+
+        DecodedImage image{ DecodeFile(filename) };
+        if (!pCache->Store(cacheKey, image))
+            OutputDebugString(std::format(_T("Texture {} could not be added to the texture cache.\n"), filename).c_str());
+        return image;
+    }
+
+    DecodedImage Texture::DecodeFile(const tstring& filename)
+    {
+        return IsPngFile(filename) ? DecodePng(filename) : DecodeWithWic(filename);
+    }
+
+    DecodedImage Texture::DecodeWithWic(const tstring& filename)
+    {
+        thread_local ComThreadScope comScope{};
+
+        HRESULT creationResult = S_OK;
+
+        IWICStream* pStream = NULL;
+        IWICBitmapDecoder* pDecoder = NULL;
+        IWICBitmapFrameDecode* pSource = NULL;
+        IWICFormatConverter* pConverter = NULL;
+
+        DecodedImage image{};
+
+        creationResult = CreateTextureDecoder(m_pWICFactory, filename, &pStream, &pDecoder);
+
+        if (SUCCEEDED(creationResult)) creationResult = pDecoder->GetFrame(0, &pSource);
+
+        // Same format the render target expects, so uploading is a plain copy
+        if (SUCCEEDED(creationResult)) creationResult = m_pWICFactory->CreateFormatConverter(&pConverter);
+        if (SUCCEEDED(creationResult))
+        {
+            creationResult = pConverter->Initialize(
+                pSource,
+                GUID_WICPixelFormat32bppPBGRA,
+                WICBitmapDitherTypeNone,
+                NULL,
+                0.f,
+                WICBitmapPaletteTypeMedianCut
+            );
+        }
+
+        if (SUCCEEDED(creationResult)) creationResult = pConverter->GetSize(&image.width, &image.height);
+        if (SUCCEEDED(creationResult))
+        {
+            image.pixels.resize(static_cast<std::size_t>(image.width) * image.height * 4);
+            creationResult = pConverter->CopyPixels(
+                NULL,
+                image.width * 4,
+                static_cast<UINT>(image.pixels.size()),
+                image.pixels.data()
+            );
+        }
+
+        SafeRelease(&pDecoder);
+        SafeRelease(&pStream);
+        SafeRelease(&pSource);
+        SafeRelease(&pConverter);
+
+        if (!SUCCEEDED(creationResult))
+            throw FileLoadException{
+                std::format("ERROR! File \"{}\" couldn't be decoded. HRESULT Error code: {}\n",
+                            std::filesystem::path{ filename }.string(), creationResult)
+            };
+
+        return image;
+    }
+
     //---------------------------------------------------------------------------------------------------------------------------------
 
 
@@ -136,6 +317,7 @@ namespace jela
     //---------------------
 
     IDWriteFactory5* Font::m_pDWriteFactory{ nullptr };
+    IDWriteInMemoryFontFileLoader* Font::m_pInMemoryLoader{ nullptr };
 
 
     Font::Font(const tstring& fontName, bool fromFile)
@@ -145,7 +327,8 @@ namespace jela
             try
             {
                 const tstring fullPath = ENGINE.ResourceMngr()->GetDataPath() + fontName;
-                if (const std::filesystem::path filePath{ fullPath }; !std::filesystem::exists(filePath))
+                const std::span<const std::byte> packedData{ ENGINE.ResourceMngr()->FindPackedAsset(fontName) };
+                if (const std::filesystem::path filePath{ fullPath }; packedData.empty() && !std::filesystem::exists(filePath))
                     throw FileNotFoundException{
                         std::format(
                             "Path \"{}\" does not exist. Error occurred when trying to create a Font from a file.\n",
@@ -159,7 +342,7 @@ namespace jela
                         { ".ttf", ".otf" }
                     };
 
-                if (const HRESULT hr = Initialize(fullPath); !SUCCEEDED(hr))
+                if (const HRESULT hr = Initialize(fullPath, packedData); !SUCCEEDED(hr))
                     throw FileLoadException{
                         std::format("Font {} wasn't initialized properly. HRESULT Error value: {}.",
                                     std::filesystem::path{ fontName }.string(), hr)
@@ -182,7 +365,7 @@ namespace jela
         SafeRelease(&m_pFontCollection);
     }
 
-    HRESULT Font::Initialize(const std::wstring& fontName)
+    HRESULT Font::Initialize(const std::wstring& fontName, std::span<const std::byte> packedData)
     {
         HRESULT hr = S_OK;
 
@@ -192,7 +375,14 @@ namespace jela
         m_pFontCollection = nullptr;
 
         hr = m_pDWriteFactory->CreateFontSetBuilder(&pFontSetBuilder);
-        if (SUCCEEDED(hr)) hr = m_pDWriteFactory->CreateFontFileReference(fontName.c_str(), NULL, &pFontFile);
+        if (SUCCEEDED(hr))
+        {
+            // Without an owner DirectWrite keeps its own copy, so the pack may be unmounted afterwards
+            if (packedData.empty()) hr = m_pDWriteFactory->CreateFontFileReference(fontName.c_str(), NULL, &pFontFile);
+            else if (m_pInMemoryLoader) hr = m_pInMemoryLoader->CreateInMemoryFontFileReference(m_pDWriteFactory, packedData.data(),
+                                                                                                 static_cast<UINT32>(packedData.size()), nullptr, &pFontFile);
+            else hr = E_NOINTERFACE;
+        }
 
         if (SUCCEEDED(hr)) hr = pFontSetBuilder->AddFontFile(pFontFile);
 
@@ -238,10 +428,17 @@ namespace jela
                 __uuidof(IDWriteFactory5),
                 reinterpret_cast<IUnknown**>(&m_pDWriteFactory));
         }
+        if (m_pDWriteFactory && !m_pInMemoryLoader)
+        {
+            if (SUCCEEDED(m_pDWriteFactory->CreateInMemoryFontFileLoader(&m_pInMemoryLoader)))
+                m_pDWriteFactory->RegisterFontFileLoader(m_pInMemoryLoader);
+        }
     }
 
     void Font::DestroyFactory()
     {
+        if (m_pInMemoryLoader) m_pDWriteFactory->UnregisterFontFileLoader(m_pInMemoryLoader);
+        SafeRelease(&m_pInMemoryLoader);
         SafeRelease(&m_pDWriteFactory);
     }
 
@@ -338,93 +535,415 @@ namespace jela
 
     void ResourceManager::Start()
     {
-        GetFont(_T("Verdana"), m_pDefaultFont);
-        SetCurrentFont(m_pDefaultFont.pObject);
+        m_DefaultFont = GetFont(_T("Verdana"));
+        SetCurrentFont(Resolve(m_DefaultFont));
 
         m_pDefaultTextFormat = std::make_unique<TextFormat>(12.f, false, false, TextFormat::HorAllignment::Left,
                                                             TextFormat::VertAllignment::Top);
         SetCurrentTextFormat(m_pDefaultTextFormat.get());
     }
 
-    void ResourceManager::GetTexture(const tstring& file, ResourcePtr<Texture>& resourcePtr)
+    ResourceManager::ResourceHandle<Texture> ResourceManager::GetTexture(const tstring& file)
+    {
+        return GetTexture(AssetId{ file }, file);
+    }
+
+    ResourceManager::ResourceHandle<Texture> ResourceManager::GetTexture(AssetId id)
+    {
+        if (m_Textures.ids.contains(id)) return GetTexture(id, {});
+
+        for (auto it = m_AssetPacks.rbegin(); it != m_AssetPacks.rend(); ++it)
+        {
+            if (const std::string_view name{ (*it)->FindName(id) }; !name.empty())
+            {
+                const std::u8string_view utf8Name{ reinterpret_cast<const char8_t*>(name.data()), name.size() };
+                return GetTexture(id, std::filesystem::path{ utf8Name }.string<tstring::value_type>());
+            }
+        }
+
+        OutputDebugStringA(std::format("Texture {} isn't loaded and no mounted asset pack contains it.\n", id.GetName()).c_str());
+        return ResourceHandle<Texture>{};
+    }
+
+    ResourceManager::ResourceHandle<Texture> ResourceManager::GetTexture(AssetId id, const tstring& file)
     {
+        if (const auto it = m_Textures.ids.find(id); it != m_Textures.ids.end())
+        {
+            const ResourceHandle<Texture> handle{ it->second };
+            // Marks it as used, and loads it again when it was evicted
+            Resolve(handle);
+            return handle;
+        }
+
         try
         {
-            m_MapTextures.try_emplace(file, file);
-            m_MapTextures.at(file).HandleObserver(resourcePtr);
+            const ResourceHandle<Texture> handle{ AddTexture(id, file, std::make_unique<Texture>(file)) };
+            EvictTextures();
+            return handle;
         }
         catch (const FileException& e)
         {
             MessageBoxA(ENGINE.GetWindow(), e.what(), "ERROR", MB_OK | MB_ICONERROR);
             OutputDebugStringA(e.what());
-            m_MapTextures.erase(file);
-            resourcePtr = ResourcePtr<Texture>{};
         }
         catch (const std::exception& e)
         {
             OutputDebugStringA(e.what());
-            m_MapTextures.erase(file);
-            resourcePtr = ResourcePtr<Texture>{};
         }
+        return ResourceHandle<Texture>{};
     }
 
-    void ResourceManager::RemoveTexture(const tstring& file)
+    ResourceManager::AsyncTexture ResourceManager::GetTextureAsync(const tstring& file, LoadPriority priority,
+                                                                   std::function<void(const Texture*)> onLoaded)
+    {
+        auto pState = std::make_shared<AsyncTexture::State>();
+        pState->onLoaded = std::move(onLoaded);
+
+        const AssetId id{ file };
+
+        // Evicted textures are decoded again like new ones
+        if (const auto it = m_Textures.ids.find(id); it != m_Textures.ids.end() && m_Textures.slots.Find(it->second)->pResource)
+        {
+            pState->texture = ResourceHandle<Texture>{ it->second };
+            FinishAsyncTexture(*pState, {});
+            return AsyncTexture{ std::move(pState) };
+        }
+
+        // The loader merges requests for the same file, a repeated request only raises the priority
+        m_PendingTextures[id].emplace_back(pState);
+        m_pTextureLoader->Request(file, priority);
+
+        return AsyncTexture{ std::move(pState) };
+    }
+
+    bool ResourceManager::MountAssetPack(const tstring& packFile)
+    {
+        try
+        {
+            const AssetPack& pack{ *m_AssetPacks.emplace_back(std::make_unique<AssetPack>(m_DataPath + packFile)) };
+            // Debug builds can then name the ids of literals that are only ever looked up in a pack
+            for (std::size_t index = 0; index < pack.GetAssetCount(); ++index) AssetId::RememberName(pack.GetAssetName(index));
+            return true;
+        }
+        catch (const FileException& e)
+        {
+            OutputDebugStringA(e.what());
+            return false;
+        }
+    }
+
+    std::span<const std::byte> ResourceManager::FindPackedAsset(const tstring& file) const
+    {
+        if (m_AssetPacks.empty()) return {};
+
+        const std::string name{ utils::NormalizeAssetName(file) };
+        for (auto it = m_AssetPacks.rbegin(); it != m_AssetPacks.rend(); ++it)
+        {
+            if (const std::span<const std::byte> data{ (*it)->Find(name) }; !data.empty()) return data;
+        }
+        return {};
+    }
+
+    const AssetPack* ResourceManager::FindAssetPack(const tstring& file) const
     {
-        if (m_MapTextures.contains(file))
+        if (m_AssetPacks.empty()) return nullptr;
+
+        const std::string name{ utils::NormalizeAssetName(file) };
+        for (auto it = m_AssetPacks.rbegin(); it != m_AssetPacks.rend(); ++it)
         {
-            m_MapTextures.erase(file);
+            if ((*it)->Contains(name)) return it->get();
         }
+        return nullptr;
+    }
+
+    bool ResourceManager::SetTextureCache(const tstring& directory, bool isCompressed)
+    {
+        m_pTextureCache = nullptr;
+        if (directory.empty()) return true;
+
+        try
+        {
+            m_pTextureCache = std::make_unique<TextureCache>(std::filesystem::path{ directory }, isCompressed);
+            return true;
+        }
+        catch (const FileException& e)
+        {
+            OutputDebugStringA(e.what());
+            return false;
+        }
+    }
+
+    std::span<const std::byte> ResourceManager::FindPackedAsset(AssetId id) const
+    {
+        for (auto it = m_AssetPacks.rbegin(); it != m_AssetPacks.rend(); ++it)
+        {
+            if (const std::span<const std::byte> data{ (*it)->Find(id) }; !data.empty()) return data;
+        }
+        return {};
+    }
+
+    void ResourceManager::RemoveTexture(const tstring& file)
+    {
+        const AssetId id{ file };
+        if (m_Textures.Remove(id)) m_TextureBudget.Remove(id);
         else OutputDebugString(std::format(_T("\nTexture to remove is not present. File: {}\n\n"), file).c_str());
     }
 
     void ResourceManager::RemoveAllTextures()
     {
-        m_MapTextures.clear();
+        m_Textures.Clear();
+        m_TextureBudget.Clear();
+    }
+
+    const Texture* ResourceManager::Resolve(const ResourceHandle<Texture>& handle)
+    {
+        ManagedResource<Texture>* const pManagedTexture{ m_Textures.slots.Find(handle.m_Key) };
+        if (!pManagedTexture) return nullptr;
+
+        // The first use in a frame moves it to the back of the eviction order
+        if (pManagedTexture->lastUsedFrame != m_FrameNumber)
+        {
+            pManagedTexture->lastUsedFrame = m_FrameNumber;
+            m_TextureBudget.Touch(pManagedTexture->id);
+        }
+
+        if (!pManagedTexture->pResource)
+        {
+            try
+            {
+                pManagedTexture->pResource = std::make_unique<Texture>(pManagedTexture->name);
+                m_TextureBudget.Add(pManagedTexture->id, pManagedTexture->pResource->GetSizeInBytes());
+            }
+            catch (const std::exception& e)
+            {
+                OutputDebugStringA(e.what());
+            }
+        }
+        return pManagedTexture->pResource.get();
+    }
+
+    const Font* ResourceManager::Resolve(const ResourceHandle<Font>& handle)
+    {
+        const ManagedResource<Font>* const pManagedFont{ m_Fonts.slots.Find(handle.m_Key) };
+        return pManagedFont ? pManagedFont->pResource.get() : nullptr;
+    }
+
+    ResourceManager::ResourceHandle<Texture> ResourceManager::AddTexture(AssetId id, const tstring& file, std::unique_ptr<Texture> pTexture)
+    {
+        m_TextureBudget.Add(id, pTexture->GetSizeInBytes());
+        return ResourceHandle<Texture>{ m_Textures.Add(id, file, std::move(pTexture), m_FrameNumber) };
     }
 
-    void ResourceManager::GetFont(const tstring& fontName, ResourcePtr<Font>& resourcePtr, bool fromFile)
+    void ResourceManager::Update()
     {
+        ++m_FrameNumber;
+
+        if (m_pFileWatcher) ReloadChangedFiles();
+
+        m_pTextureLoader->Collect(m_LoadedTextures, m_MaxTextureUploadsPerFrame);
+
+        for (TextureLoader::Result& result : m_LoadedTextures)
+        {
+            const AssetId id{ result.file };
+
+            if (m_ReloadingTextures.erase(id) > 0)
+            {
+                ManagedResource<Texture>* const pManagedTexture{ m_Textures.Find(id) };
+                if (!result.error.empty()) OutputDebugStringA(result.error.c_str());
+                // An evicted texture loads the new file by itself the next time it's used
+                else if (pManagedTexture && pManagedTexture->pResource)
+                {
+                    try
+                    {
+                        pManagedTexture->pResource = std::make_unique<Texture>(result.file, result.image);
+                        m_TextureBudget.Add(id, pManagedTexture->pResource->GetSizeInBytes());
+                    }
+                    catch (const std::exception& e)
+                    {
+                        OutputDebugStringA(e.what());
+                    }
+                }
+            }
+
+            const auto pendingIt = m_PendingTextures.find(id);
+            if (pendingIt == m_PendingTextures.end()) continue;
+
+            // Taken out before running any callback, those are free to request textures again
+            const std::vector<std::shared_ptr<AsyncTexture::State>> states{ std::move(pendingIt->second) };
+            m_PendingTextures.erase(pendingIt);
+
+            std::string error{ std::move(result.error) };
+            if (error.empty())
+            {
+                try
+                {
+                    ResourceHandle<Texture> handle{};
+                    // A synchronous GetTexture could have loaded the same file in the meantime
+                    if (ManagedResource<Texture>* const pManagedTexture{ m_Textures.Find(id) })
+                    {
+                        if (!pManagedTexture->pResource)
+                        {
+                            pManagedTexture->pResource = std::make_unique<Texture>(result.file, result.image);
+                            m_TextureBudget.Add(id, pManagedTexture->pResource->GetSizeInBytes());
+                        }
+                        handle = ResourceHandle<Texture>{ m_Textures.ids.at(id) };
+                    }
+                    else handle = AddTexture(id, result.file, std::make_unique<Texture>(result.file, result.image));
+
+                    for (const auto& pState : states) pState->texture = handle;
+                }
+                catch (const std::exception& e)
+                {
+                    error = e.what();
+                }
+            }
+            if (!error.empty()) OutputDebugStringA(error.c_str());
+
+            for (const auto& pState : states) FinishAsyncTexture(*pState, error);
+        }
+
+        // Frees the decoded pixels right away
+        m_LoadedTextures.clear();
+
+        // Also catches the textures that went out of use since the previous frame
+        EvictTextures();
+    }
+
+    void ResourceManager::SetTextureBudget(std::size_t budgetInBytes)
+    {
+        m_TextureBudget.SetBudget(budgetInBytes);
+        EvictTextures();
+    }
+
+    void ResourceManager::EvictTextures()
+    {
+        if (!m_TextureBudget.IsOverBudget()) return;
+
+        // Whatever got drawn last frame is likely drawn again in this one
+        std::vector<AssetId> evictedTextures{};
+        m_TextureBudget.Evict([this](AssetId id) { return m_Textures.Find(id)->lastUsedFrame + 1 >= m_FrameNumber; },
+                              evictedTextures);
+
+        // The slots stay, so the handles can load them again
+        for (const AssetId id : evictedTextures) m_Textures.Find(id)->pResource = nullptr;
+    }
+
+    void ResourceManager::SetHotReloadEnabled(bool isEnabled)
+    {
+        if (!isEnabled)
+        {
+            m_pFileWatcher = nullptr;
+            return;
+        }
+        if (m_pFileWatcher) return;
+
+        m_pFileWatcher = std::make_unique<FileWatcher>(std::filesystem::path{ m_DataPath }, [this](const std::filesystem::path& file)
+            {
+                const std::lock_guard<std::mutex> lock{ m_ChangedFilesMutex };
+                m_ChangedFiles.emplace_back(file);
+            });
+
+        if (!m_pFileWatcher->IsWatching())
+        {
+            OutputDebugString(std::format(_T("Hot reload could not watch the data path: {}\n"), m_DataPath).c_str());
+            m_pFileWatcher = nullptr;
+        }
+    }
+
+    void ResourceManager::ReloadChangedFiles()
+    {
+        std::vector<std::filesystem::path> changedFiles{};
+        {
+            const std::lock_guard<std::mutex> lock{ m_ChangedFilesMutex };
+            changedFiles.swap(m_ChangedFiles);
+        }
+
+        for (std::filesystem::path& changedFile : changedFiles)
+        {
+            // Either separator gives the same id, whichever one the game asked for the resource with
+            const tstring genericName{ changedFile.generic_string<tstring::value_type>() };
+            const AssetId id{ genericName };
+
+            if (const ManagedResource<Texture>* const pManagedTexture{ m_Textures.Find(id) })
+            {
+                // Decoded like any other request, the old texture stays in use until the new one is uploaded
+                m_ReloadingTextures.insert(id);
+                m_pTextureLoader->Request(pManagedTexture->name, LoadPriority::High);
+            }
+            else if (ManagedResource<Font>* const pManagedFont{ m_Fonts.Find(id) })
+            {
+                const bool isCurrentFont{ pManagedFont->pResource.get() == m_pCurrentFont };
+                try
+                {
+                    // Created before the old one goes, a failed reload leaves everything as it was
+                    pManagedFont->pResource = std::make_unique<Font>(pManagedFont->name, true);
+                    if (isCurrentFont) SetCurrentFont(pManagedFont->pResource.get());
+                }
+                catch (const std::exception& e)
+                {
+                    OutputDebugStringA(e.what());
+                }
+            }
+            else if (changedFile.extension() == _T(".wav"))
+            {
+                AudioLocator::GetAudioService().ReloadSound(genericName);
+            }
+        }
+    }
+
+    void ResourceManager::FinishAsyncTexture(AsyncTexture::State& state, const std::string& error)
+    {
+        state.status = error.empty() ? LoadStatus::Ready : LoadStatus::Failed;
+        state.error = error;
+
+        if (state.onLoaded)
+        {
+            const auto onLoaded = std::move(state.onLoaded);
+            state.onLoaded = nullptr;
+            onLoaded(state.texture.Get());
+        }
+    }
+
+    ResourceManager::ResourceHandle<Font> ResourceManager::GetFont(const tstring& fontName, bool fromFile)
+    {
+        const AssetId id{ fontName };
+        if (const auto it = m_Fonts.ids.find(id); it != m_Fonts.ids.end()) return ResourceHandle<Font>{ it->second };
+
         try
         {
-            m_MapFonts.try_emplace(fontName, fontName, fromFile);
-            m_MapFonts.at(fontName).HandleObserver(resourcePtr);
+            return ResourceHandle<Font>{ m_Fonts.Add(id, fontName, std::make_unique<Font>(fontName, fromFile)) };
         }
         catch (const FileException& e)
         {
             MessageBoxA(ENGINE.GetWindow(), e.what(), "ERROR", MB_OK | MB_ICONERROR);
             OutputDebugStringA(e.what());
-            m_MapFonts.erase(fontName);
-            resourcePtr = ResourcePtr<Font>{};
         }
         catch (const std::exception& e)
         {
             OutputDebugStringA(e.what());
-            m_MapFonts.erase(fontName);
-            resourcePtr = ResourcePtr<Font>{};
         }
+        return ResourceHandle<Font>{};
     }
 
     void ResourceManager::RemoveFont(const tstring& fontName)
     {
-        if (m_MapFonts.contains(fontName))
-        {
-            m_MapFonts.erase(fontName);
-        }
-        else OutputDebugString(std::format(_T("Font to remove is not present. Fontname: {}\n"), fontName).c_str());
+        if (!m_Fonts.Remove(AssetId{ fontName }))
+            OutputDebugString(std::format(_T("Font to remove is not present. Fontname: {}\n"), fontName).c_str());
     }
 
     void ResourceManager::RemoveAllFonts()
     {
-        m_MapFonts.clear();
+        m_Fonts.Clear();
     }
 
     void ResourceManager::SetCurrentFont(const Font* const pFont)
     {
         if (pFont != m_pCurrentFont)
         {
-            if (pFont == nullptr && pFont != m_pDefaultFont.pObject)
+            const Font* const pDefaultFont{ Resolve(m_DefaultFont) };
+            if (pFont == nullptr && pFont != pDefaultFont)
             {
-                m_pCurrentFont = m_pDefaultFont.pObject;
+                m_pCurrentFont = pDefaultFont;
                 OutputDebugString(_T("ERROR! New Font was 'nullptr'. Continuing with default Font!\n"));
             }
             else m_pCurrentFont = pFont;
@@ -435,8 +954,10 @@ namespace jela
 
     void ResourceManager::SetCurrentTextFormat(TextFormat* const pTextFormat)
     {
-        if (pTextFormat != m_pCurrentTextFormat)
+        // A new TextFormat can get the address of a destroyed one, which isn't subscribed anymore
+        if (pTextFormat != m_pCurrentTextFormat || !m_OnFontChange.HasObserver(pTextFormat))
         {
+            // Only compares the address, the current TextFormat may already be destroyed
             m_OnFontChange.RemoveObserver(m_pCurrentTextFormat);
 
             if (pTextFormat == nullptr && pTextFormat != m_pDefaultTextFormat.get())
@@ -0,0 +1,126 @@
+#ifndef SIMD_H
+#define SIMD_H
+
+// Thin wrapper around the 4-wide float registers of the target platform.
+// Kernels written against simd::Float4 compile to SSE2 on x86/x64, NEON on ARM
+// and plain scalar code everywhere else.
+
+#if defined(__SSE2__) || defined(_M_X64) || defined(_M_AMD64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+    #define JELA_SIMD_SSE2
+    #include <emmintrin.h>
+
+    // Functions marked with these may use newer instructions than the build targets,
+    // their callers check the CPU supports them first. MSVC allows those intrinsics anywhere.
+    #if defined(_MSC_VER) && !defined(__clang__)
+        #define JELA_TARGET_SSE41
+        #define JELA_TARGET_AVX2
+    #else
+        #define JELA_TARGET_SSE41 __attribute__((target("ssse3,sse4.1")))
+        #define JELA_TARGET_AVX2 __attribute__((target("avx2")))
+    #endif
+#elif defined(__ARM_NEON) || defined(_M_ARM64)
+    #define JELA_SIMD_NEON
+    #include <arm_neon.h>
+#endif
+
+#include <algorithm>
+
+namespace jela::simd
+{
+    inline constexpr int floatWidth{ 4 };
+
+#if defined(JELA_SIMD_SSE2)
+
+    struct Float4 { __m128 v; };
+
+    inline Float4 Load(const float* pSrc) { return { _mm_loadu_ps(pSrc) }; }
+    inline Float4 LoadAligned(const float* pSrc) { return { _mm_load_ps(pSrc) }; }
+    inline void Store(float* pDst, Float4 a) { _mm_storeu_ps(pDst, a.v); }
+    inline void StoreAligned(float* pDst, Float4 a) { _mm_store_ps(pDst, a.v); }
+    inline Float4 Set1(float value) { return { _mm_set1_ps(value) }; }
+    inline Float4 Zero() { return { _mm_setzero_ps() }; }
+
+    inline Float4 Add(Float4 a, Float4 b) { return { _mm_add_ps(a.v, b.v) }; }
+    inline Float4 Sub(Float4 a, Float4 b) { return { _mm_sub_ps(a.v, b.v) }; }
+    inline Float4 Mul(Float4 a, Float4 b) { return { _mm_mul_ps(a.v, b.v) }; }
+    inline Float4 Min(Float4 a, Float4 b) { return { _mm_min_ps(a.v, b.v) }; }
+    inline Float4 Max(Float4 a, Float4 b) { return { _mm_max_ps(a.v, b.v) }; }
+    inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return { _mm_add_ps(_mm_mul_ps(a.v, b.v), c.v) }; }
+    // a0 b0 a1 b1 and a2 b2 a3 b3
+    inline Float4 InterleaveLow(Float4 a, Float4 b) { return { _mm_unpacklo_ps(a.v, b.v) }; }
+    inline Float4 InterleaveHigh(Float4 a, Float4 b) { return { _mm_unpackhi_ps(a.v, b.v) }; }
+
+    inline float HorizontalAdd(Float4 a)
+    {
+        __m128 shuffled = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 sums = _mm_add_ps(a.v, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, sums);
+        return _mm_cvtss_f32(_mm_add_ss(sums, shuffled));
+    }
+    inline float HorizontalMin(Float4 a)
+    {
+        __m128 shuffled = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 mins = _mm_min_ps(a.v, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, mins);
+        return _mm_cvtss_f32(_mm_min_ss(mins, shuffled));
+    }
+    inline float HorizontalMax(Float4 a)
+    {
+        __m128 shuffled = _mm_shuffle_ps(a.v, a.v, _MM_SHUFFLE(2, 3, 0, 1));
+        __m128 maxs = _mm_max_ps(a.v, shuffled);
+        shuffled = _mm_movehl_ps(shuffled, maxs);
+        return _mm_cvtss_f32(_mm_max_ss(maxs, shuffled));
+    }
+
+#elif defined(JELA_SIMD_NEON)
+
+    struct Float4 { float32x4_t v; };
+
+    inline Float4 Load(const float* pSrc) { return { vld1q_f32(pSrc) }; }
+    inline Float4 LoadAligned(const float* pSrc) { return { vld1q_f32(pSrc) }; }
+    inline void Store(float* pDst, Float4 a) { vst1q_f32(pDst, a.v); }
+    inline void StoreAligned(float* pDst, Float4 a) { vst1q_f32(pDst, a.v); }
+    inline Float4 Set1(float value) { return { vdupq_n_f32(value) }; }
+    inline Float4 Zero() { return { vdupq_n_f32(0.f) }; }
+
+    inline Float4 Add(Float4 a, Float4 b) { return { vaddq_f32(a.v, b.v) }; }
+    inline Float4 Sub(Float4 a, Float4 b) { return { vsubq_f32(a.v, b.v) }; }
+    inline Float4 Mul(Float4 a, Float4 b) { return { vmulq_f32(a.v, b.v) }; }
+    inline Float4 Min(Float4 a, Float4 b) { return { vminq_f32(a.v, b.v) }; }
+    inline Float4 Max(Float4 a, Float4 b) { return { vmaxq_f32(a.v, b.v) }; }
+    inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return { vmlaq_f32(c.v, a.v, b.v) }; }
+    inline Float4 InterleaveLow(Float4 a, Float4 b) { return { vzip1q_f32(a.v, b.v) }; }
+    inline Float4 InterleaveHigh(Float4 a, Float4 b) { return { vzip2q_f32(a.v, b.v) }; }
+
+    inline float HorizontalAdd(Float4 a) { return vaddvq_f32(a.v); }
+    inline float HorizontalMin(Float4 a) { return vminvq_f32(a.v); }
+    inline float HorizontalMax(Float4 a) { return vmaxvq_f32(a.v); }
+
+#else
+
+    struct Float4 { float v[4]; };
+
+    inline Float4 Load(const float* pSrc) { return { { pSrc[0], pSrc[1], pSrc[2], pSrc[3] } }; }
+    inline Float4 LoadAligned(const float* pSrc) { return Load(pSrc); }
+    inline void Store(float* pDst, Float4 a) { std::copy(a.v, a.v + 4, pDst); }
+    inline void StoreAligned(float* pDst, Float4 a) { Store(pDst, a); }
+    inline Float4 Set1(float value) { return { { value, value, value, value } }; }
+    inline Float4 Zero() { return Set1(0.f); }
+
+    inline Float4 Add(Float4 a, Float4 b) { return { { a.v[0] + b.v[0], a.v[1] + b.v[1], a.v[2] + b.v[2], a.v[3] + b.v[3] } }; }
+    inline Float4 Sub(Float4 a, Float4 b) { return { { a.v[0] - b.v[0], a.v[1] - b.v[1], a.v[2] - b.v[2], a.v[3] - b.v[3] } }; }
+    inline Float4 Mul(Float4 a, Float4 b) { return { { a.v[0] * b.v[0], a.v[1] * b.v[1], a.v[2] * b.v[2], a.v[3] * b.v[3] } }; }
+    inline Float4 Min(Float4 a, Float4 b) { return { { std::min(a.v[0], b.v[0]), std::min(a.v[1], b.v[1]), std::min(a.v[2], b.v[2]), std::min(a.v[3], b.v[3]) } }; }
+    inline Float4 Max(Float4 a, Float4 b) { return { { std::max(a.v[0], b.v[0]), std::max(a.v[1], b.v[1]), std::max(a.v[2], b.v[2]), std::max(a.v[3], b.v[3]) } }; }
+    inline Float4 MulAdd(Float4 a, Float4 b, Float4 c) { return Add(Mul(a, b), c); }
+    inline Float4 InterleaveLow(Float4 a, Float4 b) { return { { a.v[0], b.v[0], a.v[1], b.v[1] } }; }
+    inline Float4 InterleaveHigh(Float4 a, Float4 b) { return { { a.v[2], b.v[2], a.v[3], b.v[3] } }; }
+
+    inline float HorizontalAdd(Float4 a) { return (a.v[0] + a.v[1]) + (a.v[2] + a.v[3]); }
+    inline float HorizontalMin(Float4 a) { return std::min(std::min(a.v[0], a.v[1]), std::min(a.v[2], a.v[3])); }
+    inline float HorizontalMax(Float4 a) { return std::max(std::max(a.v[0], a.v[1]), std::max(a.v[2], a.v[3])); }
+
+#endif
+}
+
+#endif // !SIMD_H
@@ -0,0 +1,652 @@
+#include "SoftwareAudio.h"
+#include "AudioLog.h"
+#include "FileExceptions.h"
+#include "MappedFile.h"
+#include "MpscQueue.h"
+#include "WaveFile.h"
+#include <algorithm>
+#include <chrono>
+#include <deque>
+#include <filesystem>
+#include <format>
+#include <map>
+#include <optional>
+#include <thread>
+
+namespace jela
+{
+    //Implementation
+    // The game thread owns the sounds and decides which voice plays what; the mixing thread only gets commands for the voices.
+    // It hands back the voices that played to their end, which are released at the start of the next call that uses voices, like XAudio's channels.
+    class SoftwareAudio::AudioImpl final
+    {
+    public:
+        AudioImpl(std::unique_ptr<AudioOutput> pOutput, const SoftwareAudioSettings& settings) :
+            m_pOutput{ std::move(pOutput) },
+            m_DataPath{ settings.dataPath },
+            m_FindPackedAsset{ settings.findPackedAsset },
+            m_Mixer{ settings.sampleRate, settings.blockFrameCount, settings.voiceCount, settings.resampler },
+            m_VoiceStates(settings.voiceCount),
+            m_InstanceCount{ std::min<uint16_t>(settings.voiceCount, UINT8_MAX + 1) },
+            m_MixerPlayCounts(settings.voiceCount)
+        {
+            m_IdleVoices.reserve(settings.voiceCount);
+            for (uint16_t voice = settings.voiceCount; voice > 0; --voice) m_IdleVoices.push_back(voice - 1);
+
+            m_pOutput->Open(settings.sampleRate, AudioMixer::m_ChannelCount);
+            // Last, once everything it uses is there
+            m_Thread = std::jthread{ [this](std::stop_token stopToken) { Run(stopToken); } };
+        }
+
+        ~AudioImpl() = default;
+
+        AudioImpl(const AudioImpl&) = delete;
+        AudioImpl(AudioImpl&&) noexcept = delete;
+        AudioImpl& operator=(const AudioImpl&) = delete;
+        AudioImpl& operator=(AudioImpl&&) noexcept = delete;
+
+        void AddSoundImpl(const tstring& filename, SoundID id)
+        {
+            if (m_Sounds.contains(id))
+                audio::Log(audio::LogLevel::Warning, std::format("\nSoundID {} bound to file {} was already added.\n\n", id, std::filesystem::path{ filename }.string()));
+            else
+            {
+                try
+                {
+                    m_Sounds.try_emplace(id, filename, LoadSound(filename), m_InstanceCount);
+                }
+                catch (const FileException& e)
+                {
+                    audio::Log(audio::LogLevel::Error, e.what());
+                }
+                catch (const std::exception& e)
+                {
+                    audio::Log(audio::LogLevel::Warning, e.what());
+                }
+            }
+        }
+
+        void RemoveSoundImpl(SoundID id)
+        {
+            ReleaseEndedVoices();
+            if (const auto itSound = m_Sounds.find(id); itSound != m_Sounds.end())
+            {
+                StopVoices(itSound->second);
+                RetireSound(std::move(itSound->second.pData));
+                m_Sounds.erase(itSound);
+            }
+        }
+
+        void ReloadSoundImpl(const tstring& filename)
+        {
+            ReleaseEndedVoices();
+            const std::filesystem::path filePath{ std::filesystem::path{ filename }.lexically_normal() };
+            for (auto& [soundId, sound] : m_Sounds)
+            {
+                if (std::filesystem::path{ sound.fileName }.lexically_normal() != filePath) continue;
+
+                // Loaded next to the old sound, which stays when the new file can't be read
+                std::shared_ptr<const MixerSound> pData{};
+                try
+                {
+                    pData = LoadSound(sound.fileName);
+                }
+                catch (const std::exception& e)
+                {
+                    audio::Log(audio::LogLevel::Warning, e.what());
+                    continue;
+                }
+
+                StopVoices(sound);
+                RetireSound(std::move(sound.pData));
+                sound.pData = std::move(pData);
+            }
+        }
+
+        void PlaySoundInstanceImpl(SoundID id, bool repeat, uint8_t volume, SoundInstanceID& instanceId, float frequency)
+        {
+            if (const auto itSound = m_Sounds.find(id); itSound != m_Sounds.end())
+                PlaySound(itSound->second, repeat, volume / 100.f, frequency, instanceId);
+            else
+                audio::Log(audio::LogLevel::Warning, std::format("Sound file with id {} was not added before trying to play the sound.\n", id));
+        }
+
+        void PlaySoundClipImpl(SoundID id, bool repeat, uint8_t volume, float frequency)
+        {
+            SoundInstanceID instanceId{};
+            PlaySoundInstanceImpl(id, repeat, volume, instanceId, frequency);
+        }
+
+        uint8_t GetMasterVolumeImpl() const
+        {
+            return m_IsMute ? 0 : m_LatestVolume;
+        }
+
+        void SetMasterVolumeImpl(uint8_t newVolume)
+        {
+            m_IsMute = false;
+            m_LatestVolume = newVolume;
+            m_MasterGain.store(newVolume / 100.f, std::memory_order_relaxed);
+        }
+
+        void IncrementMasterVolumeImpl()
+        {
+            if (const uint8_t vol = GetMasterVolumeImpl(); vol < UINT8_MAX)
+                SetMasterVolumeImpl(vol + 1);
+        }
+
+        void DecrementMasterVolumeImpl()
+        {
+            if (const uint8_t vol = GetMasterVolumeImpl(); vol > 0)
+                SetMasterVolumeImpl(vol - 1);
+        }
+
+        void ToggleMuteImpl()
+        {
+            m_IsMute = !m_IsMute;
+            m_MasterGain.store(m_IsMute ? 0.f : m_LatestVolume / 100.f, std::memory_order_relaxed);
+        }
+
+        void PauseSoundImpl(SoundID id)
+        {
+            ReleaseEndedVoices();
+            if (const auto itSound = m_Sounds.find(id); itSound != m_Sounds.end())
+                SendToVoices(itSound->second, CommandType::Pause);
+            else
+                audio::Log(audio::LogLevel::Warning, std::format("Sound file with id {} was not added before trying to pause the sound.\n", id));
+        }
+
+        void PauseSoundImpl(SoundID id, const SoundInstanceID& instanceId)
+        {
+            ReleaseEndedVoices();
+            if (const auto itSound = m_Sounds.find(id); itSound != m_Sounds.end())
+            {
+                if (const uint16_t voice{ GetVoice(itSound->second, instanceId) }; voice != m_NoVoice)
+                    PushCommand(Command{ CommandType::Pause, voice });
+            }
+            else
+                audio::Log(audio::LogLevel::Warning, std::format("Sound file with id {} was not added before trying to pause an instance.\n", id));
+        }
+
+        void PauseAllSoundsImpl()
+        {
+            ReleaseEndedVoices();
+            for (auto& [soundId, sound] : m_Sounds) SendToVoices(sound, CommandType::Pause);
+        }
+
+        void ResumeSoundImpl(SoundID id)
+        {
+            ReleaseEndedVoices();
+            if (const auto itSound = m_Sounds.find(id); itSound != m_Sounds.end())
+                SendToVoices(itSound->second, CommandType::Resume);
+            else
+                audio::Log(audio::LogLevel::Warning, std::format("Sound file with id {} was not added before trying to resume the sound.\n", id));
+        }
+
+        void ResumeSoundImpl(SoundID id, const SoundInstanceID& instanceId)
+        {
+            ReleaseEndedVoices();
+            if (const auto itSound = m_Sounds.find(id); itSound != m_Sounds.end())
+            {
+                if (const uint16_t voice{ GetVoice(itSound->second, instanceId) }; voice != m_NoVoice)
+                    PushCommand(Command{ CommandType::Resume, voice });
+            }
+            else
+                audio::Log(audio::LogLevel::Warning, std::format("Sound file with id {} was not added before trying to resume an instance.\n", id));
+        }
+
+        void ResumeAllSoundsImpl()
+        {
+            ReleaseEndedVoices();
+            for (auto& [soundId, sound] : m_Sounds) SendToVoices(sound, CommandType::Resume);
+        }
+
+        void StopSoundImpl(SoundID id)
+        {
+            ReleaseEndedVoices();
+            if (const auto itSound = m_Sounds.find(id); itSound != m_Sounds.end())
+                StopVoices(itSound->second);
+            else
+                audio::Log(audio::LogLevel::Warning, std::format("Sound file with id {} was not added before trying to stop the sound.\n", id));
+        }
+
+        void StopSoundImpl(SoundID id, const SoundInstanceID& instanceId)
+        {
+            ReleaseEndedVoices();
+            if (const auto itSound = m_Sounds.find(id); itSound != m_Sounds.end())
+            {
+                if (const uint16_t voice{ GetVoice(itSound->second, instanceId) }; voice != m_NoVoice)
+                    StopVoice(voice);
+            }
+            else
+                audio::Log(audio::LogLevel::Warning, std::format("Sound file with id {} was not added before trying to stop an instance.\n", id));
+        }
+
+        void StopAllSoundsImpl()
+        {
+            ReleaseEndedVoices();
+            for (auto& [soundId, sound] : m_Sounds) StopVoices(sound);
+        }
+
+        void SeekSoundImpl(SoundID id, const SoundInstanceID& instanceId, float seconds)
+        {
+            ReleaseEndedVoices();
+            if (const auto itSound = m_Sounds.find(id); itSound != m_Sounds.end())
+            {
+                if (const uint16_t voice{ GetVoice(itSound->second, instanceId) }; voice != m_NoVoice)
+                {
+                    Command command{ CommandType::Seek, voice };
+                    command.frame = static_cast<uint64_t>(std::max(seconds, 0.f) * itSound->second.pData->GetSampleRate());
+                    PushCommand(command);
+                }
+            }
+            else
+                audio::Log(audio::LogLevel::Warning, std::format("Sound file with id {} was not added before trying to seek an instance.\n", id));
+        }
+
+        // Frees the voices of sounds that ended, even when nothing else gets called
+        void UpdateImpl()
+        {
+            ReleaseEndedVoices();
+        }
+
+    private:
+        static constexpr uint16_t m_NoVoice{ UINT16_MAX };
+
+        struct Sound final
+        {
+            Sound(const tstring& fileName, std::shared_ptr<const MixerSound> pData, uint16_t instanceCount) :
+                fileName{ fileName },
+                pData{ std::move(pData) },
+                instanceVoices(instanceCount, m_NoVoice)
+            {
+            }
+
+            tstring fileName;
+            std::shared_ptr<const MixerSound> pData;
+            // The voice every instance plays on, the index is the instance's ID
+            std::vector<uint16_t> instanceVoices;
+            std::unique_ptr<Subject<uint8_t>> pOnVoiceRelease{ std::make_unique<Subject<uint8_t>>() };
+        };
+
+        // What the game thread knows of a voice; playCount tells which Play a voice that ended belongs to
+        struct VoiceState
+        {
+            Sound* pSound{};
+            uint8_t instance{};
+            uint32_t playCount{};
+        };
+
+        enum class CommandType : uint8_t
+        {
+            Play,
+            Stop,
+            Pause,
+            Resume,
+            Seek
+        };
+
+        struct Command
+        {
+            CommandType type{};
+            uint16_t voice{};
+            uint32_t playCount{};
+            const MixerSound* pSound{};
+            bool isLooping{};
+            float volume{};
+            float frequency{};
+            uint64_t frame{};
+        };
+
+        struct EndedVoice
+        {
+            uint16_t voice;
+            uint32_t playCount;
+        };
+
+        std::shared_ptr<const MixerSound> LoadSound(const tstring& fileName) const
+        {
+            const std::filesystem::path filePath{ m_DataPath + fileName };
+            const std::span<const std::byte> packedData{ m_FindPackedAsset ? m_FindPackedAsset(fileName) : std::span<const std::byte>{} };
+
+            if (packedData.empty() && !std::filesystem::exists(filePath))
+                throw FileNotFoundException{ std::format("File path {} could not be found. Error occurred when trying to add a sound file.", filePath.string()) };
+
+            // Decoded straight from the pack or the mapped file, which is closed again after
+            std::optional<MappedFile> mappedFile{};
+            if (packedData.empty()) mappedFile.emplace(filePath);
+            const WaveFile waveFile{ packedData.empty() ? mappedFile->GetData() : packedData };
+            auto pSound{ std::make_shared<const MixerSound>(waveFile) };
+
+            audio::Log(audio::LogLevel::Info, std::format("Audio File {} was successfully loaded! {} channel(s) at {} Hz, {} frames.\n",
+                                                          std::filesystem::path{ fileName }.string(), pSound->GetChannelCount(), pSound->GetSampleRate(), pSound->GetFrameCount()));
+            return pSound;
+        }
+
+        void PlaySound(Sound& sound, bool repeat, float volume, float frequency, SoundInstanceID& instanceId)
+        {
+            ReleaseEndedVoices();
+            if (m_IdleVoices.empty())
+            {
+                audio::Log(audio::LogLevel::Warning, std::format("WARNING! When trying to play {}, no voices were available.\n", std::filesystem::path{ sound.fileName }.string()));
+                return;
+            }
+            const auto itInstance{ std::ranges::find(sound.instanceVoices, m_NoVoice) };
+            if (itInstance == sound.instanceVoices.end())
+            {
+                audio::Log(audio::LogLevel::Warning, std::format("WARNING! When trying to play {}, it already played {} instances.\n", std::filesystem::path{ sound.fileName }.string(), sound.instanceVoices.size()));
+                return;
+            }
+
+            const uint16_t voice{ m_IdleVoices.back() };
+            VoiceState& state{ m_VoiceStates[voice] };
+
+            Command command{ CommandType::Play, voice, state.playCount + 1, sound.pData.get() };
+            command.isLooping = repeat;
+            command.volume = volume;
+            command.frequency = frequency;
+            // Dropped, the voice stays idle
+            if (!PushCommand(command)) return;
+
+            m_IdleVoices.pop_back();
+            *itInstance = voice;
+            state.pSound = &sound;
+            state.instance = static_cast<uint8_t>(itInstance - sound.instanceVoices.begin());
+            ++state.playCount;
+            instanceId.Init(state.instance, sound.pOnVoiceRelease.get());
+        }
+
+        uint16_t GetVoice(const Sound& sound, const SoundInstanceID& instanceId) const
+        {
+            if (!instanceId.GetID().has_value() || instanceId.GetID().value() >= sound.instanceVoices.size()) return m_NoVoice;
+            return sound.instanceVoices[instanceId.GetID().value()];
+        }
+
+        void SendToVoices(const Sound& sound, CommandType type)
+        {
+            for (const uint16_t voice : sound.instanceVoices)
+            {
+                if (voice != m_NoVoice) PushCommand(Command{ type, voice });
+            }
+        }
+
+        void StopVoices(const Sound& sound)
+        {
+            for (const uint16_t voice : sound.instanceVoices)
+            {
+                if (voice != m_NoVoice) StopVoice(voice);
+            }
+        }
+
+        void StopVoice(uint16_t voice)
+        {
+            PushCommand(Command{ CommandType::Stop, voice });
+            ReleaseVoice(voice);
+        }
+
+        void ReleaseVoice(uint16_t voice)
+        {
+            VoiceState& state{ m_VoiceStates[voice] };
+            Sound& sound{ *state.pSound };
+            sound.instanceVoices[state.instance] = m_NoVoice;
+            state.pSound = nullptr;
+            m_IdleVoices.push_back(voice);
+            // The instance IDs of this voice unsubscribe themselves
+            sound.pOnVoiceRelease->NotifyObservers(state.instance);
+        }
+
+        void ReleaseEndedVoices()
+        {
+            PushOverflowedCommands();
+
+            EndedVoice endedVoice{};
+            while (m_EndedVoices.TryPop(endedVoice))
+            {
+                // The voice was stopped, and maybe played again, since this was pushed
+                const VoiceState& state{ m_VoiceStates[endedVoice.voice] };
+                if (state.pSound && state.playCount == endedVoice.playCount) ReleaseVoice(endedVoice.voice);
+            }
+
+            const uint64_t appliedCount{ m_AppliedCommandCount.load(std::memory_order_acquire) };
+            std::erase_if(m_RetiredSounds, [appliedCount](const auto& retiredSound) { return retiredSound.first <= appliedCount; });
+        }
+
+        // The voices that played the sound are stopped by now, but the mixing thread may not have seen that yet.
+        // So the sound is only freed once it applied every command sent so far.
+        void RetireSound(std::shared_ptr<const MixerSound> pData)
+        {
+            m_RetiredSounds.emplace_back(m_PushedCommandCount, std::move(pData));
+        }
+
+        // The mixing thread empties the queue every block, so it only fills up when more commands than fit come within one.
+        // Then the command is dropped with a warning rather than waiting on the game thread, unless it is a Stop: a voice that isn't
+        // stopped could play forever. Stops wait in m_OverflowedCommands instead. Returns false when the command was dropped.
+        bool PushCommand(const Command& command)
+        {
+            // What overflowed goes first, to keep the order
+            PushOverflowedCommands();
+            if (!m_OverflowedCommands.empty() || !m_Commands.TryPush(command))
+            {
+                if (command.type != CommandType::Stop)
+                {
+                    audio::Log(audio::LogLevel::Warning, std::format("WARNING! The audio command queue is full, dropped a command for voice {}.\n", command.voice));
+                    return false;
+                }
+                m_OverflowedCommands.push_back(command);
+            }
+            // Counted in the order the mixing thread applies them, overflowed or not
+            ++m_PushedCommandCount;
+            return true;
+        }
+
+        void PushOverflowedCommands()
+        {
+            while (!m_OverflowedCommands.empty() && m_Commands.TryPush(m_OverflowedCommands.front())) m_OverflowedCommands.pop_front();
+        }
+
+        // Mixing thread
+        void Run(std::stop_token stopToken)
+        {
+            using Clock = std::chrono::steady_clock;
+            const auto blockDuration{ std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{ static_cast<double>(m_Mixer.GetBlockFrameCount()) / m_Mixer.GetSampleRate() }) };
+            Clock::time_point blockTime{ Clock::now() };
+
+            while (!stopToken.stop_requested())
+            {
+                ApplyCommands();
+                m_Mixer.SetMasterGain(m_MasterGain.load(std::memory_order_relaxed));
+                const std::span<const float> block{ m_Mixer.Mix() };
+
+                for (const uint16_t voice : m_Mixer.GetEndedVoices())
+                {
+                    if (!m_EndedVoices.TryPush(EndedVoice{ voice, m_MixerPlayCounts[voice] }))
+                        audio::Log(audio::LogLevel::Warning, "WARNING! Too many voices ended at once, one stays in use until it is stopped.\n");
+                }
+
+                m_pOutput->Write(block, stopToken);
+                if (m_pOutput->IsPaced()) continue;
+
+                // Keeps to the clock, but starts over rather than rushing to catch up when it fell far behind, like after a breakpoint
+                blockTime += blockDuration;
+                const Clock::time_point now{ Clock::now() };
+                if (now - blockTime > m_MaxLagBlockCount * blockDuration) blockTime = now;
+                else std::this_thread::sleep_until(blockTime);
+            }
+        }
+
+        // Mixing thread
+        void ApplyCommands()
+        {
+            Command command{};
+            while (m_Commands.TryPop(command))
+            {
+                switch (command.type)
+                {
+                case CommandType::Play:
+                    m_MixerPlayCounts[command.voice] = command.playCount;
+                    m_Mixer.Play(command.voice, command.pSound, command.isLooping, command.volume, command.frequency);
+                    break;
+                case CommandType::Stop: m_Mixer.Stop(command.voice); break;
+                case CommandType::Pause: m_Mixer.Pause(command.voice); break;
+                case CommandType::Resume: m_Mixer.Resume(command.voice); break;
+                case CommandType::Seek: m_Mixer.Seek(command.voice, command.frame); break;
+                }
+                ++m_AppliedCommandCountLocal;
+            }
+            m_AppliedCommandCount.store(m_AppliedCommandCountLocal, std::memory_order_release);
+        }
+
+        static constexpr int m_MaxLagBlockCount{ 4 };
+
+        std::unique_ptr<AudioOutput> m_pOutput;
+        const tstring m_DataPath;
+        const SoftwareAudioSettings::PackedAssetFinder m_FindPackedAsset;
+        // Only used by the mixing thread once it runs
+        AudioMixer m_Mixer;
+
+        // Game thread
+        std::map<SoundID, Sound> m_Sounds{};
+        std::vector<VoiceState> m_VoiceStates;
+        std::vector<uint16_t> m_IdleVoices{};
+        // Instances a sound can play at once, as many as fit a SoundInstanceID
+        const uint16_t m_InstanceCount;
+        // With the number of commands pushed when they were retired
+        std::vector<std::pair<uint64_t, std::shared_ptr<const MixerSound>>> m_RetiredSounds{};
+        uint64_t m_PushedCommandCount{};
+        // Stops that didn't fit in the queue. Plays are dropped while it holds any, and a voice is only stopped once
+        // per Play, so there are never more than there are voices.
+        std::deque<Command> m_OverflowedCommands{};
+        bool m_IsMute{ false };
+        uint8_t m_LatestVolume{ 100 };
+
+        // Mixing thread
+        std::vector<uint32_t> m_MixerPlayCounts;
+        uint64_t m_AppliedCommandCountLocal{};
+
+        // Shared
+        MpscQueue<Command, 1024> m_Commands{};
+        MpscQueue<EndedVoice, 1024> m_EndedVoices{};
+        std::atomic<uint64_t> m_AppliedCommandCount{};
+        std::atomic<float> m_MasterGain{ 1.f };
+
+        // Last, so it stops before the rest is destroyed
+        std::jthread m_Thread{};
+    };
+
+
+    //Audio
+    SoftwareAudio::SoftwareAudio(std::unique_ptr<AudioOutput> pOutput, const SoftwareAudioSettings& settings) :
+        m_pImpl{ new AudioImpl{ std::move(pOutput), settings } }
+    {
+    }
+
+    SoftwareAudio::~SoftwareAudio()
+    {
+        delete m_pImpl;
+    }
+
+    void SoftwareAudio::AddSound(const tstring& filename, SoundID id, bool)
+    {
+        m_pImpl->AddSoundImpl(filename, id);
+    }
+
+    void SoftwareAudio::RemoveSound(SoundID id)
+    {
+        m_pImpl->RemoveSoundImpl(id);
+    }
+
+    void SoftwareAudio::ReloadSound(const tstring& filename)
+    {
+        m_pImpl->ReloadSoundImpl(filename);
+    }
+
+    void SoftwareAudio::PlaySoundClip(SoundID id, bool repeat, uint8_t volume, float frequency, uint8_t) const
+    {
+        m_pImpl->PlaySoundClipImpl(id, repeat, volume, frequency);
+    }
+
+    void SoftwareAudio::PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume, float frequency, uint8_t) const
+    {
+        m_pImpl->PlaySoundInstanceImpl(id, repeat, volume, instanceId, frequency);
+    }
+
+    uint8_t SoftwareAudio::GetMasterVolume() const
+    {
+        return m_pImpl->GetMasterVolumeImpl();
+    }
+
+    void SoftwareAudio::SetMasterVolume(uint8_t newVolume)
+    {
+        m_pImpl->SetMasterVolumeImpl(newVolume);
+    }
+
+    void SoftwareAudio::IncrementMasterVolume()
+    {
+        m_pImpl->IncrementMasterVolumeImpl();
+    }
+
+    void SoftwareAudio::DecrementMasterVolume()
+    {
+        m_pImpl->DecrementMasterVolumeImpl();
+    }
+
+    void SoftwareAudio::ToggleMute()
+    {
+        m_pImpl->ToggleMuteImpl();
+    }
+
+    void SoftwareAudio::PauseSound(SoundID id) const
+    {
+        m_pImpl->PauseSoundImpl(id);
+    }
+
+    void SoftwareAudio::PauseSound(SoundID id, const SoundInstanceID& instanceId) const
+    {
+        m_pImpl->PauseSoundImpl(id, instanceId);
+    }
+
+    void SoftwareAudio::PauseAllSounds() const
+    {
+        m_pImpl->PauseAllSoundsImpl();
+    }
+
+    void SoftwareAudio::ResumeSound(SoundID id) const
+    {
+        m_pImpl->ResumeSoundImpl(id);
+    }
+
+    void SoftwareAudio::ResumeSound(SoundID id, const SoundInstanceID& instanceId) const
+    {
+        m_pImpl->ResumeSoundImpl(id, instanceId);
+    }
+
+    void SoftwareAudio::ResumeAllSounds() const
+    {
+        m_pImpl->ResumeAllSoundsImpl();
+    }
+
+    void SoftwareAudio::StopSound(SoundID id) const
+    {
+        m_pImpl->StopSoundImpl(id);
+    }
+
+    void SoftwareAudio::StopSound(SoundID id, const SoundInstanceID& instanceId) const
+    {
+        m_pImpl->StopSoundImpl(id, instanceId);
+    }
+
+    void SoftwareAudio::StopAllSounds() const
+    {
+        m_pImpl->StopAllSoundsImpl();
+    }
+
+    void SoftwareAudio::SeekSound(SoundID id, const SoundInstanceID& instanceId, float seconds) const
+    {
+        m_pImpl->SeekSoundImpl(id, instanceId, seconds);
+    }
+
+    void SoftwareAudio::Update()
+    {
+        m_pImpl->UpdateImpl();
+    }
+}
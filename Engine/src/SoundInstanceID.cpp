@@ -0,0 +1,73 @@
+#include "SoundInstanceID.h"
+#include "AudioLog.h"
+
+namespace jela
+{
+	//------------------------------------------------------------------------------------------------------------------------------
+	// SoundInstanceID
+	SoundInstanceID::SoundInstanceID(const SoundInstanceID& other)
+        : Observer<uint8_t>{}
+          , m_Id{other.m_Id}
+    {
+        if (other.GetSubject()) other.GetSubject()->AddObserver(this);
+    }
+
+	SoundInstanceID::SoundInstanceID(SoundInstanceID&& other) noexcept
+        : Observer<uint8_t>{}
+          , m_Id{std::move(other.m_Id)}
+	{
+		if (other.GetSubject()) other.GetSubject()->AddObserver(this);
+
+		other.Unsubscribe();
+        other.m_Id = std::nullopt;
+	}
+
+	SoundInstanceID& SoundInstanceID::operator= (const SoundInstanceID& other)
+	{
+		if (&other == this) return *this;
+
+		m_Id = other.m_Id;
+		Unsubscribe();
+		if (other.GetSubject()) other.GetSubject()->AddObserver(this);
+
+		return *this;
+	}
+
+	SoundInstanceID& SoundInstanceID::operator= (SoundInstanceID&& other) noexcept
+	{
+		if (&other == this) return *this;
+
+        m_Id = std::move(other.m_Id);
+		Unsubscribe();
+		if (other.GetSubject()) other.GetSubject()->AddObserver(this);
+
+		other.Unsubscribe();
+		other.m_Id = std::nullopt;
+
+		return *this;
+    }
+
+    void SoundInstanceID::Init(uint8_t index, Subject<uint8_t>* pOnChannelRelease)
+	{
+		if (m_Id.has_value()) audio::Log(audio::LogLevel::Warning, "SoundInstanceID was already initialized when trying to initialize.\n");
+		else
+		{
+			m_Id = index;
+			pOnChannelRelease->AddObserver(this);
+		}
+	}
+
+	void SoundInstanceID::Notify(uint8_t index)
+    {
+        if (m_Id.has_value() && m_Id.value() == index)
+		{
+			m_Id = std::nullopt;
+			Unsubscribe();
+		}
+	}
+	void SoundInstanceID::OnSubjectDestroy(Subject<uint8_t>*)
+	{
+		m_Id = std::nullopt;
+	}
+	//------------------------------------------------------------------------------------------------------------------------------
+}
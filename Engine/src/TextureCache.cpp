@@ -0,0 +1,320 @@
+#include "TextureCache.h"
+#include "FileExceptions.h"
+#include <array>
+#include <bit>
+#include <cstring>
+#include <fstream>
+#include <thread>
+
+namespace jela
+{
+    static_assert(std::endian::native == std::endian::little, "Texture cache files are read in place and stored little-endian.");
+    static_assert(sizeof(texturecache::Header) % 16 == 0);
+
+    namespace
+    {
+        constexpr std::size_t lz4MinMatch{ 4 };
+        // The block format ends with at least this many literals, and its last match starts at least 12 bytes before the end
+        constexpr std::size_t lz4LastLiterals{ 5 };
+        constexpr std::size_t lz4MatchSearchLimit{ 12 };
+        constexpr std::size_t lz4MaxOffset{ 65535 };
+        constexpr int lz4HashBits{ 16 };
+
+        uint32_t Read32(const uint8_t* pData)
+        {
+            uint32_t value{};
+            std::memcpy(&value, pData, sizeof(value));
+            return value;
+        }
+
+        void WriteLength(std::vector<uint8_t>& output, std::size_t length)
+        {
+            for (; length >= 255; length -= 255) output.emplace_back(uint8_t{ 255 });
+            output.emplace_back(static_cast<uint8_t>(length));
+        }
+
+        void WriteSequence(std::vector<uint8_t>& output, std::span<const uint8_t> literals, std::size_t offset, std::size_t matchLength)
+        {
+            // A block without a match, the last one, ends after the literals
+            const std::size_t matchCode{ matchLength > 0 ? matchLength - lz4MinMatch : 0 };
+            output.emplace_back(static_cast<uint8_t>((std::min<std::size_t>(literals.size(), 15) << 4) | std::min<std::size_t>(matchCode, 15)));
+
+            if (literals.size() >= 15) WriteLength(output, literals.size() - 15);
+            output.insert(output.end(), literals.begin(), literals.end());
+
+            if (matchLength == 0) return;
+
+            output.emplace_back(static_cast<uint8_t>(offset & 0xFF));
+            output.emplace_back(static_cast<uint8_t>(offset >> 8));
+            if (matchCode >= 15) WriteLength(output, matchCode - 15);
+        }
+
+        // False when the length runs past the end of the source
+        bool ReadLength(std::span<const uint8_t> source, std::size_t& position, std::size_t& length)
+        {
+            uint8_t byte{};
+            do
+            {
+                if (position >= source.size()) return false;
+                byte = source[position++];
+                length += byte;
+            } while (byte == 255);
+            return true;
+        }
+
+        // FNV-1a, continued from hash
+        uint64_t HashBytes(uint64_t hash, std::span<const std::byte> bytes)
+        {
+            for (const std::byte byte : bytes)
+            {
+                hash ^= static_cast<uint8_t>(byte);
+                hash *= 1099511628211ull;
+            }
+            return hash;
+        }
+    }
+
+    namespace utils
+    {
+        std::vector<uint8_t> CompressLz4(std::span<const uint8_t> data)
+        {
+            std::vector<uint8_t> output{};
+            output.reserve(data.size() / 2 + 16);
+
+            // Last position every hash of 4 bytes was seen at
+            std::vector<uint32_t> table(std::size_t{ 1 } << lz4HashBits);
+
+            std::size_t anchor{};
+            std::size_t position{};
+            while (data.size() >= lz4MatchSearchLimit && position <= data.size() - lz4MatchSearchLimit)
+            {
+                const uint32_t sequence{ Read32(data.data() + position) };
+                uint32_t& tableEntry{ table[(sequence * 2654435761u) >> (32 - lz4HashBits)] };
+                const std::size_t candidate{ tableEntry };
+                tableEntry = static_cast<uint32_t>(position);
+
+                if (candidate >= position || position - candidate > lz4MaxOffset || Read32(data.data() + candidate) != sequence)
+                {
+                    ++position;
+                    continue;
+                }
+
+                std::size_t matchLength{ lz4MinMatch };
+                const std::size_t matchLimit{ data.size() - lz4LastLiterals - position };
+                while (matchLength < matchLimit && data[candidate + matchLength] == data[position + matchLength]) ++matchLength;
+
+                WriteSequence(output, data.subspan(anchor, position - anchor), position - candidate, matchLength);
+                position += matchLength;
+                anchor = position;
+            }
+
+            WriteSequence(output, data.subspan(anchor), 0, 0);
+            return output;
+        }
+
+        bool DecompressLz4(std::span<const uint8_t> source, std::span<uint8_t> destination)
+        {
+            std::size_t sourcePosition{};
+            std::size_t destinationPosition{};
+
+            while (sourcePosition < source.size())
+            {
+                const uint8_t token{ source[sourcePosition++] };
+
+                std::size_t literalLength{ static_cast<std::size_t>(token >> 4) };
+                if (literalLength == 15 && !ReadLength(source, sourcePosition, literalLength)) return false;
+                if (literalLength > source.size() - sourcePosition || literalLength > destination.size() - destinationPosition) return false;
+
+                std::memcpy(destination.data() + destinationPosition, source.data() + sourcePosition, literalLength);
+                sourcePosition += literalLength;
+                destinationPosition += literalLength;
+
+                if (sourcePosition == source.size()) break;
+
+                if (source.size() - sourcePosition < 2) return false;
+                const std::size_t offset{ source[sourcePosition] | (static_cast<std::size_t>(source[sourcePosition + 1]) << 8) };
+                sourcePosition += 2;
+                if (offset == 0 || offset > destinationPosition) return false;
+
+                std::size_t matchLength{ static_cast<std::size_t>(token & 0x0F) };
+                if (matchLength == 15 && !ReadLength(source, sourcePosition, matchLength)) return false;
+                matchLength += lz4MinMatch;
+                if (matchLength > destination.size() - destinationPosition) return false;
+
+                // A match may overlap the bytes it produces, copying a chunk of offset bytes at a time repeats the pattern
+                uint8_t* const pOutput{ destination.data() + destinationPosition };
+                const uint8_t* const pMatch{ pOutput - offset };
+                for (std::size_t copied = 0; copied < matchLength;)
+                {
+                    const std::size_t chunk{ std::min(offset, matchLength - copied) };
+                    std::memcpy(pOutput + copied, pMatch + copied, chunk);
+                    copied += chunk;
+                }
+                destinationPosition += matchLength;
+            }
+
+            return destinationPosition == destination.size();
+        }
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------------------
+    //---------------------
+    //TextureCache
+    //---------------------
+
+    TextureCache::TextureCache(const std::filesystem::path& directory, bool isCompressed) :
+        m_Directory{ directory },
+        m_IsCompressed{ isCompressed }
+    {
+        std::error_code error{};
+        std::filesystem::create_directories(m_Directory, error);
+        if (error || !std::filesystem::is_directory(m_Directory))
+            throw FileLoadException{ std::format("Texture cache directory \"{}\" could not be created.\n", m_Directory.string()) };
+    }
+
+    uint64_t TextureCache::MakeKey(std::string_view name, const std::filesystem::path& sourceFile)
+    {
+        std::error_code error{};
+        const int64_t lastWriteTime{ static_cast<int64_t>(std::filesystem::last_write_time(sourceFile, error).time_since_epoch().count()) };
+        if (error) return 0;
+        const uint64_t size{ std::filesystem::file_size(sourceFile, error) };
+        if (error) return 0;
+
+        const std::u8string sourcePath{ sourceFile.lexically_normal().generic_u8string() };
+        // Keeps "a" + "bc" apart from "ab" + "c"
+        const std::array<std::byte, 1> separator{};
+
+        uint64_t key{ 14695981039346656037ull };
+        key = HashBytes(key, std::as_bytes(std::span{ sourcePath }));
+        key = HashBytes(key, separator);
+        key = HashBytes(key, std::as_bytes(std::span{ name }));
+        key = HashBytes(key, std::as_bytes(std::span{ &lastWriteTime, 1 }));
+        key = HashBytes(key, std::as_bytes(std::span{ &size, 1 }));
+        return key != 0 ? key : 1;
+    }
+
+    std::optional<DecodedImage> TextureCache::Find(uint64_t key) const
+    {
+        if (key == 0) return std::nullopt;
+
+        const std::filesystem::path entryPath{ GetEntryPath(key) };
+        std::error_code error{};
+        if (!std::filesystem::exists(entryPath, error))
+        {
+            ++m_MissCount;
+            return std::nullopt;
+        }
+
+        std::shared_ptr<const MappedFile> pFile{};
+        try
+        {
+            pFile = std::make_shared<const MappedFile>(entryPath);
+        }
+        catch (const FileException&)
+        {
+            ++m_MissCount;
+            return std::nullopt;
+        }
+
+        const std::span<const std::byte> data{ pFile->GetData() };
+        texturecache::Header header{};
+        if (data.size() >= sizeof(header)) std::memcpy(&header, data.data(), sizeof(header));
+
+        const uint64_t pixelsSize{ uint64_t{ header.width } * header.height * 4 };
+        const bool isValid{ data.size() >= sizeof(header) &&
+                            header.magic == texturecache::magic && header.version == texturecache::version && header.key == key &&
+                            header.pixelsSize == pixelsSize && header.storedSize == data.size() - sizeof(header) &&
+                            (header.compression == texturecache::Compression::Lz4 ||
+                             (header.compression == texturecache::Compression::None && header.storedSize == pixelsSize)) };
+        if (!isValid)
+        {
+            ++m_MissCount;
+            return std::nullopt;
+        }
+
+        DecodedImage image{ header.width, header.height };
+        const std::span<const uint8_t> storedPixels{ reinterpret_cast<const uint8_t*>(data.data() + sizeof(header)),
+                                                     static_cast<std::size_t>(header.storedSize) };
+
+        if (header.compression == texturecache::Compression::None)
+        {
+            image.mappedPixels = storedPixels;
+            image.pMappedFile = std::move(pFile);
+        }
+        else
+        {
+            image.pixels.resize(static_cast<std::size_t>(pixelsSize));
+            if (!utils::DecompressLz4(storedPixels, image.pixels))
+            {
+                ++m_MissCount;
+                return std::nullopt;
+            }
+        }
+
+        ++m_HitCount;
+        return image;
+    }
+
+    bool TextureCache::Store(uint64_t key, const DecodedImage& image) const
+    {
+        if (key == 0) return false;
+
+        const std::span<const uint8_t> pixels{ image.GetPixels() };
+        std::vector<uint8_t> compressedPixels{};
+        if (m_IsCompressed) compressedPixels = utils::CompressLz4(pixels);
+
+        // Images that don't shrink are stored raw, those at least load in place
+        const bool isCompressed{ m_IsCompressed && compressedPixels.size() < pixels.size() };
+        const std::span<const uint8_t> storedPixels{ isCompressed ? std::span<const uint8_t>{ compressedPixels } : pixels };
+
+        const texturecache::Header header{
+            texturecache::magic, texturecache::version, key, image.width, image.height,
+            isCompressed ? texturecache::Compression::Lz4 : texturecache::Compression::None, 0,
+            pixels.size(), storedPixels.size()
+        };
+
+        const std::filesystem::path entryPath{ GetEntryPath(key) };
+        // Two threads could store the same image at once
+        std::filesystem::path temporaryPath{ entryPath };
+        temporaryPath += std::format(".{:x}.tmp", std::hash<std::thread::id>{}(std::this_thread::get_id()));
+
+        std::error_code error{};
+        {
+            std::ofstream output{ temporaryPath, std::ios_base::binary | std::ios_base::trunc };
+            if (!output.is_open()) return false;
+
+            output.write(reinterpret_cast<const char*>(&header), sizeof(header));
+            output.write(reinterpret_cast<const char*>(storedPixels.data()), static_cast<std::streamsize>(storedPixels.size()));
+            if (!output.flush())
+            {
+                output.close();
+                std::filesystem::remove(temporaryPath, error);
+                return false;
+            }
+        }
+
+        // Fails when another thread or process has the entry mapped, which then already holds the same image
+        std::filesystem::rename(temporaryPath, entryPath, error);
+        if (!error) return true;
+
+        std::filesystem::remove(temporaryPath, error);
+        return false;
+    }
+
+    void TextureCache::Clear()
+    {
+        std::error_code error{};
+        for (const std::filesystem::directory_entry& entry : std::filesystem::directory_iterator{ m_Directory, error })
+        {
+            const std::filesystem::path extension{ entry.path().extension() };
+            if (extension == ".jtex" || extension == ".tmp") std::filesystem::remove(entry.path(), error);
+        }
+    }
+
+    std::filesystem::path TextureCache::GetEntryPath(uint64_t key) const
+    {
+        return m_Directory / std::format("{:016x}.jtex", key);
+    }
+
+    //---------------------------------------------------------------------------------------------------------------------------------
+}
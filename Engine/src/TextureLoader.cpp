@@ -0,0 +1,110 @@
+#include "TextureLoader.h"
+#include "ThreadPool.h"
+#include <algorithm>
+#include <cassert>
+#include <thread>
+
+namespace jela
+{
+    TextureLoader::TextureLoader(Decoder decoder) :
+        TextureLoader{ std::move(decoder), std::max(1u, std::thread::hardware_concurrency() / 2) }
+    {}
+
+    TextureLoader::TextureLoader(Decoder decoder, uint32_t nrOfThreads) :
+        m_Decoder{ std::move(decoder) },
+        m_pThreadPool{ std::make_unique<ThreadPool>(std::max(1u, nrOfThreads)) }
+    {
+        assert(m_Decoder && _T("TextureLoader needs a decoder"));
+    }
+
+    TextureLoader::~TextureLoader()
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+            m_Jobs.clear();
+        }
+        // Joins the workers; runners that start from here on find no job and return.
+        m_pThreadPool = nullptr;
+    }
+
+    void TextureLoader::Request(const tstring& file, LoadPriority priority)
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+
+            if (const auto it = std::ranges::find(m_Jobs, file, &Job::file); it != m_Jobs.end())
+            {
+                if (it->priority < priority)
+                {
+                    it->priority = priority;
+                    std::ranges::make_heap(m_Jobs, IsLowerPriority);
+                }
+                return;
+            }
+            if (std::ranges::find(m_DecodingFiles, file) != m_DecodingFiles.end() ||
+                std::ranges::find(m_Results, file, &Result::file) != m_Results.end())
+                return;
+
+            m_Jobs.emplace_back(Job{ file, priority, m_NextSequence++ });
+            std::ranges::push_heap(m_Jobs, IsLowerPriority);
+        }
+
+        // Every runner decodes whatever is most important at the time it starts,
+        // not necessarily the job it was pushed for.
+        m_pThreadPool->Enqueue([this]() { RunNextJob(); });
+    }
+
+    std::size_t TextureLoader::Collect(std::vector<Result>& results, std::size_t maxResults)
+    {
+        std::lock_guard<std::mutex> lock{ m_Mutex };
+
+        const std::size_t count{ std::min(maxResults, m_Results.size()) };
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            results.emplace_back(std::move(m_Results.front()));
+            m_Results.pop_front();
+        }
+        return count;
+    }
+
+    std::size_t TextureLoader::GetPendingCount() const
+    {
+        std::lock_guard<std::mutex> lock{ m_Mutex };
+        return m_Jobs.size() + m_DecodingFiles.size();
+    }
+
+    bool TextureLoader::IsLowerPriority(const Job& lhs, const Job& rhs)
+    {
+        // Equal priorities are served first come, first served
+        if (lhs.priority != rhs.priority) return lhs.priority < rhs.priority;
+        return lhs.sequence > rhs.sequence;
+    }
+
+    void TextureLoader::RunNextJob()
+    {
+        Job job{};
+        {
+            std::lock_guard<std::mutex> lock{ m_Mutex };
+            if (m_Jobs.empty()) return;
+
+            std::ranges::pop_heap(m_Jobs, IsLowerPriority);
+            job = std::move(m_Jobs.back());
+            m_Jobs.pop_back();
+            m_DecodingFiles.emplace_back(job.file);
+        }
+
+        Result result{ job.file };
+        try
+        {
+            result.image = m_Decoder(job.file);
+        }
+        catch (const std::exception& e)
+        {
+            result.error = e.what();
+        }
+
+        std::lock_guard<std::mutex> lock{ m_Mutex };
+        std::erase(m_DecodingFiles, job.file);
+        m_Results.emplace_back(std::move(result));
+    }
+}
@@ -0,0 +1,120 @@
+#include "ThreadPool.h"
+#include <algorithm>
+#include <atomic>
+#include <exception>
+
+namespace jela
+{
+    ThreadPool::ThreadPool() :
+        // hardware_concurrency is 0 when it can't tell
+        ThreadPool{ std::max(2u, std::thread::hardware_concurrency()) - 1 }
+    {}
+
+    ThreadPool::ThreadPool(uint32_t nrOfThreads)
+    {
+        m_Threads.reserve(nrOfThreads);
+        for (uint32_t i = 0; i < nrOfThreads; ++i)
+            m_Threads.emplace_back([this](std::stop_token stopToken) { WorkerLoop(stopToken); });
+    }
+
+    ThreadPool::~ThreadPool()
+    {
+        for (std::jthread& thread : m_Threads) thread.request_stop();
+        m_TasksCondition.notify_all();
+        m_Threads.clear();
+    }
+
+    void ThreadPool::ParallelFor(std::size_t count, std::size_t grainSize, const std::function<void(std::size_t begin, std::size_t end)>& task)
+    {
+        if (count == 0) return;
+        grainSize = std::max<std::size_t>(grainSize, 1);
+
+        const std::size_t nrOfChunks{ (count + grainSize - 1) / grainSize };
+        if (nrOfChunks == 1 || m_Threads.empty())
+        {
+            task(0, count);
+            return;
+        }
+
+        // Helpers that only get picked up after the loop finished must not touch the caller's stack,
+        // so everything they need is shared.
+        struct SharedState
+        {
+            std::function<void(std::size_t, std::size_t)> task;
+            std::size_t count;
+            std::size_t grainSize;
+            std::size_t nrOfChunks;
+            std::atomic<std::size_t> nextChunk{ 0 };
+            std::atomic<std::size_t> finishedChunks{ 0 };
+            // The first exception a chunk threw, written once by whoever sets isFailed
+            std::atomic<bool> isFailed{ false };
+            std::exception_ptr pException{};
+        };
+        auto pState = std::make_shared<SharedState>();
+        pState->task = task;
+        pState->count = count;
+        pState->grainSize = grainSize;
+        pState->nrOfChunks = nrOfChunks;
+
+        auto runChunks = [](SharedState& state)
+        {
+            for (std::size_t chunk = state.nextChunk.fetch_add(1); chunk < state.nrOfChunks; chunk = state.nextChunk.fetch_add(1))
+            {
+                // Once a chunk threw, the ones left are only counted
+                if (!state.isFailed.load())
+                {
+                    const std::size_t begin{ chunk * state.grainSize };
+                    try
+                    {
+                        state.task(begin, std::min(begin + state.grainSize, state.count));
+                    }
+                    catch (...)
+                    {
+                        if (!state.isFailed.exchange(true)) state.pException = std::current_exception();
+                    }
+                }
+
+                if (state.finishedChunks.fetch_add(1) + 1 == state.nrOfChunks)
+                    state.finishedChunks.notify_all();
+            }
+        };
+
+        const std::size_t nrOfHelpers{ std::min<std::size_t>(m_Threads.size(), nrOfChunks - 1) };
+        for (std::size_t i = 0; i < nrOfHelpers; ++i)
+            Push([pState, runChunks]() { runChunks(*pState); });
+
+        runChunks(*pState);
+
+        for (std::size_t finished = pState->finishedChunks.load(); finished < nrOfChunks; finished = pState->finishedChunks.load())
+            pState->finishedChunks.wait(finished);
+
+        // Counting the chunk after storing it makes the exception visible here
+        if (pState->pException) std::rethrow_exception(pState->pException);
+    }
+
+    void ThreadPool::Push(std::function<void()>&& task)
+    {
+        {
+            std::lock_guard<std::mutex> lock{ m_TasksMutex };
+            m_Tasks.push(std::move(task));
+        }
+        m_TasksCondition.notify_one();
+    }
+
+    void ThreadPool::WorkerLoop(std::stop_token stopToken)
+    {
+        while (true)
+        {
+            std::function<void()> task{};
+            {
+                std::unique_lock<std::mutex> lock{ m_TasksMutex };
+                if (!m_TasksCondition.wait(lock, stopToken, [this]() { return !m_Tasks.empty(); }))
+                    return;
+
+                task = std::move(m_Tasks.front());
+                m_Tasks.pop();
+            }
+            task();
+        }
+    }
+}
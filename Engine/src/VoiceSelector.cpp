@@ -0,0 +1,84 @@
+#include "VoiceSelector.h"
+#include <algorithm>
+
+namespace jela
+{
+    uint64_t ResolveFrame(uint64_t frame, uint64_t frameCount, bool isLooping, uint64_t loopBegin, uint64_t loopEnd)
+    {
+        if (frameCount == 0) return 0;
+        if (isLooping && loopBegin < loopEnd && frame >= loopEnd) return loopBegin + (frame - loopBegin) % (loopEnd - loopBegin);
+        return std::min(frame, frameCount - 1);
+    }
+
+    //---------------------------------------------------------------
+    // VoiceTimeline
+    void VoiceTimeline::Start(uint64_t frame, double framesPerSecond, Clock::time_point now)
+    {
+        m_FramesPerSecond = framesPerSecond;
+        m_IsPaused = false;
+        Seek(frame, now);
+    }
+
+    void VoiceTimeline::Seek(uint64_t frame, Clock::time_point now)
+    {
+        m_StartFrame = frame;
+        m_StartTime = now;
+    }
+
+    void VoiceTimeline::Pause(Clock::time_point now)
+    {
+        if (m_IsPaused) return;
+        m_StartFrame = GetFrame(now);
+        m_IsPaused = true;
+    }
+
+    void VoiceTimeline::Resume(Clock::time_point now)
+    {
+        if (!m_IsPaused) return;
+        m_StartTime = now;
+        m_IsPaused = false;
+    }
+
+    uint64_t VoiceTimeline::GetFrame(Clock::time_point now) const
+    {
+        if (m_IsPaused || now <= m_StartTime) return m_StartFrame;
+        const double seconds{ std::chrono::duration<double>(now - m_StartTime).count() };
+        return m_StartFrame + static_cast<uint64_t>(seconds * m_FramesPerSecond);
+    }
+    //---------------------------------------------------------------
+
+    //---------------------------------------------------------------
+    // VoiceSelector
+    bool VoiceSelector::Outranks(const Candidate& lhs, const Candidate& rhs) const
+    {
+        if (lhs.isPaused != rhs.isPaused) return rhs.isPaused;
+        if (lhs.priority != rhs.priority) return lhs.priority > rhs.priority;
+
+        switch (m_Policy)
+        {
+        case VoiceStealPolicy::Quietest:
+            if (lhs.volume != rhs.volume) return lhs.volume > rhs.volume;
+            break;
+        case VoiceStealPolicy::Oldest:
+            // Play orders are unique, so this always decides
+            return lhs.playOrder > rhs.playOrder;
+        case VoiceStealPolicy::LowestPriority:
+            break;
+        }
+
+        if (lhs.isAudible != rhs.isAudible) return lhs.isAudible;
+        // Of the ones waiting for a voice, the loudest and then the newest gets the first free one
+        if (lhs.volume != rhs.volume) return lhs.volume > rhs.volume;
+        return lhs.playOrder > rhs.playOrder;
+    }
+
+    std::span<VoiceSelector::Candidate> VoiceSelector::Select(std::span<Candidate> candidates, std::size_t voiceCount) const
+    {
+        if (candidates.size() <= voiceCount) return candidates;
+
+        const auto itEnd{ candidates.begin() + static_cast<std::ptrdiff_t>(voiceCount) };
+        std::ranges::nth_element(candidates, itEnd, [this](const Candidate& lhs, const Candidate& rhs) { return Outranks(lhs, rhs); });
+        return candidates.first(voiceCount);
+    }
+    //---------------------------------------------------------------
+}
@@ -0,0 +1,184 @@
+#include "WaveFile.h"
+#include "FileExceptions.h"
+#include <algorithm>
+#include <array>
+
+namespace jela
+{
+    namespace
+    {
+        constexpr std::size_t chunkHeaderSize{ 8 };
+        constexpr std::size_t formatSize{ 16 };
+        constexpr std::size_t extensibleExtraSize{ 22 };
+        constexpr std::size_t samplerHeaderSize{ 36 };
+        constexpr std::size_t samplerLoopSize{ 24 };
+
+        // Chunk ids as the first 4 bytes read as a little-endian number
+        constexpr uint32_t MakeChunkId(const char(&name)[5])
+        {
+            return uint32_t{ static_cast<uint8_t>(name[0]) } | (uint32_t{ static_cast<uint8_t>(name[1]) } << 8) |
+                   (uint32_t{ static_cast<uint8_t>(name[2]) } << 16) | (uint32_t{ static_cast<uint8_t>(name[3]) } << 24);
+        }
+
+        constexpr uint32_t riffId{ MakeChunkId("RIFF") };
+        constexpr uint32_t waveId{ MakeChunkId("WAVE") };
+        constexpr uint32_t formatId{ MakeChunkId("fmt ") };
+        constexpr uint32_t dataId{ MakeChunkId("data") };
+        constexpr uint32_t samplerId{ MakeChunkId("smpl") };
+
+        // Bytes 4 to 15 of the GUID every sub format that is a format tag shares, KSDATAFORMAT_SUBTYPE_PCM and the like
+        constexpr std::array<uint8_t, 12> subFormatGuidTail{ 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 };
+
+        [[noreturn]] void ThrowCorrupt(const char* pReason)
+        {
+            throw FileLoadException{ std::format("WAVE data is corrupt: {}.\n", pReason) };
+        }
+
+        uint32_t ReadLittleEndian32(std::span<const std::byte> data, std::size_t offset)
+        {
+            return std::to_integer<uint32_t>(data[offset]) | (std::to_integer<uint32_t>(data[offset + 1]) << 8) |
+                   (std::to_integer<uint32_t>(data[offset + 2]) << 16) | (std::to_integer<uint32_t>(data[offset + 3]) << 24);
+        }
+
+        uint16_t ReadLittleEndian16(std::span<const std::byte> data, std::size_t offset)
+        {
+            return static_cast<uint16_t>(std::to_integer<uint32_t>(data[offset]) | (std::to_integer<uint32_t>(data[offset + 1]) << 8));
+        }
+    }
+
+    WaveFile::WaveFile(std::span<const std::byte> data)
+    {
+        if (data.size() < 12 || ReadLittleEndian32(data, 0) != riffId || ReadLittleEndian32(data, 8) != waveId)
+            throw FileTypeNotSupportedException{ "Data is not a RIFF/WAVE file.", { ".wav" } };
+
+        // Writers that stream often leave the RIFF size at 0 or too large, the file then ends the chunks
+        const std::size_t riffSize{ ReadLittleEndian32(data, 4) };
+        const std::size_t end{ riffSize >= 4 && riffSize <= data.size() - chunkHeaderSize ? chunkHeaderSize + riffSize : data.size() };
+
+        bool hasFormat{};
+        bool hasData{};
+        bool hasSampler{};
+        std::size_t offset{ 12 };
+        while (end - offset >= chunkHeaderSize)
+        {
+            const uint32_t id{ ReadLittleEndian32(data, offset) };
+            const std::size_t size{ ReadLittleEndian32(data, offset + 4) };
+            offset += chunkHeaderSize;
+
+            const std::size_t available{ end - offset };
+            if (size > available)
+            {
+                // A cut off data chunk still plays what is there; anything else cut off is only a problem when fmt or data is missing
+                if (id == dataId && !hasData)
+                {
+                    m_Data = data.subspan(offset, available);
+                    hasData = true;
+                }
+                break;
+            }
+
+            const std::span<const std::byte> chunk{ data.subspan(offset, size) };
+            if (id == formatId && !hasFormat)
+            {
+                ReadFormat(chunk);
+                m_FormatChunk = chunk;
+                hasFormat = true;
+            }
+            else if (id == dataId && !hasData)
+            {
+                m_Data = chunk;
+                hasData = true;
+            }
+            else if (id == samplerId && !hasSampler)
+            {
+                m_SamplerChunk = chunk;
+                hasSampler = true;
+            }
+
+            // Chunks are padded to an even size
+            offset += std::min(size + (size & 1), available);
+        }
+
+        if (!hasFormat) ThrowCorrupt("there is no fmt chunk");
+        if (!hasData) ThrowCorrupt("there is no data chunk");
+
+        m_Data = m_Data.first(m_Data.size() / m_Format.blockAlign * m_Format.blockAlign);
+        if (m_Data.empty()) ThrowCorrupt("the data chunk doesn't hold a whole block");
+
+        if (hasSampler) ReadLoops(m_SamplerChunk);
+    }
+
+    uint64_t WaveFile::GetFrameCount() const
+    {
+        const uint64_t blockCount{ m_Data.size() / m_Format.blockAlign };
+        if (m_Format.formatTag == WaveFormat::imaAdpcm) return blockCount * m_Format.GetImaFramesPerBlock();
+        return blockCount;
+    }
+
+    uint32_t WaveFormat::GetImaFramesPerBlock() const
+    {
+        // Every channel has a 4 byte header holding its first sample, then the channels take turns with words of 8 samples of 4 bits
+        const uint32_t headersSize{ uint32_t{ channelCount } * 4 };
+        if (headersSize == 0 || blockAlign <= headersSize) return 0;
+        return (blockAlign - headersSize) / headersSize * 8 + 1;
+    }
+
+    void WaveFile::ReadFormat(std::span<const std::byte> chunk)
+    {
+        if (chunk.size() < formatSize) ThrowCorrupt("the fmt chunk is too small");
+
+        m_Format.formatTag = ReadLittleEndian16(chunk, 0);
+        m_Format.channelCount = ReadLittleEndian16(chunk, 2);
+        m_Format.sampleRate = ReadLittleEndian32(chunk, 4);
+        m_Format.bytesPerSecond = ReadLittleEndian32(chunk, 8);
+        m_Format.blockAlign = ReadLittleEndian16(chunk, 12);
+        m_Format.bitsPerSample = ReadLittleEndian16(chunk, 14);
+
+        // Plain PCM files often end at the 16 bytes, without cbSize
+        std::span<const std::byte> extraData{};
+        if (chunk.size() >= formatSize + 2)
+        {
+            const std::size_t extraSize{ ReadLittleEndian16(chunk, formatSize) };
+            if (extraSize > chunk.size() - formatSize - 2) ThrowCorrupt("the fmt chunk is smaller than its cbSize");
+            extraData = chunk.subspan(formatSize + 2, extraSize);
+        }
+
+        if (m_Format.formatTag == WaveFormat::extensible)
+        {
+            if (extraData.size() < extensibleExtraSize) ThrowCorrupt("the WAVE_FORMAT_EXTENSIBLE fmt chunk is too small");
+
+            const uint32_t subFormat{ ReadLittleEndian32(extraData, 6) };
+            const bool isFormatTag{ subFormat <= UINT16_MAX && std::ranges::equal(extraData.subspan(10, subFormatGuidTail.size()), subFormatGuidTail,
+                [](std::byte lhs, uint8_t rhs) { return std::to_integer<uint8_t>(lhs) == rhs; }) };
+            if (!isFormatTag) ThrowCorrupt("the WAVE_FORMAT_EXTENSIBLE sub format isn't a format tag");
+
+            m_Format.isExtensible = true;
+            m_Format.validBitsPerSample = ReadLittleEndian16(extraData, 0);
+            m_Format.channelMask = ReadLittleEndian32(extraData, 2);
+            m_Format.formatTag = static_cast<uint16_t>(subFormat);
+            extraData = extraData.subspan(extensibleExtraSize);
+        }
+        m_Format.extraData = extraData;
+
+        if (m_Format.channelCount == 0 || m_Format.sampleRate == 0 || m_Format.blockAlign == 0)
+            ThrowCorrupt("the fmt chunk has no channels, sample rate or block size");
+
+        const bool isUncompressed{ m_Format.formatTag == WaveFormat::pcm || m_Format.formatTag == WaveFormat::ieeeFloat };
+        if (isUncompressed && (m_Format.bitsPerSample == 0 || m_Format.blockAlign != m_Format.channelCount * ((m_Format.bitsPerSample + 7) / 8)))
+            ThrowCorrupt("the block size doesn't match the channels and bits per sample");
+    }
+
+    void WaveFile::ReadLoops(std::span<const std::byte> chunk)
+    {
+        if (chunk.size() < samplerHeaderSize) return;
+
+        const uint64_t frameCount{ GetFrameCount() };
+        const std::size_t loopCount{ std::min<std::size_t>(ReadLittleEndian32(chunk, 28), (chunk.size() - samplerHeaderSize) / samplerLoopSize) };
+        for (std::size_t index = 0; index < loopCount; ++index)
+        {
+            const std::size_t loopOffset{ samplerHeaderSize + index * samplerLoopSize };
+            const WaveLoop loop{ ReadLittleEndian32(chunk, loopOffset + 8), ReadLittleEndian32(chunk, loopOffset + 12), ReadLittleEndian32(chunk, loopOffset + 20) };
+            if (loop.begin <= loop.end && loop.end < frameCount) m_Loops.push_back(loop);
+        }
+    }
+}
@@ -1,10 +1,19 @@
 #include "Audio.h"
+#include "AudioConvert.h"
+#include "AudioDecoder.h"
+#include "AudioStream.h"
 #include "Engine.h"
 #include "FileExceptions.h"
+#include "MappedFile.h"
+#include "MpscQueue.h"
+#include "WaveFile.h"
 #include <xaudio2.h>
+#include <xapobase.h>
+#include <array>
+#include <atomic>
+#include <deque>
 #include <ranges>
 #include <filesystem>
-#include <mutex>
 
 // Shoutout: ChiliTomatoNoodle
 // https://www.youtube.com/watch?v=T51Eqbbald4&t=2888s
@@ -24,6 +33,23 @@ namespace jela
         m_NrOfChannelsPerFormat = amount;
     }
 
+    void XAudio::SetEngineFormat(uint32_t sampleRate, uint16_t channelCount, uint16_t bitsPerSample)
+    {
+        const bool isRateValid{ sampleRate == 0 || (sampleRate >= XAUDIO2_MIN_SAMPLE_RATE && sampleRate <= XAUDIO2_MAX_SAMPLE_RATE) };
+        if (!isRateValid || (channelCount != 1 && channelCount != 2) || (bitsPerSample != 16 && bitsPerSample != 32))
+        {
+            OutputDebugString(std::format(_T("WARNING! The engine format can't be {} Hz with {} channels of {} bits, it stays as it was. Expected mono or stereo of 16 or 32 bits.\n"),
+                                          sampleRate, channelCount, bitsPerSample).c_str());
+            return;
+        }
+        if (m_ChannelPoolCreated)
+            OutputDebugString(_T("WARNING! When setting the engine format, sounds were already added. Those keep the format they were loaded in.\n\n"));
+
+        m_EngineSampleRate = sampleRate;
+        m_EngineChannelCount = channelCount;
+        m_EngineBitsPerSample = bitsPerSample;
+    }
+
     bool operator==(const WAVEFORMATEX& lhs, const WAVEFORMATEX& rhs)
     {
         return lhs.cbSize == rhs.cbSize &&
@@ -53,16 +79,26 @@ namespace jela
             hr = m_pAudioEngine->CreateMasteringVoice(&m_pMasteringVoice);
             if (FAILED(hr))
                 OutputDebugString(_T("ERROR! Unable to create the XAudio2 Mastering Voice!"));
+            else CreateBuses();
         }
 
         ~AudioImpl()
         {
             m_ChannelPools.clear();
-            // First destroy the channels because, in their destructor, they still need access to the audio files.
+            // First destroy the channels because, in their destructor, they still need access to their voices.
+            // The audio files then stop their voices.
             m_MapAudioFiles.clear();
 
             m_VecSupportedFormats.clear();
 
+            // After the channels, whose voices send to them. The effects go once the voices let go of them.
+            for (Bus& bus : m_Buses)
+            {
+                if (bus.pVoice) bus.pVoice->DestroyVoice();
+                bus.pVoice = nullptr;
+                SafeRelease(&bus.pEffect);
+            }
+
             SafeRelease(&m_pAudioEngine);
             m_pMasteringVoice = nullptr;
         }
@@ -72,7 +108,7 @@ namespace jela
         AudioImpl& operator=(const AudioImpl&) = delete;
         AudioImpl& operator=(AudioImpl&&) noexcept = delete;
 
-        void AddSoundImpl(const tstring& filename, SoundID id)
+        void AddSoundImpl(const tstring& filename, SoundID id, bool stream)
         {
             if (m_MapAudioFiles.contains(id))
                 OutputDebugString(std::format(_T("\nSoundID {} bound to file {} was already added.\n\n"), id, filename).c_str());
@@ -80,7 +116,7 @@ namespace jela
             {
                 try
                 {
-                    m_MapAudioFiles.try_emplace(id, filename, this);
+                    m_MapAudioFiles.try_emplace(id, filename, stream, this);
                 }
                 catch (const FileException& e)
                 {
@@ -98,27 +134,55 @@ namespace jela
 
         void RemoveSoundImpl(SoundID id)
         {
+            ReleaseEndedChannels();
             m_MapAudioFiles.erase(id);
         }
 
-        void PlaySoundInstanceImpl(SoundID id, bool repeat, uint8_t volume, SoundInstanceID& instanceId, float frequency)
+        void ReloadSoundImpl(const tstring& filename)
+        {
+            ReleaseEndedChannels();
+            const std::filesystem::path filePath{ std::filesystem::path{ filename }.lexically_normal() };
+            for (auto it = m_MapAudioFiles.begin(); it != m_MapAudioFiles.end(); ++it)
+            {
+                if (std::filesystem::path{ it->second.GetFileName() }.lexically_normal() != filePath) continue;
+
+                // Loaded next to the old sound, which stays when the new file can't be read
+                std::map<SoundID, AudioFile> reloadedFile{};
+                try
+                {
+                    reloadedFile.try_emplace(it->first, it->second.GetFileName(), it->second.IsStreamed(), this);
+                    reloadedFile.begin()->second.SetBus(it->second.GetBus());
+                }
+                catch (const std::exception& e)
+                {
+                    OutputDebugStringA(e.what());
+                    continue;
+                }
+
+                // AudioFile can't move, the map node is handed over instead
+                it = m_MapAudioFiles.erase(it);
+                it = m_MapAudioFiles.insert(it, reloadedFile.extract(reloadedFile.begin()));
+            }
+        }
+
+        void PlaySoundInstanceImpl(SoundID id, bool repeat, uint8_t volume, SoundInstanceID& instanceId, float frequency, uint8_t priority)
         {
             if (m_MapAudioFiles.contains(id))
             {
                 const float fVolume = volume / 100.f;
-                PlayAudioFile(m_MapAudioFiles.at(id), repeat, fVolume, frequency, instanceId);
+                PlayAudioFile(m_MapAudioFiles.at(id), repeat, fVolume, frequency, priority, instanceId);
             }
             else
                 OutputDebugString(std::format(_T("Sound file with id {} was not added before trying to play the sound."), id).c_str());
         }
 
-        void PlaySoundClipImpl(SoundID id, bool repeat, uint8_t volume, float frequency)
+        void PlaySoundClipImpl(SoundID id, bool repeat, uint8_t volume, float frequency, uint8_t priority)
         {
             if (m_MapAudioFiles.contains(id))
             {
                 const float fVolume = volume / 100.f;
                 SoundInstanceID instanceId{};
-                PlayAudioFile(m_MapAudioFiles.at(id), repeat, fVolume, frequency, instanceId);
+                PlayAudioFile(m_MapAudioFiles.at(id), repeat, fVolume, frequency, priority, instanceId);
             }
             else
                 OutputDebugString(std::format(_T("Sound file with id {} was not added before trying to play the sound."), id).c_str());
@@ -160,9 +224,10 @@ namespace jela
 
         void PauseSoundImpl(SoundID id)
         {
+            ReleaseEndedChannels();
             if (m_MapAudioFiles.contains(id))
             {
-                m_MapAudioFiles.at(id).PauseChannels();
+                m_MapAudioFiles.at(id).PauseVoices();
             }
             else
                 OutputDebugString(std::format(_T("Sound file with id {} was not added before trying to pause the sound."), id).c_str());
@@ -170,10 +235,11 @@ namespace jela
 
         void PauseSoundImpl(SoundID id, const SoundInstanceID& instanceId)
         {
+            ReleaseEndedChannels();
             if (m_MapAudioFiles.contains(id))
             {
                 if (!instanceId.GetID().has_value()) return;
-                m_MapAudioFiles.at(id).PauseChannel(instanceId);
+                m_MapAudioFiles.at(id).PauseInstance(instanceId);
             }
             else
                 OutputDebugString(std::format(_T("Sound file with id {} was not added before trying to pause instance {}."), id, instanceId.GetID().value()).c_str());
@@ -181,18 +247,20 @@ namespace jela
 
         void PauseAllSoundsImpl()
         {
+            ReleaseEndedChannels();
             std::ranges::for_each(m_MapAudioFiles, [](auto& pair)
             {
                 auto& [soundId, audioFile] = pair;
-                audioFile.PauseChannels();
+                audioFile.PauseVoices();
             });
         }
 
         void ResumeSoundImpl(SoundID id)
         {
+            ReleaseEndedChannels();
             if (m_MapAudioFiles.contains(id))
             {
-                m_MapAudioFiles.at(id).ResumeChannels();
+                m_MapAudioFiles.at(id).ResumeVoices();
             }
             else
                 OutputDebugString(std::format(_T("Sound file with id {} was not added before trying to resume the sound."), id).c_str());
@@ -200,10 +268,11 @@ namespace jela
 
         void ResumeSoundImpl(SoundID id, const SoundInstanceID& instanceId)
         {
+            ReleaseEndedChannels();
             if (m_MapAudioFiles.contains(id))
             {
                 if (!instanceId.GetID().has_value()) return;
-                m_MapAudioFiles.at(id).ResumeChannel(instanceId);
+                m_MapAudioFiles.at(id).ResumeInstance(instanceId);
             }
             else
                 OutputDebugString(std::format(_T("Sound file with id {} was not added before trying to resume instance {}."), id, instanceId.GetID().value()).c_str());
@@ -211,18 +280,20 @@ namespace jela
 
         void ResumeAllSoundsImpl()
         {
+            ReleaseEndedChannels();
             std::ranges::for_each(m_MapAudioFiles, [](auto& pair)
             {
                 auto& [soundId, audioFile] = pair;
-                audioFile.ResumeChannels();
+                audioFile.ResumeVoices();
             });
         }
 
         void StopSoundImpl(SoundID id)
         {
+            ReleaseEndedChannels();
             if (m_MapAudioFiles.contains(id))
             {
-                m_MapAudioFiles.at(id).StopChannels();
+                m_MapAudioFiles.at(id).StopVoices();
             }
             else
                 OutputDebugString(std::format(_T("Sound file with id {} was not added before trying to stop the sound."), id).c_str());
@@ -230,27 +301,168 @@ namespace jela
 
         void StopSoundImpl(SoundID id, const SoundInstanceID& instanceId)
         {
+            ReleaseEndedChannels();
             if (m_MapAudioFiles.contains(id))
             {
                 if (!instanceId.GetID().has_value()) return;
-                m_MapAudioFiles.at(id).StopChannel(instanceId);
+                m_MapAudioFiles.at(id).StopInstance(instanceId);
             }
             else
                 OutputDebugString(std::format(_T("Sound file with id {} was not added before trying to resume instance {}."), id, instanceId.GetID().value()).c_str());
         }
 
+        void SeekSoundImpl(SoundID id, const SoundInstanceID& instanceId, float seconds)
+        {
+            ReleaseEndedChannels();
+            if (m_MapAudioFiles.contains(id))
+            {
+                if (!instanceId.GetID().has_value()) return;
+                AudioFile& audioFile{ m_MapAudioFiles.at(id) };
+                const auto frame{ static_cast<uint64_t>(std::max(seconds, 0.f) * audioFile.GetFormatPtr()->nSamplesPerSec) };
+                audioFile.SeekInstance(instanceId, frame);
+            }
+            else
+                OutputDebugString(std::format(_T("Sound file with id {} was not added before trying to seek instance {}."), id, instanceId.GetID().value()).c_str());
+        }
+
         void StopAllSoundsImpl()
         {
+            ReleaseEndedChannels();
             std::ranges::for_each(m_MapAudioFiles, [](auto& pair)
             {
                 auto& [soundId, audioFile] = pair;
-                audioFile.StopChannels();
+                audioFile.StopVoices();
             });
         }
 
+        void UpdateImpl()
+        {
+            ReleaseEndedChannels();
+            const auto now{ VoiceTimeline::Clock::now() };
+
+            // Heard sounds end when their channel does, virtual ones when their timeline passes the end
+            for (std::size_t index{ m_VoicePtrs.size() }; index-- > 0;)
+            {
+                Voice& voice{ *m_VoicePtrs[index] };
+                if (!voice.pChannel && !voice.isLooping && voice.timeline.GetFrame(now) >= voice.pAudioFile->GetFrameCount()) StopVoice(voice);
+            }
+
+            // Nothing to decide while every sound is heard
+            std::size_t audibleCount{};
+            for (const auto& [pFormat, pool] : m_ChannelPools) audibleCount += pool.GetActiveCount();
+            if (audibleCount == m_VoicePtrs.size()) return;
+
+            for (auto& [pFormat, pool] : m_ChannelPools) pool.candidates.clear();
+            for (const Voice* const pVoice : m_VoicePtrs) m_ChannelPools.at(pVoice->pAudioFile->GetFormatPtr()).candidates.push_back(MakeCandidate(*pVoice));
+
+            for (auto& [pFormat, pool] : m_ChannelPools)
+            {
+                const std::span<VoiceSelector::Candidate> selected{ m_VoiceSelector.Select(pool.candidates, pool.channelPtrs.size()) };
+
+                // The ones that lost give up their channels first, so the ones that won find them idle
+                for (const VoiceSelector::Candidate& candidate : std::span{ pool.candidates }.subspan(selected.size()))
+                {
+                    if (candidate.isAudible) m_VoicePtrs[candidate.voice]->pChannel->Stop();
+                }
+                for (const VoiceSelector::Candidate& candidate : selected)
+                {
+                    if (!candidate.isAudible && !candidate.isPaused) PlayOnIdleChannel(*m_VoicePtrs[candidate.voice], now);
+                }
+            }
+        }
+
+        void SetVoiceStealPolicyImpl(VoiceStealPolicy policy) { m_VoiceSelector.SetPolicy(policy); }
+        VoiceStealPolicy GetVoiceStealPolicyImpl() const { return m_VoiceSelector.GetPolicy(); }
+
+        void SetSoundBusImpl(SoundID id, AudioBus bus)
+        {
+            ReleaseEndedChannels();
+            if (!m_MapAudioFiles.contains(id))
+            {
+                OutputDebugString(std::format(_T("Sound file with id {} was not added before trying to set its bus."), id).c_str());
+                return;
+            }
+
+            AudioFile& audioFile{ m_MapAudioFiles.at(id) };
+            audioFile.SetBus(bus);
+            for (const Voice* const pVoice : m_VoicePtrs)
+            {
+                if (pVoice->pAudioFile == &audioFile && pVoice->pChannel) pVoice->pChannel->SetBus(bus);
+            }
+        }
+
+        uint8_t GetBusVolumeImpl(AudioBus bus) const { return GetBus(bus).volume; }
+        bool IsBusMutedImpl(AudioBus bus) const { return GetBus(bus).isMuted; }
+
+        void SetBusVolumeImpl(AudioBus bus, uint8_t newVolume)
+        {
+            Bus& target{ GetBus(bus) };
+            target.volume = newVolume;
+            ApplyBusVolume(target);
+        }
+
+        void SetBusMuteImpl(AudioBus bus, bool isMuted)
+        {
+            Bus& target{ GetBus(bus) };
+            target.isMuted = isMuted;
+            ApplyBusVolume(target);
+        }
+
+        void SetBusEffectsImpl(AudioBus bus, const audio::EffectSettings& settings, std::optional<AudioBus> keyBus)
+        {
+            if (keyBus == bus)
+            {
+                OutputDebugString(_T("WARNING! A bus can't duck itself, its compressor follows its own level instead.\n"));
+                keyBus.reset();
+            }
+
+            Bus& target{ GetBus(bus) };
+            target.parameters.settings = settings;
+            target.parameters.pKeyLevel = keyBus && GetBus(*keyBus).pEffect ? &GetBus(*keyBus).pEffect->GetLevel() : nullptr;
+            CommitBusParameters(target);
+        }
+
         class Channel;
         class AudioFile;
 
+        // A play of a sound. It is heard while it has a channel and plays on virtually otherwise:
+        // its timeline keeps the frame it is at, so it continues from there when it gets a channel again.
+        struct Voice
+        {
+            AudioFile* pAudioFile{};
+            Channel* pChannel{};
+            VoiceTimeline timeline{};
+            float volume{};
+            float frequency{};
+            uint64_t playOrder{};
+            uint8_t priority{};
+            // Its slot in the audio file, which its instance IDs hold
+            uint8_t instanceIndex{};
+            bool isLooping{};
+            // In m_VoicePtrs
+            std::size_t index{};
+        };
+
+        // Pushed by the XAudio2 thread when a channel's buffer ends, playCount tells which Play it ended
+        struct EndedChannel
+        {
+            Channel* pChannel;
+            uint32_t playCount;
+        };
+
+        // The XAudio2 thread doesn't touch the channels itself, so nothing here needs a lock.
+        // Channels whose sound ended are released on the game thread, at the start of the next call that uses channels.
+        void ReleaseEndedChannels()
+        {
+            EndedChannel endedChannel{};
+            while (m_EndedChannels.TryPop(endedChannel))
+            {
+                // The channel was stopped, and maybe played again, since this was pushed
+                if (endedChannel.pChannel->GetPlayCount() != endedChannel.playCount) continue;
+                if (Voice* const pVoice{ endedChannel.pChannel->GetVoice() }) StopVoice(*pVoice);
+            }
+        }
+
         //----------------------------------------------------------------------------------------------------------------------------
         // AudioFile class
         class AudioFile final
@@ -258,22 +470,35 @@ namespace jela
             friend XAudio::AudioImpl::Channel;
 
         public:
-            AudioFile(const tstring& filename, AudioImpl* const pAudioSystem) :
+            // Instance IDs are 8 bit
+            static constexpr std::size_t m_MaxVoiceCount{ UINT8_MAX + 1 };
+
+            AudioFile(const tstring& filename, bool isStreamed, AudioImpl* const pAudioSystem) :
                 m_FileName{ filename },
-                m_pAudioSystem{ pAudioSystem }
+                m_pAudioSystem{ pAudioSystem },
+                m_Bus{ isStreamed ? AudioBus::Music : AudioBus::Sfx },
+                m_IsStreamed{ isStreamed }
             {
                 try
                 {
                     OpenFile(m_FileName);
-                    m_ActiveChannelPtrs.assign(FormatChannelPool::amountOfChannels, nullptr);
+                    m_InstanceVoicePtrs.assign(m_MaxVoiceCount, nullptr);
+                    // Taken from the back, so the lowest indices go first
+                    m_FreeInstanceIndices.reserve(m_MaxVoiceCount);
+                    for (std::size_t index = m_MaxVoiceCount; index-- > 0;) m_FreeInstanceIndices.push_back(static_cast<uint8_t>(index));
                 }
                 catch (...)
                 {
                     m_FileName.clear();
                     m_pData.clear();
-                    m_ActiveChannelPtrs.clear();
+                    m_pStreamDataOwner.reset();
+                    m_StreamData = {};
+                    m_pDecoder.reset();
+                    m_Loop.reset();
+                    m_InstanceVoicePtrs.clear();
+                    m_FreeInstanceIndices.clear();
                     m_pFormat = nullptr;
-                    m_pOnChannelRelease.reset();
+                    m_pOnVoiceRelease.reset();
                     m_Exists = false;
                     throw;
                 }
@@ -281,7 +506,7 @@ namespace jela
 
             ~AudioFile()
             {
-                StopChannels();
+                StopVoices();
             }
 
             AudioFile(const AudioFile& other) = delete;
@@ -291,125 +516,122 @@ namespace jela
 
             const WAVEFORMATEX* const GetFormatPtr() const { return m_pFormat; }
             const tstring& GetFileName() const { return m_FileName; }
-            void StopChannel(const SoundInstanceID& id) { m_ActiveChannelPtrs.at(id.GetID().value())->Stop(); }
-            void PauseChannel(const SoundInstanceID& id) { m_ActiveChannelPtrs.at(id.GetID().value())->Pause(); }
-            void ResumeChannel(const SoundInstanceID& id) { m_ActiveChannelPtrs.at(id.GetID().value())->Resume(); }
-            void StopChannels() { std::ranges::for_each(m_ActiveChannelPtrs, [](const auto& pChannel) { if (pChannel) pChannel->Stop(); }); }
-            void PauseChannels() { std::ranges::for_each(m_ActiveChannelPtrs, [](const auto& pChannel) { if (pChannel) pChannel->Pause(); }); }
-            void ResumeChannels() { std::ranges::for_each(m_ActiveChannelPtrs, [](const auto& pChannel) { if (pChannel) pChannel->Resume(); }); }
+            bool IsStreamed() const { return m_IsStreamed; }
+            // What its voices play through, SetSoundBusImpl moves the ones that are heard along
+            AudioBus GetBus() const { return m_Bus; }
+            void SetBus(AudioBus bus) { m_Bus = bus; }
+            // Compressed sounds play through a stream too, which decodes them
+            bool IsPlayedByStream() const { return m_IsStreamed || m_pDecoder; }
+            uint64_t GetFrameCount() const
+            {
+                if (m_pDecoder) return m_pDecoder->GetFrameCount(m_StreamData.size());
+                return (m_IsStreamed ? m_StreamData.size() : m_pData.size()) / m_pFormat->nBlockAlign;
+            }
+            // What repeating plays, the end is exclusive
+            uint64_t GetLoopBegin() const { return m_Loop ? m_Loop->begin : 0; }
+            uint64_t GetLoopEnd() const { return m_Loop ? uint64_t{ m_Loop->end } + 1 : GetFrameCount(); }
+
+            void StopInstance(const SoundInstanceID& id) { if (Voice* const pVoice{ m_InstanceVoicePtrs.at(id.GetID().value()) }) m_pAudioSystem->StopVoice(*pVoice); }
+            void PauseInstance(const SoundInstanceID& id) { if (Voice* const pVoice{ m_InstanceVoicePtrs.at(id.GetID().value()) }) m_pAudioSystem->PauseVoice(*pVoice); }
+            void ResumeInstance(const SoundInstanceID& id) { if (Voice* const pVoice{ m_InstanceVoicePtrs.at(id.GetID().value()) }) m_pAudioSystem->ResumeVoice(*pVoice); }
+            void SeekInstance(const SoundInstanceID& id, uint64_t frame) { if (Voice* const pVoice{ m_InstanceVoicePtrs.at(id.GetID().value()) }) m_pAudioSystem->SeekVoice(*pVoice, frame); }
+            void StopVoices() { std::ranges::for_each(m_InstanceVoicePtrs, [this](Voice* pVoice) { if (pVoice) m_pAudioSystem->StopVoice(*pVoice); }); }
+            void PauseVoices() { std::ranges::for_each(m_InstanceVoicePtrs, [this](Voice* pVoice) { if (pVoice) m_pAudioSystem->PauseVoice(*pVoice); }); }
+            void ResumeVoices() { std::ranges::for_each(m_InstanceVoicePtrs, [this](Voice* pVoice) { if (pVoice) m_pAudioSystem->ResumeVoice(*pVoice); }); }
+
+            bool HasFreeInstance() const { return !m_FreeInstanceIndices.empty(); }
+
+            // Gives the voice a free slot and instanceId the index of it
+            void AddVoice(Voice& voice, SoundInstanceID& instanceId)
+            {
+                assert(HasFreeInstance());
+                voice.instanceIndex = m_FreeInstanceIndices.back();
+                m_FreeInstanceIndices.pop_back();
+                m_InstanceVoicePtrs[voice.instanceIndex] = &voice;
+                instanceId.Init(voice.instanceIndex, m_pOnVoiceRelease.get());
+            }
 
-        private:
-            enum class WaveCode
-            {
-#ifdef _XBOX //Big-Endian
-                RIFF='RIFF',
-                DATA='data',
-                FMT='fmt ',
-                WAVE='WAVE',
-                XWMA='XWMA',
-                DPDS='dpds'
-#endif
-
-#ifndef _XBOX //Little-Endian
-                RIFF = 'FFIR',
-                DATA = 'atad',
-                FMT = ' tmf',
-                WAVE = 'EVAW',
-                XWMA = 'AMWX',
-                DPDS = 'sdpd'
-#endif
-            };
+            void RemoveVoice(const Voice& voice)
+            {
+                m_InstanceVoicePtrs[voice.instanceIndex] = nullptr;
+                m_FreeInstanceIndices.push_back(voice.instanceIndex);
+                // The instance IDs of this voice unsubscribe themselves
+                m_pOnVoiceRelease->NotifyObservers(voice.instanceIndex);
+            }
 
+        private:
             void OpenFile(const tstring& fileName)
             {
-                constexpr static unsigned int nrOfFourccChars{ 4 };
+                const std::filesystem::path filePath{ ENGINE.ResourceMngr()->GetDataPath() + fileName };
+                const std::span<const std::byte> packedData{ ENGINE.ResourceMngr()->FindPackedAsset(fileName) };
+
+                if (packedData.empty() && !std::filesystem::exists(filePath))
+                    throw FileNotFoundException{ std::format("File path {} could not be found. Error occurred when trying to add a sound file.", filePath.string()) };
+
+                // Packed sounds are read in place, loose ones are mapped
+                std::shared_ptr<const MappedFile> pMappedFile{};
+                if (packedData.empty()) pMappedFile = std::make_shared<const MappedFile>(filePath);
+                const WaveFile waveFile{ packedData.empty() ? pMappedFile->GetData() : packedData };
+                const WaveFormat& format{ waveFile.GetFormat() };
+
+                // WAVE_FORMAT_EXTENSIBLE is played as the plain format of its sub format
+                const bool isCompressed{ audio::IsBlockCompressed(format) };
+                if (format.formatTag != WaveFormat::pcm && format.formatTag != WaveFormat::ieeeFloat && !isCompressed)
+                    throw FileTypeNotSupportedException{ std::format("Format tag {} of {} is not supported.", format.formatTag, std::filesystem::path{ fileName }.string()), { "PCM .wav", "IEEE float .wav", "IMA ADPCM .wav" } };
+
+                // Compressed sounds stay compressed in memory and are decoded a block at a time as they play, they are played as the PCM they decode to
+                if (isCompressed) m_pDecoder = audio::CreateBlockDecoder(format);
+
+                // Converted to the engine format, when there is one, so it plays on the channels of that format. Streams and compressed sounds are read as they are.
+                const bool isConverted{ !m_IsStreamed && !isCompressed && m_EngineSampleRate != 0 };
+                const WaveFormat playedFormat{ isConverted ? audio::MakePcmFormat(m_EngineSampleRate, m_EngineChannelCount, m_EngineBitsPerSample) :
+                                               isCompressed ? m_pDecoder->GetDecodedFormat() : format };
+
                 WAVEFORMATEX extractedFormat{};
+                extractedFormat.wFormatTag = playedFormat.formatTag;
+                extractedFormat.nChannels = playedFormat.channelCount;
+                extractedFormat.nSamplesPerSec = playedFormat.sampleRate;
+                extractedFormat.nAvgBytesPerSec = playedFormat.bytesPerSecond;
+                extractedFormat.nBlockAlign = playedFormat.blockAlign;
+                extractedFormat.wBitsPerSample = playedFormat.bitsPerSample;
 
-                std::streampos filePosition{ 0 }; // Debug Purposes
+                // Repeating plays the first loop of the smpl chunk, or the whole sound when there is none
+                if (!waveFile.GetLoops().empty()) m_Loop = waveFile.GetLoops().front();
 
-                tstring pathString{ ENGINE.ResourceMngr()->GetDataPath() + fileName };
+                // Streams don't start without a frame to play
+                if ((m_IsStreamed || isCompressed) && waveFile.GetData().empty())
+                    throw FileLoadException{ "Expected a block of samples in the data chunk when reading Sound file.\n" };
 
-                if (const std::filesystem::path filePath{ pathString }; std::filesystem::exists(filePath))
+                if (m_IsStreamed)
+                {
+                    if (playedFormat.blockAlign > AudioStreamer::m_DefaultBufferSize)
+                        throw FileLoadException{ "Expected a block of samples that fits a stream buffer when reading Sound file.\n" };
+                    m_pStreamDataOwner = std::move(pMappedFile);
+                    m_StreamData = waveFile.GetData();
+                }
+                else if (isCompressed)
                 {
-                    if (fileName.find(_T(".wav")) == std::string::npos)
-                        throw FileTypeNotSupportedException{ std::format("File type of {} is not supported.", std::filesystem::path{ fileName }.string()), { ".wav" } };
-
-                    if (std::ifstream file{ filePath, std::ios_base::binary }; file.is_open())
-                    {
-                        int fourccResult{};
-
-                        filePosition = file.read(reinterpret_cast<char*>(&fourccResult), nrOfFourccChars).tellg();
-                        if (fourccResult != static_cast<int>(WaveCode::RIFF))
-                            throw FileLoadException{ std::format("Expected {} (WAVE_CODE_RIFF) when reading Sound file. Got {} instead.\n", static_cast<int>(WaveCode::RIFF), fourccResult) };
-
-                        unsigned int fileSize{ 0 };
-                        filePosition = file.read(reinterpret_cast<char*>(&fileSize), nrOfFourccChars).tellg();
-                        fileSize += 8;
-                        if (fileSize <= 44)
-                            throw FileLoadException{
-                                "Expected a filesize larger than 44 bytes when reading Sound file.\n"
-                            };
-
-                        filePosition = file.read(reinterpret_cast<char*>(&fourccResult), nrOfFourccChars).tellg();
-                        if (fourccResult != static_cast<int>(WaveCode::WAVE))
-                            throw FileLoadException{ std::format("Expected {} (WAVE_CODE_WAVE) when reading Sound file. Got {} instead.\n", static_cast<int>(WaveCode::WAVE), fourccResult) };
-
-                        unsigned int chunkSize{};
-
-                        auto findChunk = [&](WaveCode waveCode) -> bool
-                        {
-                            filePosition = file.seekg(nrOfFourccChars * 3, std::ifstream::beg).tellg();
-                            bool bFilledData{ false };
-
-                            while (!bFilledData && !file.eof())
-                            {
-                                filePosition = file.read(reinterpret_cast<char*>(&fourccResult), nrOfFourccChars).
-                                        tellg();
-
-                                if (fourccResult != static_cast<int>(waveCode)) // did not find chuck
-                                {
-                                    filePosition = file.read(reinterpret_cast<char*>(&chunkSize), sizeof(chunkSize)).
-                                            tellg();
-                                    filePosition = file.seekg(chunkSize, std::ifstream::cur).tellg();
-                                }
-                                else // found chunk
-                                {
-                                    filePosition = file.read(reinterpret_cast<char*>(&chunkSize), sizeof(chunkSize)).
-                                            tellg();
-
-                                    if (waveCode == WaveCode::FMT)
-                                        filePosition = file.read(
-                                            reinterpret_cast<char*>(&extractedFormat),
-                                            sizeof(extractedFormat)).tellg();
-                                    else if (waveCode == WaveCode::DATA)
-                                    {
-                                        m_pData.assign(chunkSize, 0);
-                                        filePosition = file.read(reinterpret_cast<char*>(m_pData.data()),
-                                                                 m_pData.size()).tellg();
-                                    }
-
-                                    bFilledData = true;
-                                }
-                            }
-
-                            return bFilledData;
-                        };
-
-                        if (!findChunk(WaveCode::FMT))
-                            throw FileLoadException{ std::format("Expected {} (WAVE_CODE_FMT) format not found when reading Sound file.\n", static_cast<int>(WaveCode::FMT)) };
-
-                        if (!findChunk(WaveCode::DATA))
-                            throw FileLoadException{ std::format("Expected {} (WAVE_CODE_DATA) data not found when reading Sound file.\n", static_cast<int>(WaveCode::DATA)) };
-                    }
-                    else throw FileLoadException{ std::format("File path {} was found but file could not be opened. Error occurred when trying to add a sound file.", filePath.string()) };
+                    // Copied like PCM, the streams share the copy
+                    const std::span<const std::byte> data{ waveFile.GetData() };
+                    const auto pBlocks{ std::make_shared<const std::vector<std::byte>>(data.begin(), data.end()) };
+                    m_StreamData = *pBlocks;
+                    m_pStreamDataOwner = pBlocks;
+                }
+                else if (isConverted && !IsSameFormat(format, playedFormat))
+                {
+                    const std::vector<std::byte> data{ audio::ConvertSound(waveFile.GetData(), format, playedFormat) };
+                    m_pData.assign(reinterpret_cast<const BYTE*>(data.data()), reinterpret_cast<const BYTE*>(data.data() + data.size()));
+                    if (m_Loop) ConvertLoop(*m_Loop, format.sampleRate, playedFormat.sampleRate, data.size() / playedFormat.blockAlign);
+                }
+                else
+                {
+                    // Copied, so the XAudio2 thread never waits for a page of the file to be read
+                    const std::span<const std::byte> data{ waveFile.GetData() };
+                    m_pData.assign(reinterpret_cast<const BYTE*>(data.data()), reinterpret_cast<const BYTE*>(data.data() + data.size()));
                 }
-                else throw FileNotFoundException{ std::format("File path {} could not be found. Error occurred when trying to add a sound file.", filePath.string()) };
 
                 m_Exists = true;
 
-                if (extractedFormat.wFormatTag == WAVE_FORMAT_PCM || extractedFormat.wFormatTag == WAVE_FORMAT_IEEE_FLOAT)
-                    extractedFormat.cbSize = 0;
-
                 m_pFormat = m_pAudioSystem->AddFormat(extractedFormat);
 
                 tstring formatStringSummary = std::format(
@@ -420,68 +642,63 @@ namespace jela
                 OutputDebugString(std::format(_T("Audio File {} was successfully loaded! Format:\n{}\n"), fileName, formatStringSummary).c_str());
             }
 
-            void RemoveChannel(const AudioImpl::Channel* pChannel)
+            static bool IsSameFormat(const WaveFormat& lhs, const WaveFormat& rhs)
             {
-                std::lock_guard<std::mutex> lock{ m_ChannelsMutex };
-                for (std::size_t index = 0; index < m_ActiveChannelPtrs.size(); ++index)
-                {
-                    auto& pCurrChannel = m_ActiveChannelPtrs.at(index);
-                    if (pCurrChannel == pChannel)
-                    {
-                        pCurrChannel = nullptr;
-                        std::vector<SoundInstanceID*> instanceIDs{};
-                        m_pOnChannelRelease->NotifyObservers(static_cast<uint8_t>(index), instanceIDs);
-                        for (const auto& id : instanceIDs)
-                            m_pOnChannelRelease->RemoveObserver(id);
-                        return;
-                    }
-                }
+                return lhs.formatTag == rhs.formatTag && lhs.channelCount == rhs.channelCount && lhs.sampleRate == rhs.sampleRate &&
+                       lhs.blockAlign == rhs.blockAlign && lhs.bitsPerSample == rhs.bitsPerSample;
             }
 
-            void AddChannel(AudioImpl::Channel* pChannel, SoundInstanceID& instanceId)
+            // Moves the loop to the same time at the new rate, keeping it within the frameCount frames of the converted sound
+            static void ConvertLoop(WaveLoop& loop, uint32_t sourceRate, uint32_t destinationRate, uint64_t frameCount)
             {
-                // No lock_guard needed, because AddChannel will never be called when the audio voice already started.
-                for (std::size_t index = 0; index < m_ActiveChannelPtrs.size(); ++index)
-                {
-                    auto& pCurrChannel = m_ActiveChannelPtrs.at(index);
-                    if (!pCurrChannel)
-                    {
-                        if (!m_pOnChannelRelease->HasObserver(&instanceId))
-                            m_pOnChannelRelease->AddObserver(&instanceId);
-
-                        instanceId.SaveSubject(m_pOnChannelRelease.get());
-                        pCurrChannel = pChannel;
-                        instanceId.Init(static_cast<uint8_t>(index));
-                        return;
-                    }
-                }
+                const uint64_t lastFrame{ std::max<uint64_t>(frameCount, 1) - 1 };
+                const uint64_t begin{ std::min(audio::ConvertFrame(loop.begin, sourceRate, destinationRate), lastFrame) };
+                const uint64_t end{ audio::ConvertFrame(uint64_t{ loop.end } + 1, sourceRate, destinationRate) };
+                loop.begin = static_cast<uint32_t>(begin);
+                loop.end = static_cast<uint32_t>(std::clamp(end, begin + 1, lastFrame + 1) - 1);
             }
 
-            std::mutex m_ChannelsMutex{};
             tstring m_FileName{};
             std::vector<BYTE> m_pData{};
-            std::vector<AudioImpl::Channel*> m_ActiveChannelPtrs{};
+            // Only for streamed and compressed sounds, instead of m_pData: the mapped file, or the compressed blocks in memory.
+            // Shared with the streams, so removing the sound while one still reads is fine.
+            std::shared_ptr<const void> m_pStreamDataOwner{};
+            std::span<const std::byte> m_StreamData{};
+            // Only for compressed sounds
+            std::shared_ptr<const audio::BlockDecoder> m_pDecoder{};
+            std::optional<WaveLoop> m_Loop{};
+            // Indexed by instance ID
+            std::vector<Voice*> m_InstanceVoicePtrs{};
+            // Reserved for every index up front, so taking and giving back never allocates
+            std::vector<uint8_t> m_FreeInstanceIndices{};
             const WAVEFORMATEX* m_pFormat{};
             AudioImpl* const m_pAudioSystem{};
 
-            std::unique_ptr<Subject<uint8_t, std::vector<SoundInstanceID*>&>> m_pOnChannelRelease{ std::make_unique<Subject<uint8_t, std::vector<SoundInstanceID*>&>>() };
+            std::unique_ptr<Subject<uint8_t>> m_pOnVoiceRelease{ std::make_unique<Subject<uint8_t>>() };
+            AudioBus m_Bus{};
             bool m_Exists{ false };
+            const bool m_IsStreamed{ false };
         };
 
         //----------------------------------------------------------------------------------------------------------------------------
 
         //----------------------------------------------------------------------------------------------------------------------------
         // Channel class
-        class Channel final
+        // Plays a voice's sound whole from memory in one buffer, or streamed through its AudioStream, which it is the sink of.
+        // Compressed sounds are streamed from memory as well, the stream decodes them.
+        class Channel final : public AudioStreamSink
         {
         public:
-            Channel(AudioImpl* const pAudioSystem, const WAVEFORMATEX* const pFormat) :
+            Channel(AudioImpl* const pAudioSystem, const WAVEFORMATEX* const pFormat, uint16_t poolIndex) :
                 m_pFormat{ pFormat },
-                m_pAudioSystem{ pAudioSystem }
+                m_pAudioSystem{ pAudioSystem },
+                m_PoolIndex{ poolIndex }
             {
                 ZeroMemory(&m_XAudioBuffer, sizeof(m_XAudioBuffer));
-                m_XAudioBuffer.pContext = this;
-                HRESULT hr = pAudioSystem->m_pAudioEngine->CreateSourceVoice(&m_pAudioVoice, pFormat, 0u, XAUDIO2_MAX_FREQ_RATIO, &m_Callback);
+                // Straight to the master when the buses couldn't be made
+                XAUDIO2_SEND_DESCRIPTOR send{ 0, pAudioSystem->GetBus(m_Bus).pVoice };
+                const XAUDIO2_VOICE_SENDS sends{ 1, &send };
+                HRESULT hr = pAudioSystem->m_pAudioEngine->CreateSourceVoice(&m_pAudioVoice, pFormat, 0u, XAUDIO2_MAX_FREQ_RATIO, &m_Callback, send.pOutputVoice ? &sends : nullptr);
                 if (FAILED(hr))
                     OutputDebugString(std::format(_T("Creating Source Voice failed. HRESULT {}"), hr).c_str());
             }
@@ -493,10 +710,12 @@ namespace jela
 
             ~Channel()
             {
-                if (m_pAudioFile)
+                // Before the voice goes, so the streaming thread doesn't submit to it anymore
+                if (m_pStream) m_pStream->Stop();
+                if (m_pVoice)
                 {
-                    m_pAudioFile->RemoveChannel(this);
-                    m_pAudioFile = nullptr;
+                    m_pVoice->pChannel = nullptr;
+                    m_pVoice = nullptr;
                 }
                 if (m_pAudioVoice)
                 {
@@ -506,30 +725,70 @@ namespace jela
             }
 
             const WAVEFORMATEX* const GetFormatPtr() const { return m_pFormat; }
+            uint32_t GetPlayCount() const { return m_PlayCount; }
+            uint16_t GetPoolIndex() const { return m_PoolIndex; }
+            Voice* GetVoice() const { return m_pVoice; }
 
-            void Play(AudioFile& s, bool repeat, float vol, float frequency, SoundInstanceID& instanceId)
+            // Sends the channel's voice to the bus instead, which takes effect while it plays too
+            void SetBus(AudioBus bus)
             {
-                assert(m_pAudioVoice && !m_pAudioFile);
-                s.AddChannel(this, instanceId);
-                // callback thread not running yet, so no sync necessary for m_pAudioFile
-                m_pAudioFile = &s;
-                m_XAudioBuffer.LoopCount = repeat ? XAUDIO2_LOOP_INFINITE : 0;
-                m_XAudioBuffer.pAudioData = s.m_pData.data();
-                m_XAudioBuffer.AudioBytes = static_cast<UINT32>(s.m_pData.size());
-                m_pAudioVoice->SubmitSourceBuffer(&m_XAudioBuffer, nullptr);
-                const float freq = std::max(XAUDIO2_MIN_FREQ_RATIO, std::min(XAUDIO2_MAX_FREQ_RATIO, frequency));
-                m_pAudioVoice->SetFrequencyRatio(freq);
-                m_pAudioVoice->SetVolume(vol);
+                IXAudio2SubmixVoice* const pBusVoice{ m_pAudioSystem->GetBus(bus).pVoice };
+                if (bus == m_Bus || !m_pAudioVoice || !pBusVoice) return;
+
+                XAUDIO2_SEND_DESCRIPTOR send{ 0, pBusVoice };
+                const XAUDIO2_VOICE_SENDS sends{ 1, &send };
+                if (FAILED(m_pAudioVoice->SetOutputVoices(&sends)))
+                    OutputDebugString(_T("WARNING! Sending a channel to another bus failed, it stays on the one it was on.\n"));
+                else m_Bus = bus;
+            }
+
+            // Plays the voice's sound from frame, which ResolveFrame has put within the sound already
+            void Play(Voice& voice, uint64_t frame)
+            {
+                assert(m_pAudioVoice && !m_pVoice);
+                m_pVoice = &voice;
+                voice.pChannel = this;
+                ++m_PlayCount;
+                const AudioFile& s{ *voice.pAudioFile };
+                if (!s.IsPlayedByStream())
+                {
+                    m_XAudioBuffer.pContext = GetBufferContext(false);
+                    m_XAudioBuffer.LoopCount = voice.isLooping ? XAUDIO2_LOOP_INFINITE : 0;
+                    m_XAudioBuffer.LoopBegin = voice.isLooping && s.m_Loop ? s.m_Loop->begin : 0;
+                    m_XAudioBuffer.LoopLength = voice.isLooping && s.m_Loop ? s.m_Loop->end - s.m_Loop->begin + 1 : 0;
+                    m_XAudioBuffer.PlayBegin = static_cast<UINT32>(frame);
+                    m_XAudioBuffer.pAudioData = s.m_pData.data();
+                    m_XAudioBuffer.AudioBytes = static_cast<UINT32>(s.m_pData.size());
+                    m_pAudioVoice->SubmitSourceBuffer(&m_XAudioBuffer, nullptr);
+                }
+                SetBus(s.GetBus());
+                m_pAudioVoice->SetFrequencyRatio(voice.frequency);
+                m_pAudioVoice->SetVolume(voice.volume);
                 m_pAudioVoice->Start();
+
+                if (s.IsPlayedByStream())
+                {
+                    // Only channels that ever stream get a stream, and keep it
+                    if (!m_pStream) m_pStream = &m_pAudioSystem->GetStreamer().CreateStream(this);
+                    const uint64_t loopBegin{ s.m_Loop ? s.m_Loop->begin : 0 };
+                    const uint64_t loopEnd{ s.m_Loop ? uint64_t{ s.m_Loop->end } + 1 : 0 };
+                    // Compressed sounds in memory are the short ones that play often, their decoded blocks are cached
+                    if (s.m_pDecoder) m_pStream->Start(s.m_StreamData, s.m_pStreamDataOwner, s.m_pDecoder, !s.IsStreamed(), voice.isLooping, loopBegin, loopEnd);
+                    else m_pStream->Start(s.m_StreamData, s.m_pStreamDataOwner, m_pFormat->nBlockAlign, voice.isLooping, loopBegin, loopEnd);
+                    if (frame != 0) m_pStream->Seek(frame);
+                }
             }
 
+            // Gives the channel back to the pool. Its voice plays on virtually, unless it is stopped too.
             void Stop()
             {
-                if (m_pAudioVoice && m_pAudioFile)
+                if (m_pAudioVoice && m_pVoice)
                 {
                     m_pAudioVoice->Stop();
-                    m_pAudioFile->RemoveChannel(this);
-                    m_pAudioFile = nullptr;
+                    // Before flushing, so nothing gets submitted after it
+                    if (m_pStream) m_pStream->Stop();
+                    m_pVoice->pChannel = nullptr;
+                    m_pVoice = nullptr;
                     m_pAudioSystem->DeactivateChannel(*this);
                     m_pAudioVoice->FlushSourceBuffers();
                     m_IsPaused = false;
@@ -538,7 +797,7 @@ namespace jela
 
             void Pause()
             {
-                if (m_pAudioVoice && m_pAudioFile)
+                if (m_pAudioVoice && m_pVoice)
                 {
                     m_pAudioVoice->Stop();
                     m_IsPaused = true;
@@ -547,48 +806,255 @@ namespace jela
 
             void Resume()
             {
-                if (m_pAudioVoice && m_pAudioFile && m_IsPaused)
+                if (m_pAudioVoice && m_pVoice && m_IsPaused)
                 {
                     m_pAudioVoice->Start();
                     m_IsPaused = false;
                 }
             }
 
+            // frame is wrapped into the loop when the sound repeats, and clamped to the last one otherwise
+            void Seek(uint64_t frame)
+            {
+                if (!m_pAudioVoice || !m_pVoice) return;
+
+                if (m_pVoice->pAudioFile->IsPlayedByStream())
+                {
+                    m_pStream->Seek(frame);
+                    return;
+                }
+
+                const uint64_t frameCount{ m_pVoice->pAudioFile->GetFrameCount() };
+                if (frameCount == 0) return;
+
+                // Submitted again as a new Play, so the end of the flushed buffer is ignored
+                m_pAudioVoice->Stop();
+                m_pAudioVoice->FlushSourceBuffers();
+                ++m_PlayCount;
+                m_XAudioBuffer.pContext = GetBufferContext(false);
+                const uint64_t loopBegin{ m_XAudioBuffer.LoopBegin };
+                const uint64_t loopEnd{ m_XAudioBuffer.LoopLength != 0 ? loopBegin + m_XAudioBuffer.LoopLength : frameCount };
+                const bool isLooping{ m_XAudioBuffer.LoopCount != 0 };
+                m_XAudioBuffer.PlayBegin = static_cast<UINT32>(ResolveFrame(frame, frameCount, isLooping, loopBegin, loopEnd));
+                m_pAudioVoice->SubmitSourceBuffer(&m_XAudioBuffer, nullptr);
+                if (!m_IsPaused) m_pAudioVoice->Start();
+            }
+
+            // AudioStreamSink, called by the streaming thread. m_PlayCount is safe to read: the stream's lock orders it after Play.
+            virtual void SubmitBuffer(std::span<const std::byte> buffer, bool isEndOfStream) override
+            {
+                XAUDIO2_BUFFER xAudioBuffer{};
+                xAudioBuffer.Flags = isEndOfStream ? XAUDIO2_END_OF_STREAM : 0;
+                xAudioBuffer.AudioBytes = static_cast<UINT32>(buffer.size());
+                xAudioBuffer.pAudioData = reinterpret_cast<const BYTE*>(buffer.data());
+                xAudioBuffer.pContext = GetBufferContext(true);
+                if (FAILED(m_pAudioVoice->SubmitSourceBuffer(&xAudioBuffer, nullptr)))
+                    OutputDebugString(_T("WARNING! Submitting a stream buffer failed, the stream stalls until it is stopped.\n"));
+            }
+            virtual void FlushBuffers() override
+            {
+                // A playing voice finishes its current buffer first
+                m_pAudioVoice->FlushSourceBuffers();
+            }
+
         private:
+            // The buffers' context tells the callback which Play they belong to, and whether the stream submitted them
+            void* GetBufferContext(bool isStreamed) const
+            {
+                return reinterpret_cast<void*>(static_cast<uintptr_t>(m_PlayCount) << 1 | (isStreamed ? 1 : 0));
+            }
+
             class VoiceCallback final : public IXAudio2VoiceCallback
             {
             public:
+                explicit VoiceCallback(Channel* pChannel) : m_pChannel{ pChannel } {}
                 virtual ~VoiceCallback() = default;
 
+                VoiceCallback(const VoiceCallback&) = delete;
+                VoiceCallback(VoiceCallback&&) noexcept = delete;
+                VoiceCallback& operator=(const VoiceCallback&) = delete;
+                VoiceCallback& operator=(VoiceCallback&&) noexcept = delete;
+
                 virtual void STDMETHODCALLTYPE OnStreamEnd() override {}
                 virtual void STDMETHODCALLTYPE OnVoiceProcessingPassEnd() override {}
                 virtual void STDMETHODCALLTYPE OnVoiceProcessingPassStart(UINT32) override {}
 
+                // Runs on the XAudio2 thread, which must not block, so the game thread stops the channel later
                 virtual void STDMETHODCALLTYPE OnBufferEnd(void* pBufferContext) override
                 {
-                    Channel& chan = *(static_cast<Channel*>(pBufferContext));
-                    chan.Stop();
+                    const auto context{ reinterpret_cast<uintptr_t>(pBufferContext) };
+                    // Streamed buffers go back to the stream, only its last one ends the sound
+                    if ((context & 1) != 0 && !m_pChannel->m_pStream->OnBufferEnd()) return;
+
+                    const EndedChannel endedChannel{ m_pChannel, static_cast<uint32_t>(context >> 1) };
+                    if (!m_pChannel->m_pAudioSystem->m_EndedChannels.TryPush(endedChannel))
+                        OutputDebugString(_T("WARNING! Too many channels ended at once, one stays in use until it is stopped.\n"));
                 }
 
                 virtual void STDMETHODCALLTYPE OnBufferStart(void*) override {}
                 virtual void STDMETHODCALLTYPE OnLoopEnd(void*) override {}
                 virtual void STDMETHODCALLTYPE OnVoiceError(void*, HRESULT) override {}
+
+            private:
+                Channel* const m_pChannel;
             };
 
             XAUDIO2_BUFFER m_XAudioBuffer{};
             IXAudio2SourceVoice* m_pAudioVoice{ nullptr };
-            // does this need to be synchronized?
-            // (no--no overlap of callback thread and main thread here)
-            AudioFile* m_pAudioFile{ nullptr };
+            // Only used on the game thread, the callback just pushes to m_EndedChannels
+            Voice* m_pVoice{ nullptr };
             const WAVEFORMATEX* const m_pFormat{ nullptr };
             AudioImpl* const m_pAudioSystem{ nullptr };
+            const uint16_t m_PoolIndex{};
+            AudioBus m_Bus{ AudioBus::Sfx };
             bool m_IsPaused{ false };
+            uint32_t m_PlayCount{};
+            // Owned by the streamer, which outlives the channels
+            AudioStream* m_pStream{ nullptr };
 
-            inline static VoiceCallback m_Callback{};
+            VoiceCallback m_Callback{ this };
         };
 
         //----------------------------------------------------------------------------------------------------------------------------
 
+        // What the game thread hands a bus's effect, through XAudio2's parameter blocks
+        struct BusEffectParameters
+        {
+            audio::EffectSettings settings{};
+            // The level of the bus that ducks this one, nullptr when the compressor follows this bus's own
+            const std::atomic<float>* pKeyLevel{};
+            // The bus's volume, its level is given to the buses it ducks as they hear it
+            float levelGain{ 1.f };
+        };
+
+        //----------------------------------------------------------------------------------------------------------------------------
+        // BusEffect class
+        // Runs a bus's effect chain on the XAudio2 thread, in place on its float frames, and keeps the level the chain put out for the buses it ducks.
+        // XAudio2 calls the buses one after another in no set order, so a bus ducks by its key's level of the pass before at the latest.
+        class BusEffect final : public CXAPOParametersBase
+        {
+        public:
+            BusEffect() :
+                CXAPOParametersBase{ &m_Registration, reinterpret_cast<BYTE*>(m_ParameterBlocks.data()), sizeof(BusEffectParameters), FALSE }
+            {
+            }
+            virtual ~BusEffect() = default;
+
+            BusEffect(const BusEffect&) = delete;
+            BusEffect(BusEffect&&) noexcept = delete;
+            BusEffect& operator=(const BusEffect&) = delete;
+            BusEffect& operator=(BusEffect&&) noexcept = delete;
+
+            const std::atomic<float>& GetLevel() const { return m_Level; }
+
+            // Before the voice processes, not on the XAudio2 thread, so the chain may allocate here
+            virtual HRESULT STDMETHODCALLTYPE LockForProcess(UINT32 inputCount, const XAPO_LOCKFORPROCESS_BUFFER_PARAMETERS* pInputs,
+                                                             UINT32 outputCount, const XAPO_LOCKFORPROCESS_BUFFER_PARAMETERS* pOutputs) override
+            {
+                const HRESULT hr{ CXAPOParametersBase::LockForProcess(inputCount, pInputs, outputCount, pOutputs) };
+                if (FAILED(hr)) return hr;
+
+                m_ChannelCount = pInputs[0].pFormat->nChannels;
+                m_Chain.Prepare(pInputs[0].pFormat->nSamplesPerSec, m_ChannelCount);
+                return S_OK;
+            }
+
+            virtual void STDMETHODCALLTYPE Process(UINT32 inputCount, const XAPO_PROCESS_BUFFER_PARAMETERS* pInputs,
+                                                   UINT32 outputCount, XAPO_PROCESS_BUFFER_PARAMETERS* pOutputs, BOOL isEnabled) override
+            {
+                assert(inputCount == 1 && outputCount == 1 && pInputs[0].pBuffer == pOutputs[0].pBuffer);
+                const auto& parameters{ *reinterpret_cast<const BusEffectParameters*>(BeginProcess()) };
+                if (ParametersChanged()) m_Chain.SetSettings(parameters.settings);
+
+                const XAPO_PROCESS_BUFFER_PARAMETERS& input{ pInputs[0] };
+                XAPO_PROCESS_BUFFER_PARAMETERS& output{ pOutputs[0] };
+                output.BufferFlags = input.BufferFlags;
+                output.ValidFrameCount = input.ValidFrameCount;
+
+                // A reverb rings on after its input goes silent, the other effects leave silence as it is
+                const bool isSilent{ input.BufferFlags == XAPO_BUFFER_SILENT };
+                float level{};
+                if (isEnabled && (!isSilent || parameters.settings.isReverbOn))
+                {
+                    const std::span<float> samples{ static_cast<float*>(input.pBuffer), std::size_t{ input.ValidFrameCount } * m_ChannelCount };
+                    if (isSilent) std::ranges::fill(samples, 0.f);
+
+                    std::optional<float> keyLevel{};
+                    if (parameters.pKeyLevel) keyLevel = parameters.pKeyLevel->load(std::memory_order_relaxed);
+                    m_Chain.Process(samples, keyLevel);
+                    output.BufferFlags = XAPO_BUFFER_VALID;
+                    level = m_Chain.GetPeak();
+                }
+                m_Level.store(level * parameters.levelGain, std::memory_order_relaxed);
+
+                EndProcess();
+            }
+
+        private:
+            inline static const XAPO_REGISTRATION_PROPERTIES m_Registration{
+                { 0x6d3b8f2a, 0x41c7, 0x4e59, { 0x9a, 0x0e, 0x27, 0xb4, 0x5c, 0x18, 0xd3, 0x6f } },
+                L"JelA Bus Effect", L"", 1, 0, XAPO_FLAGDEFAULT | XAPO_FLAG_INPLACE_REQUIRED, 1, 1, 1, 1 };
+
+            // XAudio2 hands the parameters over through three blocks, so neither thread waits for the other
+            std::array<BusEffectParameters, 3> m_ParameterBlocks{};
+            audio::EffectChain m_Chain{};
+            uint16_t m_ChannelCount{ 2 };
+            std::atomic<float> m_Level{};
+        };
+
+        //----------------------------------------------------------------------------------------------------------------------------
+
+        // A submix voice, which the voices of its sounds send to and which sends to the master
+        struct Bus
+        {
+            IXAudio2SubmixVoice* pVoice{};
+            // Shared with the voice, held until it is destroyed
+            BusEffect* pEffect{};
+            BusEffectParameters parameters{};
+            uint8_t volume{ 100 };
+            bool isMuted{ false };
+        };
+
+        static constexpr std::size_t m_BusCount{ 4 };
+
+        Bus& GetBus(AudioBus bus) { return m_Buses[static_cast<std::size_t>(bus)]; }
+        const Bus& GetBus(AudioBus bus) const { return m_Buses[static_cast<std::size_t>(bus)]; }
+
+        // One per bus, in the format of the master, so nothing gets converted on the way there
+        void CreateBuses()
+        {
+            XAUDIO2_VOICE_DETAILS details{};
+            m_pMasteringVoice->GetVoiceDetails(&details);
+            for (Bus& bus : m_Buses)
+            {
+                bus.pEffect = new BusEffect{};
+                XAUDIO2_EFFECT_DESCRIPTOR effect{ static_cast<IXAPO*>(bus.pEffect), TRUE, details.InputChannels };
+                const XAUDIO2_EFFECT_CHAIN effectChain{ 1, &effect };
+                if (FAILED(m_pAudioEngine->CreateSubmixVoice(&bus.pVoice, details.InputChannels, details.InputSampleRate, 0u, 0u, nullptr, &effectChain)))
+                {
+                    OutputDebugString(_T("ERROR! Unable to create an XAudio2 Submix Voice, the sounds of its bus play straight to the master.\n"));
+                    bus.pVoice = nullptr;
+                    SafeRelease(&bus.pEffect);
+                }
+                else CommitBusParameters(bus);
+            }
+        }
+
+        void ApplyBusVolume(Bus& bus)
+        {
+            const float fVolume{ bus.isMuted ? 0.f : bus.volume / 100.f };
+            if (bus.pVoice) bus.pVoice->SetVolume(fVolume);
+            bus.parameters.levelGain = fVolume;
+            CommitBusParameters(bus);
+        }
+
+        void CommitBusParameters(Bus& bus)
+        {
+            if (!bus.pVoice) return;
+            if (FAILED(bus.pVoice->SetEffectParameters(0, &bus.parameters, sizeof(BusEffectParameters))))
+                OutputDebugString(_T("WARNING! Setting the effects of a bus failed, it keeps the ones it had.\n"));
+        }
+
 
         WAVEFORMATEX* AddFormat(const WAVEFORMATEX& extractedFormat)
         {
@@ -599,44 +1065,138 @@ namespace jela
 
             const auto pFormat = m_VecSupportedFormats.emplace_back(std::make_unique<WAVEFORMATEX>(extractedFormat)).get();
 
-            std::lock_guard<std::mutex> lock{ m_ChannelMutex };
             m_ChannelPools.try_emplace(pFormat, FormatChannelPool{ this, pFormat });
 
             return pFormat;
         }
 
-        void PlayAudioFile(class AudioFile& s, bool repeat, float vol, float frequency, SoundInstanceID& instanceId)
+        void PlayAudioFile(AudioFile& s, bool repeat, float vol, float frequency, uint8_t priority, SoundInstanceID& instanceId)
         {
-            std::lock_guard<std::mutex> lock{ m_ChannelMutex };
-            const WAVEFORMATEX* const pSoundFormat{ s.GetFormatPtr() };
-            if (m_ChannelPools.contains(pSoundFormat))
+            ReleaseEndedChannels();
+            if (!s.HasFreeInstance())
             {
-                auto& [idles, actives] = m_ChannelPools.at(pSoundFormat);
-                if (idles.empty())
-                {
-                    OutputDebugString(std::format(_T("WARNING! When trying to play {}, no channels were available.\n"), s.GetFileName()).c_str());
-                    return;
-                }
+                OutputDebugString(std::format(_T("WARNING! When trying to play {}, it was already playing {} times.\n"), s.GetFileName(), AudioFile::m_MaxVoiceCount).c_str());
+                return;
+            }
+
+            Voice& voice{ AcquireVoice() };
+            s.AddVoice(voice, instanceId);
+            voice.pAudioFile = &s;
+            voice.volume = vol;
+            voice.frequency = std::clamp(frequency, XAUDIO2_MIN_FREQ_RATIO, XAUDIO2_MAX_FREQ_RATIO);
+            voice.playOrder = ++m_PlayOrder;
+            voice.priority = priority;
+            voice.isLooping = repeat;
+            const auto now{ VoiceTimeline::Clock::now() };
+            voice.timeline.Start(0, s.GetFormatPtr()->nSamplesPerSec * double{ voice.frequency }, now);
+            AcquireChannel(voice, now);
+        }
+
+        void StopVoice(Voice& voice)
+        {
+            if (voice.pChannel) voice.pChannel->Stop();
+            voice.pAudioFile->RemoveVoice(voice);
+            ReleaseVoice(voice);
+        }
 
-                actives.emplace_back(std::move(idles.back()));
-                idles.pop_back();
-                actives.back()->Play(s, repeat, vol, frequency, instanceId);
+        // Takes a free voice, or a new one when none is, and adds it to the ones that play
+        Voice& AcquireVoice()
+        {
+            Voice* pVoice{ nullptr };
+            if (m_FreeVoicePtrs.empty()) pVoice = &m_Voices.emplace_back();
+            else
+            {
+                pVoice = m_FreeVoicePtrs.back();
+                m_FreeVoicePtrs.pop_back();
+                *pVoice = Voice{};
             }
+
+            pVoice->index = m_VoicePtrs.size();
+            m_VoicePtrs.push_back(pVoice);
+            return *pVoice;
         }
 
-        void DeactivateChannel(Channel& channel)
+        void ReleaseVoice(Voice& voice)
+        {
+            // The last voice takes its place
+            const std::size_t index{ voice.index };
+            m_VoicePtrs[index] = m_VoicePtrs.back();
+            m_VoicePtrs[index]->index = index;
+            m_VoicePtrs.pop_back();
+
+            voice.pAudioFile = nullptr;
+            m_FreeVoicePtrs.push_back(&voice);
+        }
+
+        void PauseVoice(Voice& voice)
         {
-            std::lock_guard<std::mutex> lock{ m_ChannelMutex };
-            if (m_ChannelPools.contains(channel.GetFormatPtr()))
+            voice.timeline.Pause(VoiceTimeline::Clock::now());
+            if (voice.pChannel) voice.pChannel->Pause();
+        }
+
+        void ResumeVoice(Voice& voice)
+        {
+            if (!voice.timeline.IsPaused()) return;
+            const auto now{ VoiceTimeline::Clock::now() };
+            voice.timeline.Resume(now);
+            if (voice.pChannel) voice.pChannel->Resume();
+            else AcquireChannel(voice, now);
+        }
+
+        void SeekVoice(Voice& voice, uint64_t frame)
+        {
+            const AudioFile& s{ *voice.pAudioFile };
+            voice.timeline.Seek(ResolveFrame(frame, s.GetFrameCount(), voice.isLooping, s.GetLoopBegin(), s.GetLoopEnd()), VoiceTimeline::Clock::now());
+            if (voice.pChannel) voice.pChannel->Seek(frame);
+        }
+
+        // Plays the voice on an idle channel of its format. When there is none, it takes the channel of the voice
+        // that ranks lowest if it outranks that one, which then plays on virtually. Otherwise it stays virtual itself.
+        void AcquireChannel(Voice& voice, VoiceTimeline::Clock::time_point now)
+        {
+            FormatChannelPool& pool{ m_ChannelPools.at(voice.pAudioFile->GetFormatPtr()) };
+            if (pool.idleIndices.empty())
             {
-                auto& [idles, actives] = m_ChannelPools.at(channel.GetFormatPtr());
-                auto itChannel = std::ranges::find_if(actives, [&](const auto& channelPtr) { return channelPtr.get() == &channel; });
-                if (itChannel != actives.cend())
+                // None idle, so every channel has a voice
+                Voice* pWeakest{ nullptr };
+                for (const auto& pChannel : pool.channelPtrs)
                 {
-                    idles.emplace_back(std::move(*itChannel));
-                    actives.erase(itChannel);
+                    Voice* const pActive{ pChannel->GetVoice() };
+                    if (!pWeakest || m_VoiceSelector.Outranks(MakeCandidate(*pWeakest), MakeCandidate(*pActive))) pWeakest = pActive;
                 }
+                if (!pWeakest || !m_VoiceSelector.Outranks(MakeCandidate(voice), MakeCandidate(*pWeakest))) return;
+                pWeakest->pChannel->Stop();
             }
+            PlayOnIdleChannel(voice, now);
+        }
+
+        void PlayOnIdleChannel(Voice& voice, VoiceTimeline::Clock::time_point now)
+        {
+            assert(!voice.pChannel);
+            Channel* const pChannel{ m_ChannelPools.at(voice.pAudioFile->GetFormatPtr()).AcquireChannel() };
+            assert(pChannel);
+
+            const AudioFile& s{ *voice.pAudioFile };
+            const uint64_t frame{ ResolveFrame(voice.timeline.GetFrame(now), s.GetFrameCount(), voice.isLooping, s.GetLoopBegin(), s.GetLoopEnd()) };
+            pChannel->Play(voice, frame);
+        }
+
+        VoiceSelector::Candidate MakeCandidate(const Voice& voice) const
+        {
+            return { static_cast<uint32_t>(voice.index), voice.priority, voice.volume, voice.playOrder, voice.timeline.IsPaused(), voice.pChannel != nullptr };
+        }
+
+        AudioStreamer& GetStreamer()
+        {
+            // Its thread only runs once a sound streams
+            if (!m_pStreamer) m_pStreamer = std::make_unique<AudioStreamer>();
+            return *m_pStreamer;
+        }
+
+        void DeactivateChannel(Channel& channel)
+        {
+            if (const auto itPool = m_ChannelPools.find(channel.GetFormatPtr()); itPool != m_ChannelPools.end())
+                itPool->second.ReleaseChannel(channel.GetPoolIndex());
         }
 
     private:
@@ -647,27 +1207,62 @@ namespace jela
         {
             FormatChannelPool(AudioImpl* const pAudioSystem, const WAVEFORMATEX* const pFormat)
             {
-                idleChannelPtrs.reserve(amountOfChannels);
-                activeChannelPtrs.reserve(amountOfChannels);
+                channelPtrs.reserve(amountOfChannels);
+                idleIndices.reserve(amountOfChannels);
 
                 for (size_t i = 0; i < amountOfChannels; i++)
-                    idleChannelPtrs.emplace_back(std::make_unique<Channel>(pAudioSystem, pFormat));
+                {
+                    const auto index{ static_cast<uint16_t>(i) };
+                    channelPtrs.emplace_back(std::make_unique<Channel>(pAudioSystem, pFormat, index));
+                    idleIndices.push_back(index);
+                }
 
                 m_ChannelPoolCreated = true;
             }
 
             static constexpr size_t amountOfChannels{ 64 };
 
+            // nullptr when every channel is active
+            Channel* AcquireChannel()
+            {
+                if (idleIndices.empty()) return nullptr;
+
+                Channel* const pChannel{ channelPtrs[idleIndices.back()].get() };
+                idleIndices.pop_back();
+                return pChannel;
+            }
+
+            void ReleaseChannel(uint16_t index) { idleIndices.push_back(index); }
+            std::size_t GetActiveCount() const { return channelPtrs.size() - idleIndices.size(); }
+
             // We store unique ptrs in order for the Channel objects to stay in the same place in memory
             // This is necessary for the async callback (in the Channel class) that points to a channel object somewhere in memory
-            std::vector<std::unique_ptr<AudioImpl::Channel>> idleChannelPtrs{};
-            std::vector<std::unique_ptr<AudioImpl::Channel>> activeChannelPtrs{};
+            std::vector<std::unique_ptr<AudioImpl::Channel>> channelPtrs{};
+            // Of the idle channels in channelPtrs, reserved for all of them so a release never allocates
+            std::vector<uint16_t> idleIndices{};
+
+            // The voices of the format, filled by UpdateImpl and kept so it doesn't allocate every frame
+            std::vector<VoiceSelector::Candidate> candidates{};
         };
 
+        // Before the channels, so these outlive them: their voices can still call back while they are destroyed
+        MpscQueue<EndedChannel, 1024> m_EndedChannels{};
+        std::unique_ptr<AudioStreamer> m_pStreamer{};
+        // Every voice there ever was at once, a deque so they stay where they are as it grows, and reused after they stop.
+        // Before the audio files, which stop theirs when destroyed.
+        std::deque<Voice> m_Voices{};
+        std::vector<Voice*> m_FreeVoicePtrs{};
+        // The voices that play, heard or virtual
+        std::vector<Voice*> m_VoicePtrs{};
         std::map<SoundID, AudioFile> m_MapAudioFiles{};
         std::vector<std::unique_ptr<WAVEFORMATEX>> m_VecSupportedFormats{};
         std::unordered_map<const WAVEFORMATEX*, FormatChannelPool> m_ChannelPools{};
-        std::mutex m_ChannelMutex{};
+
+        // Indexed by AudioBus. Destroyed by hand after the channels.
+        std::array<Bus, m_BusCount> m_Buses{};
+
+        VoiceSelector m_VoiceSelector{};
+        uint64_t m_PlayOrder{};
 
         bool m_IsMute{ false };
         uint8_t m_LatestVolume{ 100 };
@@ -685,9 +1280,9 @@ namespace jela
         delete m_pImpl;
     }
 
-    void XAudio::AddSound(const tstring& filename, SoundID id)
+    void XAudio::AddSound(const tstring& filename, SoundID id, bool stream)
     {
-        m_pImpl->AddSoundImpl(filename, id);
+        m_pImpl->AddSoundImpl(filename, id, stream);
     }
 
     void XAudio::RemoveSound(SoundID id)
@@ -695,14 +1290,19 @@ namespace jela
         m_pImpl->RemoveSoundImpl(id);
     }
 
-    void XAudio::PlaySoundClip(SoundID id, bool repeat, uint8_t volume, float frequency) const
+    void XAudio::ReloadSound(const tstring& filename)
     {
-        m_pImpl->PlaySoundClipImpl(id, repeat, volume, frequency);
+        m_pImpl->ReloadSoundImpl(filename);
     }
 
-    void XAudio::PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume, float frequency) const
+    void XAudio::PlaySoundClip(SoundID id, bool repeat, uint8_t volume, float frequency, uint8_t priority) const
     {
-        m_pImpl->PlaySoundInstanceImpl(id, repeat, volume, instanceId, frequency);
+        m_pImpl->PlaySoundClipImpl(id, repeat, volume, frequency, priority);
+    }
+
+    void XAudio::PlaySoundInstance(SoundID id, bool repeat, SoundInstanceID& instanceId, uint8_t volume, float frequency, uint8_t priority) const
+    {
+        m_pImpl->PlaySoundInstanceImpl(id, repeat, volume, instanceId, frequency, priority);
     }
 
     uint8_t XAudio::GetMasterVolume() const
@@ -774,4 +1374,54 @@ namespace jela
     {
         m_pImpl->StopAllSoundsImpl();
     }
+
+    void XAudio::SeekSound(SoundID id, const SoundInstanceID& instanceId, float seconds) const
+    {
+        m_pImpl->SeekSoundImpl(id, instanceId, seconds);
+    }
+
+    void XAudio::Update()
+    {
+        m_pImpl->UpdateImpl();
+    }
+
+    void XAudio::SetVoiceStealPolicy(VoiceStealPolicy policy)
+    {
+        m_pImpl->SetVoiceStealPolicyImpl(policy);
+    }
+
+    VoiceStealPolicy XAudio::GetVoiceStealPolicy() const
+    {
+        return m_pImpl->GetVoiceStealPolicyImpl();
+    }
+
+    void XAudio::SetSoundBus(SoundID id, AudioBus bus)
+    {
+        m_pImpl->SetSoundBusImpl(id, bus);
+    }
+
+    uint8_t XAudio::GetBusVolume(AudioBus bus) const
+    {
+        return m_pImpl->GetBusVolumeImpl(bus);
+    }
+
+    void XAudio::SetBusVolume(AudioBus bus, uint8_t newVolume)
+    {
+        m_pImpl->SetBusVolumeImpl(bus, newVolume);
+    }
+
+    void XAudio::SetBusMute(AudioBus bus, bool isMuted)
+    {
+        m_pImpl->SetBusMuteImpl(bus, isMuted);
+    }
+
+    bool XAudio::IsBusMuted(AudioBus bus) const
+    {
+        return m_pImpl->IsBusMutedImpl(bus);
+    }
+
+    void XAudio::SetBusEffects(AudioBus bus, const audio::EffectSettings& settings, std::optional<AudioBus> keyBus)
+    {
+        m_pImpl->SetBusEffectsImpl(bus, settings, keyBus);
+    }
 }
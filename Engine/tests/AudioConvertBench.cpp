@@ -0,0 +1,65 @@
+#include "AudioConvert.h"
+#include "Bench.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// How fast sounds convert to the engine's format when they load, on a minute of stereo noise at 44.1 kHz:
+// each step alone, and whole conversions, in times real time and MB/s of the source.
+
+namespace
+{
+    using namespace jela;
+    using namespace jela::audio;
+
+    void Print(const char* pName, double seconds, double soundSeconds, std::size_t byteCount)
+    {
+        std::printf("%-48s %8.2f ms %8.0f x real time %7.0f MB/s\n", pName, seconds * 1e3, soundSeconds / seconds, byteCount / seconds / 1e6);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const double soundSeconds{ jela::test::IsQuickRun(argc, argv) ? 0.1 : 60 };
+    const int runCount{ jela::test::IsQuickRun(argc, argv) ? 1 : 5 };
+    const auto frameCount{ static_cast<std::size_t>(44100 * soundSeconds) };
+
+    std::mt19937 random{ 48 };
+    std::vector<float> stereo(frameCount * 2);
+    for (float& sample : stereo) sample = static_cast<float>(static_cast<int>(random() % 60001) - 30000) / 32768.f;
+
+    const WaveFormat stereo16{ MakePcmFormat(44100, 2, 16) };
+    std::vector<std::byte> data16(stereo.size() * 2);
+    EncodePcm(stereo, stereo16, data16);
+    WaveFormat stereo24{ stereo16 };
+    stereo24.bitsPerSample = 24;
+    stereo24.blockAlign = 6;
+    const std::vector<std::byte> data24(stereo.size() * 3);
+    const std::span<const std::byte> mono16{ data16.data(), frameCount * 2 };
+
+    std::vector<float> samples(stereo.size());
+    std::vector<float> left(frameCount);
+    std::vector<float> right(frameCount);
+    std::vector<float> mono(frameCount);
+    const auto measure{ [runCount](auto&& function) { return jela::test::MeasureSeconds(function, runCount); } };
+
+    Print("decode 16 bit stereo", measure([&] { DecodePcm(data16, stereo16, samples); }), soundSeconds, data16.size());
+    Print("encode 16 bit stereo", measure([&] { EncodePcm(samples, stereo16, data16); }), soundSeconds, data16.size());
+    Print("decode 24 bit stereo", measure([&] { DecodePcm(data24, stereo24, samples); }), soundSeconds, data24.size());
+    Print("deinterleave stereo", measure([&] { Deinterleave(samples, left, right); }), soundSeconds, samples.size() * 4);
+    Print("remix stereo to mono", measure([&] { RemixChannels(samples, 2, 0, mono, 1); }), soundSeconds, samples.size() * 4);
+    Print("remix mono to stereo", measure([&] { RemixChannels(mono, 1, 0, samples, 2); }), soundSeconds, mono.size() * 4);
+
+    std::size_t checksum{};
+    const auto convert{ [&](std::span<const std::byte> data, const WaveFormat& format, const WaveFormat& target)
+        {
+            return measure([&] { checksum += ConvertSound(data, format, target).size(); });
+        } };
+    Print("16 bit stereo 44.1 kHz to 48 kHz", convert(data16, stereo16, MakePcmFormat(48000, 2, 16)), soundSeconds, data16.size());
+    Print("16 bit stereo 44.1 kHz to mono 48 kHz", convert(data16, stereo16, MakePcmFormat(48000, 1, 16)), soundSeconds, data16.size());
+    Print("16 bit stereo 44.1 kHz to 22.05 kHz", convert(data16, stereo16, MakePcmFormat(22050, 2, 16)), soundSeconds, data16.size());
+    Print("24 bit stereo to 16 bit, same rate", convert(data24, stereo24, MakePcmFormat(44100, 2, 16)), soundSeconds, data24.size());
+    Print("16 bit mono to stereo, same rate", convert(mono16, MakePcmFormat(44100, 1, 16), MakePcmFormat(44100, 2, 16)), soundSeconds, mono16.size());
+    std::printf("(%zu)\n", checksum % 10);
+    return 0;
+}
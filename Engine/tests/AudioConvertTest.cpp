@@ -0,0 +1,250 @@
+#include "AudioConvert.h"
+#include "AudioKernels.h"
+#include "Check.h"
+#include <cmath>
+#include <cstdio>
+#include <cstring>
+#include <numbers>
+#include <random>
+#include <vector>
+
+// The sample format conversions exactly, and the quality of the resampling ConvertSound does: the noise it adds to a sine,
+// what it leaves of the frequencies a lower rate can't hold, and that it keeps the level of the ones it can.
+
+namespace
+{
+    using namespace jela;
+    using namespace jela::audio;
+
+    std::vector<float> MakeSine(double frequency, uint32_t sampleRate, std::size_t sampleCount, double amplitude = 0.5)
+    {
+        std::vector<float> samples(sampleCount);
+        for (std::size_t index = 0; index < sampleCount; ++index)
+            samples[index] = static_cast<float>(amplitude * std::sin(2 * std::numbers::pi * frequency * static_cast<double>(index) / sampleRate));
+        return samples;
+    }
+
+    std::vector<std::byte> Encode(std::span<const float> samples, const WaveFormat& format)
+    {
+        std::vector<std::byte> data(samples.size() * format.bitsPerSample / 8);
+        EncodePcm(samples, format, data);
+        return data;
+    }
+
+    std::vector<float> Decode(std::span<const std::byte> data, const WaveFormat& format)
+    {
+        std::vector<float> samples(data.size() / (format.bitsPerSample / 8));
+        DecodePcm(data, format, samples);
+        return samples;
+    }
+
+    double GetRms(std::span<const float> samples)
+    {
+        double sum{};
+        for (const float sample : samples) sum += double{ sample } * sample;
+        return std::sqrt(sum / static_cast<double>(samples.size()));
+    }
+
+    int16_t GetSample16(std::span<const std::byte> data, std::size_t index)
+    {
+        int16_t sample{};
+        std::memcpy(&sample, data.data() + index * 2, 2);
+        return sample;
+    }
+
+    // Two seconds of a sine, converted to a mono float sound of another rate
+    std::vector<float> Resample(double frequency, uint32_t sourceRate, uint32_t destinationRate, uint16_t bitsPerSample)
+    {
+        const std::vector<float> source{ MakeSine(frequency, sourceRate, std::size_t{ sourceRate } * 2) };
+        const WaveFormat sourceFormat{ MakePcmFormat(sourceRate, 1, 32) };
+        const WaveFormat destinationFormat{ MakePcmFormat(destinationRate, 1, bitsPerSample) };
+        std::vector<float> destination{ Decode(ConvertSound(Encode(source, sourceFormat), sourceFormat, destinationFormat), destinationFormat) };
+        CHECK(destination.size() == ConvertFrameCount(source.size(), sourceRate, destinationRate));
+        return destination;
+    }
+
+    // In dB, of the sine against the exact one at the new rate, without the tenth of a second at either end
+    double GetResampledSnr(double frequency, uint32_t sourceRate, uint32_t destinationRate, uint16_t bitsPerSample = 32)
+    {
+        const std::vector<float> destination{ Resample(frequency, sourceRate, destinationRate, bitsPerSample) };
+        const std::vector<float> expected{ MakeSine(frequency, destinationRate, destination.size()) };
+        double signal{};
+        double noise{};
+        for (std::size_t index = destinationRate / 10; index < destination.size() - destinationRate / 10; ++index)
+        {
+            const double error{ double{ destination[index] } - expected[index] };
+            signal += double{ expected[index] } * expected[index];
+            noise += error * error;
+        }
+        const double snr{ 10 * std::log10(signal / noise) };
+        std::printf("%5.1f kHz sine, %5u Hz to %5u Hz, %2u bit: SNR %5.1f dB\n", frequency / 1000, sourceRate, destinationRate, bitsPerSample, snr);
+        return snr;
+    }
+
+    // In dB, of the level of the sine after resampling against before
+    double GetResampledGain(double frequency, uint32_t sourceRate, uint32_t destinationRate)
+    {
+        const std::vector<float> destination{ Resample(frequency, sourceRate, destinationRate, 32) };
+        const double gain{ 20 * std::log10(GetRms(std::span{ destination }.subspan(destinationRate / 10, destination.size() - destinationRate / 5)) / (0.5 / std::sqrt(2.))) };
+        std::printf("%5.1f kHz sine, %5u Hz to %5u Hz: gain %7.2f dB\n", frequency / 1000, sourceRate, destinationRate, gain);
+        return gain;
+    }
+
+    void TestPcm16()
+    {
+        // Every 16 bit sample comes back unchanged, also the odd ones at the end the vector code leaves
+        std::mt19937 random{ 48 };
+        const WaveFormat format{ MakePcmFormat(48000, 1, 16) };
+        std::vector<std::byte> data(2 * 65543);
+        for (std::byte& byte : data) byte = static_cast<std::byte>(random());
+
+        const std::vector<float> samples{ Decode(data, format) };
+        CHECK(Encode(samples, format) == data);
+        for (std::size_t index = 0; index < samples.size(); ++index)
+        {
+            if (!CHECK(samples[index] == GetSample16(data, index) / 32768.f)) break;
+        }
+
+        // Full scale and past it saturate
+        const std::vector<float> clipped{ 1.f, -1.f, 2.f, -2.f, 0.5f };
+        const std::vector<std::byte> clippedData{ Encode(clipped, format) };
+        CHECK(GetSample16(clippedData, 0) == INT16_MAX && GetSample16(clippedData, 1) == INT16_MIN);
+        CHECK(GetSample16(clippedData, 2) == INT16_MAX && GetSample16(clippedData, 3) == INT16_MIN);
+        CHECK(GetSample16(clippedData, 4) == 16384);
+    }
+
+    void TestOtherSizes()
+    {
+        WaveFormat format8{ MakePcmFormat(8000, 1, 16) };
+        format8.bitsPerSample = 8;
+        format8.blockAlign = 1;
+        const std::vector<std::byte> data8{ std::byte{ 0 }, std::byte{ 128 }, std::byte{ 255 } };
+        CHECK(Decode(data8, format8) == std::vector<float>({ -1.f, 0.f, 127.f / 128.f }));
+
+        WaveFormat format24{ format8 };
+        format24.bitsPerSample = 24;
+        format24.blockAlign = 3;
+        const std::vector<std::byte> data24{ std::byte{ 0 }, std::byte{ 0 }, std::byte{ 0x80 }, std::byte{ 0xFF }, std::byte{ 0xFF }, std::byte{ 0x7F } };
+        std::vector<float> samples24(2);
+        DecodePcm(data24, format24, samples24);
+        CHECK(samples24[0] == -1.f && samples24[1] == 8388607.f / 8388608.f);
+
+        // 24 bits in frames of 4 bytes, the last one padding
+        WaveFormat padded{ format24 };
+        padded.blockAlign = 4;
+        const std::vector<std::byte> paddedData{ std::byte{ 0 }, std::byte{ 0 }, std::byte{ 0x40 }, std::byte{ 0x55 }, std::byte{ 0 }, std::byte{ 0 }, std::byte{ 0xC0 }, std::byte{ 0x55 } };
+        std::vector<float> paddedSamples(2);
+        DecodePcm(paddedData, padded, paddedSamples);
+        CHECK(paddedSamples[0] == 0.5f && paddedSamples[1] == -0.5f);
+        CHECK(CanDecode(padded) && !CanEncode(padded));
+        CHECK(!CanDecode(WaveFormat{ WaveFormat::imaAdpcm, 1, 8000, 0, 1, 4 }));
+    }
+
+    void TestChannels()
+    {
+        std::mt19937 random{ 48 };
+        constexpr std::size_t frameCount{ 1003 };
+        std::vector<float> stereo(2 * frameCount);
+        for (float& sample : stereo) sample = static_cast<float>(random() % 1000) / 1000.f;
+
+        std::vector<float> left(frameCount);
+        std::vector<float> right(frameCount);
+        std::vector<float> interleaved(stereo.size());
+        Deinterleave(stereo, left, right);
+        Interleave(left, right, interleaved);
+        CHECK(interleaved == stereo);
+
+        std::vector<float> mono(frameCount);
+        RemixChannels(stereo, 2, 0, mono, 1);
+        std::vector<float> upmixed(stereo.size());
+        RemixChannels(mono, 1, 0, upmixed, 2);
+        for (std::size_t frame = 0; frame < frameCount; ++frame)
+        {
+            if (!CHECK(left[frame] == stereo[frame * 2] && right[frame] == stereo[frame * 2 + 1])) break;
+            if (!CHECK(mono[frame] == (stereo[frame * 2] + stereo[frame * 2 + 1]) * 0.5f)) break;
+            if (!CHECK(upmixed[frame * 2] == mono[frame] && upmixed[frame * 2 + 1] == mono[frame])) break;
+        }
+
+        // 5.1 in the default order, front left, front right, center, LFE, back left and back right: a frame of each but the front right
+        const std::vector<float> surround{ 1, 0, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 1, 0, 0, 0, 0, 0, 0, 0, 1 };
+        std::vector<float> folded(8);
+        RemixChannels(surround, 6, 0, folded, 2);
+        CHECK(folded[0] == 1.f && folded[1] == 0.f);
+        CHECK_NEAR(folded[2], 0.7071, 1e-4);
+        CHECK_NEAR(folded[3], 0.7071, 1e-4);
+        CHECK(folded[4] == 0.f && folded[5] == 0.f && folded[6] == 0.f);
+        CHECK_NEAR(folded[7], 0.7071, 1e-4);
+
+        // With a mask of front left, front right, side left and side right the third channel is side left
+        const std::vector<float> quad{ 0, 0, 1, 0 };
+        std::vector<float> quadFolded(2);
+        RemixChannels(quad, 4, 0x1 | 0x2 | 0x200 | 0x400, quadFolded, 2);
+        CHECK_NEAR(quadFolded[0], 0.7071, 1e-4);
+        CHECK(quadFolded[1] == 0.f);
+    }
+
+    void TestFrames()
+    {
+        CHECK(ConvertFrame(44100, 44100, 48000) == 48000);
+        CHECK(ConvertFrameCount(1, 44100, 48000) == 2);
+        CHECK(ConvertFrameCount(44100, 44100, 22050) == 22050);
+        // Wider filters when going down far, so they still keep out what the lower rate can't hold
+        CHECK(SincResampler(48000, 48000).GetTapCount() == sincTapCount);
+        CHECK(SincResampler(96000, 22050).GetTapCount() == 140);
+        CHECK(SincResampler(400000, 1000).GetTapCount() == maxSincTapCount);
+    }
+
+    void TestResampleQuality()
+    {
+        CHECK(GetResampledSnr(1000, 44100, 48000) > 68);
+        CHECK(GetResampledSnr(1000, 22050, 48000) > 68);
+        CHECK(GetResampledSnr(1000, 48000, 44100) > 68);
+        CHECK(GetResampledSnr(1000, 48000, 22050) > 68);
+        CHECK(GetResampledSnr(8000, 44100, 48000) > 68);
+        CHECK(GetResampledSnr(8000, 48000, 22050) > 60);
+        // Rounding to 16 bits adds hardly any
+        CHECK(GetResampledSnr(1000, 44100, 48000, 16) > 68);
+
+        // Going down to 22.05 kHz keeps the level below 9 kHz and all but removes what is above 11 kHz
+        CHECK(std::abs(GetResampledGain(1000, 48000, 22050)) < 0.01);
+        CHECK(std::abs(GetResampledGain(8000, 48000, 22050)) < 0.01);
+        CHECK(GetResampledGain(12000, 48000, 22050) < -70);
+        CHECK(GetResampledGain(15000, 48000, 22050) < -70);
+        CHECK(GetResampledGain(20000, 48000, 22050) < -70);
+        CHECK(std::abs(GetResampledGain(1000, 22050, 48000)) < 0.01);
+        CHECK(std::abs(GetResampledGain(9000, 22050, 48000)) < 0.5);
+    }
+
+    // Everything at once: 24 bit stereo at 44.1 kHz with a sine on the left only, to 16 bit mono at 48 kHz
+    void TestConvertSound()
+    {
+        const std::vector<float> sine{ MakeSine(1000, 44100, 44100) };
+        WaveFormat format{ MakePcmFormat(44100, 2, 16) };
+        format.bitsPerSample = 24;
+        format.blockAlign = 6;
+        std::vector<std::byte> data(sine.size() * 6);
+        for (std::size_t index = 0; index < sine.size(); ++index)
+        {
+            const auto sample{ static_cast<int32_t>(std::lrint(sine[index] * 8388608.f)) };
+            for (std::size_t byte = 0; byte < 3; ++byte) data[index * 6 + byte] = static_cast<std::byte>(sample >> (byte * 8));
+        }
+
+        const WaveFormat target{ MakePcmFormat(48000, 1, 16) };
+        const std::vector<float> converted{ Decode(ConvertSound(data, format, target), target) };
+        CHECK(converted.size() == 48000);
+        // Half the sine, as the left channel is averaged with the silent right one
+        const double gain{ 20 * std::log10(GetRms(std::span{ converted }.subspan(4800, 38400)) / (0.25 / std::sqrt(2.))) };
+        CHECK(std::abs(gain) < 0.05);
+    }
+}
+
+int main()
+{
+    TestPcm16();
+    TestOtherSizes();
+    TestChannels();
+    TestFrames();
+    TestResampleQuality();
+    TestConvertSound();
+    return jela::test::GetResult();
+}
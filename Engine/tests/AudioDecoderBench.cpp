@@ -0,0 +1,70 @@
+#include "AudioDecoder.h"
+#include "Bench.h"
+#include "ImaAdpcm.h"
+#include "WaveWriter.h"
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Decoding IMA ADPCM blocks as a stream does when they play, against decoding them the way the specification writes it down.
+
+namespace
+{
+    using namespace jela;
+
+    void Measure(uint16_t channelCount, uint16_t blockAlign, int repeatCount)
+    {
+        const auto pDecoder{ audio::CreateBlockDecoder(test::MakeWaveFormat(WaveFormat::imaAdpcm, channelCount, 48000, blockAlign, 4)) };
+        constexpr std::size_t blockCount{ 256 };
+
+        std::mt19937 random{ 49 };
+        std::vector<std::byte> blocks(std::size_t{ blockAlign } * blockCount);
+        for (std::byte& byte : blocks) byte = static_cast<std::byte>(random());
+        for (std::size_t block = 0; block < blockCount; ++block)
+        {
+            for (std::size_t channel = 0; channel < channelCount; ++channel)
+            {
+                blocks[block * blockAlign + channel * 4 + 2] = static_cast<std::byte>(random() % 89);
+                blocks[block * blockAlign + channel * 4 + 3] = std::byte{};
+            }
+        }
+        const auto getBlock{ [&](std::size_t block) { return std::span<const std::byte>{ blocks }.subspan(block * blockAlign, blockAlign); } };
+
+        std::vector<int16_t> frames(pDecoder->GetFramesPerBlock() * channelCount);
+        int64_t checksum{};
+        const double decodeSeconds{ test::MeasureSeconds([&]
+            {
+                for (int repeat = 0; repeat < repeatCount; ++repeat)
+                {
+                    for (std::size_t block = 0; block < blockCount; ++block)
+                    {
+                        pDecoder->DecodeBlock(getBlock(block), frames);
+                        checksum += frames[block % frames.size()];
+                    }
+                }
+            }) };
+        const double referenceSeconds{ test::MeasureSeconds([&]
+            {
+                for (int repeat = 0; repeat < repeatCount; ++repeat)
+                {
+                    for (std::size_t block = 0; block < blockCount; ++block)
+                        checksum += test::ReferenceImaDecoder::DecodeBlock(getBlock(block), channelCount)[block % frames.size()];
+                }
+            }) };
+
+        const double sampleCount{ static_cast<double>(repeatCount) * blockCount * frames.size() };
+        std::printf("%u channel(s), blocks of %4u bytes: %5.2f ns per sample, %6.0f x real time at 48 kHz | reference %5.2f ns per sample (%lld)\n",
+            channelCount, blockAlign, decodeSeconds * 1e9 / sampleCount, sampleCount / decodeSeconds / (48000. * channelCount),
+            referenceSeconds * 1e9 / sampleCount, static_cast<long long>(checksum % 10));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int repeatCount{ jela::test::IsQuickRun(argc, argv) ? 1 : 100 };
+    Measure(1, 512, repeatCount);
+    Measure(1, 1024, repeatCount);
+    Measure(2, 2048, repeatCount);
+    Measure(6, 1536, repeatCount);
+    return 0;
+}
@@ -0,0 +1,124 @@
+#include "AudioDecoder.h"
+#include "Check.h"
+#include "FileExceptions.h"
+#include "ImaAdpcm.h"
+#include "WaveWriter.h"
+#include <random>
+#include <vector>
+
+// ImaAdpcmDecoder against the decoder of the specification, on random blocks of the layouts WAVE writers use,
+// and the formats it refuses.
+
+namespace
+{
+    using namespace jela;
+
+    WaveFormat MakeImaFormat(uint16_t channelCount, uint16_t blockAlign)
+    {
+        return test::MakeWaveFormat(WaveFormat::imaAdpcm, channelCount, 44100, blockAlign, 4);
+    }
+
+    // Any bits, with step indices past the last one now and then, which decoders clamp
+    std::vector<std::byte> MakeBlock(std::mt19937& random, uint16_t channelCount, uint16_t blockAlign)
+    {
+        std::vector<std::byte> block(blockAlign);
+        for (std::byte& byte : block) byte = static_cast<std::byte>(random());
+        for (std::size_t channel = 0; channel < channelCount; ++channel)
+        {
+            block[channel * 4 + 2] = static_cast<std::byte>(random() % 121);
+            block[channel * 4 + 3] = std::byte{};
+        }
+        return block;
+    }
+
+    // Worked out by hand from the step table: each nibble adds or takes step * (magnitude + 1/2) / 4 and moves the step index
+    void TestKnownSamples()
+    {
+        test::ReferenceImaDecoder::Channel channel{};
+        CHECK(channel.Decode(7) == 11 && channel.stepIndex == 8);
+        CHECK(channel.Decode(15) == -19 && channel.stepIndex == 16);
+        CHECK(channel.Decode(0) == -15 && channel.stepIndex == 15);
+
+        test::ReferenceImaDecoder::Channel loud{ 32767, 88 };
+        CHECK(loud.Decode(7) == 32767);
+
+        // A block of one channel, starting at 0 with the step index 0, then the nibbles above low first and the rest 0
+        std::vector<std::byte> block(8);
+        block[4] = std::byte{ 0xF7 };
+        const audio::ImaAdpcmDecoder decoder{ MakeImaFormat(1, 8) };
+        CHECK(decoder.GetFramesPerBlock() == 9);
+        std::vector<int16_t> frames(decoder.GetFramesPerBlock());
+        decoder.DecodeBlock(block, frames);
+        CHECK(frames[0] == 0 && frames[1] == 11 && frames[2] == -19 && frames[3] == -15);
+        CHECK(frames == test::ReferenceImaDecoder::DecodeBlock(block, 1));
+    }
+
+    void TestAgainstReference()
+    {
+        std::mt19937 random{ 49 };
+        struct Layout
+        {
+            uint16_t channelCount;
+            uint16_t blockAlign;
+        };
+        // What writers use at 22 to 48 kHz, an odd number of channels and 5.1, and the smallest blocks there are
+        for (const Layout layout : { Layout{ 1, 256 }, Layout{ 1, 512 }, Layout{ 1, 1024 }, Layout{ 2, 2048 }, Layout{ 3, 1548 }, Layout{ 6, 1536 }, Layout{ 1, 8 }, Layout{ 2, 40 } })
+        {
+            const auto pDecoder{ audio::CreateBlockDecoder(MakeImaFormat(layout.channelCount, layout.blockAlign)) };
+            CHECK(pDecoder->GetBlockSize() == layout.blockAlign);
+            CHECK(pDecoder->GetFramesPerBlock() == (layout.blockAlign - 4u * layout.channelCount) / (4u * layout.channelCount) * 8 + 1);
+            CHECK(pDecoder->GetDecodedFormat().channelCount == layout.channelCount && pDecoder->GetDecodedFormat().bitsPerSample == 16);
+            CHECK(pDecoder->GetFrameCount(layout.blockAlign * 10 + 3) == pDecoder->GetFramesPerBlock() * 10);
+
+            std::vector<int16_t> frames(pDecoder->GetFramesPerBlock() * layout.channelCount);
+            for (int blockIndex = 0; blockIndex < 200; ++blockIndex)
+            {
+                const std::vector<std::byte> block{ MakeBlock(random, layout.channelCount, layout.blockAlign) };
+                pDecoder->DecodeBlock(block, frames);
+                if (!CHECK(frames == test::ReferenceImaDecoder::DecodeBlock(block, layout.channelCount))) break;
+            }
+        }
+    }
+
+    void TestRefusedFormats()
+    {
+        const auto isRefused{ [](const WaveFormat& format)
+            {
+                try
+                {
+                    audio::ImaAdpcmDecoder{ format };
+                }
+                catch (const FileTypeNotSupportedException&)
+                {
+                    return true;
+                }
+                return false;
+            } };
+
+        CHECK(!isRefused(MakeImaFormat(2, 2048)));
+        // Blocks that don't hold whole words of every channel, or nothing but the headers
+        CHECK(isRefused(MakeImaFormat(2, 2050)));
+        CHECK(isRefused(MakeImaFormat(2, 8)));
+        CHECK(isRefused(MakeImaFormat(0, 256)));
+        WaveFormat threeBits{ MakeImaFormat(1, 256) };
+        threeBits.bitsPerSample = 3;
+        CHECK(isRefused(threeBits));
+
+        // The samples per block the extra data gives have to be what the blocks hold
+        const std::vector<std::byte> rightCount{ std::byte{ 0xF9 }, std::byte{ 0x07 } };
+        const std::vector<std::byte> wrongCount{ std::byte{ 0x01 }, std::byte{ 0x02 } };
+        WaveFormat format{ MakeImaFormat(2, 2048) };
+        format.extraData = rightCount;
+        CHECK(!isRefused(format));
+        format.extraData = wrongCount;
+        CHECK(isRefused(format));
+    }
+}
+
+int main()
+{
+    TestKnownSamples();
+    TestAgainstReference();
+    TestRefusedFormats();
+    return jela::test::GetResult();
+}
@@ -0,0 +1,74 @@
+#include "AudioDsp.h"
+#include "Bench.h"
+#include "ReferenceBiquad.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// What each effect of a bus costs per sample, on blocks of 512 frames of mono and stereo noise.
+
+namespace
+{
+    using namespace jela;
+    using namespace jela::audio;
+
+    constexpr uint32_t sampleRate{ 48000 };
+    constexpr std::size_t blockFrameCount{ 512 };
+
+    template <typename Effect>
+    void Measure(const char* pName, uint16_t channelCount, int blockCount, Effect&& effect)
+    {
+        std::mt19937 random{ 50 };
+        std::uniform_real_distribution<float> distribution{ -0.5f, 0.5f };
+        std::vector<float> source(blockFrameCount * channelCount);
+        for (float& sample : source) sample = distribution(random);
+        std::vector<float> samples(source.size());
+
+        float checksum{};
+        const double seconds{ test::MeasureSeconds([&]
+            {
+                for (int block = 0; block < blockCount; ++block)
+                {
+                    std::ranges::copy(source, samples.begin());
+                    effect(std::span<float>{ samples });
+                    checksum += samples[block % samples.size()];
+                }
+            }) };
+        std::printf("%-24s %u channel(s): %6.2f ns per sample (%.1f)\n", pName, channelCount, seconds * 1e9 / (static_cast<double>(blockCount) * samples.size()), checksum);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int blockCount{ jela::test::IsQuickRun(argc, argv) ? 2 : 20000 };
+    for (const uint16_t channelCount : { 1, 2 })
+    {
+        const BiquadCoefficients lowPass{ MakeLowPass(sampleRate, 1000) };
+        Biquad biquad{};
+        biquad.SetCoefficients(lowPass);
+        Measure("biquad", channelCount, blockCount, [&](std::span<float> samples) { biquad.Process(samples, channelCount); });
+        jela::test::ReferenceBiquad reference{ lowPass, channelCount };
+        Measure("biquad, sample by sample", channelCount, blockCount, [&](std::span<float> samples) { reference.Process(samples, channelCount); });
+
+        Compressor compressor{};
+        compressor.SetSettings(CompressorSettings{ -18.f, 4.f, 10.f, 150.f, 0.f }, sampleRate);
+        Measure("compressor", channelCount, blockCount, [&](std::span<float> samples) { compressor.Process(samples, channelCount); });
+        Compressor ducker{};
+        ducker.SetSettings(CompressorSettings{ -30.f, 10.f, 5.f, 200.f, 0.f }, sampleRate);
+        Measure("compressor, keyed", channelCount, blockCount, [&](std::span<float> samples) { ducker.Process(samples, channelCount, 0.5f); });
+
+        Reverb reverb{};
+        reverb.Prepare(sampleRate);
+        reverb.SetSettings(ReverbSettings{});
+        Measure("reverb", channelCount, blockCount, [&](std::span<float> samples) { reverb.Process(samples, channelCount); });
+
+        EffectSettings settings{};
+        settings.isHighPassOn = settings.isLowPassOn = settings.isCompressorOn = settings.isReverbOn = true;
+        EffectChain chain{};
+        chain.Prepare(sampleRate, channelCount);
+        chain.SetSettings(settings);
+        Measure("every effect", channelCount, blockCount, [&](std::span<float> samples) { chain.Process(samples); });
+    }
+    return 0;
+}
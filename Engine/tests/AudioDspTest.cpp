@@ -0,0 +1,189 @@
+#include "AudioDsp.h"
+#include "AudioKernels.h"
+#include "Check.h"
+#include "ReferenceBiquad.h"
+#include <array>
+#include <cmath>
+#include <numbers>
+#include <random>
+#include <vector>
+
+// The effects of a bus: the vector biquad against one worked out a sample at a time, the response of the filters,
+// the gain the compressor settles on, with its own level and keyed by another, and the reverb's tail.
+
+namespace
+{
+    using namespace jela;
+    using namespace jela::audio;
+
+    constexpr uint32_t sampleRate{ 48000 };
+
+    double ToDb(double gain)
+    {
+        return 20 * std::log10(gain);
+    }
+
+    void TestBiquadAgainstReference()
+    {
+        std::mt19937 random{ 50 };
+        std::uniform_real_distribution<float> distribution{ -1.f, 1.f };
+
+        for (const uint16_t channelCount : { 1, 2, 3, 6 })
+        {
+            for (const BiquadCoefficients& coefficients : { MakeLowPass(sampleRate, 1000), MakeHighPass(sampleRate, 80), MakeLowPass(44100, 15000, 2.f) })
+            {
+                Biquad biquad{};
+                biquad.SetCoefficients(coefficients);
+                test::ReferenceBiquad reference{ coefficients, channelCount };
+
+                // Blocks of all sizes, so the state goes on from frames the vector code left over
+                float maxError{};
+                for (std::size_t block = 0; block < 20; ++block)
+                {
+                    std::vector<float> samples((block * 37 % 101 + 1) * channelCount);
+                    for (float& sample : samples) sample = distribution(random);
+                    std::vector<float> expected{ samples };
+
+                    biquad.Process(samples, channelCount);
+                    reference.Process(expected, channelCount);
+                    for (std::size_t index = 0; index < samples.size(); ++index) maxError = std::max(maxError, std::abs(samples[index] - expected[index]));
+                }
+                CHECK(maxError < 1e-4f);
+            }
+        }
+    }
+
+    // The peak of the second half of a second of a stereo sine through the filter
+    float GetFilteredPeak(float frequency, const BiquadCoefficients& coefficients)
+    {
+        Biquad biquad{};
+        biquad.SetCoefficients(coefficients);
+        std::vector<float> samples(2 * sampleRate);
+        for (std::size_t frame = 0; frame < sampleRate; ++frame)
+            samples[frame * 2] = samples[frame * 2 + 1] = static_cast<float>(std::sin(2 * std::numbers::pi * frequency * static_cast<double>(frame) / sampleRate));
+        biquad.Process(samples, 2);
+        return GetPeak(std::span<const float>{ samples }.subspan(sampleRate));
+    }
+
+    void TestFilterResponse()
+    {
+        CHECK_NEAR(GetFilteredPeak(100, MakeLowPass(sampleRate, 1000)), 1., 0.01);
+        CHECK_NEAR(GetFilteredPeak(1000, MakeLowPass(sampleRate, 1000)), 0.7071, 0.01);
+        CHECK(GetFilteredPeak(10000, MakeLowPass(sampleRate, 1000)) < 0.02f);
+        CHECK(GetFilteredPeak(20, MakeHighPass(sampleRate, 200)) < 0.02f);
+        CHECK_NEAR(GetFilteredPeak(5000, MakeHighPass(sampleRate, 200)), 1., 0.01);
+    }
+
+    void TestCompressor()
+    {
+        const CompressorSettings settings{ -18.f, 4.f, 10.f, 150.f, 0.f };
+
+        // Full scale is 18 dB over the threshold, of which a ratio of 4 leaves 4.5
+        Compressor compressor{};
+        compressor.SetSettings(settings, sampleRate);
+        std::vector<float> stereo(2 * sampleRate, 1.f);
+        compressor.Process(stereo, 2);
+        CHECK_NEAR(ToDb(compressor.GetGain()), -13.5, 0.2);
+
+        // The same for mono, and with frames past the last whole control block
+        Compressor monoCompressor{};
+        monoCompressor.SetSettings(settings, sampleRate);
+        std::vector<float> mono(sampleRate + 7, 1.f);
+        monoCompressor.Process(mono, 1);
+        CHECK_NEAR(monoCompressor.GetGain(), compressor.GetGain(), 1e-3);
+
+        // Below the threshold nothing changes
+        Compressor quietCompressor{};
+        quietCompressor.SetSettings(settings, sampleRate);
+        std::vector<float> quiet(2000, 0.05f);
+        quietCompressor.Process(quiet, 2);
+        CHECK(quiet.back() == 0.05f);
+        CHECK(quietCompressor.GetGain() == 1.f);
+    }
+
+    void TestDucking()
+    {
+        Compressor ducker{};
+        ducker.SetSettings(CompressorSettings{ -30.f, 10.f, 5.f, 200.f, 0.f }, sampleRate);
+
+        // A key at full scale takes a quiet signal down by 30 dB less a tenth
+        std::vector<float> samples(2 * 4800, 0.1f);
+        ducker.Process(samples, 2, 1.f);
+        CHECK_NEAR(ToDb(ducker.GetGain()), -27., 0.2);
+        CHECK(samples.back() < 0.01f);
+
+        // Once the key goes quiet, the gain comes back over the release
+        ducker.Process(samples, 2, 0.f);
+        const float releasingGain{ ducker.GetGain() };
+        std::vector<float> later(2 * sampleRate, 0.1f);
+        ducker.Process(later, 2, 0.f);
+        CHECK(releasingGain < ducker.GetGain());
+        CHECK(ducker.GetGain() > 0.99f);
+    }
+
+    void TestReverb()
+    {
+        // An impulse leaves a tail that dies out, different on either side
+        Reverb reverb{};
+        reverb.Prepare(sampleRate);
+        reverb.SetSettings(ReverbSettings{});
+        std::vector<float> samples(2 * sampleRate * 3);
+        samples[0] = samples[1] = 1.f;
+        reverb.Process(samples, 2);
+
+        std::array<double, 3> energies{};
+        bool isWide{};
+        bool isFinite{ true };
+        for (std::size_t frame = 0; frame < sampleRate * 3; ++frame)
+        {
+            energies[frame / sampleRate] += double{ samples[frame * 2] } * samples[frame * 2];
+            if (frame > 0 && samples[frame * 2] != samples[frame * 2 + 1]) isWide = true;
+            if (!std::isfinite(samples[frame * 2]) || !std::isfinite(samples[frame * 2 + 1])) isFinite = false;
+        }
+        CHECK(isFinite && isWide);
+        CHECK(energies[0] > energies[1] && energies[1] > energies[2] && energies[2] > 0.);
+
+        // Even the largest room without damping dies out
+        Reverb largeRoom{};
+        largeRoom.Prepare(44100);
+        largeRoom.SetSettings(ReverbSettings{ 1.f, 0.f, 1.f, 1.f });
+        std::vector<float> mono(44100 * 10);
+        mono[0] = 1.f;
+        largeRoom.Process(mono, 1);
+        CHECK(GetPeak(std::span<const float>{ mono }.subspan(44100 * 9)) < 0.5f);
+    }
+
+    void TestChain()
+    {
+        std::mt19937 random{ 50 };
+        std::uniform_real_distribution<float> distribution{ -1.f, 1.f };
+        std::vector<float> samples(2 * 480);
+        for (float& sample : samples) sample = distribution(random);
+
+        EffectSettings settings{};
+        settings.isHighPassOn = settings.isLowPassOn = settings.isCompressorOn = settings.isReverbOn = true;
+        EffectChain chain{};
+        chain.Prepare(sampleRate, 2);
+        chain.SetSettings(settings);
+        chain.Process(samples);
+        CHECK(chain.GetPeak() > 0.f);
+
+        // With every effect off, it passes the samples through
+        const std::vector<float> unchanged{ samples };
+        EffectChain emptyChain{};
+        emptyChain.Process(samples);
+        CHECK(samples == unchanged);
+        CHECK(emptyChain.GetPeak() == GetPeak(unchanged));
+    }
+}
+
+int main()
+{
+    TestBiquadAgainstReference();
+    TestFilterResponse();
+    TestCompressor();
+    TestDucking();
+    TestReverb();
+    TestChain();
+    return jela::test::GetResult();
+}
@@ -0,0 +1,61 @@
+#include "AudioMixer.h"
+#include "Bench.h"
+#include "WaveFile.h"
+#include "WaveWriter.h"
+#include <cmath>
+#include <cstdio>
+#include <vector>
+
+// How many voices the mixing thread of SoftwareAudio mixes per millisecond, with each resampler,
+// for sounds at the output rate, at another rate and played faster.
+
+namespace
+{
+    using namespace jela;
+
+    constexpr uint32_t sampleRate{ 48000 };
+    constexpr uint32_t blockFrameCount{ 256 };
+    constexpr uint16_t voiceCount{ 64 };
+
+    std::vector<std::byte> MakeTone(uint16_t channelCount, uint32_t toneSampleRate)
+    {
+        std::vector<int16_t> samples(std::size_t{ toneSampleRate } * channelCount);
+        for (std::size_t index = 0; index < samples.size(); ++index) samples[index] = static_cast<int16_t>(8000 * std::sin(index * 0.05));
+        return test::MakePcmWave(channelCount, toneSampleRate, samples);
+    }
+
+    void Measure(const char* pName, AudioMixer::Resampler resampler, const MixerSound& sound, float frequency, int blockCount)
+    {
+        AudioMixer mixer{ sampleRate, blockFrameCount, voiceCount, resampler };
+        for (uint16_t voice = 0; voice < voiceCount; ++voice) mixer.Play(voice, &sound, true, 0.1f, frequency);
+
+        float checksum{};
+        const double seconds{ test::MeasureSeconds([&]
+            {
+                for (int block = 0; block < blockCount; ++block) checksum += mixer.Mix()[0];
+            }) };
+
+        const double voiceBlocks{ static_cast<double>(voiceCount) * blockCount };
+        const double blockSeconds{ static_cast<double>(blockFrameCount) / sampleRate };
+        std::printf("%-9s %-18s %8.1f voice blocks of %u frames per ms, %6.1f ns per voice frame, %6.0f voices in real time (%.1f)\n",
+            resampler == AudioMixer::Resampler::Linear ? "linear" : "polyphase", pName, voiceBlocks / (seconds * 1e3), blockFrameCount,
+            seconds * 1e9 / (voiceBlocks * blockFrameCount), voiceBlocks * blockSeconds / seconds, checksum);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int blockCount{ jela::test::IsQuickRun(argc, argv) ? 2 : 2000 };
+
+    const jela::MixerSound monoAtRate{ jela::WaveFile{ MakeTone(1, sampleRate) } };
+    const jela::MixerSound monoResampled{ jela::WaveFile{ MakeTone(1, 44100) } };
+    const jela::MixerSound stereoAtRate{ jela::WaveFile{ MakeTone(2, sampleRate) } };
+
+    for (const auto resampler : { jela::AudioMixer::Resampler::Linear, jela::AudioMixer::Resampler::Polyphase })
+    {
+        Measure("mono 48 kHz", resampler, monoAtRate, 1.f, blockCount);
+        Measure("mono 44.1 kHz", resampler, monoResampled, 1.f, blockCount);
+        Measure("stereo 48 kHz x1.1", resampler, stereoAtRate, 1.1f, blockCount);
+    }
+    return 0;
+}
@@ -0,0 +1,34 @@
+#ifndef BENCH_H
+#define BENCH_H
+
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+
+namespace jela::test
+{
+    //---------------------------------------------------------------
+    // The fastest of a few runs, in seconds. The fastest rather than the mean, it is the least disturbed by the rest of the machine.
+    template <typename Function>
+    double MeasureSeconds(Function&& function, int runCount = 5)
+    {
+        double best{ 1e30 };
+        for (int run = 0; run < runCount; ++run)
+        {
+            const auto start = std::chrono::steady_clock::now();
+            function();
+            best = std::min(best, std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count());
+        }
+        return best;
+    }
+
+    // Benchmarks take --quick to do a fraction of the work, ctest runs them that way to check they still work
+    inline bool IsQuickRun(int argc, char* argv[])
+    {
+        return argc > 1 && std::strcmp(argv[1], "--quick") == 0;
+    }
+    //---------------------------------------------------------------
+}
+
+#endif // !BENCH_H
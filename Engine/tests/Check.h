@@ -0,0 +1,53 @@
+#ifndef CHECK_H
+#define CHECK_H
+
+#include <atomic>
+#include <cmath>
+#include <cstdio>
+
+namespace jela::test
+{
+    //---------------------------------------------------------------
+    // Just enough of a test framework for the tests here: a failed CHECK prints where it failed and the test goes on.
+    // main returns GetResult(), so ctest sees the test fail when any check did. Checks may fail on any thread.
+    inline std::atomic<int>& GetFailCount()
+    {
+        static std::atomic<int> failCount{};
+        return failCount;
+    }
+
+    inline bool Check(bool condition, const char* expression, const char* file, int line)
+    {
+        if (!condition)
+        {
+            GetFailCount().fetch_add(1, std::memory_order_relaxed);
+            std::fprintf(stderr, "%s(%d): CHECK(%s) failed\n", file, line, expression);
+        }
+        return condition;
+    }
+
+    inline bool CheckNear(double value, double expected, double tolerance, const char* expression, const char* file, int line)
+    {
+        const bool isNear{ std::abs(value - expected) <= tolerance };
+        if (!isNear)
+        {
+            GetFailCount().fetch_add(1, std::memory_order_relaxed);
+            std::fprintf(stderr, "%s(%d): CHECK_NEAR(%s) failed: %g, expected %g within %g\n", file, line, expression, value, expected, tolerance);
+        }
+        return isNear;
+    }
+
+    inline int GetResult()
+    {
+        const int failCount{ GetFailCount().load() };
+        if (failCount == 0) std::puts("All checks passed");
+        else std::printf("%d checks failed\n", failCount);
+        return failCount == 0 ? 0 : 1;
+    }
+    //---------------------------------------------------------------
+}
+
+#define CHECK(condition) ::jela::test::Check(static_cast<bool>(condition), #condition, __FILE__, __LINE__)
+#define CHECK_NEAR(value, expected, tolerance) ::jela::test::CheckNear((value), (expected), (tolerance), #value, __FILE__, __LINE__)
+
+#endif // !CHECK_H
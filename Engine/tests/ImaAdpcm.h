@@ -0,0 +1,73 @@
+#ifndef IMAADPCM_H
+#define IMAADPCM_H
+
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jela::test
+{
+    //---------------------------------------------------------------
+    // IMA ADPCM decoded the way the specification writes it down, a sample at a time testing the bits of each nibble,
+    // to check the engine's decoder against and to time it by.
+    class ReferenceImaDecoder final
+    {
+    public:
+        struct Channel
+        {
+            int32_t predictor{};
+            int32_t stepIndex{};
+
+            int16_t Decode(uint32_t nibble)
+            {
+                static constexpr std::array<int32_t, 89> stepSizes{
+                    7, 8, 9, 10, 11, 12, 13, 14, 16, 17, 19, 21, 23, 25, 28, 31, 34, 37, 41, 45, 50, 55, 60, 66, 73, 80, 88, 97, 107, 118, 130, 143,
+                    157, 173, 190, 209, 230, 253, 279, 307, 337, 371, 408, 449, 494, 544, 598, 658, 724, 796, 876, 963, 1060, 1166, 1282, 1411, 1552,
+                    1707, 1878, 2066, 2272, 2499, 2749, 3024, 3327, 3660, 4026, 4428, 4871, 5358, 5894, 6484, 7132, 7845, 8630, 9493, 10442, 11487,
+                    12635, 13899, 15289, 16818, 18500, 20350, 22385, 24623, 27086, 29794, 32767 };
+                static constexpr std::array<int32_t, 8> indexSteps{ -1, -1, -1, -1, 2, 4, 6, 8 };
+
+                const int32_t step{ stepSizes[stepIndex] };
+                int32_t difference{ step >> 3 };
+                if (nibble & 4) difference += step;
+                if (nibble & 2) difference += step >> 1;
+                if (nibble & 1) difference += step >> 2;
+                predictor = std::clamp(nibble & 8 ? predictor - difference : predictor + difference, -32768, 32767);
+                stepIndex = std::clamp(stepIndex + indexSteps[nibble & 7], 0, 88);
+                return static_cast<int16_t>(predictor);
+            }
+        };
+
+        // A block of blockSize bytes, to interleaved frames
+        static std::vector<int16_t> DecodeBlock(std::span<const std::byte> block, std::size_t channelCount)
+        {
+            const auto byteAt{ [&block](std::size_t index) { return std::to_integer<uint32_t>(block[index]); } };
+            const std::size_t wordCount{ (block.size() - channelCount * 4) / (channelCount * 4) };
+            std::vector<int16_t> frames((wordCount * 8 + 1) * channelCount);
+
+            for (std::size_t channel = 0; channel < channelCount; ++channel)
+            {
+                Channel state{ static_cast<int16_t>(byteAt(channel * 4) | byteAt(channel * 4 + 1) << 8), std::min(static_cast<int32_t>(byteAt(channel * 4 + 2)), 88) };
+                frames[channel] = static_cast<int16_t>(state.predictor);
+                std::size_t frame{ 1 };
+                for (std::size_t word = 0; word < wordCount; ++word)
+                {
+                    const std::size_t wordOffset{ channelCount * 4 + (word * channelCount + channel) * 4 };
+                    for (std::size_t index = 0; index < 4; ++index)
+                    {
+                        const uint32_t byte{ byteAt(wordOffset + index) };
+                        frames[frame++ * channelCount + channel] = state.Decode(byte & 0xF);
+                        frames[frame++ * channelCount + channel] = state.Decode(byte >> 4);
+                    }
+                }
+            }
+            return frames;
+        }
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !IMAADPCM_H
@@ -0,0 +1,162 @@
+#include "Bench.h"
+#include "MpscQueue.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <queue>
+#include <thread>
+#include <vector>
+
+// The MpscQueue against the mutex and condition variable queue Audio used before it:
+// throughput with producers pushing as fast as they can, and the cost of a push at a game's pace.
+
+namespace
+{
+    using namespace jela;
+    using Clock = std::chrono::steady_clock;
+
+    // The size of an audio command
+    struct Command
+    {
+        uint32_t type;
+        uint32_t id;
+        float volume;
+        float frequency;
+        int64_t pushTime;
+    };
+
+    class LockedQueue final
+    {
+    public:
+        bool TryPush(const Command& command)
+        {
+            {
+                const std::lock_guard<std::mutex> lock{ m_Mutex };
+                m_Commands.push(command);
+            }
+            m_Condition.notify_one();
+            return true;
+        }
+        bool TryPop(Command& command)
+        {
+            const std::lock_guard<std::mutex> lock{ m_Mutex };
+            if (m_Commands.empty()) return false;
+            command = m_Commands.front();
+            m_Commands.pop();
+            return true;
+        }
+        void Wait()
+        {
+            std::unique_lock<std::mutex> lock{ m_Mutex };
+            m_Condition.wait(lock, [this] { return !m_Commands.empty(); });
+        }
+
+    private:
+        std::mutex m_Mutex{};
+        std::condition_variable m_Condition{};
+        std::queue<Command> m_Commands{};
+    };
+
+    using LockFreeQueue = MpscQueue<Command, 1024>;
+
+    int64_t GetNanoseconds()
+    {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now().time_since_epoch()).count();
+    }
+
+    template <typename Queue>
+    void MeasureThroughput(const char* name, int producerCount, int commandCount)
+    {
+        auto pQueue{ std::make_unique<Queue>() };
+        const int commandsPerProducer{ commandCount / producerCount };
+
+        const double seconds{ test::MeasureSeconds([&]
+            {
+                std::thread consumer{ [&]
+                    {
+                        Command command{};
+                        for (int receivedCount = 0; receivedCount < commandsPerProducer * producerCount;)
+                        {
+                            if (pQueue->TryPop(command)) ++receivedCount;
+                            else pQueue->Wait();
+                        }
+                    } };
+
+                std::vector<std::thread> producers{};
+                for (int producer = 0; producer < producerCount; ++producer)
+                {
+                    producers.emplace_back([&]
+                        {
+                            for (int index = 0; index < commandsPerProducer; ++index)
+                            {
+                                while (!pQueue->TryPush({ 1, static_cast<uint32_t>(index), 1.f, 1.f, 0 })) std::this_thread::yield();
+                            }
+                        });
+                }
+                for (std::thread& producer : producers) producer.join();
+                consumer.join();
+            }, 3) };
+
+        std::printf("%-9s %d producer(s): %7.1f M commands/s\n", name, producerCount, commandsPerProducer * producerCount / seconds / 1e6);
+    }
+
+    // A few commands a frame, the consumer asleep in between, as with the game thread and the audio thread
+    template <typename Queue>
+    void MeasureLatency(const char* name, int frameCount)
+    {
+        constexpr int commandsPerFrame{ 4 };
+        auto pQueue{ std::make_unique<Queue>() };
+        std::vector<double> pushNanoseconds{};
+        std::vector<double> deliveryMicroseconds{};
+
+        std::thread consumer{ [&]
+            {
+                Command command{};
+                while (static_cast<int>(deliveryMicroseconds.size()) < frameCount * commandsPerFrame)
+                {
+                    if (pQueue->TryPop(command)) deliveryMicroseconds.push_back((GetNanoseconds() - command.pushTime) / 1000.0);
+                    else pQueue->Wait();
+                }
+            } };
+
+        for (int frame = 0; frame < frameCount; ++frame)
+        {
+            for (int index = 0; index < commandsPerFrame; ++index)
+            {
+                const int64_t start{ GetNanoseconds() };
+                pQueue->TryPush({ 1, 0, 1.f, 1.f, start });
+                pushNanoseconds.push_back(static_cast<double>(GetNanoseconds() - start));
+            }
+            std::this_thread::sleep_for(std::chrono::microseconds{ 500 });
+        }
+        consumer.join();
+
+        std::sort(pushNanoseconds.begin(), pushNanoseconds.end());
+        std::sort(deliveryMicroseconds.begin(), deliveryMicroseconds.end());
+        const auto percentile = [](const std::vector<double>& values, std::size_t percent) { return values[values.size() * percent / 100]; };
+        std::printf("%-9s push p50 %6.0f ns, p99 %7.0f ns, max %8.0f ns | push to pop p50 %6.1f us, p99 %7.1f us\n", name,
+            percentile(pushNanoseconds, 50), percentile(pushNanoseconds, 99), pushNanoseconds.back(),
+            percentile(deliveryMicroseconds, 50), percentile(deliveryMicroseconds, 99));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const bool isQuick{ jela::test::IsQuickRun(argc, argv) };
+    const int commandCount{ isQuick ? 20'000 : 1'000'000 };
+    const int frameCount{ isQuick ? 50 : 2000 };
+
+    for (const int producerCount : { 1, 2, 4 })
+    {
+        MeasureThroughput<LockFreeQueue>("MpscQueue", producerCount, commandCount);
+        MeasureThroughput<LockedQueue>("mutex", producerCount, commandCount);
+    }
+    MeasureLatency<LockFreeQueue>("MpscQueue", frameCount);
+    MeasureLatency<LockedQueue>("mutex", frameCount);
+    return 0;
+}
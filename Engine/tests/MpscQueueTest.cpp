@@ -0,0 +1,142 @@
+#include "Check.h"
+#include "MpscQueue.h"
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Build with -DJELA_SANITIZER=thread to have the stress tests checked for data races as well
+
+namespace
+{
+    using namespace jela;
+
+    struct Command
+    {
+        uint32_t producer;
+        uint32_t sequence;
+        uint64_t payload;
+    };
+
+    uint64_t GetPayload(uint32_t producer, uint32_t sequence)
+    {
+        return uint64_t{ producer } << 32 | sequence;
+    }
+
+    void TestFillAndDrain()
+    {
+        MpscQueue<Command, 8> queue{};
+        Command command{};
+        CHECK(!queue.TryPop(command));
+
+        // A few laps around the ring, so the sequence numbers wrap
+        for (uint32_t lap = 0; lap < 4; ++lap)
+        {
+            for (uint32_t index = 0; index < 8; ++index) CHECK(queue.TryPush({ 0, index, GetPayload(lap, index) }));
+            CHECK(!queue.TryPush({}));
+
+            for (uint32_t index = 0; index < 8; ++index)
+            {
+                CHECK(queue.TryPop(command));
+                CHECK(command.sequence == index && command.payload == GetPayload(lap, index));
+            }
+            CHECK(!queue.TryPop(command));
+        }
+    }
+
+    // Commands of one producer come out in the order it pushed them, whatever the other producers do
+    void TestProducersKeepTheirOrder(uint32_t producerCount, uint32_t commandsPerProducer)
+    {
+        auto pQueue{ std::make_unique<MpscQueue<Command, 256>>() };
+        std::vector<uint32_t> nextSequences(producerCount);
+        const uint64_t commandCount{ uint64_t{ producerCount } * commandsPerProducer };
+
+        std::thread consumer{ [&]
+            {
+                uint64_t receivedCount{};
+                Command command{};
+                while (receivedCount < commandCount)
+                {
+                    if (!pQueue->TryPop(command))
+                    {
+                        pQueue->Wait();
+                        continue;
+                    }
+                    ++receivedCount;
+                    if (!CHECK(command.producer < producerCount)) continue;
+                    CHECK(command.sequence == nextSequences[command.producer]);
+                    CHECK(command.payload == GetPayload(command.producer, command.sequence));
+                    nextSequences[command.producer] = command.sequence + 1;
+                }
+            } };
+
+        std::vector<std::thread> producers{};
+        for (uint32_t producer = 0; producer < producerCount; ++producer)
+        {
+            producers.emplace_back([&, producer]
+                {
+                    for (uint32_t sequence = 0; sequence < commandsPerProducer; ++sequence)
+                    {
+                        while (!pQueue->TryPush({ producer, sequence, GetPayload(producer, sequence) })) std::this_thread::yield();
+                        // Now and then give the consumer the time to fall asleep, so waking it gets tested too
+                        if (sequence % 4096 == 0) std::this_thread::sleep_for(std::chrono::microseconds{ 50 });
+                    }
+                });
+        }
+        for (std::thread& producer : producers) producer.join();
+        consumer.join();
+
+        for (uint32_t producer = 0; producer < producerCount; ++producer) CHECK(nextSequences[producer] == commandsPerProducer);
+    }
+
+    // Stopping the consumer ends its Wait, also when it stops before it got to wait
+    void TestStopEndsWait()
+    {
+        for (int cycle = 0; cycle < 2000; ++cycle)
+        {
+            MpscQueue<Command, 16> queue{};
+            std::jthread consumer{ [&](std::stop_token stopToken)
+                {
+                    Command command{};
+                    while (!stopToken.stop_requested())
+                    {
+                        if (!queue.TryPop(command)) queue.Wait(stopToken);
+                    }
+                } };
+
+            for (int index = 0; index < cycle % 5; ++index) queue.TryPush({});
+            if (cycle % 3 == 0) std::this_thread::sleep_for(std::chrono::microseconds{ 50 });
+            consumer.request_stop();
+        }
+    }
+
+    // Work that doesn't come through the queue ends the Wait as well, when it is handed over with Wake
+    void TestWakeForOtherWork()
+    {
+        for (int cycle = 0; cycle < 2000; ++cycle)
+        {
+            MpscQueue<Command, 16> queue{};
+            std::atomic<bool> hasWork{};
+            std::thread consumer{ [&]
+                {
+                    while (!hasWork.load()) queue.Wait({}, [&] { return hasWork.load(); });
+                } };
+
+            if (cycle % 3 == 0) std::this_thread::sleep_for(std::chrono::microseconds{ 50 });
+            hasWork.store(true);
+            queue.Wake();
+            consumer.join();
+        }
+    }
+}
+
+int main()
+{
+    TestFillAndDrain();
+    for (const uint32_t producerCount : { 1u, 2u, 4u, 8u }) TestProducersKeepTheirOrder(producerCount, 50'000);
+    TestStopEndsWait();
+    TestWakeForOtherWork();
+    return jela::test::GetResult();
+}
@@ -0,0 +1,65 @@
+#include "Bench.h"
+#include "PhysicsWorld.h"
+#include "ThreadPool.h"
+#include <chrono>
+#include <cstdio>
+
+// The 1k and 10k body scenes: columns of boxes and circles dropped onto the ground, stepped at 60 Hz
+// while they fall, pile up and settle. Without a thread pool and with one.
+
+namespace
+{
+    using namespace jela;
+
+    void AddScene(PhysicsWorld& world, int columnCount, int rowCount)
+    {
+        BodyDefinition ground{};
+        ground.type = BodyType::Static;
+        world.AddBody(Rectf{ -5000.f, 1000.f, 40000.f, 50.f }, ground);
+
+        for (int column = 0; column < columnCount; ++column)
+        {
+            for (int row = 0; row < rowCount; ++row)
+            {
+                const Point2f center{ column * 30.f, 990.f - row * 20.5f };
+                if ((column + row) % 3 == 0) world.AddBody(Circlef{ center, 10.f });
+                else world.AddBody(Rectf{ center.x - 10.f, center.y - 10.f, 20.f, 20.f });
+            }
+        }
+    }
+
+    void Measure(int columnCount, int rowCount, ThreadPool* pThreadPool, int stepCount)
+    {
+        PhysicsWorld world{};
+        world.SetThreadPool(pThreadPool);
+        AddScene(world, columnCount, rowCount);
+
+        double worstMilliseconds{};
+        const auto start = std::chrono::steady_clock::now();
+        for (int step = 0; step < stepCount; ++step)
+        {
+            const auto stepStart = std::chrono::steady_clock::now();
+            world.Step(1.f / 60.f);
+            worstMilliseconds = std::max(worstMilliseconds, std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - stepStart).count());
+        }
+        const double milliseconds{ std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count() };
+
+        std::printf("%5zu bodies, %-16s %7.3f ms per step, worst %7.3f ms | %6zu contacts, %4zu islands awake\n", world.GetBodyCount() - 1,
+            pThreadPool ? "thread pool:" : "one thread:", milliseconds / stepCount, worstMilliseconds, world.GetContactCount(), world.GetAwakeIslandCount());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int stepCount{ jela::test::IsQuickRun(argc, argv) ? 5 : 600 };
+    jela::ThreadPool threadPool{};
+    std::printf("Thread pool of %u threads\n", threadPool.GetNrOfThreads());
+
+    // 1000 bodies in 50 columns of 20, 10000 in 200 columns of 50
+    for (const auto& [columnCount, rowCount] : { std::pair{ 50, 20 }, std::pair{ 200, 50 } })
+    {
+        Measure(columnCount, rowCount, nullptr, stepCount);
+        Measure(columnCount, rowCount, &threadPool, stepCount);
+    }
+    return 0;
+}
@@ -0,0 +1,140 @@
+#include "Check.h"
+#include "PhysicsWorld.h"
+#include "ThreadPool.h"
+#include <algorithm>
+
+namespace
+{
+    using namespace jela;
+
+    constexpr float timeStep{ 1.f / 60.f };
+    constexpr float groundTop{ 1000.f };
+
+    BodyID AddGround(PhysicsWorld& world)
+    {
+        BodyDefinition ground{};
+        ground.type = BodyType::Static;
+        return world.AddBody(Rectf{ -5000.f, groundTop, 10000.f, 50.f }, ground);
+    }
+
+    // Columns of boxes with a circle now and then, just above the ground
+    void AddStacks(PhysicsWorld& world, int columnCount, int rowCount)
+    {
+        for (int column = 0; column < columnCount; ++column)
+        {
+            for (int row = 0; row < rowCount; ++row)
+            {
+                const Point2f center{ column * 30.f, groundTop - 10.f - row * 20.5f };
+                if ((column + row) % 3 == 0) world.AddBody(Circlef{ center, 10.f });
+                else world.AddBody(Rectf{ center.x - 10.f, center.y - 10.f, 20.f, 20.f });
+            }
+        }
+    }
+
+    // A stack comes to rest on the ground without sinking into it, and then falls asleep
+    void TestStackRests()
+    {
+        PhysicsWorld world{};
+        AddGround(world);
+        std::vector<BodyID> boxes{};
+        for (int row = 0; row < 5; ++row) boxes.push_back(world.AddBody(Rectf{ -10.f, groundTop - 20.f - row * 20.5f, 20.f, 20.f }));
+
+        for (int step = 0; step < 300; ++step) world.Step(timeStep);
+
+        for (std::size_t row = 0; row < boxes.size(); ++row)
+        {
+            // Resting contacts keep up to half a pixel apart
+            CHECK_NEAR(world.GetPosition(boxes[row]).y, groundTop - 10.f - 20.f * row, 0.5 * (row + 1));
+            CHECK_NEAR(world.GetPosition(boxes[row]).x, 0.f, 0.5);
+            CHECK(!world.IsAwake(boxes[row]));
+        }
+        CHECK(world.GetAwakeIslandCount() == 0);
+
+        // Something landing on it wakes the whole stack
+        const BodyID ball{ world.AddBody(Circlef{ Point2f{ 0.f, 700.f }, 8.f }) };
+        bool isBottomWoken{};
+        for (int step = 0; step < 120; ++step)
+        {
+            world.Step(timeStep);
+            isBottomWoken = isBottomWoken || world.IsAwake(boxes.front());
+        }
+        CHECK(isBottomWoken);
+        CHECK_NEAR(world.GetPosition(ball).y, groundTop - 5.f * 20.f - 8.f, 2.0);
+    }
+
+    // An impulse off the center of mass spins the body as much as its inertia says
+    void TestImpulse()
+    {
+        PhysicsWorld world{ Vector2f{} };
+        const BodyID box{ world.AddBody(Rectf{ 100.f, 100.f, 20.f, 20.f }) };
+        CHECK_NEAR(world.GetMass(box), 400.f, 1e-3);
+
+        world.ApplyImpulse(box, Vector2f{ 0.f, 400.f }, Point2f{ 120.f, 110.f });
+        CHECK_NEAR(world.GetVelocity(box).y, 1.f, 1e-5);
+        // 10 * 400 / (400 * (20² + 20²) / 12) radians per second, in degrees
+        CHECK_NEAR(world.GetAngularVelocity(box), 0.15f * 180.f / 3.14159265f, 1e-3);
+    }
+
+    void TestRemoveBody()
+    {
+        PhysicsWorld world{};
+        AddGround(world);
+        const BodyID first{ world.AddBody(Rectf{ -10.f, 900.f, 20.f, 20.f }) };
+        const BodyID second{ world.AddBody(Circlef{ Point2f{ 0.f, 800.f }, 10.f }) };
+        CHECK(world.GetBodyCount() == 3);
+
+        world.RemoveBody(first);
+        CHECK(!world.IsValid(first));
+        CHECK(world.IsValid(second));
+        CHECK(world.GetBodyCount() == 2);
+
+        // The circle falls to the ground now that the box is gone
+        for (int step = 0; step < 300; ++step) world.Step(timeStep);
+        CHECK_NEAR(world.GetPosition(second).y, groundTop - 10.f, 1.5);
+    }
+
+    // The same steps give exactly the same bodies, whether the islands are solved on a thread pool or not
+    void TestDeterminism()
+    {
+        PhysicsWorld serialWorld{};
+        PhysicsWorld pooledWorld{};
+        ThreadPool threadPool{ 4 };
+        pooledWorld.SetThreadPool(&threadPool);
+
+        for (PhysicsWorld* pWorld : { &serialWorld, &pooledWorld })
+        {
+            AddGround(*pWorld);
+            AddStacks(*pWorld, 20, 20);
+        }
+
+        for (int step = 0; step < 300; ++step)
+        {
+            serialWorld.Step(timeStep);
+            pooledWorld.Step(timeStep);
+        }
+
+        int differentCount{};
+        float lowestBottom{};
+        for (BodyID body = 0; body < serialWorld.GetBodyCount(); ++body)
+        {
+            const Point2f serialPosition{ serialWorld.GetPosition(body) };
+            const Point2f pooledPosition{ pooledWorld.GetPosition(body) };
+            if (serialPosition.x != pooledPosition.x || serialPosition.y != pooledPosition.y || serialWorld.GetAngle(body) != pooledWorld.GetAngle(body))
+                ++differentCount;
+            if (serialWorld.GetBodyType(body) == BodyType::Dynamic) lowestBottom = std::max(lowestBottom, serialPosition.y + 10.f);
+        }
+        CHECK(differentCount == 0);
+        CHECK(serialWorld.GetContactCount() == pooledWorld.GetContactCount());
+        // Nothing fell through the ground
+        CHECK(lowestBottom < groundTop + 1.f);
+    }
+}
+
+int main()
+{
+    TestStackRests();
+    TestImpulse();
+    TestRemoveBody();
+    TestDeterminism();
+    return jela::test::GetResult();
+}
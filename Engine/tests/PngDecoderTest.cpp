@@ -0,0 +1,165 @@
+#include "Check.h"
+#include "FileExceptions.h"
+#include "PixelConvert.h"
+#include "PngDecoder.h"
+#include <array>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <random>
+#include <string>
+#include <vector>
+
+// Decodes the reference corpus of corpus/PngDecoder at every SIMD level the machine has, whole and a few rows at a time.
+// Generate.py wrote the corpus and computed the expected pixels on its own, Reference.txt holds their CRC-32.
+
+namespace
+{
+    using namespace jela;
+
+    const std::filesystem::path corpusDirectory{ "corpus/PngDecoder" };
+
+    std::vector<std::byte> ReadFile(const std::filesystem::path& path)
+    {
+        std::ifstream stream{ path, std::ios::binary };
+        std::vector<std::byte> data(std::filesystem::file_size(path));
+        stream.read(reinterpret_cast<char*>(data.data()), static_cast<std::streamsize>(data.size()));
+        return data;
+    }
+
+    uint32_t GetCrc32(std::span<const uint8_t> data)
+    {
+        static const std::array<uint32_t, 256> table{ [] {
+            std::array<uint32_t, 256> crcs{};
+            for (uint32_t index = 0; index < 256; ++index)
+            {
+                uint32_t crc{ index };
+                for (int bit = 0; bit < 8; ++bit) crc = (crc & 1) ? 0xEDB88320u ^ (crc >> 1) : crc >> 1;
+                crcs[index] = crc;
+            }
+            return crcs;
+        }() };
+
+        uint32_t crc{ 0xFFFFFFFFu };
+        for (const uint8_t byte : data) crc = table[(crc ^ byte) & 0xFF] ^ (crc >> 8);
+        return crc ^ 0xFFFFFFFFu;
+    }
+
+    template <typename Function>
+    bool ThrowsFileLoadException(Function&& function)
+    {
+        try
+        {
+            function();
+        }
+        catch (const FileLoadException&)
+        {
+            return true;
+        }
+        return false;
+    }
+
+    struct Reference
+    {
+        std::string name;
+        uint32_t width;
+        uint32_t height;
+        uint32_t crc;
+    };
+
+    std::vector<Reference> ReadReferences()
+    {
+        std::vector<Reference> references{};
+        std::ifstream stream{ corpusDirectory / "Reference.txt" };
+        Reference reference{};
+        while (stream >> reference.name >> reference.width >> reference.height >> std::hex >> reference.crc >> std::dec) references.push_back(reference);
+        return references;
+    }
+
+    void TestReferences(const std::vector<Reference>& references)
+    {
+        for (const Reference& reference : references)
+        {
+            const std::vector<std::byte> data{ ReadFile(corpusDirectory / reference.name) };
+            try
+            {
+                const DecodedImage image{ PngDecoder::Decode(data) };
+                const bool isSame{ image.width == reference.width && image.height == reference.height && GetCrc32(image.GetPixels()) == reference.crc };
+                if (!CHECK(isSame)) std::printf("  %s decoded differently\n", reference.name.c_str());
+
+                // Three rows at a time, into rows with some padding
+                PngDecoder decoder{ data };
+                const std::size_t rowSize{ std::size_t{ decoder.GetWidth() } * 4 };
+                const std::size_t rowStride{ rowSize + 12 };
+                std::vector<uint8_t> rows(rowStride * 3);
+                std::vector<uint8_t> pixels{};
+                while (const uint32_t rowCount{ decoder.DecodeRows(rows, rowStride, 3) })
+                {
+                    for (uint32_t row = 0; row < rowCount; ++row) pixels.insert(pixels.end(), rows.begin() + static_cast<std::ptrdiff_t>(row * rowStride), rows.begin() + static_cast<std::ptrdiff_t>(row * rowStride + rowSize));
+                }
+                if (!CHECK(decoder.GetDecodedRowCount() == reference.height && GetCrc32(pixels) == reference.crc))
+                    std::printf("  %s decoded differently row by row\n", reference.name.c_str());
+            }
+            catch (const std::exception& exception)
+            {
+                CHECK(false);
+                std::printf("  %s threw: %s\n", reference.name.c_str(), exception.what());
+            }
+        }
+    }
+
+    // The bad_*.png files and every cut of a good one are rejected with a FileLoadException, and nothing else
+    void TestRejects()
+    {
+        for (const auto& entry : std::filesystem::directory_iterator{ corpusDirectory })
+        {
+            if (!entry.path().filename().string().starts_with("bad_")) continue;
+            const std::vector<std::byte> data{ ReadFile(entry.path()) };
+            if (!CHECK(ThrowsFileLoadException([&] { PngDecoder::Decode(data); })))
+                std::printf("  %s was decoded\n", entry.path().filename().string().c_str());
+        }
+
+        const std::vector<std::byte> data{ ReadFile(corpusDirectory / "rgb8_interlaced_large.png") };
+        for (std::size_t size = 0; size < data.size(); size += 97)
+        {
+            const std::vector<std::byte> cut{ data.begin(), data.begin() + static_cast<std::ptrdiff_t>(size) };
+            CHECK(ThrowsFileLoadException([&] { PngDecoder::Decode(cut); }));
+        }
+    }
+
+    // Random bytes changed in small images either decode or throw a FileLoadException
+    void TestCorruption(const std::vector<Reference>& references)
+    {
+        std::mt19937 random{ 1 };
+        for (int attempt = 0; attempt < 4000; ++attempt)
+        {
+            std::vector<std::byte> data{ ReadFile(corpusDirectory / references[static_cast<std::size_t>(attempt) % references.size()].name) };
+            for (int change = 0; change < 4; ++change) data[random() % data.size()] = static_cast<std::byte>(random());
+            try
+            {
+                PngDecoder::Decode(data);
+            }
+            catch (const FileLoadException&)
+            {
+            }
+        }
+    }
+}
+
+int main()
+{
+    const std::vector<Reference> references{ ReadReferences() };
+    CHECK(references.size() == 62);
+
+    for (const pixels::SimdLevel simdLevel : { pixels::SimdLevel::Scalar, pixels::SimdLevel::Sse41, pixels::SimdLevel::Avx2, pixels::SimdLevel::Neon })
+    {
+        if (!pixels::SetSimdLevel(simdLevel)) continue;
+        std::printf("%s\n", pixels::GetSimdLevelName(simdLevel));
+        TestReferences(references);
+    }
+    pixels::SetSimdLevel(pixels::GetSupportedSimdLevel());
+
+    TestRejects();
+    TestCorruption(references);
+    return jela::test::GetResult();
+}
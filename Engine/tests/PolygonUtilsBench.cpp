@@ -0,0 +1,112 @@
+#include "Bench.h"
+#include "PolygonUtils.h"
+#include <cmath>
+#include <cstdio>
+#include <numbers>
+#include <random>
+#include <vector>
+
+// Simplifying and decomposing hand traced outlines of a growing number of points, and hit testing
+// their convex pieces, with and without simplifying first, against the crossing test over the whole outline.
+
+namespace
+{
+    using namespace jela;
+
+    bool IsPointInPolygon(const Point2fArray& points, const Point2f& point)
+    {
+        bool isInside{};
+        for (std::size_t index = 0, previous = points.Size() - 1; index < points.Size(); previous = index++)
+        {
+            const Point2f first{ points[index] };
+            const Point2f second{ points[previous] };
+            if ((first.y > point.y) != (second.y > point.y) && point.x < (second.x - first.x) * (point.y - first.y) / (second.y - first.y) + first.x)
+                isInside = !isInside;
+        }
+        return isInside;
+    }
+
+    // A blob with a few lobes, traced with many nearly collinear points and a little noise
+    Point2fArray MakeOutline(std::size_t pointCount, std::mt19937& random)
+    {
+        std::uniform_real_distribution<float> noise{ -0.2f, 0.2f };
+        Point2fArray points{};
+        for (std::size_t index = 0; index < pointCount; ++index)
+        {
+            const float angle{ 2.f * std::numbers::pi_v<float> * static_cast<float>(index) / static_cast<float>(pointCount) };
+            const float radius{ 100.f + 30.f * std::sin(5.f * angle) + noise(random) };
+            points.PushBack(Point2f{ radius * std::cos(angle), radius * std::sin(angle) });
+        }
+        return points;
+    }
+
+    std::size_t CountHits(const std::vector<Point2fArray>& pieces, const std::vector<Point2f>& queries)
+    {
+        std::size_t hitCount{};
+        for (const Point2f& query : queries)
+        {
+            for (const Point2fArray& piece : pieces)
+            {
+                if (utils::IsPointInConvexPolygon(piece, query))
+                {
+                    ++hitCount;
+                    break;
+                }
+            }
+        }
+        return hitCount;
+    }
+
+    void Measure(std::size_t pointCount, bool isQuick)
+    {
+        std::mt19937 random{ 1 };
+        const Point2fArray outline{ MakeOutline(pointCount, random) };
+        const int repeatCount{ isQuick ? 1 : static_cast<int>(std::max<std::size_t>(1, 100'000 / pointCount)) };
+
+        Point2fArray simplified{};
+        const double rdpSeconds{ test::MeasureSeconds([&]
+            {
+                for (int repeat = 0; repeat < repeatCount; ++repeat) simplified = utils::SimplifyRamerDouglasPeucker(outline, 0.5f);
+            }) };
+        std::size_t visvalingamSize{};
+        const double visvalingamSeconds{ test::MeasureSeconds([&]
+            {
+                for (int repeat = 0; repeat < repeatCount; ++repeat) visvalingamSize = utils::SimplifyVisvalingam(outline, 1.f).Size();
+            }) };
+        std::printf("%6zu points: RDP %8.3f ms to %4zu points, Visvalingam %8.3f ms to %4zu points\n",
+            pointCount, rdpSeconds * 1e3 / repeatCount, simplified.Size(), visvalingamSeconds * 1e3 / repeatCount, visvalingamSize);
+
+        std::vector<Point2fArray> pieces{};
+        const double decomposeSeconds{ test::MeasureSeconds([&] { pieces = utils::DecomposeConvex(outline); }, isQuick ? 1 : 3) };
+        std::vector<Point2fArray> simplifiedPieces{};
+        const double decomposeSimplifiedSeconds{ test::MeasureSeconds([&] { simplifiedPieces = utils::DecomposeConvex(simplified); }, isQuick ? 1 : 3) };
+        std::printf("              decompose %9.3f ms to %4zu pieces, simplified first %8.3f ms to %4zu pieces\n",
+            decomposeSeconds * 1e3, pieces.size(), decomposeSimplifiedSeconds * 1e3, simplifiedPieces.size());
+
+        std::uniform_real_distribution<float> coordinate{ -140.f, 140.f };
+        std::vector<Point2f> queries(isQuick ? 100 : 10'000);
+        for (Point2f& query : queries) query = Point2f{ coordinate(random), coordinate(random) };
+
+        std::size_t crossingHitCount{};
+        const double crossingSeconds{ test::MeasureSeconds([&]
+            {
+                crossingHitCount = 0;
+                for (const Point2f& query : queries) crossingHitCount += IsPointInPolygon(outline, query);
+            }) };
+        std::size_t piecesHitCount{};
+        const double piecesSeconds{ test::MeasureSeconds([&] { piecesHitCount = CountHits(pieces, queries); }) };
+        std::size_t simplifiedHitCount{};
+        const double simplifiedSeconds{ test::MeasureSeconds([&] { simplifiedHitCount = CountHits(simplifiedPieces, queries); }) };
+
+        const auto perQuery = [&queries](double seconds) { return seconds * 1e9 / static_cast<double>(queries.size()); };
+        std::printf("              hit test: crossing %8.1f ns, pieces %8.1f ns, simplified pieces %7.1f ns (hits %zu, %zu, %zu of %zu)\n",
+            perQuery(crossingSeconds), perQuery(piecesSeconds), perQuery(simplifiedSeconds), crossingHitCount, piecesHitCount, simplifiedHitCount, queries.size());
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const bool isQuick{ jela::test::IsQuickRun(argc, argv) };
+    for (const std::size_t pointCount : { 100u, 1000u, 10'000u }) Measure(pointCount, isQuick);
+    return 0;
+}
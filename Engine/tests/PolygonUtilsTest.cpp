@@ -0,0 +1,147 @@
+#include "Check.h"
+#include "PolygonUtils.h"
+#include <algorithm>
+#include <cmath>
+#include <numbers>
+#include <random>
+
+namespace
+{
+    using namespace jela;
+
+    // The O(n) crossing test the convex pieces replace
+    bool IsPointInPolygon(const Point2fArray& points, const Point2f& point)
+    {
+        bool isInside{};
+        for (std::size_t index = 0, previous = points.Size() - 1; index < points.Size(); previous = index++)
+        {
+            const Point2f first{ points[index] };
+            const Point2f second{ points[previous] };
+            if ((first.y > point.y) != (second.y > point.y) && point.x < (second.x - first.x) * (point.y - first.y) / (second.y - first.y) + first.x)
+                isInside = !isInside;
+        }
+        return isInside;
+    }
+
+    // A star shaped outline with a random radius per point, so it is simple but concave
+    Point2fArray MakeStar(std::mt19937& random, std::size_t pointCount, bool isClockwise)
+    {
+        std::uniform_real_distribution<float> radius{ 50.f, 100.f };
+        Point2fArray points{};
+        for (std::size_t index = 0; index < pointCount; ++index)
+        {
+            const float angle{ 2.f * std::numbers::pi_v<float> * static_cast<float>(isClockwise ? pointCount - index : index) / static_cast<float>(pointCount) };
+            const float distance{ radius(random) };
+            points.PushBack(Point2f{ distance * std::cos(angle), distance * std::sin(angle) });
+        }
+        return points;
+    }
+
+    void TestArea()
+    {
+        const Point2fArray square{ Point2f{ 0.f, 0.f }, Point2f{ 2.f, 0.f }, Point2f{ 2.f, 2.f }, Point2f{ 0.f, 2.f } };
+        CHECK_NEAR(utils::GetSignedArea(square), 4.f, 1e-6);
+        CHECK(utils::IsConvex(square));
+
+        const Point2fArray clockwise{ Point2f{ 0.f, 0.f }, Point2f{ 0.f, 2.f }, Point2f{ 2.f, 2.f }, Point2f{ 2.f, 0.f } };
+        CHECK_NEAR(utils::GetSignedArea(clockwise), -4.f, 1e-6);
+
+        const Point2fArray lShape{ Point2f{ 0.f, 0.f }, Point2f{ 2.f, 0.f }, Point2f{ 2.f, 1.f }, Point2f{ 1.f, 1.f }, Point2f{ 1.f, 2.f }, Point2f{ 0.f, 2.f } };
+        CHECK(!utils::IsConvex(lShape));
+        CHECK(utils::DecomposeConvex(lShape).size() == 2);
+        // Already convex, it stays one piece
+        CHECK(utils::DecomposeConvex(square).size() == 1);
+    }
+
+    // The pieces are convex, counterclockwise, cover the outline's area and contain exactly the points it does
+    void TestDecomposition()
+    {
+        std::mt19937 random{ 42 };
+        std::uniform_real_distribution<float> coordinate{ -110.f, 110.f };
+
+        for (int outline = 0; outline < 200; ++outline)
+        {
+            const std::size_t pointCount{ 5 + static_cast<std::size_t>(outline % 60) };
+            const Point2fArray points{ MakeStar(random, pointCount, outline % 2 == 1) };
+
+            const auto triangles{ utils::Triangulate(points) };
+            CHECK(triangles.size() == pointCount - 2);
+
+            const std::vector<Point2fArray> pieces{ utils::DecomposeConvex(points) };
+            // Hertel-Mehlhorn merges at least some of the triangles
+            CHECK(!pieces.empty() && pieces.size() < triangles.size());
+
+            float area{};
+            for (const Point2fArray& piece : pieces)
+            {
+                CHECK(utils::IsConvex(piece));
+                CHECK(utils::GetSignedArea(piece) > 0.f);
+                area += utils::GetSignedArea(piece);
+            }
+            CHECK_NEAR(area, std::abs(utils::GetSignedArea(points)), 0.001 * area);
+
+            for (int sample = 0; sample < 200; ++sample)
+            {
+                const Point2f point{ coordinate(random), coordinate(random) };
+                const bool isInPiece{ std::ranges::any_of(pieces, [&point](const Point2fArray& piece) { return utils::IsPointInConvexPolygon(piece, point); }) };
+                CHECK(isInPiece == IsPointInPolygon(points, point));
+            }
+        }
+    }
+
+    void TestSimplification()
+    {
+        // A circle of 1000 points with 0.1 of noise
+        std::mt19937 random{ 7 };
+        std::uniform_real_distribution<float> noise{ -0.1f, 0.1f };
+        Point2fArray circle{};
+        for (int index = 0; index < 1000; ++index)
+        {
+            const float angle{ 2.f * std::numbers::pi_v<float> * static_cast<float>(index) / 1000.f };
+            const float radius{ 100.f + noise(random) };
+            circle.PushBack(Point2f{ radius * std::cos(angle), radius * std::sin(angle) });
+        }
+
+        for (const Point2fArray& simplified : { utils::SimplifyRamerDouglasPeucker(circle, 0.5f), utils::SimplifyVisvalingam(circle, 2.f) })
+        {
+            // Far fewer points, all of them from the outline, still close to its area
+            CHECK(simplified.Size() >= 3 && simplified.Size() < 100);
+            CHECK_NEAR(utils::GetSignedArea(simplified), utils::GetSignedArea(circle), 0.01 * utils::GetSignedArea(circle));
+            for (std::size_t index = 0; index < simplified.Size(); ++index)
+            {
+                const Point2f point{ simplified[index] };
+                CHECK_NEAR(std::hypot(point.x, point.y), 100.f, 0.1001);
+            }
+        }
+
+        // An open line keeps its ends and drops the point that hardly bends it
+        const Point2fArray line{ Point2f{ 0.f, 0.f }, Point2f{ 1.f, 0.01f }, Point2f{ 2.f, 0.f }, Point2f{ 3.f, 5.f } };
+        const Point2fArray simplifiedLine{ utils::SimplifyRamerDouglasPeucker(line, 0.1f, false) };
+        if (CHECK(simplifiedLine.Size() == 3))
+        {
+            CHECK(simplifiedLine[0].x == 0.f && simplifiedLine[1].x == 2.f && simplifiedLine[2].y == 5.f);
+        }
+
+        // Closed outlines keep at least a triangle
+        const Point2fArray tiny{ Point2f{ 0.f, 0.f }, Point2f{ 0.01f, 0.f }, Point2f{ 0.01f, 0.01f }, Point2f{ 0.f, 0.01f } };
+        CHECK(utils::SimplifyVisvalingam(tiny, 1.f).Size() == 3);
+    }
+
+    void TestConvexOverlap()
+    {
+        const Point2fArray triangle{ Point2f{ 0.f, 0.f }, Point2f{ 1.f, 0.f }, Point2f{ 0.f, 1.f } };
+        CHECK(utils::IsOverlappingConvex(triangle, Point2fArray{ Point2f{ 0.4f, 0.4f }, Point2f{ 2.f, 0.4f }, Point2f{ 2.f, 2.f } }));
+        CHECK(!utils::IsOverlappingConvex(triangle, Point2fArray{ Point2f{ 0.6f, 0.6f }, Point2f{ 2.f, 0.6f }, Point2f{ 2.f, 2.f } }));
+        CHECK(utils::IsPointInConvexPolygon(triangle, Point2f{ 0.2f, 0.2f }));
+        CHECK(!utils::IsPointInConvexPolygon(triangle, Point2f{ 0.6f, 0.6f }));
+    }
+}
+
+int main()
+{
+    TestArea();
+    TestDecomposition();
+    TestSimplification();
+    TestConvexOverlap();
+    return jela::test::GetResult();
+}
@@ -0,0 +1,47 @@
+#ifndef REFERENCEBIQUAD_H
+#define REFERENCEBIQUAD_H
+
+#include "AudioDsp.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jela::test
+{
+    //---------------------------------------------------------------
+    // A biquad worked out a sample at a time in transposed direct form II, to check audio::Biquad against and to time it by.
+    class ReferenceBiquad final
+    {
+    public:
+        ReferenceBiquad(const audio::BiquadCoefficients& coefficients, uint16_t channelCount) :
+            m_Coefficients{ coefficients },
+            m_State(std::size_t{ channelCount } * 2)
+        {
+        }
+
+        void Process(std::span<float> samples, uint16_t channelCount)
+        {
+            const audio::BiquadCoefficients& c{ m_Coefficients };
+            for (std::size_t frame = 0; frame < samples.size() / channelCount; ++frame)
+            {
+                for (std::size_t channel = 0; channel < channelCount; ++channel)
+                {
+                    float& sample{ samples[frame * channelCount + channel] };
+                    const float input{ sample };
+                    const float output{ c.b0 * input + m_State[channel * 2] };
+                    m_State[channel * 2] = c.b1 * input - c.a1 * output + m_State[channel * 2 + 1];
+                    m_State[channel * 2 + 1] = c.b2 * input - c.a2 * output;
+                    sample = output;
+                }
+            }
+        }
+
+    private:
+        audio::BiquadCoefficients m_Coefficients;
+        std::vector<float> m_State;
+    };
+    //---------------------------------------------------------------
+}
+
+#endif // !REFERENCEBIQUAD_H
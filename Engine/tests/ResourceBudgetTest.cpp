@@ -0,0 +1,177 @@
+#include "Check.h"
+#include "ResourceBudget.h"
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <set>
+#include <vector>
+
+namespace
+{
+    using namespace jela;
+    using namespace jela::literals;
+
+    void TestEvictsLeastRecentlyUsed()
+    {
+        ResourceBudget budget{ 100 };
+        budget.Add("a"_asset, 40);
+        budget.Add("b"_asset, 40);
+        budget.Add("c"_asset, 40);
+        CHECK(budget.GetUsage() == 120);
+        CHECK(budget.IsOverBudget());
+
+        // a is in use, so b goes instead
+        std::set<AssetId> inUse{ "a"_asset };
+        const auto isInUse = [&inUse](AssetId id) { return inUse.contains(id); };
+        std::vector<AssetId> evicted{};
+        CHECK(budget.Evict(isInUse, evicted) == 1);
+        CHECK(evicted == std::vector<AssetId>{ "b"_asset });
+        CHECK(budget.GetUsage() == 80);
+        CHECK(!budget.IsOverBudget());
+
+        // Touching a makes c the least recently used one
+        budget.Touch("a"_asset);
+        budget.Add("d"_asset, 50);
+        inUse.clear();
+        evicted.clear();
+        CHECK(budget.Evict(isInUse, evicted) == 1);
+        CHECK(evicted == std::vector<AssetId>{ "c"_asset });
+        CHECK(budget.GetUsage() == 90);
+
+        CHECK(budget.GetEvictionCount() == 2);
+        CHECK(budget.GetEvictedBytes() == 80);
+    }
+
+    void TestAddUpdatesSize()
+    {
+        ResourceBudget budget{ 100 };
+        budget.Add("a"_asset, 40);
+        budget.Add("b"_asset, 40);
+        // Adding a again resizes it and makes it the most recently used one
+        budget.Add("a"_asset, 10);
+        CHECK(budget.GetCount() == 2);
+        CHECK(budget.GetUsage() == 50);
+
+        budget.Add("c"_asset, 60);
+        std::vector<AssetId> evicted{};
+        budget.Evict([](AssetId) { return false; }, evicted);
+        CHECK(evicted == std::vector<AssetId>{ "b"_asset });
+
+        budget.Remove("c"_asset);
+        budget.Remove("c"_asset);
+        CHECK(budget.GetUsage() == 10);
+        CHECK(budget.GetCount() == 1);
+    }
+
+    void TestEverythingInUse()
+    {
+        ResourceBudget budget{ 10 };
+        budget.Add("a"_asset, 20);
+        budget.Add("b"_asset, 20);
+
+        std::vector<AssetId> evicted{};
+        CHECK(budget.Evict([](AssetId) { return true; }, evicted) == 0);
+        CHECK(evicted.empty());
+        CHECK(budget.IsOverBudget());
+        CHECK(budget.GetUsage() == 40);
+    }
+
+    void TestNoBudget()
+    {
+        ResourceBudget budget{};
+        budget.Add("a"_asset, 1'000'000);
+        CHECK(!budget.IsOverBudget());
+
+        std::vector<AssetId> evicted{};
+        CHECK(budget.Evict([](AssetId) { return false; }, evicted) == 0);
+        CHECK(budget.GetCount() == 1);
+
+        // Clear stops tracking, but doesn't reset the totals
+        budget.SetBudget(1);
+        budget.Evict([](AssetId) { return false; }, evicted);
+        budget.Add("b"_asset, 5);
+        budget.Clear();
+        CHECK(budget.GetUsage() == 0);
+        CHECK(budget.GetCount() == 0);
+        CHECK(budget.GetEvictionCount() == 1);
+    }
+
+    // Random uses against a plain list kept in the same order
+    void TestAgainstModel()
+    {
+        struct Entry
+        {
+            AssetId id;
+            std::size_t sizeInBytes;
+        };
+
+        std::mt19937 random{ 12345 };
+        ResourceBudget budget{ 4096 };
+        std::vector<Entry> model{};
+        std::set<AssetId> inUse{};
+        const auto isInUse = [&inUse](AssetId id) { return inUse.contains(id); };
+        const auto find = [&model](AssetId id) { return std::find_if(model.begin(), model.end(), [id](const Entry& entry) { return entry.id == id; }); };
+
+        for (int step = 0; step < 20'000; ++step)
+        {
+            const AssetId id{ AssetId::FromValue(random() % 64 + 1) };
+            switch (random() % 5)
+            {
+            case 0:
+            case 1:
+            {
+                const std::size_t sizeInBytes{ random() % 512 };
+                budget.Add(id, sizeInBytes);
+                if (const auto it = find(id); it != model.end()) model.erase(it);
+                model.push_back({ id, sizeInBytes });
+                break;
+            }
+            case 2:
+                budget.Touch(id);
+                if (const auto it = find(id); it != model.end()) std::rotate(it, it + 1, model.end());
+                break;
+            case 3:
+                budget.Remove(id);
+                if (const auto it = find(id); it != model.end()) model.erase(it);
+                break;
+            case 4:
+                if (inUse.contains(id)) inUse.erase(id);
+                else inUse.insert(id);
+                break;
+            }
+
+            if (step % 16 != 0) continue;
+
+            std::size_t usage{};
+            for (const Entry& entry : model) usage += entry.sizeInBytes;
+
+            std::vector<AssetId> expected{};
+            for (auto it = model.begin(); it != model.end() && usage > budget.GetBudget();)
+            {
+                if (inUse.contains(it->id))
+                {
+                    ++it;
+                    continue;
+                }
+                usage -= it->sizeInBytes;
+                expected.push_back(it->id);
+                it = model.erase(it);
+            }
+
+            std::vector<AssetId> evicted{};
+            budget.Evict(isInUse, evicted);
+            if (!CHECK(evicted == expected)) return;
+            if (!CHECK(budget.GetUsage() == usage && budget.GetCount() == model.size())) return;
+        }
+    }
+}
+
+int main()
+{
+    TestEvictsLeastRecentlyUsed();
+    TestAddUpdatesSize();
+    TestEverythingInUse();
+    TestNoBudget();
+    TestAgainstModel();
+    return jela::test::GetResult();
+}
@@ -0,0 +1,124 @@
+#include "Bench.h"
+#include "SoftwareAudio.h"
+#include "WaveWriter.h"
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <cstdlib>
+#include <new>
+#include <thread>
+#include <vector>
+
+// What playing and stopping short sounds costs the game thread, and whether it allocates, with the mixing thread running.
+// Each frame plays a batch of sounds and stops or lets them end, then waits for the mixer, which isn't timed.
+
+namespace
+{
+    std::atomic<uint64_t>& GetAllocationCount()
+    {
+        static std::atomic<uint64_t> allocationCount{};
+        return allocationCount;
+    }
+}
+
+void* operator new(std::size_t size)
+{
+    GetAllocationCount().fetch_add(1, std::memory_order_relaxed);
+    if (void* const pMemory{ std::malloc(size ? size : 1) }) return pMemory;
+    throw std::bad_alloc{};
+}
+
+void operator delete(void* pMemory) noexcept { std::free(pMemory); }
+void operator delete(void* pMemory, std::size_t) noexcept { std::free(pMemory); }
+
+namespace
+{
+    using namespace jela;
+
+    constexpr SoundID toneId{ 1 };
+    constexpr SoundID clickId{ 2 };
+    constexpr std::size_t batchSize{ 48 };
+
+    std::vector<std::byte> MakeTone(std::size_t frameCount)
+    {
+        std::vector<int16_t> samples(frameCount);
+        for (std::size_t index = 0; index < samples.size(); ++index) samples[index] = static_cast<int16_t>(8000 * std::sin(index * 0.05));
+        return test::MakePcmWave(1, 48000, samples);
+    }
+
+    void WaitForBlocks(const NullAudioOutput& output, uint64_t blockCount)
+    {
+        const uint64_t frameCount{ output.GetFrameCount() + blockCount * SoftwareAudioSettings{}.blockFrameCount };
+        while (output.GetFrameCount() < frameCount) std::this_thread::sleep_for(std::chrono::microseconds{ 200 });
+    }
+
+    // Runs batch every frame and prints what one sound of it took
+    template <typename Batch>
+    void Measure(const char* pName, const NullAudioOutput& output, int frameCount, Batch&& batch)
+    {
+        // The first frames fill the free lists and queues up to what they need
+        for (int frame = 0; frame < 4; ++frame)
+        {
+            batch();
+            WaitForBlocks(output, 2);
+        }
+
+        double seconds{};
+        const uint64_t allocationCount{ GetAllocationCount().load() };
+        for (int frame = 0; frame < frameCount; ++frame)
+        {
+            seconds += test::MeasureSeconds(batch, 1);
+            WaitForBlocks(output, 2);
+        }
+        const double soundCount{ static_cast<double>(frameCount) * batchSize };
+        std::printf("%-34s %7.1f ns per sound, %.2f allocations per sound\n", pName, seconds * 1e9 / soundCount,
+            static_cast<double>(GetAllocationCount().load() - allocationCount) / soundCount);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int frameCount{ jela::test::IsQuickRun(argc, argv) ? 2 : 300 };
+
+    const std::vector<std::byte> tone{ MakeTone(48000) };
+    // 5 ms, it ends within the frame it is played in
+    const std::vector<std::byte> click{ MakeTone(240) };
+    jela::SoftwareAudioSettings settings{};
+    settings.findPackedAsset = [&](const tstring& filename) { return std::span<const std::byte>{ filename == _T("Tone.wav") ? tone : click }; };
+
+    auto pOutput{ std::make_unique<jela::NullAudioOutput>() };
+    const jela::NullAudioOutput& output{ *pOutput };
+    jela::SoftwareAudio audio{ std::move(pOutput), settings };
+    audio.AddSound(_T("Tone.wav"), toneId);
+    audio.AddSound(_T("Click.wav"), clickId);
+
+    Measure("one-shots that end", output, frameCount, [&]
+        {
+            for (std::size_t index = 0; index < batchSize; ++index) audio.PlaySoundClip(clickId, false);
+            audio.Update();
+        });
+
+    std::vector<jela::SoundInstanceID> instanceIds(batchSize);
+    Measure("instances played and stopped", output, frameCount, [&]
+        {
+            for (jela::SoundInstanceID& instanceId : instanceIds) audio.PlaySoundInstance(toneId, true, instanceId);
+            for (const jela::SoundInstanceID& instanceId : instanceIds) audio.StopSound(toneId, instanceId);
+        });
+
+    // With looping beds holding all but 16 voices, so those are taken and given back over and over
+    constexpr std::size_t freeVoiceCount{ 16 };
+    std::vector<jela::SoundInstanceID> bedIds(settings.voiceCount - freeVoiceCount);
+    for (jela::SoundInstanceID& bedId : bedIds) audio.PlaySoundInstance(toneId, true, bedId);
+    Measure("under beds, 16 voices left", output, frameCount, [&]
+        {
+            for (std::size_t index = 0; index < batchSize; ++index)
+            {
+                jela::SoundInstanceID& instanceId{ instanceIds[index % freeVoiceCount] };
+                audio.StopSound(toneId, instanceId);
+                audio.PlaySoundInstance(toneId, true, instanceId);
+            }
+            for (std::size_t index = 0; index < freeVoiceCount; ++index) audio.StopSound(toneId, instanceIds[index]);
+        });
+    return 0;
+}
@@ -0,0 +1,161 @@
+#include "AudioLog.h"
+#include "Check.h"
+#include "SoftwareAudio.h"
+#include "WaveWriter.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// The game thread's side of SoftwareAudio: voices taken and given back by many short sounds,
+// and the mixing thread falling behind, when the output is a ring nobody reads at first so the command queue fills up.
+
+namespace
+{
+    using namespace jela;
+
+    constexpr SoundID toneId{ 1 };
+    constexpr SoundID clickId{ 2 };
+    constexpr std::size_t ringFrameCount{ 512 };
+
+    std::vector<std::byte> MakeTone(std::size_t frameCount = 4800)
+    {
+        std::vector<int16_t> samples(frameCount);
+        for (std::size_t index = 0; index < samples.size(); ++index) samples[index] = static_cast<int16_t>(8000 * std::sin(index * 0.05));
+        return test::MakePcmWave(1, 48000, samples);
+    }
+
+    std::atomic<int>& GetDroppedCount()
+    {
+        static std::atomic<int> droppedCount{};
+        return droppedCount;
+    }
+
+    std::atomic<int>& GetWarningCount()
+    {
+        static std::atomic<int> warningCount{};
+        return warningCount;
+    }
+
+    void WaitForBlocks(const NullAudioOutput& output, uint64_t blockCount)
+    {
+        const uint64_t frameCount{ output.GetFrameCount() + blockCount * SoftwareAudioSettings{}.blockFrameCount };
+        while (output.GetFrameCount() < frameCount) std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+    }
+
+    // Many short sounds played and stopped every frame, none of which may keep its voice
+    void TestChurn()
+    {
+        const std::vector<std::byte> tone{ MakeTone() };
+        // 5 ms, so it ends on its own within a frame
+        const std::vector<std::byte> click{ MakeTone(240) };
+        SoftwareAudioSettings settings{};
+        settings.findPackedAsset = [&](const tstring& filename) { return std::span<const std::byte>{ filename == _T("Tone.wav") ? tone : click }; };
+
+        auto pOutput{ std::make_unique<NullAudioOutput>() };
+        const NullAudioOutput& output{ *pOutput };
+        SoftwareAudio audio{ std::move(pOutput), settings };
+        audio.AddSound(_T("Tone.wav"), toneId);
+        audio.AddSound(_T("Click.wav"), clickId);
+        const int warningCount{ GetWarningCount() };
+
+        std::vector<SoundInstanceID> instanceIds(32);
+        for (int frame = 0; frame < 60; ++frame)
+        {
+            for (SoundInstanceID& instanceId : instanceIds)
+            {
+                audio.PlaySoundInstance(toneId, true, instanceId);
+                CHECK(instanceId.GetID().has_value());
+            }
+            // Half stop one at a time, the other half with the sound
+            for (std::size_t index = 0; index < instanceIds.size() / 2; ++index)
+            {
+                audio.StopSound(toneId, instanceIds[index]);
+                CHECK(!instanceIds[index].GetID().has_value());
+            }
+            for (int index = 0; index < 16; ++index) audio.PlaySoundClip(clickId, false);
+            audio.StopSound(toneId);
+            CHECK(std::ranges::none_of(instanceIds, [](const SoundInstanceID& instanceId) { return instanceId.GetID().has_value(); }));
+
+            audio.Update();
+            WaitForBlocks(output, 2);
+        }
+        audio.Update();
+
+        // Every voice is idle again
+        std::vector<SoundInstanceID> allIds(settings.voiceCount);
+        for (SoundInstanceID& instanceId : allIds) audio.PlaySoundInstance(toneId, true, instanceId);
+        CHECK(std::ranges::all_of(allIds, [](const SoundInstanceID& instanceId) { return instanceId.GetID().has_value(); }));
+        CHECK(GetWarningCount() == warningCount);
+    }
+
+    void TestFullQueue()
+    {
+        const std::vector<std::byte> tone{ MakeTone() };
+        SoftwareAudioSettings settings{};
+        settings.findPackedAsset = [&tone](const tstring&) { return std::span<const std::byte>{ tone }; };
+
+        auto pOutput{ std::make_unique<RingBufferAudioOutput>(ringFrameCount) };
+        RingBufferAudioOutput& output{ *pOutput };
+        SoftwareAudio audio{ std::move(pOutput), settings };
+        audio.AddSound(_T("Tone.wav"), toneId);
+
+        // Once the ring is full, the mixing thread doesn't take any more commands
+        while (output.GetReadableFrameCount() < ringFrameCount) std::this_thread::sleep_for(std::chrono::milliseconds{ 1 });
+
+        for (int index = 0; index < 4; ++index) audio.PlaySoundClip(toneId, true);
+        CHECK(GetDroppedCount() == 0);
+
+        // Many more than fit, which used to wait here for the mixing thread forever
+        for (int index = 0; index < 1000; ++index) audio.ResumeSound(toneId);
+        const int droppedResumeCount{ GetDroppedCount() };
+        CHECK(droppedResumeCount > 0);
+
+        // Stops aren't dropped, they wait. Plays are dropped while they do.
+        audio.StopAllSounds();
+        CHECK(GetDroppedCount() == droppedResumeCount);
+        audio.PlaySoundClip(toneId, true);
+        CHECK(GetDroppedCount() == droppedResumeCount + 1);
+
+        // The tone plays once the ring is read, and stops once the waiting Stops got through
+        std::vector<float> samples(ringFrameCount * AudioMixer::m_ChannelCount);
+        bool isPlayed{};
+        std::size_t silentFrameCount{};
+        const auto deadline{ std::chrono::steady_clock::now() + std::chrono::seconds{ 10 } };
+        while (silentFrameCount < 48000 && std::chrono::steady_clock::now() < deadline)
+        {
+            audio.Update();
+            const std::size_t frameCount{ output.Read(samples) };
+            const auto itEnd{ samples.begin() + frameCount * AudioMixer::m_ChannelCount };
+            if (std::all_of(samples.begin(), itEnd, [](float sample) { return sample == 0.f; })) silentFrameCount += frameCount;
+            else
+            {
+                isPlayed = true;
+                silentFrameCount = 0;
+            }
+            std::this_thread::yield();
+        }
+        CHECK(isPlayed);
+        CHECK(silentFrameCount >= 48000);
+
+        // Nothing waits anymore, so playing works again
+        audio.PlaySoundClip(toneId, false);
+        CHECK(GetDroppedCount() == droppedResumeCount + 1);
+    }
+}
+
+int main()
+{
+    jela::audio::SetLogSink([](jela::audio::LogLevel level, std::string_view message)
+        {
+            if (level != jela::audio::LogLevel::Info) ++GetWarningCount();
+            if (message.find("queue is full") != std::string_view::npos) ++GetDroppedCount();
+        });
+    TestChurn();
+    TestFullQueue();
+    jela::audio::SetLogSink({});
+    return jela::test::GetResult();
+}
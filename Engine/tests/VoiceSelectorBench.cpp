@@ -0,0 +1,73 @@
+#include "Bench.h"
+#include "VoiceSelector.h"
+#include <algorithm>
+#include <cstdio>
+#include <random>
+#include <vector>
+
+// Picking the sounds that get one of 64 voices among up to 10k virtual ones, the work of one update of a busy scene,
+// against sorting all of them.
+
+namespace
+{
+    using namespace jela;
+    using Candidate = VoiceSelector::Candidate;
+
+    const char* GetName(VoiceStealPolicy policy)
+    {
+        switch (policy)
+        {
+        case VoiceStealPolicy::Quietest: return "quietest";
+        case VoiceStealPolicy::Oldest: return "oldest";
+        case VoiceStealPolicy::LowestPriority: break;
+        }
+        return "lowest priority";
+    }
+
+    void Measure(VoiceStealPolicy policy, std::size_t candidateCount, std::size_t voiceCount, int updateCount)
+    {
+        std::mt19937 random{ 46 };
+        std::vector<Candidate> sounds(candidateCount);
+        for (std::size_t index = 0; index < sounds.size(); ++index)
+            sounds[index] = Candidate{ static_cast<uint32_t>(index), static_cast<uint8_t>(random() % 4 * 60), (random() % 100) / 100.f, index, random() % 16 == 0, false };
+
+        const VoiceSelector selector{ policy };
+        std::vector<Candidate> candidates{};
+        uint64_t checksum{};
+        const auto update{ [&](auto&& select)
+            {
+                for (int index = 0; index < updateCount; ++index)
+                {
+                    // Gathered anew each update, the way a service does, with the ones chosen last time audible
+                    candidates = sounds;
+                    for (Candidate& sound : sounds) sound.isAudible = false;
+                    for (const std::span<Candidate> selected{ select(std::span<Candidate>{ candidates }) }; const Candidate& candidate : selected)
+                    {
+                        sounds[candidate.voice].isAudible = true;
+                        checksum += candidate.voice;
+                    }
+                }
+            } };
+
+        const double selectSeconds{ test::MeasureSeconds([&] { update([&](std::span<Candidate> all) { return selector.Select(all, voiceCount); }); }) };
+        const double sortSeconds{ test::MeasureSeconds([&] { update([&](std::span<Candidate> all)
+            {
+                std::ranges::sort(all, [&selector](const Candidate& lhs, const Candidate& rhs) { return selector.Outranks(lhs, rhs); });
+                return all.first(std::min(voiceCount, all.size()));
+            }); }) };
+
+        const auto microseconds = [updateCount](double seconds) { return seconds * 1e6 / updateCount; };
+        std::printf("%-16s %6zu sounds, %2zu voices: select %8.1f us | sort %8.1f us per update (%llu)\n", GetName(policy), candidateCount, voiceCount,
+            microseconds(selectSeconds), microseconds(sortSeconds), static_cast<unsigned long long>(checksum % 10));
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int updateCount{ jela::test::IsQuickRun(argc, argv) ? 1 : 200 };
+    for (const auto policy : { jela::VoiceStealPolicy::LowestPriority, jela::VoiceStealPolicy::Quietest, jela::VoiceStealPolicy::Oldest })
+    {
+        for (const std::size_t candidateCount : { 100, 1000, 10000 }) Measure(policy, candidateCount, 64, updateCount);
+    }
+    return 0;
+}
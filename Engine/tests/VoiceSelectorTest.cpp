@@ -0,0 +1,135 @@
+#include "Check.h"
+#include "VoiceSelector.h"
+#include <algorithm>
+#include <random>
+#include <vector>
+
+namespace
+{
+    using namespace jela;
+    using Candidate = VoiceSelector::Candidate;
+
+    void TestResolveFrame()
+    {
+        CHECK(ResolveFrame(10, 0, true, 0, 0) == 0);
+        // Not looping, clamped to the last frame
+        CHECK(ResolveFrame(50, 100, false, 20, 80) == 50);
+        CHECK(ResolveFrame(150, 100, false, 20, 80) == 99);
+        // Looping, frames before the loop's end play as they are and the rest wraps into the loop
+        CHECK(ResolveFrame(10, 100, true, 20, 80) == 10);
+        CHECK(ResolveFrame(79, 100, true, 20, 80) == 79);
+        CHECK(ResolveFrame(80, 100, true, 20, 80) == 20);
+        CHECK(ResolveFrame(80 + 60 * 1000 + 5, 100, true, 20, 80) == 25);
+        // An empty loop doesn't loop
+        CHECK(ResolveFrame(150, 100, true, 80, 80) == 99);
+    }
+
+    void TestTimeline()
+    {
+        using Clock = VoiceTimeline::Clock;
+        const Clock::time_point start{};
+        const auto at{ [start](double seconds) { return start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>{ seconds }); } };
+
+        VoiceTimeline timeline{};
+        timeline.Start(100, 48000., start);
+        CHECK(timeline.GetFrame(start) == 100);
+        CHECK(timeline.GetFrame(at(0.5)) == 24100);
+
+        // Doesn't move while paused, and goes on from there when resumed
+        timeline.Pause(at(1.));
+        CHECK(timeline.IsPaused());
+        CHECK(timeline.GetFrame(at(5.)) == 48100);
+        timeline.Pause(at(2.));
+        timeline.Resume(at(5.));
+        CHECK(!timeline.IsPaused());
+        CHECK(timeline.GetFrame(at(5.25)) == 48100 + 12000);
+
+        timeline.Seek(10, at(6.));
+        CHECK(timeline.GetFrame(at(6.)) == 10);
+        CHECK(timeline.GetFrame(at(7.)) == 48010);
+
+        // A sound played twice as fast
+        timeline.Start(0, 96000., at(10.));
+        CHECK(timeline.GetFrame(at(10.5)) == 48000);
+    }
+
+    void TestOutranks()
+    {
+        const Candidate loud{ 0, 128, 1.f, 1, false, false };
+        const Candidate quiet{ 1, 128, 0.2f, 2, false, false };
+        const Candidate important{ 2, 200, 0.1f, 0, false, false };
+        const Candidate paused{ 3, 255, 1.f, 3, true, true };
+
+        for (const VoiceStealPolicy policy : { VoiceStealPolicy::LowestPriority, VoiceStealPolicy::Quietest, VoiceStealPolicy::Oldest })
+        {
+            const VoiceSelector selector{ policy };
+            CHECK(selector.Outranks(important, loud));
+            CHECK(!selector.Outranks(loud, important));
+            CHECK(selector.Outranks(quiet, paused));
+            CHECK(!selector.Outranks(paused, quiet));
+        }
+
+        // Of the same priority, the quietest loses its voice first
+        VoiceSelector selector{ VoiceStealPolicy::Quietest };
+        Candidate audibleQuiet{ quiet };
+        audibleQuiet.isAudible = true;
+        CHECK(selector.Outranks(loud, audibleQuiet));
+
+        // The oldest does
+        selector.SetPolicy(VoiceStealPolicy::Oldest);
+        CHECK(selector.GetPolicy() == VoiceStealPolicy::Oldest);
+        Candidate audibleLoud{ loud };
+        audibleLoud.isAudible = true;
+        CHECK(selector.Outranks(quiet, audibleLoud));
+
+        // None does: the ones that have a voice keep it
+        selector.SetPolicy(VoiceStealPolicy::LowestPriority);
+        CHECK(selector.Outranks(audibleQuiet, loud));
+        CHECK(!selector.Outranks(loud, audibleQuiet));
+        // And of the ones waiting, the loudest comes first
+        CHECK(selector.Outranks(loud, quiet));
+    }
+
+    void TestSelectAgainstSort()
+    {
+        std::mt19937 random{ 46 };
+        std::uniform_int_distribution<int> priorityDistribution{ 0, 3 };
+        std::uniform_int_distribution<int> volumeDistribution{ 0, 4 };
+        std::bernoulli_distribution flip{ 0.3 };
+
+        for (int run = 0; run < 300; ++run)
+        {
+            const VoiceSelector selector{ static_cast<VoiceStealPolicy>(run % 3) };
+            std::vector<Candidate> candidates(1 + random() % 300);
+            for (std::size_t index = 0; index < candidates.size(); ++index)
+            {
+                // Few priorities and volumes, so most of the decisions come down to the ties
+                candidates[index] = Candidate{ static_cast<uint32_t>(index), static_cast<uint8_t>(priorityDistribution(random) * 60),
+                    volumeDistribution(random) / 4.f, random(), flip(random), flip(random) };
+            }
+            const std::size_t voiceCount{ random() % 80 };
+
+            std::vector<Candidate> sorted{ candidates };
+            std::ranges::sort(sorted, [&selector](const Candidate& lhs, const Candidate& rhs) { return selector.Outranks(lhs, rhs); });
+            sorted.resize(std::min(voiceCount, sorted.size()));
+
+            const std::span<Candidate> selected{ selector.Select(candidates, voiceCount) };
+            std::vector<uint32_t> selectedVoices{};
+            for (const Candidate& candidate : selected) selectedVoices.push_back(candidate.voice);
+            std::vector<uint32_t> expectedVoices{};
+            for (const Candidate& candidate : sorted) expectedVoices.push_back(candidate.voice);
+            std::ranges::sort(selectedVoices);
+            std::ranges::sort(expectedVoices);
+            if (!CHECK(selectedVoices == expectedVoices)) return;
+        }
+    }
+}
+
+int main()
+{
+    TestResolveFrame();
+    TestTimeline();
+    TestOutranks();
+    TestSelectAgainstSort();
+    return jela::test::GetResult();
+}
@@ -0,0 +1,71 @@
+#include "Bench.h"
+#include "MappedFile.h"
+#include "WaveFile.h"
+#include "WaveWriter.h"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <vector>
+
+// Loading a WAVE file by mapping it and parsing the mapping in place, against reading it into memory first.
+// Parsing alone is timed as well, on a file whose fmt and data come after many chunks to skip.
+
+namespace
+{
+    using namespace jela;
+
+    void Measure(const char* pName, std::size_t skippedChunkCount, std::size_t dataSize, int repeatCount)
+    {
+        test::WaveWriter writer{};
+        for (std::size_t index = 0; index < skippedChunkCount; ++index) writer.AddChunk("LIST", std::vector<std::byte>(30 + index % 7));
+        writer.AddFormat(test::MakeWaveFormat(WaveFormat::pcm, 2, 48000, 4, 16));
+        for (std::size_t index = 0; index < skippedChunkCount; ++index) writer.AddChunk("junk", std::vector<std::byte>(18 + index % 5));
+        writer.AddChunk("data", std::vector<std::byte>(dataSize, std::byte{ 1 }));
+        const std::vector<std::byte> file{ writer.GetFile() };
+
+        const std::filesystem::path path{ std::filesystem::temp_directory_path() / "JelA_WaveFileBench.wav" };
+        {
+            std::ofstream stream{ path, std::ios::binary };
+            stream.write(reinterpret_cast<const char*>(file.data()), static_cast<std::streamsize>(file.size()));
+        }
+
+        std::size_t checksum{};
+        const double parseSeconds{ test::MeasureSeconds([&]
+            {
+                for (int repeat = 0; repeat < repeatCount; ++repeat) checksum += WaveFile{ file }.GetData().size();
+            }) };
+        const double readSeconds{ test::MeasureSeconds([&]
+            {
+                for (int repeat = 0; repeat < repeatCount; ++repeat)
+                {
+                    std::ifstream stream{ path, std::ios::binary };
+                    std::vector<char> contents(std::filesystem::file_size(path));
+                    stream.read(contents.data(), static_cast<std::streamsize>(contents.size()));
+                    checksum += WaveFile{ std::as_bytes(std::span{ contents }) }.GetData().size();
+                }
+            }) };
+        const double mapSeconds{ test::MeasureSeconds([&]
+            {
+                for (int repeat = 0; repeat < repeatCount; ++repeat)
+                {
+                    const MappedFile mappedFile{ path };
+                    checksum += WaveFile{ mappedFile.GetData() }.GetData().size();
+                }
+            }) };
+        std::filesystem::remove(path);
+
+        const auto microseconds = [repeatCount](double seconds) { return seconds * 1e6 / repeatCount; };
+        std::printf("%-28s parse %8.2f us | read + parse %9.1f us | map + parse %7.1f us (%zu)\n", pName,
+            microseconds(parseSeconds), microseconds(readSeconds), microseconds(mapSeconds), checksum % 10);
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    const int repeatCount{ jela::test::IsQuickRun(argc, argv) ? 1 : 200 };
+    Measure("44 byte header, 64 KiB", 0, 64 << 10, repeatCount * 10);
+    Measure("200 chunks, 64 KiB", 200, 64 << 10, repeatCount * 10);
+    Measure("2 chunks, 32 MiB", 2, 32 << 20, repeatCount / 10 + 1);
+    return 0;
+}
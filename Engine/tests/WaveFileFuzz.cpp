@@ -0,0 +1,130 @@
+#include "FileExceptions.h"
+#include "WaveFile.h"
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <random>
+#include <span>
+#include <string_view>
+#include <vector>
+
+// Gives WaveFile any bytes and checks that whatever it makes of them lies within them.
+// Built with -DJELA_LIBFUZZER=ON (clang only) it is a libFuzzer target: WaveFileFuzz corpus/WaveFile
+// Otherwise main parses every file of the corpus, and a fixed number of random mutations of each. Best run with -DJELA_SANITIZER=address.
+
+namespace
+{
+    using namespace jela;
+
+    void Require(bool condition, const char* pWhat)
+    {
+        if (condition) return;
+        std::fprintf(stderr, "WaveFile broke an invariant: %s\n", pWhat);
+        std::abort();
+    }
+
+    bool IsWithin(std::span<const std::byte> part, std::span<const std::byte> data)
+    {
+        return part.empty() || (part.data() >= data.data() && part.data() + part.size() <= data.data() + data.size());
+    }
+
+    void Parse(std::span<const std::byte> data)
+    {
+        try
+        {
+            const WaveFile waveFile{ data };
+            const WaveFormat& format{ waveFile.GetFormat() };
+            Require(IsWithin(waveFile.GetData(), data) && IsWithin(waveFile.GetFormatChunk(), data) &&
+                    IsWithin(waveFile.GetSamplerChunk(), data) && IsWithin(format.extraData, data), "a chunk lies outside the data");
+            Require(format.channelCount > 0 && format.sampleRate > 0 && format.blockAlign > 0, "the format has no channels, sample rate or block size");
+            Require(!waveFile.GetData().empty() && waveFile.GetData().size() % format.blockAlign == 0, "the data isn't whole blocks");
+
+            const uint64_t frameCount{ waveFile.GetFrameCount() };
+            for (const WaveLoop& loop : waveFile.GetLoops()) Require(loop.begin <= loop.end && loop.end < frameCount, "a loop lies outside the data");
+        }
+        catch (const FileException&)
+        {
+        }
+    }
+}
+
+extern "C" int LLVMFuzzerTestOneInput(const uint8_t* pData, std::size_t size)
+{
+    Parse({ reinterpret_cast<const std::byte*>(pData), size });
+    return 0;
+}
+
+#ifndef JELA_LIBFUZZER
+namespace
+{
+    void Mutate(std::vector<std::byte>& data, std::mt19937& random)
+    {
+        const int mutationCount{ 1 + static_cast<int>(random() % 8) };
+        for (int mutation = 0; mutation < mutationCount; ++mutation)
+        {
+            if (data.empty()) data.push_back(std::byte{});
+            const std::size_t offset{ random() % data.size() };
+            switch (random() % 5)
+            {
+            case 0:
+                data[offset] ^= static_cast<std::byte>(1u << (random() % 8));
+                break;
+            case 1:
+                data.resize(offset);
+                break;
+            case 2:
+            {
+                // Sizes and counts are where parsers go wrong, so sometimes the largest one
+                const uint32_t value{ random() % 4 == 0 ? UINT32_MAX : static_cast<uint32_t>(random()) };
+                for (std::size_t index = 0; index < 4 && offset + index < data.size(); ++index) data[offset + index] = static_cast<std::byte>(value >> (8 * index));
+                break;
+            }
+            case 3:
+                data.insert(data.begin() + static_cast<std::ptrdiff_t>(offset), random() % 16, static_cast<std::byte>(random()));
+                break;
+            case 4:
+                data.erase(data.begin() + static_cast<std::ptrdiff_t>(offset), data.begin() + static_cast<std::ptrdiff_t>(std::min(data.size(), offset + random() % 16)));
+                break;
+            }
+        }
+    }
+}
+
+// WaveFileFuzz <corpus directory> [mutations per file]
+int main(int argc, char* argv[])
+{
+    if (argc < 2)
+    {
+        std::puts("Usage: WaveFileFuzz <corpus directory> [mutations per file]");
+        return 1;
+    }
+    const int mutationCount{ argc > 2 ? std::atoi(argv[2]) : 20'000 };
+
+    std::mt19937 random{ 12345 };
+    int fileCount{};
+    for (const auto& entry : std::filesystem::directory_iterator{ argv[1] })
+    {
+        std::ifstream stream{ entry.path(), std::ios::binary };
+        const std::vector<char> contents{ std::istreambuf_iterator<char>{ stream }, std::istreambuf_iterator<char>{} };
+        const std::vector<std::byte> seed{ reinterpret_cast<const std::byte*>(contents.data()), reinterpret_cast<const std::byte*>(contents.data() + contents.size()) };
+        Parse(seed);
+        ++fileCount;
+
+        for (int index = 0; index < mutationCount; ++index)
+        {
+            std::vector<std::byte> mutated{ seed };
+            Mutate(mutated, random);
+            // Copied to a vector of exactly its size, so the address sanitizer catches reads past its end
+            const std::vector<std::byte> input{ mutated };
+            Parse(input);
+        }
+    }
+
+    std::printf("Parsed %d files and %d mutations of each\n", fileCount, mutationCount);
+    return fileCount > 0 ? 0 : 1;
+}
+#endif // !JELA_LIBFUZZER
@@ -0,0 +1,192 @@
+#include "Check.h"
+#include "FileExceptions.h"
+#include "WaveFile.h"
+#include "WaveWriter.h"
+#include <array>
+#include <vector>
+
+namespace
+{
+    using namespace jela;
+    using test::MakeWaveFormat;
+    using test::WaveWriter;
+
+    template <typename Exception>
+    bool Throws(std::span<const std::byte> file)
+    {
+        try
+        {
+            const WaveFile waveFile{ file };
+        }
+        catch (const Exception&)
+        {
+            return true;
+        }
+        catch (...)
+        {
+        }
+        return false;
+    }
+
+    void TestPcm()
+    {
+        const std::vector<std::byte> data(403);
+        // Without cbSize, after an odd sized chunk that is padded
+        const std::vector<std::byte> file{ WaveWriter{}
+            .AddChunk("LIST", std::vector<std::byte>(31))
+            .AddFormat(MakeWaveFormat(WaveFormat::pcm, 2, 44100, 4, 16), false)
+            .AddChunk("data", data)
+            .GetFile() };
+
+        const WaveFile waveFile{ file };
+        const WaveFormat& format{ waveFile.GetFormat() };
+        CHECK(format.formatTag == WaveFormat::pcm);
+        CHECK(format.channelCount == 2 && format.sampleRate == 44100 && format.blockAlign == 4 && format.bitsPerSample == 16);
+        CHECK(!format.isExtensible && format.extraData.empty());
+        // Cut to whole frames
+        CHECK(waveFile.GetData().size() == 400);
+        CHECK(waveFile.GetFrameCount() == 100);
+        CHECK(waveFile.GetSamplerChunk().empty() && waveFile.GetLoops().empty());
+    }
+
+    void TestExtensible()
+    {
+        std::vector<std::byte> extraData{};
+        WaveWriter::Append16(extraData, 24);
+        WaveWriter::Append32(extraData, 0x3F);
+        WaveWriter::Append32(extraData, WaveFormat::ieeeFloat);
+        for (const uint8_t byte : { 0x00, 0x00, 0x10, 0x00, 0x80, 0x00, 0x00, 0xAA, 0x00, 0x38, 0x9B, 0x71 }) extraData.push_back(std::byte{ byte });
+
+        WaveFormat format{ MakeWaveFormat(WaveFormat::extensible, 6, 48000, 24, 32) };
+        format.extraData = extraData;
+        const std::vector<std::byte> file{ WaveWriter{}.AddFormat(format).AddChunk("data", std::vector<std::byte>(240)).GetFile() };
+
+        const WaveFile waveFile{ file };
+        CHECK(waveFile.GetFormat().formatTag == WaveFormat::ieeeFloat);
+        CHECK(waveFile.GetFormat().isExtensible);
+        CHECK(waveFile.GetFormat().validBitsPerSample == 24 && waveFile.GetFormat().channelMask == 0x3F);
+        CHECK(waveFile.GetFrameCount() == 10);
+
+        // Any other GUID isn't a format tag
+        extraData.back() = std::byte{ 0x72 };
+        CHECK(Throws<FileLoadException>(WaveWriter{}.AddFormat(format).AddChunk("data", std::vector<std::byte>(240)).GetFile()));
+    }
+
+    // IMA ADPCM blocks of 256 bytes per channel hold 505 frames, whether the fmt chunk says so or not
+    void TestImaAdpcmFrameCount()
+    {
+        std::vector<std::byte> samplesPerBlock{};
+        WaveWriter::Append16(samplesPerBlock, 505);
+
+        for (const uint16_t channelCount : { uint16_t{ 1 }, uint16_t{ 2 } })
+        {
+            for (const bool hasSamplesPerBlock : { true, false })
+            {
+                WaveFormat format{ MakeWaveFormat(WaveFormat::imaAdpcm, channelCount, 22050, static_cast<uint16_t>(256 * channelCount), 4) };
+                if (hasSamplesPerBlock) format.extraData = samplesPerBlock;
+                CHECK(format.GetImaFramesPerBlock() == 505);
+
+                const std::array<WaveLoop, 2> loops{ WaveLoop{ 100, 1000, 0 }, WaveLoop{ 0, 1010, 0 } };
+                const std::vector<std::byte> file{ WaveWriter{}
+                    .AddFormat(format)
+                    .AddChunk("data", std::vector<std::byte>(format.blockAlign * 2))
+                    .AddLoops(loops)
+                    .GetFile() };
+
+                const WaveFile waveFile{ file };
+                CHECK(waveFile.GetFrameCount() == 1010);
+                // The second loop ends past the last frame
+                CHECK(waveFile.GetLoops().size() == 1);
+            }
+        }
+
+        WaveFormat tooSmall{ MakeWaveFormat(WaveFormat::imaAdpcm, 2, 22050, 8, 4) };
+        CHECK(tooSmall.GetImaFramesPerBlock() == 0);
+    }
+
+    void TestLoops()
+    {
+        const std::array<WaveLoop, 4> loops{ WaveLoop{ 10, 99, 0 }, WaveLoop{ 0, 199, 2 }, WaveLoop{ 50, 200, 0 }, WaveLoop{ 60, 50, 0 } };
+        // The smpl chunk before the data, which is allowed
+        const std::vector<std::byte> file{ WaveWriter{}
+            .AddFormat(MakeWaveFormat(WaveFormat::pcm, 1, 44100, 2, 16))
+            .AddLoops(loops)
+            .AddChunk("data", std::vector<std::byte>(400))
+            .GetFile() };
+
+        const WaveFile waveFile{ file };
+        CHECK(!waveFile.GetSamplerChunk().empty());
+        // Past the end or backwards are left out
+        if (CHECK(waveFile.GetLoops().size() == 2))
+        {
+            CHECK(waveFile.GetLoops()[0].begin == 10 && waveFile.GetLoops()[0].end == 99);
+            CHECK(waveFile.GetLoops()[1].playCount == 2);
+        }
+    }
+
+    void TestCutOff()
+    {
+        // A writer that was cut off: the RIFF size is 0 and the data chunk claims more than the file has
+        std::vector<std::byte> file{ WaveWriter{}.AddFormat(MakeWaveFormat(WaveFormat::pcm, 2, 44100, 4, 16)).AddChunk("data", std::vector<std::byte>(402)).GetFile() };
+        for (std::size_t index = 4; index < 8; ++index) file[index] = std::byte{};
+        for (std::size_t index = file.size() - 402 - 4; index < file.size() - 402; ++index) file[index] = std::byte{ 0xFF };
+
+        const WaveFile waveFile{ file };
+        CHECK(waveFile.GetData().size() == 400);
+    }
+
+    void TestFirstChunkCounts()
+    {
+        const std::vector<std::byte> file{ WaveWriter{}
+            .AddFormat(MakeWaveFormat(WaveFormat::pcm, 1, 8000, 1, 8))
+            .AddChunk("data", std::vector<std::byte>(10))
+            .AddFormat(MakeWaveFormat(WaveFormat::pcm, 2, 44100, 4, 16))
+            .AddChunk("data", std::vector<std::byte>(20))
+            .GetFile() };
+
+        const WaveFile waveFile{ file };
+        CHECK(waveFile.GetFormat().sampleRate == 8000);
+        CHECK(waveFile.GetData().size() == 10);
+    }
+
+    void TestRejects()
+    {
+        const WaveFormat pcm{ MakeWaveFormat(WaveFormat::pcm, 2, 44100, 4, 16) };
+        const std::vector<std::byte> data(16);
+
+        std::vector<std::byte> notWave{ WaveWriter{}.AddFormat(pcm).AddChunk("data", data).GetFile() };
+        notWave[8] = std::byte{ 'A' };
+        CHECK(Throws<FileTypeNotSupportedException>(notWave));
+        CHECK(Throws<FileTypeNotSupportedException>(std::vector<std::byte>(11)));
+
+        CHECK(Throws<FileLoadException>(WaveWriter{}.AddChunk("data", data).GetFile()));
+        CHECK(Throws<FileLoadException>(WaveWriter{}.AddFormat(pcm).GetFile()));
+        // Less than a block of data
+        CHECK(Throws<FileLoadException>(WaveWriter{}.AddFormat(pcm).AddChunk("data", std::vector<std::byte>(3)).GetFile()));
+        // A block size that doesn't fit the samples
+        CHECK(Throws<FileLoadException>(WaveWriter{}.AddFormat(MakeWaveFormat(WaveFormat::pcm, 2, 44100, 3, 16)).AddChunk("data", data).GetFile()));
+        CHECK(Throws<FileLoadException>(WaveWriter{}.AddFormat(MakeWaveFormat(WaveFormat::pcm, 0, 44100, 4, 16)).AddChunk("data", data).GetFile()));
+
+        // cbSize larger than the chunk
+        std::vector<std::byte> formatChunk(18);
+        formatChunk[0] = std::byte{ 1 };
+        formatChunk[2] = std::byte{ 1 };
+        formatChunk[4] = std::byte{ 0x40 };
+        formatChunk[12] = std::byte{ 2 };
+        formatChunk[14] = std::byte{ 16 };
+        formatChunk[16] = std::byte{ 4 };
+        CHECK(Throws<FileLoadException>(WaveWriter{}.AddChunk("fmt ", formatChunk).AddChunk("data", data).GetFile()));
+    }
+}
+
+int main()
+{
+    TestPcm();
+    TestExtensible();
+    TestImaAdpcmFrameCount();
+    TestLoops();
+    TestCutOff();
+    TestFirstChunkCounts();
+    TestRejects();
+    return jela::test::GetResult();
+}
@@ -0,0 +1,125 @@
+#ifndef WAVEWRITER_H
+#define WAVEWRITER_H
+
+#include "WaveFile.h"
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+namespace jela::test
+{
+    //---------------------------------------------------------------
+    // Writes RIFF/WAVE files in memory for the tests, chunk by chunk so they can be as odd as the files writers leave
+    class WaveWriter final
+    {
+    public:
+        WaveWriter()
+        {
+            AppendId("RIFF");
+            Append32(0);
+            AppendId("WAVE");
+        }
+
+        // hasSize false leaves cbSize out, the way many PCM files end their fmt chunk after 16 bytes
+        WaveWriter& AddFormat(const WaveFormat& format, bool hasSize = true)
+        {
+            std::vector<std::byte> chunk{};
+            Append16(chunk, format.formatTag);
+            Append16(chunk, format.channelCount);
+            Append32(chunk, format.sampleRate);
+            Append32(chunk, format.bytesPerSecond);
+            Append16(chunk, format.blockAlign);
+            Append16(chunk, format.bitsPerSample);
+            if (hasSize || !format.extraData.empty())
+            {
+                Append16(chunk, static_cast<uint16_t>(format.extraData.size()));
+                chunk.insert(chunk.end(), format.extraData.begin(), format.extraData.end());
+            }
+            return AddChunk("fmt ", chunk);
+        }
+
+        WaveWriter& AddLoops(std::span<const WaveLoop> loops)
+        {
+            std::vector<std::byte> chunk(28);
+            Append32(chunk, static_cast<uint32_t>(loops.size()));
+            Append32(chunk, 0);
+            for (std::size_t index = 0; index < loops.size(); ++index)
+            {
+                Append32(chunk, static_cast<uint32_t>(index));
+                Append32(chunk, 0);
+                Append32(chunk, loops[index].begin);
+                Append32(chunk, loops[index].end);
+                Append32(chunk, 0);
+                Append32(chunk, loops[index].playCount);
+            }
+            return AddChunk("smpl", chunk);
+        }
+
+        WaveWriter& AddChunk(const char(&id)[5], std::span<const std::byte> chunk)
+        {
+            AppendId(id);
+            Append32(static_cast<uint32_t>(chunk.size()));
+            m_File.insert(m_File.end(), chunk.begin(), chunk.end());
+            if (chunk.size() & 1) m_File.push_back(std::byte{});
+            return *this;
+        }
+
+        // The RIFF size filled in
+        std::vector<std::byte> GetFile() const
+        {
+            std::vector<std::byte> file{ m_File };
+            const uint32_t riffSize{ static_cast<uint32_t>(file.size() - 8) };
+            for (std::size_t index = 0; index < 4; ++index) file[4 + index] = static_cast<std::byte>(riffSize >> (8 * index));
+            return file;
+        }
+
+        static void Append16(std::vector<std::byte>& bytes, uint16_t value)
+        {
+            bytes.push_back(static_cast<std::byte>(value));
+            bytes.push_back(static_cast<std::byte>(value >> 8));
+        }
+        static void Append32(std::vector<std::byte>& bytes, uint32_t value)
+        {
+            Append16(bytes, static_cast<uint16_t>(value));
+            Append16(bytes, static_cast<uint16_t>(value >> 16));
+        }
+
+    private:
+        void AppendId(const char(&id)[5])
+        {
+            for (std::size_t index = 0; index < 4; ++index) m_File.push_back(static_cast<std::byte>(id[index]));
+        }
+        void Append32(uint32_t value) { Append32(m_File, value); }
+
+        std::vector<std::byte> m_File{};
+    };
+
+    inline WaveFormat MakeWaveFormat(uint16_t formatTag, uint16_t channelCount, uint32_t sampleRate, uint16_t blockAlign, uint16_t bitsPerSample)
+    {
+        WaveFormat format{};
+        format.formatTag = formatTag;
+        format.channelCount = channelCount;
+        format.sampleRate = sampleRate;
+        format.bytesPerSecond = sampleRate * blockAlign;
+        format.blockAlign = blockAlign;
+        format.bitsPerSample = bitsPerSample;
+        return format;
+    }
+
+    // A 16-bit PCM file of samples, the channels interleaved
+    inline std::vector<std::byte> MakePcmWave(uint16_t channelCount, uint32_t sampleRate, std::span<const int16_t> samples)
+    {
+        std::vector<std::byte> data{};
+        data.reserve(samples.size() * 2);
+        for (const int16_t sample : samples) WaveWriter::Append16(data, static_cast<uint16_t>(sample));
+
+        return WaveWriter{}
+            .AddFormat(MakeWaveFormat(WaveFormat::pcm, channelCount, sampleRate, static_cast<uint16_t>(channelCount * 2), 16))
+            .AddChunk("data", data)
+            .GetFile();
+    }
+    //---------------------------------------------------------------
+}
+
+#endif // !WAVEWRITER_H
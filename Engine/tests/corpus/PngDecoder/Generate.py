@@ -0,0 +1,138 @@
+# Writes the PNG reference corpus of PngDecoderTest: python3 Generate.py
+# Every combination of color type, bit depth, interlacing and tRNS, with random filters, split IDATs and compression levels,
+# plus two images larger than the inflate window. The expected premultiplied BGRA is computed here, independently of the engine,
+# and listed in Reference.txt as width, height and the CRC-32 of the pixels. The bad_*.png files have to be rejected.
+import os, random, struct, zlib
+
+random.seed(7)
+
+def chunk(type, data):
+    return struct.pack('>I', len(data)) + type + data + struct.pack('>I', zlib.crc32(type + data) & 0xFFFFFFFF)
+
+def paeth(a, b, c):
+    p = a + b - c
+    pa, pb, pc = abs(p - a), abs(p - b), abs(p - c)
+    if pa <= pb and pa <= pc: return a
+    return b if pb <= pc else c
+
+def filter_rows(rows, bytes_per_pixel):
+    out = b''
+    previous = bytes(len(rows[0])) if rows else b''
+    for row in rows:
+        type = random.randrange(5)
+        filtered = bytearray([type])
+        for i, x in enumerate(row):
+            a = row[i - bytes_per_pixel] if i >= bytes_per_pixel else 0
+            b = previous[i]
+            c = previous[i - bytes_per_pixel] if i >= bytes_per_pixel else 0
+            filtered.append((x - [0, a, b, (a + b) // 2, paeth(a, b, c)][type]) & 255)
+        out += bytes(filtered)
+        previous = row
+    return out
+
+def premultiply(color, alpha): return int(color * alpha / 255 + 0.5)
+def scale16(value): return (value * 255 + 32895) >> 16
+
+def make(color_type, bit_depth, width, height, interlaced, level, transparency, pixel=None):
+    channels = {0: 1, 2: 3, 3: 1, 4: 2, 6: 4}[color_type]
+    max_value = (1 << bit_depth) - 1
+    if pixel is None: pixel = lambda x, y, c: random.randint(0, max_value)
+    pixels = [[[pixel(x, y, c) for c in range(channels)] for x in range(width)] for y in range(height)]
+
+    palette = palette_alpha = color_key = None
+    if color_type == 3:
+        count = random.randint(1, 1 << bit_depth)
+        palette = [[random.randrange(256) for _ in range(3)] for _ in range(count)]
+        for row in pixels:
+            for p in row: p[0] = random.randrange(count)
+        if transparency: palette_alpha = [random.randrange(256) for _ in range(random.randint(0, count))]
+    if transparency and color_type in (0, 2): color_key = list(pixels[0][0])
+
+    def pack_row(row):
+        if bit_depth < 8:
+            bits = ''.join(format(p[0], '0%db' % bit_depth) for p in row)
+            bits += '0' * (-len(bits) % 8)
+            return bytes(int(bits[i:i + 8], 2) for i in range(0, len(bits), 8))
+        if bit_depth == 8: return bytes(v for p in row for v in p)
+        return b''.join(struct.pack('>H', v) for p in row for v in p)
+
+    bytes_per_pixel = max(1, channels * bit_depth // 8)
+    if not interlaced:
+        raw = filter_rows([pack_row(row) for row in pixels], bytes_per_pixel)
+    else:
+        raw = b''
+        for (x0, y0, dx, dy) in [(0, 0, 8, 8), (4, 0, 8, 8), (0, 4, 4, 8), (2, 0, 4, 4), (0, 2, 2, 4), (1, 0, 2, 2), (0, 1, 1, 2)]:
+            if x0 >= width or y0 >= height: continue
+            raw += filter_rows([pack_row([pixels[y][x] for x in range(x0, width, dx)]) for y in range(y0, height, dy)], bytes_per_pixel)
+
+    compressed = zlib.compress(raw, level)
+    data = b'\x89PNG\r\n\x1a\n' + chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, bit_depth, color_type, 0, 0, 1 if interlaced else 0))
+    data += chunk(b'gAMA', struct.pack('>I', 45455))
+    if palette: data += chunk(b'PLTE', bytes(v for p in palette for v in p))
+    if palette_alpha is not None: data += chunk(b'tRNS', bytes(palette_alpha))
+    if color_key is not None: data += chunk(b'tRNS', b''.join(struct.pack('>H', v) for v in color_key))
+    step = max(1, len(compressed) // random.randint(1, 3) + 1)
+    for i in range(0, len(compressed), step): data += chunk(b'IDAT', compressed[i:i + step])
+    data += chunk(b'IEND', b'')
+
+    expected = bytearray()
+    for row in pixels:
+        for p in row:
+            if color_type == 3:
+                r, g, b = palette[p[0]]
+                a = palette_alpha[p[0]] if palette_alpha and p[0] < len(palette_alpha) else 255
+            elif color_type == 0:
+                v = p[0]
+                r = g = b = v * 255 // max_value if bit_depth < 8 else (v if bit_depth == 8 else scale16(v))
+                a = 0 if color_key and v == color_key[0] else 255
+            elif color_type == 2:
+                r, g, b = [v if bit_depth == 8 else scale16(v) for v in p]
+                a = 0 if color_key and list(p) == color_key else 255
+            elif color_type == 4:
+                r = g = b = p[0] if bit_depth == 8 else scale16(p[0])
+                a = p[1] if bit_depth == 8 else scale16(p[1])
+            else:
+                r, g, b, a = [v if bit_depth == 8 else scale16(v) for v in p]
+            expected += bytes([premultiply(b, a), premultiply(g, a), premultiply(r, a), a])
+    return data, bytes(expected)
+
+def header_only(width, height, color_type, bit_depth, image_data):
+    return (b'\x89PNG\r\n\x1a\n' + chunk(b'IHDR', struct.pack('>IIBBBBB', width, height, bit_depth, color_type, 0, 0, 0)) +
+            chunk(b'IDAT', image_data) + chunk(b'IEND', b''))
+
+directory = os.path.dirname(os.path.abspath(__file__))
+for name in os.listdir(directory):
+    if name.endswith('.png'): os.remove(os.path.join(directory, name))
+
+reference = []
+def write(name, data, expected, width, height):
+    open(os.path.join(directory, name), 'wb').write(data)
+    reference.append('%s %d %d %08x' % (name, width, height, zlib.crc32(expected) & 0xFFFFFFFF))
+
+names = {0: 'gray', 2: 'rgb', 3: 'palette', 4: 'grayalpha', 6: 'rgba'}
+for color_type, bit_depths in [(0, [1, 2, 4, 8, 16]), (2, [8, 16]), (3, [1, 2, 4, 8]), (4, [8, 16]), (6, [8, 16])]:
+    for bit_depth in bit_depths:
+        for interlaced in (False, True):
+            for transparency in (False, True):
+                width, height = random.randint(1, 40), random.randint(1, 24)
+                data, expected = make(color_type, bit_depth, width, height, interlaced, random.choice([0, 1, 6, 9]), transparency)
+                name = '%s%d%s%s.png' % (names[color_type], bit_depth, '_interlaced' if interlaced else '', '_trns' if transparency else '')
+                write(name, data, expected, width, height)
+
+# Larger than the 32 KiB window, smooth so they stay small
+smooth = lambda x, y, c: (x * (3 + c) + y * 5 + ((x * y) >> 6)) & 255
+data, expected = make(6, 8, 320, 200, False, 6, False, smooth)
+write('rgba8_large.png', data, expected, 320, 200)
+data, expected = make(2, 8, 300, 160, True, 9, False, smooth)
+write('rgb8_interlaced_large.png', data, expected, 300, 160)
+open(os.path.join(directory, 'Reference.txt'), 'w', newline='\n').write('\n'.join(reference) + '\n')
+
+# Headers that promise more than the data holds, which must be rejected before the pixels are allocated
+open(os.path.join(directory, 'bad_huge_dimensions.png'), 'wb').write(header_only(60000, 60000, 6, 8, zlib.compress(bytes(100))))
+open(os.path.join(directory, 'bad_too_many_pixels.png'), 'wb').write(header_only(1 << 20, 1 << 20, 0, 1, zlib.compress(bytes(100))))
+open(os.path.join(directory, 'bad_bit_depth.png'), 'wb').write(header_only(4, 4, 2, 4, zlib.compress(bytes(40))))
+open(os.path.join(directory, 'bad_no_image_data.png'), 'wb').write(
+    b'\x89PNG\r\n\x1a\n' + chunk(b'IHDR', struct.pack('>IIBBBBB', 4, 4, 8, 6, 0, 0, 0)) + chunk(b'IEND', b''))
+large = open(os.path.join(directory, 'rgba8_large.png'), 'rb').read()
+open(os.path.join(directory, 'bad_truncated.png'), 'wb').write(large[:4096])
+open(os.path.join(directory, 'bad_signature.png'), 'wb').write(b'\x89PNG\r\n\x1a\x0a'[:7] + b'\x00' + large[8:200])
@@ -0,0 +1,87 @@
+#include "AssetPack.h"
+#include "PngDecoder.h"
+#include <chrono>
+#include <exception>
+#include <format>
+#include <iostream>
+#include <string_view>
+
+namespace
+{
+    void PrintUsage()
+    {
+        std::cout << "Usage:\n"
+                  << "  AssetPacker pack <input directory> <output pack>\n"
+                  << "  AssetPacker list <pack>\n"
+                  << "  AssetPacker check <pack>\n";
+    }
+
+    int Pack(const std::filesystem::path& inputDirectory, const std::filesystem::path& packPath)
+    {
+        const auto start = std::chrono::steady_clock::now();
+
+        jela::AssetPackWriter writer{};
+        writer.AddDirectory(inputDirectory);
+        writer.Write(packPath);
+
+        const auto milliseconds = std::chrono::duration_cast<std::chrono::milliseconds>(std::chrono::steady_clock::now() - start);
+        std::cout << "Packed " << writer.GetAssetCount() << " assets into " << packPath.string()
+                  << " (" << std::filesystem::file_size(packPath) << " bytes) in " << milliseconds.count() << " ms\n";
+        return 0;
+    }
+
+    int List(const std::filesystem::path& packPath)
+    {
+        const jela::AssetPack pack{ packPath };
+        for (std::size_t index = 0; index < pack.GetAssetCount(); ++index)
+            std::cout << std::format("{:016x}\t{}\t{}\n", pack.GetAssetId(index).GetValue(), pack.GetAssetData(index).size(), pack.GetAssetName(index));
+        std::cout << pack.GetAssetCount() << " assets\n";
+        return 0;
+    }
+
+    // Decodes every PNG in the pack, the way the engine will load it
+    int Check(const std::filesystem::path& packPath)
+    {
+        const jela::AssetPack pack{ packPath };
+        std::size_t imageCount{};
+        std::size_t failureCount{};
+        for (std::size_t index = 0; index < pack.GetAssetCount(); ++index)
+        {
+            const std::string_view name{ pack.GetAssetName(index) };
+            if (!name.ends_with(".png")) continue;
+
+            ++imageCount;
+            try
+            {
+                const jela::DecodedImage image{ jela::PngDecoder::Decode(pack.GetAssetData(index)) };
+                std::cout << std::format("{}\t{}x{}\n", name, image.width, image.height);
+            }
+            catch (const std::exception& e)
+            {
+                ++failureCount;
+                std::cout << std::format("{}\tFAILED: {}", name, e.what());
+            }
+        }
+        std::cout << imageCount - failureCount << " of " << imageCount << " images decoded\n";
+        return failureCount == 0 ? 0 : 1;
+    }
+}
+
+int main(int argc, char* argv[])
+{
+    try
+    {
+        const std::string_view command{ argc > 1 ? argv[1] : "" };
+        if (command == "pack" && argc == 4) return Pack(argv[2], argv[3]);
+        if (command == "list" && argc == 3) return List(argv[2]);
+        if (command == "check" && argc == 3) return Check(argv[2]);
+    }
+    catch (const std::exception& e)
+    {
+        std::cerr << e.what() << '\n';
+        return 1;
+    }
+
+    PrintUsage();
+    return 2;
+}